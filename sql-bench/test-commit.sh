@@ -0,0 +1,97 @@
+#!/usr/bin/perl
+# Copyright (c) 2013, Twitter, Inc. All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; version 2
+# of the License.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the Free
+# Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+# MA 02110-1301, USA
+#
+# Test of many small transactions committed by concurrent clients: every
+# client inserts single rows in autocommit mode into a shared table.
+#
+
+##################### Standard benchmark inits ##############################
+
+use Cwd;
+use DBI;
+use Benchmark;
+
+$opt_loop_count=64000;	    # Rows inserted for each number of clients
+@opt_clients=(1,4,8,16,32,64);
+
+$pwd = cwd(); $pwd = "." if ($pwd eq '');
+require "$pwd/bench-init.pl" || die "Can't read Configuration file: $!\n";
+
+if ($opt_small_test)
+{
+  $opt_loop_count/=10;
+}
+
+print "Testing concurrent commits of single row inserts\n";
+print "$opt_loop_count rows are inserted with each number of clients\n\n";
+
+####
+####  Connect and start timeing
+####
+
+$start_time=new Benchmark;
+$dbh = $server->connect();
+
+foreach $clients (@opt_clients)
+{
+  print "Creating table\n";
+  $dbh->do("drop table bench1" . $server->{'drop_attr'});
+
+  do_many($dbh,$server->create("bench1",
+			       ["id int NOT NULL",
+				"client int NOT NULL",
+				"pad char(60) NOT NULL"],
+			       ["primary key (client,id)"]));
+
+  $rows=int($opt_loop_count/$clients);
+
+  $loop_time=new Benchmark;
+  for ($client=0 ; $client < $clients ; $client++)
+  {
+    $pid=fork();
+    die "Can't fork: $!\n" if (!defined($pid));
+    next if ($pid);
+
+    # The child must not close the connection of the parent
+    $dbh->{InactiveDestroy}=1;
+    $cdbh = $server->connect();
+    for ($i=0 ; $i < $rows ; $i++)
+    {
+      $cdbh->do("insert into bench1 values ($i,$client,'ABCDEFGHIJKLMNOPQRSTUVWXYZ')")
+	or die $DBI::errstr;
+    }
+    $cdbh->disconnect;
+    exit 0;
+  }
+  while (wait() != -1)
+  {
+    die "A client failed\n" if ($?);
+  }
+  $end_time=new Benchmark;
+  print "Time for insert_commit_$clients (" . $rows*$clients . "): " .
+    timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+}
+
+####
+#### End of benchmark
+####
+
+$sth = $dbh->do("drop table bench1" . $server->{'drop_attr'}) or die $DBI::errstr;
+
+$dbh->disconnect;				# close connection
+end_benchmark($start_time);
@@ -0,0 +1,162 @@
+#!/usr/bin/perl
+# Copyright (c) 2013, Twitter, Inc. All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; version 2
+# of the License.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the Free
+# Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+# MA 02110-1301, USA
+#
+# Test of large sequential scans: full table scans and long range scans
+# on the primary key and on a secondary index.
+#
+
+##################### Standard benchmark inits ##############################
+
+use Cwd;
+use DBI;
+use Benchmark;
+
+$opt_loop_count=500000;	    # Rows in the table
+$opt_medium_loop_count=20;  # Scans of the whole table
+$opt_range_count=200;	    # Scans of 1/100 of the table
+
+$pwd = cwd(); $pwd = "." if ($pwd eq '');
+require "$pwd/bench-init.pl" || die "Can't read Configuration file: $!\n";
+
+if ($opt_small_test || $opt_small_tables)
+{
+  $opt_loop_count/=100;
+}
+if ($opt_small_test)
+{
+  $opt_medium_loop_count/=10;
+  $opt_range_count/=10;
+}
+
+print "Testing large sequential scans\n";
+print "The table has $opt_loop_count rows\n\n";
+
+####
+####  Connect and start timeing
+####
+
+$start_time=new Benchmark;
+$dbh = $server->connect();
+
+###
+### Create and fill the table
+###
+
+print "Creating table\n";
+$dbh->do("drop table bench1" . $server->{'drop_attr'});
+
+do_many($dbh,$server->create("bench1",
+			     ["id int NOT NULL",
+			      "grp int NOT NULL",
+			      "val int NOT NULL",
+			      "pad char(60) NOT NULL"],
+			     ["primary key (id)",
+			      "index index_grp (grp)"]));
+
+$loop_time=new Benchmark;
+
+if ($server->{transactions})
+{
+  $dbh->{AutoCommit} = 0;
+}
+
+print "Inserting $opt_loop_count rows\n";
+$query_size=$limits->{'query_size'};
+$query="insert into bench1 values ";
+$res=$query;
+for ($i=0 ; $i < $opt_loop_count ; $i++)
+{
+  my $tmp= "($i," . ($i % 100) . "," . ($i * 7 % 1000) . ",'ABCDEFGHIJKLMNOPQRSTUVWXYZ'),";
+  if ($limits->{'insert_multi_value'} &&
+      length($tmp)+length($res) < $query_size)
+  {
+    $res.= $tmp;
+  }
+  else
+  {
+    do_query($dbh,substr($res,0,length($res)-1)) if ($res ne $query);
+    $res=$query . $tmp;
+  }
+}
+do_query($dbh,substr($res,0,length($res)-1));
+
+if ($server->{transactions})
+{
+  $dbh->commit;
+  $dbh->{AutoCommit} = 1;
+}
+
+$end_time=new Benchmark;
+print "Time for insert ($opt_loop_count): " .
+  timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+
+if ($opt_fast && defined($server->{vacuum}))
+{
+  $server->vacuum(0,\$dbh);
+}
+
+###
+### Scans that do not return the rows to the client
+###
+
+time_fetch_all_rows("Testing full table scans",
+		    "select_full_scan",
+		    "select sum(val) from bench1 where pad <> ''",
+		    $dbh,$opt_medium_loop_count);
+
+$range=int($opt_loop_count/100);
+$loop_time=new Benchmark;
+$rows=0;
+for ($i=0 ; $i < $opt_range_count ; $i++)
+{
+  my $start=($i * 7919) % ($opt_loop_count - $range);
+  my $end=$start + $range - 1;
+  $rows+=fetch_all_rows($dbh,"select sum(val) from bench1 where id between $start and $end and pad <> ''");
+}
+$end_time=new Benchmark;
+print "Time for select_range_primary_key ($opt_range_count:$rows): " .
+  timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+
+$loop_time=new Benchmark;
+$rows=0;
+for ($i=0 ; $i < $opt_range_count ; $i++)
+{
+  my $grp=$i % 100;
+  $rows+=fetch_all_rows($dbh,"select count(*),max(id) from bench1 where grp=$grp");
+}
+$end_time=new Benchmark;
+print "Time for select_range_index_only ($opt_range_count:$rows): " .
+  timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+
+###
+### Scans that return all rows to the client
+###
+
+time_fetch_all_rows("Testing fetching all rows",
+		    "select_all_rows",
+		    "select id,val from bench1",
+		    $dbh,$opt_medium_loop_count);
+
+####
+#### End of benchmark
+####
+
+$sth = $dbh->do("drop table bench1" . $server->{'drop_attr'}) or die $DBI::errstr;
+
+$dbh->disconnect;				# close connection
+end_benchmark($start_time);
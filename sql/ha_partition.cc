@@ -7077,6 +7077,11 @@ uint ha_partition::alter_table_flags(uint flags)
   flags_to_check|= HA_INPLACE_DROP_PK_INDEX_NO_WRITE;
   if ((flags_to_return & flags_to_check) != flags_to_check)
     flags_to_return&= ~flags_to_check;
+  /*
+    The partitions are altered one at a time, so writes must be blocked
+    until all of them have been altered.
+  */
+  flags_to_return&= ~HA_INPLACE_ADD_INDEX_ONLINE;
   DBUG_RETURN(flags_to_return);
 }
 
@@ -1344,6 +1344,7 @@ int ha_commit_trans(THD *thd, bool all)
         goto end;
       }
       DBUG_EXECUTE_IF("crash_commit_after_log", DBUG_SUICIDE(););
+      DEBUG_SYNC(thd, "ha_commit_trans_after_log_xid");
     }
     error=ha_commit_one_phase(thd, all) ? (cookie ? 2 : 1) : 0;
     DBUG_EXECUTE_IF("crash_commit_before_unlog", DBUG_SUICIDE(););
@@ -4708,6 +4709,34 @@ scan_it_again:
 }
 
 
+/**
+  Check the conditions for a disk-sweep multi-range read that do not
+  depend on the storage engine.
+
+  A disk-sweep multi-range read only pays off when the rows are looked
+  up by their row reference after the index scan, so it is not used if
+  the scan is covering, or if the index is the clustered primary key.
+
+  @param keyno   Index the ranges are on
+  @param sorted  TRUE if the rows must be returned in index order
+
+  @return The size of the buffer for the row references (mrr_buffer_size),
+          or 0 if the rows must be read in index order
+*/
+ulong handler::disk_sweep_mrr_buffer_size(uint keyno, bool sorted)
+{
+  THD *thd= table->in_use;
+
+  if (sorted || keyno >= MAX_KEY ||
+      !(thd->variables.optimizer_switch & OPTIMIZER_SWITCH_MRR) ||
+      thd->variables.mrr_buff_size < 2 * ref_length ||
+      table->key_read ||
+      (keyno == table->s->primary_key && primary_key_is_clustered()))
+    return 0;
+  return thd->variables.mrr_buff_size;
+}
+
+
 /**
   Read first row between two ranges.
   Store ranges for future calls to read_range_next.
@@ -4845,6 +4874,41 @@ int handler::compare_key(key_range *range)
 }
 
 
+/**
+  Check an index entry against the index condition that was pushed down
+  to the handler, see handler::idx_cond_push().
+
+  The storage engine must have copied the columns of the index entry to
+  table->record[0] before calling this function.
+
+  @param h_arg  the handler, as a void pointer so that storage engines
+                written in C can call this function
+
+  @retval ICP_NO_MATCH      the entry does not satisfy the condition
+  @retval ICP_MATCH         the entry satisfies the condition
+  @retval ICP_OUT_OF_RANGE  the entry is beyond the end of the range that
+                            is being scanned
+*/
+ICP_RESULT handler_index_cond_check(void* h_arg)
+{
+  handler *h= (handler*) h_arg;
+  THD *thd= h->table->in_use;
+  DBUG_ENTER("handler_index_cond_check");
+  DBUG_ASSERT(h->pushed_idx_cond);
+  DBUG_ASSERT(h->pushed_idx_cond_keyno == h->active_index);
+
+  if (h->end_range && h->compare_key(h->end_range) > 0)
+    DBUG_RETURN(ICP_OUT_OF_RANGE);
+
+  status_var_increment(thd->status_var.ha_icp_attempts);
+  if (!h->pushed_idx_cond->val_int())
+    DBUG_RETURN(ICP_NO_MATCH);
+
+  status_var_increment(thd->status_var.ha_icp_match);
+  DBUG_RETURN(ICP_MATCH);
+}
+
+
 int handler::index_read_idx_map(uchar * buf, uint index, const uchar * key,
                                 key_part_map keypart_map,
                                 enum ha_rkey_function find_flag)
@@ -5243,6 +5307,8 @@ int handler::ha_reset()
   /* reset the bitmaps to point to defaults */
   table->default_column_bitmaps();
   pushed_cond= NULL;
+  /* Reset information about pushed index conditions */
+  cancel_pushed_idx_cond();
   DBUG_RETURN(reset());
 }
 
@@ -34,6 +34,7 @@
 #include "structs.h"                            /* SHOW_COMP_OPTION */
 
 #include <my_compare.h>
+#include <my_icp.h>
 #include <ft_global.h>
 #include <keycache.h>
 
@@ -207,6 +208,13 @@
 #define HA_INPLACE_DROP_UNIQUE_INDEX_NO_WRITE      (1L << 9)
 #define HA_INPLACE_ADD_PK_INDEX_NO_WRITE           (1L << 10)
 #define HA_INPLACE_DROP_PK_INDEX_NO_WRITE          (1L << 11)
+/*
+  HA_INPLACE_ADD_INDEX_ONLINE is set if non-unique secondary indexes can be
+  created in-place while allowing concurrent reads and writes of table data,
+  except while the index creation is being finalized. It implies
+  HA_INPLACE_ADD_INDEX_NO_WRITE.
+*/
+#define HA_INPLACE_ADD_INDEX_ONLINE                (1L << 15)
 /*
   HA_PARTITION_FUNCTION_SUPPORTED indicates that the function is
   supported at all.
@@ -241,6 +249,8 @@
   set for unordered (e.g. HASH) indexes.
 */
 #define HA_KEY_SCAN_NOT_ROR     128 
+/* Supports Index Condition Pushdown, see handler::idx_cond_push() */
+#define HA_DO_INDEX_COND_PUSHDOWN  256
 
 /* operations for disable/enable indexes */
 #define HA_KEY_SWITCH_NONUNIQ      0
@@ -1261,6 +1271,8 @@ public:
   virtual ~handler_add_index() {}
 };
 
+extern "C" ICP_RESULT handler_index_cond_check(void* h_arg);
+
 /**
   The handler class is the interface for dynamically loadable
   storage engines. Do not add ifdefs and take care when adding or
@@ -1269,6 +1281,7 @@ public:
 
 class handler :public Sql_alloc
 {
+  friend ICP_RESULT handler_index_cond_check(void* h_arg);
 public:
   typedef ulonglong Table_flags;
 protected:
@@ -1309,6 +1322,13 @@ public:
   bool locked;
   bool implicit_emptied;                /* Can be !=0 only if HEAP */
   const COND *pushed_cond;
+  /**
+    Index condition that was pushed down to the storage engine by
+    idx_cond_push(), and the index it was pushed to. The engine evaluates
+    it with handler_index_cond_check().
+  */
+  Item *pushed_idx_cond;
+  uint pushed_idx_cond_keyno;
   /**
     next_insert_id is the next value which should be inserted into the
     auto_increment column: in a inserting-multi-row statement (like INSERT
@@ -1361,7 +1381,8 @@ public:
     ref_length(sizeof(my_off_t)),
     ft_handler(0), inited(NONE),
     locked(FALSE), implicit_emptied(0),
-    pushed_cond(0), next_insert_id(0), insert_id_for_cur_row(0),
+    pushed_cond(0), pushed_idx_cond(NULL), pushed_idx_cond_keyno(MAX_KEY),
+    next_insert_id(0), insert_id_for_cur_row(0),
     auto_inc_intervals_count(0),
     m_psi(NULL)
     {}
@@ -1387,6 +1408,7 @@ public:
     DBUG_ASSERT(inited==NONE);
     if (!(result= index_init(idx, sorted)))
       inited=INDEX;
+    end_range= NULL;
     DBUG_RETURN(result);
   }
   int ha_index_end()
@@ -1641,6 +1663,18 @@ public:
                                      KEY_MULTI_RANGE *ranges, uint range_count,
                                      bool sorted, HANDLER_BUFFER *buffer);
   virtual int read_multi_range_next(KEY_MULTI_RANGE **found_range_p);
+  /**
+    Check if read_multi_range_first() on index keyno collects the row
+    references of the ranges and reads the rows in their order (disk-sweep
+    multi-range read), instead of reading each row in index order.
+
+    @param keyno   Index the ranges are on
+    @param sorted  TRUE if the rows must be returned in index order
+
+    @see disk_sweep_mrr_buffer_size()
+  */
+  virtual bool use_disk_sweep_mrr(uint keyno, bool sorted) { return FALSE; }
+  ulong disk_sweep_mrr_buffer_size(uint keyno, bool sorted);
   virtual int read_range_first(const key_range *start_key,
                                const key_range *end_key,
                                bool eq_range, bool sorted);
@@ -2001,6 +2035,38 @@ public:
    Pops the top if condition stack, if stack is not empty.
  */
  virtual void cond_pop() { return; };
+
+ /**
+   Push down an index condition to the handler.
+
+   The handler will evaluate the condition on the columns of the index
+   keyno, for every index entry it reads, before it fetches the rest of
+   the row. It does so by copying the index columns to table->record[0]
+   and calling handler_index_cond_check(), which also checks whether the
+   index entry is beyond the end of the range that is being scanned.
+
+   @param  keyno     MySQL index number
+   @param  idx_cond  Condition that only refers to columns of the index,
+                     see make_cond_for_index()
+
+   @return
+     The part of the condition that the handler does not evaluate; the
+     caller must use it to filter out records. NULL means the handler
+     will only return rows that match idx_cond.
+
+   @note
+   handler->ha_reset() and cancel_pushed_idx_cond() remove the pushed
+   index condition.
+ */
+ virtual Item *idx_cond_push(uint keyno, Item *idx_cond) { return idx_cond; }
+ /**
+   Reset information about the pushed index condition.
+ */
+ virtual void cancel_pushed_idx_cond()
+ {
+   pushed_idx_cond= NULL;
+   pushed_idx_cond_keyno= MAX_KEY;
+ }
  virtual bool check_if_incompatible_data(HA_CREATE_INFO *create_info,
 					 uint table_changes)
  { return COMPATIBLE_DATA_NO; }
@@ -430,6 +430,8 @@ public:
      trx_cache.set_binlog_cache_info(param_max_binlog_cache_size,
                                      param_ptr_binlog_cache_use,
                                      param_ptr_binlog_cache_disk_use);
+     commit_ticket= 0;
+     commit_pos= 0;
   }
 
   void reset_cache(binlog_cache_data* cache_data)
@@ -451,6 +453,18 @@ public:
 
   binlog_cache_data trx_cache;
 
+  /*
+    Ticket assigned by the binlog group commit to the transaction being
+    committed, or 0 if the engines need not wait for their turn.
+  */
+  ulonglong commit_ticket;
+
+  /*
+    Binlog position right after the events of the transaction being
+    committed.
+  */
+  my_off_t commit_pos;
+
 private:
 
   binlog_cache_mngr& operator=(const binlog_cache_mngr& info);
@@ -2820,7 +2834,9 @@ const char *MYSQL_LOG::generate_name(const char *log_name,
 
 
 MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
-  :bytes_written(0), prepared_xids(0), file_id(1), open_count(1),
+  :group_commit_queue(0), group_commit_queue_last(0),
+   commit_ticket_next(0), commit_ticket_done(0),
+   bytes_written(0), prepared_xids(0), file_id(1), open_count(1),
    need_start_event(TRUE),
    sync_period_ptr(sync_period), sync_counter(0),
    is_relay_log(0), signal_cnt(0),
@@ -5522,6 +5538,234 @@ bool MYSQL_BIN_LOG::write_incident(THD *thd, bool lock)
   DBUG_RETURN(error);
 }
 
+/**
+  Write the events of one transaction to the binary log.
+
+  The events are a BEGIN, the contents of the cache, the commit event
+  and, if requested, an incident event. The log is not flushed.
+
+  @param thd
+  @param cache		The cache to copy to the binlog
+  @param commit_event   The commit event to print after writing the
+                        contents of the cache.
+  @param incident       Defines if an incident event should be created to
+                        notify that some non-transactional changes did
+                        not get into the binlog.
+
+  @note
+    LOCK_log must be held by the caller.
+
+  @retval FALSE  success
+  @retval TRUE   error
+*/
+
+bool MYSQL_BIN_LOG::write_transaction(THD *thd, IO_CACHE *cache,
+                                      Log_event *commit_event, bool incident)
+{
+  DBUG_ENTER("MYSQL_BIN_LOG::write_transaction");
+  mysql_mutex_assert_owner(&LOCK_log);
+
+  /*
+    Log "BEGIN" at the beginning of every transaction.  Here, a
+    transaction is either a BEGIN..COMMIT block or a single
+    statement in autocommit mode.
+  */
+  Query_log_event qinfo(thd, STRING_WITH_LEN("BEGIN"), TRUE, FALSE, TRUE, 0);
+  if (qinfo.write(&log_file))
+    DBUG_RETURN(TRUE);
+  DBUG_EXECUTE_IF("crash_before_writing_xid",
+                  {
+                    if ((write_error= write_cache(cache, false, true)))
+                      DBUG_PRINT("info", ("error writing binlog cache: %d",
+                                           write_error));
+                    DBUG_PRINT("info", ("crashing before writing xid"));
+                    DBUG_SUICIDE();
+                  });
+
+  if ((write_error= write_cache(cache, false, false)))
+    DBUG_RETURN(TRUE);
+
+  if (commit_event && commit_event->write(&log_file))
+    DBUG_RETURN(TRUE);
+
+  if (incident && write_incident(thd, FALSE))
+    DBUG_RETURN(TRUE);
+
+  if (cache->error)				// Error on read
+  {
+    sql_print_error(ER(ER_ERROR_ON_READ), cache->file_name, errno);
+    write_error=1;				// Don't give more errors
+    DBUG_RETURN(TRUE);
+  }
+
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  A transaction waiting in the binlog group commit queue. The entry lives
+  on the stack of the committing session, which sleeps until the group
+  leader has set @c done.
+*/
+
+struct Binlog_group_commit_entry
+{
+  Binlog_group_commit_entry(THD *thd_arg, IO_CACHE *cache_arg,
+                            Log_event *commit_event_arg, bool incident_arg)
+    : thd(thd_arg), cache(cache_arg), commit_event(commit_event_arg),
+      incident(incident_arg), next(NULL), error(FALSE), done(FALSE)
+  { }
+
+  THD *thd;
+  IO_CACHE *cache;
+  Log_event *commit_event;
+  bool incident;
+  Binlog_group_commit_entry *next;
+  bool error;
+  bool done;
+};
+
+
+/**
+  Write an XID transaction to the binary log as part of a commit group.
+
+  The commit is done in three stages:
+
+  - Flush stage: the session is appended to the flush queue. The first
+    session in an empty queue becomes the leader; the others wait. Once
+    the leader holds LOCK_log it takes the whole queue (sessions that
+    arrive from now on form the next group) and writes the caches of
+    all members in queue order.
+  - Sync stage: the leader flushes and syncs the binary log once for
+    the whole group and runs the after_flush hooks of every member.
+  - Commit stage: every member is given a commit ticket in binary log
+    order so that storage engines can commit in the same order (see
+    commit_order_enter()), and the leader wakes up the group.
+
+  @param entry  The queue entry of the calling session.
+
+  @retval FALSE  success
+  @retval TRUE   error
+*/
+
+bool MYSQL_BIN_LOG::write_group_commit(Binlog_group_commit_entry *entry)
+{
+  THD *thd= entry->thd;
+  Binlog_group_commit_entry *queue, *e;
+  ulong group_size= 0;
+  bool synced= 0;
+  DBUG_ENTER("MYSQL_BIN_LOG::write_group_commit");
+
+  mysql_mutex_lock(&LOCK_group_commit);
+  if (group_commit_queue == NULL)
+    group_commit_queue= entry;
+  else
+    group_commit_queue_last->next= entry;
+  group_commit_queue_last= entry;
+
+  if (group_commit_queue != entry)
+  {
+    /* Follower: the leader writes our transaction and wakes us up. */
+    const char *old_msg;
+    old_msg= thd->enter_cond(&COND_group_commit, &LOCK_group_commit,
+                             "Waiting for binlog group commit");
+    while (!entry->done)
+      mysql_cond_wait(&COND_group_commit, &LOCK_group_commit);
+    thd->exit_cond(old_msg);
+    DBUG_RETURN(entry->error);
+  }
+  mysql_mutex_unlock(&LOCK_group_commit);
+
+  /* Flush stage. */
+  mysql_mutex_lock(&LOCK_log);
+
+  mysql_mutex_lock(&LOCK_group_commit);
+  queue= group_commit_queue;
+  group_commit_queue= group_commit_queue_last= NULL;
+  mysql_mutex_unlock(&LOCK_group_commit);
+
+  for (e= queue; e; e= e->next)
+  {
+    binlog_cache_mngr *cache_mngr=
+      (binlog_cache_mngr*) thd_get_ha_data(e->thd, binlog_hton);
+
+    group_size++;
+    if (my_b_tell(e->cache) > 0 &&
+        write_transaction(e->thd, e->cache, e->commit_event, e->incident))
+    {
+      if (!write_error)
+      {
+        write_error= 1;
+        sql_print_error(ER(ER_ERROR_ON_WRITE), name, errno);
+      }
+      e->error= TRUE;
+    }
+    cache_mngr->commit_pos= my_b_tell(&log_file);
+    cache_mngr->commit_ticket= 0;
+  }
+
+  /* Sync stage. */
+  if (flush_and_sync(&synced))
+  {
+    if (!write_error)
+    {
+      write_error= 1;
+      sql_print_error(ER(ER_ERROR_ON_WRITE), name, errno);
+    }
+    for (e= queue; e; e= e->next)
+      e->error= TRUE;
+  }
+  DEBUG_SYNC(thd, "binlog_group_commit_after_sync");
+  DBUG_EXECUTE_IF("half_binlogged_transaction", DBUG_SUICIDE(););
+
+  for (e= queue; e; e= e->next)
+  {
+    binlog_cache_mngr *cache_mngr=
+      (binlog_cache_mngr*) thd_get_ha_data(e->thd, binlog_hton);
+
+    if (e->error)
+      continue;
+
+    if (RUN_HOOK(binlog_storage, after_flush,
+                 (e->thd, log_file_name, cache_mngr->commit_pos, synced)))
+    {
+      sql_print_error("Failed to run 'after_flush' hooks");
+      write_error= 1;
+      e->error= TRUE;
+      continue;
+    }
+
+    /*
+      Increase the number of prepared_xids (it's decreased in ::unlog()).
+      Binlog cannot be rotated if there're prepared xids in it - see the
+      comment in new_file() for an explanation.
+    */
+    mysql_mutex_lock(&LOCK_prep_xids);
+    prepared_xids++;
+    mysql_mutex_unlock(&LOCK_prep_xids);
+
+    /* Commit stage. */
+    if (opt_binlog_order_commits)
+      cache_mngr->commit_ticket= ++commit_ticket_next;
+  }
+
+  signal_update();
+
+  binlog_group_commits++;
+  binlog_group_commit_trx+= group_size;
+
+  mysql_mutex_unlock(&LOCK_log);
+
+  mysql_mutex_lock(&LOCK_group_commit);
+  for (e= queue; e; e= e->next)
+    e->done= TRUE;
+  mysql_cond_broadcast(&COND_group_commit);
+  mysql_mutex_unlock(&LOCK_group_commit);
+
+  DBUG_RETURN(entry->error);
+}
+
+
 /**
   Write a cached log entry to the binary log.
   - To support transaction over replication, we wrap the transaction
@@ -5530,6 +5774,9 @@ bool MYSQL_BIN_LOG::write_incident(THD *thd, bool lock)
   was updated in a transaction which was rolled back. This is to ensure
   that the same updates are run on the slave.
 
+  Transactions ending with an Xid_log_event are committed through the
+  binlog group commit, see write_group_commit().
+
   @param thd
   @param cache		The cache to copy to the binlog
   @param commit_event   The commit event to print after writing the
@@ -5559,6 +5806,12 @@ bool MYSQL_BIN_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event,
 
     scoped_proc_info(state, "Writing a cached log to the binary log");
 
+    if (commit_event && commit_event->get_type_code() == XID_EVENT)
+    {
+      Binlog_group_commit_entry entry(thd, cache, commit_event, incident);
+      DBUG_RETURN(write_group_commit(&entry));
+    }
+
     mysql_mutex_lock(&LOCK_log);
     /*
       We only bother to write to the binary log if there is anything
@@ -5566,42 +5819,13 @@ bool MYSQL_BIN_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event,
      */
     if (my_b_tell(cache) > 0)
     {
-      /*
-        Log "BEGIN" at the beginning of every transaction.  Here, a
-        transaction is either a BEGIN..COMMIT block or a single
-        statement in autocommit mode.
-      */
-      Query_log_event qinfo(thd, STRING_WITH_LEN("BEGIN"), TRUE, FALSE, TRUE, 0);
-      if (qinfo.write(&log_file))
-        goto err;
-      DBUG_EXECUTE_IF("crash_before_writing_xid",
-                      {
-                        if ((write_error= write_cache(cache, false, true)))
-                          DBUG_PRINT("info", ("error writing binlog cache: %d",
-                                               write_error));
-                        DBUG_PRINT("info", ("crashing before writing xid"));
-                        DBUG_SUICIDE();
-                      });
-
-      if ((write_error= write_cache(cache, false, false)))
-        goto err;
-
-      if (commit_event && commit_event->write(&log_file))
-        goto err;
-
-      if (incident && write_incident(thd, FALSE))
+      if (write_transaction(thd, cache, commit_event, incident))
         goto err;
 
       bool synced= 0;
       if (flush_and_sync(&synced))
         goto err;
       DBUG_EXECUTE_IF("half_binlogged_transaction", DBUG_SUICIDE(););
-      if (cache->error)				// Error on read
-      {
-        sql_print_error(ER(ER_ERROR_ON_READ), cache->file_name, errno);
-        write_error=1;				// Don't give more errors
-        goto err;
-      }
 
       if (RUN_HOOK(binlog_storage, after_flush,
                    (thd, log_file_name, log_file.pos_in_file, synced)))
@@ -5615,28 +5839,14 @@ bool MYSQL_BIN_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event,
     }
 
     /*
-      if commit_event is Xid_log_event, increase the number of
-      prepared_xids (it's decreasd in ::unlog()). Binlog cannot be rotated
-      if there're prepared xids in it - see the comment in new_file() for
-      an explanation.
-      If the commit_event is not Xid_log_event (then it's a Query_log_event)
-      rotate binlog, if necessary.
+      The commit_event is not an Xid_log_event (then it's a
+      Query_log_event), so rotate binlog, if necessary.
     */
-    if (commit_event && commit_event->get_type_code() == XID_EVENT)
-    {
-      mysql_mutex_lock(&LOCK_prep_xids);
-      prepared_xids++;
-      mysql_mutex_unlock(&LOCK_prep_xids);
-      mysql_mutex_unlock(&LOCK_log);
-    }
-    else
-    {
-      if (rotate(false, &check_purge))
-        goto err;
-      mysql_mutex_unlock(&LOCK_log);
-      if (check_purge) 
-        purge();
-    }
+    if (rotate(false, &check_purge))
+      goto err;
+    mysql_mutex_unlock(&LOCK_log);
+    if (check_purge)
+      purge();
   }
 
   DBUG_RETURN(0);
@@ -6571,6 +6781,12 @@ int TC_LOG_BINLOG::open(const char *opt_name)
   mysql_mutex_init(key_BINLOG_LOCK_prep_xids,
                    &LOCK_prep_xids, MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_BINLOG_COND_prep_xids, &COND_prep_xids, 0);
+  mysql_mutex_init(key_BINLOG_LOCK_group_commit,
+                   &LOCK_group_commit, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_BINLOG_COND_group_commit, &COND_group_commit, 0);
+  mysql_mutex_init(key_BINLOG_LOCK_commit_ordered,
+                   &LOCK_commit_ordered, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_BINLOG_COND_commit_ordered, &COND_commit_ordered, 0);
 
   if (!my_b_inited(&index_file))
   {
@@ -6650,13 +6866,18 @@ err:
 void TC_LOG_BINLOG::close()
 {
   DBUG_ASSERT(prepared_xids==0);
+  DBUG_ASSERT(group_commit_queue == NULL);
   mysql_mutex_destroy(&LOCK_prep_xids);
   mysql_cond_destroy(&COND_prep_xids);
+  mysql_mutex_destroy(&LOCK_group_commit);
+  mysql_cond_destroy(&COND_group_commit);
+  mysql_mutex_destroy(&LOCK_commit_ordered);
+  mysql_cond_destroy(&COND_commit_ordered);
 }
 
 /**
-  @todo
-  group commit
+  Write the transaction to the binary log. The transaction cache is
+  written by the binlog group commit, see write_group_commit().
 
   @retval
     0    error
@@ -6676,9 +6897,90 @@ int TC_LOG_BINLOG::log_xid(THD *thd, my_xid xid)
               !binlog_commit_flush_trx_cache(thd, cache_mngr, xid));
 }
 
+/**
+  Wait until all transactions written to the binary log before the
+  transaction of this session have been committed in the storage engines.
+
+  Storage engines call this (through mysql_bin_log_commit_order_enter())
+  right before making the transaction visible, so that transactions are
+  committed in the same order as they appear in the binary log. Does
+  nothing if the session does not hold a commit ticket.
+*/
+void TC_LOG_BINLOG::commit_order_enter(THD *thd)
+{
+  binlog_cache_mngr *cache_mngr;
+
+  /*
+    Without --log-bin the binlog handlerton has no slot in the session.
+    Tickets are only handed out while the binary log is open; a session
+    that holds one waits for its turn even if the log has been closed
+    since, or the sessions behind it would commit out of order.
+  */
+  if (binlog_hton->slot == HA_SLOT_UNDEF)
+    return;
+
+  cache_mngr= (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
+
+  if (!cache_mngr || !cache_mngr->commit_ticket)
+    return;
+
+  mysql_mutex_lock(&LOCK_commit_ordered);
+  if (commit_ticket_done + 1 != cache_mngr->commit_ticket)
+  {
+    const char *old_msg;
+    old_msg= thd->enter_cond(&COND_commit_ordered, &LOCK_commit_ordered,
+                             "Waiting for binlog commit order");
+    while (commit_ticket_done + 1 != cache_mngr->commit_ticket)
+      mysql_cond_wait(&COND_commit_ordered, &LOCK_commit_ordered);
+    thd->exit_cond(old_msg);
+  }
+  else
+    mysql_mutex_unlock(&LOCK_commit_ordered);
+}
+
+/**
+  Let the transaction following the one of this session in the binary log
+  commit. Must be called after commit_order_enter().
+*/
+void TC_LOG_BINLOG::commit_order_exit(THD *thd)
+{
+  binlog_cache_mngr *cache_mngr;
+
+  /*
+    A commit ticket is released even if the binary log has been closed
+    since commit_order_enter(), so that no later session waits for it.
+  */
+  if (binlog_hton->slot == HA_SLOT_UNDEF)
+    return;
+
+  cache_mngr= (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
+
+  if (!cache_mngr || !cache_mngr->commit_ticket)
+    return;
+
+  mysql_mutex_lock(&LOCK_commit_ordered);
+  DBUG_ASSERT(commit_ticket_done + 1 == cache_mngr->commit_ticket);
+  commit_ticket_done= cache_mngr->commit_ticket;
+  cache_mngr->commit_ticket= 0;
+  mysql_cond_broadcast(&COND_commit_ordered);
+  mysql_mutex_unlock(&LOCK_commit_ordered);
+}
+
 int TC_LOG_BINLOG::unlog(ulong cookie, my_xid xid)
 {
+  THD *thd= current_thd;
+  binlog_cache_mngr *cache_mngr=
+    (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
   DBUG_ENTER("TC_LOG_BINLOG::unlog");
+  /*
+    Release the commit ticket if no storage engine has taken its turn,
+    so that the transactions behind us are not blocked.
+  */
+  commit_order_enter(thd);
+  commit_order_exit(thd);
+  if (cache_mngr)
+    cache_mngr->commit_pos= 0;
+
   mysql_mutex_lock(&LOCK_prep_xids);
   // prepared_xids can be 0 if the transaction had ignorable errors.
   DBUG_ASSERT(prepared_xids >= 0);
@@ -6938,6 +7240,47 @@ ulonglong mysql_bin_log_file_pos(void)
 {
   return (ulonglong) mysql_bin_log.get_log_file()->pos_in_file;
 }
+
+/**
+  Get the binlog file name and the position right after the events of
+  the transaction the session is committing. Falls back to the current
+  binlog position if the transaction has not been written by the binlog
+  group commit.
+*/
+extern "C"
+void mysql_bin_log_commit_pos(THD *thd, ulonglong *pos, const char **file)
+{
+  binlog_cache_mngr *cache_mngr= NULL;
+
+  /* Without --log-bin the binlog handlerton has no slot in the session. */
+  if (binlog_hton->slot != HA_SLOT_UNDEF)
+    cache_mngr= (binlog_cache_mngr*) thd_get_ha_data(thd, binlog_hton);
+
+  *file= mysql_bin_log.get_log_fname();
+  if (cache_mngr && cache_mngr->commit_pos)
+    *pos= (ulonglong) cache_mngr->commit_pos;
+  else
+    *pos= (ulonglong) mysql_bin_log.get_log_file()->pos_in_file;
+}
+
+/**
+  Wait until the transactions written to the binlog before the one the
+  session is committing have been committed in the storage engines.
+*/
+extern "C"
+void mysql_bin_log_commit_order_enter(THD *thd)
+{
+  mysql_bin_log.commit_order_enter(thd);
+}
+
+/**
+  Let the next transaction in binlog order commit in the storage engines.
+*/
+extern "C"
+void mysql_bin_log_commit_order_exit(THD *thd)
+{
+  mysql_bin_log.commit_order_exit(thd);
+}
 #endif /* INNODB_COMPATIBILITY_HOOKS */
 
 
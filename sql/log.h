@@ -23,6 +23,8 @@ class Relay_log_info;
 
 class Format_description_log_event;
 
+struct Binlog_group_commit_entry;
+
 bool trans_has_updated_trans_table(const THD* thd);
 bool stmt_has_updated_trans_table(const THD *thd);
 bool use_trans_cache(const THD* thd, bool is_transactional);
@@ -294,6 +296,26 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   mysql_mutex_t LOCK_prep_xids;
   mysql_cond_t  COND_prep_xids;
   mysql_cond_t update_cond;
+  /*
+    Group commit. Sessions committing an XID transaction append themselves
+    to the flush queue under LOCK_group_commit. The session that finds the
+    queue empty becomes the group leader: once it holds LOCK_log it takes
+    the whole queue, writes every cache, syncs the binary log once and
+    then wakes the other members through COND_group_commit.
+  */
+  mysql_mutex_t LOCK_group_commit;
+  mysql_cond_t  COND_group_commit;
+  Binlog_group_commit_entry *group_commit_queue;
+  Binlog_group_commit_entry *group_commit_queue_last;
+  /*
+    Commit ordering. Every transaction written by a group is handed a
+    ticket in binary log order; storage engines commit in ticket order
+    between commit_order_enter() and commit_order_exit().
+  */
+  mysql_mutex_t LOCK_commit_ordered;
+  mysql_cond_t  COND_commit_ordered;
+  ulonglong commit_ticket_next;
+  ulonglong commit_ticket_done;
   ulonglong bytes_written;
   IO_CACHE index_file;
   char index_file_name[FN_REFLEN];
@@ -344,6 +366,9 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   }
 
   int write_to_file(IO_CACHE *cache);
+  bool write_transaction(THD *thd, IO_CACHE *cache, Log_event *commit_event,
+                         bool incident);
+  bool write_group_commit(Binlog_group_commit_entry *entry);
   /*
     This is used to start writing to a new log file. The difference from
     new_file() is locking. new_file_without_locking() does not acquire
@@ -395,6 +420,8 @@ public:
   int log_xid(THD *thd, my_xid xid);
   int unlog(ulong cookie, my_xid xid);
   int recover(IO_CACHE *log, Format_description_log_event *fdle);
+  void commit_order_enter(THD *thd);
+  void commit_order_exit(THD *thd);
 #if !defined(MYSQL_CLIENT)
 
   int flush_and_set_pending_rows_event(THD *thd, Rows_log_event* event,
@@ -1508,6 +1508,7 @@ const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
     SNW       | +   +   +   -   -    -    -  |
     SNRW      | +   +   -   -   -    -    -  |
     X         | -   -   -   -   -    -    -  |
+    SW -> X   | -   -   -   -   0    0    0  |
     SNW -> X  | -   -   -   0   0    0    0  |
     SNRW -> X | -   -   0   0   0    0    0  |
 
@@ -1525,6 +1526,7 @@ const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
     SNW       | +   +   +   +   +     +   - |
     SNRW      | +   +   +   +   +     +   - |
     X         | +   +   +   +   +     +   + |
+    SW -> X   | +   +   +   +   +     +   + |
     SNW -> X  | +   +   +   +   +     +   + |
     SNRW -> X | +   +   +   +   +     +   + |
 
@@ -2350,9 +2352,13 @@ MDL_context::upgrade_shared_lock_to_exclusive(MDL_ticket *mdl_ticket,
   if (mdl_ticket->m_type == MDL_EXCLUSIVE)
     DBUG_RETURN(FALSE);
 
-  /* Only allow upgrades from MDL_SHARED_NO_WRITE/NO_READ_WRITE */
+  /*
+    Only allow upgrades from MDL_SHARED_NO_WRITE/NO_READ_WRITE, or from
+    MDL_SHARED_WRITE that was downgraded from MDL_SHARED_NO_WRITE.
+  */
   DBUG_ASSERT(mdl_ticket->m_type == MDL_SHARED_NO_WRITE ||
-              mdl_ticket->m_type == MDL_SHARED_NO_READ_WRITE);
+              mdl_ticket->m_type == MDL_SHARED_NO_READ_WRITE ||
+              mdl_ticket->m_type == MDL_SHARED_WRITE);
 
   mdl_xlock_request.init(&mdl_ticket->m_lock->key, MDL_EXCLUSIVE,
                          MDL_TRANSACTION);
@@ -2768,6 +2774,28 @@ void MDL_ticket::downgrade_exclusive_lock(enum_mdl_type type)
 }
 
 
+/**
+  Downgrade a shared metadata lock which blocks writes to a lock which
+  allows them, while ALTER TABLE builds an index online.
+
+  @note The lock can be upgraded back to exclusive, as no other
+        upgradable lock can be granted while this one is held.
+*/
+
+void MDL_ticket::downgrade_shared_no_write_lock()
+{
+  mysql_mutex_assert_not_owner(&LOCK_open);
+  DBUG_ASSERT(m_type == MDL_SHARED_NO_WRITE);
+
+  mysql_prlock_wrlock(&m_lock->m_rwlock);
+  m_lock->m_granted.remove_ticket(this);
+  m_type= MDL_SHARED_WRITE;
+  m_lock->m_granted.add_ticket(this);
+  m_lock->reschedule_waiters();
+  mysql_prlock_unlock(&m_lock->m_rwlock);
+}
+
+
 /**
   Auxiliary function which allows to check if we have some kind of lock on
   a object. Returns TRUE if we have a lock of a given or stronger type.
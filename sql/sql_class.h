@@ -451,6 +451,7 @@ typedef struct system_variables
   ulong profiling_history_size;
   ulong read_buff_size;
   ulong read_rnd_buff_size;
+  ulong mrr_buff_size;
   ulong div_precincrement;
   ulong sortbuff_size;
   ulong max_sp_recursion_depth;
@@ -547,6 +548,8 @@ typedef struct system_status_var
   ulong ha_discover_count;
   ulong ha_savepoint_count;
   ulong ha_savepoint_rollback_count;
+  ulong ha_icp_attempts;
+  ulong ha_icp_match;
 
   /* KEY_CACHE parts. These are copies of the original */
   ulong key_blocks_changed;
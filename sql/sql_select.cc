@@ -6150,6 +6150,7 @@ JOIN::make_simple_join(JOIN *parent, TABLE *temp_table)
   join_tab->table=temp_table;
   join_tab->select=0;
   join_tab->select_cond=0;
+  join_tab->pre_idx_push_select_cond= 0;
   join_tab->quick=0;
   join_tab->type= JT_ALL;			/* Map through all records */
   join_tab->keys.init();
@@ -6856,6 +6857,327 @@ pick_table_access_method(JOIN_TAB *tab)
 }
 
 
+/**
+  Check if an expression can be evaluated from the columns of an index.
+
+  @param item           Expression to check
+  @param tbl            The table the index belongs to
+  @param keyno          The index
+  @param other_tbls_ok  TRUE if columns of other tables may be used
+
+  @note
+    Columns of other tables are fine for ref and range scans, because
+    the rows of the preceding tables in the join order are already
+    available when the index is scanned.
+
+  @retval TRUE   The expression can be evaluated from the index tuple
+  @retval FALSE  Otherwise
+*/
+
+static bool
+uses_index_fields_only(Item *item, TABLE *tbl, uint keyno, bool other_tbls_ok)
+{
+  if (item->const_item())
+  {
+    /*
+      Do not push down constant subqueries or stored functions: they
+      would be evaluated for each index tuple.
+    */
+    return !item->has_subquery() &&
+           !item->walk(&Item::is_expensive_processor, 0, (uchar*) 0);
+  }
+
+  /*
+    Outer references are not available to the engine, and nondeterministic
+    functions must not be evaluated more than once per row.
+  */
+  if (item->used_tables() & (OUTER_REF_TABLE_BIT | RAND_TABLE_BIT))
+    return FALSE;
+
+  switch (item->type()) {
+  case Item::FUNC_ITEM:
+    {
+      Item_func *item_func= (Item_func*) item;
+      /*
+        Triggered conditions are switched on and off during the join
+        execution, and multiple equalities are substituted later.
+      */
+      if (item_func->functype() == Item_func::TRIG_COND_FUNC ||
+          item_func->functype() == Item_func::MULT_EQUAL_FUNC ||
+          item_func->is_expensive() || item_func->has_subquery())
+        return FALSE;
+      Item **child;
+      Item **item_end= item_func->arguments() + item_func->argument_count();
+      for (child= item_func->arguments(); child != item_end; child++)
+      {
+        if (!uses_index_fields_only(*child, tbl, keyno, other_tbls_ok))
+          return FALSE;
+      }
+      return TRUE;
+    }
+  case Item::COND_ITEM:
+    {
+      List_iterator<Item> li(*((Item_cond*) item)->argument_list());
+      Item *child;
+      while ((child= li++))
+      {
+        if (!uses_index_fields_only(child, tbl, keyno, other_tbls_ok))
+          return FALSE;
+      }
+      return TRUE;
+    }
+  case Item::FIELD_ITEM:
+    {
+      Field *field= ((Item_field*) item)->field;
+      if (field->table != tbl)
+        return other_tbls_ok;
+      /*
+        BLOB and GEOMETRY columns are stored outside the index tuple,
+        and a column prefix does not hold the whole value.
+      */
+      return field->part_of_key.is_set(keyno) &&
+             field->type() != MYSQL_TYPE_GEOMETRY &&
+             field->type() != MYSQL_TYPE_BLOB;
+    }
+  case Item::REF_ITEM:
+    return uses_index_fields_only(item->real_item(), tbl, keyno,
+                                  other_tbls_ok);
+  default:
+    return FALSE;
+  }
+}
+
+
+/**
+  Extract the part of a condition that can be checked on an index tuple.
+
+  @param cond           The condition to extract from
+  @param table          The table the index belongs to
+  @param keyno          The index
+  @param other_tbls_ok  TRUE if columns of other tables may be used
+
+  @return The index condition, or NULL if no part of cond can be checked
+          on the index tuple
+*/
+
+static Item *
+make_cond_for_index(Item *cond, TABLE *table, uint keyno, bool other_tbls_ok)
+{
+  if (cond->type() == Item::COND_ITEM)
+  {
+    uint n_marked= 0;
+    if (((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+    {
+      table_map used_tables= 0;
+      Item_cond_and *new_cond= new Item_cond_and;
+      if (!new_cond)
+        return NULL;
+      List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
+      {
+        Item *fix= make_cond_for_index(item, table, keyno, other_tbls_ok);
+        if (fix)
+        {
+          new_cond->argument_list()->push_back(fix);
+          used_tables|= fix->used_tables();
+          n_marked++;
+        }
+      }
+      switch (n_marked) {
+      case 0:
+        return NULL;
+      case 1:
+        return new_cond->argument_list()->head();
+      default:
+        new_cond->quick_fix_field();
+        new_cond->used_tables_cache= used_tables;
+        return new_cond;
+      }
+    }
+    else /* It's OR */
+    {
+      Item_cond_or *new_cond= new Item_cond_or;
+      if (!new_cond)
+        return NULL;
+      List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
+      {
+        Item *fix= make_cond_for_index(item, table, keyno, other_tbls_ok);
+        if (!fix)
+          return NULL;
+        new_cond->argument_list()->push_back(fix);
+      }
+      new_cond->quick_fix_field();
+      new_cond->used_tables_cache= ((Item_cond_or*) cond)->used_tables_cache;
+      new_cond->top_level_item();
+      return new_cond;
+    }
+  }
+
+  if (!uses_index_fields_only(cond, table, keyno, other_tbls_ok))
+    return NULL;
+  return cond;
+}
+
+
+/**
+  Extract the part of a condition that cannot be checked on an index
+  tuple, that is, what is left to check after make_cond_for_index().
+
+  @return The remaining condition, or NULL if all of cond can be checked
+          on the index tuple
+*/
+
+static Item *
+make_cond_remainder(Item *cond, TABLE *table, uint keyno, bool other_tbls_ok)
+{
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    table_map tbl_map= 0;
+    Item_cond_and *new_cond= new Item_cond_and;
+    if (!new_cond)
+      return (Item*) 0;
+    List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+    {
+      Item *fix= make_cond_remainder(item, table, keyno, other_tbls_ok);
+      if (fix)
+      {
+        new_cond->argument_list()->push_back(fix);
+        tbl_map|= fix->used_tables();
+      }
+    }
+    switch (new_cond->argument_list()->elements) {
+    case 0:
+      return (Item*) 0;
+    case 1:
+      return new_cond->argument_list()->head();
+    default:
+      new_cond->quick_fix_field();
+      new_cond->used_tables_cache= tbl_map;
+      return new_cond;
+    }
+  }
+
+  /* An OR is pushed down either as a whole or not at all */
+  if (uses_index_fields_only(cond, table, keyno, other_tbls_ok))
+    return (Item*) 0;
+  return cond;
+}
+
+
+/**
+  Try to push down a part of the condition on a table to the storage
+  engine as an index condition, to be checked on the index tuple before
+  the whole row is read.
+
+  @param tab            The join table. tab->select_cond is replaced
+                        with what is left to check on the whole row.
+  @param keyno          The index that will be used to access the table
+  @param other_tbls_ok  TRUE if columns of other tables may be used
+
+  @note
+    tab->select->cond keeps the full condition, because the join buffer
+    and filesort check the rows against it.
+*/
+
+static void
+push_index_cond(JOIN_TAB *tab, uint keyno, bool other_tbls_ok)
+{
+  TABLE *table= tab->table;
+  THD *thd= table->in_use;
+  DBUG_ENTER("push_index_cond");
+
+  if (!(table->file->index_flags(keyno, 0, 1) & HA_DO_INDEX_COND_PUSHDOWN) ||
+      !(thd->variables.optimizer_switch &
+        OPTIMIZER_SWITCH_INDEX_CONDITION_PUSHDOWN) ||
+      thd->lex->sql_command == SQLCOM_UPDATE_MULTI ||
+      thd->lex->sql_command == SQLCOM_DELETE_MULTI ||
+      !tab->select_cond ||
+      table->key_read || tab->first_inner ||
+      table->covering_keys.is_set(keyno) ||
+      (keyno == table->s->primary_key &&
+       table->file->primary_key_is_clustered()))
+    DBUG_VOID_RETURN;
+
+  Item *idx_cond= make_cond_for_index(tab->select_cond, table, keyno,
+                                      other_tbls_ok);
+  if (!idx_cond)
+    DBUG_VOID_RETURN;
+
+  DBUG_EXECUTE("where", print_where(idx_cond, "idx cond", QT_ORDINARY););
+
+  Item *idx_remainder_cond= table->file->idx_cond_push(keyno, idx_cond);
+  if (idx_remainder_cond == idx_cond)
+    DBUG_VOID_RETURN;                           // Not accepted
+
+  tab->pre_idx_push_select_cond= tab->select_cond;
+
+  Item *row_cond= make_cond_remainder(tab->select_cond, table, keyno,
+                                      other_tbls_ok);
+  if (row_cond && idx_remainder_cond)
+  {
+    Item_cond_and *new_cond= new Item_cond_and(row_cond, idx_remainder_cond);
+    new_cond->quick_fix_field();
+    new_cond->used_tables_cache= row_cond->used_tables() |
+                                 idx_remainder_cond->used_tables();
+    row_cond= new_cond;
+  }
+  else if (!row_cond)
+    row_cond= idx_remainder_cond;
+
+  tab->select_cond= row_cond;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Cancel the index condition that push_index_cond() pushed down, if
+  test_if_skip_sort_order() changed the access method so that the table
+  is no longer read through the index the condition was pushed for.
+
+  @param tab    The join table
+*/
+
+static void
+revise_index_cond(JOIN_TAB *tab)
+{
+  TABLE *table= tab->table;
+  uint keyno= MAX_KEY;
+
+  if (!tab->pre_idx_push_select_cond)
+    return;
+
+  switch (tab->type) {
+  case JT_EQ_REF:
+  case JT_REF:
+  case JT_REF_OR_NULL:
+    keyno= tab->ref.key;
+    break;
+  case JT_ALL:
+    if (tab->select && tab->select->quick)
+      keyno= tab->select->quick->index;
+    break;
+  case JT_NEXT:
+    keyno= tab->index;
+    break;
+  default:
+    break;
+  }
+
+  if (keyno == table->file->pushed_idx_cond_keyno && !table->key_read)
+    return;
+
+  tab->select_cond= tab->pre_idx_push_select_cond;
+  tab->pre_idx_push_select_cond= NULL;
+  table->file->cancel_pushed_idx_cond();
+}
+
+
 static void
 make_join_readinfo(JOIN *join, ulonglong options)
 {
@@ -6911,6 +7233,8 @@ make_join_readinfo(JOIN *join, ulonglong options)
       if (table->covering_keys.is_set(tab->ref.key) &&
 	  !table->no_keyread)
         table->set_keyread(TRUE);
+      if (tab->type != JT_CONST)
+        push_index_cond(tab, tab->ref.key, TRUE);
       break;
     case JT_ALL:
       /*
@@ -6991,6 +7315,17 @@ make_join_readinfo(JOIN *join, ulonglong options)
 	    tab->type=JT_NEXT;		// Read with index_first / index_next
 	  }
 	}
+        /*
+          The join buffer checks the buffered rows against select->cond
+          only after the range scan, when the columns of the preceding
+          tables no longer hold the values the scan was filtered with.
+        */
+        if (tab->select && tab->select->quick &&
+            tab->select->quick->get_type() ==
+            QUICK_SELECT_I::QS_TYPE_RANGE &&
+            (i == join->const_tables ||
+             tab[-1].next_select != sub_select_cache))
+          push_index_cond(tab, tab->select->quick->index, TRUE);
       }
       break;
     case JT_FT:
@@ -14106,6 +14441,8 @@ skipped_filesort:
     delete save_quick;
     save_quick= NULL;
   }
+  if (!no_changes)
+    revise_index_cond(tab);
   DBUG_RETURN(1);
 
 use_filesort:
@@ -14115,6 +14452,8 @@ use_filesort:
     delete select->quick;
     select->quick= save_quick;
   }
+  if (!no_changes)
+    revise_index_cond(tab);
   DBUG_RETURN(0);
 }
 
@@ -17118,7 +17457,13 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
           {
             const COND *pushed_cond= tab->table->file->pushed_cond;
 
-            if ((thd->variables.optimizer_switch &
+            if (table->file->pushed_idx_cond)
+            {
+              extra.append(STRING_WITH_LEN("; Using index condition"));
+              if (tab->select_cond)
+                extra.append(STRING_WITH_LEN("; Using where"));
+            }
+            else if ((thd->variables.optimizer_switch &
                  OPTIMIZER_SWITCH_ENGINE_CONDITION_PUSHDOWN) && pushed_cond)
             {
               extra.append(STRING_WITH_LEN("; Using where with pushed "
@@ -17132,6 +17477,10 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
             else
               extra.append(STRING_WITH_LEN("; Using where"));
           }
+          if (quick_type == QUICK_SELECT_I::QS_TYPE_RANGE &&
+              table->file->use_disk_sweep_mrr(tab->select->quick->index,
+                                              tab->select->quick->sorted))
+            extra.append(STRING_WITH_LEN("; Using MRR"));
 	}
         if (table_list->schema_table &&
             table_list->schema_table->i_s_requested_object & OPTIMIZE_I_S_TABLE)
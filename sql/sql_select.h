@@ -175,6 +175,13 @@ typedef struct st_join_table {
   */
   SQL_SELECT    *saved_select;
   COND		*select_cond;
+  /**
+    The condition on the rows of this table before a part of it was
+    pushed down to the storage engine as an index condition, or NULL if
+    no index condition was pushed down. select_cond is the remainder
+    that still has to be checked; select->cond keeps the full condition.
+  */
+  COND		*pre_idx_push_select_cond;
   QUICK_SELECT_I *quick;
   Item	       **on_expr_ref;   /**< pointer to the associated on expression   */
   COND_EQUAL    *cond_equal;    /**< multiple equalities for the on expression */
@@ -5748,6 +5748,7 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
   bool partition_changed= FALSE;
 #endif
   bool need_lock_for_indexes= TRUE;
+  bool online_add_index= FALSE;
   KEY  *key_info_buffer;
   uint index_drop_count= 0;
   uint *index_drop_buffer= NULL;
@@ -6358,6 +6359,13 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
         /* All required in-place flags to allow concurrent reads are present. */
         need_copy_table= ALTER_TABLE_METADATA_ONLY;
         need_lock_for_indexes= FALSE;
+        /*
+          If only non-unique secondary indexes are added, the handler may
+          also allow concurrent writes while it creates them.
+        */
+        if (needed_inplace_with_read_flags == HA_INPLACE_ADD_INDEX_NO_WRITE &&
+            (alter_flags & HA_INPLACE_ADD_INDEX_ONLINE))
+          online_add_index= TRUE;
       }
       else if ((alter_flags & needed_inplace_flags) == needed_inplace_flags)
       {
@@ -6577,6 +6585,15 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
         for (key_part= key->key_part; key_part < part_end; key_part++)
           key_part->field= table->field[key_part->fieldnr];
       }
+      /*
+        Allow concurrent writes while the indexes are being created
+        online. The metadata lock is upgraded to exclusive before the
+        index creation is finalized.
+      */
+      if (online_add_index && !need_lock_for_indexes &&
+          !table->s->tmp_table && thd->locked_tables_mode == LTM_NONE &&
+          table->mdl_ticket->get_type() == MDL_SHARED_NO_WRITE)
+        table->mdl_ticket->downgrade_shared_no_write_lock();
       /* Add the indexes. */
       if ((error= table->file->add_index(table, key_info, index_add_count,
                                          &add)))
@@ -6960,6 +6977,16 @@ end_temporary:
   DBUG_RETURN(FALSE);
 
 err_new_table_cleanup:
+  if (pending_inplace_add_index)
+  {
+    /*
+      Do not leave indexes that are being created online behind, as
+      concurrent writes would keep logging their modifications.
+    */
+    pending_inplace_add_index= false;
+    table->file->final_add_index(add, false);
+    table->m_needs_reopen= true;
+  }
   if (new_table)
   {
     /* close_temporary_table() frees the new_table pointer. */
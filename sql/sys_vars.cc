@@ -452,6 +452,15 @@ static Sys_var_mybool Sys_binlog_direct(
        CMD_LINE(OPT_ARG), DEFAULT(FALSE),
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(binlog_direct_check));
 
+static Sys_var_mybool Sys_binlog_order_commits(
+       "binlog_order_commits",
+       "Issue storage engine commits in the same order as the transactions "
+       "are written to the binary log by the binlog group commit. Disabling "
+       "this lets engines commit the members of a group concurrently, but "
+       "the commit order of the engines may then differ from the binary log.",
+       GLOBAL_VAR(opt_binlog_order_commits),
+       CMD_LINE(OPT_ARG), DEFAULT(TRUE));
+
 static Sys_var_mybool Sys_binlog_rows_table_metadata(
        "binlog_rows_table_metadata_events",
        "Write Table_metadata events to the binary log.",
@@ -1531,6 +1540,7 @@ static const char *optimizer_switch_names[]=
 {
   "index_merge", "index_merge_union", "index_merge_sort_union",
   "index_merge_intersection", "engine_condition_pushdown",
+  "index_condition_pushdown", "mrr",
   "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
@@ -1546,7 +1556,8 @@ static Sys_var_flagset Sys_optimizer_switch(
        "optimizer_switch",
        "optimizer_switch=option=val[,option=val...], where option is one of "
        "{index_merge, index_merge_union, index_merge_sort_union, "
-       "index_merge_intersection, engine_condition_pushdown}"
+       "index_merge_intersection, engine_condition_pushdown, "
+       "index_condition_pushdown, mrr}"
        " and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
@@ -1737,6 +1748,14 @@ static Sys_var_ulong Sys_multi_range_count(
        SESSION_VAR(multi_range_count), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, ULONG_MAX), DEFAULT(256), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_mrr_buff_size(
+       "mrr_buffer_size",
+       "When the rows of a range scan on a secondary index are read in "
+       "primary key order (optimizer_switch mrr), the row references are "
+       "collected and sorted in this buffer",
+       SESSION_VAR(mrr_buff_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(8192, INT_MAX32), DEFAULT(256*1024), BLOCK_SIZE(1));
+
 static bool fix_thd_mem_root(sys_var *self, THD *thd, enum_var_type type)
 {
   if (type != OPT_GLOBAL)
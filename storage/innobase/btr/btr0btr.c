@@ -1614,10 +1614,15 @@ btr_page_reorganize_low(
 	max_ins_size1 = page_get_max_insert_size_after_reorganize(page, 1);
 
 #ifndef UNIV_HOTBACKUP
-	/* Write the log record */
-	mlog_open_and_write_index(mtr, page, index, page_is_comp(page)
-				  ? MLOG_COMP_PAGE_REORGANIZE
-				  : MLOG_PAGE_REORGANIZE, 0);
+	/* Write the log record. A compressed page is logged as the
+	compressed page image after the reorganization instead, because
+	recovery cannot rely on recompressing the page with the same
+	result: innodb_compression_level may have changed. */
+	if (!page_zip) {
+		mlog_open_and_write_index(mtr, page, index, page_is_comp(page)
+					  ? MLOG_COMP_PAGE_REORGANIZE
+					  : MLOG_PAGE_REORGANIZE, 0);
+	}
 #endif /* !UNIV_HOTBACKUP */
 
 	/* Turn logging off */
@@ -1665,9 +1670,13 @@ btr_page_reorganize_low(
 		ut_ad(max_trx_id != 0 || recovery);
 	}
 
+	/* Log the compressed page image. If the compression fails,
+	the page is restored and nothing is logged. */
+	mtr_set_log_mode(mtr, log_mode);
+
 	if (UNIV_LIKELY_NULL(page_zip)
 	    && UNIV_UNLIKELY
-	    (!page_zip_compress(page_zip, page, index, NULL))) {
+	    (!page_zip_compress(page_zip, page, index, mtr))) {
 
 		/* Restore the old page and exit. */
 		btr_blob_dbg_restore(page, temp_page, index,
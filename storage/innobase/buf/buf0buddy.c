@@ -125,6 +125,16 @@ buf_buddy_alloc_zip(
 
 	bpage = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
 
+	if (UNIV_UNLIKELY(buf_pool_withdrawing(buf_pool))) {
+		/* Do not allocate from the frames that are going to be
+		removed by buf_pool_resize(). */
+		while (bpage != NULL
+		       && buf_frame_will_be_withdrawn(buf_pool,
+						      (byte*) bpage)) {
+			bpage = UT_LIST_GET_NEXT(list, bpage);
+		}
+	}
+
 	if (bpage) {
 		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_ZIP_FREE);
 
@@ -453,8 +463,12 @@ recombine:
 
 	/* Do not recombine blocks if there are few free blocks.
 	We may waste up to 15360*max_len bytes to free blocks
-	(1024 + 2048 + 4096 + 8192 = 15360) */
-	if (UT_LIST_GET_LEN(buf_pool->zip_free[i]) < 16) {
+	(1024 + 2048 + 4096 + 8192 = 15360).  Always recombine the
+	blocks in a frame that is being withdrawn, so that the
+	frame can be freed. */
+	if (UT_LIST_GET_LEN(buf_pool->zip_free[i]) < 16
+	    && (!buf_pool_withdrawing(buf_pool)
+		|| !buf_frame_will_be_withdrawn(buf_pool, (byte*) buf))) {
 		goto func_exit;
 	}
 
@@ -503,7 +517,9 @@ buddy_nonfree:
 	/* The buddy is not free. Is there a free block of this size? */
 	bpage = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
 
-	if (bpage) {
+	if (bpage
+	    && (!buf_pool_withdrawing(buf_pool)
+		|| !buf_frame_will_be_withdrawn(buf_pool, (byte*) bpage))) {
 
 		/* Remove the block from the free list, because a successful
 		buf_buddy_relocate() will overwrite bpage->list. */
@@ -529,3 +545,159 @@ func_exit:
 	bpage->state = BUF_BLOCK_ZIP_FREE;
 	buf_buddy_add_to_free(buf_pool, bpage, i);
 }
+
+/**********************************************************************//**
+Merges the free blocks of the buddy allocator that reside in the frames
+that the ongoing shrink of the buffer pool is going to remove with their
+free buddies, so that the frames that hold no compressed pages are
+returned to the buffer pool.  The caller must hold buf_pool->mutex. */
+UNIV_INTERN
+void
+buf_buddy_condense_free(
+/*====================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	ulint	i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	for (i = buf_buddy_get_slot(PAGE_ZIP_MIN_SIZE);
+	     i < BUF_BUDDY_SIZES; i++) {
+		buf_page_t*	bpage;
+
+		bpage = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
+
+		while (bpage != NULL) {
+			buf_page_t*	next = UT_LIST_GET_NEXT(list, bpage);
+			buf_page_t*	buddy;
+			buf_page_t*	b;
+
+			if (!buf_frame_will_be_withdrawn(buf_pool,
+							 (byte*) bpage)) {
+				bpage = next;
+				continue;
+			}
+
+			buddy = (buf_page_t*) buf_buddy_get(
+				(byte*) bpage, BUF_BUDDY_LOW << i);
+
+			for (b = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
+			     b != NULL && b != buddy;
+			     b = UT_LIST_GET_NEXT(list, b)) {
+			}
+
+			if (b == NULL) {
+				bpage = next;
+				continue;
+			}
+
+			/* Free the block again, so that
+			buf_buddy_free_low() recombines it with its
+			buddy.  This shortens the list, so starting
+			over terminates. */
+			buf_buddy_remove_from_free(buf_pool, bpage, i);
+			buf_pool->buddy_stat[i].used++;
+			buf_buddy_free_low(buf_pool, bpage, i);
+
+			bpage = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
+		}
+	}
+}
+
+/**********************************************************************//**
+Relocates the compressed pages that are allocated from the frame of a
+block that is being withdrawn from the buffer pool to other frames, so
+that the frame is returned to the buffer pool.  Does nothing if the
+block does not belong to the buddy allocator.  The caller must hold
+buf_pool->mutex, which is not released.
+@return	TRUE if a compressed page could not be relocated for the lack
+of a free block */
+UNIV_INTERN
+ibool
+buf_buddy_withdraw_block(
+/*=====================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	buf_block_t*	block)		/*!< in: block in state
+					BUF_BLOCK_MEMORY */
+{
+	const ulint	fold	= BUF_POOL_ZIP_FOLD(block);
+	buf_page_t*	bpage;
+	ulint		offs;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+	ut_ad(!mutex_own(&buf_pool->zip_mutex));
+	ut_ad(buf_block_get_state(block) == BUF_BLOCK_MEMORY);
+
+	/* Only the frames of the buddy allocator are in zip_hash. */
+	HASH_SEARCH(hash, buf_pool->zip_hash, fold, buf_page_t*, bpage,
+		    ut_ad(buf_page_get_state(bpage) == BUF_BLOCK_MEMORY
+			  && bpage->in_zip_hash && !bpage->in_page_hash),
+		    bpage == &block->page);
+
+	if (bpage == NULL) {
+
+		return(FALSE);
+	}
+
+	/* Look for the compressed pages in the frame like
+	buf_buddy_relocate() does. */
+	for (offs = 0; offs < UNIV_PAGE_SIZE; offs += PAGE_ZIP_MIN_SIZE) {
+		byte*	src	= block->frame + offs;
+		void*	dst	= NULL;
+		ulint	space;
+		ulint	page_no;
+		ulint	i;
+
+		space = mach_read_from_4(src
+					 + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+		page_no = mach_read_from_4(src + FIL_PAGE_OFFSET);
+		UNIV_MEM_VALID(&space, sizeof space);
+		UNIV_MEM_VALID(&page_no, sizeof page_no);
+
+		bpage = buf_page_hash_get(buf_pool, space, page_no);
+
+		if (bpage == NULL || bpage->zip.data != src) {
+			continue;
+		}
+
+		i = buf_buddy_get_slot(page_zip_get_size(&bpage->zip));
+
+		if (i < BUF_BUDDY_SIZES) {
+			dst = buf_buddy_alloc_zip(buf_pool, i);
+		}
+
+		if (dst == NULL) {
+			buf_block_t*	new_block;
+
+			new_block = buf_LRU_get_free_only(buf_pool);
+
+			if (new_block == NULL) {
+
+				return(TRUE);
+			}
+
+			buf_buddy_block_register(new_block);
+
+			dst = buf_buddy_alloc_from(
+				buf_pool, new_block->frame, i,
+				BUF_BUDDY_SIZES);
+		}
+
+		buf_pool->buddy_stat[i].used++;
+
+		if (!buf_buddy_relocate(buf_pool, src, dst, i)) {
+			/* The page is fixed; retry in the next round. */
+			buf_buddy_free_low(buf_pool, dst, i);
+			continue;
+		}
+
+		buf_buddy_free_low(buf_pool, src, i);
+
+		if (buf_block_get_state(block) != BUF_BLOCK_MEMORY) {
+			/* The frame was freed to the withdraw list. */
+			break;
+		}
+	}
+
+	return(FALSE);
+}
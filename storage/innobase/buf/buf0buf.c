@@ -48,9 +48,13 @@ Created 11/5/1995 Heikki Tuuri
 #include "log0log.h"
 #endif /* !UNIV_HOTBACKUP */
 #include "srv0srv.h"
+#ifndef UNIV_HOTBACKUP
+#include "srv0start.h"
+#endif /* !UNIV_HOTBACKUP */
 #include "dict0dict.h"
 #include "log0recv.h"
 #include "page0zip.h"
+#include "ut0crc32.h"
 
 /*
 		IMPLEMENTATION OF THE BUFFER POOL
@@ -249,6 +253,20 @@ static const ulint BUF_PAGE_READ_MAX_RETRIES = 100;
 /** The buffer pools of the database */
 UNIV_INTERN buf_pool_t*	buf_pool_ptr;
 
+/** Incremented every time the buffer pool is shrunk, see
+buf_pool_is_obsolete() */
+UNIV_INTERN volatile ulint	buf_withdraw_clock;
+
+/** Status message of the last or currently running buffer pool resize */
+static char	buf_resize_status_str[BUF_RESIZE_STATUS_LEN];
+
+/** Interval between the rounds of withdrawing blocks, in microseconds */
+#define BUF_WITHDRAW_RETRY_INTERVAL	100000
+
+/** Number of rounds of withdrawing blocks between the progress messages
+that are printed to the error log */
+#define BUF_WITHDRAW_LOG_INTERVAL	150
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 static ulint	buf_dbg_counter	= 0; /*!< This is used to insert validation
 					operations in execution in the
@@ -511,6 +529,138 @@ buf_calc_page_old_checksum(
 	return(checksum);
 }
 
+/********************************************************************//**
+Calculates a page CRC32 which is stored to the page when it is written
+to a file. Note that we must be careful to calculate the same value on
+32-bit and 64-bit architectures.
+@return	checksum */
+UNIV_INTERN
+ib_uint32_t
+buf_calc_page_crc32(
+/*================*/
+	const byte*	page)	/*!< in: buffer page */
+{
+	ib_uint32_t	checksum;
+
+	/* Since the field FIL_PAGE_FILE_FLUSH_LSN, and in versions <= 4.1.x
+	FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID, are written outside the buffer pool
+	to the first pages of data files, we have to skip them in the page
+	checksum calculation.
+	We must also skip the field FIL_PAGE_SPACE_OR_CHKSUM where the
+	checksum is stored, and also the last 8 bytes of page because
+	there we store the old formula checksum. */
+
+	checksum = ut_crc32(page + FIL_PAGE_OFFSET,
+			    FIL_PAGE_FILE_FLUSH_LSN - FIL_PAGE_OFFSET)
+		^ ut_crc32(page + FIL_PAGE_DATA,
+			   UNIV_PAGE_SIZE - FIL_PAGE_DATA
+			   - FIL_PAGE_END_LSN_OLD_CHKSUM);
+
+	return(checksum);
+}
+
+/********************************************************************//**
+Return a printable string describing the checksum algorithm.
+@return	algorithm name */
+UNIV_INTERN
+const char*
+buf_checksum_algorithm_name(
+/*========================*/
+	srv_checksum_algorithm_t	algo)	/*!< in: algorithm */
+{
+	switch (algo) {
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_CRC32:
+		return("crc32");
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_INNODB:
+		return("innodb");
+	case SRV_CHECKSUM_ALGORITHM_NONE:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_NONE:
+		return("none");
+	}
+
+	ut_error;
+	return(NULL);
+}
+
+/********************************************************************//**
+Checks if the checksum fields of a page hold the crc32 checksum, which
+is stored both to FIL_PAGE_SPACE_OR_CHKSUM and to the old formula
+checksum field at the end of the page.
+@return TRUE if the page has a valid crc32 checksum */
+UNIV_INLINE
+ibool
+buf_page_is_checksum_valid_crc32(
+/*=============================*/
+	const byte*	read_buf,		/*!< in: a database page */
+	ulint		checksum_field1,	/*!< in: new checksum field */
+	ulint		checksum_field2)	/*!< in: old checksum field */
+{
+	ib_uint32_t	crc32;
+
+	if (checksum_field1 != checksum_field2) {
+		return(FALSE);
+	}
+
+	crc32 = buf_calc_page_crc32(read_buf);
+
+	return(checksum_field1 == crc32);
+}
+
+/********************************************************************//**
+Checks if the checksum fields of a page hold the innodb checksums, or
+values written by versions of InnoDB that predate them.
+@return TRUE if the page has valid innodb checksums */
+UNIV_INLINE
+ibool
+buf_page_is_checksum_valid_innodb(
+/*==============================*/
+	const byte*	read_buf,		/*!< in: a database page */
+	ulint		checksum_field1,	/*!< in: new checksum field */
+	ulint		checksum_field2)	/*!< in: old checksum field */
+{
+	/* There are 2 valid formulas for old_checksum_field:
+
+	1. Very old versions of InnoDB only stored 8 byte lsn to the
+	start and the end of the page.
+
+	2. Newer InnoDB versions store the old formula checksum
+	there. */
+
+	if (checksum_field2 != mach_read_from_4(read_buf + FIL_PAGE_LSN)
+	    && checksum_field2 != buf_calc_page_old_checksum(read_buf)) {
+
+		return(FALSE);
+	}
+
+	/* InnoDB versions < 4.0.14 and < 4.1.1 stored the space id
+	(always equal to 0), to FIL_PAGE_SPACE_OR_CHKSUM */
+
+	if (checksum_field1 != 0
+	    && checksum_field1 != buf_calc_page_new_checksum(read_buf)) {
+
+		return(FALSE);
+	}
+
+	return(TRUE);
+}
+
+/********************************************************************//**
+Checks if the checksum fields of a page hold the values which are stored
+when checksums are disabled.
+@return TRUE if the page was written with checksums disabled */
+UNIV_INLINE
+ibool
+buf_page_is_checksum_valid_none(
+/*============================*/
+	ulint		checksum_field1,	/*!< in: new checksum field */
+	ulint		checksum_field2)	/*!< in: old checksum field */
+{
+	return(checksum_field1 == BUF_NO_CHECKSUM_MAGIC
+	       && checksum_field2 == BUF_NO_CHECKSUM_MAGIC);
+}
+
 /********************************************************************//**
 Checks if a page is corrupt.
 @return	TRUE if corrupted */
@@ -522,8 +672,9 @@ buf_page_is_corrupted(
 	ulint		zip_size)	/*!< in: size of compressed page;
 					0 for uncompressed pages */
 {
-	ulint		checksum_field;
-	ulint		old_checksum_field;
+	ulint		checksum_field1;
+	ulint		checksum_field2;
+	ibool		ok;
 
 	if (UNIV_LIKELY(!zip_size)
 	    && memcmp(read_buf + FIL_PAGE_LSN + 4,
@@ -565,55 +716,67 @@ buf_page_is_corrupted(
 	}
 #endif
 
-	/* If we use checksums validation, make additional check before
-	returning TRUE to ensure that the checksum is not equal to
-	BUF_NO_CHECKSUM_MAGIC which might be stored by InnoDB with checksums
-	disabled. Otherwise, skip checksum calculation and return FALSE */
+	/* With innodb_checksum_algorithm=none (or innodb_checksums=OFF)
+	skip the checksum verification altogether. */
 
-	if (UNIV_LIKELY(srv_use_checksums)) {
-		checksum_field = mach_read_from_4(read_buf
-						  + FIL_PAGE_SPACE_OR_CHKSUM);
+	if (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_NONE) {
 
-		if (UNIV_UNLIKELY(zip_size)) {
-			if (checksum_field != BUF_NO_CHECKSUM_MAGIC
-			    && checksum_field
-			    != page_zip_calc_checksum(read_buf, zip_size))
-				goto corrupted;
+		return(FALSE);
+	}
 
-			return(FALSE);
+	if (UNIV_UNLIKELY(zip_size)) {
+		if (!page_zip_verify_checksum(read_buf, zip_size)) {
+			goto corrupted;
 		}
 
-		old_checksum_field = mach_read_from_4(
-			read_buf + UNIV_PAGE_SIZE
-			- FIL_PAGE_END_LSN_OLD_CHKSUM);
-
-		/* There are 2 valid formulas for old_checksum_field:
-
-		1. Very old versions of InnoDB only stored 8 byte lsn to the
-		start and the end of the page.
-
-		2. Newer InnoDB versions store the old formula checksum
-		there. */
+		return(FALSE);
+	}
 
-		if (old_checksum_field != mach_read_from_4(read_buf
-							   + FIL_PAGE_LSN)
-		    && old_checksum_field != BUF_NO_CHECKSUM_MAGIC
-		    && old_checksum_field
-		    != buf_calc_page_old_checksum(read_buf)) {
+	checksum_field1 = mach_read_from_4(
+		read_buf + FIL_PAGE_SPACE_OR_CHKSUM);
 
-			goto corrupted;
-		}
+	checksum_field2 = mach_read_from_4(
+		read_buf + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM);
 
-		/* InnoDB versions < 4.0.14 and < 4.1.1 stored the space id
-		(always equal to 0), to FIL_PAGE_SPACE_OR_CHKSUM */
+	/* The strict variants only accept the configured algorithm.
+	The others accept any algorithm, so that pages written with
+	another setting keep working, but try the configured one
+	first as it is the most likely to match. */
 
-		if (checksum_field != 0
-		    && checksum_field != BUF_NO_CHECKSUM_MAGIC
-		    && checksum_field
-		    != buf_calc_page_new_checksum(read_buf)) {
+	switch ((srv_checksum_algorithm_t) srv_checksum_algorithm) {
+	case SRV_CHECKSUM_ALGORITHM_STRICT_CRC32:
+		ok = buf_page_is_checksum_valid_crc32(
+			read_buf, checksum_field1, checksum_field2);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_STRICT_INNODB:
+		ok = buf_page_is_checksum_valid_innodb(
+			read_buf, checksum_field1, checksum_field2);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_STRICT_NONE:
+		ok = buf_page_is_checksum_valid_none(
+			checksum_field1, checksum_field2);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+		ok = buf_page_is_checksum_valid_crc32(
+			read_buf, checksum_field1, checksum_field2)
+			|| buf_page_is_checksum_valid_none(
+				checksum_field1, checksum_field2)
+			|| buf_page_is_checksum_valid_innodb(
+				read_buf, checksum_field1, checksum_field2);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+	default:
+		ok = buf_page_is_checksum_valid_innodb(
+			read_buf, checksum_field1, checksum_field2)
+			|| buf_page_is_checksum_valid_none(
+				checksum_field1, checksum_field2)
+			|| buf_page_is_checksum_valid_crc32(
+				read_buf, checksum_field1, checksum_field2);
+		break;
+	}
 
-			goto corrupted;
-		}
+	if (!ok) {
+		goto corrupted;
 	}
 
 #ifndef DBUG_OFF
@@ -675,19 +838,23 @@ buf_page_print(
 		switch (fil_page_get_type(read_buf)) {
 		case FIL_PAGE_TYPE_ZBLOB:
 		case FIL_PAGE_TYPE_ZBLOB2:
-			checksum = srv_use_checksums
-				? page_zip_calc_checksum(read_buf, zip_size)
-				: BUF_NO_CHECKSUM_MAGIC;
+			checksum = page_zip_calc_checksum(
+				read_buf, zip_size,
+				(srv_checksum_algorithm_t)
+				srv_checksum_algorithm);
 			ut_print_timestamp(stderr);
 			fprintf(stderr,
 				"  InnoDB: Compressed BLOB page"
-				" checksum %lu, stored %lu\n"
+				" checksum %lu (%s), stored %lu\n"
 				"InnoDB: Page lsn %lu %lu\n"
 				"InnoDB: Page number (if stored"
 				" to page already) %lu,\n"
 				"InnoDB: space id (if stored"
 				" to page already) %lu\n",
 				(ulong) checksum,
+				buf_checksum_algorithm_name(
+					(srv_checksum_algorithm_t)
+					srv_checksum_algorithm),
 				(ulong) mach_read_from_4(
 					read_buf + FIL_PAGE_SPACE_OR_CHKSUM),
 				(ulong) mach_read_from_4(
@@ -708,13 +875,14 @@ buf_page_print(
 				fil_page_get_type(read_buf));
 			/* fall through */
 		case FIL_PAGE_INDEX:
-			checksum = srv_use_checksums
-				? page_zip_calc_checksum(read_buf, zip_size)
-				: BUF_NO_CHECKSUM_MAGIC;
+			checksum = page_zip_calc_checksum(
+				read_buf, zip_size,
+				(srv_checksum_algorithm_t)
+				srv_checksum_algorithm);
 
 			ut_print_timestamp(stderr);
 			fprintf(stderr,
-				"  InnoDB: Compressed page checksum %lu,"
+				"  InnoDB: Compressed page checksum %lu (%s),"
 				" stored %lu\n"
 				"InnoDB: Page lsn %lu %lu\n"
 				"InnoDB: Page number (if stored"
@@ -722,6 +890,9 @@ buf_page_print(
 				"InnoDB: space id (if stored"
 				" to page already) %lu\n",
 				(ulong) checksum,
+				buf_checksum_algorithm_name(
+					(srv_checksum_algorithm_t)
+					srv_checksum_algorithm),
 				(ulong) mach_read_from_4(
 					read_buf + FIL_PAGE_SPACE_OR_CHKSUM),
 				(ulong) mach_read_from_4(
@@ -740,15 +911,13 @@ buf_page_print(
 		}
 	}
 
-	checksum = srv_use_checksums
-		? buf_calc_page_new_checksum(read_buf) : BUF_NO_CHECKSUM_MAGIC;
-	old_checksum = srv_use_checksums
-		? buf_calc_page_old_checksum(read_buf) : BUF_NO_CHECKSUM_MAGIC;
+	checksum = buf_calc_page_new_checksum(read_buf);
+	old_checksum = buf_calc_page_old_checksum(read_buf);
 
 	ut_print_timestamp(stderr);
 	fprintf(stderr,
-		"  InnoDB: Page checksum %lu, prior-to-4.0.14-form"
-		" checksum %lu\n"
+		"  InnoDB: Page checksum %lu (innodb), crc32 checksum %lu,"
+		" prior-to-4.0.14-form checksum %lu\n"
 		"InnoDB: stored checksum %lu, prior-to-4.0.14-form"
 		" stored checksum %lu\n"
 		"InnoDB: Page lsn %lu %lu, low 4 bytes of lsn"
@@ -756,7 +925,8 @@ buf_page_print(
 		"InnoDB: Page number (if stored to page already) %lu,\n"
 		"InnoDB: space id (if created with >= MySQL-4.1.1"
 		" and stored already) %lu\n",
-		(ulong) checksum, (ulong) old_checksum,
+		(ulong) checksum, (ulong) buf_calc_page_crc32(read_buf),
+		(ulong) old_checksum,
 		(ulong) mach_read_from_4(read_buf + FIL_PAGE_SPACE_OR_CHKSUM),
 		(ulong) mach_read_from_4(read_buf + UNIV_PAGE_SIZE
 					 - FIL_PAGE_END_LSN_OLD_CHKSUM),
@@ -1038,10 +1208,6 @@ buf_chunk_init(
 		buf_block_init(buf_pool, block, frame);
 		UNIV_MEM_INVALID(block->frame, UNIV_PAGE_SIZE);
 
-		/* Add the block to the free list */
-		UT_LIST_ADD_LAST(list, buf_pool->free, (&block->page));
-
-		ut_d(block->page.in_free_list = TRUE);
 		ut_ad(buf_pool_from_block(block) == buf_pool);
 
 		block++;
@@ -1054,6 +1220,54 @@ buf_chunk_init(
 	return(chunk);
 }
 
+/********************************************************************//**
+Adds the blocks of a chunk that was initialized by buf_chunk_init()
+to the free list of the buffer pool instance. */
+static
+void
+buf_chunk_add_free(
+/*===============*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	buf_chunk_t*	chunk)		/*!< in: chunk of buffers */
+{
+	buf_block_t*	block;
+	ulint		i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	block = chunk->blocks;
+
+	for (i = chunk->size; i--; block++) {
+		UT_LIST_ADD_LAST(list, buf_pool->free, (&block->page));
+		ut_d(block->page.in_free_list = TRUE);
+	}
+}
+
+/********************************************************************//**
+Frees the latches of the blocks of a chunk and the memory of the chunk.
+None of the blocks may be in use. */
+static
+void
+buf_chunk_free(
+/*===========*/
+	buf_chunk_t*	chunk)	/*!< in/out: chunk of buffers */
+{
+	buf_block_t*	block;
+	ulint		i;
+
+	block = chunk->blocks;
+
+	for (i = chunk->size; i--; block++) {
+		mutex_free(&block->mutex);
+		rw_lock_free(&block->lock);
+#ifdef UNIV_SYNC_DEBUG
+		rw_lock_free(&block->debug_latch);
+#endif /* UNIV_SYNC_DEBUG */
+	}
+
+	os_mem_free_large(chunk->mem, chunk->mem_size);
+}
+
 #ifdef UNIV_DEBUG
 /*********************************************************************//**
 Finds a block in the given buffer chunk that points to a
@@ -1209,23 +1423,46 @@ buf_pool_init_instance(
 	buf_pool_mutex_enter(buf_pool);
 
 	if (buf_pool_size > 0) {
-		buf_pool->n_chunks = 1;
-		buf_pool->chunks = chunk = mem_zalloc(sizeof *chunk);
+		ulint	n_chunks;
+
+		/* The instance is allocated in chunks of
+		srv_buf_pool_chunk_unit bytes, so that it can be
+		resized online by adding and removing chunks. */
+		ut_ad(srv_buf_pool_chunk_unit > 0);
+		n_chunks = ut_max(buf_pool_size / srv_buf_pool_chunk_unit, 1);
+
+		buf_pool->n_chunks = buf_pool->n_chunks_new = n_chunks;
+		buf_pool->chunks = mem_zalloc(n_chunks * sizeof *chunk);
 
 		UT_LIST_INIT(buf_pool->free);
+		UT_LIST_INIT(buf_pool->withdraw);
 
-		if (!buf_chunk_init(buf_pool, chunk, buf_pool_size, populate)) {
-			mem_free(chunk);
-			mem_free(buf_pool);
+		buf_pool->curr_size = 0;
 
-			buf_pool_mutex_exit(buf_pool);
+		for (chunk = buf_pool->chunks;
+		     chunk < buf_pool->chunks + n_chunks; chunk++) {
 
-			return(DB_ERROR);
+			if (!buf_chunk_init(buf_pool, chunk,
+					    srv_buf_pool_chunk_unit,
+					    populate)) {
+
+				while (--chunk >= buf_pool->chunks) {
+					buf_chunk_free(chunk);
+				}
+
+				buf_pool_mutex_exit(buf_pool);
+
+				mem_free(buf_pool->chunks);
+
+				return(DB_ERROR);
+			}
+
+			buf_chunk_add_free(buf_pool, chunk);
+			buf_pool->curr_size += chunk->size;
 		}
 
 		buf_pool->instance_no = instance_no;
 		buf_pool->old_pool_size = buf_pool_size;
-		buf_pool->curr_size = chunk->size;
 		buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
 
 		buf_pool->page_hash = hash_create(2 * buf_pool->curr_size);
@@ -1293,6 +1530,11 @@ buf_pool_free_instance(
 	}
 
 	mem_free(buf_pool->chunks);
+
+	if (buf_pool->chunks_old != NULL) {
+		mem_free(buf_pool->chunks_old);
+	}
+
 	hash_table_free(buf_pool->page_hash);
 	hash_table_free(buf_pool->zip_hash);
 }
@@ -1369,7 +1611,7 @@ buf_pool_clear_hash_index(void)
 	ulint	p;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(btr_search_own_all(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(!btr_search_enabled);
 
@@ -1386,7 +1628,8 @@ buf_pool_clear_hash_index(void)
 				dict_index_t*	index	= block->index;
 
 				/* We can set block->index = NULL
-				when we have an x-latch on btr_search_latch;
+				when we have x-latched all the
+				btr_search_latches;
 				see the comment in buf0buf.h */
 
 				if (!index) {
@@ -1413,7 +1656,9 @@ buf_relocate(
 /*=========*/
 	buf_page_t*	bpage,	/*!< in/out: control block being relocated;
 				buf_page_get_state(bpage) must be
-				BUF_BLOCK_ZIP_DIRTY or BUF_BLOCK_ZIP_PAGE */
+				BUF_BLOCK_ZIP_DIRTY or BUF_BLOCK_ZIP_PAGE,
+				or BUF_BLOCK_FILE_PAGE when the block is
+				being withdrawn by a buffer pool resize */
 	buf_page_t*	dpage)	/*!< in/out: destination control block */
 {
 	buf_page_t*	b;
@@ -1435,10 +1680,13 @@ buf_relocate(
 	case BUF_BLOCK_ZIP_FREE:
 	case BUF_BLOCK_NOT_USED:
 	case BUF_BLOCK_READY_FOR_USE:
-	case BUF_BLOCK_FILE_PAGE:
 	case BUF_BLOCK_MEMORY:
 	case BUF_BLOCK_REMOVE_HASH:
 		ut_error;
+	case BUF_BLOCK_FILE_PAGE:
+		ut_ad(buf_block_will_be_withdrawn(
+			      buf_pool, (buf_block_t*) bpage));
+		break;
 	case BUF_BLOCK_ZIP_DIRTY:
 	case BUF_BLOCK_ZIP_PAGE:
 		break;
@@ -1487,6 +1735,759 @@ buf_relocate(
 	HASH_INSERT(buf_page_t, hash, buf_pool->page_hash, fold, dpage);
 }
 
+/********************************************************************//**
+Rounds a buffer pool size up to a multiple of the chunk size times the
+number of buffer pool instances, the granularity in which the buffer
+pool is allocated and resized.
+@return	aligned size in bytes */
+UNIV_INTERN
+ulint
+buf_pool_size_align(
+/*================*/
+	ulint	size)	/*!< in: size in bytes */
+{
+	const ulint	unit = srv_buf_pool_chunk_unit
+		* srv_buf_pool_instances;
+
+	if (size % unit == 0) {
+
+		return(size);
+	}
+
+	return((size / unit + 1) * unit);
+}
+
+/********************************************************************//**
+Determines if a block belongs to a chunk that the ongoing shrink of the
+buffer pool is going to remove.
+@return	TRUE if the block will be withdrawn */
+UNIV_INTERN
+ibool
+buf_block_will_be_withdrawn(
+/*========================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block)		/*!< in: block in buf_pool */
+{
+	const buf_chunk_t*	chunk;
+	const buf_chunk_t*	echunk;
+
+	chunk = buf_pool->chunks + buf_pool->n_chunks_new;
+	echunk = buf_pool->chunks + buf_pool->n_chunks;
+
+	for (; chunk < echunk; chunk++) {
+		if (block >= chunk->blocks
+		    && block < chunk->blocks + chunk->size) {
+
+			return(TRUE);
+		}
+	}
+
+	return(FALSE);
+}
+
+/********************************************************************//**
+Determines if a frame belongs to a chunk that the ongoing shrink of the
+buffer pool is going to remove.
+@return	TRUE if the frame will be withdrawn */
+UNIV_INTERN
+ibool
+buf_frame_will_be_withdrawn(
+/*========================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*	ptr)		/*!< in: pointer into a frame */
+{
+	const buf_chunk_t*	chunk;
+	const buf_chunk_t*	echunk;
+
+	chunk = buf_pool->chunks + buf_pool->n_chunks_new;
+	echunk = buf_pool->chunks + buf_pool->n_chunks;
+
+	for (; chunk < echunk; chunk++) {
+		if (ptr >= chunk->blocks->frame
+		    && ptr < chunk->blocks->frame
+		    + chunk->size * UNIV_PAGE_SIZE) {
+
+			return(TRUE);
+		}
+	}
+
+	return(FALSE);
+}
+
+/********************************************************************//**
+Copies the current buffer pool resize status message into the given
+buffer, which must be at least BUF_RESIZE_STATUS_LEN bytes. */
+UNIV_INTERN
+void
+buf_resize_status_get(
+/*==================*/
+	char*	status)	/*!< out: resize status message */
+{
+	/* The message is only modified by the resize thread and always
+	remains NUL-terminated, a torn read is harmless. */
+	ut_strlcpy(status, buf_resize_status_str, BUF_RESIZE_STATUS_LEN);
+}
+
+/********************************************************************//**
+Sets the global variable that feeds MySQL's
+innodb_buffer_pool_resize_status to the specified string and optionally
+prints it to the error log. The format and the following parameters are
+the same as the ones used for printf(3). */
+static
+void
+buf_resize_status(
+/*==============*/
+	ibool		print,	/*!< in: whether to print the message
+				to the error log */
+	const char*	fmt,	/*!< in: format */
+	...)			/*!< in: extra parameters according
+				to fmt */
+{
+	va_list	ap;
+	char	msg[BUF_RESIZE_STATUS_LEN];
+
+	va_start(ap, fmt);
+#ifdef __WIN__
+	_vsnprintf(msg, sizeof(msg), fmt, ap);
+#else
+	vsnprintf(msg, sizeof(msg), fmt, ap);
+#endif /* __WIN__ */
+	va_end(ap);
+	msg[sizeof(msg) - 1] = '\0';
+
+	/* Keep the status NUL-terminated at all times, it can be read
+	concurrently by SHOW STATUS. */
+	buf_resize_status_str[BUF_RESIZE_STATUS_LEN - 1] = '\0';
+	memcpy(buf_resize_status_str, msg, BUF_RESIZE_STATUS_LEN - 1);
+
+	if (print) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr, " InnoDB: %s\n", msg);
+	}
+}
+
+/********************************************************************//**
+Moves the file page in a block that is being withdrawn to a free block,
+keeping its position in the LRU, unzip_LRU and flush lists.  The old
+block is freed, which puts it to the withdraw list.  Pages that are
+buffer-fixed or I/O-fixed are skipped; they are retried in the next
+round of buf_pool_withdraw_blocks().
+@return	TRUE if the page could not be moved for the lack of a free block */
+static
+ibool
+buf_page_realloc(
+/*=============*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	buf_block_t*	block)		/*!< in/out: file page to move */
+{
+	buf_block_t*	new_block;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+	ut_ad(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
+	ut_ad(!btr_search_enabled);
+
+	mutex_enter(&block->mutex);
+
+	if (!buf_page_can_relocate(&block->page) || block->index != NULL) {
+		mutex_exit(&block->mutex);
+
+		return(FALSE);
+	}
+
+	new_block = buf_LRU_get_free_only(buf_pool);
+
+	if (new_block == NULL) {
+		mutex_exit(&block->mutex);
+
+		return(TRUE);
+	}
+
+	ut_ad(!buf_block_will_be_withdrawn(buf_pool, new_block));
+
+	mutex_enter(&new_block->mutex);
+
+	memcpy(new_block->frame, block->frame, UNIV_PAGE_SIZE);
+
+	/* Relocate the LRU list and page_hash, and the state and all
+	the other fields of block->page. */
+	buf_relocate(&block->page, &new_block->page);
+
+	if (buf_page_belongs_to_unzip_LRU(&new_block->page)) {
+		buf_block_t*	prev_block;
+
+		ut_ad(block->in_unzip_LRU_list);
+
+		prev_block = UT_LIST_GET_PREV(unzip_LRU, block);
+		UT_LIST_REMOVE(unzip_LRU, buf_pool->unzip_LRU, block);
+
+		ut_d(block->in_unzip_LRU_list = FALSE);
+		ut_d(new_block->in_unzip_LRU_list = TRUE);
+
+		if (prev_block != NULL) {
+			UT_LIST_INSERT_AFTER(unzip_LRU, buf_pool->unzip_LRU,
+					     prev_block, new_block);
+		} else {
+			UT_LIST_ADD_FIRST(unzip_LRU, buf_pool->unzip_LRU,
+					  new_block);
+		}
+	}
+
+	if (block->page.oldest_modification != 0) {
+		buf_flush_relocate_on_flush_list(&block->page,
+						 &new_block->page);
+	}
+
+	new_block->check_index_page_at_flush
+		= block->check_index_page_at_flush;
+	new_block->lock_hash_val = block->lock_hash_val;
+	new_block->n_hash_helps = 0;
+
+	mutex_exit(&new_block->mutex);
+
+	/* Invalidate the old block like buf_LRU_block_remove_hashed_page()
+	does, and make the optimistic latching of any cursor that still
+	points to it fail. */
+	buf_block_modify_clock_inc(block);
+	memset(block->frame + FIL_PAGE_OFFSET, 0xff, 4);
+	memset(block->frame + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID, 0xff, 4);
+	UNIV_MEM_INVALID(block->frame, UNIV_PAGE_SIZE);
+	buf_block_set_state(block, BUF_BLOCK_REMOVE_HASH);
+	block->page.space = ULINT32_UNDEFINED;
+	block->page.offset = ULINT32_UNDEFINED;
+
+	/* The compressed page now belongs to new_block. */
+	block->page.zip.data = NULL;
+	page_zip_set_size(&block->page.zip, 0);
+
+	buf_block_set_state(block, BUF_BLOCK_MEMORY);
+	buf_LRU_block_free_non_file_page(block);
+
+	mutex_exit(&block->mutex);
+
+	return(FALSE);
+}
+
+/********************************************************************//**
+Withdraws the blocks of the chunks that the ongoing shrink is going to
+remove from a buffer pool instance: the free blocks are moved to the
+withdraw list, and the file pages and compressed pages in the other
+blocks are moved elsewhere, so that the blocks are freed to the
+withdraw list too.  Blocks that are in use by other memory heaps or
+whose pages are fixed are left alone.
+@return	TRUE if the withdraw list is still incomplete */
+static
+ibool
+buf_pool_withdraw_blocks(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	buf_page_t*	bpage;
+	ulint		i;
+	ibool		withdrawing;
+
+	buf_pool_mutex_enter(buf_pool);
+
+	/* Move the free blocks of the chunks to the withdraw list.
+	buf_LRU_get_free_only() and buf_LRU_block_free_non_file_page()
+	do the same for the blocks that they come across. */
+	bpage = UT_LIST_GET_FIRST(buf_pool->free);
+
+	while (bpage != NULL) {
+		buf_page_t*	next_bpage = UT_LIST_GET_NEXT(list, bpage);
+
+		ut_ad(bpage->in_free_list);
+
+		if (buf_block_will_be_withdrawn(buf_pool,
+						(buf_block_t*) bpage)) {
+
+			UT_LIST_REMOVE(list, buf_pool->free, bpage);
+			ut_d(bpage->in_free_list = FALSE);
+			UT_LIST_ADD_LAST(list, buf_pool->withdraw, bpage);
+		}
+
+		bpage = next_bpage;
+	}
+
+	/* Merge the free buddies in the frames of the chunks, so that
+	the frames that hold no compressed pages are freed. */
+	buf_buddy_condense_free(buf_pool);
+
+	buf_pool_mutex_exit(buf_pool);
+
+	/* Move the pages out of the remaining blocks.  buf_pool->mutex
+	is acquired for one block at a time, so that the threads that
+	are using the buffer pool are only stalled briefly. */
+	for (i = buf_pool->n_chunks_new; i < buf_pool->n_chunks; i++) {
+		buf_chunk_t*	chunk = &buf_pool->chunks[i];
+		buf_block_t*	block = chunk->blocks;
+		ulint		j;
+
+		for (j = chunk->size; j--; block++) {
+			ibool	retried = FALSE;
+			ibool	no_free;
+retry:
+			buf_pool_mutex_enter(buf_pool);
+
+			switch (buf_block_get_state(block)) {
+			case BUF_BLOCK_FILE_PAGE:
+				no_free = buf_page_realloc(buf_pool, block);
+				break;
+			case BUF_BLOCK_MEMORY:
+				no_free = buf_buddy_withdraw_block(
+					buf_pool, block);
+				break;
+			default:
+				no_free = FALSE;
+			}
+
+			buf_pool_mutex_exit(buf_pool);
+
+			if (no_free && !retried) {
+				buf_block_t*	free_block;
+
+				/* Make room by evicting or flushing
+				pages from the tail of the LRU list.
+				Put the block to the free list, where
+				the retry will find it. */
+				free_block = buf_LRU_get_free_block(buf_pool);
+
+				buf_pool_mutex_enter(buf_pool);
+				mutex_enter(&free_block->mutex);
+				buf_LRU_block_free_non_file_page(free_block);
+				mutex_exit(&free_block->mutex);
+				buf_pool_mutex_exit(buf_pool);
+
+				retried = TRUE;
+				goto retry;
+			}
+		}
+	}
+
+	buf_pool_mutex_enter(buf_pool);
+	withdrawing = buf_pool_withdrawing(buf_pool);
+	buf_pool_mutex_exit(buf_pool);
+
+	return(withdrawing);
+}
+
+/********************************************************************//**
+Rebuilds page_hash and zip_hash of a buffer pool instance for its
+current size. */
+static
+void
+buf_pool_resize_hash(
+/*=================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	hash_table_t*	new_hash_table;
+	ulint		i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	new_hash_table = hash_create(2 * buf_pool->curr_size);
+
+	for (i = 0; i < hash_get_n_cells(buf_pool->page_hash); i++) {
+		buf_page_t*	bpage;
+
+		bpage = HASH_GET_FIRST(buf_pool->page_hash, i);
+
+		while (bpage != NULL) {
+			buf_page_t*	prev_bpage = bpage;
+			ulint		fold;
+
+			bpage = HASH_GET_NEXT(hash, prev_bpage);
+
+			fold = buf_page_address_fold(prev_bpage->space,
+						     prev_bpage->offset);
+
+			HASH_DELETE(buf_page_t, hash,
+				    buf_pool->page_hash, fold, prev_bpage);
+			HASH_INSERT(buf_page_t, hash,
+				    new_hash_table, fold, prev_bpage);
+		}
+	}
+
+	hash_table_free(buf_pool->page_hash);
+	buf_pool->page_hash = new_hash_table;
+
+	new_hash_table = hash_create(2 * buf_pool->curr_size);
+
+	for (i = 0; i < hash_get_n_cells(buf_pool->zip_hash); i++) {
+		buf_page_t*	bpage;
+
+		bpage = HASH_GET_FIRST(buf_pool->zip_hash, i);
+
+		while (bpage != NULL) {
+			buf_page_t*	prev_bpage = bpage;
+			ulint		fold;
+
+			bpage = HASH_GET_NEXT(hash, prev_bpage);
+
+			fold = BUF_POOL_ZIP_FOLD(
+				(buf_block_t*) prev_bpage);
+
+			HASH_DELETE(buf_page_t, hash,
+				    buf_pool->zip_hash, fold, prev_bpage);
+			HASH_INSERT(buf_page_t, hash,
+				    new_hash_table, fold, prev_bpage);
+		}
+	}
+
+	hash_table_free(buf_pool->zip_hash);
+	buf_pool->zip_hash = new_hash_table;
+}
+
+/********************************************************************//**
+Gives up shrinking the buffer pool: puts the withdrawn blocks back to
+the free lists. */
+static
+void
+buf_pool_withdraw_cancel(void)
+/*==========================*/
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_page_t*	bpage;
+
+		buf_pool_mutex_enter(buf_pool);
+
+		while ((bpage = UT_LIST_GET_FIRST(buf_pool->withdraw))) {
+			UT_LIST_REMOVE(list, buf_pool->withdraw, bpage);
+			UT_LIST_ADD_LAST(list, buf_pool->free, bpage);
+			ut_d(bpage->in_free_list = TRUE);
+		}
+
+		buf_pool->withdraw_target = 0;
+		buf_pool->n_chunks_new = buf_pool->n_chunks;
+
+		buf_pool_mutex_exit(buf_pool);
+	}
+}
+
+/********************************************************************//**
+Resizes the buffer pool instances to srv_buf_pool_size by adding or
+removing chunks of srv_buf_pool_chunk_unit bytes.  When shrinking, the
+pages are first moved out of the chunks that are going to be removed;
+this runs concurrently with the other threads, which only wait for
+buf_pool->mutex while a single block is moved.  The chunk arrays are
+then swapped while holding all the buffer pool mutexes. */
+static
+void
+buf_pool_resize(void)
+/*=================*/
+{
+	const ulint	old_size = srv_buf_pool_old_size;
+	const ulint	new_size = srv_buf_pool_size;
+	const ulint	n_chunks_new = new_size / srv_buf_pool_instances
+		/ srv_buf_pool_chunk_unit;
+	buf_chunk_t*	new_chunks[MAX_BUFFER_POOLS];
+	ulint		n_chunks_old;
+	ulint		new_pages;
+	ibool		shrinking;
+	ibool		resize_hash;
+	ibool		ahi_was_enabled = FALSE;
+	ibool		completed = FALSE;
+	ulint		n_rounds = 0;
+	ulint		i;
+
+	ut_ad(!mutex_own(&dict_sys->mutex));
+	ut_ad(n_chunks_new > 0);
+
+	buf_resize_status(TRUE, "Resizing buffer pool from %lu to %lu"
+			  " (chunk size %lu).", (ulong) old_size,
+			  (ulong) new_size, (ulong) srv_buf_pool_chunk_unit);
+
+	/* All the instances have the same number of chunks. */
+	n_chunks_old = buf_pool_from_array(0)->n_chunks;
+	shrinking = n_chunks_new < n_chunks_old;
+
+	/* The hash tables are rebuilt when their size would be off by
+	more than a factor of two; they were created for twice the
+	number of pages. */
+	new_pages = n_chunks_new * buf_pool_from_array(0)->chunks->size;
+	resize_hash = new_pages
+		> hash_get_n_cells(buf_pool_from_array(0)->page_hash)
+		|| new_pages * 4
+		< hash_get_n_cells(buf_pool_from_array(0)->page_hash);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		ulint		j;
+
+		buf_pool_mutex_enter(buf_pool);
+
+		ut_ad(buf_pool->n_chunks == n_chunks_old);
+		ut_ad(UT_LIST_GET_LEN(buf_pool->withdraw) == 0);
+
+		/* Nobody can be scanning the array that the previous
+		resize replaced any more. */
+		if (buf_pool->chunks_old != NULL) {
+			mem_free(buf_pool->chunks_old);
+			buf_pool->chunks_old = NULL;
+		}
+
+		buf_pool->n_chunks_new = n_chunks_new;
+		buf_pool->withdraw_target = 0;
+
+		for (j = n_chunks_new; j < n_chunks_old; j++) {
+			buf_pool->withdraw_target += buf_pool->chunks[j].size;
+		}
+
+		buf_pool_mutex_exit(buf_pool);
+	}
+
+	/* The adaptive hash index points to the frames of the pages
+	that are going to be moved, and its hash tables can only be
+	rebuilt while it is empty. btr_search_enable() refuses to
+	enable it until the resize is complete. */
+	if ((shrinking || resize_hash) && btr_search_enabled) {
+		btr_search_disable();
+		ahi_was_enabled = TRUE;
+
+		buf_resize_status(TRUE, "Disabled the adaptive hash index"
+				  " during the resize.");
+	}
+
+	while (shrinking) {
+		ibool	withdrawing = FALSE;
+		ulint	withdrawn = 0;
+		ulint	target = 0;
+
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+			if (buf_pool_withdraw_blocks(buf_pool)) {
+				withdrawing = TRUE;
+			}
+
+			withdrawn += UT_LIST_GET_LEN(buf_pool->withdraw);
+			target += buf_pool->withdraw_target;
+		}
+
+		if (!withdrawing) {
+			break;
+		}
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			buf_pool_withdraw_cancel();
+			srv_buf_pool_size = old_size;
+
+			buf_resize_status(TRUE, "Resizing buffer pool"
+					  " aborted by the shutdown.");
+
+			goto func_exit;
+		}
+
+		buf_resize_status(n_rounds % BUF_WITHDRAW_LOG_INTERVAL == 0,
+				  "Withdrawing blocks from the buffer pool"
+				  " (%lu/%lu).", (ulong) withdrawn,
+				  (ulong) target);
+
+		n_rounds++;
+		os_thread_sleep(BUF_WITHDRAW_RETRY_INTERVAL);
+	}
+
+	/* Build the new chunk arrays.  When growing, the new chunks are
+	allocated and initialized here, before any mutex is acquired. */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_chunk_t*	chunk;
+
+		new_chunks[i] = mem_zalloc(ut_max(n_chunks_new, n_chunks_old)
+					   * sizeof *chunk);
+		memcpy(new_chunks[i], buf_pool->chunks,
+		       ut_min(n_chunks_new, n_chunks_old) * sizeof *chunk);
+
+		for (chunk = new_chunks[i] + n_chunks_old;
+		     chunk < new_chunks[i] + n_chunks_new; chunk++) {
+
+			if (!buf_chunk_init(buf_pool, chunk,
+					    srv_buf_pool_chunk_unit,
+					    srv_buf_pool_populate)) {
+				buf_chunk_t*	end = chunk;
+				ulint		j;
+
+				buf_resize_status(TRUE, "Cannot allocate"
+						  " memory for the buffer"
+						  " pool, not resizing it.");
+
+				/* Free the chunks allocated so far for
+				this and the preceding instances. */
+				for (j = i + 1; j--; ) {
+					for (chunk = new_chunks[j]
+					     + n_chunks_old;
+					     chunk < end; chunk++) {
+						buf_chunk_free(chunk);
+					}
+
+					mem_free(new_chunks[j]);
+
+					if (j > 0) {
+						end = new_chunks[j - 1]
+							+ n_chunks_new;
+					}
+				}
+
+				buf_pool_withdraw_cancel();
+				srv_buf_pool_size = old_size;
+
+				goto func_exit;
+			}
+		}
+	}
+
+	/* Swap the chunk arrays.  The adaptive hash index latches keep
+	buf_pool_clear_hash_index() from scanning the chunks meanwhile. */
+	btr_search_x_lock_all();
+	buf_pool_mutex_enter_all();
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_chunk_t*	chunk;
+
+		if (shrinking) {
+			/* The withdrawn blocks are discarded along with
+			their chunks. */
+			ut_ad(UT_LIST_GET_LEN(buf_pool->withdraw)
+			      == buf_pool->withdraw_target);
+			UT_LIST_INIT(buf_pool->withdraw);
+			buf_pool->withdraw_target = 0;
+
+			/* See buf_block_align_instance() for the order
+			of the assignments. */
+			buf_pool->chunks_old = buf_pool->chunks;
+			*(volatile ulint*) &buf_pool->n_chunks
+				= n_chunks_new;
+			*(buf_chunk_t* volatile*) &buf_pool->chunks
+				= new_chunks[i];
+		} else {
+			for (chunk = new_chunks[i] + n_chunks_old;
+			     chunk < new_chunks[i] + n_chunks_new; chunk++) {
+				buf_chunk_add_free(buf_pool, chunk);
+			}
+
+			buf_pool->chunks_old = buf_pool->chunks;
+			*(buf_chunk_t* volatile*) &buf_pool->chunks
+				= new_chunks[i];
+			*(volatile ulint*) &buf_pool->n_chunks
+				= n_chunks_new;
+		}
+
+		buf_pool->n_chunks_new = n_chunks_new;
+
+		buf_pool->curr_size = 0;
+
+		for (chunk = buf_pool->chunks;
+		     chunk < buf_pool->chunks + n_chunks_new; chunk++) {
+			buf_pool->curr_size += chunk->size;
+		}
+
+		buf_pool->curr_pool_size = buf_pool->curr_size
+			* UNIV_PAGE_SIZE;
+		buf_pool->old_pool_size = buf_pool->curr_pool_size;
+
+		if (resize_hash) {
+			buf_pool_resize_hash(buf_pool);
+		}
+	}
+
+	if (shrinking) {
+		buf_withdraw_clock++;
+	}
+
+	buf_pool_mutex_exit_all();
+	btr_search_x_unlock_all();
+
+	/* Free the memory of the removed chunks, which is no longer
+	reachable. */
+	for (i = 0; shrinking && i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_chunk_t*	chunk;
+
+		for (chunk = buf_pool->chunks_old + n_chunks_new;
+		     chunk < buf_pool->chunks_old + n_chunks_old; chunk++) {
+			buf_chunk_free(chunk);
+		}
+	}
+
+	if (resize_hash) {
+		btr_search_sys_resize(new_pages * srv_buf_pool_instances
+				      * UNIV_PAGE_SIZE / sizeof(void*) / 64);
+	}
+
+	buf_pool_set_sizes();
+	ibuf_max_size_update();
+
+	completed = TRUE;
+
+func_exit:
+	if (ahi_was_enabled) {
+		btr_search_enable();
+
+		buf_resize_status(TRUE, "Re-enabled the adaptive hash index.");
+	}
+
+	srv_buf_pool_old_size = srv_buf_pool_size;
+
+	/* Report the completion last, so that a new resize can be
+	requested as soon as the status says that this one completed. */
+	if (completed) {
+		buf_resize_status(TRUE, "Completed resizing buffer pool from"
+				  " %lu to %lu.", (ulong) old_size,
+				  (ulong) new_size);
+	}
+}
+
+/********************************************************************//**
+This is the thread that resizes the buffer pool. It waits for an event
+and, when woken up, resizes the buffer pool instances to
+srv_buf_pool_size and sleeps again.
+@return this function does not return, it calls os_thread_exit() */
+UNIV_INTERN
+os_thread_ret_t
+buf_resize_thread(
+/*==============*/
+	void*	arg __attribute__((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	ib_int64_t	sig_count;
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_resize_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	ut_ad(srv_buf_resize_thread_active);
+
+	buf_resize_status(FALSE, "not started");
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+
+		sig_count = os_event_reset(srv_buf_resize_event);
+
+		if (srv_buf_pool_old_size == srv_buf_pool_size) {
+			os_event_wait_low(srv_buf_resize_event, sig_count);
+		}
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			break;
+		}
+
+		if (srv_buf_pool_old_size != srv_buf_pool_size) {
+			buf_pool_resize();
+		}
+	}
+
+	srv_buf_resize_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /********************************************************************//**
 Determine if a block is a sentinel for a buffer pool watch.
 @return	TRUE if a sentinel for a buffer pool watch, FALSE if not */
@@ -1976,25 +2977,28 @@ buf_zip_decompress(
 	ibool		check)	/*!< in: TRUE=verify the page checksum */
 {
 	const byte*	frame		= block->page.zip.data;
-	ulint		stamp_checksum	= mach_read_from_4(
-		frame + FIL_PAGE_SPACE_OR_CHKSUM);
+	ulint		size		= page_zip_get_size(&block->page.zip);
 
 	ut_ad(buf_block_get_zip_size(block));
 	ut_a(buf_block_get_space(block) != 0);
 
-	if (UNIV_LIKELY(check && stamp_checksum != BUF_NO_CHECKSUM_MAGIC)) {
-		ulint	calc_checksum	= page_zip_calc_checksum(
-			frame, page_zip_get_size(&block->page.zip));
+	if (UNIV_UNLIKELY(check && !page_zip_verify_checksum(frame, size))) {
 
-		if (UNIV_UNLIKELY(stamp_checksum != calc_checksum)) {
-			ut_print_timestamp(stderr);
-			fprintf(stderr,
-				"  InnoDB: compressed page checksum mismatch"
-				" (space %u page %u): %lu != %lu\n",
-				block->page.space, block->page.offset,
-				stamp_checksum, calc_checksum);
-			return(FALSE);
-		}
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: compressed page checksum mismatch"
+			" (space %u page %u): stored: %lu, crc32: %lu,"
+			" innodb: %lu, none: %lu\n",
+			block->page.space, block->page.offset,
+			(ulong) mach_read_from_4(
+				frame + FIL_PAGE_SPACE_OR_CHKSUM),
+			(ulong) page_zip_calc_checksum(
+				frame, size, SRV_CHECKSUM_ALGORITHM_CRC32),
+			(ulong) page_zip_calc_checksum(
+				frame, size, SRV_CHECKSUM_ALGORITHM_INNODB),
+			(ulong) page_zip_calc_checksum(
+				frame, size, SRV_CHECKSUM_ALGORITHM_NONE));
+		return(FALSE);
 	}
 
 	switch (fil_page_get_type(frame)) {
@@ -2047,11 +3051,26 @@ buf_block_align_instance(
 	buf_chunk_t*	chunk;
 	ulint		i;
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
-	for (chunk = buf_pool->chunks, i = buf_pool->n_chunks; i--; chunk++) {
+	/* buf_pool->chunks and buf_pool->n_chunks are read without
+	holding buf_pool->mutex.  buf_pool_resize() publishes a longer
+	array before the larger n_chunks and a smaller n_chunks before
+	the array that has the removed chunks zeroed out, and it frees
+	the replaced array only at the next resize.  Reading n_chunks
+	first thus never scans past the end of an array.  The memory of
+	a removed chunk is freed, so chunk->blocks may be dereferenced
+	only when ptr points into the chunk. */
+	i = *(volatile ulint*) &buf_pool->n_chunks;
+
+	for (chunk = *(buf_chunk_t* volatile*) &buf_pool->chunks;
+	     i--; chunk++) {
 		ulint	offs;
 
+		if (ptr < (byte*) chunk->mem
+		    || ptr >= (byte*) chunk->mem + chunk->mem_size) {
+
+			continue;
+		}
+
 		if (UNIV_UNLIKELY(ptr < chunk->blocks->frame)) {
 
 			continue;
@@ -2161,11 +3180,14 @@ buf_pointer_is_block_field_instance(
 	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	const void*	ptr)		/*!< in: pointer not dereferenced */
 {
-	const buf_chunk_t*		chunk	= buf_pool->chunks;
-	const buf_chunk_t* const	echunk	= chunk + buf_pool->n_chunks;
+	/* buf_pool->chunks is read without holding buf_pool->mutex,
+	see buf_block_align_instance(). */
+	const ulint			n_chunks
+		= *(volatile ulint*) &buf_pool->n_chunks;
+	const buf_chunk_t*		chunk
+		= *(buf_chunk_t* volatile*) &buf_pool->chunks;
+	const buf_chunk_t* const	echunk	= chunk + n_chunks;
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
 	while (chunk < echunk) {
 		if (ptr >= (void *)chunk->blocks
 		    && ptr < (void *)(chunk->blocks + chunk->size)) {
@@ -2519,7 +3541,7 @@ wait_until_unfixed:
 
 		/* Decompress the page while not holding
 		buf_pool->mutex or block->mutex. */
-		success = buf_zip_decompress(block, srv_use_checksums);
+		success = buf_zip_decompress(block, TRUE);
 		ut_a(success);
 
 		if (UNIV_LIKELY(!recv_no_ibuf_operations)) {
@@ -4058,9 +5080,12 @@ buf_pool_validate_instance(
 	}
 
 	ut_a(UT_LIST_GET_LEN(buf_pool->LRU) == n_lru);
-	if (UT_LIST_GET_LEN(buf_pool->free) != n_free) {
-		fprintf(stderr, "Free list len %lu, free blocks %lu\n",
+	if (UT_LIST_GET_LEN(buf_pool->free)
+	    + UT_LIST_GET_LEN(buf_pool->withdraw) != n_free) {
+		fprintf(stderr, "Free list len %lu, withdraw list len %lu,"
+			" free blocks %lu\n",
 			(ulong) UT_LIST_GET_LEN(buf_pool->free),
+			(ulong) UT_LIST_GET_LEN(buf_pool->withdraw),
 			(ulong) n_free);
 		ut_error;
 	}
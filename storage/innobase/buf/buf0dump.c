@@ -0,0 +1,774 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file buf/buf0dump.c
+Implements a buffer pool dump/load.
+
+The dump is a text file with one "space_id,page_no" line for each page
+found in the LRU lists of the buffer pool instances. The load reads the
+file back, sorts the entries by (space_id, page_no) and issues asynchronous
+read requests for batches of pages of the same tablespace.
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#include "buf0dump.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include "buf0buf.h"
+#include "buf0rea.h"
+#include "fil0fil.h"
+#include "os0sync.h"
+#include "os0thread.h"
+#include "srv0srv.h"
+#include "srv0start.h"
+#include "sync0rw.h"
+#include "ut0sort.h"
+
+/** Maximum number of pages of a tablespace issued in a single read
+request batch by the load. */
+#define BUF_LOAD_BATCH_SIZE	64
+
+/** Pack a (space_id, page_no) pair into a single 64-bit value that
+sorts in (space_id, page_no) order. */
+#define BUF_DUMP_CREATE(space, page)	\
+	((((ib_uint64_t) (space)) << 32) | ((ib_uint64_t) (page)))
+/** Extract the space_id from a value created by BUF_DUMP_CREATE() */
+#define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
+/** Extract the page_no from a value created by BUF_DUMP_CREATE() */
+#define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
+
+/** TRUE if the server is shutting down */
+#define SHUTTING_DOWN()			(srv_shutdown_state \
+					 != SRV_SHUTDOWN_NONE)
+
+/** Severity of a status message. */
+enum status_severity {
+	STATUS_INFO,	/*!< only update the status variable */
+	STATUS_NOTICE,	/*!< also print the message to the error log */
+	STATUS_ERR	/*!< an error, printed to the error log */
+};
+
+/** Flag indicating that a dump has been requested. */
+static volatile ibool	buf_dump_should_start = FALSE;
+/** Flag indicating that a load has been requested. */
+static volatile ibool	buf_load_should_start = FALSE;
+/** Flag indicating that a running load should be aborted. */
+static volatile ibool	buf_load_abort_flag = FALSE;
+
+/** Status message of the last or currently running dump. */
+static char	buf_dump_status_str[BUF_DUMP_STATUS_LEN];
+/** Status message of the last or currently running load. */
+static char	buf_load_status_str[BUF_DUMP_STATUS_LEN];
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a dump. This function is called by MySQL code via buffer_pool_dump_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_dump_start(void)
+/*================*/
+{
+	buf_dump_should_start = TRUE;
+	os_event_set(srv_buf_dump_event);
+}
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a load. This function is called by MySQL code via buffer_pool_load_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_load_start(void)
+/*================*/
+{
+	buf_load_should_start = TRUE;
+	os_event_set(srv_buf_dump_event);
+}
+
+/*****************************************************************//**
+Aborts a currently running buffer pool load. This function is called by
+MySQL code via buffer_pool_load_abort() and it should return immediately
+because the whole MySQL is frozen during its execution. */
+UNIV_INTERN
+void
+buf_load_abort(void)
+/*================*/
+{
+	buf_load_abort_flag = TRUE;
+}
+
+/*****************************************************************//**
+Copies the current dump and load status messages into the given
+buffers, each of which must be at least BUF_DUMP_STATUS_LEN bytes. */
+UNIV_INTERN
+void
+buf_dump_status_get(
+/*================*/
+	char*	dump_status,	/*!< out: dump status message */
+	char*	load_status)	/*!< out: load status message */
+{
+	/* The messages are only modified by the dump/load thread and
+	always remain NUL-terminated, a torn read is harmless. */
+	ut_strlcpy(dump_status, buf_dump_status_str, BUF_DUMP_STATUS_LEN);
+	ut_strlcpy(load_status, buf_load_status_str, BUF_DUMP_STATUS_LEN);
+}
+
+/*****************************************************************//**
+Formats a status message into the given buffer and prints it to the
+error log unless it is only informational. */
+static
+void
+buf_status_set(
+/*===========*/
+	char*			status,		/*!< out: status buffer */
+	enum status_severity	severity,	/*!< in: message severity */
+	const char*		fmt,		/*!< in: format */
+	va_list			ap)		/*!< in: arguments */
+{
+	char	msg[BUF_DUMP_STATUS_LEN];
+
+#ifdef __WIN__
+	_vsnprintf(msg, sizeof(msg), fmt, ap);
+#else
+	vsnprintf(msg, sizeof(msg), fmt, ap);
+#endif /* __WIN__ */
+	msg[sizeof(msg) - 1] = '\0';
+
+	/* Keep the status NUL-terminated at all times, it can be read
+	concurrently by SHOW STATUS. */
+	status[BUF_DUMP_STATUS_LEN - 1] = '\0';
+	memcpy(status, msg, BUF_DUMP_STATUS_LEN - 1);
+
+	if (severity != STATUS_INFO) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr, " InnoDB: %s%s\n",
+			severity == STATUS_ERR ? "Error: " : "", msg);
+	}
+}
+
+/*****************************************************************//**
+Sets the global variable that feeds MySQL's innodb_buffer_pool_dump_status
+to the specified string. The format and the following parameters are the
+same as the ones used for printf(3). */
+static
+void
+buf_dump_status(
+/*============*/
+	enum status_severity	severity,	/*!< in: message severity */
+	const char*		fmt,		/*!< in: format */
+	...)					/*!< in: extra parameters according
+						to fmt */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+	buf_status_set(buf_dump_status_str, severity, fmt, ap);
+	va_end(ap);
+}
+
+/*****************************************************************//**
+Sets the global variable that feeds MySQL's innodb_buffer_pool_load_status
+to the specified string. The format and the following parameters are the
+same as the ones used for printf(3). */
+static
+void
+buf_load_status(
+/*============*/
+	enum status_severity	severity,	/*!< in: message severity */
+	const char*		fmt,		/*!< in: format */
+	...)					/*!< in: extra parameters according
+						to fmt */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+	buf_status_set(buf_load_status_str, severity, fmt, ap);
+	va_end(ap);
+}
+
+/*****************************************************************//**
+Builds the full path of the dump file from the InnoDB data home
+directory and innodb_buffer_pool_filename. */
+static
+void
+buf_dump_generate_path(
+/*===================*/
+	char*	path,		/*!< out: full path of the dump file */
+	ulint	path_size)	/*!< in: size of path */
+{
+	ulint	len = strlen(srv_data_home);
+
+	if (len == 0 || srv_data_home[len - 1] == SRV_PATH_SEPARATOR) {
+		ut_snprintf(path, path_size, "%s%s",
+			    srv_data_home, srv_buf_dump_filename);
+	} else {
+		ut_snprintf(path, path_size, "%s%c%s",
+			    srv_data_home, SRV_PATH_SEPARATOR,
+			    srv_buf_dump_filename);
+	}
+}
+
+/*****************************************************************//**
+Performs a buffer pool dump into the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_dump_status will be set accordingly, see buf_dump_status().
+The dump filename can be specified by (relative to srv_data_home):
+SET GLOBAL innodb_buffer_pool_filename='filename'; */
+static
+void
+buf_dump(
+/*=====*/
+	ibool	obey_shutdown)	/*!< in: quit if we are in a shutting down
+				state */
+{
+#define SHOULD_QUIT()	(obey_shutdown && SHUTTING_DOWN())
+
+	char	full_filename[OS_FILE_MAX_PATH];
+	char	tmp_filename[OS_FILE_MAX_PATH + sizeof ".incomplete"];
+	char	now[32];
+	FILE*	f;
+	ulint	i;
+	int	ret;
+
+	buf_dump_generate_path(full_filename, sizeof(full_filename));
+
+	ut_snprintf(tmp_filename, sizeof(tmp_filename),
+		    "%s.incomplete", full_filename);
+
+	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
+			full_filename);
+
+	f = fopen(tmp_filename, "w");
+	if (f == NULL) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot open '%s' for writing: %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	/* walk through each buffer pool */
+	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
+		buf_pool_t*		buf_pool;
+		const buf_page_t*	bpage;
+		ib_uint64_t*		dump;
+		ulint			n_pages;
+		ulint			j;
+
+		buf_pool = buf_pool_from_array(i);
+
+		/* obtain buf_pool mutex before allocate, since
+		UT_LIST_GET_LEN(buf_pool->LRU) could change */
+		buf_pool_mutex_enter(buf_pool);
+
+		n_pages = UT_LIST_GET_LEN(buf_pool->LRU);
+
+		/* skip empty buffer pools */
+		if (n_pages == 0) {
+			buf_pool_mutex_exit(buf_pool);
+			continue;
+		}
+
+		dump = ut_malloc_low(n_pages * sizeof(*dump), FALSE);
+		if (dump == NULL) {
+			buf_pool_mutex_exit(buf_pool);
+			fclose(f);
+			buf_dump_status(STATUS_ERR,
+					"Cannot allocate " ULINTPF " bytes: %s",
+					(ulint) (n_pages * sizeof(*dump)),
+					strerror(errno));
+			/* leave tmp_filename to exist */
+			return;
+		}
+
+		/* Walk from the most recently used end so that the
+		hottest pages come first in the file. */
+		for (bpage = UT_LIST_GET_FIRST(buf_pool->LRU), j = 0;
+		     bpage != NULL;
+		     bpage = UT_LIST_GET_NEXT(LRU, bpage), j++) {
+
+			ut_a(buf_page_in_file(bpage));
+
+			dump[j] = BUF_DUMP_CREATE(buf_page_get_space(bpage),
+						  buf_page_get_page_no(bpage));
+		}
+
+		ut_a(j == n_pages);
+
+		buf_pool_mutex_exit(buf_pool);
+
+		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
+			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
+				      BUF_DUMP_SPACE(dump[j]),
+				      BUF_DUMP_PAGE(dump[j]));
+			if (ret < 0) {
+				ut_free(dump);
+				fclose(f);
+				buf_dump_status(STATUS_ERR,
+						"Cannot write to '%s': %s",
+						tmp_filename, strerror(errno));
+				/* leave tmp_filename to exist */
+				return;
+			}
+
+			if (j % 128 == 0) {
+				buf_dump_status(
+					STATUS_INFO,
+					"Dumping buffer pool "
+					ULINTPF "/" ULINTPF ", "
+					"page " ULINTPF "/" ULINTPF,
+					i + 1, srv_buf_pool_instances,
+					j + 1, n_pages);
+			}
+		}
+
+		ut_free(dump);
+	}
+
+	ret = fclose(f);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot close '%s': %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	if (SHOULD_QUIT()) {
+		buf_dump_status(STATUS_NOTICE,
+				"Buffer pool(s) dump aborted by shutdown");
+		return;
+	}
+
+	ret = unlink(full_filename);
+	if (ret != 0 && errno != ENOENT) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot delete '%s': %s",
+				full_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+	/* else */
+
+	ret = rename(tmp_filename, full_filename);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot rename '%s' to '%s': %s",
+				tmp_filename, full_filename,
+				strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+	/* else */
+
+	/* success */
+
+	ut_sprintf_timestamp(now);
+
+	buf_dump_status(STATUS_NOTICE,
+			"Buffer pool(s) dump completed at %s", now);
+
+#undef SHOULD_QUIT
+}
+
+/*****************************************************************//**
+Compare two (space_id, page_no) values packed by BUF_DUMP_CREATE().
+@return -1 if a < b, 0 if a == b, 1 if a > b */
+UNIV_INLINE
+int
+buf_dump_cmp(
+/*=========*/
+	ib_uint64_t	a,	/*!< in: first value */
+	ib_uint64_t	b)	/*!< in: second value */
+{
+	if (a < b) {
+		return(-1);
+	} else if (a > b) {
+		return(1);
+	}
+
+	return(0);
+}
+
+/*****************************************************************//**
+Sort (space_id, page_no) values in ascending order. */
+static
+void
+buf_dump_sort(
+/*==========*/
+	ib_uint64_t*	arr,		/*!< in/out: array to be sorted */
+	ib_uint64_t*	aux_arr,	/*!< in/out: auxiliary array */
+	ulint		low,		/*!< in: lower bound of the
+					sorting area, inclusive */
+	ulint		high)		/*!< in: upper bound of the
+					sorting area, exclusive */
+{
+	UT_SORT_FUNCTION_BODY(buf_dump_sort, arr, aux_arr, low, high,
+			      buf_dump_cmp);
+}
+
+/*****************************************************************//**
+Issues asynchronous read requests for a sorted batch of pages of a
+single tablespace. Pages of tablespaces which have been dropped, and
+pages beyond the current end of a tablespace, are silently skipped.
+@return number of read requests issued */
+static
+ulint
+buf_load_space_batch(
+/*=================*/
+	ulint		space,		/*!< in: tablespace id */
+	const ulint*	page_nos,	/*!< in: page numbers in
+					ascending order */
+	ulint		n_pages)	/*!< in: number of pages */
+{
+	ulint	space_size;
+	ulint	n_read = 0;
+
+	/* Skip tablespaces which no longer exist. */
+	if (!fil_tablespace_exists_in_mem(space)) {
+		return(0);
+	}
+
+	/* Prevent the tablespace from being deleted while the
+	read requests are being issued. */
+	if (fil_inc_pending_ops(space)) {
+		return(0);
+	}
+
+	space_size = fil_space_get_size(space);
+
+	if (space_size && fil_space_get_type(space) == FIL_TABLESPACE) {
+
+		/* The tablespace may have been truncated since the dump
+		was taken, drop the pages beyond its end. */
+		while (n_pages > 0 && page_nos[n_pages - 1] >= space_size) {
+			n_pages--;
+		}
+
+		if (n_pages > 0) {
+			n_read = buf_read_pages(FALSE, space, 0,
+						page_nos, n_pages);
+		}
+	}
+
+	fil_decr_pending_ops(space);
+
+	return(n_read);
+}
+
+/*****************************************************************//**
+Performs a buffer pool load from the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
+The dump filename can be specified by (relative to srv_data_home):
+SET GLOBAL innodb_buffer_pool_filename='filename'; */
+static
+void
+buf_load(void)
+/*==========*/
+{
+	char		full_filename[OS_FILE_MAX_PATH];
+	char		now[32];
+	FILE*		f;
+	ib_uint64_t*	dump;
+	ib_uint64_t*	dump_tmp;
+	ulint		page_nos[BUF_LOAD_BATCH_SIZE];
+	ulint		dump_n;
+	ulint		total_buffer_pools_pages;
+	ulint		n_loaded;
+	ulint		n_issued_this_sec;
+	ib_time_t	sec_start;
+	ulint		i;
+	ulint		space_id;
+	ulint		page_no;
+	int		fscanf_ret;
+
+	/* Ignore any leftovers from before */
+	buf_load_abort_flag = FALSE;
+
+	buf_dump_generate_path(full_filename, sizeof(full_filename));
+
+	buf_load_status(STATUS_NOTICE,
+			"Loading buffer pool(s) from %s", full_filename);
+
+	f = fopen(full_filename, "r");
+	if (f == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot open '%s' for reading: %s",
+				full_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	/* First scan the file to estimate how many entries are in it.
+	This file is tiny (approx 500KB per 1GB buffer pool), reading it
+	two times is fine. */
+	dump_n = 0;
+	while (fscanf(f, ULINTPF "," ULINTPF, &space_id, &page_no) == 2
+	       && !SHUTTING_DOWN()) {
+		dump_n++;
+	}
+
+	if (!SHUTTING_DOWN() && !feof(f)) {
+		/* fscanf() returned != 2 */
+		const char*	what;
+		if (ferror(f)) {
+			what = "reading";
+		} else {
+			what = "parsing";
+		}
+		fclose(f);
+		buf_load_status(STATUS_ERR, "Error %s '%s', "
+				"unable to load buffer pool (stage 1)",
+				what, full_filename);
+		return;
+	}
+
+	/* If dump is larger than the buffer pool(s), then we ignore the
+	extra trailing. This could happen if a dump is made, then buffer
+	pool is shrunk and then load is attempted. */
+	total_buffer_pools_pages = buf_pool_get_n_pages();
+	dump_n = ut_min(dump_n, total_buffer_pools_pages);
+
+	if (dump_n == 0 || SHUTTING_DOWN()) {
+		fclose(f);
+		ut_sprintf_timestamp(now);
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load completed at %s "
+				"(%s was empty)", now, full_filename);
+		return;
+	}
+
+	dump = ut_malloc_low(dump_n * sizeof(*dump), FALSE);
+	if (dump == NULL) {
+		fclose(f);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (dump_n * sizeof(*dump)),
+				strerror(errno));
+		return;
+	}
+
+	dump_tmp = ut_malloc_low(dump_n * sizeof(*dump_tmp), FALSE);
+	if (dump_tmp == NULL) {
+		ut_free(dump);
+		fclose(f);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (dump_n * sizeof(*dump_tmp)),
+				strerror(errno));
+		return;
+	}
+
+	rewind(f);
+
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+		fscanf_ret = fscanf(f, ULINTPF "," ULINTPF,
+				    &space_id, &page_no);
+
+		if (fscanf_ret != 2) {
+			if (feof(f)) {
+				break;
+			}
+			/* else */
+
+			ut_free(dump);
+			ut_free(dump_tmp);
+			fclose(f);
+			buf_load_status(STATUS_ERR,
+					"Error parsing '%s', unable "
+					"to load buffer pool (stage 2)",
+					full_filename);
+			return;
+		}
+
+		if (space_id > 0xFFFFFFFFUL || page_no > 0xFFFFFFFFUL) {
+			ut_free(dump);
+			ut_free(dump_tmp);
+			fclose(f);
+			buf_load_status(STATUS_ERR,
+					"Error parsing '%s': bogus "
+					"space,page " ULINTPF "," ULINTPF
+					" at line " ULINTPF ", "
+					"unable to load buffer pool",
+					full_filename,
+					space_id, page_no,
+					i);
+			return;
+		}
+
+		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
+	}
+
+	/* Set dump_n to the actual number of initialized elements,
+	i could be smaller than dump_n here if the file got truncated after
+	we read it the first time. */
+	dump_n = i;
+
+	fclose(f);
+
+	if (dump_n == 0) {
+		ut_free(dump);
+		ut_free(dump_tmp);
+		ut_sprintf_timestamp(now);
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load completed at %s "
+				"(%s was empty)", now, full_filename);
+		return;
+	}
+
+	if (!SHUTTING_DOWN()) {
+		buf_dump_sort(dump, dump_tmp, 0, dump_n);
+	}
+
+	ut_free(dump_tmp);
+
+	n_loaded = 0;
+	n_issued_this_sec = 0;
+	sec_start = ut_time();
+
+	/* Issue the reads in batches of pages of the same tablespace.
+	As the entries are sorted, each batch is in ascending page order,
+	which lets the reads be merged and keeps the disk heads moving in
+	one direction. */
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); ) {
+		ulint	n_batch = 0;
+
+		space_id = BUF_DUMP_SPACE(dump[i]);
+
+		while (i < dump_n
+		       && n_batch < BUF_LOAD_BATCH_SIZE
+		       && BUF_DUMP_SPACE(dump[i]) == space_id) {
+
+			page_nos[n_batch++] = BUF_DUMP_PAGE(dump[i++]);
+		}
+
+		n_issued_this_sec += buf_load_space_batch(
+			space_id, page_nos, n_batch);
+
+		n_loaded = i;
+
+		if (buf_load_abort_flag) {
+			buf_load_abort_flag = FALSE;
+			ut_free(dump);
+			buf_load_status(
+				STATUS_NOTICE,
+				"Buffer pool(s) load aborted on request");
+			return;
+		}
+
+		buf_load_status(STATUS_INFO,
+				"Loaded " ULINTPF "/" ULINTPF " pages",
+				n_loaded, dump_n);
+
+		/* Do not issue more than innodb_io_capacity read requests
+		per second, so that the load does not starve user queries
+		of disk bandwidth. */
+		if (n_issued_this_sec >= srv_io_capacity) {
+			ib_time_t	elapsed = ut_time() - sec_start;
+
+			if (elapsed < 1) {
+				os_thread_sleep(1000000);
+			}
+
+			n_issued_this_sec = 0;
+			sec_start = ut_time();
+		}
+	}
+
+	ut_free(dump);
+
+	if (SHUTTING_DOWN()) {
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load aborted by shutdown");
+		return;
+	}
+
+	ut_sprintf_timestamp(now);
+
+	buf_load_status(STATUS_NOTICE,
+			"Buffer pool(s) load completed at %s", now);
+}
+
+/*****************************************************************//**
+This is the main thread for buffer pool dump/load. It waits for an
+event and when waked up either performs a dump or load and sleeps
+again. At shutdown it dumps the buffer pool if requested.
+@return this function does not return, it calls os_thread_exit() */
+UNIV_INTERN
+os_thread_ret_t
+buf_dump_thread(
+/*============*/
+	void*	arg __attribute__((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	ib_int64_t	sig_count;
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_dump_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	srv_buf_dump_thread_active = TRUE;
+
+	buf_dump_status(STATUS_INFO, "not started");
+	buf_load_status(STATUS_INFO, "not started");
+
+	if (srv_buffer_pool_load_at_startup) {
+		buf_load();
+	}
+
+	while (!SHUTTING_DOWN()) {
+
+		sig_count = os_event_reset(srv_buf_dump_event);
+
+		if (!buf_dump_should_start && !buf_load_should_start) {
+			os_event_wait_low(srv_buf_dump_event, sig_count);
+		}
+
+		if (buf_dump_should_start) {
+			buf_dump_should_start = FALSE;
+			buf_dump(TRUE /* quit on shutdown */);
+		}
+
+		if (buf_load_should_start) {
+			buf_load_should_start = FALSE;
+			buf_load();
+		}
+	}
+
+	if (srv_buffer_pool_dump_at_shutdown && srv_fast_shutdown != 2) {
+		buf_dump(FALSE /* ignore shutdown down flag,
+		keep going even if we are in a shutdown state */);
+	}
+
+	srv_buf_dump_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
@@ -43,6 +43,8 @@ Created 11/11/1995 Heikki Tuuri
 #include "log0log.h"
 #include "os0file.h"
 #include "trx0sys.h"
+#include "srv0start.h"
+#include "os0thread.h"
 #include "mysql/plugin.h"
 #include "mysql/service_thd_wait.h"
 
@@ -712,45 +714,34 @@ buf_flush_sync_datafiles(void)
 }
 
 /********************************************************************//**
-Flushes possible buffered writes from the doublewrite memory buffer to disk,
-and also wakes up the aio thread if simulated aio is used. It is very
-important to call this function after a batch of writes has been posted,
-and also when we may have to wait for a page latch! Otherwise a deadlock
-of threads can occur. */
+Flushes possible buffered writes from a doublewrite slot to disk, and
+also wakes up the aio thread if simulated aio is used. */
 static
 void
-buf_flush_buffered_writes(void)
-/*===========================*/
+buf_flush_write_doublewrite_slot(
+/*=============================*/
+	trx_doublewrite_slot_t*	slot)	/*!< in: doublewrite slot */
 {
-	byte*		write_buf;
-	ulint		len;
-	ulint		len2;
 	ulint		i;
 
-	if (!srv_use_doublewrite_buf || trx_doublewrite == NULL) {
-		/* Sync the writes to the disk. */
-		buf_flush_sync_datafiles();
-		return;
-	}
-
-	mutex_enter(&(trx_doublewrite->mutex));
+	mutex_enter(&slot->mutex);
 
-	/* Write first to doublewrite buffer blocks. We use synchronous
+	/* Write first to the doublewrite buffer slot. We use synchronous
 	aio and thus know that file write has been completed when the
 	control returns. */
 
-	if (trx_doublewrite->first_free == 0) {
+	if (slot->first_free == 0) {
 
-		mutex_exit(&(trx_doublewrite->mutex));
+		mutex_exit(&slot->mutex);
 
 		return;
 	}
 
-	for (i = 0; i < trx_doublewrite->first_free; i++) {
+	for (i = 0; i < slot->first_free; i++) {
 
 		const buf_block_t*	block;
 
-		block = (buf_block_t*) trx_doublewrite->buf_block_arr[i];
+		block = (buf_block_t*) slot->buf_block_arr[i];
 
 		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
 		    || block->page.zip.data) {
@@ -803,91 +794,55 @@ corrupted_page:
 	}
 
 	/* increment the doublewrite flushed pages counter */
-	srv_dblwr_pages_written+= trx_doublewrite->first_free;
+	srv_dblwr_pages_written+= slot->first_free;
 	srv_dblwr_writes++;
 
-	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
-		     trx_doublewrite->first_free) * UNIV_PAGE_SIZE;
-
-	write_buf = trx_doublewrite->write_buf;
-	i = 0;
-
-	fil_io(OS_FILE_WRITE, TRUE, TRX_SYS_SPACE, 0,
-	       trx_doublewrite->block1, 0, len,
-	       (void*) write_buf, NULL);
-
-	for (len2 = 0; len2 + UNIV_PAGE_SIZE <= len;
-	     len2 += UNIV_PAGE_SIZE, i++) {
-		const buf_block_t* block = (buf_block_t*)
-			trx_doublewrite->buf_block_arr[i];
+	for (i = 0; i < slot->first_free; i++) {
+		const buf_block_t*	block = (buf_block_t*)
+			slot->buf_block_arr[i];
+		const byte*		write_buf = slot->write_buf
+			+ i * UNIV_PAGE_SIZE;
 
 		if (UNIV_LIKELY(!block->page.zip.data)
 		    && UNIV_LIKELY(buf_block_get_state(block)
 				   == BUF_BLOCK_FILE_PAGE)
 		    && UNIV_UNLIKELY
-		    (memcmp(write_buf + len2 + (FIL_PAGE_LSN + 4),
-			    write_buf + len2
-			    + (UNIV_PAGE_SIZE
-			       - FIL_PAGE_END_LSN_OLD_CHKSUM + 4), 4))) {
+		    (memcmp(write_buf + (FIL_PAGE_LSN + 4),
+			    write_buf + (UNIV_PAGE_SIZE
+					 - FIL_PAGE_END_LSN_OLD_CHKSUM + 4),
+			    4))) {
 			ut_print_timestamp(stderr);
 			fprintf(stderr,
 				"  InnoDB: ERROR: The page to be written"
 				" seems corrupt!\n"
 				"InnoDB: The lsn fields do not match!"
-				" Noticed in the doublewrite block1.\n");
+				" Noticed in the doublewrite buffer.\n");
 		}
 	}
 
-	if (trx_doublewrite->first_free <= TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		goto flush;
-	}
-
-	len = (trx_doublewrite->first_free - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
-		* UNIV_PAGE_SIZE;
-
-	write_buf = trx_doublewrite->write_buf
-		+ TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
-	ut_ad(i == TRX_SYS_DOUBLEWRITE_BLOCK_SIZE);
-
-	fil_io(OS_FILE_WRITE, TRUE, TRX_SYS_SPACE, 0,
-	       trx_doublewrite->block2, 0, len,
-	       (void*) write_buf, NULL);
-
-	for (len2 = 0; len2 + UNIV_PAGE_SIZE <= len;
-	     len2 += UNIV_PAGE_SIZE, i++) {
-		const buf_block_t* block = (buf_block_t*)
-			trx_doublewrite->buf_block_arr[i];
-
-		if (UNIV_LIKELY(!block->page.zip.data)
-		    && UNIV_LIKELY(buf_block_get_state(block)
-				   == BUF_BLOCK_FILE_PAGE)
-		    && UNIV_UNLIKELY
-		    (memcmp(write_buf + len2 + (FIL_PAGE_LSN + 4),
-			    write_buf + len2
-			    + (UNIV_PAGE_SIZE
-			       - FIL_PAGE_END_LSN_OLD_CHKSUM + 4), 4))) {
-			ut_print_timestamp(stderr);
-			fprintf(stderr,
-				"  InnoDB: ERROR: The page to be"
-				" written seems corrupt!\n"
-				"InnoDB: The lsn fields do not match!"
-				" Noticed in"
-				" the doublewrite block2.\n");
-		}
-	}
+	/* Now write and flush the doublewrite slot to disk */
 
-flush:
-	/* Now flush the doublewrite buffer data to disk */
+	trx_doublewrite_write_slot(slot);
 
-	fil_flush(TRX_SYS_SPACE);
+	/* Simulate a crash before the pages reach the data files, in a
+	batch that writes pages of a tablespace other than the system
+	tablespace */
+	DBUG_EXECUTE_IF(
+		"ib_doublewrite_crash_after_write",
+		for (i = 0; i < slot->first_free; i++) {
+			if (buf_page_get_space(slot->buf_block_arr[i])
+			    != TRX_SYS_SPACE) {
+				DBUG_SUICIDE();
+			}
+		});
 
 	/* We know that the writes have been flushed to disk now
 	and in recovery we will find them in the doublewrite buffer
 	blocks. Next do the writes to the intended positions. */
 
-	for (i = 0; i < trx_doublewrite->first_free; i++) {
+	for (i = 0; i < slot->first_free; i++) {
 		const buf_block_t* block = (buf_block_t*)
-			trx_doublewrite->buf_block_arr[i];
+			slot->buf_block_arr[i];
 
 		ut_a(buf_page_in_file(&block->page));
 		if (UNIV_LIKELY_NULL(block->page.zip.data)) {
@@ -942,32 +897,62 @@ flush:
 	buf_flush_sync_datafiles();
 
 	/* We can now reuse the doublewrite memory buffer: */
-	trx_doublewrite->first_free = 0;
+	slot->first_free = 0;
+
+	mutex_exit(&slot->mutex);
+}
 
-	mutex_exit(&(trx_doublewrite->mutex));
+/********************************************************************//**
+Flushes possible buffered writes from the doublewrite memory buffer to disk,
+and also wakes up the aio thread if simulated aio is used. It is very
+important to call this function after a batch of writes has been posted,
+and also when we may have to wait for a page latch! Otherwise a deadlock
+of threads can occur. Only the doublewrite slot of the given buffer pool
+instance and flush type is flushed. */
+static
+void
+buf_flush_buffered_writes(
+/*======================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	enum buf_flush	flush_type)	/*!< in: BUF_FLUSH_LRU
+					or BUF_FLUSH_LIST */
+{
+	if (!srv_use_doublewrite_buf || trx_doublewrite == NULL) {
+		/* Sync the writes to the disk. */
+		buf_flush_sync_datafiles();
+		return;
+	}
+
+	buf_flush_write_doublewrite_slot(
+		trx_doublewrite_get_slot(buf_pool_index(buf_pool),
+					 flush_type));
 }
 
 /********************************************************************//**
-Posts a buffer page for writing. If the doublewrite memory buffer is
-full, calls buf_flush_buffered_writes and waits for for free space to
-appear. */
+Posts a buffer page for writing. If the doublewrite slot of the buffer
+pool instance and flush type of the page is full, flushes the slot and
+waits for for free space to appear. */
 static
 void
 buf_flush_post_to_doublewrite_buf(
 /*==============================*/
 	buf_page_t*	bpage)	/*!< in: buffer block to write */
 {
-	ulint	zip_size;
+	ulint			zip_size;
+	trx_doublewrite_slot_t*	slot;
+
+	slot = trx_doublewrite_get_slot(
+		buf_pool_index(buf_pool_from_bpage(bpage)),
+		buf_page_get_flush_type(bpage));
 try_again:
-	mutex_enter(&(trx_doublewrite->mutex));
+	mutex_enter(&slot->mutex);
 
 	ut_a(buf_page_in_file(bpage));
 
-	if (trx_doublewrite->first_free
-	    >= 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		mutex_exit(&(trx_doublewrite->mutex));
+	if (slot->first_free >= slot->n_pages) {
+		mutex_exit(&slot->mutex);
 
-		buf_flush_buffered_writes();
+		buf_flush_write_doublewrite_slot(slot);
 
 		goto try_again;
 	}
@@ -977,36 +962,35 @@ try_again:
 	if (UNIV_UNLIKELY(zip_size)) {
 		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
 		/* Copy the compressed page and clear the rest. */
-		memcpy(trx_doublewrite->write_buf
-		       + UNIV_PAGE_SIZE * trx_doublewrite->first_free,
+		memcpy(slot->write_buf
+		       + UNIV_PAGE_SIZE * slot->first_free,
 		       bpage->zip.data, zip_size);
-		memset(trx_doublewrite->write_buf
-		       + UNIV_PAGE_SIZE * trx_doublewrite->first_free
+		memset(slot->write_buf
+		       + UNIV_PAGE_SIZE * slot->first_free
 		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
 	} else {
 		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
 		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
 				   UNIV_PAGE_SIZE);
 
-		memcpy(trx_doublewrite->write_buf
-		       + UNIV_PAGE_SIZE * trx_doublewrite->first_free,
+		memcpy(slot->write_buf
+		       + UNIV_PAGE_SIZE * slot->first_free,
 		       ((buf_block_t*) bpage)->frame, UNIV_PAGE_SIZE);
 	}
 
-	trx_doublewrite->buf_block_arr[trx_doublewrite->first_free] = bpage;
+	slot->buf_block_arr[slot->first_free] = bpage;
 
-	trx_doublewrite->first_free++;
+	slot->first_free++;
 
-	if (trx_doublewrite->first_free
-	    >= 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		mutex_exit(&(trx_doublewrite->mutex));
+	if (slot->first_free >= slot->n_pages) {
+		mutex_exit(&slot->mutex);
 
-		buf_flush_buffered_writes();
+		buf_flush_write_doublewrite_slot(slot);
 
 		return;
 	}
 
-	mutex_exit(&(trx_doublewrite->mutex));
+	mutex_exit(&slot->mutex);
 }
 #endif /* !UNIV_HOTBACKUP */
 
@@ -1021,6 +1005,8 @@ buf_flush_init_for_writing(
 	ib_uint64_t	newest_lsn)	/*!< in: newest modification lsn
 					to the page */
 {
+	ib_uint32_t	checksum;
+
 	ut_ad(page);
 
 	if (page_zip_) {
@@ -1047,10 +1033,10 @@ buf_flush_init_for_writing(
 			memset(page_zip->data + FIL_PAGE_FILE_FLUSH_LSN, 0, 8);
 			mach_write_to_4(page_zip->data
 					+ FIL_PAGE_SPACE_OR_CHKSUM,
-					srv_use_checksums
-					? page_zip_calc_checksum(
-						page_zip->data, zip_size)
-					: BUF_NO_CHECKSUM_MAGIC);
+					page_zip_calc_checksum(
+						page_zip->data, zip_size,
+						(srv_checksum_algorithm_t)
+						srv_checksum_algorithm));
 			return;
 		}
 
@@ -1072,20 +1058,39 @@ buf_flush_init_for_writing(
 
 	/* Store the new formula checksum */
 
-	mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM,
-			srv_use_checksums
-			? buf_calc_page_new_checksum(page)
-			: BUF_NO_CHECKSUM_MAGIC);
+	switch ((srv_checksum_algorithm_t) srv_checksum_algorithm) {
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_CRC32:
+		checksum = buf_calc_page_crc32(page);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_INNODB:
+		checksum = (ib_uint32_t) buf_calc_page_new_checksum(page);
+		break;
+	case SRV_CHECKSUM_ALGORITHM_NONE:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_NONE:
+	default:
+		checksum = BUF_NO_CHECKSUM_MAGIC;
+		break;
+	}
+
+	mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM, checksum);
 
 	/* We overwrite the first 4 bytes of the end lsn field to store
 	the old formula checksum. Since it depends also on the field
 	FIL_PAGE_SPACE_OR_CHKSUM, it has to be calculated after storing the
-	new formula checksum. */
+	new formula checksum. The crc32 and none algorithms store the same
+	value in both fields. */
+
+	if (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_INNODB
+	    || srv_checksum_algorithm
+	    == SRV_CHECKSUM_ALGORITHM_STRICT_INNODB) {
+
+		checksum = (ib_uint32_t) buf_calc_page_old_checksum(page);
+	}
 
 	mach_write_to_4(page + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM,
-			srv_use_checksums
-			? buf_calc_page_old_checksum(page)
-			: BUF_NO_CHECKSUM_MAGIC);
+			checksum);
 }
 
 #ifndef UNIV_HOTBACKUP
@@ -1152,10 +1157,7 @@ buf_flush_write_block_low(
 		break;
 	case BUF_BLOCK_ZIP_DIRTY:
 		frame = bpage->zip.data;
-		if (UNIV_LIKELY(srv_use_checksums)) {
-			ut_a(mach_read_from_4(frame + FIL_PAGE_SPACE_OR_CHKSUM)
-			     == page_zip_calc_checksum(frame, zip_size));
-		}
+		ut_a(page_zip_verify_checksum(frame, zip_size));
 		mach_write_to_8(frame + FIL_PAGE_LSN,
 				bpage->newest_modification);
 		memset(frame + FIL_PAGE_FILE_FLUSH_LSN, 0, 8);
@@ -1255,7 +1257,7 @@ buf_flush_page_try(
 	}
 
 	buf_pool_mutex_exit(buf_pool);
-	buf_flush_buffered_writes();
+	buf_flush_buffered_writes(buf_pool, BUF_FLUSH_LRU);
 
 	return(TRUE);
 }
@@ -1326,7 +1328,7 @@ buf_flush_page(
 		flush_list or LRU_list. */
 
 		if (!is_s_latched) {
-			buf_flush_buffered_writes();
+			buf_flush_buffered_writes(buf_pool, flush_type);
 
 			if (is_uncompressed) {
 				rw_lock_s_lock_gen(&((buf_block_t*) bpage)
@@ -1767,7 +1769,7 @@ buf_flush_batch(
 
 	buf_pool_mutex_exit(buf_pool);
 
-	buf_flush_buffered_writes();
+	buf_flush_buffered_writes(buf_pool, flush_type);
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints && count > 0) {
@@ -1790,8 +1792,6 @@ buf_flush_common(
 	enum buf_flush	flush_type,	/*!< in: type of flush */
 	ulint		page_count)	/*!< in: number of pages flushed */
 {
-	buf_flush_buffered_writes();
-
 	ut_a(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
 #ifdef UNIV_DEBUG
@@ -1928,6 +1928,41 @@ buf_flush_LRU(
 	return(page_count);
 }
 
+/*******************************************************************//**
+This utility flushes dirty blocks from the end of the flush list of
+one buffer pool instance.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return number of blocks for which the write request was queued;
+ULINT_UNDEFINED if there was a flush of the same type already running */
+static
+ulint
+buf_flush_list_instance(
+/*====================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed (it is not guaranteed that the
+					actual number is that big, though) */
+	ib_uint64_t	lsn_limit)	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed (if their number
+					does not exceed min_n) */
+{
+	ulint		page_count;
+
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		return(ULINT_UNDEFINED);
+	}
+
+	page_count = buf_flush_batch(
+		buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+
+	buf_flush_common(BUF_FLUSH_LIST, page_count);
+
+	return(page_count);
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -1962,12 +1997,12 @@ buf_flush_list(
 
 	/* Flush to lsn_limit in all buffer pool instances */
 	for (i = 0; i < srv_buf_pool_instances; i++) {
-		buf_pool_t*	buf_pool;
-		ulint		page_count = 0;
+		ulint		page_count;
 
-		buf_pool = buf_pool_from_array(i);
+		page_count = buf_flush_list_instance(
+			buf_pool_from_array(i), min_n, lsn_limit);
 
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		if (page_count == ULINT_UNDEFINED) {
 			/* We have two choices here. If lsn_limit was
 			specified then skipping an instance of buffer
 			pool means we cannot guarantee that all pages
@@ -1983,13 +2018,6 @@ buf_flush_list(
 			continue;
 		}
 
-		page_count = buf_flush_batch(
-			buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
-
-		buf_flush_end(buf_pool, BUF_FLUSH_LIST);
-
-		buf_flush_common(BUF_FLUSH_LIST, page_count);
-
 		total_page_count += page_count;
 	}
 
@@ -2216,6 +2244,564 @@ buf_flush_get_desired_flush_rate(void)
 	return(rate > 0 ? (ulint) rate : 0);
 }
 
+/** Number of page cleaner iterations over which the average page
+flushing rate and redo generation rate are computed */
+#define PAGE_CLEANER_AVG_LOOPS	30
+
+/** Age of the oldest modification, in percent of the asynchronous
+preflush age (log_sys->max_modified_age_async), below which the page
+cleaner does not flush for the sake of the redo log */
+#define PAGE_CLEANER_LSN_LWM	10
+
+/** Event to wake up the page cleaner coordinator, at shutdown */
+UNIV_INTERN os_event_t	buf_flush_event;
+
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t	page_cleaner_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** State of a buffer pool instance in the current page cleaner
+iteration */
+enum page_cleaner_state {
+	PAGE_CLEANER_STATE_NONE = 0,	/*!< not requested in this
+					iteration */
+	PAGE_CLEANER_STATE_REQUESTED,	/*!< waiting for a thread to
+					flush it */
+	PAGE_CLEANER_STATE_FLUSHING,	/*!< being flushed by a thread */
+	PAGE_CLEANER_STATE_FINISHED	/*!< flushed in this iteration */
+};
+
+/** Page cleaner request and result for one buffer pool instance */
+typedef struct page_cleaner_slot_struct	page_cleaner_slot_t;
+/** Page cleaner request and result for one buffer pool instance */
+struct page_cleaner_slot_struct {
+	enum page_cleaner_state	state;	/*!< state of the slot, protected
+					by page_cleaner->mutex */
+	ulint		n_pages_requested;
+					/*!< number of pages to flush from
+					the flush list */
+	ulint		n_flushed_lru;	/*!< number of pages flushed from
+					the LRU tail */
+	ulint		n_flushed_list;	/*!< number of pages flushed from
+					the flush list */
+	ullint		lru_time;	/*!< time spent in the LRU tail
+					flush, in microseconds */
+	ullint		list_time;	/*!< time spent in the flush list
+					flush, in microseconds */
+};
+
+/** The page cleaner coordinator and worker threads */
+typedef struct page_cleaner_struct	page_cleaner_t;
+/** The page cleaner coordinator and worker threads */
+struct page_cleaner_struct {
+	mutex_t		mutex;		/*!< protects the fields below
+					and the state of the slots */
+	os_event_t	is_requested;	/*!< set when there are slots
+					waiting to be flushed */
+	os_event_t	is_finished;	/*!< set when all the slots of the
+					current iteration are flushed */
+	ulint		n_workers;	/*!< number of running worker
+					threads */
+	ibool		is_running;	/*!< FALSE when the worker threads
+					must exit */
+	ulint		n_slots;	/*!< number of slots, equal to
+					srv_buf_pool_instances */
+	ulint		n_slots_requested;
+					/*!< number of slots in state
+					PAGE_CLEANER_STATE_REQUESTED */
+	ulint		n_slots_flushing;
+					/*!< number of slots in state
+					PAGE_CLEANER_STATE_FLUSHING */
+	ulint		n_slots_finished;
+					/*!< number of slots in state
+					PAGE_CLEANER_STATE_FINISHED */
+	page_cleaner_slot_t*	slots;	/*!< one slot per buffer pool
+					instance */
+};
+
+/** The page cleaner, or NULL if innodb_page_cleaners is 0 */
+static page_cleaner_t*	page_cleaner = NULL;
+
+/*********************************************************************//**
+Returns the percentage of io_capacity that should be used for flushing
+because of the share of dirty pages in the buffer pool. Above
+innodb_max_dirty_pages_pct all of io_capacity is used; below it, if
+adaptive flushing is enabled, a share proportional to the dirty pages.
+@return percentage of io_capacity */
+static
+ulint
+page_cleaner_pct_for_dirty(void)
+/*============================*/
+{
+	ulint	dirty_pct = buf_get_modified_ratio_pct();
+
+	if (dirty_pct > srv_max_buf_pool_modified_pct) {
+
+		return(100);
+	}
+
+	if (!srv_adaptive_flushing) {
+
+		return(0);
+	}
+
+	return((dirty_pct * 100) / (srv_max_buf_pool_modified_pct + 1));
+}
+
+/*********************************************************************//**
+Returns the percentage of io_capacity that should be used for flushing
+because of the age of the oldest modified page. The percentage grows
+quadratically with the age, relative to the age at which user threads
+start flushing asynchronously in log_preflush_pool_modified_pages(), so
+that the page cleaner catches up before that happens.
+@return percentage of io_capacity */
+static
+ulint
+page_cleaner_pct_for_lsn(
+/*=====================*/
+	ib_uint64_t	age)	/*!< in: current lsn - oldest lsn */
+{
+	ib_uint64_t	max_async_age = log_sys->max_modified_age_async;
+	ulint		lsn_age_factor;
+
+	if (max_async_age == 0
+	    || age < max_async_age * PAGE_CLEANER_LSN_LWM / 100) {
+
+		return(0);
+	}
+
+	lsn_age_factor = (ulint) ((age * 100) / max_async_age);
+
+	return((lsn_age_factor * lsn_age_factor) / 75);
+}
+
+/*********************************************************************//**
+Computes the number of pages the page cleaner should flush from the flush
+lists in this iteration. The result is the average of the io_capacity
+share that the dirty page percentage and the redo log age ask for, and
+the average number of pages flushed per iteration in the recent past,
+which smooths the rate. Called once per iteration by the coordinator.
+@return number of pages to flush from the flush lists */
+static
+ulint
+page_cleaner_flush_pages_recommendation(
+/*====================================*/
+	ulint	last_pages_in)	/*!< in: number of pages flushed in the
+				previous iteration */
+{
+	static ulint	sum_pages = 0;
+	static ulint	avg_page_rate = 0;
+	static ulint	n_iterations = 0;
+	ib_uint64_t	oldest_lsn;
+	ib_uint64_t	cur_lsn;
+	ib_uint64_t	age;
+	ulint		pct_for_dirty;
+	ulint		pct_for_lsn;
+	ulint		n_pages;
+
+	sum_pages += last_pages_in;
+
+	if (++n_iterations >= PAGE_CLEANER_AVG_LOOPS) {
+		avg_page_rate = (avg_page_rate
+				 + sum_pages / n_iterations) / 2;
+		sum_pages = 0;
+		n_iterations = 0;
+	}
+
+	cur_lsn = log_get_lsn();
+	oldest_lsn = buf_pool_get_oldest_modification();
+
+	age = (oldest_lsn != 0 && cur_lsn > oldest_lsn)
+		? cur_lsn - oldest_lsn : 0;
+
+	pct_for_dirty = page_cleaner_pct_for_dirty();
+	pct_for_lsn = page_cleaner_pct_for_lsn(age);
+
+	n_pages = (PCT_IO(ut_max(pct_for_dirty, pct_for_lsn))
+		   + avg_page_rate) / 2;
+
+	/* Never flush more than twice io_capacity in one iteration */
+	return(ut_min(n_pages, PCT_IO(200)));
+}
+
+/*********************************************************************//**
+Requests a flush of all the buffer pool instances from the page cleaner
+threads: the LRU tail of every instance, and n_pages pages from the flush
+lists, divided evenly among the instances. */
+static
+void
+pc_request(
+/*=======*/
+	ulint	n_pages)	/*!< in: number of pages to flush from the
+				flush lists */
+{
+	ulint	i;
+	ulint	n_per_instance;
+
+	n_per_instance = (n_pages + page_cleaner->n_slots - 1)
+		/ page_cleaner->n_slots;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(page_cleaner->n_slots_requested == 0);
+	ut_ad(page_cleaner->n_slots_flushing == 0);
+
+	for (i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		slot->state = PAGE_CLEANER_STATE_REQUESTED;
+		slot->n_pages_requested = n_per_instance;
+		slot->n_flushed_lru = 0;
+		slot->n_flushed_list = 0;
+		slot->lru_time = 0;
+		slot->list_time = 0;
+	}
+
+	page_cleaner->n_slots_requested = page_cleaner->n_slots;
+	page_cleaner->n_slots_finished = 0;
+
+	os_event_reset(page_cleaner->is_finished);
+	os_event_set(page_cleaner->is_requested);
+
+	mutex_exit(&page_cleaner->mutex);
+}
+
+/*********************************************************************//**
+Flushes one requested buffer pool instance, if there is one left: first
+the LRU tail, so that user threads find free blocks without flushing
+themselves, then the requested number of pages from the flush list.
+@return number of slots that are still waiting to be flushed */
+static
+ulint
+pc_flush_slot(void)
+/*===============*/
+{
+	page_cleaner_slot_t*	slot = NULL;
+	buf_pool_t*		buf_pool = NULL;
+	ulint			i;
+	ulint			n;
+	ullint			start_time;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	if (page_cleaner->n_slots_requested > 0) {
+
+		for (i = 0; i < page_cleaner->n_slots; i++) {
+			slot = &page_cleaner->slots[i];
+
+			if (slot->state == PAGE_CLEANER_STATE_REQUESTED) {
+				break;
+			}
+		}
+
+		ut_a(i < page_cleaner->n_slots);
+
+		buf_pool = buf_pool_from_array(i);
+
+		slot->state = PAGE_CLEANER_STATE_FLUSHING;
+		page_cleaner->n_slots_requested--;
+		page_cleaner->n_slots_flushing++;
+
+		if (page_cleaner->n_slots_requested == 0) {
+			os_event_reset(page_cleaner->is_requested);
+		}
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	if (buf_pool == NULL) {
+
+		return(0);
+	}
+
+	start_time = ut_time_us(NULL);
+
+	n = buf_flush_LRU_recommendation(buf_pool);
+
+	if (n > 0) {
+		n = buf_flush_LRU(buf_pool, n);
+
+		slot->n_flushed_lru = (n == ULINT_UNDEFINED) ? 0 : n;
+	}
+
+	slot->lru_time = ut_time_us(NULL) - start_time;
+
+	if (slot->n_pages_requested > 0) {
+		start_time = ut_time_us(NULL);
+
+		n = buf_flush_list_instance(
+			buf_pool, slot->n_pages_requested, IB_ULONGLONG_MAX);
+
+		slot->n_flushed_list = (n == ULINT_UNDEFINED) ? 0 : n;
+		slot->list_time = ut_time_us(NULL) - start_time;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	slot->state = PAGE_CLEANER_STATE_FINISHED;
+	page_cleaner->n_slots_flushing--;
+	page_cleaner->n_slots_finished++;
+
+	if (page_cleaner->n_slots_finished == page_cleaner->n_slots) {
+		os_event_set(page_cleaner->is_finished);
+	}
+
+	n = page_cleaner->n_slots_requested;
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(n);
+}
+
+/*********************************************************************//**
+Waits until all the slots of the current page cleaner iteration have
+been flushed, and adds up the results of the slots. */
+static
+void
+pc_wait_finished(
+/*=============*/
+	ulint*	n_flushed_lru,	/*!< out: pages flushed from the LRU
+				tails */
+	ulint*	n_flushed_list,	/*!< out: pages flushed from the flush
+				lists */
+	ullint*	lru_time,	/*!< out: time spent in LRU tail
+				flushes, in microseconds */
+	ullint*	list_time)	/*!< out: time spent in flush list
+				flushes, in microseconds */
+{
+	ulint	i;
+
+	*n_flushed_lru = 0;
+	*n_flushed_list = 0;
+	*lru_time = 0;
+	*list_time = 0;
+
+	os_event_wait(page_cleaner->is_finished);
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(page_cleaner->n_slots_requested == 0);
+	ut_ad(page_cleaner->n_slots_flushing == 0);
+	ut_ad(page_cleaner->n_slots_finished == page_cleaner->n_slots);
+
+	for (i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_FINISHED);
+
+		*n_flushed_lru += slot->n_flushed_lru;
+		*n_flushed_list += slot->n_flushed_list;
+		*lru_time += slot->lru_time;
+		*list_time += slot->list_time;
+
+		slot->state = PAGE_CLEANER_STATE_NONE;
+	}
+
+	page_cleaner->n_slots_finished = 0;
+
+	mutex_exit(&page_cleaner->mutex);
+}
+
+/******************************************************************//**
+Initializes the page cleaner. Must be called before the page cleaner
+threads are created, and only if srv_n_page_cleaners > 0. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void)
+/*=============================*/
+{
+	ut_a(srv_n_page_cleaners > 0);
+	ut_a(page_cleaner == NULL);
+
+	page_cleaner = mem_zalloc(sizeof(*page_cleaner));
+
+	mutex_create(page_cleaner_mutex_key, &page_cleaner->mutex,
+		     SYNC_PAGE_CLEANER);
+
+	page_cleaner->is_requested = os_event_create(NULL);
+	page_cleaner->is_finished = os_event_create(NULL);
+	page_cleaner->is_running = TRUE;
+
+	page_cleaner->n_slots = srv_buf_pool_instances;
+	page_cleaner->slots = mem_zalloc(
+		page_cleaner->n_slots * sizeof(*page_cleaner->slots));
+
+	buf_flush_event = os_event_create(NULL);
+
+	/* Set here rather than in the coordinator thread, so that a
+	shutdown cannot miss the thread while it is starting up. */
+	srv_page_cleaner_active = TRUE;
+}
+
+/******************************************************************//**
+Page cleaner coordinator thread. Once per second it computes how many
+pages to flush and has the coordinator and the worker threads flush the
+LRU tail and the flush list of every buffer pool instance in parallel.
+It exits at shutdown, after the worker threads; the final flush at
+shutdown is done by the master thread.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+buf_flush_page_cleaner_coordinator(
+/*===============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ulint		next_loop_time = ut_time_ms() + 1000;
+	ulint		n_flushed = 0;
+	ib_int64_t	sig_count = os_event_reset(buf_flush_event);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_coordinator_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	/* The mysys thread context lets DBUG_EXECUTE_IF() fire in the
+	pages that this thread flushes. */
+	my_thread_init();
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		ulint	cur_time = ut_time_ms();
+		ulint	n_pages;
+		ulint	n_flushed_lru;
+		ulint	n_flushed_list;
+		ullint	lru_time;
+		ullint	list_time;
+		ullint	start_time;
+
+		if (next_loop_time > cur_time) {
+			/* Use ut_min() to avoid a long sleep in case of
+			a wrap around. */
+			os_event_wait_time_low(
+				buf_flush_event,
+				ut_min(1000000,
+				       (next_loop_time - cur_time) * 1000),
+				sig_count);
+			srv_page_cleaner_sleeps++;
+		}
+
+		sig_count = os_event_reset(buf_flush_event);
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			break;
+		}
+
+		next_loop_time = ut_time_ms() + 1000;
+
+		start_time = ut_time_us(NULL);
+
+		n_pages = page_cleaner_flush_pages_recommendation(n_flushed);
+
+		pc_request(n_pages);
+
+		while (pc_flush_slot() > 0) {
+			/* The coordinator flushes instances too */
+		}
+
+		pc_wait_finished(&n_flushed_lru, &n_flushed_list,
+				 &lru_time, &list_time);
+
+		n_flushed = n_flushed_lru + n_flushed_list;
+
+		srv_page_cleaner_iterations++;
+		srv_page_cleaner_lru_pages += n_flushed_lru;
+		srv_page_cleaner_flush_list_pages += n_flushed_list;
+		srv_page_cleaner_lru_time += (ulint) (lru_time / 1000);
+		srv_page_cleaner_flush_list_time += (ulint) (list_time / 1000);
+		srv_page_cleaner_time
+			+= (ulint) ((ut_time_us(NULL) - start_time) / 1000);
+
+		if (n_pages > 0 && n_flushed_list >= n_pages
+		    && buf_get_modified_ratio_pct()
+		    > srv_max_buf_pool_modified_pct) {
+
+			/* We are still above the dirty page limit after
+			flushing all we were asked to: do not sleep. */
+			next_loop_time = ut_time_ms();
+		}
+	}
+
+	/* Tell the worker threads to exit and wait for them */
+
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->is_running = FALSE;
+	os_event_set(page_cleaner->is_requested);
+	mutex_exit(&page_cleaner->mutex);
+
+	for (;;) {
+		ulint	n_workers;
+
+		mutex_enter(&page_cleaner->mutex);
+		n_workers = page_cleaner->n_workers;
+		mutex_exit(&page_cleaner->mutex);
+
+		if (n_workers == 0) {
+			break;
+		}
+
+		os_thread_sleep(10000);
+	}
+
+	srv_page_cleaner_active = FALSE;
+
+	my_thread_end();
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+Page cleaner worker thread. Flushes the buffer pool instances requested
+by the coordinator, until the coordinator tells it to exit.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+buf_flush_page_cleaner_worker(
+/*==========================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_worker_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	my_thread_init();
+
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->n_workers++;
+	mutex_exit(&page_cleaner->mutex);
+
+	for (;;) {
+		ibool	is_running;
+
+		os_event_wait(page_cleaner->is_requested);
+
+		mutex_enter(&page_cleaner->mutex);
+		is_running = page_cleaner->is_running;
+		mutex_exit(&page_cleaner->mutex);
+
+		if (!is_running) {
+			break;
+		}
+
+		pc_flush_slot();
+	}
+
+	my_thread_end();
+
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->n_workers--;
+	mutex_exit(&page_cleaner->mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /******************************************************************//**
 Validates the flush list.
@@ -1053,7 +1053,7 @@ buf_LRU_get_free_only(
 
 	block = (buf_block_t*) UT_LIST_GET_FIRST(buf_pool->free);
 
-	if (block) {
+	while (block) {
 
 		ut_ad(block->page.in_free_list);
 		ut_d(block->page.in_free_list = FALSE);
@@ -1062,6 +1062,18 @@ buf_LRU_get_free_only(
 		ut_a(!buf_page_in_file(&block->page));
 		UT_LIST_REMOVE(list, buf_pool->free, (&block->page));
 
+		if (UNIV_UNLIKELY(buf_pool_withdrawing(buf_pool))
+		    && buf_block_will_be_withdrawn(buf_pool, block)) {
+			/* The chunk of the block is going to be
+			removed by buf_pool_resize(). */
+			UT_LIST_ADD_LAST(list, buf_pool->withdraw,
+					 (&block->page));
+
+			block = (buf_block_t*)
+				UT_LIST_GET_FIRST(buf_pool->free);
+			continue;
+		}
+
 		mutex_enter(&block->mutex);
 
 		buf_block_set_state(block, BUF_BLOCK_READY_FOR_USE);
@@ -1070,6 +1082,7 @@ buf_LRU_get_free_only(
 		ut_ad(buf_pool_from_block(block) == buf_pool);
 
 		mutex_exit(&block->mutex);
+		break;
 	}
 
 	return(block);
@@ -1878,11 +1891,11 @@ alloc:
 
 			mach_write_to_4(
 				b->zip.data + FIL_PAGE_SPACE_OR_CHKSUM,
-				UNIV_LIKELY(srv_use_checksums)
-				? page_zip_calc_checksum(
+				page_zip_calc_checksum(
 					b->zip.data,
-					page_zip_get_size(&b->zip))
-				: BUF_NO_CHECKSUM_MAGIC);
+					page_zip_get_size(&b->zip),
+					(srv_checksum_algorithm_t)
+					srv_checksum_algorithm));
 		}
 
 		buf_pool_mutex_enter(buf_pool);
@@ -1962,8 +1975,15 @@ buf_LRU_block_free_non_file_page(
 		page_zip_set_size(&block->page.zip, 0);
 	}
 
-	UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
-	ut_d(block->page.in_free_list = TRUE);
+	if (UNIV_UNLIKELY(buf_pool_withdrawing(buf_pool))
+	    && buf_block_will_be_withdrawn(buf_pool, block)) {
+		/* The chunk of the block is going to be removed by
+		buf_pool_resize(). */
+		UT_LIST_ADD_LAST(list, buf_pool->withdraw, (&block->page));
+	} else {
+		UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
+		ut_d(block->page.in_free_list = TRUE);
+	}
 
 	UNIV_MEM_ASSERT_AND_FREE(block->frame, UNIV_PAGE_SIZE);
 }
@@ -41,6 +41,7 @@ UNIV_INTERN dict_index_t*	dict_ind_compact;
 #include "dict0boot.h"
 #include "dict0mem.h"
 #include "dict0crea.h"
+#include "dict0stats.h"
 #include "trx0undo.h"
 #include "btr0btr.h"
 #include "btr0cur.h"
@@ -52,9 +53,11 @@ UNIV_INTERN dict_index_t*	dict_ind_compact;
 #include "que0que.h"
 #include "rem0cmp.h"
 #include "row0merge.h"
+#include "row0log.h"
 #include "m_ctype.h" /* my_isspace() */
 #include "ha_prototypes.h" /* innobase_strcasecmp(), innobase_casedn_str()*/
 #include "row0upd.h"
+#include "lock0lock.h"
 #include "m_string.h"
 #include "my_sys.h"
 
@@ -78,13 +81,33 @@ UNIV_INTERN rw_lock_t	dict_operation_lock;
 UNIV_INTERN mysql_pfs_key_t	dict_operation_lock_key;
 UNIV_INTERN mysql_pfs_key_t	index_tree_rw_lock_key;
 UNIV_INTERN mysql_pfs_key_t	dict_table_stats_latch_key;
+UNIV_INTERN mysql_pfs_key_t	dict_table_hash_latch_key;
 #endif /* UNIV_PFS_RWLOCK */
 
 #ifdef UNIV_PFS_MUTEX
 UNIV_INTERN mysql_pfs_key_t	dict_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	dict_foreign_err_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	index_zip_pad_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+/** Highest acceptable percentage of failed compressions of an index
+before padding is added; 0 disables padding.
+innodb_compression_failure_threshold_pct */
+UNIV_INTERN ulong	dict_zip_failure_threshold_pct
+	= DICT_ZIP_FAILURE_THRESHOLD_PCT_DEFAULT;
+/** Highest percentage of an uncompressed page that may be left empty
+as padding; innodb_compression_pad_pct_max */
+UNIV_INTERN ulong	dict_zip_pad_max = DICT_ZIP_PAD_MAX_DEFAULT;
+
+/** Number of compressions in a round, after which the failure rate
+of an index is evaluated */
+#define ZIP_PAD_ROUND_LEN		128
+/** Number of consecutive rounds with an acceptable failure rate after
+which the padding is decreased */
+#define ZIP_PAD_SUCCESSFUL_ROUND_LIMIT	5
+/** Number of bytes by which the padding is increased or decreased */
+#define ZIP_PAD_INCR			128
+
 #define	DICT_HEAP_SIZE		100	/*!< initial memory heap size when
 					creating a table or index object */
 #define DICT_POOL_PER_TABLE_HASH 512	/*!< buffer pool max size per table
@@ -329,6 +352,27 @@ dict_table_stats_unlock(
 	}
 }
 
+/********************************************************************//**
+Increments the count of open MySQL handles to a table, which keeps the
+table from being evicted from the dictionary cache. The caller must hold
+dict_sys->mutex. */
+UNIV_INTERN
+void
+dict_table_increment_handle_count(
+/*==============================*/
+	dict_table_t*	table)		/*!< in/out: table */
+{
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	/* dict_table_open_if_cached() increments the count without
+	holding dict_sys->mutex. */
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_increment_ulint(&table->n_mysql_handles_opened, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
+	table->n_mysql_handles_opened++;
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
 /********************************************************************//**
 Decrements the count of open MySQL handles to a table. */
 UNIV_INTERN
@@ -345,7 +389,17 @@ dict_table_decrement_handle_count(
 	ut_ad(mutex_own(&dict_sys->mutex));
 	ut_a(table->n_mysql_handles_opened > 0);
 
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_decrement_ulint(&table->n_mysql_handles_opened, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
 	table->n_mysql_handles_opened--;
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	/* Keep the most recently used tables at the head of the LRU
+	list, so that dict_make_room_in_cache() evicts from the tail
+	the tables that have been unused for the longest time. */
+	UT_LIST_REMOVE(table_LRU, dict_sys->table_LRU, table);
+	UT_LIST_ADD_FIRST(table_LRU, dict_sys->table_LRU, table);
 
 	if (!dict_locked) {
 		mutex_exit(&dict_sys->mutex);
@@ -725,6 +779,9 @@ dict_init(void)
 
 	UT_LIST_INIT(dict_sys->table_LRU);
 
+	rw_lock_create(dict_table_hash_latch_key,
+		       &dict_sys->table_hash_latch, SYNC_DICT_TABLE_HASH);
+
 	rw_lock_create(dict_operation_lock_key,
 		       &dict_operation_lock, SYNC_DICT_OPERATION);
 
@@ -738,7 +795,45 @@ dict_init(void)
 		rw_lock_create(dict_table_stats_latch_key,
 			       &dict_table_stats_latches[i], SYNC_INDEX_TREE);
 	}
+
+	dict_stats_init();
+}
+
+#ifdef HAVE_ATOMIC_BUILTINS
+/**********************************************************************//**
+Looks for a table in the dictionary cache without acquiring
+dict_sys->mutex, and increments its MySQL open handle count if found.
+The open handle keeps the table from being evicted from the cache.
+@return	table, NULL if the table is not cached or is corrupted */
+static
+dict_table_t*
+dict_table_open_if_cached(
+/*======================*/
+	const char*	table_name)	/*!< in: table name */
+{
+	dict_table_t*	table;
+	ulint		table_fold;
+
+	table_fold = ut_fold_string(table_name);
+
+	rw_lock_s_lock(&dict_sys->table_hash_latch);
+
+	HASH_SEARCH(name_hash, dict_sys->table_hash, table_fold,
+		    dict_table_t*, table, ut_ad(table->cached),
+		    !strcmp(table->name, table_name));
+
+	/* Corrupted tables are reported by dict_table_get_low(). */
+	if (table != NULL && !table->corrupted) {
+		os_atomic_increment_ulint(&table->n_mysql_handles_opened, 1);
+	} else {
+		table = NULL;
+	}
+
+	rw_lock_s_unlock(&dict_sys->table_hash_latch);
+
+	return(table);
 }
+#endif /* HAVE_ATOMIC_BUILTINS */
 
 /**********************************************************************//**
 Returns a table object and optionally increment its MySQL open handle count.
@@ -756,17 +851,67 @@ dict_table_get(
 {
 	dict_table_t*	table;
 
+#ifdef HAVE_ATOMIC_BUILTINS
+	if (inc_mysql_count) {
+		table = dict_table_open_if_cached(table_name);
+
+		if (table != NULL) {
+			os_atomic_increment_ulint(&srv_n_dict_cache_hits, 1);
+
+			/* Move the table to the head of the LRU list if
+			dict_sys->mutex is free. If it is not, the table
+			is moved when its handle is closed, in
+			dict_table_decrement_handle_count(); it cannot be
+			evicted before that. */
+			if (mutex_enter_nowait(&dict_sys->mutex) == 0) {
+				UT_LIST_REMOVE(table_LRU,
+					       dict_sys->table_LRU, table);
+				UT_LIST_ADD_FIRST(table_LRU,
+						  dict_sys->table_LRU, table);
+				mutex_exit(&dict_sys->mutex);
+			}
+
+			goto func_exit;
+		}
+	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
 	mutex_enter(&(dict_sys->mutex));
 
+	table = dict_table_check_if_in_cache_low(table_name);
+
+	if (table != NULL) {
+#ifdef HAVE_ATOMIC_BUILTINS
+		/* The hits of dict_table_open_if_cached() are counted
+		without dict_sys->mutex */
+		os_atomic_increment_ulint(&srv_n_dict_cache_hits, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
+		srv_n_dict_cache_hits++;
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+		UT_LIST_REMOVE(table_LRU, dict_sys->table_LRU, table);
+		UT_LIST_ADD_FIRST(table_LRU, dict_sys->table_LRU, table);
+	} else {
+		srv_n_dict_cache_misses++;
+	}
+
 	table = dict_table_get_low(table_name);
 
 	if (inc_mysql_count && table) {
-		table->n_mysql_handles_opened++;
+		dict_table_increment_handle_count(table);
 	}
 
 	mutex_exit(&(dict_sys->mutex));
 
-	if (table != NULL) {
+#ifdef HAVE_ATOMIC_BUILTINS
+func_exit:
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	if (table != NULL && srv_stats_persistent) {
+		/* Use the statistics stored in SYS_TABLE_STATS and
+		SYS_INDEX_STATS, if there are any. */
+		dict_stats_update(table, DICT_STATS_FETCH);
+	} else if (table != NULL) {
 		/* If table->ibd_file_missing == TRUE, this will
 		print an error message and return without doing
 		anything. */
@@ -904,8 +1049,10 @@ dict_table_add_to_cache(
 	}
 
 	/* Add table to hash table of tables */
+	rw_lock_x_lock(&dict_sys->table_hash_latch);
 	HASH_INSERT(dict_table_t, name_hash, dict_sys->table_hash, fold,
 		    table);
+	rw_lock_x_unlock(&dict_sys->table_hash_latch);
 
 	/* Add table to hash table of tables based on table id */
 	HASH_INSERT(dict_table_t, id_hash, dict_sys->table_id_hash, id_fold,
@@ -1031,6 +1178,7 @@ dict_table_rename_in_cache(
 	}
 
 	/* Remove table from the hash tables of tables */
+	rw_lock_x_lock(&dict_sys->table_hash_latch);
 	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
 		    ut_fold_string(old_name), table);
 
@@ -1046,6 +1194,7 @@ dict_table_rename_in_cache(
 	/* Add table to hash table of tables */
 	HASH_INSERT(dict_table_t, name_hash, dict_sys->table_hash, fold,
 		    table);
+	rw_lock_x_unlock(&dict_sys->table_hash_latch);
 
 	dict_sys->size += strlen(new_name) - strlen(old_name);
 	ut_a(dict_sys->size > 0);
@@ -1218,12 +1367,16 @@ dict_table_change_id_in_cache(
 }
 
 /**********************************************************************//**
-Removes a table object from the dictionary cache. */
-UNIV_INTERN
-void
-dict_table_remove_from_cache(
-/*=========================*/
-	dict_table_t*	table)	/*!< in, own: table */
+Removes a table object from the dictionary cache.
+@return	TRUE if removed, FALSE if lru_evict and the table was opened
+by MySQL after the caller checked it */
+static
+ibool
+dict_table_remove_from_cache_low(
+/*=============================*/
+	dict_table_t*	table,		/*!< in, own: table */
+	ibool		lru_evict)	/*!< in: TRUE if evicting an
+					unused table from the LRU list */
 {
 	dict_foreign_t*	foreign;
 	dict_index_t*	index;
@@ -1239,6 +1392,22 @@ dict_table_remove_from_cache(
 	fputs(" from dictionary cache\n", stderr);
 #endif
 
+	/* Remove table from the hash tables of tables. After this,
+	dict_table_open_if_cached() can no longer find the table. */
+	rw_lock_x_lock(&dict_sys->table_hash_latch);
+
+	if (lru_evict && table->n_mysql_handles_opened > 0) {
+		rw_lock_x_unlock(&dict_sys->table_hash_latch);
+		return(FALSE);
+	}
+
+	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
+		    ut_fold_string(table->name), table);
+	HASH_DELETE(dict_table_t, id_hash, dict_sys->table_id_hash,
+		    ut_fold_ull(table->id), table);
+
+	rw_lock_x_unlock(&dict_sys->table_hash_latch);
+
 	/* Remove the foreign constraints from the cache */
 	foreign = UT_LIST_GET_LAST(table->foreign_list);
 
@@ -1266,12 +1435,6 @@ dict_table_remove_from_cache(
 		index = UT_LIST_GET_LAST(table->indexes);
 	}
 
-	/* Remove table from the hash tables of tables */
-	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
-		    ut_fold_string(table->name), table);
-	HASH_DELETE(dict_table_t, id_hash, dict_sys->table_id_hash,
-		    ut_fold_ull(table->id), table);
-
 	/* Remove table from LRU list of tables */
 	UT_LIST_REMOVE(table_LRU, dict_sys->table_LRU, table);
 
@@ -1282,6 +1445,131 @@ dict_table_remove_from_cache(
 	dict_sys->size -= size;
 
 	dict_mem_table_free(table);
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Removes a table object from the dictionary cache. */
+UNIV_INTERN
+void
+dict_table_remove_from_cache(
+/*=========================*/
+	dict_table_t*	table)	/*!< in, own: table */
+{
+	dict_table_remove_from_cache_low(table, FALSE);
+}
+
+/**********************************************************************//**
+Checks if a table can be evicted from the dictionary cache.
+@return	TRUE if the table is not in use and can be evicted */
+static
+ibool
+dict_table_can_be_evicted(
+/*======================*/
+	dict_table_t*	table)	/*!< in: table */
+{
+	const dict_index_t*	index;
+
+	ut_ad(mutex_own(&dict_sys->mutex));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
+
+	if (table->n_mysql_handles_opened > 0
+	    || table->n_foreign_key_checks_running > 0) {
+		return(FALSE);
+	}
+
+	/* The system tables, the tables being created, altered or
+	dropped and the tables that are part of foreign key
+	constraints are never evicted. */
+	if (table->id < DICT_HDR_FIRST_ID
+	    || table->dir_path_of_temp_table != NULL
+	    || strstr(table->name, "/#sql")
+	    || UT_LIST_GET_LEN(table->foreign_list) > 0
+	    || UT_LIST_GET_LEN(table->referenced_list) > 0) {
+		return(FALSE);
+	}
+
+	/* Purge and rollback may still hold record locks of committed
+	or rolled back transactions that refer to the table. */
+	if (lock_table_has_locks(table)) {
+		return(FALSE);
+	}
+
+	for (index = dict_table_get_first_index(table);
+	     index != NULL;
+	     index = dict_table_get_next_index(index)) {
+
+		if (dict_index_is_online_ddl(index)) {
+			return(FALSE);
+		}
+
+		/* The adaptive hash index entries point to the index. */
+		if (btr_search_info_get_ref_count(index->search_info,
+						  (dict_index_t*) index) > 0) {
+			return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Evicts unused tables from the tail of the LRU list of the dictionary cache
+until the cache is no bigger than max_size bytes. A table is unused if it
+has no open MySQL handles, no locks, no foreign key constraints and no
+adaptive hash index entries. The caller must hold dict_operation_lock in
+X-mode and dict_sys->mutex.
+@return	number of tables evicted */
+UNIV_INTERN
+ulint
+dict_make_room_in_cache(
+/*====================*/
+	ulint	max_size,	/*!< in: target size of the cache
+				in bytes */
+	ulint	pct_check)	/*!< in: how much of the LRU list to
+				scan, in percent */
+{
+	ulint		i;
+	ulint		len;
+	ulint		check_up_to;
+	ulint		n_evicted = 0;
+	dict_table_t*	table;
+
+	ut_ad(pct_check > 0 && pct_check <= 100);
+	ut_ad(mutex_own(&dict_sys->mutex));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
+
+	len = UT_LIST_GET_LEN(dict_sys->table_LRU);
+
+	check_up_to = len - ((len * pct_check) / 100);
+
+	for (i = len, table = UT_LIST_GET_LAST(dict_sys->table_LRU);
+	     table != NULL
+	     && i > check_up_to
+	     && dict_sys->size > max_size;
+	     --i) {
+
+		dict_table_t*	prev_table;
+
+		prev_table = UT_LIST_GET_PREV(table_LRU, table);
+
+		if (dict_table_can_be_evicted(table)
+		    && dict_table_remove_from_cache_low(table, TRUE)) {
+
+			++n_evicted;
+		}
+
+		table = prev_table;
+	}
+
+	srv_n_dict_cache_evictions += n_evicted;
+
+	return(n_evicted);
 }
 
 /****************************************************************//**
@@ -1749,6 +2037,12 @@ undo_size_ok:
 		       dict_index_is_ibuf(index)
 		       ? SYNC_IBUF_INDEX_TREE : SYNC_INDEX_TREE);
 
+	if (dict_table_zip_size(table)) {
+		mutex_create(index_zip_pad_mutex_key,
+			     &new_index->zip_pad.mutex, SYNC_ANY_LATCH);
+		new_index->zip_pad.enabled = TRUE;
+	}
+
 	if (!UNIV_UNLIKELY(new_index->type & DICT_UNIVERSAL)) {
 
 		new_index->stat_n_diff_key_vals = mem_heap_alloc(
@@ -1810,7 +2104,7 @@ dict_index_remove_from_cache(
 	zero. */
 
 	for (;;) {
-		ulint ref_count = btr_search_info_get_ref_count(info);
+		ulint ref_count = btr_search_info_get_ref_count(info, index);
 		if (ref_count == 0) {
 			break;
 		}
@@ -1840,8 +2134,18 @@ dict_index_remove_from_cache(
 		}
 	}
 
+	/* The log should have been freed when online index creation
+	completed or was aborted. */
+	ut_ad(!index->online_log);
+	row_log_free(index);
+
 	rw_lock_free(&index->lock);
 
+	if (index->zip_pad.enabled) {
+		mutex_free(&index->zip_pad.mutex);
+		index->zip_pad.enabled = FALSE;
+	}
+
 	/* Remove the index from the list of indexes of the table */
 	UT_LIST_REMOVE(indexes, table->indexes, index);
 
@@ -4333,17 +4637,20 @@ dict_index_calc_min_rec_len(
 }
 
 /*********************************************************************//**
-Calculates new estimates for table and index statistics. The statistics
-are used in query optimization. */
+Calculates new estimates for table and index statistics, sampling the
+given number of leaf pages of each index. The statistics are used in
+query optimization. */
 UNIV_INTERN
 void
-dict_update_statistics(
-/*===================*/
+dict_update_statistics_low(
+/*=======================*/
 	dict_table_t*	table,		/*!< in/out: table */
-	ibool		only_calc_if_missing_stats)/*!< in: only
+	ibool		only_calc_if_missing_stats,/*!< in: only
 					update/recalc the stats if they have
 					not been initialized yet, otherwise
 					do nothing */
+	ullint		n_sample_pages)	/*!< in: number of leaf pages
+					to sample per index */
 {
 	dict_index_t*	index;
 	ulint		sum_of_index_sizes	= 0;
@@ -4410,7 +4717,8 @@ dict_update_statistics(
 
 			index->stat_n_leaf_pages = size;
 
-			btr_estimate_number_of_different_key_vals(index);
+			btr_estimate_number_of_different_key_vals(
+				index, n_sample_pages);
 		} else {
 			/* If we have set a high innodb_force_recovery
 			level, do not calculate statistics, as a badly
@@ -4453,6 +4761,24 @@ fake_statistics:
 	dict_table_stats_unlock(table, RW_X_LATCH);
 }
 
+/*********************************************************************//**
+Calculates new estimates for table and index statistics, sampling
+innodb_stats_sample_pages leaf pages of each index. The statistics
+are used in query optimization. */
+UNIV_INTERN
+void
+dict_update_statistics(
+/*===================*/
+	dict_table_t*	table,		/*!< in/out: table */
+	ibool		only_calc_if_missing_stats)/*!< in: only
+					update/recalc the stats if they have
+					not been initialized yet, otherwise
+					do nothing */
+{
+	dict_update_statistics_low(table, only_calc_if_missing_stats,
+				   srv_stats_sample_pages);
+}
+
 #ifndef UNIV_HOTBACKUP
 /**********************************************************************//**
 Prints info of a foreign key constraint. */
@@ -5131,6 +5457,8 @@ dict_close(void)
 
 	mutex_free(&dict_sys->mutex);
 
+	rw_lock_free(&dict_sys->table_hash_latch);
+
 	rw_lock_free(&dict_operation_lock);
 	memset(&dict_operation_lock, 0x0, sizeof(dict_operation_lock));
 
@@ -5142,6 +5470,8 @@ dict_close(void)
 	for (i = 0; i < DICT_TABLE_STATS_LATCHES_SIZE; i++) {
 		rw_lock_free(&dict_table_stats_latches[i]);
 	}
+
+	dict_stats_close();
 }
 
 /**********************************************************************//**
@@ -5326,4 +5656,122 @@ dict_set_corrupted_index_cache_only(
 
 	index->type |= DICT_CORRUPT;
 }
+
+/**********************************************************************//**
+Ends a round of compressions of an index if it is complete, and adjusts
+the padding of the index according to the failure rate of the round.
+The caller must hold zip_pad->mutex. */
+static
+void
+dict_index_zip_pad_update(
+/*======================*/
+	zip_pad_info_t*	zip_pad,	/*!< in/out: padding info */
+	ulint		threshold)	/*!< in: highest acceptable
+					failure percentage */
+{
+	ulint	total;
+	ulint	fail_pct;
+
+	ut_ad(mutex_own(&zip_pad->mutex));
+
+	total = zip_pad->success + zip_pad->failure;
+
+	if (total < ZIP_PAD_ROUND_LEN) {
+		/* The round is not complete yet. */
+		return;
+	}
+
+	fail_pct = (zip_pad->failure * 100) / total;
+
+	zip_pad->success = 0;
+	zip_pad->failure = 0;
+
+	if (fail_pct > threshold) {
+		/* Too many failures: leave more space empty, unless
+		the padding would exceed innodb_compression_pad_pct_max. */
+		if (zip_pad->pad + ZIP_PAD_INCR
+		    < (UNIV_PAGE_SIZE * dict_zip_pad_max) / 100) {
+
+			zip_pad->pad += ZIP_PAD_INCR;
+		}
+
+		zip_pad->n_rounds = 0;
+	} else if (++zip_pad->n_rounds >= ZIP_PAD_SUCCESSFUL_ROUND_LIMIT
+		   && zip_pad->pad > 0) {
+		/* The failure rate has been acceptable for long enough:
+		try packing the pages more densely again. */
+		zip_pad->pad -= ZIP_PAD_INCR;
+		zip_pad->n_rounds = 0;
+	}
+}
+
+/**********************************************************************//**
+Records a successful compression of a leaf page of an index. */
+UNIV_INTERN
+void
+dict_index_zip_success(
+/*===================*/
+	dict_index_t*	index)	/*!< in/out: index */
+{
+	ulint	threshold = dict_zip_failure_threshold_pct;
+
+	if (!threshold || !index->zip_pad.enabled) {
+
+		return;
+	}
+
+	mutex_enter(&index->zip_pad.mutex);
+	index->zip_pad.success++;
+	dict_index_zip_pad_update(&index->zip_pad, threshold);
+	mutex_exit(&index->zip_pad.mutex);
+}
+
+/**********************************************************************//**
+Records a failed compression of a leaf page of an index. */
+UNIV_INTERN
+void
+dict_index_zip_failure(
+/*===================*/
+	dict_index_t*	index)	/*!< in/out: index */
+{
+	ulint	threshold = dict_zip_failure_threshold_pct;
+
+	if (!threshold || !index->zip_pad.enabled) {
+
+		return;
+	}
+
+	mutex_enter(&index->zip_pad.mutex);
+	index->zip_pad.failure++;
+	dict_index_zip_pad_update(&index->zip_pad, threshold);
+	mutex_exit(&index->zip_pad.mutex);
+}
+
+/**********************************************************************//**
+Returns the amount of data that should be stored on an uncompressed leaf
+page of an index, so that the page is likely to compress.
+@return	number of bytes, at most UNIV_PAGE_SIZE */
+UNIV_INTERN
+ulint
+dict_index_zip_pad_optimal_page_size(
+/*=================================*/
+	const dict_index_t*	index)	/*!< in: index */
+{
+	ulint	pad;
+	ulint	min_size;
+
+	if (!dict_zip_failure_threshold_pct || !index->zip_pad.enabled) {
+
+		return(UNIV_PAGE_SIZE);
+	}
+
+	/* A dirty read suffices: the padding is only a hint. */
+	pad = index->zip_pad.pad;
+
+	ut_ad(pad < UNIV_PAGE_SIZE);
+
+	min_size = (UNIV_PAGE_SIZE * (100 - dict_zip_pad_max)) / 100;
+
+	return(ut_max(UNIV_PAGE_SIZE - pad, min_size));
+}
 #endif /* !UNIV_HOTBACKUP */
@@ -0,0 +1,941 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file dict/dict0stats.c
+Persistent table and index statistics
+
+When innodb_stats_persistent is set, the statistics of a table are
+stored in the system tables SYS_TABLE_STATS and SYS_INDEX_STATS. They
+are loaded when the table is first opened, also after a restart, and
+they are only recalculated by ANALYZE TABLE and by the statistics
+thread, which handles the tables in which more than 10% of the rows
+have changed. This keeps query plans stable and avoids sampling the
+indexes of every table that is opened on a cold server.
+
+SYS_TABLE_STATS has one row per table: the number of rows and the
+sizes of the clustered and the secondary indexes in pages.
+SYS_INDEX_STATS has one row per index: its size and number of leaf
+pages in pages, and the stat_n_diff_key_vals[] and
+stat_n_non_null_key_vals[] arrays as 8-byte big-endian integers.
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#include "dict0stats.h"
+
+#ifndef UNIV_HOTBACKUP
+#include "btr0pcur.h"
+#include "data0data.h"
+#include "dict0dict.h"
+#include "mach0data.h"
+#include "pars0pars.h"
+#include "que0que.h"
+#include "rem0rec.h"
+#include "row0mysql.h"
+#include "srv0srv.h"
+#include "srv0start.h"
+#include "sync0sync.h"
+#include "trx0roll.h"
+#include "trx0trx.h"
+#include "ut0mem.h"
+
+/** Interval in seconds at which the statistics thread handles the
+tables waiting for it */
+#define DICT_STATS_RECALC_INTERVAL	10
+
+/** Event to wake up the statistics thread, at shutdown */
+UNIV_INTERN os_event_t	dict_stats_event;
+
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t	dict_stats_recalc_pool_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** TRUE if SYS_TABLE_STATS and SYS_INDEX_STATS exist */
+static ibool		dict_stats_tables_exist = FALSE;
+
+/** Protects the dict_stats_recalc_pool* variables */
+static mutex_t		dict_stats_recalc_pool_mutex;
+
+/** Ids of the tables waiting for the statistics thread */
+static table_id_t*	dict_stats_recalc_pool = NULL;
+
+/** Number of tables in dict_stats_recalc_pool */
+static ulint		dict_stats_recalc_pool_n = 0;
+
+/** Number of allocated elements of dict_stats_recalc_pool */
+static ulint		dict_stats_recalc_pool_size = 0;
+
+/*********************************************************************//**
+Creates the persistent statistics tables SYS_TABLE_STATS and
+SYS_INDEX_STATS if they do not exist yet. Called once at startup.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+dict_stats_create_tables(void)
+/*==========================*/
+{
+	dict_table_t*	table1;
+	dict_table_t*	table2;
+	ulint		error;
+	trx_t*		trx;
+
+	mutex_enter(&(dict_sys->mutex));
+
+	table1 = dict_table_get_low("SYS_TABLE_STATS");
+	table2 = dict_table_get_low("SYS_INDEX_STATS");
+
+	if (table1 && table2
+	    && UT_LIST_GET_LEN(table1->indexes) == 1
+	    && UT_LIST_GET_LEN(table2->indexes) == 1) {
+
+		/* The statistics tables have already been created,
+		and they are ok */
+
+		mutex_exit(&(dict_sys->mutex));
+
+		dict_stats_tables_exist = TRUE;
+
+		return(DB_SUCCESS);
+	}
+
+	mutex_exit(&(dict_sys->mutex));
+
+	trx = trx_allocate_for_mysql();
+
+	trx->op_info = "creating statistics sys tables";
+
+	row_mysql_lock_data_dictionary(trx);
+
+	if (table1) {
+		fprintf(stderr,
+			"InnoDB: dropping incompletely created"
+			" SYS_TABLE_STATS table\n");
+		row_drop_table_for_mysql("SYS_TABLE_STATS", trx, TRUE);
+	}
+
+	if (table2) {
+		fprintf(stderr,
+			"InnoDB: dropping incompletely created"
+			" SYS_INDEX_STATS table\n");
+		row_drop_table_for_mysql("SYS_INDEX_STATS", trx, TRUE);
+	}
+
+	fprintf(stderr, "InnoDB: Creating statistics system tables\n");
+
+	/* NOTE: dict_stats_fetch() relies on the column order below */
+
+	error = que_eval_sql(NULL,
+			     "PROCEDURE CREATE_STATS_SYS_TABLES_PROC () IS\n"
+			     "BEGIN\n"
+			     "CREATE TABLE\n"
+			     "SYS_TABLE_STATS(NAME CHAR, N_ROWS BINARY(8),"
+			     " CLUST_SIZE INT, OTHER_SIZE INT);\n"
+			     "CREATE UNIQUE CLUSTERED INDEX NAME_IND"
+			     " ON SYS_TABLE_STATS (NAME);\n"
+			     "CREATE TABLE\n"
+			     "SYS_INDEX_STATS(TABLE_NAME CHAR, INDEX_NAME CHAR,"
+			     " SIZE INT, N_LEAF_PAGES INT,"
+			     " N_DIFF BLOB, N_NON_NULL BLOB);\n"
+			     "CREATE UNIQUE CLUSTERED INDEX NAME_IND"
+			     " ON SYS_INDEX_STATS (TABLE_NAME, INDEX_NAME);\n"
+			     "END;\n"
+			     , FALSE, trx);
+
+	if (error != DB_SUCCESS) {
+		fprintf(stderr, "InnoDB: error %lu in creation\n",
+			(ulong) error);
+
+		ut_a(error == DB_OUT_OF_FILE_SPACE
+		     || error == DB_TOO_MANY_CONCURRENT_TRXS);
+
+		fprintf(stderr,
+			"InnoDB: creation failed\n"
+			"InnoDB: tablespace is full\n"
+			"InnoDB: dropping incompletely created"
+			" statistics tables\n");
+
+		row_drop_table_for_mysql("SYS_TABLE_STATS", trx, TRUE);
+		row_drop_table_for_mysql("SYS_INDEX_STATS", trx, TRUE);
+
+		error = DB_MUST_GET_MORE_FILE_SPACE;
+	}
+
+	trx_commit_for_mysql(trx);
+
+	row_mysql_unlock_data_dictionary(trx);
+
+	trx_free_for_mysql(trx);
+
+	if (error == DB_SUCCESS) {
+		fprintf(stderr,
+			"InnoDB: Statistics system tables created\n");
+
+		dict_stats_tables_exist = TRUE;
+	}
+
+	return(error);
+}
+
+/*********************************************************************//**
+Positions a cursor on the record of a statistics table whose key
+equals the given tuple.
+@return	the record, or NULL if there is no such record */
+static
+const rec_t*
+dict_stats_search_rec(
+/*==================*/
+	const char*	sys_name,	/*!< in: statistics table name */
+	const dtuple_t*	tuple,		/*!< in: key */
+	btr_pcur_t*	pcur,		/*!< out: persistent cursor */
+	mtr_t*		mtr)		/*!< in/out: mini-transaction */
+{
+	dict_table_t*	sys_table;
+	dict_index_t*	sys_index;
+	const rec_t*	rec;
+	ulint		i;
+
+	ut_ad(mutex_own(&(dict_sys->mutex)));
+
+	sys_table = dict_table_get_low(sys_name);
+	ut_a(!dict_table_is_comp(sys_table));
+	sys_index = UT_LIST_GET_FIRST(sys_table->indexes);
+
+	btr_pcur_open_on_user_rec(sys_index, tuple, PAGE_CUR_GE,
+				  BTR_SEARCH_LEAF, pcur, mtr);
+
+	if (!btr_pcur_is_on_user_rec(pcur)) {
+
+		return(NULL);
+	}
+
+	rec = btr_pcur_get_rec(pcur);
+
+	if (rec_get_deleted_flag(rec, 0)) {
+
+		return(NULL);
+	}
+
+	for (i = 0; i < dtuple_get_n_fields(tuple); i++) {
+		const dfield_t*	dfield = dtuple_get_nth_field(tuple, i);
+		const byte*	field;
+		ulint		len;
+
+		field = rec_get_nth_field_old(rec, i, &len);
+
+		if (len != dfield_get_len(dfield)
+		    || memcmp(field, dfield_get_data(dfield), len)) {
+
+			return(NULL);
+		}
+	}
+
+	return(rec);
+}
+
+/*********************************************************************//**
+Reads an array of 8-byte statistics values from a SYS_INDEX_STATS
+record into a buffer.
+@return	TRUE if the stored array has the expected number of elements */
+static
+ibool
+dict_stats_read_array(
+/*==================*/
+	const rec_t*	rec,	/*!< in: SYS_INDEX_STATS record */
+	ulint		field_no,/*!< in: field number */
+	ib_int64_t*	vals,	/*!< out: values */
+	ulint		n_vals)	/*!< in: number of values */
+{
+	const byte*	field;
+	ulint		len;
+	ulint		i;
+
+	field = rec_get_nth_field_old(rec, field_no, &len);
+
+	if (len != n_vals * 8) {
+
+		return(FALSE);
+	}
+
+	for (i = 0; i < n_vals; i++) {
+		vals[i] = (ib_int64_t) mach_read_from_8(field + i * 8);
+	}
+
+	return(TRUE);
+}
+
+/*********************************************************************//**
+Loads the statistics of a table and all its indexes from
+SYS_TABLE_STATS and SYS_INDEX_STATS. The in-memory statistics are only
+changed if the statistics of the table and of every index are found.
+@return	TRUE if the statistics were loaded */
+static
+ibool
+dict_stats_fetch(
+/*=============*/
+	dict_table_t*	table)	/*!< in/out: table */
+{
+	mem_heap_t*	heap;
+	dict_index_t*	index;
+	dtuple_t*	tuple;
+	btr_pcur_t	pcur;
+	mtr_t		mtr;
+	const rec_t*	rec;
+	const byte*	field;
+	ulint		len;
+	ulint		n_indexes;
+	ulint		i;
+	ib_int64_t	n_rows = 0;
+	ulint		clust_size = 0;
+	ulint		other_size = 0;
+	ulint*		index_size;
+	ulint*		n_leaf_pages;
+	ib_int64_t**	n_diff;
+	ib_int64_t**	n_non_null;
+	ibool		found;
+
+	heap = mem_heap_create(1000);
+
+	mutex_enter(&(dict_sys->mutex));
+
+	n_indexes = UT_LIST_GET_LEN(table->indexes);
+
+	index_size = mem_heap_alloc(heap, n_indexes * sizeof *index_size);
+	n_leaf_pages = mem_heap_alloc(heap, n_indexes * sizeof *n_leaf_pages);
+	n_diff = mem_heap_alloc(heap, n_indexes * sizeof *n_diff);
+	n_non_null = mem_heap_alloc(heap, n_indexes * sizeof *n_non_null);
+
+	/* The table row */
+
+	mtr_start(&mtr);
+
+	tuple = dtuple_create(heap, 1);
+	dfield_set_data(dtuple_get_nth_field(tuple, 0),
+			table->name, ut_strlen(table->name));
+	dict_index_copy_types(tuple, UT_LIST_GET_FIRST(
+		dict_table_get_low("SYS_TABLE_STATS")->indexes), 1);
+
+	rec = dict_stats_search_rec("SYS_TABLE_STATS", tuple, &pcur, &mtr);
+
+	found = rec != NULL;
+
+	if (found) {
+		field = rec_get_nth_field_old(rec, 3, &len);
+		ut_a(len == 8);
+		n_rows = (ib_int64_t) mach_read_from_8(field);
+
+		field = rec_get_nth_field_old(rec, 4, &len);
+		ut_a(len == 4);
+		clust_size = mach_read_from_4(field);
+
+		field = rec_get_nth_field_old(rec, 5, &len);
+		ut_a(len == 4);
+		other_size = mach_read_from_4(field);
+	}
+
+	btr_pcur_close(&pcur);
+	mtr_commit(&mtr);
+
+	/* The index rows */
+
+	for (index = dict_table_get_first_index(table), i = 0;
+	     found && index != NULL;
+	     index = dict_table_get_next_index(index), i++) {
+
+		ulint	n_vals = 1 + dict_index_get_n_unique(index);
+
+		if (index->stat_n_diff_key_vals == NULL) {
+			found = FALSE;
+			break;
+		}
+
+		mtr_start(&mtr);
+
+		tuple = dtuple_create(heap, 2);
+		dfield_set_data(dtuple_get_nth_field(tuple, 0),
+				table->name, ut_strlen(table->name));
+		dfield_set_data(dtuple_get_nth_field(tuple, 1),
+				index->name, ut_strlen(index->name));
+		dict_index_copy_types(tuple, UT_LIST_GET_FIRST(
+			dict_table_get_low("SYS_INDEX_STATS")->indexes), 2);
+
+		rec = dict_stats_search_rec("SYS_INDEX_STATS", tuple,
+					    &pcur, &mtr);
+
+		n_diff[i] = mem_heap_alloc(heap, n_vals * sizeof **n_diff);
+		n_non_null[i] = mem_heap_alloc(
+			heap, n_vals * sizeof **n_non_null);
+
+		found = rec != NULL
+			&& dict_stats_read_array(rec, 6, n_diff[i], n_vals)
+			&& dict_stats_read_array(rec, 7, n_non_null[i],
+						 n_vals);
+
+		if (found) {
+			field = rec_get_nth_field_old(rec, 4, &len);
+			ut_a(len == 4);
+			index_size[i] = mach_read_from_4(field);
+
+			field = rec_get_nth_field_old(rec, 5, &len);
+			ut_a(len == 4);
+			n_leaf_pages[i] = mach_read_from_4(field);
+		}
+
+		btr_pcur_close(&pcur);
+		mtr_commit(&mtr);
+	}
+
+	if (found) {
+		dict_table_stats_lock(table, RW_X_LATCH);
+
+		for (index = dict_table_get_first_index(table), i = 0;
+		     index != NULL;
+		     index = dict_table_get_next_index(index), i++) {
+
+			ulint	n_vals = 1 + dict_index_get_n_unique(index);
+
+			index->stat_index_size = index_size[i];
+			index->stat_n_leaf_pages = n_leaf_pages[i];
+			memcpy(index->stat_n_diff_key_vals, n_diff[i],
+			       n_vals * sizeof **n_diff);
+			memcpy(index->stat_n_non_null_key_vals, n_non_null[i],
+			       n_vals * sizeof **n_non_null);
+		}
+
+		table->stat_n_rows = n_rows;
+		table->stat_clustered_index_size = clust_size;
+		table->stat_sum_of_other_index_sizes = other_size;
+		table->stat_initialized = TRUE;
+		table->stat_modified_counter = 0;
+
+		dict_table_stats_unlock(table, RW_X_LATCH);
+	}
+
+	mutex_exit(&(dict_sys->mutex));
+
+	mem_heap_free(heap);
+
+	return(found);
+}
+
+/*********************************************************************//**
+Converts an array of statistics values to 8-byte big-endian integers.
+@return	the converted array, allocated from heap */
+static
+byte*
+dict_stats_write_array(
+/*===================*/
+	const ib_int64_t*	vals,	/*!< in: values */
+	ulint			n_vals,	/*!< in: number of values */
+	mem_heap_t*		heap)	/*!< in: memory heap */
+{
+	byte*	buf = mem_heap_alloc(heap, n_vals * 8);
+	ulint	i;
+
+	for (i = 0; i < n_vals; i++) {
+		mach_write_to_8(buf + i * 8, (ib_uint64_t) vals[i]);
+	}
+
+	return(buf);
+}
+
+/*********************************************************************//**
+Stores the statistics of a table and all its indexes in SYS_TABLE_STATS
+and SYS_INDEX_STATS, replacing the previously stored ones. */
+static
+void
+dict_stats_save(
+/*============*/
+	dict_table_t*	table)	/*!< in: table */
+{
+	trx_t*		trx;
+	mem_heap_t*	heap;
+	pars_info_t*	info;
+	dict_index_t*	index;
+	const char*	table_name;
+	ulint		err;
+
+	if (srv_force_recovery > 0 || !table->stat_initialized) {
+		/* Do not modify the statistics tables in a forced
+		recovery, and do not store the default statistics. */
+
+		return;
+	}
+
+	heap = mem_heap_create(1000);
+
+	trx = trx_allocate_for_background();
+
+	trx->op_info = "saving table statistics";
+
+	row_mysql_lock_data_dictionary(trx);
+
+	table_name = mem_heap_strdup(heap, table->name);
+
+	info = pars_info_create();
+
+	dict_table_stats_lock(table, RW_S_LATCH);
+
+	pars_info_add_str_literal(info, "table_name", table_name);
+	pars_info_add_ull_literal(info, "n_rows", table->stat_n_rows);
+	pars_info_add_int4_literal(info, "clust_size",
+				   table->stat_clustered_index_size);
+	pars_info_add_int4_literal(info, "other_size",
+				   table->stat_sum_of_other_index_sizes);
+
+	dict_table_stats_unlock(table, RW_S_LATCH);
+
+	err = que_eval_sql(info,
+			   "PROCEDURE SAVE_TABLE_STATS_PROC () IS\n"
+			   "BEGIN\n"
+			   "DELETE FROM SYS_TABLE_STATS\n"
+			   "WHERE NAME = :table_name;\n"
+			   "DELETE FROM SYS_INDEX_STATS\n"
+			   "WHERE TABLE_NAME = :table_name;\n"
+			   "INSERT INTO SYS_TABLE_STATS VALUES\n"
+			   "(:table_name, :n_rows, :clust_size,"
+			   " :other_size);\n"
+			   "END;\n"
+			   , FALSE, trx);
+
+	for (index = dict_table_get_first_index(table);
+	     index != NULL && err == DB_SUCCESS;
+	     index = dict_table_get_next_index(index)) {
+
+		ulint	n_vals = 1 + dict_index_get_n_unique(index);
+
+		if (*index->name == TEMP_INDEX_PREFIX
+		    || index->to_be_dropped
+		    || index->stat_n_diff_key_vals == NULL) {
+
+			continue;
+		}
+
+		info = pars_info_create();
+
+		dict_table_stats_lock(table, RW_S_LATCH);
+
+		pars_info_add_str_literal(info, "table_name", table_name);
+		pars_info_add_str_literal(info, "index_name", index->name);
+		pars_info_add_int4_literal(info, "size",
+					   index->stat_index_size);
+		pars_info_add_int4_literal(info, "n_leaf_pages",
+					   index->stat_n_leaf_pages);
+		pars_info_add_literal(info, "n_diff",
+				      dict_stats_write_array(
+					      index->stat_n_diff_key_vals,
+					      n_vals, heap),
+				      n_vals * 8, DATA_BLOB,
+				      DATA_BINARY_TYPE);
+		pars_info_add_literal(info, "n_non_null",
+				      dict_stats_write_array(
+					      index->stat_n_non_null_key_vals,
+					      n_vals, heap),
+				      n_vals * 8, DATA_BLOB,
+				      DATA_BINARY_TYPE);
+
+		dict_table_stats_unlock(table, RW_S_LATCH);
+
+		err = que_eval_sql(info,
+				   "PROCEDURE SAVE_INDEX_STATS_PROC () IS\n"
+				   "BEGIN\n"
+				   "INSERT INTO SYS_INDEX_STATS VALUES\n"
+				   "(:table_name, :index_name, :size,"
+				   " :n_leaf_pages, :n_diff, :n_non_null);\n"
+				   "END;\n"
+				   , FALSE, trx);
+	}
+
+	if (err == DB_SUCCESS) {
+		trx_commit_for_mysql(trx);
+	} else {
+		trx->error_state = DB_SUCCESS;
+		trx_general_rollback_for_mysql(trx, NULL);
+		trx->error_state = DB_SUCCESS;
+
+		ut_print_timestamp(stderr);
+		fputs("  InnoDB: Error: cannot save the statistics of table ",
+		      stderr);
+		ut_print_name(stderr, trx, TRUE, table_name);
+		fprintf(stderr, ", error %lu\n", (ulong) err);
+	}
+
+	row_mysql_unlock_data_dictionary(trx);
+
+	trx_free_for_background(trx);
+
+	mem_heap_free(heap);
+}
+
+/*********************************************************************//**
+Updates the statistics of a table from or to the persistent statistics
+tables. Must not be called while holding the data dictionary latch or
+mutex. */
+UNIV_INTERN
+void
+dict_stats_update(
+/*==============*/
+	dict_table_t*			table,	/*!< in/out: table */
+	enum dict_stats_upd_option	option)	/*!< in: how to update */
+{
+	if (!dict_stats_tables_exist) {
+		/* Fall back to the transient statistics */
+		dict_update_statistics(table, option == DICT_STATS_FETCH);
+
+		return;
+	}
+
+	switch (option) {
+	case DICT_STATS_FETCH:
+		if (table->stat_initialized || dict_stats_fetch(table)) {
+
+			return;
+		}
+
+		dict_update_statistics_low(
+			table, TRUE /* only update stats if they have not
+			been initialized */,
+			srv_stats_persistent_sample_pages);
+
+		/* The caller may hold the data dictionary latch in S
+		mode, for example during a foreign key check, so leave
+		storing the statistics to the statistics thread. */
+		dict_stats_recalc_pool_add(table);
+
+		return;
+
+	case DICT_STATS_RECALC_PERSISTENT:
+		/* The statistics thread need not do this again */
+		dict_stats_recalc_pool_del(table);
+
+		dict_update_statistics_low(
+			table, FALSE /* update even if stats are
+			initialized */,
+			srv_stats_persistent_sample_pages);
+
+		dict_stats_save(table);
+
+		return;
+	}
+
+	ut_error;
+}
+
+/*********************************************************************//**
+Deletes the persistent statistics of a table that is being dropped.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+dict_stats_drop_table(
+/*==================*/
+	const char*	table_name,	/*!< in: table name */
+	trx_t*		trx)		/*!< in: transaction holding the
+					data dictionary latch in X mode */
+{
+	pars_info_t*	info;
+
+	ut_ad(trx->dict_operation_lock_mode == RW_X_LATCH);
+
+	if (!dict_stats_tables_exist) {
+
+		return(DB_SUCCESS);
+	}
+
+	info = pars_info_create();
+
+	pars_info_add_str_literal(info, "table_name", table_name);
+
+	return(que_eval_sql(info,
+			    "PROCEDURE DROP_TABLE_STATS_PROC () IS\n"
+			    "BEGIN\n"
+			    "DELETE FROM SYS_TABLE_STATS\n"
+			    "WHERE NAME = :table_name;\n"
+			    "DELETE FROM SYS_INDEX_STATS\n"
+			    "WHERE TABLE_NAME = :table_name;\n"
+			    "END;\n"
+			    , FALSE, trx));
+}
+
+/*********************************************************************//**
+Moves the persistent statistics of a table that is being renamed.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+dict_stats_rename_table(
+/*====================*/
+	const char*	old_name,	/*!< in: old table name */
+	const char*	new_name,	/*!< in: new table name */
+	trx_t*		trx)		/*!< in: transaction holding the
+					data dictionary latch in X mode */
+{
+	pars_info_t*	info;
+
+	ut_ad(trx->dict_operation_lock_mode == RW_X_LATCH);
+
+	if (!dict_stats_tables_exist) {
+
+		return(DB_SUCCESS);
+	}
+
+	info = pars_info_create();
+
+	pars_info_add_str_literal(info, "new_table_name", new_name);
+	pars_info_add_str_literal(info, "old_table_name", old_name);
+
+	/* Remove any stale statistics stored under the new name first,
+	so that the update cannot fail on a duplicate key. */
+
+	return(que_eval_sql(info,
+			    "PROCEDURE RENAME_TABLE_STATS_PROC () IS\n"
+			    "BEGIN\n"
+			    "DELETE FROM SYS_TABLE_STATS\n"
+			    "WHERE NAME = :new_table_name;\n"
+			    "DELETE FROM SYS_INDEX_STATS\n"
+			    "WHERE TABLE_NAME = :new_table_name;\n"
+			    "UPDATE SYS_TABLE_STATS SET NAME = :new_table_name\n"
+			    "WHERE NAME = :old_table_name;\n"
+			    "UPDATE SYS_INDEX_STATS"
+			    " SET TABLE_NAME = :new_table_name\n"
+			    "WHERE TABLE_NAME = :old_table_name;\n"
+			    "END;\n"
+			    , FALSE, trx));
+}
+
+/*********************************************************************//**
+Asks the statistics thread to recalculate and store the persistent
+statistics of a table. Does nothing if the table is already waiting. */
+UNIV_INTERN
+void
+dict_stats_recalc_pool_add(
+/*=======================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	ulint	i;
+
+	mutex_enter(&dict_stats_recalc_pool_mutex);
+
+	for (i = 0; i < dict_stats_recalc_pool_n; i++) {
+		if (dict_stats_recalc_pool[i] == table->id) {
+			mutex_exit(&dict_stats_recalc_pool_mutex);
+
+			return;
+		}
+	}
+
+	if (dict_stats_recalc_pool_n == dict_stats_recalc_pool_size) {
+		ulint		size = dict_stats_recalc_pool_size
+			? 2 * dict_stats_recalc_pool_size : 64;
+		table_id_t*	pool = ut_malloc(size * sizeof *pool);
+
+		if (dict_stats_recalc_pool != NULL) {
+			memcpy(pool, dict_stats_recalc_pool,
+			       dict_stats_recalc_pool_n * sizeof *pool);
+			ut_free(dict_stats_recalc_pool);
+		}
+
+		dict_stats_recalc_pool = pool;
+		dict_stats_recalc_pool_size = size;
+	}
+
+	dict_stats_recalc_pool[dict_stats_recalc_pool_n++] = table->id;
+
+	mutex_exit(&dict_stats_recalc_pool_mutex);
+}
+
+/*********************************************************************//**
+Removes a table from the tables waiting for the statistics thread, for
+example because it is being dropped. */
+UNIV_INTERN
+void
+dict_stats_recalc_pool_del(
+/*=======================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	ulint	i;
+
+	mutex_enter(&dict_stats_recalc_pool_mutex);
+
+	for (i = 0; i < dict_stats_recalc_pool_n; i++) {
+		if (dict_stats_recalc_pool[i] == table->id) {
+			dict_stats_recalc_pool_n--;
+			memmove(dict_stats_recalc_pool + i,
+				dict_stats_recalc_pool + i + 1,
+				(dict_stats_recalc_pool_n - i)
+				* sizeof *dict_stats_recalc_pool);
+			break;
+		}
+	}
+
+	mutex_exit(&dict_stats_recalc_pool_mutex);
+}
+
+/*********************************************************************//**
+Takes the first table from the tables waiting for the statistics thread.
+@return	TRUE if there was a table */
+static
+ibool
+dict_stats_recalc_pool_get(
+/*=======================*/
+	table_id_t*	id)	/*!< out: table id */
+{
+	ibool	found;
+
+	mutex_enter(&dict_stats_recalc_pool_mutex);
+
+	found = dict_stats_recalc_pool_n > 0;
+
+	if (found) {
+		*id = dict_stats_recalc_pool[0];
+		dict_stats_recalc_pool_n--;
+		memmove(dict_stats_recalc_pool, dict_stats_recalc_pool + 1,
+			dict_stats_recalc_pool_n
+			* sizeof *dict_stats_recalc_pool);
+	}
+
+	mutex_exit(&dict_stats_recalc_pool_mutex);
+
+	return(found);
+}
+
+/*********************************************************************//**
+Recalculates and stores the persistent statistics of the first table
+waiting for the statistics thread.
+@return	TRUE if there was a table */
+static
+ibool
+dict_stats_process_entry_from_recalc_pool(void)
+/*===========================================*/
+{
+	table_id_t	id;
+	dict_table_t*	table;
+
+	if (!dict_stats_recalc_pool_get(&id)) {
+
+		return(FALSE);
+	}
+
+	if (!srv_stats_persistent) {
+		/* The statistics became transient after the table
+		was added */
+
+		return(TRUE);
+	}
+
+	mutex_enter(&(dict_sys->mutex));
+
+	table = dict_table_get_on_id_low(id);
+
+	if (table != NULL) {
+		/* Keep the table from being dropped or evicted while
+		we are using it. DROP TABLE will drop it in the
+		background instead. */
+		dict_table_increment_handle_count(table);
+	}
+
+	mutex_exit(&(dict_sys->mutex));
+
+	if (table == NULL) {
+		/* The table has been dropped or truncated */
+
+		return(TRUE);
+	}
+
+	dict_stats_update(table, DICT_STATS_RECALC_PERSISTENT);
+
+	dict_table_decrement_handle_count(table, FALSE);
+
+	return(TRUE);
+}
+
+/*********************************************************************//**
+Initializes the tables waiting for the statistics thread. Called by
+dict_init(), before any table can be modified or dropped. */
+UNIV_INTERN
+void
+dict_stats_init(void)
+/*=================*/
+{
+	mutex_create(dict_stats_recalc_pool_mutex_key,
+		     &dict_stats_recalc_pool_mutex, SYNC_STATS_AUTO_RECALC);
+
+	dict_stats_event = os_event_create(NULL);
+}
+
+/*********************************************************************//**
+Frees the resources allocated by dict_stats_init(). Called by
+dict_close(), after the statistics thread has exited. */
+UNIV_INTERN
+void
+dict_stats_close(void)
+/*==================*/
+{
+	mutex_free(&dict_stats_recalc_pool_mutex);
+
+	os_event_free(dict_stats_event);
+	dict_stats_event = NULL;
+
+	if (dict_stats_recalc_pool != NULL) {
+		ut_free(dict_stats_recalc_pool);
+		dict_stats_recalc_pool = NULL;
+	}
+
+	dict_stats_recalc_pool_n = 0;
+	dict_stats_recalc_pool_size = 0;
+	dict_stats_tables_exist = FALSE;
+}
+
+/*********************************************************************//**
+Statistics thread. Every DICT_STATS_RECALC_INTERVAL seconds it
+recalculates and stores the persistent statistics of the tables that
+were added by dict_stats_recalc_pool_add().
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+dict_stats_thread(
+/*==============*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(dict_stats_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+
+		/* The event is only set at shutdown. Waking up at a
+		fixed interval, rather than whenever a table is added,
+		limits how often a small, busy table is recalculated. */
+		os_event_wait_time_low(dict_stats_event,
+				       DICT_STATS_RECALC_INTERVAL * 1000000,
+				       0);
+
+		while (srv_shutdown_state == SRV_SHUTDOWN_NONE
+		       && dict_stats_process_entry_from_recalc_pool()) {
+		}
+	}
+
+	srv_dict_stats_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+#endif /* !UNIV_HOTBACKUP */
@@ -98,11 +98,17 @@ identifier.
 Some operating systems do not support many open files at the same time,
 though NT seems to tolerate at least 900 open files. Therefore, we put the
 open files in an LRU-list. If we need to open another file, we may close the
-file at the end of the LRU-list. When an i/o-operation is pending on a file,
-the file cannot be closed. We take the file nodes with pending i/o-operations
-out of the LRU-list and keep a count of pending operations. When an operation
-completes, we decrement the count and return the file node to the LRU-list if
-the count drops to zero. */
+least recently used file in the LRU-list that has no pending i/o-operations.
+When an i/o-operation is pending on a file, the file cannot be closed: we
+keep a count of pending operations in the file node.
+
+Most i/o-operations are on files that are already open. fil_io() then finds
+the file node while holding fil_system->latch in S mode, and increments the
+pending operation count of the node atomically, without fil_system->mutex.
+Completing a read only decrements the count. The hash table of spaces, the
+file chains of spaces and the open and stop flags are only changed while
+holding both fil_system->mutex and fil_system->latch in X mode, and a file
+is only closed with the latch in X mode when its count is zero. */
 
 /** When mysqld is run, the default directory "." is the mysqld datadir,
 but in the MySQL Embedded Server Library and ibbackup it is not the default
@@ -133,8 +139,25 @@ UNIV_INTERN mysql_pfs_key_t	fil_system_mutex_key;
 #ifdef UNIV_PFS_RWLOCK
 /* Key to register file space latch with performance schema */
 UNIV_INTERN mysql_pfs_key_t	fil_space_latch_key;
+/* Key to register fil_system->latch with performance schema */
+UNIV_INTERN mysql_pfs_key_t	fil_system_latch_key;
 #endif /* UNIV_PFS_RWLOCK */
 
+#if defined HAVE_ATOMIC_BUILTINS && !defined UNIV_HOTBACKUP
+/** fil_io() looks up open files without acquiring fil_system->mutex */
+# define FIL_IO_FAST_PATH
+/** Adds to a counter that fil_io() may update without fil_system->mutex */
+# define fil_counter_add(counter, n)				\
+	((void) os_atomic_increment_ulint(&(counter), n))
+/** Subtracts from a counter that fil_io() may update without
+fil_system->mutex */
+# define fil_counter_sub(counter, n)				\
+	((void) os_atomic_decrement_ulint(&(counter), n))
+#else /* HAVE_ATOMIC_BUILTINS && !UNIV_HOTBACKUP */
+# define fil_counter_add(counter, n)	((void) ((counter) += (n)))
+# define fil_counter_sub(counter, n)	((void) ((counter) -= (n)))
+#endif /* HAVE_ATOMIC_BUILTINS && !UNIV_HOTBACKUP */
+
 /** File node of a tablespace or the log data space */
 struct fil_node_struct {
 	fil_space_t*	space;	/*!< backpointer to the space where this node
@@ -150,11 +173,16 @@ struct fil_node_struct {
 	ulint		n_pending;
 				/*!< count of pending i/o's on this file;
 				closing of the file is not allowed if
-				this is > 0 */
+				this is > 0; updated with fil_counter_add()
+				and fil_counter_sub() */
 	ulint		n_pending_flushes;
 				/*!< count of pending flushes on this file;
 				closing of the file is not allowed if
 				this is > 0 */
+	ibool		being_extended;
+				/*!< TRUE if fil_extend_space_to_desired_size()
+				is extending this file without holding
+				fil_system->mutex */
 	ib_int64_t	modification_counter;/*!< when we write to the file we
 				increment this by one */
 	ib_int64_t	flush_counter;/*!< up to what
@@ -234,6 +262,11 @@ struct fil_space_struct {
 				file we have written to */
 	ibool		is_in_unflushed_spaces; /*!< TRUE if this space is
 				currently in unflushed_spaces */
+	UT_LIST_NODE_T(fil_space_t) preextend_spaces;
+				/*!< list of spaces waiting to be extended
+				in the background */
+	ibool		is_in_preextend_spaces; /*!< TRUE if this space is
+				currently in preextend_spaces */
 	UT_LIST_NODE_T(fil_space_t) space_list;
 	fil_stat_t	stat;	/*!< Space statistics */
 				/*!< list of all spaces */
@@ -254,6 +287,13 @@ struct fil_system_struct {
 #ifndef UNIV_HOTBACKUP
 	mutex_t		mutex;		/*!< The mutex protecting the cache */
 #endif /* !UNIV_HOTBACKUP */
+	rw_lock_t	latch;		/*!< Protects the spaces hash table,
+					the file chains of the spaces, and
+					fil_node_t::open, fil_space_t::stop_ios
+					and fil_space_t::stop_new_ops: they
+					are modified with both mutex and latch
+					X-locked, and read by fil_io() with
+					the latch S-locked */
 	hash_table_t*	spaces;		/*!< The hash table of spaces in the
 					system; they are hashed on the space
 					id */
@@ -261,11 +301,10 @@ struct fil_system_struct {
 					name */
 	UT_LIST_BASE_NODE_T(fil_node_t) LRU;
 					/*!< base node for the LRU list of the
-					most recently used open files with no
-					pending i/o's; if we start an i/o on
-					the file, we first remove it from this
-					list, and return it to the start of
-					the list when the i/o ends;
+					most recently used open files; a file
+					is moved to the start of the list when
+					fil_io() acquires fil_system->mutex
+					for an i/o on it;
 					log files and the system tablespace are
 					not put to this list: they are opened
 					after the startup, and kept open until
@@ -276,6 +315,11 @@ struct fil_system_struct {
 					unflushed writes; those spaces have
 					at least one file node where
 					modification_counter > flush_counter */
+	UT_LIST_BASE_NODE_T(fil_space_t) preextend_spaces;
+					/*!< base node for the list of those
+					tablespaces that are about to fill up
+					and that fsp_preextend_thread() should
+					extend, see fil_space_preextend_add() */
 	ulint		n_open;		/*!< number of files currently open */
 	ulint		max_n_open;	/*!< n_open is not allowed to exceed
 					this */
@@ -365,9 +409,9 @@ fil_account_close(
 NOTE: you must call fil_mutex_enter_and_prepare_for_io() first!
 
 Prepares a file node for i/o. Opens the file if it is closed. Updates the
-pending i/o's field in the node and the system appropriately. Takes the node
-off the LRU list if it is in the LRU list. The caller must hold the fil_sys
-mutex. */
+pending i/o's field in the node and the system appropriately. Moves the node
+to the start of the LRU list if it is in the LRU list. The caller must hold
+the fil_sys mutex. */
 static
 void
 fil_node_prepare_for_io(
@@ -477,7 +521,14 @@ fil_space_get_by_id(
 {
 	fil_space_t*	space;
 
-	ut_ad(mutex_own(&fil_system->mutex));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(mutex_own(&fil_system->mutex)
+	      || rw_lock_own(&fil_system->latch, RW_LOCK_SHARED));
+#else /* UNIV_SYNC_DEBUG */
+	/* The owners of an rw-lock are only known with UNIV_SYNC_DEBUG */
+	ut_ad(mutex_own(&fil_system->mutex)
+	      || rw_lock_is_locked(&fil_system->latch, RW_LOCK_SHARED));
+#endif /* UNIV_SYNC_DEBUG */
 
 	HASH_SEARCH(hash, fil_system->spaces, id,
 		    fil_space_t*, space,
@@ -654,6 +705,7 @@ fil_node_create(
 	node->magic_n = FIL_NODE_MAGIC_N;
 	node->n_pending = 0;
 	node->n_pending_flushes = 0;
+	node->being_extended = FALSE;
 
 	node->modification_counter = 0;
 	node->flush_counter = 0;
@@ -680,7 +732,9 @@ fil_node_create(
 
 	node->space = space;
 
+	rw_lock_x_lock(&fil_system->latch);
 	UT_LIST_ADD_LAST(chain, space->chain, node);
+	rw_lock_x_unlock(&fil_system->latch);
 
 	if (id < SRV_LOG_SPACE_FIRST_ID && fil_system->max_assigned_id < id) {
 
@@ -863,7 +917,9 @@ add_size:
 
 	ut_a(ret);
 
+	rw_lock_x_lock(&system->latch);
 	node->open = TRUE;
+	rw_lock_x_unlock(&system->latch);
 
 	fil_account_open(system);
 
@@ -886,6 +942,9 @@ fil_node_close_file(
 
 	ut_ad(node && system);
 	ut_ad(mutex_own(&(system->mutex)));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&system->latch, RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
 	ut_a(node->open);
 	ut_a(node->n_pending == 0);
 	ut_a(node->n_pending_flushes == 0);
@@ -912,8 +971,8 @@ fil_node_close_file(
 }
 
 /********************************************************************//**
-Tries to close a file in the LRU list. The caller must hold the fil_sys
-mutex.
+Tries to close a file with no pending i/o's in the LRU list. The caller must
+hold the fil_sys mutex.
 @return TRUE if success, FALSE if should retry later; since i/o's
 generally complete in < 100 ms, and as InnoDB writes at most 128 pages
 from the buffer pool in a batch, and then immediately flushes the
@@ -938,12 +997,18 @@ fil_try_to_close_file_in_LRU(
 			(ulong) UT_LIST_GET_LEN(fil_system->LRU));
 	}
 
+	/* fil_io() does not increment n_pending while we hold the latch */
+	rw_lock_x_lock(&fil_system->latch);
+
 	while (node != NULL) {
 		if (node->modification_counter == node->flush_counter
-		    && node->n_pending_flushes == 0) {
+		    && node->n_pending_flushes == 0
+		    && node->n_pending == 0) {
 
 			fil_node_close_file(node, fil_system);
 
+			rw_lock_x_unlock(&fil_system->latch);
+
 			return(TRUE);
 		}
 
@@ -964,9 +1029,18 @@ fil_try_to_close_file_in_LRU(
 				(long) node->flush_counter);
 		}
 
+		if (print_info && node->n_pending > 0) {
+			fputs("InnoDB: cannot close file ", stderr);
+			ut_print_filename(stderr, node->name);
+			fprintf(stderr, ", because n_pending %lu\n",
+				(ulong) node->n_pending);
+		}
+
 		node = UT_LIST_GET_PREV(LRU, node);
 	}
 
+	rw_lock_x_unlock(&fil_system->latch);
+
 	return(FALSE);
 }
 
@@ -1120,6 +1194,9 @@ fil_node_free(
 {
 	ut_ad(node && system && space);
 	ut_ad(mutex_own(&(system->mutex)));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&system->latch, RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
 	ut_a(node->magic_n == FIL_NODE_MAGIC_N);
 	ut_a(node->n_pending == 0);
 
@@ -1172,6 +1249,8 @@ fil_space_truncate_start(
 
 	ut_a(space);
 
+	rw_lock_x_lock(&fil_system->latch);
+
 	while (trunc_len > 0) {
 		node = UT_LIST_GET_FIRST(space->chain);
 
@@ -1182,6 +1261,8 @@ fil_space_truncate_start(
 		fil_node_free(node, fil_system, space);
 	}
 
+	rw_lock_x_unlock(&fil_system->latch);
+
 	mutex_exit(&fil_system->mutex);
 }
 #endif /* UNIV_LOG_ARCHIVE */
@@ -1332,11 +1413,14 @@ try_again:
 
 	rw_lock_create(fil_space_latch_key, &space->latch, SYNC_FSP);
 
+	rw_lock_x_lock(&fil_system->latch);
 	HASH_INSERT(fil_space_t, hash, fil_system->spaces, id, space);
+	rw_lock_x_unlock(&fil_system->latch);
 
 	HASH_INSERT(fil_space_t, name_hash, fil_system->name_hash,
 		    ut_fold_string(name), space);
 	space->is_in_unflushed_spaces = FALSE;
+	space->is_in_preextend_spaces = FALSE;
 
 	UT_LIST_ADD_LAST(space_list, fil_system->space_list, space);
 
@@ -1437,6 +1521,9 @@ fil_space_free(
 		return(FALSE);
 	}
 
+	/* Wait for fil_io() to release the space and its files */
+	rw_lock_x_lock(&fil_system->latch);
+
 	HASH_DELETE(fil_space_t, hash, fil_system->spaces, id, space);
 
 	namespace = fil_space_get_by_name(space->name);
@@ -1453,6 +1540,13 @@ fil_space_free(
 			       space);
 	}
 
+	if (space->is_in_preextend_spaces) {
+		space->is_in_preextend_spaces = FALSE;
+
+		UT_LIST_REMOVE(preextend_spaces, fil_system->preextend_spaces,
+			       space);
+	}
+
 	UT_LIST_REMOVE(space_list, fil_system->space_list, space);
 
 	ut_a(space->magic_n == FIL_SPACE_MAGIC_N);
@@ -1468,6 +1562,8 @@ fil_space_free(
 
 	ut_a(0 == UT_LIST_GET_LEN(space->chain));
 
+	rw_lock_x_unlock(&fil_system->latch);
+
 	if (x_latched) {
 		rw_lock_x_unlock(&space->latch);
 	}
@@ -1674,10 +1770,17 @@ fil_init(
 	mutex_create(fil_system_mutex_key,
 		     &fil_system->mutex, SYNC_ANY_LATCH);
 
+	/* The latch is acquired in X mode while holding the mutex, and
+	in S mode by fil_io() while holding various other latches: its
+	level is below those of all of them */
+	rw_lock_create(fil_system_latch_key,
+		       &fil_system->latch, SYNC_FIL_SYSTEM_LATCH);
+
 	fil_system->spaces = hash_create(hash_size);
 	fil_system->name_hash = hash_create(hash_size);
 
 	UT_LIST_INIT(fil_system->LRU);
+	UT_LIST_INIT(fil_system->preextend_spaces);
 
 	fil_system->max_n_open = max_n_open;
 }
@@ -1758,6 +1861,8 @@ fil_close_all_files(void)
 		fil_node_t*	node;
 		fil_space_t*	prev_space = space;
 
+		rw_lock_x_lock(&fil_system->latch);
+
 		for (node = UT_LIST_GET_FIRST(space->chain);
 		     node != NULL;
 		     node = UT_LIST_GET_NEXT(chain, node)) {
@@ -1767,12 +1872,18 @@ fil_close_all_files(void)
 			}
 		}
 
+		rw_lock_x_unlock(&fil_system->latch);
+
 		space = UT_LIST_GET_NEXT(space_list, space);
 
 		fil_space_free(prev_space->id, FALSE);
 	}
 
 	mutex_exit(&fil_system->mutex);
+
+	/* No i/o is possible after this; the latch must be freed before
+	sync_close() */
+	rw_lock_free(&fil_system->latch);
 }
 
 /*******************************************************************//**
@@ -2020,6 +2131,74 @@ fil_decr_pending_ops(
 
 	mutex_exit(&fil_system->mutex);
 }
+
+/*******************************************************************//**
+Asks fsp_preextend_thread() to extend a single-table tablespace that is
+about to fill up. Does nothing if the tablespace is already waiting or
+is being deleted. */
+UNIV_INTERN
+void
+fil_space_preextend_add(
+/*====================*/
+	ulint	id)	/*!< in: space id */
+{
+	fil_space_t*	space;
+
+	mutex_enter(&fil_system->mutex);
+
+	space = fil_space_get_by_id(id);
+
+	if (space != NULL
+	    && space->purpose == FIL_TABLESPACE
+	    && !space->stop_new_ops
+	    && !space->is_in_preextend_spaces) {
+
+		space->is_in_preextend_spaces = TRUE;
+
+		UT_LIST_ADD_LAST(preextend_spaces,
+				 fil_system->preextend_spaces, space);
+	}
+
+	mutex_exit(&fil_system->mutex);
+}
+
+/*******************************************************************//**
+Removes the first tablespace from the tablespaces waiting to be extended
+in the background. Unless the tablespace is being deleted, increments
+its count of pending operations, which the caller must decrement with
+fil_decr_pending_ops().
+@return	TRUE if a tablespace was found, FALSE if none is waiting */
+UNIV_INTERN
+ibool
+fil_space_preextend_get(
+/*====================*/
+	ulint*	id)	/*!< out: space id */
+{
+	fil_space_t*	space;
+
+	mutex_enter(&fil_system->mutex);
+
+	while ((space = UT_LIST_GET_FIRST(fil_system->preextend_spaces))) {
+
+		space->is_in_preextend_spaces = FALSE;
+
+		UT_LIST_REMOVE(preextend_spaces, fil_system->preextend_spaces,
+			       space);
+
+		if (!space->stop_new_ops) {
+			space->n_pending_ops++;
+			*id = space->id;
+
+			mutex_exit(&fil_system->mutex);
+
+			return(TRUE);
+		}
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	return(FALSE);
+}
 #endif /* !UNIV_HOTBACKUP */
 
 /********************************************************//**
@@ -2313,7 +2492,11 @@ stop_new_ops:
 	space = fil_space_get_by_id(id);
 
 	if (space != NULL) {
+		/* Keep fil_io() from starting new i/o on the space
+		without fil_system->mutex */
+		rw_lock_x_lock(&fil_system->latch);
 		space->stop_new_ops = TRUE;
+		rw_lock_x_unlock(&fil_system->latch);
 
 		if (space->n_pending_ops == 0) {
 			mutex_exit(&fil_system->mutex);
@@ -2699,7 +2882,11 @@ retry:
 	operating systems can rename an open file. For the closing we have to
 	wait until there are no pending i/o's or flushes on the file. */
 
+	/* Keep fil_io() from starting new i/o on the file without
+	fil_system->mutex */
+	rw_lock_x_lock(&fil_system->latch);
 	space->stop_ios = TRUE;
+	rw_lock_x_unlock(&fil_system->latch);
 
 	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
 	node = UT_LIST_GET_FIRST(space->chain);
@@ -2728,7 +2915,9 @@ retry:
 	} else if (node->open) {
 		/* Close the file */
 
+		rw_lock_x_lock(&fil_system->latch);
 		fil_node_close_file(node, fil_system);
+		rw_lock_x_unlock(&fil_system->latch);
 	}
 
 	/* Check that the old name in the space is right */
@@ -4000,7 +4189,9 @@ fil_get_space_id_for_table(
 /**********************************************************************//**
 Tries to extend a data file so that it would accommodate the number of pages
 given. The tablespace must be cached in the memory cache. If the space is big
-enough already, does nothing.
+enough already, does nothing. The file is extended without holding
+fil_system->mutex, with posix_fallocate() if innodb_use_fallocate is set and
+the file system supports it, or else by writing zeros.
 @return	TRUE if success */
 UNIV_INTERN
 ibool
@@ -4021,11 +4212,13 @@ fil_extend_space_to_desired_size(
 	ulint		buf_size;
 	ulint		start_page_no;
 	ulint		file_start_page_no;
+	ulint		n_added;
 	ulint		offset_high;
 	ulint		offset_low;
 	ulint		page_size;
 	ibool		success		= TRUE;
 
+retry:
 	fil_mutex_enter_and_prepare_for_io(space_id);
 
 	space = fil_space_get_by_id(space_id);
@@ -4041,24 +4234,67 @@ fil_extend_space_to_desired_size(
 		return(TRUE);
 	}
 
+	node = UT_LIST_GET_LAST(space->chain);
+
+	if (node->being_extended) {
+		/* Another thread is extending the file; wait for it
+		and look at the size again */
+
+		mutex_exit(&fil_system->mutex);
+
+		os_thread_sleep(100000);
+
+		goto retry;
+	}
+
 	page_size = dict_table_flags_to_zip_size(space->flags);
 	if (!page_size) {
 		page_size = UNIV_PAGE_SIZE;
 	}
 
-	node = UT_LIST_GET_LAST(space->chain);
-
 	fil_node_prepare_for_io(node, fil_system, space);
 
+	/* The pending i/o keeps the file open, and being_extended keeps
+	other threads from extending it, while we release the mutex. The
+	pages being added are not part of space->size yet, so nobody
+	else can access them. */
+	node->being_extended = TRUE;
+
 	start_page_no = space->size;
 	file_start_page_no = space->size - node->size;
 
-	/* Extend at most 64 pages at a time */
-	buf_size = ut_min(64, size_after_extend - start_page_no) * page_size;
-	buf2 = mem_alloc(buf_size + page_size);
-	buf = ut_align(buf2, page_size);
+	mutex_exit(&fil_system->mutex);
 
-	memset(buf, 0, buf_size);
+	n_added = 0;
+
+#ifndef UNIV_HOTBACKUP
+	if (srv_use_fallocate
+	    && os_file_allocate(node->name, node->handle,
+				(ib_int64_t) (start_page_no
+					      - file_start_page_no)
+				* page_size,
+				(ib_int64_t) (size_after_extend
+					      - start_page_no)
+				* page_size)) {
+
+		n_added = size_after_extend - start_page_no;
+		start_page_no = size_after_extend;
+	}
+#endif /* !UNIV_HOTBACKUP */
+
+	if (start_page_no < size_after_extend) {
+		/* Extend at most 64 pages at a time */
+		buf_size = ut_min(64, size_after_extend - start_page_no)
+			* page_size;
+		buf2 = mem_alloc(buf_size + page_size);
+		buf = ut_align(buf2, page_size);
+
+		memset(buf, 0, buf_size);
+	} else {
+		buf_size = 0;
+		buf2 = NULL;
+		buf = NULL;
+	}
 
 	while (start_page_no < size_after_extend) {
 		ulint	n_pages = ut_min(buf_size / page_size,
@@ -4080,32 +4316,38 @@ fil_extend_space_to_desired_size(
 				 page_size * n_pages,
 				 NULL, NULL);
 #endif
-		space->stat.n_extend_bytes += n_pages * page_size;
-
-		if (success) {
-			node->size += n_pages;
-			space->size += n_pages;
-
-			os_has_said_disk_full = FALSE;
-		} else {
+		if (!success) {
 			/* Let us measure the size of the file to determine
 			how much we were able to extend it */
 
-			n_pages = ((ulint)
+			n_added = ((ulint)
 				   (os_file_get_size_as_iblonglong(
 					   node->handle)
 				    / page_size)) - node->size;
 
-			node->size += n_pages;
-			space->size += n_pages;
-
 			break;
 		}
 
+		n_added += n_pages;
 		start_page_no += n_pages;
 	}
 
-	mem_free(buf2);
+	if (buf2 != NULL) {
+		mem_free(buf2);
+	}
+
+	mutex_enter(&fil_system->mutex);
+
+	ut_a(node->being_extended);
+	node->being_extended = FALSE;
+
+	node->size += n_added;
+	space->size += n_added;
+	space->stat.n_extend_bytes += n_added * page_size;
+
+	if (success) {
+		os_has_said_disk_full = FALSE;
+	}
 
 	fil_node_complete_io(node, fil_system, OS_FILE_WRITE);
 
@@ -4134,6 +4376,69 @@ fil_extend_space_to_desired_size(
 	return(success);
 }
 
+/**********************************************************************//**
+Truncates a single-file tablespace to the given number of pages. The caller
+must make sure that no pages of the tablespace are in the buffer pool and
+that nobody accesses the tablespace meanwhile.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+fil_truncate_tablespace(
+/*====================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint	size)		/*!< in: size in pages after the truncation */
+{
+	fil_node_t*	node;
+	fil_space_t*	space;
+	ibool		success;
+
+	ut_a(space_id != 0);
+
+retry:
+	fil_mutex_enter_and_prepare_for_io(space_id);
+
+	space = fil_space_get_by_id(space_id);
+	ut_a(space);
+	ut_a(space->purpose == FIL_TABLESPACE);
+	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
+
+	node = UT_LIST_GET_FIRST(space->chain);
+
+	if (node->being_extended) {
+		/* Wait for a background extension to complete */
+
+		mutex_exit(&fil_system->mutex);
+
+		os_thread_sleep(100000);
+
+		goto retry;
+	}
+
+	/* The pending i/o keeps the file open while we release the
+	mutex. */
+	fil_node_prepare_for_io(node, fil_system, space);
+
+	mutex_exit(&fil_system->mutex);
+
+	success = os_file_truncate(node->name, node->handle,
+				   (ib_int64_t) size * UNIV_PAGE_SIZE);
+
+	mutex_enter(&fil_system->mutex);
+
+	if (success) {
+		space->size -= node->size - size;
+		node->size = size;
+	}
+
+	fil_node_complete_io(node, fil_system, OS_FILE_WRITE);
+
+	mutex_exit(&fil_system->mutex);
+
+	fil_flush(space_id);
+
+	return(success);
+}
+
 #ifdef UNIV_HOTBACKUP
 /********************************************************************//**
 Extends all tablespaces to the size stored in the space header. During the
@@ -4321,16 +4626,16 @@ fil_node_prepare_for_io(
 		fil_node_open_file(node, system, space);
 	}
 
-	if (node->n_pending == 0 && space->purpose == FIL_TABLESPACE
-	    && space->id != 0) {
-		/* The node is in the LRU list, remove it */
+	if (space->purpose == FIL_TABLESPACE && space->id != 0) {
+		/* The node is in the LRU list, move it to the start */
 
 		ut_a(UT_LIST_GET_LEN(system->LRU) > 0);
 
 		UT_LIST_REMOVE(LRU, system->LRU, node);
+		UT_LIST_ADD_FIRST(LRU, system->LRU, node);
 	}
 
-	node->n_pending++;
+	fil_counter_add(node->n_pending, 1);
 }
 
 /********************************************************************//**
@@ -4352,8 +4657,6 @@ fil_node_complete_io(
 
 	ut_a(node->n_pending > 0);
 
-	node->n_pending--;
-
 	if (type == OS_FILE_WRITE) {
 		system->modification_counter++;
 		node->modification_counter = system->modification_counter;
@@ -4367,11 +4670,111 @@ fil_node_complete_io(
 		}
 	}
 
-	if (node->n_pending == 0 && node->space->purpose == FIL_TABLESPACE
-	    && node->space->id != 0) {
-		/* The node must be put back to the LRU list */
-		UT_LIST_ADD_FIRST(LRU, system->LRU, node);
+	/* Decrement the count only after marking the node as modified,
+	so that the file cannot be closed before it is flushed */
+	fil_counter_sub(node->n_pending, 1);
+}
+
+#ifdef FIL_IO_FAST_PATH
+/********************************************************************//**
+Prepares a file node for i/o without acquiring fil_system->mutex, if the
+file is open and no file needs to be closed first.
+@return file node, with its pending i/o count incremented, or NULL if
+fil_mutex_enter_and_prepare_for_io() and fil_node_prepare_for_io() must
+be used */
+static
+fil_node_t*
+fil_node_prepare_for_io_fast(
+/*=========================*/
+	ulint	type,		/*!< in: OS_FILE_READ or OS_FILE_WRITE */
+	ulint	space_id,	/*!< in: space id */
+	ulint*	block_offset,	/*!< in: offset in the space, in number of
+				blocks; out: offset in the file, if a node
+				is returned */
+	ulint	len)		/*!< in: how many bytes to read or write */
+{
+	fil_space_t*	space;
+	fil_node_t*	node;
+	ulint		offset	= *block_offset;
+
+	/* Keep the LRU list in order while files have to be closed to
+	open others */
+	if (fil_system->n_open >= fil_system->max_n_open) {
+
+		return(NULL);
+	}
+
+	rw_lock_s_lock(&fil_system->latch);
+
+	space = fil_space_get_by_id(space_id);
+
+	if (space == NULL || space->stop_ios || space->stop_new_ops) {
+		/* Let the caller wait or report the error */
+		node = NULL;
+		goto func_exit;
+	}
+
+	for (node = UT_LIST_GET_FIRST(space->chain);
+	     node != NULL && node->size <= offset;
+	     node = UT_LIST_GET_NEXT(chain, node)) {
+
+		offset -= node->size;
+	}
+
+	if (node == NULL || !node->open) {
+
+		node = NULL;
+		goto func_exit;
+	}
+
+	fil_counter_add(node->n_pending, 1);
+
+	*block_offset = offset;
+
+	if (type == OS_FILE_READ) {
+		fil_counter_add(space->stat.n_read, 1);
+		fil_counter_add(space->stat.n_data_read, len);
+	} else if (type == OS_FILE_WRITE) {
+		fil_counter_add(space->stat.n_wrtn, 1);
+		fil_counter_add(space->stat.n_data_wrtn, len);
 	}
+
+func_exit:
+	rw_lock_s_unlock(&fil_system->latch);
+
+	return(node);
+}
+#endif /* FIL_IO_FAST_PATH */
+
+/********************************************************************//**
+Updates the data structures when an i/o operation on a file node that was
+prepared for i/o finishes. Acquires fil_system->mutex unless the i/o was a
+read and fil_io() does not need the mutex. */
+static
+void
+fil_node_complete_io_any(
+/*=====================*/
+	fil_node_t*	node,	/*!< in: file node */
+	ulint		type)	/*!< in: OS_FILE_WRITE or OS_FILE_READ */
+{
+#ifdef FIL_IO_FAST_PATH
+	if (type == OS_FILE_READ) {
+		/* A read does not modify the file: only the pending
+		count, which fil_io() updates without the mutex, must
+		be decremented */
+		ut_a(node->n_pending > 0);
+
+		fil_counter_sub(node->n_pending, 1);
+
+		return;
+	}
+#endif /* FIL_IO_FAST_PATH */
+
+	mutex_enter(&fil_system->mutex);
+
+	fil_node_complete_io(node, fil_system, type);
+
+	mutex_exit(&fil_system->mutex);
 }
 
 /********************************************************************//**
@@ -4489,6 +4892,16 @@ fil_io(
 		srv_data_written+= len;
 	}
 
+#ifdef FIL_IO_FAST_PATH
+	node = fil_node_prepare_for_io_fast(type, space_id, &block_offset,
+					    len);
+
+	if (node != NULL) {
+
+		goto do_io;
+	}
+#endif /* FIL_IO_FAST_PATH */
+
 	/* Reserve the fil_system mutex and make sure that we can open at
 	least one file while holding it, if the file is not already open */
 
@@ -4514,11 +4927,11 @@ fil_io(
 	}
 
 	if (type == OS_FILE_READ) {
-		space->stat.n_read++;
-		space->stat.n_data_read+= len;
+		fil_counter_add(space->stat.n_read, 1);
+		fil_counter_add(space->stat.n_data_read, len);
 	} else if (type == OS_FILE_WRITE) {
-		space->stat.n_wrtn++;
-		space->stat.n_data_wrtn+= len;
+		fil_counter_add(space->stat.n_wrtn, 1);
+		fil_counter_add(space->stat.n_data_wrtn, len);
 	}
 
 	ut_ad((mode != OS_AIO_IBUF) || (space->purpose == FIL_TABLESPACE));
@@ -4568,6 +4981,9 @@ fil_io(
 	/* Now we have made the changes in the data structures of fil_system */
 	mutex_exit(&fil_system->mutex);
 
+#ifdef FIL_IO_FAST_PATH
+do_io:
+#endif /* FIL_IO_FAST_PATH */
 	/* Calculate the low 32 bits and the high 32 bits of the file offset */
 
 	if (!zip_size) {
@@ -4620,11 +5036,7 @@ fil_io(
 		/* The i/o operation is already completed when we return from
 		os_aio: */
 
-		mutex_enter(&fil_system->mutex);
-
-		fil_node_complete_io(node, fil_system, type);
-
-		mutex_exit(&fil_system->mutex);
+		fil_node_complete_io_any(node, type);
 
 		ut_ad(fil_validate_skip());
 	}
@@ -4649,6 +5061,7 @@ fil_aio_wait(
 	fil_node_t*	fil_node;
 	void*		message;
 	ulint		type;
+	ulint		purpose;
 
 	ut_ad(fil_validate_skip());
 
@@ -4679,11 +5092,10 @@ fil_aio_wait(
 
 	srv_set_io_thread_op_info(segment, "complete io for fil node");
 
-	mutex_enter(&fil_system->mutex);
-
-	fil_node_complete_io(fil_node, fil_system, type);
+	/* The file may be closed once the i/o is completed */
+	purpose = fil_node->space->purpose;
 
-	mutex_exit(&fil_system->mutex);
+	fil_node_complete_io_any(fil_node, type);
 
 	ut_ad(fil_validate_skip());
 
@@ -4693,7 +5105,7 @@ fil_aio_wait(
 	deadlocks in the i/o system. We keep tablespace 0 data files always
 	open, and use a special i/o thread to serve insert buffer requests. */
 
-	if (fil_node->space->purpose == FIL_TABLESPACE) {
+	if (purpose == FIL_TABLESPACE) {
 		srv_set_io_thread_op_info(segment, "complete io for buf page");
 		buf_page_io_complete(message);
 	} else {
@@ -4921,7 +5333,6 @@ fil_validate(void)
 	fil_node = UT_LIST_GET_FIRST(fil_system->LRU);
 
 	while (fil_node != NULL) {
-		ut_a(fil_node->n_pending == 0);
 		ut_a(fil_node->open);
 		ut_a(fil_node->space->purpose == FIL_TABLESPACE);
 		ut_a(fil_node->space->id != 0);
@@ -41,6 +41,7 @@ Created 11/29/1995 Heikki Tuuri
 # include "sync0sync.h"
 # include "fut0fut.h"
 # include "srv0srv.h"
+# include "srv0start.h"
 # include "ibuf0ibuf.h"
 # include "btr0btr.h"
 # include "btr0sea.h"
@@ -49,6 +50,25 @@ Created 11/29/1995 Heikki Tuuri
 #endif /* UNIV_HOTBACKUP */
 #include "dict0mem.h"
 
+#ifndef UNIV_HOTBACKUP
+/** Maximum number of extents that fsp_try_extend_data_file() adds to a
+single-table tablespace at a time when innodb_file_extend_percent is set */
+#define FSP_EXTEND_MAX_EXTENTS	256
+
+/** fsp_preextend_thread() extends a tablespace when fewer than this many
+extents above FSP_FREE_LIMIT are left in it */
+#define FSP_PREEXTEND_EXTENTS	(2 * FSP_FREE_ADD)
+
+/** Event to wake up fsp_preextend_thread() */
+UNIV_INTERN os_event_t	fsp_preextend_event;
+
+/** Number of times fsp_preextend_thread() extended a tablespace */
+UNIV_INTERN ulint	fsp_n_preextends	= 0;
+
+# ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	fsp_preextend_thread_key;
+# endif /* UNIV_PFS_THREAD */
+#endif /* !UNIV_HOTBACKUP */
 
 /*			FILE SEGMENT INODE
 			==================
@@ -877,8 +897,24 @@ void
 fsp_init(void)
 /*==========*/
 {
-	/* Does nothing at the moment */
+#ifndef UNIV_HOTBACKUP
+	fsp_preextend_event = os_event_create(NULL);
+#endif /* !UNIV_HOTBACKUP */
+}
+
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Frees the resources allocated by fsp_init(). Called at shutdown, after
+fsp_preextend_thread() has exited. */
+UNIV_INTERN
+void
+fsp_close(void)
+/*===========*/
+{
+	os_event_free(fsp_preextend_event);
+	fsp_preextend_event = NULL;
 }
+#endif /* !UNIV_HOTBACKUP */
 
 /**********************************************************************//**
 Writes the space id and compressed page size to a tablespace header.
@@ -1277,10 +1313,18 @@ fsp_try_extend_data_file(
 		if (size < 32 * extent_size) {
 			size_increase = extent_size;
 		} else {
-			/* Below in fsp_fill_free_list() we assume
-			that we add at most FSP_FREE_ADD extents at
-			a time */
-			size_increase = FSP_FREE_ADD * extent_size;
+			/* Below in fsp_fill_free_list() we add at
+			most FSP_FREE_ADD extents to the free list at
+			a time; with innodb_file_extend_percent, the
+			rest are added by the next calls without
+			extending the file */
+			ulint	n_extents = size / extent_size
+				* srv_file_extend_percent / 100;
+
+			n_extents = ut_min(n_extents, FSP_EXTEND_MAX_EXTENTS);
+			n_extents = ut_max(n_extents, FSP_FREE_ADD);
+
+			size_increase = n_extents * extent_size;
 		}
 	}
 
@@ -1453,8 +1497,111 @@ fsp_fill_free_list(
 
 		i += FSP_EXTENT_SIZE;
 	}
+
+#ifndef UNIV_HOTBACKUP
+	/* If a big single-table tablespace is about to fill up, let
+	fsp_preextend_thread() extend it before a user thread has to */
+	if (srv_file_preextend && space != 0 && !init_space
+	    && size >= 32 * FSP_EXTENT_SIZE
+	    && size < i + FSP_PREEXTEND_EXTENTS * FSP_EXTENT_SIZE) {
+
+		fil_space_preextend_add(space);
+		os_event_set(fsp_preextend_event);
+	}
+#endif /* !UNIV_HOTBACKUP */
 }
 
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Extends a single-table tablespace until at least FSP_PREEXTEND_EXTENTS
+extents are left above its free limit. */
+static
+void
+fsp_preextend(
+/*==========*/
+	ulint	space)	/*!< in: space id */
+{
+	fsp_header_t*	header;
+	ulint		flags;
+	ulint		size;
+	ulint		limit;
+	ulint		actual_increase;
+	mtr_t		mtr;
+
+	mtr_start(&mtr);
+
+	mtr_x_lock(fil_space_get_latch(space, &flags), &mtr);
+
+	header = fsp_get_space_header(
+		space, dict_table_flags_to_zip_size(flags), &mtr);
+
+	size = mtr_read_ulint(header + FSP_SIZE, MLOG_4BYTES, &mtr);
+	limit = mtr_read_ulint(header + FSP_FREE_LIMIT, MLOG_4BYTES, &mtr);
+
+	while (size < limit + FSP_PREEXTEND_EXTENTS * FSP_EXTENT_SIZE) {
+
+		if (!fsp_try_extend_data_file(&actual_increase, space,
+					      header, &mtr)
+		    || actual_increase == 0) {
+
+			/* Out of disk space: a user thread will report
+			it when it needs the space */
+			break;
+		}
+
+		fsp_n_preextends++;
+
+		size = mtr_read_ulint(header + FSP_SIZE, MLOG_4BYTES, &mtr);
+	}
+
+	mtr_commit(&mtr);
+}
+
+/*********************************************************************//**
+Tablespace pre-extension thread. Extends the single-table tablespaces
+that were added by fil_space_preextend_add() when they were about to
+fill up, so that the user threads that insert into them do not have to
+wait for the file to grow.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+fsp_preextend_thread(
+/*=================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(fsp_preextend_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		ib_int64_t	sig_count;
+		ulint		space;
+
+		sig_count = os_event_reset(fsp_preextend_event);
+
+		while (srv_shutdown_state == SRV_SHUTDOWN_NONE
+		       && fil_space_preextend_get(&space)) {
+
+			fsp_preextend(space);
+
+			fil_decr_pending_ops(space);
+		}
+
+		os_event_wait_low(fsp_preextend_event, sig_count);
+	}
+
+	srv_fsp_preextend_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /**********************************************************************//**
 Allocates a new free extent.
 @return	extent descriptor, NULL if cannot be allocated */
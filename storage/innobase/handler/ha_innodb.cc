@@ -60,6 +60,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 /* Include necessary InnoDB headers */
 extern "C" {
 #include "univ.i"
+#include "buf0dump.h"
 #include "buf0lru.h"
 #include "btr0sea.h"
 #include "os0file.h"
@@ -77,6 +78,7 @@ extern "C" {
 #include "log0log.h"
 #include "lock0lock.h"
 #include "dict0crea.h"
+#include "dict0stats.h"
 #include "btr0cur.h"
 #include "btr0btr.h"
 #include "fsp0fsp.h"
@@ -89,6 +91,7 @@ extern "C" {
 #include "ut0mem.h"
 #include "ibuf0ibuf.h"
 #include "buf0rea.h"
+#include "page0zip.h"
 }
 
 #include "ha_innodb.h"
@@ -100,8 +103,6 @@ extern "C" {
 
 /** to protect innobase_open_files */
 static mysql_mutex_t innobase_share_mutex;
-/** to force correct commit order in binlog */
-static mysql_mutex_t prepare_commit_mutex;
 static ulong commit_threads = 0;
 static mysql_mutex_t commit_threads_m;
 static mysql_cond_t commit_cond;
@@ -195,6 +196,27 @@ static TYPELIB innodb_stats_method_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_checksum_algorithm", in
+the order of srv_checksum_algorithm_t. */
+static const char* innodb_checksum_algorithm_names[] = {
+	"crc32",
+	"strict_crc32",
+	"innodb",
+	"strict_innodb",
+	"none",
+	"strict_none",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_checksum_algorithm. */
+static TYPELIB innodb_checksum_algorithm_typelib = {
+	array_elements(innodb_checksum_algorithm_names) - 1,
+	"innodb_checksum_algorithm_typelib",
+	innodb_checksum_algorithm_names,
+	NULL
+};
+
 /** List of values for system variable "innodb_index_page_split_mode". */
 static const char* innodb_index_page_split_mode_names[] = {
 	"symmetric",
@@ -234,7 +256,6 @@ static const char* innobase_change_buffering_values[IBUF_USE_COUNT] = {
 /* Keys to register pthread mutexes/cond in the current file with
 performance schema */
 static mysql_pfs_key_t	innobase_share_mutex_key;
-static mysql_pfs_key_t	prepare_commit_mutex_key;
 static mysql_pfs_key_t	commit_threads_m_key;
 static mysql_pfs_key_t	commit_cond_mutex_key;
 static mysql_pfs_key_t	commit_cond_key;
@@ -242,8 +263,7 @@ static mysql_pfs_key_t	commit_cond_key;
 static PSI_mutex_info	all_pthread_mutexes[] = {
         {&commit_threads_m_key, "commit_threads_m", 0},
         {&commit_cond_mutex_key, "commit_cond_mutex", 0},
-        {&innobase_share_mutex_key, "innobase_share_mutex", 0},
-        {&prepare_commit_mutex_key, "prepare_commit_mutex", 0}
+        {&innobase_share_mutex_key, "innobase_share_mutex", 0}
 };
 
 static PSI_cond_info	all_innodb_conds[] = {
@@ -265,6 +285,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&cache_last_read_mutex_key, "cache_last_read_mutex", 0},
 	{&dict_foreign_err_mutex_key, "dict_foreign_err_mutex", 0},
 	{&dict_sys_mutex_key, "dict_sys_mutex", 0},
+	{&dict_stats_recalc_pool_mutex_key, "dict_stats_recalc_pool_mutex", 0},
 	{&file_format_max_mutex_key, "file_format_max_mutex", 0},
 	{&fil_system_mutex_key, "fil_system_mutex", 0},
 	{&flush_list_mutex_key, "flush_list_mutex", 0},
@@ -274,16 +295,26 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&ibuf_mutex_key, "ibuf_mutex", 0},
 	{&ibuf_pessimistic_insert_mutex_key,
 		 "ibuf_pessimistic_insert_mutex", 0},
+	{&index_online_log_key, "index_online_log", 0},
+	{&index_zip_pad_mutex_key, "index_zip_pad_mutex", 0},
 	{&kernel_mutex_key, "kernel_mutex", 0},
+	{&lock_sys_mutex_key, "lock_mutex", 0},
+	{&lock_sys_wait_mutex_key, "lock_wait_mutex", 0},
 	{&log_sys_mutex_key, "log_sys_mutex", 0},
+	{&log_write_mutex_key, "log_write_mutex", 0},
+	{&log_flush_mutex_key, "log_flush_mutex", 0},
 #  ifdef UNIV_MEM_DEBUG
 	{&mem_hash_mutex_key, "mem_hash_mutex", 0},
 #  endif /* UNIV_MEM_DEBUG */
 	{&mem_pool_mutex_key, "mem_pool_mutex", 0},
 	{&mutex_list_mutex_key, "mutex_list_mutex", 0},
+	{&page_cleaner_mutex_key, "page_cleaner_mutex", 0},
+	{&page_zip_stat_per_index_mutex_key,
+		"page_zip_stat_per_index_mutex", 0},
 	{&purge_sys_bh_mutex_key, "purge_sys_bh_mutex", 0},
 	{&recv_sys_mutex_key, "recv_sys_mutex", 0},
 	{&rseg_mutex_key, "rseg_mutex", 0},
+	{&row_merge_par_mutex_key, "row_merge_par_mutex", 0},
 #  ifdef UNIV_SYNC_DEBUG
 	{&rw_lock_debug_mutex_key, "rw_lock_debug_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
@@ -298,7 +329,9 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&sync_thread_mutex_key, "sync_thread_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
 	{&trx_doublewrite_mutex_key, "trx_doublewrite_mutex", 0},
-	{&trx_undo_mutex_key, "trx_undo_mutex", 0}
+	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
+	{&trx_mutex_key, "trx_mutex", 0},
+	{&trx_sys_mutex_key, "trx_sys_mutex", 0}
 };
 # endif /* UNIV_PFS_MUTEX */
 
@@ -319,11 +352,13 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 #  endif /* UNIV_SYNC_DEBUG */
 	{&dict_operation_lock_key, "dict_operation_lock", 0},
 	{&fil_space_latch_key, "fil_space_latch", 0},
+	{&fil_system_latch_key, "fil_system_latch", 0},
 	{&checkpoint_lock_key, "checkpoint_lock", 0},
 	{&trx_i_s_cache_lock_key, "trx_i_s_cache_lock", 0},
 	{&trx_purge_latch_key, "trx_purge_latch", 0},
 	{&index_tree_rw_lock_key, "index_tree_rw_lock", 0},
-	{&dict_table_stats_latch_key, "dict_table_stats", 0}
+	{&dict_table_stats_latch_key, "dict_table_stats", 0},
+	{&dict_table_hash_latch_key, "dict_table_hash_latch", 0}
 };
 # endif /* UNIV_PFS_RWLOCK */
 
@@ -338,7 +373,18 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&srv_error_monitor_thread_key, "srv_error_monitor_thread", 0},
 	{&srv_monitor_thread_key, "srv_monitor_thread", 0},
 	{&srv_master_thread_key, "srv_master_thread", 0},
-	{&srv_purge_thread_key, "srv_purge_thread", 0}
+	{&srv_purge_thread_key, "srv_purge_thread", 0},
+	{&srv_worker_thread_key, "srv_worker_thread", 0},
+	{&buf_dump_thread_key, "buf_dump_thread", 0},
+	{&buf_resize_thread_key, "buf_resize_thread", 0},
+	{&buf_page_cleaner_coordinator_thread_key,
+	 "page_cleaner_coordinator_thread", 0},
+	{&buf_page_cleaner_worker_thread_key,
+	 "page_cleaner_worker_thread", 0},
+	{&dict_stats_thread_key, "dict_stats_thread", 0},
+	{&fsp_preextend_thread_key, "fsp_preextend_thread", 0},
+	{&log_writer_thread_key, "log_writer_thread", 0},
+	{&log_flusher_thread_key, "log_flusher_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -700,6 +746,12 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_buffer_pool_LRU_unzip_search_scanned, SHOW_LONG},
   {"buffer_pool_LRU_get_free_search",
   (char*) &export_vars.innodb_buffer_pool_LRU_get_free_search, SHOW_LONG},
+  {"buffer_pool_dump_status",
+  (char*) &export_vars.innodb_buffer_pool_dump_status,	  SHOW_CHAR},
+  {"buffer_pool_load_status",
+  (char*) &export_vars.innodb_buffer_pool_load_status,	  SHOW_CHAR},
+  {"buffer_pool_resize_status",
+  (char*) &export_vars.innodb_buffer_pool_resize_status,  SHOW_CHAR},
   {"buffer_pool_flush_LRU_batch_scanned",
   (char*) &export_vars.innodb_buffer_pool_flush_LRU_batch_scanned, SHOW_LONG},
   {"buffer_pool_flush_LRU_page_count",
@@ -778,6 +830,16 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_dblwr_pages_written,	  SHOW_LONG},
   {"dblwr_writes",
   (char*) &export_vars.innodb_dblwr_writes,		  SHOW_LONG},
+  {"dict_cache_evictions",
+  (char*) &export_vars.innodb_dict_cache_evictions,	  SHOW_LONG},
+  {"dict_cache_hits",
+  (char*) &export_vars.innodb_dict_cache_hits,		  SHOW_LONG},
+  {"dict_cache_misses",
+  (char*) &export_vars.innodb_dict_cache_misses,	  SHOW_LONG},
+  {"dict_cache_size",
+  (char*) &export_vars.innodb_dict_cache_size,		  SHOW_LONG},
+  {"file_preextends",
+  (char*) &export_vars.innodb_file_preextends,		  SHOW_LONG},
   {"files_open",
   (char*) &export_vars.innodb_files_open,		  SHOW_LONG},
   {"files_opened",
@@ -804,6 +866,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_ibuf_merged_pages,	  SHOW_LONG},
   {"ibuf_pages",
   (char*) &export_vars.innodb_ibuf_pages,		  SHOW_LONG},
+  {"lock_deadlock_check_time",
+  (char*) &export_vars.innodb_lock_deadlock_check_time,	  SHOW_LONG},
+  {"lock_deadlock_checks",
+  (char*) &export_vars.innodb_lock_deadlock_checks,	  SHOW_LONG},
   {"lock_deadlocks",
   (char*) &export_vars.innodb_lock_deadlocks,		  SHOW_LONG},
   {"log_waits",
@@ -822,6 +888,12 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) export_vars.innodb_mysql_master_log_name,	  SHOW_CHAR},
   {"mysql_master_log_pos",
   (char*) &export_vars.innodb_mysql_master_log_pos,	  SHOW_LONGLONG},
+  {"online_alter_log_bytes",
+  (char*) &export_vars.innodb_online_alter_log_bytes,	  SHOW_LONG},
+  {"online_alter_log_rows",
+  (char*) &export_vars.innodb_online_alter_log_rows,	  SHOW_LONG},
+  {"online_alter_progress",
+  (char*) &export_vars.innodb_online_alter_progress,	  SHOW_LONG},
   {"os_log_fsyncs",
   (char*) &export_vars.innodb_os_log_fsyncs,		  SHOW_LONG},
   {"os_log_pending_fsyncs",
@@ -830,6 +902,20 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_os_log_pending_writes,	  SHOW_LONG},
   {"os_log_written",
   (char*) &export_vars.innodb_os_log_written,		  SHOW_LONG},
+  {"page_cleaner_flush_list_pages",
+  (char*) &export_vars.innodb_page_cleaner_flush_list_pages, SHOW_LONG},
+  {"page_cleaner_flush_list_time",
+  (char*) &export_vars.innodb_page_cleaner_flush_list_time, SHOW_LONG},
+  {"page_cleaner_iterations",
+  (char*) &export_vars.innodb_page_cleaner_iterations,	  SHOW_LONG},
+  {"page_cleaner_lru_pages",
+  (char*) &export_vars.innodb_page_cleaner_lru_pages,	  SHOW_LONG},
+  {"page_cleaner_lru_time",
+  (char*) &export_vars.innodb_page_cleaner_lru_time,	  SHOW_LONG},
+  {"page_cleaner_sleeps",
+  (char*) &export_vars.innodb_page_cleaner_sleeps,	  SHOW_LONG},
+  {"page_cleaner_time",
+  (char*) &export_vars.innodb_page_cleaner_time,	  SHOW_LONG},
   {"page_discard",
   (char*) &export_vars.innodb_btree_page_discard,	  SHOW_LONG},
   {"page_merges",
@@ -852,6 +938,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_purge_trx_no,		  SHOW_LONGLONG},
   {"purge_undo_no",
   (char*) &export_vars.innodb_purge_undo_no,		  SHOW_LONGLONG},
+  {"purge_worker_records",
+  (char*) &export_vars.innodb_purge_worker_records,	  SHOW_LONGLONG},
   {"row_lock_current_waits",
   (char*) &export_vars.innodb_row_lock_current_waits,	  SHOW_LONG},
   {"row_lock_time",
@@ -866,6 +954,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_rows_deleted,		  SHOW_LONG},
   {"rows_inserted",
   (char*) &export_vars.innodb_rows_inserted,		  SHOW_LONG},
+  {"rows_prefetch_batches",
+  (char*) &export_vars.innodb_rows_prefetch_batches,	  SHOW_LONG},
   {"rows_read",
   (char*) &export_vars.innodb_rows_read,		  SHOW_LONG},
   {"rows_updated",
@@ -996,6 +1086,21 @@ thd_is_select(
 	return(thd_sql_command((const THD*) thd) == SQLCOM_SELECT);
 }
 
+/******************************************************************//**
+Returns true if the thread is executing a SELECT statement in autocommit
+mode, outside of an explicitly started transaction.
+@return	true if thd is executing an autocommit SELECT */
+extern "C" UNIV_INTERN
+ibool
+thd_trx_is_read_only(
+/*=================*/
+	void*	thd)	/*!< in: thread handle (THD*) */
+{
+	return(!thd_test_options((THD*) thd,
+				 OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN)
+	       && thd_sql_command((const THD*) thd) == SQLCOM_SELECT);
+}
+
 /******************************************************************//**
 Returns true if the thread supports XA,
 global value of innodb_supports_xa if thd is NULL.
@@ -1304,6 +1409,14 @@ convert_error_code_to_mysql(
 		return(HA_ERR_OUT_OF_MEM);
 	case DB_IDENTIFIER_TOO_LONG:
 		return(HA_ERR_INTERNAL_ERROR);
+	case DB_ONLINE_LOG_TOO_BIG:
+		my_printf_error(ER_UNKNOWN_ERROR,
+			"Creating index online failed: the modification log"
+			" exceeded innodb_online_alter_log_max_size (%lu)."
+			" Try again with a larger"
+			" innodb_online_alter_log_max_size.",
+			MYF(0), srv_online_alter_log_max_size);
+		return(HA_ERR_RECORD_FILE_FULL);
 	}
 }
 
@@ -1819,18 +1932,6 @@ trx_is_registered_for_2pc(
 	return(trx->is_registered == 1);
 }
 
-/*********************************************************************//**
-Note that a transaction owns the prepare_commit_mutex. */
-static inline
-void
-trx_owns_prepare_commit_mutex_set(
-/*==============================*/
-	trx_t*	trx)	/* in: transaction */
-{
-	ut_a(trx_is_registered_for_2pc(trx));
-	trx->owns_prepare_mutex = 1;
-}
-
 /*********************************************************************//**
 Note that a transaction has been registered with MySQL 2PC coordinator. */
 static inline
@@ -1840,7 +1941,6 @@ trx_register_for_2pc(
 	trx_t*	trx)	/* in: transaction */
 {
 	trx->is_registered = 1;
-	ut_ad(trx->owns_prepare_mutex == 0);
 }
 
 /*********************************************************************//**
@@ -1852,19 +1952,6 @@ trx_deregister_from_2pc(
 	trx_t*	trx)	/* in: transaction */
 {
 	trx->is_registered = 0;
-	trx->owns_prepare_mutex = 0;
-}
-
-/*********************************************************************//**
-Check whether atransaction owns the prepare_commit_mutex.
-@return true if transaction owns the prepare commit mutex */
-static inline
-bool
-trx_has_prepare_commit_mutex(
-/*=========================*/
-	const trx_t*	trx)	/* in: transaction */
-{
-	return(trx->owns_prepare_mutex == 1);
 }
 
 /*********************************************************************//**
@@ -1884,6 +1971,7 @@ Construct ha_innobase handler. */
 UNIV_INTERN
 ha_innobase::ha_innobase(handlerton *hton, TABLE_SHARE *table_arg)
   :handler(hton, table_arg),
+  prebuilt(NULL),
   int_table_flags(HA_REC_NOT_IN_SEQ |
 		  HA_NULL_IN_KEY |
 		  HA_CAN_INDEX_BLOBS |
@@ -1894,8 +1982,13 @@ ha_innobase::ha_innobase(handlerton *hton, TABLE_SHARE *table_arg)
 		  HA_CAN_GEOMETRY | HA_PARTIAL_COLUMN_READ |
 		  HA_TABLE_SCAN_ON_INDEX),
   start_of_scan(0),
-  num_write_row(0)
-{}
+  num_write_row(0),
+  mrr_file(NULL),
+  mrr_buf(NULL),
+  mrr_disk_sweep(false)
+{
+	init_alloc_root(&mrr_mem_root, 1024, 0);
+}
 
 /*********************************************************************//**
 Destruct ha_innobase handler. */
@@ -2064,9 +2157,9 @@ innobase_query_caching_of_table_permitted(
 				"search, latch though calling "
 				"innobase_query_caching_of_table_permitted.");
 
-		mutex_enter(&kernel_mutex);
+		lock_mutex_enter();
 		trx_print(stderr, trx, 1024);
-		mutex_exit(&kernel_mutex);
+		lock_mutex_exit();
 	}
 
 	trx_search_latch_release_if_reserved(trx);
@@ -2535,6 +2628,13 @@ innobase_init(
 	srv_data_home = (innobase_data_home_dir ? innobase_data_home_dir :
 			 default_path);
 
+	/* The undo tablespaces are placed with the data files unless
+	innodb_undo_directory is set. */
+
+	if (!srv_undo_dir) {
+		srv_undo_dir = srv_data_home;
+	}
+
 	/* Set default InnoDB data file size to 10 MB and let it be
 	auto-extending. Thus users can use InnoDB in >= 4.0 without having
 	to specify any startup options. */
@@ -2694,7 +2794,12 @@ innobase_change_buffering_inited_ok:
 	srv_force_recovery = (ulint) innobase_force_recovery;
 
 	srv_use_doublewrite_buf = (ibool) innobase_use_doublewrite;
-	srv_use_checksums = (ibool) innobase_use_checksums;
+
+	/* --skip-innodb-checksums is a synonym for
+	--innodb-checksum-algorithm=none. */
+	if (!innobase_use_checksums) {
+		srv_checksum_algorithm = SRV_CHECKSUM_ALGORITHM_NONE;
+	}
 
 #ifdef HAVE_LARGE_PAGES
         if ((os_use_large_pages = (ibool) my_use_large_pages))
@@ -2783,12 +2888,14 @@ innobase_change_buffering_inited_ok:
 	innobase_old_blocks_pct = buf_LRU_old_ratio_update(
 		innobase_old_blocks_pct, TRUE);
 
+	/* The size may have been rounded up to a multiple of the
+	chunk size times the number of instances. */
+	innobase_buffer_pool_size = (long long) srv_buf_pool_size;
+
 	innobase_open_tables = hash_create(200);
 	mysql_mutex_init(innobase_share_mutex_key,
 			 &innobase_share_mutex,
 			 MY_MUTEX_INIT_FAST);
-	mysql_mutex_init(prepare_commit_mutex_key,
-			 &prepare_commit_mutex, MY_MUTEX_INIT_FAST);
 	mysql_mutex_init(commit_threads_m_key,
 			 &commit_threads_m, MY_MUTEX_INIT_FAST);
 	mysql_mutex_init(commit_cond_mutex_key,
@@ -2838,7 +2945,6 @@ innobase_end(
 		srv_free_paths_and_sizes();
 		my_free(internal_innobase_data_file_path);
 		mysql_mutex_destroy(&innobase_share_mutex);
-		mysql_mutex_destroy(&prepare_commit_mutex);
 		mysql_mutex_destroy(&commit_threads_m);
 		mysql_mutex_destroy(&commit_cond_m);
 		mysql_cond_destroy(&commit_cond);
@@ -2877,6 +2983,7 @@ innobase_alter_table_flags(
 {
 	return(HA_INPLACE_ADD_INDEX_NO_READ_WRITE
 		| HA_INPLACE_ADD_INDEX_NO_WRITE
+		| HA_INPLACE_ADD_INDEX_ONLINE
 		| HA_INPLACE_DROP_INDEX_NO_READ_WRITE
 		| HA_INPLACE_ADD_UNIQUE_INDEX_NO_READ_WRITE
 		| HA_INPLACE_ADD_UNIQUE_INDEX_NO_WRITE
@@ -3075,6 +3182,7 @@ innobase_commit(
 				FALSE - the current SQL statement ended */
 {
 	trx_t*		trx;
+	ulonglong	binlog_pos;
 
 	DBUG_ENTER("innobase_commit");
 	DBUG_ASSERT(hton == innodb_hton_ptr);
@@ -3106,9 +3214,13 @@ innobase_commit(
 		/* We were instructed to commit the whole transaction, or
 		this is an SQL statement end and autocommit is on */
 
-		/* We need current binlog position for ibbackup to work.
-		Note, the position is current because of
-		prepare_commit_mutex */
+		/* For ibbackup to work the order of transactions in the
+		binlog and in InnoDB must be the same. The binlog group
+		commit hands out commit tickets in binlog order; wait for
+		our turn before making the transaction visible. This is a
+		no-op for transactions that were not written to the binlog
+		through the transaction coordinator. */
+		mysql_bin_log_commit_order_enter(thd);
 retry:
 		if (innobase_commit_concurrency > 0) {
 			mysql_mutex_lock(&commit_cond_m);
@@ -3126,21 +3238,21 @@ retry:
 			}
 		}
 
-		/* The following calls to read the MySQL binary log
-		file name and the position return consistent results:
-		1) Other InnoDB transactions cannot intervene between
-		these calls as we are holding prepare_commit_mutex.
-		2) Binary logging of other engines is not relevant
+		/* The binlog file name and the position returned
+		here are the ones right after the events of this
+		transaction:
+		1) Binary logging of other engines is not relevant
 		to InnoDB as all InnoDB requires is that committing
 		InnoDB transactions appear in the same order in the
 		MySQL binary log as they appear in InnoDB logs.
-		3) A MySQL log file rotation cannot happen because
+		2) A MySQL log file rotation cannot happen because
 		MySQL protects against this by having a counter of
 		transactions in prepared state and it only allows
 		a rotation when the counter drops to zero. See
 		LOCK_prep_xids and COND_prep_xids in log.cc. */
-		trx->mysql_log_file_name = mysql_bin_log_file_name();
-		trx->mysql_log_offset = (ib_int64_t) mysql_bin_log_file_pos();
+		mysql_bin_log_commit_pos(thd, &binlog_pos,
+					 &trx->mysql_log_file_name);
+		trx->mysql_log_offset = (ib_int64_t) binlog_pos;
 
 		if (thd_is_replication_slave_thread(thd)) {
 			trx->mysql_master_log_file_name =
@@ -3149,8 +3261,8 @@ retry:
 		}
 
 		/* Don't do write + flush right now. For group commit
-		to work we want to do the flush after releasing the
-		prepare_commit_mutex. */
+		to work we want to do the flush after letting the
+		next transaction in binlog order commit. */
 		trx->flush_log_later = TRUE;
 		innobase_commit_low(trx);
 		trx->flush_log_later = FALSE;
@@ -3162,11 +3274,8 @@ retry:
 			mysql_mutex_unlock(&commit_cond_m);
 		}
 
-		if (trx_has_prepare_commit_mutex(trx)) {
-  
-			mysql_mutex_unlock(&prepare_commit_mutex);
-  		}
-  
+		mysql_bin_log_commit_order_exit(thd);
+
 		trx_deregister_from_2pc(trx);
 
 		/* Now do a write + flush of logs. */
@@ -3457,7 +3566,7 @@ innobase_kill_connection(
 	DBUG_ENTER("innobase_kill_connection");
 	DBUG_ASSERT(hton == innodb_hton_ptr);
 
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
 
 	trx = thd_to_trx(thd);
 
@@ -3467,7 +3576,7 @@ innobase_kill_connection(
 		lock_cancel_waiting_and_release(trx->wait_lock);
 	}
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 
 	DBUG_VOID_RETURN;
 }
@@ -3585,7 +3694,8 @@ ha_innobase::index_flags(
 const
 {
 	return(HA_READ_NEXT | HA_READ_PREV | HA_READ_ORDER
-	       | HA_READ_RANGE | HA_KEYREAD_ONLY);
+	       | HA_READ_RANGE | HA_KEYREAD_ONLY
+	       | HA_DO_INDEX_COND_PUSHDOWN);
 }
 
 /****************************************************************//**
@@ -4191,7 +4301,7 @@ ha_innobase::open(
 	thd = ha_thd();
 
 	/* Under some cases MySQL seems to call this function while
-	holding btr_search_latch. This breaks the latching order as
+	holding an adaptive hash index latch. This breaks the latching order as
 	we acquire dict_sys->mutex below and leads to a deadlock. */
 	if (thd != NULL) {
 		innobase_release_temporary_latches(ht, thd);
@@ -4556,6 +4666,8 @@ ha_innobase::close(void)
 		innobase_release_temporary_latches(ht, thd);
 	}
 
+	mrr_close();
+
 	row_prebuilt_free(prebuilt, FALSE);
 
 	if (upd_buf != NULL) {
@@ -5130,6 +5242,10 @@ build_template(
 					only if templ_type is
 					ROW_MYSQL_REC_FIELDS */
 	TABLE*		table,		/*!< in: MySQL table */
+	ha_innobase*	file,		/*!< in: table handle; its pushed
+					index condition is evaluated on
+					prebuilt->index if it was pushed
+					down to the active index */
 	uint		templ_type)	/*!< in: ROW_MYSQL_WHOLE_ROW or
 					ROW_MYSQL_REC_FIELDS */
 {
@@ -5141,6 +5257,7 @@ build_template(
 	ulint		n_requested_fields	= 0;
 	ibool		fetch_all_in_key	= FALSE;
 	ibool		fetch_primary_key_cols	= FALSE;
+	uint		icp_keyno		= MAX_KEY;
 	ulint		i;
 	/* byte offset of the end of last requested column */
 	ulint		mysql_prefix_len	= 0;
@@ -5187,6 +5304,19 @@ build_template(
 
 	clust_index = dict_table_get_first_index(prebuilt->table);
 
+	/* The pushed index condition is evaluated on the records of the
+	secondary index prebuilt->index, even if the whole row is fetched
+	from the clustered index. */
+	prebuilt->idx_cond = NULL;
+
+	if (file->pushed_idx_cond
+	    && file->pushed_idx_cond_keyno == file->active_index
+	    && prebuilt->index != clust_index) {
+
+		prebuilt->idx_cond = file;
+		icp_keyno = file->pushed_idx_cond_keyno;
+	}
+
 	if (templ_type == ROW_MYSQL_REC_FIELDS) {
 		index = prebuilt->index;
 	} else {
@@ -5239,6 +5369,15 @@ build_template(
 				goto include_field;
 			}
 
+			if (icp_keyno != MAX_KEY
+			    && field->part_of_key.is_set(icp_keyno)) {
+				/* This field may be needed in the pushed
+				index condition or in the end-of-range
+				check */
+
+				goto include_field;
+			}
+
 			if (bitmap_is_set(table->read_set, i) ||
 			    bitmap_is_set(table->write_set, i)) {
 				/* This field is needed in the query */
@@ -5276,6 +5415,24 @@ include_field:
 			}
 		}
 
+		templ->icp_rec_field_no = ULINT_UNDEFINED;
+
+		if (icp_keyno != MAX_KEY
+		    && field->part_of_key.is_set(icp_keyno)) {
+			/* MySQL considers the column to be fully
+			contained in the index, even if InnoDB
+			stores it as a column prefix that is as
+			long as the column itself. */
+			templ->icp_rec_field_no = dict_index_get_nth_col_pos(
+				prebuilt->index, i);
+
+			if (templ->icp_rec_field_no == ULINT_UNDEFINED) {
+				templ->icp_rec_field_no
+					= dict_index_get_nth_col_or_prefix_pos(
+						prebuilt->index, i, TRUE);
+			}
+		}
+
 		if (field->null_ptr) {
 			templ->mysql_null_byte_offset =
 				(ulint) ((char*) field->null_ptr
@@ -5581,7 +5738,7 @@ no_commit:
 		/* Build the template used in converting quickly between
 		the two database formats */
 
-		build_template(prebuilt, NULL, table, ROW_MYSQL_WHOLE_ROW);
+		build_template(prebuilt, NULL, table, this, ROW_MYSQL_WHOLE_ROW);
 	}
 
 	innodb_srv_conc_enter_innodb(prebuilt->trx);
@@ -6093,7 +6250,7 @@ ha_innobase::index_init(
 }
 
 /******************************************************************//**
-Currently does nothing.
+Ends a disk-sweep multi-range read that was not read to the end.
 @return	0 */
 UNIV_INTERN
 int
@@ -6102,6 +6259,7 @@ ha_innobase::index_end(void)
 {
 	int	error	= 0;
 	DBUG_ENTER("index_end");
+	mrr_end();
 	active_index=MAX_KEY;
 	DBUG_RETURN(error);
 }
@@ -6263,7 +6421,8 @@ ha_innobase::index_read(
 	necessarily prebuilt->index, but can also be the clustered index */
 
 	if (prebuilt->sql_stat_start) {
-		build_template(prebuilt, user_thd, table, ROW_MYSQL_REC_FIELDS);
+		build_template(prebuilt, user_thd, table, this,
+		       ROW_MYSQL_REC_FIELDS);
 	}
 
 	if (key_ptr) {
@@ -6486,7 +6645,8 @@ ha_innobase::change_active_index(
 	the flag ROW_MYSQL_WHOLE_ROW below, but that caused unnecessary
 	copying. Starting from MySQL-4.1 we use a more efficient flag here. */
 
-	build_template(prebuilt, user_thd, table, ROW_MYSQL_REC_FIELDS);
+	build_template(prebuilt, user_thd, table, this,
+		       ROW_MYSQL_REC_FIELDS);
 
 	DBUG_RETURN(0);
 }
@@ -8519,9 +8679,19 @@ ha_innobase::info_low(
 
 			prebuilt->trx->op_info = "updating table statistics";
 
-			dict_update_statistics(ib_table,
-					       FALSE /* update even if stats
-						     are initialized */);
+			if (!srv_stats_persistent) {
+				dict_update_statistics(
+					ib_table,
+					FALSE /* update even if stats
+					      are initialized */);
+			} else if (called_from_analyze) {
+				/* Persistent statistics are only
+				recalculated by ANALYZE TABLE and by
+				the background thread. */
+				dict_stats_update(
+					ib_table,
+					DICT_STATS_RECALC_PERSISTENT);
+			}
 
 			prebuilt->trx->op_info = "returning various info to MySQL";
 		}
@@ -8668,6 +8838,26 @@ ha_innobase::info_low(
 		ulint	num_innodb_index = UT_LIST_GET_LEN(ib_table->indexes)
 					- prebuilt->clust_index_was_generated;
 
+		if (table->s->keys < num_innodb_index) {
+			/* Indexes that are being created online are
+			not defined in MySQL yet. */
+			mutex_enter(&dict_sys->mutex);
+
+			num_innodb_index = UT_LIST_GET_LEN(ib_table->indexes)
+				- prebuilt->clust_index_was_generated;
+
+			for (index = dict_table_get_first_index(ib_table);
+			     index != NULL;
+			     index = dict_table_get_next_index(index)) {
+
+				if (*index->name == TEMP_INDEX_PREFIX) {
+					num_innodb_index--;
+				}
+			}
+
+			mutex_exit(&dict_sys->mutex);
+		}
+
 		if (table->s->keys != num_innodb_index) {
 			sql_print_error("Table %s contains %lu "
 					"indexes inside InnoDB, which "
@@ -8843,7 +9033,7 @@ ha_innobase::check(
 		/* Build the template; we will use a dummy template
 		in index scans done in checking */
 
-		build_template(prebuilt, NULL, table, ROW_MYSQL_WHOLE_ROW);
+		build_template(prebuilt, NULL, table, this, ROW_MYSQL_WHOLE_ROW);
 	}
 
 	if (prebuilt->table->ibd_file_missing) {
@@ -9495,6 +9685,8 @@ ha_innobase::reset()
 
 	reset_template(prebuilt);
 
+	mrr_reset();
+
 	/* TODO: This should really be reset in reset_template() but for now
 	it's safer to do it explicitly here. */
 
@@ -9574,6 +9766,11 @@ ha_innobase::start_stmt(
 		prebuilt->select_lock_type = prebuilt->stored_select_lock_type;
 	}
 
+	if (prebuilt->select_lock_type != LOCK_NONE) {
+		/* The transaction cannot be read-only */
+		trx->will_lock++;
+	}
+
 	*trx->detailed_error = 0;
 
 	innobase_register_trx(ht, thd, trx);
@@ -9715,6 +9912,7 @@ ha_innobase::external_lock(
 			}
 
 			trx->mysql_n_tables_locked++;
+			trx->will_lock++;
 		}
 
 		trx->n_mysql_tables_in_use++;
@@ -9725,6 +9923,9 @@ ha_innobase::external_lock(
 
 	/* MySQL is releasing a table lock */
 
+	/* Unlock the clone used by a disk-sweep multi-range read */
+	mrr_reset();
+
 	trx->n_mysql_tables_in_use--;
 	prebuilt->mysql_has_locked = FALSE;
 
@@ -9758,6 +9959,11 @@ ha_innobase::external_lock(
 
 			read_view_close_for_mysql(trx);
 		}
+
+		if (!trx_is_started(trx)) {
+			/* The statement did not start the transaction */
+			trx->will_lock = 0;
+		}
 	}
 
 	DBUG_RETURN(0);
@@ -10736,6 +10942,421 @@ ha_innobase::cmp_ref(
 	return(0);
 }
 
+/*******************************************************************//**
+Pushes an index condition down to InnoDB. The condition is evaluated by
+row_search_for_mysql() on the secondary index records, before the
+clustered index records are fetched and, where the isolation level
+allows, before the records are locked.
+@return	the part of the condition that InnoDB does not evaluate */
+UNIV_INTERN
+Item*
+ha_innobase::idx_cond_push(
+/*=======================*/
+	uint	keyno,		/*!< in: MySQL index number */
+	Item*	idx_cond)	/*!< in: condition on the columns of the index */
+{
+	const KEY*		key;
+	const KEY_PART_INFO*	key_part;
+	const KEY_PART_INFO*	key_part_end;
+
+	DBUG_ENTER("ha_innobase::idx_cond_push");
+	DBUG_ASSERT(keyno != MAX_KEY);
+	DBUG_ASSERT(idx_cond != NULL);
+
+	key = &table->key_info[keyno];
+
+	if (keyno == table->s->primary_key) {
+		/* The clustered index record is the row itself. */
+		DBUG_RETURN(idx_cond);
+	}
+
+	/* The end of a range scan is checked together with the pushed
+	condition, on the columns that row_search_for_mysql() copies from
+	the secondary index record. A column prefix cannot be copied. */
+
+	key_part_end = key->key_part + key->key_parts;
+
+	for (key_part = key->key_part; key_part != key_part_end; key_part++) {
+		if (key_part->key_part_flag & HA_PART_KEY_SEG) {
+			DBUG_RETURN(idx_cond);
+		}
+	}
+
+	pushed_idx_cond = idx_cond;
+	pushed_idx_cond_keyno = keyno;
+
+	/* We will evaluate the condition entirely. */
+	DBUG_RETURN(NULL);
+}
+
+/*******************************************************************//**
+Cancels the index condition that was pushed down to InnoDB. */
+UNIV_INTERN
+void
+ha_innobase::cancel_pushed_idx_cond()
+/*=================================*/
+{
+	handler::cancel_pushed_idx_cond();
+
+	if (prebuilt) {
+		prebuilt->idx_cond = NULL;
+	}
+}
+
+/******************************************************************//**
+Evaluates the index condition that was pushed down to a table handle,
+on the columns that row_search_for_mysql() copied to the MySQL record
+buffer from a secondary index record.
+@return	ICP_NO_MATCH, ICP_MATCH, or ICP_OUT_OF_RANGE */
+extern "C" UNIV_INTERN
+ICP_RESULT
+innobase_index_cond(
+/*================*/
+	void*	file)	/*!< in/out: the ha_innobase handle */
+{
+	return(handler_index_cond_check(file));
+}
+
+/*******************************************************************//**
+Compares two row references for sorting them with my_qsort2().
+@return	< 0 if ref1 < ref2, 0 if equal, else > 0 */
+static
+int
+innobase_mrr_cmp_ref(
+/*=================*/
+	const void*	file,	/*!< in: the ha_innobase handle */
+	const void*	ref1,	/*!< in: row reference */
+	const void*	ref2)	/*!< in: row reference */
+{
+	return(((ha_innobase*) file)->cmp_ref((const uchar*) ref1,
+					      (const uchar*) ref2));
+}
+
+/*******************************************************************//**
+Checks if read_multi_range_first() reads the rows of the ranges in
+primary key order. This is only done for consistent reads, because the
+rows would otherwise be locked in a different order than the records of
+the secondary index, and for tables with a primary key, because
+position() does not know the row id of the returned row otherwise.
+@return	TRUE if a disk-sweep multi-range read is used */
+UNIV_INTERN
+bool
+ha_innobase::use_disk_sweep_mrr(
+/*============================*/
+	uint	keyno,		/*!< in: MySQL index number */
+	bool	sorted)		/*!< in: TRUE if the rows must be
+				returned in index order */
+{
+	return(prebuilt->select_lock_type == LOCK_NONE
+	       && !prebuilt->read_just_key
+	       && !prebuilt->clust_index_was_generated
+	       && !prebuilt->used_in_HANDLER
+	       && disk_sweep_mrr_buffer_size(keyno, sorted) > 0);
+}
+
+/*******************************************************************//**
+Allocates the buffer of row references and the clone of the handle
+that looks up the rows in the clustered index, if not done yet, and
+locks the clone for the statement. The buffer is kept until the end of
+the statement, and the clone until this handle is closed.
+@return	0 or error number */
+UNIV_INTERN
+int
+ha_innobase::mrr_open(
+/*==================*/
+	ulong	buf_size)	/*!< in: size of the buffer in bytes */
+{
+	int	error;
+
+	if (mrr_buf == NULL) {
+		mrr_buf = (uchar*) my_malloc(buf_size, MYF(0));
+
+		if (mrr_buf == NULL) {
+			return(HA_ERR_OUT_OF_MEM);
+		}
+
+		mrr_buf_end = mrr_buf + buf_size;
+	}
+
+	if (mrr_file == NULL) {
+		mrr_file = static_cast<ha_innobase*>(
+			clone(table->s->normalized_path.str, &mrr_mem_root));
+
+		if (mrr_file == NULL) {
+			free_root(&mrr_mem_root, MYF(0));
+			return(HA_ERR_OUT_OF_MEM);
+		}
+	}
+
+	if (!mrr_file->prebuilt->mysql_has_locked) {
+		error = mrr_file->ha_external_lock(user_thd, F_RDLCK);
+
+		if (error) {
+			return(error);
+		}
+	}
+
+	return(0);
+}
+
+/*******************************************************************//**
+Collects the row references of the index records in the ranges until
+mrr_buf is full or the end of the ranges is reached, and sorts them in
+primary key order.
+@return	0 or error number */
+UNIV_INTERN
+int
+ha_innobase::mrr_fill_buffer(
+/*=========================*/
+	int	error)		/*!< in: result of reading the first
+				index record to collect */
+{
+	KEY_MULTI_RANGE*	range;
+
+	mrr_buf_cur = mrr_buf_last = mrr_buf;
+
+	while (!error) {
+		position((const uchar*) table->record[0]);
+		memcpy(mrr_buf_last, ref, ref_length);
+		mrr_buf_last += ref_length;
+
+		if (mrr_buf_last + ref_length > mrr_buf_end) {
+			/* The buffer is full. The index scan will continue
+			from the current record after the rows have been
+			read. */
+			break;
+		}
+
+		error = handler::read_multi_range_next(&range);
+	}
+
+	if (error == HA_ERR_END_OF_FILE) {
+		mrr_index_eof = TRUE;
+	} else if (error) {
+		return(error);
+	}
+
+	my_qsort2(mrr_buf, (mrr_buf_last - mrr_buf) / ref_length, ref_length,
+		  innobase_mrr_cmp_ref, this);
+
+	return(0);
+}
+
+/*******************************************************************//**
+Reads the next row of a disk-sweep multi-range read from the clustered
+index, refilling mrr_buf from the secondary index when it is empty.
+@return	0, HA_ERR_END_OF_FILE, or error number */
+UNIV_INTERN
+int
+ha_innobase::mrr_next_row(
+/*======================*/
+	KEY_MULTI_RANGE**	found_range_p)	/*!< out: the range the index
+						scan is in; the row may be
+						in any of the ranges */
+{
+	KEY_MULTI_RANGE*	range;
+	int			error;
+
+	for (;;) {
+		if (mrr_buf_cur == mrr_buf_last) {
+			if (mrr_index_eof) {
+				error = HA_ERR_END_OF_FILE;
+				break;
+			}
+
+			error = mrr_fill_buffer(
+				handler::read_multi_range_next(&range));
+
+			if (error) {
+				break;
+			}
+
+			continue;
+		}
+
+		error = mrr_file->index_read(table->record[0], mrr_buf_cur,
+					     ref_length, HA_READ_KEY_EXACT);
+		mrr_buf_cur += ref_length;
+
+		switch (error) {
+		case HA_ERR_KEY_NOT_FOUND:
+		case HA_ERR_END_OF_FILE:
+			/* The row is not visible in the read view. */
+			continue;
+		}
+
+		*found_range_p = multi_range_curr;
+		return(error);
+	}
+
+	mrr_end();
+
+	return(error);
+}
+
+/*******************************************************************//**
+Ends a disk-sweep multi-range read, and makes this handle fetch the
+columns that it fetched before the index scan again. */
+UNIV_INTERN
+void
+ha_innobase::mrr_end(void)
+/*======================*/
+{
+	if (mrr_disk_sweep) {
+		mrr_disk_sweep = false;
+
+		prebuilt->read_just_key = 0;
+		prebuilt->hint_need_to_fetch_extra_cols = mrr_saved_hint;
+
+		build_template(prebuilt, user_thd, table, this,
+			       ROW_MYSQL_REC_FIELDS);
+	}
+}
+
+/*******************************************************************//**
+Frees the buffer of row references, and unlocks the clone of the handle
+and resets its cursor, at the end of a statement. The clone is kept open
+for the next statement. */
+UNIV_INTERN
+void
+ha_innobase::mrr_reset(void)
+/*========================*/
+{
+	if (mrr_disk_sweep) {
+		/* The template is built again at the start of the next
+		statement. */
+		mrr_disk_sweep = false;
+
+		prebuilt->read_just_key = 0;
+		prebuilt->hint_need_to_fetch_extra_cols = mrr_saved_hint;
+	}
+
+	if (mrr_file != NULL) {
+		if (mrr_file->prebuilt->mysql_has_locked) {
+			mrr_file->ha_external_lock(user_thd, F_UNLCK);
+		}
+
+		mrr_file->reset();
+	}
+
+	if (mrr_buf != NULL) {
+		my_free(mrr_buf);
+		mrr_buf = NULL;
+	}
+}
+
+/*******************************************************************//**
+Closes the clone of the handle, when this handle is closed. */
+UNIV_INTERN
+void
+ha_innobase::mrr_close(void)
+/*========================*/
+{
+	mrr_reset();
+
+	if (mrr_file != NULL) {
+		mrr_file->close();
+		delete mrr_file;
+		mrr_file = NULL;
+		free_root(&mrr_mem_root, MYF(0));
+	}
+}
+
+/*******************************************************************//**
+Reads the first row of a set of ranges on the active index. If the
+index is a secondary index and the whole rows are needed, the primary
+keys of the index records in the ranges are collected in a buffer of
+mrr_buffer_size bytes and sorted, and the rows are read from the
+clustered index in primary key order (disk-sweep multi-range read).
+This replaces one random clustered index lookup for each index record
+with a sweep over the clustered index. The rows are then not returned
+in index order.
+@return	0, HA_ERR_END_OF_FILE, or error number */
+UNIV_INTERN
+int
+ha_innobase::read_multi_range_first(
+/*================================*/
+	KEY_MULTI_RANGE**	found_range_p,	/*!< out: the range of the
+						row; for a disk-sweep, the
+						range the index scan is in */
+	KEY_MULTI_RANGE*	ranges,		/*!< in: ranges */
+	uint			range_count,	/*!< in: number of ranges */
+	bool			sorted,		/*!< in: TRUE if the rows must
+						be returned in index order */
+	HANDLER_BUFFER*		buffer)		/*!< in: unused */
+{
+	int	error;
+
+	DBUG_ENTER("ha_innobase::read_multi_range_first");
+
+	/* A previous set of ranges may not have been read to the end. */
+	mrr_end();
+
+	if (!use_disk_sweep_mrr(active_index, sorted)
+	    || mrr_open(disk_sweep_mrr_buffer_size(active_index, sorted))) {
+
+		DBUG_RETURN(handler::read_multi_range_first(
+				    found_range_p, ranges, range_count,
+				    sorted, buffer));
+	}
+
+	/* The clone looks up the rows by their primary key. */
+	error = mrr_file->change_active_index(primary_key);
+
+	if (error) {
+		DBUG_RETURN(error);
+	}
+
+	/* position() copies the primary key columns from the record. */
+	table->prepare_for_position();
+
+	mrr_disk_sweep = true;
+	mrr_index_eof = FALSE;
+	mrr_saved_hint = prebuilt->hint_need_to_fetch_extra_cols;
+
+	/* Fetch only the columns of the secondary index, including the
+	primary key columns, while collecting the row references. */
+	prebuilt->read_just_key = 1;
+
+	if (mrr_saved_hint != ROW_RETRIEVE_ALL_COLS) {
+		prebuilt->hint_need_to_fetch_extra_cols
+			= ROW_RETRIEVE_PRIMARY_KEY;
+	}
+
+	build_template(prebuilt, user_thd, table, this, ROW_MYSQL_REC_FIELDS);
+
+	error = mrr_fill_buffer(handler::read_multi_range_first(
+					found_range_p, ranges, range_count,
+					sorted, buffer));
+
+	if (error) {
+		mrr_end();
+		DBUG_RETURN(error);
+	}
+
+	DBUG_RETURN(mrr_next_row(found_range_p));
+}
+
+/*******************************************************************//**
+Reads the next row of a set of ranges.
+@see read_multi_range_first()
+@return	0, HA_ERR_END_OF_FILE, or error number */
+UNIV_INTERN
+int
+ha_innobase::read_multi_range_next(
+/*===============================*/
+	KEY_MULTI_RANGE**	found_range_p)	/*!< out: the range of the
+						row */
+{
+	DBUG_ENTER("ha_innobase::read_multi_range_next");
+
+	if (!mrr_disk_sweep) {
+		DBUG_RETURN(handler::read_multi_range_next(found_range_p));
+	}
+
+	DBUG_RETURN(mrr_next_row(found_range_p));
+}
+
 /*******************************************************************//**
 Ask InnoDB if a query to a table can be cached.
 @return	TRUE if query caching of the table is permitted */
@@ -10922,33 +11543,6 @@ innobase_xa_prepare(
 
 	srv_active_wake_master_thread();
 
-	if (thd_sql_command(thd) != SQLCOM_XA_PREPARE
-	    && (all
-		|| !thd_test_options(
-			thd, OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN))) {
-
-		/* For ibbackup to work the order of transactions in binlog
-		and InnoDB must be the same. Consider the situation
-
-		  thread1> prepare; write to binlog; ...
-			  <context switch>
-		  thread2> prepare; write to binlog; commit
-		  thread1>			     ... commit
-
-		To ensure this will not happen we're taking the mutex on
-		prepare, and releasing it on commit.
-
-		Note: only do it for normal commits, done via ha_commit_trans.
-		If 2pc protocol is executed by external transaction
-		coordinator, it will be just a regular MySQL client
-		executing XA PREPARE and XA COMMIT commands.
-		In this case we cannot know how many minutes or hours
-		will be between XA PREPARE and XA COMMIT, and we don't want
-		to block for undefined period of time. */
-		mysql_mutex_lock(&prepare_commit_mutex);
-		trx_owns_prepare_commit_mutex_set(trx);
-	}
-
 	return(error);
 }
 
@@ -11502,6 +12096,86 @@ innodb_file_format_max_update(
 	}
 }
 
+/*************************************************************//**
+Check if innodb_buffer_pool_size can be changed to the given value, and
+round the value up to a multiple of innodb_buffer_pool_chunk_size times
+innodb_buffer_pool_instances.
+@return	0 for valid innodb_buffer_pool_size */
+static
+int
+innodb_buffer_pool_size_validate(
+/*=============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value)	/*!< in: incoming value */
+{
+	long long	intbuf;
+	ulint		requested;
+
+	DBUG_ENTER("innodb_buffer_pool_size_validate");
+
+	if (value->val_int(value, &intbuf)) {
+		/* The value is NULL. That is invalid. */
+		DBUG_RETURN(1);
+	}
+
+	if (srv_buf_pool_old_size != srv_buf_pool_size) {
+		push_warning_printf(thd, MYSQL_ERROR::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: Cannot resize the buffer pool"
+				    " while another resize is in progress.");
+		DBUG_RETURN(1);
+	}
+
+	if (intbuf < 5 * 1024 * 1024
+	    || (sizeof(ulint) == 4 && intbuf > UINT_MAX32)) {
+		DBUG_RETURN(1);
+	}
+
+	requested = buf_pool_size_align((ulint) intbuf);
+
+	if (requested != (ulint) intbuf) {
+		push_warning_printf(thd, MYSQL_ERROR::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: innodb_buffer_pool_size was"
+				    " rounded up to %lu, a multiple of"
+				    " innodb_buffer_pool_chunk_size times"
+				    " innodb_buffer_pool_instances.",
+				    (ulong) requested);
+	}
+
+	*reinterpret_cast<long long*>(save) = (long long) requested;
+
+	DBUG_RETURN(0);
+}
+
+/****************************************************************//**
+Update the system variable innodb_buffer_pool_size using the "saved"
+value and wake up the buffer pool resize thread. This function is
+registered as a callback with MySQL. */
+static
+void
+innodb_buffer_pool_size_update(
+/*===========================*/
+	THD*				thd,		/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,		/*!< in: pointer to
+							system variable */
+	void*				var_ptr,	/*!< out: where the
+							formal string goes */
+	const void*			save)		/*!< in: immediate result
+							from check function */
+{
+	long long	in_val = *static_cast<const long long*>(save);
+
+	*static_cast<long long*>(var_ptr) = in_val;
+
+	srv_buf_pool_size = (ulint) in_val;
+	os_event_set(srv_buf_resize_event);
+}
+
 /****************************************************************//**
 Update the system variable innodb_adaptive_hash_index using the "saved"
 value. This function is registered as a callback with MySQL. */
@@ -11518,6 +12192,17 @@ innodb_adaptive_hash_index_update(
 							from check function */
 {
 	if (*(my_bool*) save) {
+		if (srv_buf_pool_old_size != srv_buf_pool_size) {
+			/* buf_pool_resize() enables the adaptive
+			hash index again when it is done. */
+			push_warning_printf(thd, MYSQL_ERROR::WARN_LEVEL_WARN,
+					    ER_WRONG_ARGUMENTS,
+					    "InnoDB: Cannot enable the"
+					    " adaptive hash index while the"
+					    " buffer pool is being resized.");
+			return;
+		}
+
 		btr_search_enable();
 	} else {
 		btr_search_disable();
@@ -11543,6 +12228,30 @@ innodb_old_blocks_pct_update(
 		*static_cast<const uint*>(save), TRUE);
 }
 
+/****************************************************************//**
+Update the system variable innodb_cmp_per_index_enabled using the
+"saved" value. The statistics collected so far are discarded when the
+collection is enabled. This function is registered as a callback with
+MySQL. */
+static
+void
+innodb_cmp_per_index_update(
+/*========================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	if (!srv_cmp_per_index_enabled && *(my_bool*) save) {
+		page_zip_stat_per_index_reset();
+	}
+
+	srv_cmp_per_index_enabled = *(my_bool*) save;
+}
+
 /*************************************************************//**
 Find the corresponding ibuf_use_t value that indexes into
 innobase_change_buffering_values[] array for the input
@@ -11700,6 +12409,111 @@ innodb_buffer_pool_evict_update(
 }
 #endif /* !DBUG_OFF */
 
+/** Placeholders for the buffer pool dump/load trigger variables, these
+always read as OFF. */
+static my_bool	innodb_buffer_pool_dump_now = FALSE;
+static my_bool	innodb_buffer_pool_load_now = FALSE;
+static my_bool	innodb_buffer_pool_load_abort = FALSE;
+
+/****************************************************************//**
+Trigger a dump of the buffer pool if innodb_buffer_pool_dump_now is set
+to ON. This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_dump_now(
+/*=================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	if (*(my_bool*) save) {
+		buf_dump_start();
+	}
+}
+
+/****************************************************************//**
+Trigger a load of the buffer pool if innodb_buffer_pool_load_now is set
+to ON. This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_load_now(
+/*=================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	if (*(my_bool*) save) {
+		buf_load_start();
+	}
+}
+
+/****************************************************************//**
+Abort a load of the buffer pool if innodb_buffer_pool_load_abort
+is set to ON. This function is registered as a callback with MySQL. */
+static
+void
+buffer_pool_load_abort(
+/*===================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	if (*(my_bool*) save) {
+		buf_load_abort();
+	}
+}
+
+/****************************************************************//**
+Validate the file name given for innodb_buffer_pool_filename. The file
+is always placed in the InnoDB data home directory, so directory
+components are not allowed.
+@return 0 for valid name */
+static
+int
+innodb_buffer_pool_filename_validate(
+/*=================================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value)	/*!< in: incoming string */
+{
+	const char*	file_name;
+	char		buff[OS_FILE_MAX_PATH];
+	int		len = sizeof(buff);
+
+	ut_a(save != NULL);
+	ut_a(value != NULL);
+
+	file_name = value->val_str(value, buff, &len);
+
+	if (file_name == NULL || *file_name == '\0'
+	    || strchr(file_name, '/') != NULL
+#ifdef __WIN__
+	    || strchr(file_name, '\\') != NULL
+#endif /* __WIN__ */
+	    ) {
+		return(1);
+	}
+
+	*static_cast<const char**>(save) = thd_strmake(thd, file_name, len);
+
+	return(0);
+}
+
 static int show_innodb_vars(THD *thd, SHOW_VAR *var, char *buff)
 {
   innodb_export_status();
@@ -11766,17 +12580,40 @@ static MYSQL_SYSVAR_BOOL(checksums, innobase_use_checksums,
   "Disable with --skip-innodb-checksums.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ENUM(checksum_algorithm, srv_checksum_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "The algorithm InnoDB uses for page and log block checksums. Possible "
+  "values are CRC32 (hardware accelerated if the CPU supports it), "
+  "INNODB (the legacy algorithm) and NONE (no checksum). Pages written "
+  "with any algorithm are accepted on read, unless a STRICT_ variant is "
+  "selected, in which case only the configured algorithm is accepted.",
+  NULL, NULL, SRV_CHECKSUM_ALGORITHM_INNODB,
+  &innodb_checksum_algorithm_typelib);
+
 static MYSQL_SYSVAR_STR(data_home_dir, innobase_data_home_dir,
   PLUGIN_VAR_READONLY,
   "The common part for InnoDB table spaces.",
   NULL, NULL, NULL);
 
+static MYSQL_SYSVAR_ULONG(dict_size_limit, srv_dict_size_limit,
+  PLUGIN_VAR_RQCMDARG,
+  "Size in bytes above which the master thread evicts unused tables from "
+  "the InnoDB data dictionary cache. 0 means no eviction (the default).",
+  NULL, NULL, 0, 0, ULONG_MAX, 0);
+
 static MYSQL_SYSVAR_BOOL(doublewrite, innobase_use_doublewrite,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
   "Enable InnoDB doublewrite buffer (enabled by default). "
   "Disable with --skip-innodb-doublewrite.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_STR(doublewrite_file, srv_doublewrite_file,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Path of a separate file for the doublewrite buffer, with a slot for "
+  "each buffer pool instance and flush type. If not set, the doublewrite "
+  "buffer is kept in the system tablespace.",
+  NULL, NULL, NULL);
+
 static MYSQL_SYSVAR_ULONG(io_capacity, srv_io_capacity,
   PLUGIN_VAR_RQCMDARG,
   "Number of IOPs the server can do. Tunes the background IO rate",
@@ -11798,13 +12635,96 @@ static MYSQL_SYSVAR_ULONG(rollback_segments, srv_rollback_segments,
   1,			/* Minimum value */
   TRX_SYS_N_RSEGS, 0);	/* Maximum value */
 
+static MYSQL_SYSVAR_STR(undo_directory, srv_undo_dir,
+  PLUGIN_VAR_READONLY,
+  "Directory where the undo tablespaces are placed, by default "
+  "innodb_data_home_dir.",
+  NULL, NULL, NULL);
+
+static MYSQL_SYSVAR_ULONG(undo_tablespaces, srv_undo_tablespaces,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of undo tablespaces that the rollback segments are spread over "
+  "when a new database is created; 0 keeps them in the system tablespace.",
+  NULL, NULL,
+  0,			/* Default setting */
+  0,			/* Minimum value */
+  TRX_SYS_N_RSEGS - 1, 0);/* Maximum value */
+
+static MYSQL_SYSVAR_BOOL(undo_log_truncate, srv_undo_log_truncate,
+  PLUGIN_VAR_OPCMDARG,
+  "Truncate the undo tablespaces that grow beyond innodb_max_undo_log_size "
+  "back to their initial size, one at a time. Needs at least two undo "
+  "tablespaces.",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONGLONG(max_undo_log_size, srv_max_undo_log_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Size in bytes above which an undo tablespace is truncated when "
+  "innodb_undo_log_truncate is enabled.",
+  NULL, NULL,
+  1024 * 1024 * 1024ULL,	/* Default setting */
+  10 * 1024 * 1024ULL,		/* Minimum value */
+  ~0ULL, 0);			/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
-  "Purge threads can be either 0 or 1.",
+  "Number of purge threads. 0 means that purge is done by the master "
+  "thread, 1 starts a dedicated purge thread, larger values also start "
+  "purge worker threads that purge the records of different tables in "
+  "parallel.",
   NULL, NULL,
   0,			/* Default setting */
   0,			/* Minimum value */
-  1, 0);		/* Maximum value */
+  SRV_MAX_N_PURGE_THREADS, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(recovery_threads, srv_n_recovery_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads that apply redo log records to pages during crash "
+  "recovery, including the thread that runs the recovery.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  SRV_MAX_N_RECOVERY_THREADS, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of page cleaner threads that flush dirty pages of the buffer "
+  "pool instances in parallel. 0 means that dirty pages are flushed by "
+  "the master thread.",
+  NULL, NULL,
+  1,			/* Default setting */
+  0,			/* Minimum value */
+  SRV_MAX_N_PAGE_CLEANERS, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(online_alter_log_max_size,
+  srv_online_alter_log_max_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum size of the log of the modifications that are made to a table "
+  "while a secondary index is being created on it without blocking "
+  "writes. If the log grows larger, creating the index fails.",
+  NULL, NULL,
+  128 * 1024 * 1024L,	/* Default setting */
+  65536L,		/* Minimum value */
+  ULONG_MAX, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size of the sort buffers and of the temporary file blocks that are "
+  "used when creating indexes. Each sort thread allocates one sort buffer "
+  "for each index being created, and three blocks.",
+  NULL, NULL,
+  1048576L,		/* Default setting */
+  65536L,		/* Minimum value */
+  64 * 1024 * 1024L, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(sort_threads, srv_n_sort_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that scan the clustered index and merge sort the "
+  "index entries in parallel when creating indexes.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  SRV_MAX_N_SORT_THREADS, 0);	/* Maximum value */
 
 static MYSQL_SYSVAR_ULONG(fast_shutdown, innobase_fast_shutdown,
   PLUGIN_VAR_OPCMDARG,
@@ -11899,6 +12819,12 @@ static MYSQL_SYSVAR_ULONG(max_purge_lag, srv_max_purge_lag,
   "Desired maximum length of the purge queue (0 = no limit)",
   NULL, NULL, 0, 0, ~0UL, 0);
 
+static MYSQL_SYSVAR_ULONG(max_purge_lag_delay, srv_max_purge_lag_delay,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum delay in microseconds of DML statements caused by "
+  "innodb_max_purge_lag (0 = no limit)",
+  NULL, NULL, 0, 0, 10000000UL, 0);
+
 static MYSQL_SYSVAR_BOOL(rollback_on_timeout, innobase_rollback_on_timeout,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Roll back the complete transaction on lock wait timeout, for 4.x compatibility (disabled by default)",
@@ -11919,12 +12845,40 @@ static MYSQL_SYSVAR_ULONGLONG(stats_sample_pages, srv_stats_sample_pages,
   "The number of index pages to sample when calculating statistics (default 8)",
   NULL, NULL, 8, 1, ~0ULL, 0);
 
+static MYSQL_SYSVAR_BOOL(stats_persistent, srv_stats_persistent,
+  PLUGIN_VAR_OPCMDARG,
+  "Store table and index statistics in the InnoDB system tables "
+  "SYS_TABLE_STATS and SYS_INDEX_STATS, so that they survive restarts "
+  "and are only recalculated by ANALYZE TABLE or in the background "
+  "(off by default)",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONGLONG(stats_persistent_sample_pages,
+  srv_stats_persistent_sample_pages,
+  PLUGIN_VAR_RQCMDARG,
+  "The number of index pages to sample when calculating persistent "
+  "statistics, for example by ANALYZE TABLE (default 20)",
+  NULL, NULL, 20, 1, ~0ULL, 0);
+
+static MYSQL_SYSVAR_BOOL(stats_auto_recalc, srv_stats_auto_recalc,
+  PLUGIN_VAR_OPCMDARG,
+  "Recalculate persistent statistics in the background after more than "
+  "10% of the rows of a table have changed (on by default)",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   PLUGIN_VAR_OPCMDARG,
   "Enable InnoDB adaptive hash index (enabled by default).  "
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, TRUE);
 
+static MYSQL_SYSVAR_ULONG(adaptive_hash_index_partitions, btr_search_n_parts,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of InnoDB adaptive hash index partitions. Each partition has "
+  "its own hash table and latch; an index is assigned to a partition "
+  "by its index id (default 1).",
+  NULL, NULL, 1, 1, BTR_SEARCH_MAX_PARTS, 0);
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if "
@@ -11941,6 +12895,25 @@ static MYSQL_SYSVAR_ULONG(autoextend_increment, srv_auto_extend_increment,
   "Data file autoextend increment in megabytes",
   NULL, NULL, 8L, 1L, 1000L, 0);
 
+static MYSQL_SYSVAR_ULONG(file_extend_percent, srv_file_extend_percent,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of its size by which a single-table tablespace of at least"
+  " 32 megabytes is extended when it fills up, in whole megabytes and at"
+  " most 256 megabytes at a time. 0 extends it by 4 megabytes at a time.",
+  NULL, NULL, 0L, 0L, 100L, 0);
+
+static MYSQL_SYSVAR_BOOL(file_preextend, srv_file_preextend,
+  PLUGIN_VAR_OPCMDARG,
+  "Extend single-table tablespaces of at least 32 megabytes in a background"
+  " thread before they fill up (off by default)",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_BOOL(use_fallocate, srv_use_fallocate,
+  PLUGIN_VAR_OPCMDARG,
+  "Extend data files with posix_fallocate() instead of writing zeros, if"
+  " the file system supports it (on by default)",
+  NULL, NULL, TRUE);
+
 #ifndef DBUG_OFF
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -11949,9 +12922,17 @@ static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
 #endif /* !DBUG_OFF */
 
 static MYSQL_SYSVAR_LONGLONG(buffer_pool_size, innobase_buffer_pool_size,
-  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  PLUGIN_VAR_RQCMDARG,
   "The size of the memory buffer InnoDB uses to cache data and indexes of its tables.",
-  NULL, NULL, 128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+  innodb_buffer_pool_size_validate, innodb_buffer_pool_size_update,
+  128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_chunk_size, srv_buf_pool_chunk_unit,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size of the chunks in which each buffer pool instance is allocated."
+  " innodb_buffer_pool_size is resized online in steps of this size"
+  " times innodb_buffer_pool_instances.",
+  NULL, NULL, 128 * 1024 * 1024L, 1024 * 1024L, LONG_MAX, 1024 * 1024L);
 
 static MYSQL_SYSVAR_BOOL(buffer_pool_populate, srv_buf_pool_populate,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
@@ -11959,6 +12940,36 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_populate, srv_buf_pool_populate,
   "established by the buffer pool memory region. Disabled by default.",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_STR(buffer_pool_filename, srv_buf_dump_filename,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_MEMALLOC,
+  "Filename to/from which to dump/load the InnoDB buffer pool",
+  innodb_buffer_pool_filename_validate, NULL, SRV_BUF_DUMP_FILENAME_DEFAULT);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_dump_now, innodb_buffer_pool_dump_now,
+  PLUGIN_VAR_RQCMDARG,
+  "Trigger an immediate dump of the buffer pool into a file named @@innodb_buffer_pool_filename",
+  NULL, buffer_pool_dump_now, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_dump_at_shutdown, srv_buffer_pool_dump_at_shutdown,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool into a file named @@innodb_buffer_pool_filename",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_load_now, innodb_buffer_pool_load_now,
+  PLUGIN_VAR_RQCMDARG,
+  "Trigger an immediate load of the buffer pool from a file named @@innodb_buffer_pool_filename",
+  NULL, buffer_pool_load_now, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_load_abort, innodb_buffer_pool_load_abort,
+  PLUGIN_VAR_RQCMDARG,
+  "Abort a currently running load of the buffer pool",
+  NULL, buffer_pool_load_abort, FALSE);
+
+static MYSQL_SYSVAR_BOOL(buffer_pool_load_at_startup, srv_buffer_pool_load_at_startup,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Load the buffer pool from a file named @@innodb_buffer_pool_filename",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_LONG(buffer_pool_instances, innobase_buffer_pool_instances,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Number of buffer pool instances, set to higher value on high-end machines to increase scalability",
@@ -12046,6 +13057,11 @@ static MYSQL_SYSVAR_ULONG(spin_wait_delay, srv_spin_wait_delay,
   "Maximum delay between polling for a spin lock (6 by default)",
   NULL, NULL, 6L, 0L, ~0UL, 0);
 
+static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of wait arrays that threads waiting for an InnoDB mutex or rw-lock are spread over (1 by default)",
+  NULL, NULL, 1L, 1L, 1024L, 0);
+
 static MYSQL_SYSVAR_ULONG(thread_concurrency, srv_thread_concurrency,
   PLUGIN_VAR_RQCMDARG,
   "Helps in performance tuning in heavily concurrent environments. Sets the maximum number of threads allowed inside InnoDB. Value 0 will disable the thread throttling.",
@@ -12190,22 +13206,67 @@ static MYSQL_SYSVAR_BOOL(print_all_deadlocks, srv_print_all_deadlocks,
   "Print all deadlocks to MySQL error log (off by default)",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(deadlock_detect, srv_deadlock_detect,
+  PLUGIN_VAR_OPCMDARG,
+  "Check for deadlocks when a transaction starts waiting for a lock."
+  " If disabled, deadlocks are resolved by innodb_lock_wait_timeout"
+  " (on by default)",
+  NULL, NULL, TRUE);
+
+static MYSQL_SYSVAR_ULONG(compression_level, page_zip_level,
+  PLUGIN_VAR_RQCMDARG,
+  "zlib compression level of compressed pages, from 0 (no compression)"
+  " to 9 (best compression)",
+  NULL, NULL, DEFAULT_COMPRESSION_LEVEL, 0, 9, 0);
+
+static MYSQL_SYSVAR_ULONG(compression_failure_threshold_pct,
+  dict_zip_failure_threshold_pct,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of failed compressions of an index above which empty space"
+  " is left on its uncompressed pages. 0 disables the padding",
+  NULL, NULL, DICT_ZIP_FAILURE_THRESHOLD_PCT_DEFAULT, 0, 100, 0);
+
+static MYSQL_SYSVAR_ULONG(compression_pad_pct_max, dict_zip_pad_max,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum percentage of an uncompressed page that may be left empty"
+  " to reduce compression failures",
+  NULL, NULL, DICT_ZIP_PAD_MAX_DEFAULT, 0, 75, 0);
+
+static MYSQL_SYSVAR_BOOL(cmp_per_index_enabled, srv_cmp_per_index_enabled,
+  PLUGIN_VAR_OPCMDARG,
+  "Collect compression statistics per index for"
+  " INFORMATION_SCHEMA.INNODB_CMP_PER_INDEX (off by default)",
+  NULL, innodb_cmp_per_index_update, FALSE);
+
 static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(additional_mem_pool_size),
   MYSQL_SYSVAR(autoextend_increment),
+  MYSQL_SYSVAR(file_extend_percent),
+  MYSQL_SYSVAR(file_preextend),
+  MYSQL_SYSVAR(use_fallocate),
 #ifndef DBUG_OFF
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* !DBUG_OFF */
   MYSQL_SYSVAR(buffer_pool_size),
+  MYSQL_SYSVAR(buffer_pool_chunk_size),
   MYSQL_SYSVAR(buffer_pool_populate),
   MYSQL_SYSVAR(buffer_pool_instances),
+  MYSQL_SYSVAR(buffer_pool_filename),
+  MYSQL_SYSVAR(buffer_pool_dump_now),
+  MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
+  MYSQL_SYSVAR(buffer_pool_load_now),
+  MYSQL_SYSVAR(buffer_pool_load_abort),
+  MYSQL_SYSVAR(buffer_pool_load_at_startup),
   MYSQL_SYSVAR(flush_neighbors),
   MYSQL_SYSVAR(checksums),
+  MYSQL_SYSVAR(checksum_algorithm),
   MYSQL_SYSVAR(commit_concurrency),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
+  MYSQL_SYSVAR(dict_size_limit),
   MYSQL_SYSVAR(doublewrite),
+  MYSQL_SYSVAR(doublewrite_file),
   MYSQL_SYSVAR(fast_shutdown),
   MYSQL_SYSVAR(file_io_threads),
   MYSQL_SYSVAR(read_io_threads),
@@ -12232,6 +13293,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(max_dirty_pages_pct),
   MYSQL_SYSVAR(adaptive_flushing),
   MYSQL_SYSVAR(max_purge_lag),
+  MYSQL_SYSVAR(max_purge_lag_delay),
   MYSQL_SYSVAR(mirrored_log_groups),
   MYSQL_SYSVAR(old_blocks_pct),
   MYSQL_SYSVAR(old_blocks_time),
@@ -12239,7 +13301,11 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(rollback_on_timeout),
   MYSQL_SYSVAR(stats_on_metadata),
   MYSQL_SYSVAR(stats_sample_pages),
+  MYSQL_SYSVAR(stats_persistent),
+  MYSQL_SYSVAR(stats_persistent_sample_pages),
+  MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_partitions),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
@@ -12247,6 +13313,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
+  MYSQL_SYSVAR(sync_array_size),
   MYSQL_SYSVAR(table_locks),
   MYSQL_SYSVAR(thread_concurrency),
   MYSQL_SYSVAR(thread_sleep_delay),
@@ -12262,8 +13329,17 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(read_ahead_threshold),
   MYSQL_SYSVAR(io_capacity),
   MYSQL_SYSVAR(purge_threads),
+  MYSQL_SYSVAR(recovery_threads),
+  MYSQL_SYSVAR(page_cleaners),
+  MYSQL_SYSVAR(online_alter_log_max_size),
+  MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(sort_threads),
   MYSQL_SYSVAR(purge_batch_size),
   MYSQL_SYSVAR(rollback_segments),
+  MYSQL_SYSVAR(undo_directory),
+  MYSQL_SYSVAR(undo_tablespaces),
+  MYSQL_SYSVAR(undo_log_truncate),
+  MYSQL_SYSVAR(max_undo_log_size),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(trx_rseg_n_slots_debug),
   MYSQL_SYSVAR(limit_optimistic_insert_debug),
@@ -12278,6 +13354,11 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(reserve_free_extents),
   MYSQL_SYSVAR(free_extents_reservation_factor),
   MYSQL_SYSVAR(print_all_deadlocks),
+  MYSQL_SYSVAR(deadlock_detect),
+  MYSQL_SYSVAR(compression_level),
+  MYSQL_SYSVAR(compression_failure_threshold_pct),
+  MYSQL_SYSVAR(compression_pad_pct_max),
+  MYSQL_SYSVAR(cmp_per_index_enabled),
   NULL
 };
 
@@ -12302,6 +13383,8 @@ i_s_innodb_locks,
 i_s_innodb_lock_waits,
 i_s_innodb_cmp,
 i_s_innodb_cmp_reset,
+i_s_innodb_cmp_per_index,
+i_s_innodb_cmp_per_index_reset,
 i_s_innodb_cmpmem,
 i_s_innodb_cmpmem_reset,
 i_s_innodb_buffer_page,
@@ -97,6 +97,26 @@ class ha_innobase: public handler
 					or undefined */
 	uint		num_write_row;	/*!< number of write_row() calls */
 
+	/** Disk-sweep multi-range read @see read_multi_range_first() @{ */
+	ha_innobase*	mrr_file;	/*!< clone of this handle that looks
+					up the rows in the clustered index,
+					or NULL */
+	MEM_ROOT	mrr_mem_root;	/*!< memory for mrr_file */
+	uchar*		mrr_buf;	/*!< buffer of row references,
+					or NULL */
+	uchar*		mrr_buf_end;	/*!< end of mrr_buf */
+	uchar*		mrr_buf_cur;	/*!< next row reference to look up */
+	uchar*		mrr_buf_last;	/*!< end of the row references
+					collected in mrr_buf */
+	ulint		mrr_saved_hint;	/*!< prebuilt->
+					hint_need_to_fetch_extra_cols
+					before the index scan */
+	bool		mrr_disk_sweep;	/*!< TRUE if the current multi-range
+					read is a disk-sweep */
+	bool		mrr_index_eof;	/*!< TRUE if the index scan has
+					reached the end of the ranges */
+	/** @} */
+
 	uint store_key_val_for_row(uint keynr, char* buff, uint buff_len,
                                    const uchar* record);
 	inline void update_thd(THD* thd);
@@ -112,6 +132,12 @@ class ha_innobase: public handler
 	void innobase_initialize_autoinc();
 	dict_index_t* innobase_get_index(uint keynr);
 	int info_low(uint flag, bool called_from_analyze);
+	int mrr_open(ulong buf_size);
+	int mrr_fill_buffer(int error);
+	int mrr_next_row(KEY_MULTI_RANGE** found_range_p);
+	void mrr_end();
+	void mrr_reset();
+	void mrr_close();
 
 	/* Init values for the class: */
  public:
@@ -229,6 +255,17 @@ class ha_innobase: public handler
 				 int action_flag, HA_CREATE_INFO *create_info);
 	bool check_if_incompatible_data(HA_CREATE_INFO *info,
 					uint table_changes);
+	/** Index condition pushdown @see row_search_for_mysql() @{ */
+	Item* idx_cond_push(uint keyno, Item* idx_cond);
+	void cancel_pushed_idx_cond();
+	/** @} */
+	/** Disk-sweep multi-range read @{ */
+	int read_multi_range_first(KEY_MULTI_RANGE** found_range_p,
+				   KEY_MULTI_RANGE* ranges, uint range_count,
+				   bool sorted, HANDLER_BUFFER* buffer);
+	int read_multi_range_next(KEY_MULTI_RANGE** found_range_p);
+	bool use_disk_sweep_mrr(uint keyno, bool sorted);
+	/** @} */
 };
 
 /* Some accessor functions which the InnoDB plugin needs, but which
@@ -253,6 +290,27 @@ const char* mysql_bin_log_file_name(void);
  */
 ulonglong mysql_bin_log_file_pos(void);
 
+/** Get the binlog file name and the position right after the events of
+ * the transaction the user thread is committing.
+ * @param thd   user thread
+ * @param pos   out: byte offset from the beginning of the binlog
+ * @param file  out: the name of the binlog file
+ */
+void mysql_bin_log_commit_pos(MYSQL_THD thd, ulonglong *pos,
+			      const char **file);
+
+/** Wait until the transactions written to the binlog before the one of
+ * the user thread have been committed, so that InnoDB commits in binlog
+ * order.
+ * @param thd   user thread
+ */
+void mysql_bin_log_commit_order_enter(MYSQL_THD thd);
+
+/** Let the next transaction in binlog order commit.
+ * @param thd   user thread
+ */
+void mysql_bin_log_commit_order_exit(MYSQL_THD thd);
+
 /**
   Get the file name of the mater's binlog.
   @return the name of the binlog file
@@ -28,6 +28,7 @@ Smart ALTER TABLE
 
 extern "C" {
 #include "log0log.h"
+#include "row0log.h"
 #include "row0merge.h"
 #include "srv0srv.h"
 #include "trx0trx.h"
@@ -677,6 +678,8 @@ ha_innobase::add_index(
 	ulint		num_of_idx;
 	ulint		num_created	= 0;
 	ibool		dict_locked	= FALSE;
+	ibool		online		= FALSE;
+	ibool		logging		= FALSE;
 	ulint		new_primary;
 	int		error;
 
@@ -760,9 +763,35 @@ ha_innobase::add_index(
 	the data dictionary will be locked in crash recovery. */
 	trx_set_dict_operation(trx, TRX_DICT_OP_INDEX);
 
-	/* Acquire a lock on the table before creating any indexes. */
-	error = row_merge_lock_table(prebuilt->trx, prebuilt->table,
-				     new_primary ? LOCK_X : LOCK_S);
+	/* Secondary indexes that need no uniqueness check can be created
+	while other transactions modify the table. The indexes are built
+	from a read view that is created below, so this transaction must
+	not hold any locks (LOCK TABLES) or an older read view. */
+	if (!new_primary
+	    && !UT_LIST_GET_LEN(prebuilt->trx->trx_locks)
+	    && !prebuilt->trx->read_view) {
+
+		online = TRUE;
+
+		for (ulint i = 0; i < num_of_idx; i++) {
+			if (index_defs[i].ind_type & DICT_UNIQUE) {
+				online = FALSE;
+				break;
+			}
+		}
+	}
+
+	/* Acquire a lock on the table before creating any indexes.
+	When creating the indexes online, the data dictionary transaction
+	waits for the transactions that modified the table to finish, and
+	releases the lock as soon as the indexes are logging the
+	modifications of the table. */
+	if (online) {
+		error = row_merge_lock_table(trx, prebuilt->table, LOCK_S);
+	} else {
+		error = row_merge_lock_table(prebuilt->trx, prebuilt->table,
+					     new_primary ? LOCK_X : LOCK_S);
+	}
 
 	if (UNIV_UNLIKELY(error != DB_SUCCESS)) {
 
@@ -838,6 +867,19 @@ ha_innobase::add_index(
 
 	ut_ad(error == DB_SUCCESS);
 
+	if (online) {
+		for (ulint i = 0; i < num_of_idx; i++) {
+			row_log_allocate(index[i]);
+		}
+
+		logging = TRUE;
+
+		/* No transaction can have uncommitted modifications of
+		the table while trx holds the S lock. Every modification
+		that the read view does not see will thus be logged. */
+		trx_assign_read_view(prebuilt->trx);
+	}
+
 	/* Commit the data dictionary transaction in order to release
 	the table locks on the system tables.  This means that if
 	MySQL crashes while creating a new primary key inside
@@ -870,7 +912,7 @@ ha_innobase::add_index(
 	based on this information using temporary files and merge sort. */
 	error = row_merge_build_indexes(prebuilt->trx,
 					prebuilt->table, indexed_table,
-					index, num_of_idx, table);
+					index, num_of_idx, table, online);
 
 error_handling:
 	/* After an error, remove all those index definitions from the
@@ -905,6 +947,31 @@ error:
 				row_merge_drop_table(trx, indexed_table);
 			}
 		} else {
+			if (logging) {
+				ut_ad(!dict_locked);
+
+				for (ulint i = 0; i < num_created; i++) {
+					row_log_abort_sec(index[i]);
+				}
+
+				/* Wait for the modifications that may be
+				accessing the indexes to finish. */
+				trx_start_if_not_started(trx);
+
+				if (row_merge_lock_table(trx, indexed_table,
+							 LOCK_X)
+				    != DB_SUCCESS) {
+					sql_print_error(
+						"InnoDB: Could not lock table"
+						" %s for dropping the indexes"
+						" that were being created;"
+						" they will be dropped at the"
+						" next server startup",
+						indexed_table->name);
+					break;
+				}
+			}
+
 			if (!dict_locked) {
 				row_mysql_lock_data_dictionary(trx);
 				dict_locked = TRUE;
@@ -946,6 +1013,8 @@ ha_innobase::final_add_index(
 {
 	ha_innobase_add_index*	add;
 	trx_t*			trx;
+	ulint			online_error	= DB_SUCCESS;
+	ibool			drop		= TRUE;
 	int			err	= 0;
 
 	DBUG_ENTER("ha_innobase::final_add_index");
@@ -962,6 +1031,48 @@ ha_innobase::final_add_index(
 	the data dictionary will be locked in crash recovery. */
 	trx_set_dict_operation(trx, TRX_DICT_OP_INDEX);
 
+	if (add->indexed_table == prebuilt->table) {
+		dict_index_t*	index;
+		ibool		online	= FALSE;
+
+		/* Apply the modification logs of the indexes that were
+		created online. The caller has blocked the modifications
+		of the table, unless we are rolling back. */
+		trx_start_if_not_started(prebuilt->trx);
+
+		for (index = dict_table_get_first_index(prebuilt->table);
+		     index; index = dict_table_get_next_index(index)) {
+
+			if (*index->name != TEMP_INDEX_PREFIX
+			    || !dict_index_is_online_ddl(index)) {
+				continue;
+			}
+
+			online = TRUE;
+
+			if (commit && online_error == DB_SUCCESS) {
+				online_error = row_log_apply(
+					prebuilt->trx, index);
+			} else {
+				row_log_abort_sec(index);
+			}
+		}
+
+		if (online && (!commit || online_error != DB_SUCCESS)
+		    && row_merge_lock_table(trx, prebuilt->table, LOCK_X)
+		    != DB_SUCCESS) {
+			/* Modifications may still be accessing the
+			indexes. Leave them for row_merge_drop_temp_indexes()
+			at the next startup. */
+			sql_print_error("InnoDB: Could not lock table %s"
+					" for dropping the indexes that"
+					" were being created; they will be"
+					" dropped at the next server startup",
+					prebuilt->table->name);
+			drop = FALSE;
+		}
+	}
+
 	/* Latch the InnoDB data dictionary exclusively so that no deadlocks
 	or lock waits can happen in it during an index create operation. */
 	row_mysql_lock_data_dictionary(trx);
@@ -1013,7 +1124,8 @@ ha_innobase::final_add_index(
 			trx_commit_for_mysql(prebuilt->trx);
 			row_prebuilt_free(prebuilt, TRUE);
 			error = row_merge_drop_table(trx, old_table);
-			add->indexed_table->n_mysql_handles_opened++;
+			dict_table_increment_handle_count(
+				add->indexed_table);
 			prebuilt = row_create_prebuilt(add->indexed_table,
 				0 /* XXX Do we know the mysql_row_len here?
 				Before the addition of this parameter to
@@ -1027,13 +1139,17 @@ ha_innobase::final_add_index(
 	} else {
 		/* We created secondary indexes (!new_primary). */
 
-		if (commit) {
+		if (commit && online_error != DB_SUCCESS) {
+			err = convert_error_code_to_mysql(
+				online_error, prebuilt->table->flags,
+				user_thd);
+		} else if (commit) {
 			err = convert_error_code_to_mysql(
 				row_merge_rename_indexes(trx, prebuilt->table),
 				prebuilt->table->flags, user_thd);
 		}
 
-		if (!commit || err) {
+		if (drop && (!commit || err)) {
 			dict_index_t*	index;
 			dict_index_t*	next_index;
 
@@ -498,6 +498,22 @@ ibuf_size_update(
 	ibuf->size = ibuf->seg_size - (1 + ibuf->free_list_len);
 }
 
+/******************************************************************//**
+Updates the maximum size of the insert buffer after the buffer pool
+has been resized. */
+UNIV_INTERN
+void
+ibuf_max_size_update(void)
+/*======================*/
+{
+	ulint	new_size = buf_pool_get_curr_size() / UNIV_PAGE_SIZE
+		/ IBUF_POOL_SIZE_PER_MAX_SIZE;
+
+	mutex_enter(&ibuf_mutex);
+	ibuf->max_size = new_size;
+	mutex_exit(&ibuf_mutex);
+}
+
 /******************************************************************//**
 Creates the insert buffer data structure at a database startup and initializes
 the data structures for the insert buffer. */
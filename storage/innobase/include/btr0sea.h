@@ -40,13 +40,23 @@ UNIV_INTERN
 void
 btr_search_sys_create(
 /*==================*/
-	ulint	hash_size);	/*!< in: hash index hash table size */
+	ulint	hash_size);	/*!< in: total hash table size of all the
+				adaptive hash index partitions */
 /*****************************************************************//**
 Frees the adaptive search system at a database shutdown. */
 UNIV_INTERN
 void
 btr_search_sys_free(void);
 /*=====================*/
+/*****************************************************************//**
+Recreates the hash tables of the adaptive hash index partitions for a
+new buffer pool size. The adaptive hash index must be disabled. */
+UNIV_INTERN
+void
+btr_search_sys_resize(
+/*==================*/
+	ulint	hash_size);	/*!< in: total hash table size of all the
+				adaptive hash index partitions */
 
 /********************************************************************//**
 Disable the adaptive hash search system and empty the index. */
@@ -61,6 +71,38 @@ void
 btr_search_enable(void);
 /*====================*/
 
+/********************************************************************//**
+X-latches the latches of all the adaptive hash index partitions,
+in ascending order. */
+UNIV_INTERN
+void
+btr_search_x_lock_all(void);
+/*========================*/
+/********************************************************************//**
+Releases the x-latches of all the adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_unlock_all(void);
+/*==========================*/
+#ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the current thread owns the latches of all the adaptive hash
+index partitions in the given mode.
+@return	TRUE if owns all of them */
+UNIV_INTERN
+ibool
+btr_search_own_all(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+#endif /* UNIV_SYNC_DEBUG */
+/********************************************************************//**
+Gets the hash table of the adaptive hash index partition of an index id.
+@return	hash table */
+UNIV_INLINE
+hash_table_t*
+btr_search_get_hash_table(
+/*======================*/
+	index_id_t	index_id);	/*!< in: index id */
 /********************************************************************//**
 Returns search info for an index.
 @return	search info; search mutex reserved */
@@ -78,14 +120,15 @@ btr_search_info_create(
 /*===================*/
 	mem_heap_t*	heap);	/*!< in: heap where created */
 /*****************************************************************//**
-Returns the value of ref_count. The value is protected by
-btr_search_latch.
+Returns the value of ref_count. The value is protected by the latch of
+the adaptive hash index partition of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info);	/*!< in: search info. */
+	btr_search_t*		info,	/*!< in: search info. */
+	const dict_index_t*	index);	/*!< in: index */
 /*********************************************************************//**
 Updates the search info. */
 UNIV_INLINE
@@ -111,7 +154,8 @@ btr_search_guess_on_hash(
 	ulint		latch_mode,	/*!< in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on the adaptive hash
+					index latch of index:
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr);		/*!< in: mtr */
 /********************************************************************//**
@@ -191,13 +235,22 @@ btr_search_validate(void);
 #else
 # define btr_search_validate()	TRUE
 #endif /* defined UNIV_AHI_DEBUG || defined UNIV_DEBUG */
+/********************************************************************//**
+Prints the sizes and the lookup counters of the adaptive hash index
+partitions. */
+UNIV_INTERN
+void
+btr_search_print_info(
+/*==================*/
+	FILE*	file);	/*!< in: file where to print */
 
 /** The search info struct in an index */
 struct btr_search_struct{
 	ulint	ref_count;	/*!< Number of blocks in this index tree
 				that have search index built
 				i.e. block->index points to this index.
-				Protected by btr_search_latch except
+				Protected by the latch of the adaptive
+				hash index partition of the index except
 				when during initialization in
 				btr_search_info_create(). */
 
@@ -252,14 +305,25 @@ typedef struct btr_search_sys_struct	btr_search_sys_t;
 
 /** The hash index system */
 struct btr_search_sys_struct{
-	hash_table_t*	hash_index;	/*!< the adaptive hash index,
+	hash_table_t**	hash_index;	/*!< the adaptive hash index
+					partitions: an array of
+					btr_search_n_parts hash tables,
 					mapping dtuple_fold values
 					to rec_t pointers on index pages */
+	ulint*		n_hits;		/*!< number of successful lookups
+					in each partition; not protected
+					by any latch, may be inexact */
+	ulint*		n_misses;	/*!< number of failed lookups
+					in each partition; not protected
+					by any latch, may be inexact */
 };
 
 /** The adaptive hash index */
 extern btr_search_sys_t*	btr_search_sys;
 
+/** Maximum value of btr_search_n_parts */
+#define BTR_SEARCH_MAX_PARTS	64
+
 #ifdef UNIV_SEARCH_PERF_STAT
 /** Number of successful adaptive hash index lookups */
 extern ulint	btr_search_n_succ;
@@ -31,6 +31,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "rem0types.h"
 #include "page0types.h"
 #include "sync0rw.h"
+#include "hash0hash.h"
 
 /** Persistent cursor */
 typedef struct btr_pcur_struct		btr_pcur_t;
@@ -41,28 +42,60 @@ typedef struct btr_search_struct	btr_search_t;
 
 #ifndef UNIV_HOTBACKUP
 
-/** @brief The latch protecting the adaptive search system
+/** @brief The latches protecting the adaptive search system
 
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
+The adaptive hash index is split into btr_search_n_parts partitions,
+each with a hash table and a latch of its own. The partition of an index
+is determined by its index id. The latch of a partition protects the
+(1) hash table of the partition;
+(2) columns of a record to which we have a pointer in the hash table;
+(3) block->index and the block->curr_* fields of the pages of the
+indexes that belong to the partition;
 
 but does NOT protect:
 
-(3) next record offset field in a record;
-(4) next or previous records on the same page.
+(4) next record offset field in a record;
+(5) next or previous records on the same page.
 
-Bear in mind (3) and (4) when using the hash index.
+Bear in mind (4) and (5) when using the hash index.
 */
-extern rw_lock_t*	btr_search_latch_temp;
+extern rw_lock_t*	btr_search_latches;
 
-#endif /* UNIV_HOTBACKUP */
+/** Number of adaptive hash index partitions */
+extern ulint		btr_search_n_parts;
+
+/** Gets the latch of the adaptive hash index partition of an index id.
+@param id	index id
+@return		rw_lock_t* */
+#define btr_search_get_latch_for_id(id)				\
+	(&btr_search_latches[(ulint) ((id) % btr_search_n_parts)])
 
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
+/** Gets the latch of the adaptive hash index partition of an index.
+@param index	the index
+@return		rw_lock_t* */
+#define btr_search_get_latch(index)				\
+	btr_search_get_latch_for_id((index)->id)
+
+# ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the current thread owns the latch of the adaptive hash index
+partition that a hash table belongs to.
+@return	TRUE if owns */
+UNIV_INTERN
+ibool
+btr_search_own_table_latch(
+/*=======================*/
+	const hash_table_t*	table,		/*!< in: hash table of a
+						partition */
+	ulint			lock_type);	/*!< in: RW_LOCK_SHARED or
+						RW_LOCK_EX */
+# endif /* UNIV_SYNC_DEBUG */
+
+#endif /* UNIV_HOTBACKUP */
 
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by all the btr_search_latches: it is only modified
+while holding every partition latch in exclusive mode. */
 extern char	btr_search_enabled;
 
 #ifdef UNIV_BLOB_DEBUG
@@ -70,6 +70,35 @@ buf_buddy_free(
 					up to UNIV_PAGE_SIZE */
 	__attribute__((nonnull));
 
+/**********************************************************************//**
+Merges the free blocks of the buddy allocator that reside in the frames
+that the ongoing shrink of the buffer pool is going to remove with their
+free buddies, so that the frames that hold no compressed pages are
+returned to the buffer pool.  The caller must hold buf_pool->mutex. */
+UNIV_INTERN
+void
+buf_buddy_condense_free(
+/*====================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+	__attribute__((nonnull));
+
+/**********************************************************************//**
+Relocates the compressed pages that are allocated from the frame of a
+block that is being withdrawn from the buffer pool to other frames, so
+that the frame is returned to the buffer pool.  Does nothing if the
+block does not belong to the buddy allocator.  The caller must hold
+buf_pool->mutex, which is not released.
+@return	TRUE if a compressed page could not be relocated for the lack
+of a free block */
+UNIV_INTERN
+ibool
+buf_buddy_withdraw_block(
+/*=====================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	buf_block_t*	block)		/*!< in: block in state
+					BUF_BLOCK_MEMORY */
+	__attribute__((nonnull));
+
 #ifndef UNIV_NONINL
 # include "buf0buddy.ic"
 #endif
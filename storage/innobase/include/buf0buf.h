@@ -88,6 +88,10 @@ extern ulint srv_buf_pool_write_requests; /*!< variable to count write request
 					  issued */
 extern ulint srv_buf_pool_instances;
 extern ulint srv_buf_pool_curr_size;
+extern volatile ulint buf_withdraw_clock;/*!< incremented every time
+					the buffer pool is shrunk, so that
+					pointers to blocks remembered before
+					that can be recognized as stale */
 #else /* !UNIV_HOTBACKUP */
 extern buf_block_t*	back_block1;	/*!< first block, for --apply-log */
 extern buf_block_t*	back_block2;	/*!< second block, for page reorganize */
@@ -248,6 +252,76 @@ void
 buf_pool_clear_hash_index(void);
 /*===========================*/
 
+/********************************************************************//**
+Rounds a buffer pool size up to a multiple of the chunk size times the
+number of buffer pool instances, the granularity in which the buffer
+pool is allocated and resized.
+@return	aligned size in bytes */
+UNIV_INTERN
+ulint
+buf_pool_size_align(
+/*================*/
+	ulint	size);	/*!< in: size in bytes */
+/********************************************************************//**
+Determines if a block belongs to a chunk that the ongoing shrink of the
+buffer pool is going to remove.
+@return	TRUE if the block will be withdrawn */
+UNIV_INTERN
+ibool
+buf_block_will_be_withdrawn(
+/*========================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block);		/*!< in: block in buf_pool */
+/********************************************************************//**
+Determines if a frame belongs to a chunk that the ongoing shrink of the
+buffer pool is going to remove.
+@return	TRUE if the frame will be withdrawn */
+UNIV_INTERN
+ibool
+buf_frame_will_be_withdrawn(
+/*========================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*	ptr);		/*!< in: pointer into a frame */
+/********************************************************************//**
+Determines if blocks are being withdrawn from a buffer pool instance,
+that is, if the instance is being shrunk and the withdraw list is not
+yet complete.
+@return	TRUE if withdrawing */
+UNIV_INLINE
+ibool
+buf_pool_withdrawing(
+/*=================*/
+	const buf_pool_t*	buf_pool);	/*!< in: buffer pool instance */
+/********************************************************************//**
+Determines if the buffer pool has been shrunk since a block pointer was
+remembered, in which case the pointer may point to freed memory.
+@return	TRUE if the pointer must not be dereferenced */
+UNIV_INLINE
+ibool
+buf_pool_is_obsolete(
+/*=================*/
+	ulint	withdraw_clock);	/*!< in: buf_withdraw_clock when the
+					pointer was remembered */
+/********************************************************************//**
+Copies the current buffer pool resize status message into the given
+buffer, which must be at least BUF_RESIZE_STATUS_LEN bytes. */
+UNIV_INTERN
+void
+buf_resize_status_get(
+/*==================*/
+	char*	status);	/*!< out: resize status message */
+/********************************************************************//**
+This is the thread that resizes the buffer pool. It waits for an event
+and, when woken up, resizes the buffer pool instances to
+srv_buf_pool_size and sleeps again.
+@return this function does not return, it calls os_thread_exit() */
+UNIV_INTERN
+os_thread_ret_t
+buf_resize_thread(
+/*==============*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
 /********************************************************************//**
 Relocate a buffer control block.  Relocates the block on the LRU list
 and in buf_pool->page_hash.  Does not relocate bpage->list.
@@ -258,7 +332,9 @@ buf_relocate(
 /*=========*/
 	buf_page_t*	bpage,	/*!< in/out: control block being relocated;
 				buf_page_get_state(bpage) must be
-				BUF_BLOCK_ZIP_DIRTY or BUF_BLOCK_ZIP_PAGE */
+				BUF_BLOCK_ZIP_DIRTY or BUF_BLOCK_ZIP_PAGE,
+				or BUF_BLOCK_FILE_PAGE when the block is
+				being withdrawn by a buffer pool resize */
 	buf_page_t*	dpage)	/*!< in/out: destination control block */
 	__attribute__((nonnull));
 /*********************************************************************//**
@@ -658,6 +734,24 @@ buf_calc_page_old_checksum(
 /*=======================*/
 	const byte*	 page);	/*!< in: buffer page */
 /********************************************************************//**
+Calculates a page CRC32 which is stored to the page when it is written
+to a file. Note that we must be careful to calculate the same value on
+32-bit and 64-bit architectures.
+@return	checksum */
+UNIV_INTERN
+ib_uint32_t
+buf_calc_page_crc32(
+/*================*/
+	const byte*	page);	/*!< in: buffer page */
+/********************************************************************//**
+Return a printable string describing the checksum algorithm.
+@return	algorithm name */
+UNIV_INTERN
+const char*
+buf_checksum_algorithm_name(
+/*========================*/
+	srv_checksum_algorithm_t	algo);	/*!< in: algorithm */
+/********************************************************************//**
 Checks if a page is corrupt.
 @return	TRUE if corrupted */
 UNIV_INTERN
@@ -1618,7 +1712,8 @@ struct buf_block_struct{
 
 	/** @name Hash search fields
 	These 5 fields may only be modified when we have
-	an x-latch on btr_search_latch AND
+	an x-latch on the adaptive hash index latch of the index
+	of the page (btr_search_get_latch()) AND
 	- we are holding an s-latch or x-latch on buf_block_struct::lock or
 	- we know that buf_block_struct::buf_fix_count == 0.
 
@@ -1626,7 +1721,8 @@ struct buf_block_struct{
 	in the buffer pool in buf0buf.c.
 
 	Another exception is that assigning block->index = NULL
-	is allowed whenever holding an x-latch on btr_search_latch. */
+	is allowed whenever holding an x-latch on the adaptive hash
+	index latch of the index of the page. */
 
 	/* @{ */
 
@@ -1746,7 +1842,15 @@ struct buf_pool_struct{
 	ulint		mutex_exit_forbidden; /*!< Forbid release mutex */
 #endif
 	ulint		n_chunks;	/*!< number of buffer pool chunks */
+	ulint		n_chunks_new;	/*!< number of buffer pool chunks
+					after the ongoing resize; equals
+					n_chunks when no resize is running */
 	buf_chunk_t*	chunks;		/*!< buffer pool chunks */
+	buf_chunk_t*	chunks_old;	/*!< the chunk array replaced by the
+					last resize, kept until the next one
+					because lock-free readers such as
+					buf_pointer_is_block_field() may
+					still be scanning it; or NULL */
 	ulint		curr_size;	/*!< current pool size in pages */
 	hash_table_t*	page_hash;	/*!< hash table of buf_page_t or
 					buf_block_t file pages,
@@ -1851,6 +1955,15 @@ struct buf_pool_struct{
 					/*!< base node of the
 					unzip_LRU list */
 
+	UT_LIST_BASE_NODE_T(buf_page_t) withdraw;
+					/*!< base node of the list of free
+					blocks in the chunks that the ongoing
+					resize is going to remove */
+	ulint		withdraw_target;/*!< number of blocks that must be
+					in the withdraw list before the
+					chunks can be removed; 0 unless
+					the pool is being shrunk */
+
 	/* @} */
 	/** @name Buddy allocator fields
 	The buddy allocator is used for allocating compressed page
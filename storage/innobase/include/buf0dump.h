@@ -0,0 +1,89 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/buf0dump.h
+Implements a buffer pool dump/load.
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#ifndef buf0dump_h
+#define buf0dump_h
+
+#include "univ.i"
+
+/** Default name of the buffer pool dump file, relative to the
+InnoDB data home directory. */
+#define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
+
+/** Maximum length of the dump and load status messages. */
+#define BUF_DUMP_STATUS_LEN		512
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a dump. This function is called by MySQL code via buffer_pool_dump_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_dump_start(void);
+/*================*/
+
+/*****************************************************************//**
+Wakes up the buffer pool dump/load thread and instructs it to start
+a load. This function is called by MySQL code via buffer_pool_load_now()
+and it should return immediately because the whole MySQL is frozen during
+its execution. */
+UNIV_INTERN
+void
+buf_load_start(void);
+/*================*/
+
+/*****************************************************************//**
+Aborts a currently running buffer pool load. This function is called by
+MySQL code via buffer_pool_load_abort() and it should return immediately
+because the whole MySQL is frozen during its execution. */
+UNIV_INTERN
+void
+buf_load_abort(void);
+/*================*/
+
+/*****************************************************************//**
+Copies the current dump and load status messages into the given
+buffers, each of which must be at least BUF_DUMP_STATUS_LEN bytes. */
+UNIV_INTERN
+void
+buf_dump_status_get(
+/*================*/
+	char*	dump_status,	/*!< out: dump status message */
+	char*	load_status);	/*!< out: load status message */
+
+/*****************************************************************//**
+This is the main thread for buffer pool dump/load. It waits for an
+event and when waked up either performs a dump or load and sleeps
+again. At shutdown it dumps the buffer pool if requested.
+@return this function does not return, it calls os_thread_exit() */
+UNIV_INTERN
+os_thread_ret_t
+buf_dump_thread(
+/*============*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
+#endif /* buf0dump_h */
@@ -32,6 +32,7 @@ Created 11/5/1995 Heikki Tuuri
 #include "mtr0types.h"
 #include "buf0types.h"
 #include "log0log.h"
+#include "os0thread.h"
 
 /********************************************************************//**
 Remove a block from the flush list of modified blocks. */
@@ -221,6 +222,42 @@ ulint
 buf_flush_get_desired_flush_rate(void);
 /*==================================*/
 
+/** Event to wake up the page cleaner coordinator, at shutdown */
+extern os_event_t	buf_flush_event;
+
+/******************************************************************//**
+Initializes the page cleaner. Must be called before the page cleaner
+threads are created, and only if srv_n_page_cleaners > 0. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void);
+/*=============================*/
+
+/******************************************************************//**
+Page cleaner coordinator thread. Once per second it computes how many
+pages to flush and has the coordinator and the worker threads flush the
+LRU tail and the flush list of every buffer pool instance in parallel.
+It exits at shutdown, after the worker threads; the final flush at
+shutdown is done by the master thread.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+buf_flush_page_cleaner_coordinator(
+/*===============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
+/******************************************************************//**
+Page cleaner worker thread. Flushes the buffer pool instances requested
+by the coordinator, until the coordinator tells it to exit.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+buf_flush_page_cleaner_worker(
+/*==========================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /******************************************************************//**
 Validates the flush list.
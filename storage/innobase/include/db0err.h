@@ -115,6 +115,9 @@ enum db_err {
 	DB_TABLE_IN_FK_CHECK,		/* table is being used in foreign
 					key check */
 	DB_IDENTIFIER_TOO_LONG,		/* Identifier name too long */
+	DB_ONLINE_LOG_TOO_BIG,		/* the modification log of an index
+					that is being created online grew
+					beyond innodb_online_alter_log_max_size */
 
 	/* The following are partial failure codes */
 	DB_FAIL = 1000,
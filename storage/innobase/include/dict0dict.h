@@ -78,6 +78,15 @@ dict_table_get_on_id(
         table_id_t	table_id,	/*!< in: table id */
         trx_t*		trx);		/*!< in: transaction handle */
 /********************************************************************//**
+Increments the count of open MySQL handles to a table, which keeps the
+table from being evicted from the dictionary cache. The caller must hold
+dict_sys->mutex. */
+UNIV_INTERN
+void
+dict_table_increment_handle_count(
+/*==============================*/
+	dict_table_t*	table);		/*!< in/out: table */
+/********************************************************************//**
 Decrements the count of open MySQL handles to a table. */
 UNIV_INTERN
 void
@@ -290,6 +299,21 @@ dict_table_remove_from_cache(
 /*=========================*/
 	dict_table_t*	table);	/*!< in, own: table */
 /**********************************************************************//**
+Evicts unused tables from the tail of the LRU list of the dictionary cache
+until the cache is no bigger than max_size bytes. A table is unused if it
+has no open MySQL handles, no locks, no foreign key constraints and no
+adaptive hash index entries. The caller must hold dict_operation_lock in
+X-mode and dict_sys->mutex.
+@return	number of tables evicted */
+UNIV_INTERN
+ulint
+dict_make_room_in_cache(
+/*====================*/
+	ulint	max_size,	/*!< in: target size of the cache
+				in bytes */
+	ulint	pct_check);	/*!< in: how much of the LRU list to
+				scan, in percent */
+/**********************************************************************//**
 Renames a table object.
 @return	TRUE if success */
 UNIV_INTERN
@@ -1125,7 +1149,23 @@ dict_index_calc_min_rec_len(
 /*========================*/
 	const dict_index_t*	index);	/*!< in: index */
 /*********************************************************************//**
-Calculates new estimates for table and index statistics. The statistics
+Calculates new estimates for table and index statistics, sampling the
+given number of leaf pages of each index. The statistics are used in
+query optimization. */
+UNIV_INTERN
+void
+dict_update_statistics_low(
+/*=======================*/
+	dict_table_t*	table,		/*!< in/out: table */
+	ibool		only_calc_if_missing_stats,/*!< in: only
+					update/recalc the stats if they have
+					not been initialized yet, otherwise
+					do nothing */
+	ullint		n_sample_pages);/*!< in: number of leaf pages
+					to sample per index */
+/*********************************************************************//**
+Calculates new estimates for table and index statistics, sampling
+innodb_stats_sample_pages leaf pages of each index. The statistics
 are used in query optimization. */
 UNIV_INTERN
 void
@@ -1206,6 +1246,45 @@ dict_table_get_index_on_name_and_min_id(
 /*====================================*/
 	dict_table_t*	table,	/*!< in: table */
 	const char*	name);	/*!< in: name of the index to find */
+/**********************************************************************//**
+Records a successful compression of a leaf page of an index. */
+UNIV_INTERN
+void
+dict_index_zip_success(
+/*===================*/
+	dict_index_t*	index)	/*!< in/out: index */
+	__attribute__((nonnull));
+/**********************************************************************//**
+Records a failed compression of a leaf page of an index. */
+UNIV_INTERN
+void
+dict_index_zip_failure(
+/*===================*/
+	dict_index_t*	index)	/*!< in/out: index */
+	__attribute__((nonnull));
+/**********************************************************************//**
+Returns the amount of data that should be stored on an uncompressed leaf
+page of an index, so that the page is likely to compress.
+@return	number of bytes, at most UNIV_PAGE_SIZE */
+UNIV_INTERN
+ulint
+dict_index_zip_pad_optimal_page_size(
+/*=================================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((nonnull, warn_unused_result));
+
+/** Default of innodb_compression_failure_threshold_pct */
+#define DICT_ZIP_FAILURE_THRESHOLD_PCT_DEFAULT	5
+/** Default of innodb_compression_pad_pct_max */
+#define DICT_ZIP_PAD_MAX_DEFAULT		50
+
+/** Highest acceptable percentage of failed compressions of an index
+before padding is added; 0 disables padding */
+extern ulong	dict_zip_failure_threshold_pct;
+/** Highest percentage of an uncompressed page that may be left empty
+as padding */
+extern ulong	dict_zip_pad_max;
+
 /* Buffers for storing detailed information about the latest foreign key
 and unique key errors */
 extern FILE*	dict_foreign_err_file;
@@ -1233,6 +1312,12 @@ struct dict_sys_struct{
 					the log records */
 	hash_table_t*	table_hash;	/*!< hash table of the tables, based
 					on name */
+	rw_lock_t	table_hash_latch;/*!< latch protecting table_hash
+					against the table opens that look
+					for a cached table without the
+					mutex; table_hash is modified
+					holding both the mutex and this
+					latch in X-mode */
 	hash_table_t*	table_id_hash;	/*!< hash table of the tables, based
 					on id */
 	UT_LIST_BASE_NODE_T(dict_table_t)
@@ -1286,6 +1371,19 @@ dict_index_is_corrupted(
 	const dict_index_t*	index)	/*!< in: index */
 	__attribute__((nonnull, pure, warn_unused_result));
 
+/**********************************************************************//**
+Determines if a secondary index is being created online, so that
+modifications to the table must be written to index->online_log.
+The caller must hold index->lock in S or X mode, unless the result is
+only used as a hint.
+@return	TRUE if the index is being created online */
+UNIV_INLINE
+ibool
+dict_index_is_online_ddl(
+/*=====================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((nonnull, pure, warn_unused_result));
+
 #endif /* !UNIV_HOTBACKUP */
 /**********************************************************************//**
 Flags an index and table corrupted both in the data dictionary cache
@@ -43,6 +43,7 @@ Created 1/8/1996 Heikki Tuuri
 #include "ut0byte.h"
 #include "hash0hash.h"
 #include "trx0types.h"
+#include "row0types.h"
 
 /** Type flags of an index: OR'ing of the flags is allowed to define a
 combination of types */
@@ -361,6 +362,38 @@ struct dict_field_struct{
 					DICT_ANTELOPE_MAX_INDEX_COL_LEN */
 };
 
+/** The status of online index creation */
+enum online_index_status {
+	/** the index is complete and ready for access */
+	ONLINE_INDEX_COMPLETE = 0,
+	/** the index is being created, online
+	(allowing concurrent modifications) */
+	ONLINE_INDEX_CREATION,
+	/** online index creation was aborted; modifications are
+	no longer logged and the index will be dropped */
+	ONLINE_INDEX_ABORTED
+};
+
+#ifndef UNIV_HOTBACKUP
+/** Compression failures of an index in the current round, from which
+the padding that is left empty on its uncompressed pages is derived.
+@see dict_index_zip_pad_optimal_page_size() */
+typedef struct zip_pad_info_struct {
+	mutex_t		mutex;	/*!< mutex protecting the info */
+	ulint		pad;	/*!< number of bytes to leave empty on
+				uncompressed leaf pages */
+	ulint		success;/*!< successful compressions in the
+				current round */
+	ulint		failure;/*!< failed compressions in the current
+				round */
+	ulint		n_rounds;/*!< number of consecutive rounds
+				whose failure rate was acceptable */
+	ibool		enabled;/*!< TRUE if mutex has been created,
+				that is, if the index is in the cache
+				and belongs to a compressed table */
+} zip_pad_info_t;
+#endif /* !UNIV_HOTBACKUP */
+
 /** Data structure for an index.  Most fields will be
 initialized to 0, NULL or FALSE in dict_mem_index_create(). */
 struct dict_index_struct{
@@ -437,6 +470,15 @@ struct dict_index_struct{
 	trx_id_t	trx_id; /*!< id of the transaction that created this
 				index, or 0 if the index existed
 				when InnoDB was started up */
+	ulint		online_status;
+				/*!< enum online_index_status;
+				protected by lock */
+	row_log_t*	online_log;
+				/*!< log of the modifications made to the
+				table while this index is being created
+				online, or NULL; protected by lock */
+	zip_pad_info_t	zip_pad;/*!< compression failure rate and
+				padding of a ROW_FORMAT=COMPRESSED index */
 #endif /* !UNIV_HOTBACKUP */
 #ifdef UNIV_BLOB_DEBUG
 	mutex_t		blobs_mutex;
@@ -565,7 +607,12 @@ struct dict_table_struct{
 				to this table; dropping of the table is
 				NOT allowed until this count gets to zero;
 				MySQL does NOT itself check the number of
-				open handles at drop */
+				open handles at drop; nor is the table
+				evicted from the dictionary cache while
+				the count is nonzero. Modified under
+				dict_sys->mutex, or atomically under
+				dict_sys->table_hash_latch in S-mode
+				by dict_table_open_if_cached() */
 	unsigned	fk_max_recusive_level:8;
 				/*!< maximum recursive level we support when
 				loading tables chained together with FK
@@ -588,6 +635,12 @@ struct dict_table_struct{
 				the tables it had an IX lock on */
 	UT_LIST_BASE_NODE_T(lock_t)
 			locks; /*!< list of locks on the table */
+	ulint		n_rec_locks;
+				/*!< number of record lock objects on
+				the indexes of the table; protected by
+				lock_sys->mutex. The table cannot be
+				evicted from the dictionary cache while
+				there are any */
 #ifdef UNIV_DEBUG
 	/*----------------------*/
 	ibool		does_not_fit_in_memory;
@@ -0,0 +1,142 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/dict0stats.h
+Persistent table and index statistics
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#ifndef dict0stats_h
+#define dict0stats_h
+
+#include "univ.i"
+#include "dict0types.h"
+#include "trx0types.h"
+#include "os0sync.h"
+#include "os0thread.h"
+
+/** How dict_stats_update() updates the statistics of a table */
+enum dict_stats_upd_option {
+	DICT_STATS_RECALC_PERSISTENT,	/*!< recalculate the statistics,
+					sampling
+					innodb_stats_persistent_sample_pages
+					pages, and store them in
+					SYS_TABLE_STATS and SYS_INDEX_STATS */
+	DICT_STATS_FETCH		/*!< if the statistics have not been
+					initialized, load them from
+					SYS_TABLE_STATS and SYS_INDEX_STATS;
+					if they are not stored there,
+					calculate them and have the
+					background thread store them */
+};
+
+/** Event to wake up the statistics thread, at shutdown */
+extern os_event_t	dict_stats_event;
+
+/*********************************************************************//**
+Creates the persistent statistics tables SYS_TABLE_STATS and
+SYS_INDEX_STATS if they do not exist yet. Called once at startup.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+dict_stats_create_tables(void);
+/*==========================*/
+
+/*********************************************************************//**
+Updates the statistics of a table from or to the persistent statistics
+tables. Must not be called while holding the data dictionary latch or
+mutex. */
+UNIV_INTERN
+void
+dict_stats_update(
+/*==============*/
+	dict_table_t*			table,	/*!< in/out: table */
+	enum dict_stats_upd_option	option);/*!< in: how to update */
+
+/*********************************************************************//**
+Deletes the persistent statistics of a table that is being dropped.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+dict_stats_drop_table(
+/*==================*/
+	const char*	table_name,	/*!< in: table name */
+	trx_t*		trx);		/*!< in: transaction holding the
+					data dictionary latch in X mode */
+
+/*********************************************************************//**
+Moves the persistent statistics of a table that is being renamed.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+dict_stats_rename_table(
+/*====================*/
+	const char*	old_name,	/*!< in: old table name */
+	const char*	new_name,	/*!< in: new table name */
+	trx_t*		trx);		/*!< in: transaction holding the
+					data dictionary latch in X mode */
+
+/*********************************************************************//**
+Asks the statistics thread to recalculate and store the persistent
+statistics of a table. Does nothing if the table is already waiting. */
+UNIV_INTERN
+void
+dict_stats_recalc_pool_add(
+/*=======================*/
+	const dict_table_t*	table);	/*!< in: table */
+
+/*********************************************************************//**
+Removes a table from the tables waiting for the statistics thread, for
+example because it is being dropped. */
+UNIV_INTERN
+void
+dict_stats_recalc_pool_del(
+/*=======================*/
+	const dict_table_t*	table);	/*!< in: table */
+
+/*********************************************************************//**
+Initializes the tables waiting for the statistics thread. Called by
+dict_init(), before any table can be modified or dropped. */
+UNIV_INTERN
+void
+dict_stats_init(void);
+/*=================*/
+
+/*********************************************************************//**
+Frees the resources allocated by dict_stats_init(). Called by
+dict_close(), after the statistics thread has exited. */
+UNIV_INTERN
+void
+dict_stats_close(void);
+/*==================*/
+
+/*********************************************************************//**
+Statistics thread. Every DICT_STATS_RECALC_INTERVAL seconds it
+recalculates and stores the persistent statistics of the tables that
+were added by dict_stats_recalc_pool_add().
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+dict_stats_thread(
+/*==============*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
+#endif /* dict0stats_h */
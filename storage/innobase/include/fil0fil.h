@@ -382,6 +382,26 @@ void
 fil_decr_pending_ops(
 /*=================*/
 	ulint	id);	/*!< in: space id */
+/*******************************************************************//**
+Asks fsp_preextend_thread() to extend a single-table tablespace that is
+about to fill up. Does nothing if the tablespace is already waiting or
+is being deleted. */
+UNIV_INTERN
+void
+fil_space_preextend_add(
+/*====================*/
+	ulint	id);	/*!< in: space id */
+/*******************************************************************//**
+Removes the first tablespace from the tablespaces waiting to be extended
+in the background. Unless the tablespace is being deleted, increments
+its count of pending operations, which the caller must decrement with
+fil_decr_pending_ops().
+@return	TRUE if a tablespace was found, FALSE if none is waiting */
+UNIV_INTERN
+ibool
+fil_space_preextend_get(
+/*====================*/
+	ulint*	id);	/*!< out: space id */
 #endif /* !UNIV_HOTBACKUP */
 /*******************************************************************//**
 Parses the body of a log record written about an .ibd file operation. That is,
@@ -596,7 +616,9 @@ fil_extend_tablespaces_to_stored_len(void);
 /**********************************************************************//**
 Tries to extend a data file so that it would accommodate the number of pages
 given. The tablespace must be cached in the memory cache. If the space is big
-enough already, does nothing.
+enough already, does nothing. The file is extended without holding
+fil_system->mutex, with posix_fallocate() if innodb_use_fallocate is set and
+the file system supports it, or else by writing zeros.
 @return	TRUE if success */
 UNIV_INTERN
 ibool
@@ -609,6 +631,17 @@ fil_extend_space_to_desired_size(
 	ulint	size_after_extend);/*!< in: desired size in pages after the
 				extension; if the current space size is bigger
 				than this already, the function does nothing */
+/**********************************************************************//**
+Truncates a single-file tablespace to the given number of pages. The caller
+must make sure that no pages of the tablespace are in the buffer pool and
+that nobody accesses the tablespace meanwhile.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+fil_truncate_tablespace(
+/*====================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint	size);		/*!< in: size in pages after the truncation */
 /*******************************************************************//**
 Tries to reserve free extents in a file space.
 @return	TRUE if succeed */
@@ -33,6 +33,8 @@ Created 12/18/1995 Heikki Tuuri
 #include "ut0byte.h"
 #include "page0types.h"
 #include "fsp0types.h"
+#include "os0sync.h"
+#include "os0thread.h"
 
 /* @defgroup fsp_flags InnoDB Tablespace Flag Constants @{ */
 
@@ -124,6 +126,32 @@ UNIV_INTERN
 void
 fsp_init(void);
 /*==========*/
+#ifndef UNIV_HOTBACKUP
+/** Event to wake up fsp_preextend_thread() */
+extern os_event_t	fsp_preextend_event;
+/** Number of times fsp_preextend_thread() extended a tablespace */
+extern ulint		fsp_n_preextends;
+
+/**********************************************************************//**
+Frees the resources allocated by fsp_init(). Called at shutdown, after
+fsp_preextend_thread() has exited. */
+UNIV_INTERN
+void
+fsp_close(void);
+/*===========*/
+/*********************************************************************//**
+Tablespace pre-extension thread. Extends the single-table tablespaces
+that were added by fil_space_preextend_add() when they were about to
+fill up, so that the user threads that insert into them do not have to
+wait for the file to grow.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+fsp_preextend_thread(
+/*=================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+#endif /* !UNIV_HOTBACKUP */
 /**********************************************************************//**
 Gets the current free limit of the system tablespace.  The free limit
 means the place of the first page which has never been put to the
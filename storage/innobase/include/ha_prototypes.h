@@ -29,6 +29,7 @@ Created 5/11/2006 Osku Salerma
 
 #include "trx0types.h"
 #include "m_ctype.h" /* CHARSET_INFO */
+#include "my_icp.h" /* ICP_RESULT */
 
 /*********************************************************************//**
 Wrapper around MySQL's copy_and_convert function.
@@ -191,6 +192,16 @@ thd_is_select(
 /*==========*/
 	const void*	thd);	/*!< in: thread handle (THD*) */
 
+/******************************************************************//**
+Returns true if the thread is executing a SELECT statement in autocommit
+mode, outside of an explicitly started transaction.
+@return	true if thd is executing an autocommit SELECT */
+
+ibool
+thd_trx_is_read_only(
+/*=================*/
+	void*	thd);	/*!< in: thread handle (THD*) */
+
 /******************************************************************//**
 Converts an identifier to a table name. */
 UNIV_INTERN
@@ -317,4 +328,16 @@ innobase_check_identifier_length(
 	const char*	id);	/* in: identifier to check.  it must belong
 				to charset my_charset_filename */
 
+/******************************************************************//**
+Evaluates the index condition that was pushed down to a table handle,
+on the columns that row_search_for_mysql() copied to the MySQL record
+buffer from a secondary index record.
+@return	ICP_NO_MATCH, ICP_MATCH, or ICP_OUT_OF_RANGE */
+UNIV_INTERN
+ICP_RESULT
+innobase_index_cond(
+/*================*/
+	void*	file)	/*!< in/out: the ha_innobase handle */
+	__attribute__((nonnull, warn_unused_result));
+
 #endif
@@ -112,6 +112,13 @@ UNIV_INTERN
 void
 ibuf_init_at_db_start(void);
 /*=======================*/
+/******************************************************************//**
+Updates the maximum size of the insert buffer after the buffer pool
+has been resized. */
+UNIV_INTERN
+void
+ibuf_max_size_update(void);
+/*======================*/
 /*********************************************************************//**
 Reads the biggest tablespace id from the high end of the insert buffer
 tree and updates the counter in fil_system. */
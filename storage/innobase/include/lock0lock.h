@@ -37,6 +37,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "read0types.h"
 #include "hash0hash.h"
 #include "ut0vec.h"
+#include "sync0sync.h"
 
 #ifdef UNIV_DEBUG
 extern ibool	lock_print_waits;
@@ -501,6 +502,14 @@ lock_cancel_waiting_and_release(
 	lock_t*	lock);	/*!< in: waiting lock request */
 
 /*********************************************************************//**
+Checks if there are any table or record locks on a table.
+@return	TRUE if the table has locks */
+UNIV_INTERN
+ibool
+lock_table_has_locks(
+/*=================*/
+	const dict_table_t*	table);	/*!< in: table */
+/*********************************************************************//**
 Removes locks on a table to be dropped or truncated.
 If remove_also_table_sx_locks is TRUE then table-level S and X locks are
 also removed in addition to other table-level and record-level locks.
@@ -596,9 +605,7 @@ lock_check_trx_id_sanity(
 	trx_id_t	trx_id,		/*!< in: trx id */
 	const rec_t*	rec,		/*!< in: user record */
 	dict_index_t*	index,		/*!< in: clustered index */
-	const ulint*	offsets,	/*!< in: rec_get_offsets(rec, index) */
-	ibool		has_kernel_mutex);/*!< in: TRUE if the caller owns the
-					kernel mutex */
+	const ulint*	offsets);	/*!< in: rec_get_offsets(rec, index) */
 /*********************************************************************//**
 Prints info of a table lock. */
 UNIV_INTERN
@@ -617,14 +624,14 @@ lock_rec_print(
 	const lock_t*	lock);	/*!< in: record type lock */
 /*********************************************************************//**
 Prints info of locks for all transactions.
-@return FALSE if not able to obtain kernel mutex
+@return FALSE if not able to obtain lock mutex
 and exits without printing info */
 UNIV_INTERN
 ibool
 lock_print_info_summary(
 /*====================*/
 	FILE*	file,	/*!< in: file where to print */
-	ibool   nowait);/*!< in: whether to wait for the kernel mutex */
+	ibool   nowait);/*!< in: whether to wait for the lock mutex */
 /*************************************************************************
 Prints info of locks for each transaction. */
 UNIV_INTERN
@@ -823,12 +830,48 @@ struct lock_op_struct{
 
 /** The lock system struct */
 struct lock_sys_struct{
+	mutex_t		mutex;		/*!< mutex protecting the record
+					lock hash table, the table lock
+					queues, the lock lists of the
+					transactions and their lock wait
+					state (trx->wait_lock,
+					trx->que_state == TRX_QUE_LOCK_WAIT) */
 	hash_table_t*	rec_hash;	/*!< hash table of the record locks */
+	mutex_t		wait_mutex;	/*!< mutex protecting the table of
+					threads suspended in a lock wait,
+					srv_mysql_table, and the lock wait
+					counters */
 };
 
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
+/** Test if lock_sys->mutex is owned. */
+#define lock_mutex_own() mutex_own(&lock_sys->mutex)
+
+/** Acquire the lock_sys->mutex. */
+#define lock_mutex_enter() do {			\
+	mutex_enter(&lock_sys->mutex);		\
+} while (0)
+
+/** Release the lock_sys->mutex. */
+#define lock_mutex_exit() do {			\
+	mutex_exit(&lock_sys->mutex);		\
+} while (0)
+
+/** Test if lock_sys->wait_mutex is owned. */
+#define lock_wait_mutex_own() mutex_own(&lock_sys->wait_mutex)
+
+/** Acquire the lock_sys->wait_mutex. */
+#define lock_wait_mutex_enter() do {		\
+	mutex_enter(&lock_sys->wait_mutex);	\
+} while (0)
+
+/** Release the lock_sys->wait_mutex. */
+#define lock_wait_mutex_exit() do {		\
+	mutex_exit(&lock_sys->wait_mutex);	\
+} while (0)
+
 
 #ifndef UNIV_NONINL
 #include "lock0lock.ic"
@@ -66,6 +66,9 @@ extern	ibool	log_debug_writes;
 /* @} */
 /** Maximum number of log groups in log_group_struct::checkpoint_buf */
 #define LOG_MAX_N_GROUPS	32
+/** Number of events in each of log_struct::close_events,
+log_struct::write_events and log_struct::flush_events */
+#define LOG_N_EVENTS		64
 
 #ifndef UNIV_HOTBACKUP
 /****************************************************************//**
@@ -96,23 +99,6 @@ log_calc_where_lsn_is(
 	ib_int64_t	log_file_size);		/*!< in: log file size
 						(including the header) */
 #ifndef UNIV_HOTBACKUP
-/************************************************************//**
-Writes to the log the string given. The log must be released with
-log_release.
-@return	end lsn of the log record, zero if did not succeed */
-UNIV_INLINE
-ib_uint64_t
-log_reserve_and_write_fast(
-/*=======================*/
-	const void*	str,	/*!< in: string */
-	ulint		len,	/*!< in: string length */
-	ib_uint64_t*	start_lsn);/*!< out: start lsn of the log record */
-/***********************************************************************//**
-Releases the log mutex. */
-UNIV_INLINE
-void
-log_release(void);
-/*=============*/
 /***********************************************************************//**
 Checks if there is need for a log buffer flush or a new checkpoint, and does
 this if yes. Any database operation should call this when it has modified
@@ -123,30 +109,82 @@ void
 log_free_check(void);
 /*================*/
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release.
-@return	start lsn of the log record */
+Converts a count of log record bytes to a log sequence number, by adding
+the log block headers and trailers in between.
+@return	lsn */
+UNIV_INLINE
+ib_uint64_t
+log_translate_sn_to_lsn(
+/*====================*/
+	ib_uint64_t	sn);	/*!< in: count of log record bytes */
+/************************************************************//**
+Converts a log sequence number to a count of log record bytes.
+@return	count of log record bytes */
+UNIV_INLINE
+ib_uint64_t
+log_translate_lsn_to_sn(
+/*====================*/
+	ib_uint64_t	lsn);	/*!< in: lsn, within the data area of its
+				log block */
+/************************************************************//**
+Reads an lsn field of log_sys that is advanced with log_lsn_advance().
+@return	value of the field */
+UNIV_INLINE
+ib_uint64_t
+log_lsn_read(
+/*=========*/
+	ib_uint64_t*	field);	/*!< in: field of log_sys */
+/************************************************************//**
+Advances an lsn field of log_sys, if it is smaller than the given value.
+@return	TRUE if the field was advanced */
+UNIV_INLINE
+ibool
+log_lsn_advance(
+/*============*/
+	ib_uint64_t*	field,	/*!< in/out: field of log_sys */
+	ib_uint64_t	lsn);	/*!< in: new value */
+/************************************************************//**
+Reserves space in the log buffer for a mini-transaction. This advances
+log_sys->sn without holding any mutex; the log records are then copied to
+the reserved space with log_write_low(), and the space is closed with
+log_wait_for_close() and log_close().
+@return	start lsn of the log records */
 UNIV_INTERN
 ib_uint64_t
 log_reserve_and_open(
 /*=================*/
-	ulint	len);	/*!< in: length of data to be catenated */
+	ulint		len,	/*!< in: length of data to be catenated */
+	ib_uint64_t*	end_lsn);/*!< out: end lsn of the log records */
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Copies log records to space reserved by log_reserve_and_open(). This does
+not need any mutex, because nobody else writes to the reserved space.
+@return	lsn after the copied string */
 UNIV_INTERN
-void
+ib_uint64_t
 log_write_low(
 /*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len);	/*!< in: string length */
+	ib_uint64_t	lsn,		/*!< in: lsn where to copy */
+	const byte*	str,		/*!< in: string */
+	ulint		str_len);	/*!< in: string length */
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Waits until all log records before start_lsn have been closed. On return
+the caller owns log_sys->log_flush_order_mutex, and must add the pages it
+modified to the flush lists and then call log_close(). */
 UNIV_INTERN
-ib_uint64_t
-log_close(void);
-/*===========*/
+void
+log_wait_for_close(
+/*===============*/
+	ib_uint64_t	start_lsn);	/*!< in: start lsn of the log records
+					of the caller */
+/************************************************************//**
+Closes the log records that end at end_lsn, which lets the log writer write
+them, and releases log_sys->log_flush_order_mutex. */
+UNIV_INTERN
+void
+log_close(
+/*======*/
+	ib_uint64_t	start_lsn,	/*!< in: start lsn of the log records */
+	ib_uint64_t	end_lsn);	/*!< in: end lsn of the log records */
 /************************************************************//**
 Gets the current lsn.
 @return	current lsn */
@@ -168,6 +206,17 @@ UNIV_INTERN
 void
 log_init(void);
 /*==========*/
+/******************************************************//**
+Positions the log buffer at an lsn, when the log system is initialized or
+the log has been recovered or reset. The caller must own log_sys->mutex. */
+UNIV_INTERN
+void
+log_buffer_reset(
+/*=============*/
+	ib_uint64_t	lsn,		/*!< in: new current lsn */
+	const byte*	last_block);	/*!< in: contents of the log block
+					that contains lsn, or NULL to
+					initialize an empty block */
 /******************************************************************//**
 Inits a log group to the log system. */
 UNIV_INTERN
@@ -225,6 +274,28 @@ void
 log_buffer_sync_in_background(
 /*==========================*/
 	ibool	flush);	/*<! in: flush the logs to disk */
+/******************************************************************//**
+Log writer thread. Writes the closed part of the log buffer to the log
+files when some thread waits for it in log_write_up_to(), and wakes up
+the waiting threads by the lsn that they wait for.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+log_writer_thread(
+/*==============*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+/******************************************************************//**
+Log flusher thread. Flushes the written log to disk when some thread waits
+for it in log_write_up_to(), and wakes up the waiting threads by the lsn
+that they wait for.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+log_flusher_thread(
+/*===============*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
 /****************************************************************//**
 Advances the smallest lsn for which there are unflushed dirty blocks in the
 buffer pool and also may make a new checkpoint. NOTE: this function may only
@@ -464,7 +535,8 @@ log_block_set_data_len(
 	byte*	log_block,	/*!< in/out: log block */
 	ulint	len);		/*!< in: data length */
 /************************************************************//**
-Calculates the checksum for a log block.
+Calculates the checksum for a log block according to the
+innodb_checksum_algorithm setting.
 @return	checksum */
 UNIV_INLINE
 ulint
@@ -472,6 +544,22 @@ log_block_calc_checksum(
 /*====================*/
 	const byte*	block);	/*!< in: log block */
 /************************************************************//**
+Calculates the legacy InnoDB checksum for a log block.
+@return	checksum */
+UNIV_INLINE
+ulint
+log_block_calc_checksum_innodb(
+/*===========================*/
+	const byte*	block);	/*!< in: log block */
+/************************************************************//**
+Calculates the CRC32 checksum for a log block.
+@return	checksum */
+UNIV_INLINE
+ulint
+log_block_calc_checksum_crc32(
+/*==========================*/
+	const byte*	block);	/*!< in: log block */
+/************************************************************//**
 Gets a log block checksum field value.
 @return	checksum */
 UNIV_INLINE
@@ -626,6 +714,10 @@ extern log_t*	log_sys;
 					.._HDR_NO */
 #define	LOG_BLOCK_TRL_SIZE	4	/* trailer size in bytes */
 
+/** Number of bytes of log records in a log block */
+#define LOG_BLOCK_DATA_SIZE	(OS_FILE_LOG_BLOCK_SIZE			\
+				 - LOG_BLOCK_HDR_SIZE - LOG_BLOCK_TRL_SIZE)
+
 /* Offsets for a checkpoint field */
 #define LOG_CHECKPOINT_NO		0
 #define LOG_CHECKPOINT_LSN		8
@@ -760,9 +852,15 @@ struct log_struct{
 	byte		pad[64];	/*!< padding to prevent other memory
 					update hotspots from residing on the
 					same memory cache line */
-	ib_uint64_t	lsn;		/*!< log sequence number */
-	ulint		buf_free;	/*!< first free offset within the log
-					buffer */
+	ib_uint64_t	sn;		/*!< number of bytes of log records
+					reserved so far, that is, the log
+					sequence number without the log block
+					headers and trailers; advanced with
+					an atomic add by
+					log_reserve_and_open(), see
+					log_translate_sn_to_lsn() */
+	byte		pad2[64];	/*!< padding to keep log_sys->sn
+					in its own cache line */
 #ifndef UNIV_HOTBACKUP
 	mutex_t		mutex;		/*!< mutex protecting the log */
 
@@ -773,20 +871,24 @@ struct log_struct{
 					to release log_sys->mutex during
 					mtr_commit and still ensure that
 					insertions in the flush_list happen
-					in the LSN order. */
+					in the LSN order. It also protects
+					closed_lsn */
+	ib_uint64_t	closed_lsn;	/*!< the log records of all
+					mini-transactions below this lsn have
+					been copied to the log buffer and
+					their pages added to the flush lists;
+					mini-transactions close in the lsn
+					order */
 #endif /* !UNIV_HOTBACKUP */
 	byte*		buf_ptr;	/* unaligned log buffer */
-	byte*		buf;		/*!< log buffer */
+	byte*		buf;		/*!< log buffer; the byte of an lsn
+					is at the offset lsn % buf_size,
+					the buffer is used as a ring */
 	ulint		buf_size;	/*!< log buffer size in bytes */
-	ulint		max_buf_free;	/*!< recommended maximum value of
-					buf_free, after which the buffer is
-					flushed */
-	ulint		old_buf_free;	/*!< value of buf free when log was
-					last time opened; only in the debug
-					version */
-	ib_uint64_t	old_lsn;	/*!< value of lsn when log was
-					last time opened; only in the
-					debug version */
+	ulint		max_buf_free;	/*!< recommended maximum number of
+					bytes in the log buffer that have not
+					been written yet, after which the
+					buffer is flushed */
 	ibool		check_flush_or_checkpoint;
 					/*!< this is set to TRUE when there may
 					be need to flush the log buffer, or
@@ -802,13 +904,15 @@ struct log_struct{
 #ifndef UNIV_HOTBACKUP
 	/** The fields involved in the log buffer flush @{ */
 
-	ulint		buf_next_to_write;/*!< first offset in the log buffer
-					where the byte content may not exist
-					written to file, e.g., the start
-					offset of a log record catenated
-					later; this is advanced when a flush
-					operation is completed to all the log
-					groups */
+	mutex_t		write_mutex;	/*!< mutex serializing the writes
+					of the log buffer to the log files;
+					protects write_buf and write_lsn */
+	mutex_t		flush_mutex;	/*!< mutex serializing the flushes
+					of the log files to disk */
+	byte*		write_buf_ptr;	/* unaligned write buffer */
+	byte*		write_buf;	/*!< buffer of buf_size bytes where
+					the log writer copies the log blocks
+					that it writes from the log buffer */
 	ib_uint64_t	written_to_some_lsn;
 					/*!< first log sequence number not yet
 					written to any log group; for this to
@@ -823,8 +927,11 @@ struct log_struct{
 					log groups.
 					Note that since InnoDB currently
 					has only one log group therefore
-					this value is redundant. Also it
-					is possible that this value
+					this value is redundant. It is
+					advanced with log_lsn_advance() by
+					the write, which also owns the log
+					mutex, and read with log_lsn_read().
+					Also it is possible that this value
 					falls behind the
 					flushed_to_disk_lsn transiently.
 					It is appropriate to use either
@@ -832,44 +939,60 @@ struct log_struct{
 					write_lsn which are always
 					up-to-date and accurate. */
 	ib_uint64_t	write_lsn;	/*!< end lsn for the current running
-					write */
-	ulint		write_end_offset;/*!< the data in buffer has
-					been written up to this offset
-					when the current write ends:
-					this field will then be copied
-					to buf_next_to_write */
+					write, or the last write */
 	ib_uint64_t	current_flush_lsn;/*!< end lsn for the current running
-					write + flush operation */
+					flush operation */
 	ib_uint64_t	flushed_to_disk_lsn;
 					/*!< how far we have written the log
-					AND flushed to disk */
+					AND flushed to disk; advanced with
+					log_lsn_advance() while holding the
+					log mutex */
+	ib_uint64_t	write_requested_lsn;
+					/*!< the highest lsn that a thread has
+					asked to be written; the closing of
+					the mini-transaction that reaches it
+					wakes up the log writer */
+	ib_uint64_t	flush_requested_lsn;
+					/*!< the highest lsn that a thread has
+					asked to be flushed to disk */
 	ulint		n_pending_writes;/*!< number of currently
-					pending flushes or writes */
-	/* NOTE on the 'flush' in names of the fields below: starting from
-	4.0.14, we separate the write of the log file and the actual fsync()
-	or other method to flush it to disk. The names below shhould really
-	be 'flush_or_write'! */
-	os_event_t	no_flush_event;	/*!< this event is in the reset state
-					when a flush or a write is running;
-					a thread should wait for this without
-					owning the log mutex, but NOTE that
-					to set or reset this event, the
-					thread MUST own the log mutex! */
-	ibool		one_flushed;	/*!< during a flush, this is
-					first FALSE and becomes TRUE
-					when one log group has been
-					written or flushed */
-	os_event_t	one_flushed_event;/*!< this event is reset when the
-					flush or write has not yet completed
-					for any log group; e.g., this means
-					that a transaction has been committed
-					when this is set; a thread should wait
-					for this without owning the log mutex,
-					but NOTE that to set or reset this
-					event, the thread MUST own the log
-					mutex! */
+					pending writes (0 or 1); the
+					write is done without holding
+					the log mutex */
+	ulint		n_pending_flushes;/*!< number of currently
+					pending flushes to disk (0 or 1);
+					a new write can run meanwhile */
+	ibool		writer_active;	/*!< TRUE while log_writer_thread()
+					is running; if FALSE, the threads
+					that wait for a write do it
+					themselves */
+	ibool		flusher_active;	/*!< TRUE while log_flusher_thread()
+					is running */
+	os_event_t	writer_event;	/*!< set to wake up the log writer */
+	os_event_t	flusher_event;	/*!< set to wake up the log flusher */
+	os_event_t	close_events[LOG_N_EVENTS];
+					/*!< a mini-transaction that waits
+					for closed_lsn to reach its start lsn
+					waits for the event of that lsn, see
+					log_event_slot() */
+	os_event_t	write_events[LOG_N_EVENTS];
+					/*!< a thread that waits for the log
+					to be written up to an lsn waits for
+					the event of that lsn; the writer sets
+					the events of the blocks it wrote */
+	os_event_t	flush_events[LOG_N_EVENTS];
+					/*!< same as write_events, for
+					flushed_to_disk_lsn */
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	os_fast_mutex_t	lsn_mutex;	/*!< protects the fields that are
+					accessed with log_lsn_read() and
+					log_lsn_advance() when there are no
+					64-bit atomic builtins */
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
-					far */
+					far; updated with log_counter_add(),
+					because log_write_up_to() writes
+					the log without the log mutex */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
 					previous printout */
 	time_t		last_printout_time;/*!< when log_print was last time
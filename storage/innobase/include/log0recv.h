@@ -438,6 +438,12 @@ struct recv_sys_struct{
 	hash_table_t*	addr_hash;/*!< hash table of file addresses of pages */
 	ulint		n_addrs;/*!< number of not processed hashed file
 				addresses in the hash table */
+	ulint		n_batch_addrs;/*!< number of hashed file addresses
+				at the start of the current apply batch */
+	ulint		n_apply_threads;/*!< number of redo log apply
+				worker threads that are still scanning the
+				hash table in the current apply batch;
+				protected by mutex */
 };
 
 /** The recovery system */
@@ -110,6 +110,11 @@ For 1 - 8 bytes, the flag value must give the length also! @{ */
 /*#define	MLOG_FULL_PAGE	((byte)28)	full contents of a page */
 #ifdef UNIV_LOG_LSN_DEBUG
 # define MLOG_LSN		((byte)28)	/* current LSN */
+# define MTR_LSN_REC_LEN	11		/* length of the MLOG_LSN
+						pseudo-record: the type and
+						the two halves of the LSN
+						in the 5-byte compressed
+						format */
 #endif
 #define MLOG_INIT_FILE_PAGE	((byte)29)	/*!< this means that a
 						file page is taken
@@ -860,6 +860,21 @@ os_file_set_size(
 				size */
 	ulint		size_high);/*!< in: most significant 32 bits of size */
 /***********************************************************************//**
+Allocates disk space for a range of a file with posix_fallocate(), without
+writing to it. The allocated range reads as zeros. The file is extended if
+the range ends past its end.
+@return	TRUE if success, FALSE if posix_fallocate() is not available or
+failed; the caller may then write zeros to the range instead */
+UNIV_INTERN
+ibool
+os_file_allocate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file or path as a
+				null-terminated string */
+	os_file_t	file,	/*!< in: handle to a file */
+	ib_int64_t	offset,	/*!< in: start of the range in bytes */
+	ib_int64_t	len);	/*!< in: length of the range in bytes */
+/***********************************************************************//**
 Truncates a file at its current position.
 @return	TRUE if success */
 UNIV_INTERN
@@ -868,6 +883,17 @@ os_file_set_eof(
 /*============*/
 	FILE*		file);	/*!< in: file to be truncated */
 /***********************************************************************//**
+Truncates a file to the given size.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+os_file_truncate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file or path as a
+				null-terminated string */
+	os_file_t	file,	/*!< in: handle to a file */
+	ib_int64_t	size);	/*!< in: new size of the file in bytes */
+/***********************************************************************//**
 NOTE! Use the corresponding macro os_file_flush(), not directly this function!
 Flushes the write buffers of a given file to the disk.
 @return	TRUE if success */
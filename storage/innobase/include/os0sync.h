@@ -304,12 +304,32 @@ amount of increment. */
 # define os_atomic_increment_ulint(ptr, amount) \
 	os_atomic_increment(ptr, amount)
 
+/**********************************************************//**
+Returns the resulting value, ptr is pointer to target, amount is the
+amount to decrement. */
+
+# define os_atomic_decrement_ulint(ptr, amount) \
+	__sync_sub_and_fetch(ptr, amount)
+
 /**********************************************************//**
 Returns the old value of *ptr, atomically sets *ptr to new_val */
 
 # define os_atomic_test_and_set_byte(ptr, new_val) \
 	__sync_lock_test_and_set(ptr, (byte) new_val)
 
+# ifdef HAVE_IB_GCC_ATOMIC_BUILTINS_64
+#  define HAVE_ATOMIC_BUILTINS_64
+
+/**********************************************************//**
+Same as above, on 64-bit values also on 32-bit platforms. */
+
+#  define os_atomic_increment_uint64(ptr, amount) \
+	__sync_add_and_fetch(ptr, amount)
+
+#  define os_compare_and_swap_uint64(ptr, old_val, new_val) \
+	__sync_bool_compare_and_swap(ptr, old_val, new_val)
+# endif /* HAVE_IB_GCC_ATOMIC_BUILTINS_64 */
+
 #elif defined(HAVE_IB_SOLARIS_ATOMICS)
 
 #define HAVE_ATOMIC_BUILTINS
@@ -357,12 +377,30 @@ amount of increment. */
 # define os_atomic_increment_ulint(ptr, amount) \
 	atomic_add_long_nv(ptr, amount)
 
+/**********************************************************//**
+Returns the resulting value, ptr is pointer to target, amount is the
+amount to decrement. */
+
+# define os_atomic_decrement_ulint(ptr, amount) \
+	atomic_add_long_nv(ptr, -(long) (amount))
+
 /**********************************************************//**
 Returns the old value of *ptr, atomically sets *ptr to new_val */
 
 # define os_atomic_test_and_set_byte(ptr, new_val) \
 	atomic_swap_uchar(ptr, new_val)
 
+# define HAVE_ATOMIC_BUILTINS_64
+
+/**********************************************************//**
+Same as above, on 64-bit values also on 32-bit platforms. */
+
+# define os_atomic_increment_uint64(ptr, amount) \
+	atomic_add_64_nv((uint64_t*) ptr, amount)
+
+# define os_compare_and_swap_uint64(ptr, old_val, new_val) \
+	(atomic_cas_64((uint64_t*) ptr, old_val, new_val) == old_val)
+
 #elif defined(HAVE_WINDOWS_ATOMICS)
 
 #define HAVE_ATOMIC_BUILTINS
@@ -403,6 +441,13 @@ amount of increment. */
 # define os_atomic_increment_ulint(ptr, amount) \
 	((ulint) (win_xchg_and_add(ptr, amount) + amount))
 
+/**********************************************************//**
+Returns the resulting value, ptr is pointer to target, amount is the
+amount to decrement. */
+
+# define os_atomic_decrement_ulint(ptr, amount) \
+	((ulint) (win_xchg_and_add(ptr, -(lint) (amount)) - (amount)))
+
 /**********************************************************//**
 Returns the old value of *ptr, atomically sets *ptr to new_val.
 InterlockedExchange() operates on LONG, and the LONG will be
@@ -411,6 +456,21 @@ clobbered */
 # define os_atomic_test_and_set_byte(ptr, new_val) \
 	((byte) InterlockedExchange(ptr, new_val))
 
+# ifdef _WIN64
+#  define HAVE_ATOMIC_BUILTINS_64
+
+/**********************************************************//**
+Same as above, on 64-bit values. */
+
+#  define os_atomic_increment_uint64(ptr, amount) \
+	((ib_uint64_t) (InterlockedExchangeAdd64( \
+		(LONGLONG*) ptr, amount) + amount))
+
+#  define os_compare_and_swap_uint64(ptr, old_val, new_val) \
+	((ib_uint64_t) InterlockedCompareExchange64( \
+		(LONGLONG*) ptr, new_val, old_val) == old_val)
+# endif /* _WIN64 */
+
 #else
 # define IB_ATOMICS_STARTUP_MSG \
 	"Mutexes and rw_locks use InnoDB's own implementation"
@@ -100,6 +100,18 @@ typedef struct page_zip_stat_struct page_zip_stat_t;
 /** Statistics on compression, indexed by page_zip_des_struct::ssize - 1 */
 extern page_zip_stat_t page_zip_stat[PAGE_ZIP_NUM_SSIZE - 1];
 
+/** Compression statistics of an index */
+typedef struct page_zip_stat_per_index_struct page_zip_stat_per_index_t;
+
+/** Compression statistics of an index, collected while
+innodb_cmp_per_index_enabled is set */
+struct page_zip_stat_per_index_struct {
+	index_id_t	id;	/*!< index id */
+	page_zip_stat_t	stat;	/*!< compression statistics */
+	page_zip_stat_per_index_t* hash;
+				/*!< hash chain node */
+};
+
 /**********************************************************************//**
 Write the "deleted" flag of a record on a compressed page.  The flag must
 already have been written on the uncompressed page. */
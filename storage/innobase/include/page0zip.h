@@ -38,6 +38,13 @@ Created June 2005 by Marko Makela
 #include "trx0types.h"
 #include "mem0mem.h"
 
+/** Default zlib compression level of compressed pages */
+#define DEFAULT_COMPRESSION_LEVEL	6
+
+/** zlib compression level of compressed pages, 0 (no compression)
+to 9 (best compression); innodb_compression_level */
+extern ulong	page_zip_level;
+
 /**********************************************************************//**
 Determine the size of a compressed page in bytes.
 @return	size in bytes */
@@ -445,10 +452,60 @@ UNIV_INTERN
 ulint
 page_zip_calc_checksum(
 /*===================*/
-        const void*     data,   /*!< in: compressed page */
-        ulint           size)   /*!< in: size of compressed page */
+	const void*			data,	/*!< in: compressed page */
+	ulint				size,	/*!< in: size of compressed
+						page */
+	srv_checksum_algorithm_t	algo)	/*!< in: algorithm to use */
 	__attribute__((nonnull));
 
+/**********************************************************************//**
+Verify a compressed page's checksum. The strict variants of
+innodb_checksum_algorithm only accept the configured algorithm, the
+others accept a checksum calculated with any algorithm.
+@return	TRUE if the stored checksum is valid */
+UNIV_INTERN
+ibool
+page_zip_verify_checksum(
+/*=====================*/
+	const void*	data,	/*!< in: compressed page */
+	ulint		size);	/*!< in: size of compressed page */
+
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Creates the per-index compression statistics. */
+UNIV_INTERN
+void
+page_zip_stat_per_index_init(void);
+/*==============================*/
+
+/**********************************************************************//**
+Frees the per-index compression statistics. */
+UNIV_INTERN
+void
+page_zip_stat_per_index_close(void);
+/*===============================*/
+
+/**********************************************************************//**
+Discards the per-index compression statistics collected so far. */
+UNIV_INTERN
+void
+page_zip_stat_per_index_reset(void);
+/*===============================*/
+
+/**********************************************************************//**
+Copies the per-index compression statistics, and optionally discards
+them.
+@return	array of statistics allocated from heap, or NULL if empty */
+UNIV_INTERN
+page_zip_stat_per_index_t*
+page_zip_stat_per_index_copy(
+/*=========================*/
+	mem_heap_t*	heap,	/*!< in: memory heap for the copy */
+	ulint*		n,	/*!< out: number of elements in the copy */
+	ibool		reset)	/*!< in: TRUE=discard the statistics */
+	__attribute__((nonnull));
+#endif /* !UNIV_HOTBACKUP */
+
 #ifndef UNIV_HOTBACKUP
 /** Check if a pointer to an uncompressed page matches a compressed page.
 @param ptr	pointer to an uncompressed page frame
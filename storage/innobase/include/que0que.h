@@ -114,7 +114,7 @@ que_graph_free(
 			afterwards! */
 /**********************************************************************//**
 Stops a query thread if graph or trx is in a state requiring it. The
-conditions are tested in the order (1) graph, (2) trx. The kernel mutex has
+conditions are tested in the order (1) graph, (2) trx. The trx mutex has
 to be reserved.
 @return	TRUE if stopped */
 UNIV_INTERN
@@ -308,7 +308,7 @@ que_node_list_get_len(
 Checks if graph, trx, or session is in a state where the query thread should
 be stopped.
 @return TRUE if should be stopped; NOTE that if the peek is made
-without reserving the kernel mutex, then another peek with the mutex
+without reserving the trx mutex, then another peek with the mutex
 reserved is necessary before deciding the actual stopping */
 UNIV_INLINE
 ibool
@@ -344,8 +344,8 @@ que_eval_sql(
 				dict_sys->mutex around call to pars_sql. */
 	trx_t*		trx);	/*!< in: trx */
 
-/* Query graph query thread node: the fields are protected by the kernel
-mutex with the exceptions named below */
+/* Query graph query thread node: the fields are protected by the trx
+mutex of the transaction with the exceptions named below */
 
 struct que_thr_struct{
 	que_common_t	common;		/*!< type: QUE_NODE_THR */
@@ -367,10 +367,14 @@ struct que_thr_struct{
 					the trx */
 	UT_LIST_NODE_T(que_thr_t)
 			queue;		/*!< list of runnable thread nodes in
-					the server task queue */
+					the server task queue, protected by
+					the kernel mutex */
+	srv_slot_t*	slot;		/*!< the thread slot in the lock wait
+					table while the OS thread is suspended
+					in srv_suspend_mysql_thread(), or NULL */
 	/*------------------------------*/
 	/* The following fields are private to the OS thread executing the
-	query thread, and are not protected by the kernel mutex: */
+	query thread, and are not protected by the trx mutex: */
 
 	que_node_t*	run_node;	/*!< pointer to the node where the
 					subgraph down from this node is
@@ -389,7 +393,7 @@ struct que_thr_struct{
 #define QUE_THR_MAGIC_N		8476583
 #define QUE_THR_MAGIC_FREED	123461526
 
-/* Query graph fork node: its fields are protected by the kernel mutex */
+/* Query graph fork node: its fields are protected by the trx mutex */
 struct que_fork_struct{
 	que_common_t	common;		/*!< type: QUE_NODE_FORK */
 	que_t*		graph;		/*!< query graph of this node */
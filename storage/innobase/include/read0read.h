@@ -32,6 +32,7 @@ Created 2/16/1997 Heikki Tuuri
 #include "ut0byte.h"
 #include "ut0lst.h"
 #include "trx0trx.h"
+#include "trx0sys.h"
 #include "read0types.h"
 
 /*********************************************************************//**
@@ -44,8 +45,8 @@ read_view_open_now(
 /*===============*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
-	mem_heap_t*	heap);		/*!< in: memory heap from which
-					allocated */
+	read_view_t*	view);		/*!< in: closed read view to
+					reuse, or NULL */
 /*********************************************************************//**
 Makes a copy of the oldest existing read view, or opens a new. The view
 must be closed with ..._close.
@@ -56,8 +57,8 @@ read_view_oldest_copy_or_open_new(
 /*==============================*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
-	mem_heap_t*	heap);		/*!< in: memory heap from which
-					allocated */
+	read_view_t*	view);		/*!< in: closed read view to
+					reuse, or NULL */
 /*********************************************************************//**
 Closes a read view. */
 UNIV_INTERN
@@ -66,8 +67,16 @@ read_view_close(
 /*============*/
 	read_view_t*	view);	/*!< in: read view */
 /*********************************************************************//**
+Frees the memory of a read view. The view must have been closed. */
+UNIV_INTERN
+void
+read_view_free(
+/*===========*/
+	read_view_t*	view);	/*!< in, own: read view */
+/*********************************************************************//**
 Closes a consistent read view for MySQL. This function is called at an SQL
-statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED. */
+statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED.
+The view is kept in trx->prebuilt_view for reuse. */
 UNIV_INTERN
 void
 read_view_close_for_mysql(
@@ -144,12 +153,15 @@ struct read_view_struct{
 				this is the "low water mark". */
 	ulint		n_trx_ids;
 				/*!< Number of cells in the trx_ids array */
+	ulint		max_trx_ids;
+				/*!< Number of cells allocated in the
+				trx_ids array */
 	trx_id_t*	trx_ids;/*!< Additional trx ids which the read should
 				not see: typically, these are the active
 				transactions at the time when the read is
 				serialized, except the reading transaction
-				itself; the trx ids in this array are in a
-				descending order. These trx_ids should be
+				itself; the trx ids in this array are in an
+				ascending order. These trx_ids should be
 				between the "low" and "high" water marks,
 				that is, up_limit_id and low_limit_id. */
 	trx_id_t	creator_trx_id;
@@ -177,7 +189,8 @@ is allocated and pointer to a read view. */
 
 struct cursor_view_struct{
 	mem_heap_t*	heap;
-				/*!< Memory heap for the cursor view */
+				/*!< Memory heap for the cursor view
+				struct */
 	read_view_t*	read_view;
 				/*!< Consistent read view of the cursor*/
 	ulint		n_mysql_tables_in_use;
@@ -0,0 +1,141 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/row0log.h
+Modification log for online index creation
+
+While a secondary index is being created online, the modifications
+that concurrent transactions make to it are written to a log instead
+of the index tree. The log is applied to the index tree after the
+index has been built from a consistent read of the clustered index.
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#ifndef row0log_h
+#define row0log_h
+
+#include "univ.i"
+#include "data0types.h"
+#include "dict0types.h"
+#include "trx0types.h"
+#include "row0types.h"
+
+/** Index record modification operations in the log */
+enum row_op {
+	/** Insert a record, or delete-unmark and update an existing one */
+	ROW_OP_INSERT = 1,
+	/** Delete-mark a record */
+	ROW_OP_DELETE,
+	/** Remove a delete-marked record */
+	ROW_OP_PURGE
+};
+
+/******************************************************//**
+Allocates the modification log of a secondary index that is being
+created online. Modifications to the index will be logged from now on,
+until row_log_apply() or row_log_abort_sec() is called. */
+UNIV_INTERN
+void
+row_log_allocate(
+/*=============*/
+	dict_index_t*	index)	/*!< in/out: index being created */
+	__attribute__((nonnull));
+
+/******************************************************//**
+Logs an operation on a secondary index that is being created online.
+The caller must hold index->lock in S or X mode and must have checked
+that dict_index_is_online_ddl() holds. */
+UNIV_INTERN
+void
+row_log_online_op(
+/*==============*/
+	dict_index_t*	index,	/*!< in/out: index */
+	const dtuple_t*	tuple,	/*!< in: index entry */
+	trx_id_t	trx_id,	/*!< in: transaction that modified
+				the index entry */
+	enum row_op	op)	/*!< in: operation */
+	__attribute__((nonnull));
+
+/******************************************************//**
+Logs an operation on a secondary index if the index is being created
+online. The caller must not hold index->lock.
+@return TRUE if the index is being created or its creation was aborted,
+and the operation must not be applied to the index tree; FALSE if the
+index is complete */
+UNIV_INTERN
+ibool
+row_log_online_op_try(
+/*==================*/
+	dict_index_t*	index,	/*!< in/out: index */
+	const dtuple_t*	tuple,	/*!< in: index entry */
+	trx_id_t	trx_id,	/*!< in: transaction that modified
+				the index entry */
+	enum row_op	op)	/*!< in: operation */
+	__attribute__((nonnull, warn_unused_result));
+
+/******************************************************//**
+Applies the full blocks of the modification log to a secondary index
+that is being created online, without blocking the concurrent
+modifications that are being logged.
+@return DB_SUCCESS, or error code on failure */
+UNIV_INTERN
+ulint
+row_log_catch_up(
+/*=============*/
+	trx_t*		trx,	/*!< in: transaction creating the index */
+	dict_index_t*	index)	/*!< in/out: index */
+	__attribute__((nonnull, warn_unused_result));
+
+/******************************************************//**
+Applies the rest of the modification log to a secondary index that is
+being created online, and makes the index complete. Concurrent
+modifications wait for index->lock meanwhile. On failure, index
+creation is aborted. In either case, the log is freed.
+@return DB_SUCCESS, or error code on failure */
+UNIV_INTERN
+ulint
+row_log_apply(
+/*==========*/
+	trx_t*		trx,	/*!< in: transaction creating the index */
+	dict_index_t*	index)	/*!< in/out: index */
+	__attribute__((nonnull, warn_unused_result));
+
+/******************************************************//**
+Aborts the creation of a secondary index that is being created online,
+and frees the modification log. Subsequent modifications to the index
+will be discarded, until the index is dropped. */
+UNIV_INTERN
+void
+row_log_abort_sec(
+/*==============*/
+	dict_index_t*	index)	/*!< in/out: index */
+	__attribute__((nonnull));
+
+/******************************************************//**
+Frees the modification log of an index that is being removed from the
+data dictionary cache. */
+UNIV_INTERN
+void
+row_log_free(
+/*=========*/
+	dict_index_t*	index)	/*!< in/out: index */
+	__attribute__((nonnull));
+
+#endif /* row0log_h */
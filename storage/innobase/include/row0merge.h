@@ -191,7 +191,31 @@ row_merge_build_indexes(
 					unless creating a PRIMARY KEY */
 	dict_index_t**	indexes,	/*!< in: indexes to be created */
 	ulint		n_indexes,	/*!< in: size of indexes[] */
-	struct TABLE*	table);		/*!< in/out: MySQL table, for
+	struct TABLE*	table,		/*!< in/out: MySQL table, for
 					reporting erroneous key value
 					if applicable */
+	ibool		online);	/*!< in: TRUE if the indexes are
+					being created online, reading
+					old_table through trx->read_view
+					while it is being modified */
+
+/*********************************************************************//**
+Creates a temporary file for merge sorting or for the modification log
+of online index creation, and if UNIV_PFS_IO is defined, registers the
+file descriptor with Performance Schema.
+@return file descriptor, or -1 on failure */
+UNIV_INTERN
+int
+row_merge_file_create_low(void);
+/*===========================*/
+
+/*********************************************************************//**
+Destroys a temporary file that was created by row_merge_file_create_low(),
+and if UNIV_PFS_IO is defined, de-registers the file from Performance
+Schema. */
+UNIV_INTERN
+void
+row_merge_file_destroy_low(
+/*=======================*/
+	int		fd);	/*!< in: merge file descriptor */
 #endif /* row0merge.h */
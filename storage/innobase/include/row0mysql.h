@@ -544,6 +544,12 @@ struct mysql_row_templ_struct {
 					Innobase record in the clustered index;
 					not defined if template_type is
 					ROW_MYSQL_WHOLE_ROW */
+	ulint	icp_rec_field_no;	/*!< field number of the column in an
+					Innobase record in the index of the
+					pushed index condition, or
+					ULINT_UNDEFINED if the column is not
+					(fully) contained in that index or
+					there is no pushed index condition */
 	ulint	mysql_col_offset;	/*!< offset of the column in the MySQL
 					row format */
 	ulint	mysql_col_len;		/*!< length of the column in the MySQL
@@ -575,7 +581,16 @@ struct mysql_row_templ_struct {
 					it is an unsigned integer type */
 };
 
+/* The number of rows fetched to fetch_cache in the first batch after
+positioning the cursor; each full batch doubles the size of the next one,
+up to MYSQL_FETCH_CACHE_MAX_SIZE rows or MYSQL_FETCH_CACHE_MAX_BYTES bytes
+of rows */
 #define MYSQL_FETCH_CACHE_SIZE		8
+/* The maximum number of rows in fetch_cache */
+#define MYSQL_FETCH_CACHE_MAX_SIZE	256
+/* The maximum total size of the rows in fetch_cache, unless it is less
+than MYSQL_FETCH_CACHE_SIZE rows */
+#define MYSQL_FETCH_CACHE_MAX_BYTES	UNIV_PAGE_SIZE
 /* After fetching this many rows, we start caching them in fetch_cache */
 #define MYSQL_FETCH_CACHE_THRESHOLD	4
 
@@ -735,21 +750,36 @@ struct row_prebuilt_struct {
 					('mini-rollback') */
 	ulint		mysql_prefix_len;/*!< byte offset of the end of
 					the last requested column */
+	void*		idx_cond;	/*!< the ha_innobase handle whose
+					pushed index condition must be
+					evaluated on the records of
+					prebuilt->index before fetching the
+					clustered index record, or NULL */
 	ulint		mysql_row_len;	/*!< length in bytes of a row in the
 					MySQL format */
 	ulint		n_rows_fetched;	/*!< number of rows fetched after
 					positioning the current cursor */
 	ulint		fetch_direction;/*!< ROW_SEL_NEXT or ROW_SEL_PREV */
-	byte*		fetch_cache[MYSQL_FETCH_CACHE_SIZE];
-					/*!< a cache for fetched rows if we
+	byte**		fetch_cache;	/*!< a cache for fetched rows if we
 					fetch many rows from the same cursor:
 					it saves CPU time to fetch them in a
-					batch; we reserve mysql_row_len
+					batch; an array of fetch_cache_max
+					pointers, allocated on the first use;
+					we reserve mysql_row_len
 					bytes for each such row; these
 					pointers point 4 bytes past the
 					allocated mem buf start, because
 					there is a 4 byte magic number at the
-					start and at the end */
+					start and at the end; the row buffers
+					are allocated when the batch size
+					grows to include them */
+	ulint		fetch_cache_max;/*!< number of elements in
+					fetch_cache */
+	ulint		fetch_cache_limit;/*!< number of rows to fetch in
+					the current batch; starts at
+					MYSQL_FETCH_CACHE_SIZE when the cursor
+					is positioned and doubles with each
+					full batch, up to fetch_cache_max */
 	ibool		keep_other_fields_on_keyread; /*!< when using fetch
 					cache with HA_EXTRA_KEYREAD, don't
 					overwrite other fields in mysql row
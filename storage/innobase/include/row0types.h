@@ -53,6 +53,8 @@ typedef	struct purge_node_struct purge_node_t;
 
 typedef struct row_ext_struct row_ext_t;
 
+typedef struct row_log_struct row_log_t;
+
 /* MySQL data types */
 struct TABLE;
 
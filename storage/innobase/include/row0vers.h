@@ -37,7 +37,7 @@ Created 2/6/1997 Heikki Tuuri
 
 /*****************************************************************//**
 Finds out if an active transaction has inserted or modified a secondary
-index record. NOTE: the kernel mutex is temporarily released in this
+index record. NOTE: the lock mutex is temporarily released in this
 function!
 @return NULL if committed, else the active transaction */
 UNIV_INTERN
@@ -47,6 +47,8 @@ Created 10/10/1995 Heikki Tuuri
 #include "os0sync.h"
 #include "que0types.h"
 #include "trx0types.h"
+#include "buf0types.h"
+#include "buf0dump.h"
 
 extern const char*	srv_main_thread_op_info;
 
@@ -66,6 +68,20 @@ extern os_event_t	srv_timeout_event;
 /* The error monitor thread waits on this event. */
 extern os_event_t	srv_error_event;
 
+/** The buffer pool dump/load thread waits on this event. */
+extern os_event_t	srv_buf_dump_event;
+
+/** The buffer pool resize thread waits on this event. */
+extern os_event_t	srv_buf_resize_event;
+
+/** The buffer pool dump/load file name */
+extern char*		srv_buf_dump_filename;
+
+/** Boolean config knobs that tell InnoDB to dump the buffer pool at shutdown
+and/or load it during startup. */
+extern my_bool		srv_buffer_pool_dump_at_shutdown;
+extern my_bool		srv_buffer_pool_load_at_startup;
+
 /* If the last data file is auto-extended, we add this many pages to it
 at a time */
 #define SRV_AUTO_EXTEND_INCREMENT	\
@@ -131,6 +147,9 @@ extern ulint	srv_last_file_size_max;
 extern char**	srv_log_group_home_dirs;
 #ifndef UNIV_HOTBACKUP
 extern ulong	srv_auto_extend_increment;
+extern ulong	srv_file_extend_percent;
+extern my_bool	srv_file_preextend;
+extern my_bool	srv_use_fallocate;
 
 extern double	srv_segment_fill_factor;
 extern double	srv_index_fill_factor;
@@ -156,6 +175,16 @@ extern my_bool	srv_load_corrupted;
 extern ulint	srv_n_corrupted_page_reads;
 extern ulint	srv_n_corrupted_table_opens;
 
+/* Size in bytes above which the master thread evicts unused tables from
+the data dictionary cache; 0 if tables are never evicted */
+extern ulong	srv_dict_size_limit;
+
+/* Table opens that found the table in the data dictionary cache or had to
+load it, and tables evicted from the cache */
+extern ulint	srv_n_dict_cache_hits;
+extern ulint	srv_n_dict_cache_misses;
+extern ulint	srv_n_dict_cache_evictions;
+
 /* The sort order table of the MySQL latin1_swedish_ci character set
 collation */
 extern const byte*	srv_latin1_ordering;
@@ -167,6 +196,8 @@ extern ibool	srv_use_sys_malloc;
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern my_bool	srv_buf_pool_populate;	/*!< virtual page preallocation */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
+extern ulong	srv_buf_pool_chunk_unit;/*!< size of a buffer pool chunk
+					in bytes */
 extern my_bool	srv_flush_neighbors;	/*!< whether or not to flush
 					neighbors of a block */
 extern ulint	srv_buf_pool_old_size;	/*!< previously requested size */
@@ -230,21 +261,43 @@ extern ibool	srv_innodb_status;
 
 extern unsigned long long	srv_stats_sample_pages;
 
+/** TRUE if table and index statistics are stored in SYS_TABLE_STATS and
+SYS_INDEX_STATS and survive restarts; set by innodb_stats_persistent */
+extern my_bool			srv_stats_persistent;
+/** Number of leaf pages to sample when calculating persistent
+statistics, for example by ANALYZE TABLE */
+extern unsigned long long	srv_stats_persistent_sample_pages;
+/** TRUE if persistent statistics are recalculated in the background
+when enough of a table has changed */
+extern my_bool			srv_stats_auto_recalc;
+
 extern ibool	srv_use_doublewrite_buf;
-extern ibool	srv_use_checksums;
+/** Doublewrite file, or NULL to keep the doublewrite buffer in the
+system tablespace; set by innodb_doublewrite_file */
+extern char*	srv_doublewrite_file;
+extern ulong	srv_checksum_algorithm;	/*!< the page and log block
+					checksum algorithm, one of
+					srv_checksum_algorithm_t */
 
 extern ulong	srv_max_buf_pool_modified_pct;
 extern ulong	srv_max_purge_lag;
+extern ulong	srv_max_purge_lag_delay;
 
 extern ulong	srv_replication_delay;
 /*-------------------------------------------*/
 
 extern ulint	srv_n_lock_deadlock_count;
+/** Number of deadlock searches, protected by lock_sys->mutex */
+extern ulint	srv_n_lock_deadlock_checks;
+/** Time spent in deadlock searches in microseconds, protected by
+lock_sys->mutex */
+extern ullint	srv_lock_deadlock_check_time;
 
 extern ulint	srv_n_rows_inserted;
 extern ulint	srv_n_rows_updated;
 extern ulint	srv_n_rows_deleted;
 extern ulint	srv_n_rows_read;
+extern ulint	srv_n_rows_prefetch_batches;
 
 extern ibool	srv_print_innodb_monitor;
 extern ibool	srv_print_innodb_lock_monitor;
@@ -255,11 +308,17 @@ extern ibool	srv_print_innodb_table_monitor;
 extern ibool	srv_lock_timeout_active;
 extern ibool	srv_monitor_active;
 extern ibool	srv_error_monitor_active;
+extern ibool	srv_buf_dump_thread_active;
+extern ibool	srv_buf_resize_thread_active;
+extern ibool	srv_page_cleaner_active;
+extern ibool	srv_dict_stats_thread_active;
+extern ibool	srv_fsp_preextend_thread_active;
 
 extern ulong	srv_n_spin_wait_rounds;
 extern ulong	srv_n_free_tickets_to_enter;
 extern ulong	srv_thread_sleep_delay;
 extern ulong	srv_spin_wait_delay;
+extern ulong	srv_sync_array_size;
 extern ibool	srv_priority_boost;
 
 extern ulint	srv_truncated_status_writes;
@@ -290,8 +349,8 @@ extern ulint	srv_dml_needed_delay;
 extern my_bool	srv_purge_view_update_only_debug;
 #endif /* UNIV_DEBUG */
 
-extern mutex_t*	kernel_mutex_temp;/* mutex protecting the server, trx structs,
-				query threads, and lock table: we allocate
+extern mutex_t*	kernel_mutex_temp;/* mutex protecting the server thread
+				table and the task queue: we allocate
 				it from dynamic memory to get it to the
 				same DRAM page as other hotspot semaphores */
 #define kernel_mutex (*kernel_mutex_temp)
@@ -319,15 +378,72 @@ extern ulint srv_os_log_pending_writes;
 log buffer and have to flush it */
 extern ulint srv_log_waits;
 
-/* the number of purge threads to use from the worker pool (currently 0 or 1) */
+/* the number of purge threads: 0 means that the master thread does the
+purge, otherwise a purge coordinator thread is started together with
+srv_n_purge_threads - 1 purge worker threads */
 extern ulong srv_n_purge_threads;
 
+/** Maximum number of purge threads, including the coordinator */
+#define SRV_MAX_N_PURGE_THREADS	32
+
+/* the number of threads that apply redo log records to pages during
+crash recovery, including the thread that runs the recovery */
+extern ulong srv_n_recovery_threads;
+
+/** Maximum number of redo log apply threads */
+#define SRV_MAX_N_RECOVERY_THREADS	32
+
+/* the number of page cleaner threads: 0 means that the master thread
+flushes the buffer pool, otherwise a page cleaner coordinator thread is
+started together with srv_n_page_cleaners - 1 page cleaner workers */
+extern ulong srv_n_page_cleaners;
+
+/** Maximum number of page cleaner threads, including the coordinator */
+#define SRV_MAX_N_PAGE_CLEANERS	64
+
+/** Maximum size of the modification log of an index that is being
+created online, in bytes */
+extern ulong srv_online_alter_log_max_size;
+
+/** Size of the sort buffers and of the temporary file blocks that are
+used when creating indexes, in bytes */
+extern ulong srv_sort_buf_size;
+
+/** Maximum number of threads that scan the clustered index and
+merge sort the index entries when creating indexes */
+#define SRV_MAX_N_SORT_THREADS	64
+
+/** Number of threads that scan the clustered index and merge sort
+the index entries when creating indexes */
+extern ulong srv_n_sort_threads;
+
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
 /* the number of rollback segments to use */
 extern ulong srv_rollback_segments;
 
+/** Directory where the undo tablespaces are placed */
+extern char*	srv_undo_dir;
+
+/** Number of undo tablespaces to create with a new database */
+extern ulong	srv_undo_tablespaces;
+
+/** Number of undo tablespaces that were opened at startup; their space
+ids are 1 .. srv_undo_tablespaces_open */
+extern ulint	srv_undo_tablespaces_open;
+
+/** Whether purge truncates the undo tablespaces that are larger than
+srv_max_undo_log_size */
+extern my_bool	srv_undo_log_truncate;
+
+/** Size of an undo tablespace, in bytes, above which it is truncated */
+extern unsigned long long	srv_max_undo_log_size;
+
+/** Initial size of an undo tablespace, in pages */
+#define SRV_UNDO_TABLESPACE_SIZE_IN_PAGES	\
+	((1024 * 1024 * 10) / UNIV_PAGE_SIZE)
+
 /* variable that counts amount of data read in total (in bytes) */
 extern ulint srv_data_read;
 
@@ -385,6 +501,42 @@ extern ulint srv_buf_pool_flush_neighbor_pages;
 /** Number of pages scanned as part of LRU batches. */
 extern ulint srv_buf_pool_flush_LRU_batch_scanned;
 
+/** Number of iterations of the page cleaner coordinator. */
+extern ulint srv_page_cleaner_iterations;
+
+/** Number of times the page cleaner coordinator slept between
+iterations. */
+extern ulint srv_page_cleaner_sleeps;
+
+/** Time spent in page cleaner iterations, in milliseconds. */
+extern ulint srv_page_cleaner_time;
+
+/** Number of pages flushed from the LRU tails by the page cleaner. */
+extern ulint srv_page_cleaner_lru_pages;
+
+/** Time spent by the page cleaner threads in LRU tail flushes, in
+milliseconds. */
+extern ulint srv_page_cleaner_lru_time;
+
+/** Number of pages flushed from the flush lists by the page cleaner. */
+extern ulint srv_page_cleaner_flush_list_pages;
+
+/** Time spent by the page cleaner threads in flush list flushes, in
+milliseconds. */
+extern ulint srv_page_cleaner_flush_list_time;
+
+/** Number of index entry modifications written to the logs of
+indexes that were being created online. */
+extern ulint srv_online_alter_log_rows;
+
+/** Current size of the logs of the indexes that are being created
+online, in bytes. */
+extern ulint srv_online_alter_log_bytes;
+
+/** Percentage of the clustered index that the latest index creation
+has read, or 100 when it has finished building the indexes. */
+extern ulint srv_online_alter_progress;
+
 /** Number of pages flushed as part of LRU batches. */
 extern ulint srv_buf_pool_flush_LRU_page_count;
 
@@ -403,6 +555,12 @@ extern ulint srv_n_semaphore_stalls;
 /** print all user-level transactions deadlocks to mysqld stderr */
 extern my_bool srv_print_all_deadlocks;
 
+/** check for deadlocks when a lock wait begins */
+extern my_bool srv_deadlock_detect;
+
+/** collect compression statistics per index */
+extern my_bool srv_cmp_per_index_enabled;
+
 /** Status variables to be passed to MySQL */
 typedef struct export_var_struct export_struc;
 
@@ -424,6 +582,15 @@ extern mysql_pfs_key_t	srv_error_monitor_thread_key;
 extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_master_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
+extern mysql_pfs_key_t	srv_worker_thread_key;
+extern mysql_pfs_key_t	buf_dump_thread_key;
+extern mysql_pfs_key_t	buf_resize_thread_key;
+extern mysql_pfs_key_t	buf_page_cleaner_coordinator_thread_key;
+extern mysql_pfs_key_t	buf_page_cleaner_worker_thread_key;
+extern mysql_pfs_key_t	dict_stats_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
+extern mysql_pfs_key_t	fsp_preextend_thread_key;
 
 /* This macro register the current thread and its key with performance
 schema */
@@ -516,7 +683,9 @@ typedef enum srv_stats_method_name_enum		srv_stats_method_name_t;
 /** Types of threads existing in the system. */
 enum srv_thread_type {
 	SRV_WORKER = 0,	/**< threads serving parallelized queries and
-			queries released from lock wait */
+			queries released from lock wait, currently the
+			purge worker threads */
+	SRV_PURGE,	/**< the purge coordinator thread */
 	SRV_MASTER	/**< the master thread, (whose type number must
 			be biggest) */
 };
@@ -598,6 +767,13 @@ void
 srv_wake_purge_thread(void);
 /*=======================*/
 /*******************************************************************//**
+Wakes up all suspended purge worker threads, so that they can check
+for shutdown. */
+UNIV_INTERN
+void
+srv_wake_worker_threads(void);
+/*=========================*/
+/*******************************************************************//**
 Tells the Innobase server that there has been activity in the database
 and wakes up the master thread if it is suspended (not sleeping). Used
 in the MySQL interface. Note that there is a small chance that the master
@@ -723,7 +899,7 @@ ibool
 srv_printf_innodb_monitor(
 /*======================*/
 	FILE*	file,		/*!< in: output stream */
-	ibool	nowait,		/*!< in: whether to wait for kernel mutex */
+	ibool	nowait,		/*!< in: whether to wait for lock mutex */
 	ulint*	trx_start,	/*!< out: file position of the start of
 				the list of active transactions */
 	ulint*	trx_end);	/*!< out: file position of the end of
@@ -746,6 +922,17 @@ srv_purge_thread(
 	void*	arg __attribute__((unused))); /*!< in: a dummy parameter
 					      required by os_thread_create */
 
+/*********************************************************************//**
+Purge worker thread. Executes the purge query threads that the purge
+coordinator enqueues to the server task queue.
+@return	a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+srv_worker_thread(
+/*==============*/
+	void*	arg __attribute__((unused))); /*!< in: a dummy parameter
+					      required by os_thread_create */
+
 /**********************************************************************//**
 Enqueues a task to server task queue and releases a worker thread, if there
 is a suspended one. */
@@ -795,6 +982,7 @@ struct export_var_struct{
 	ulint innodb_buffer_pool_read_ahead_evicted;/*!< srv_read_ahead evicted*/
 	ulint innodb_dblwr_pages_written;	/*!< srv_dblwr_pages_written */
 	ulint innodb_dblwr_writes;		/*!< srv_dblwr_writes */
+	ulint innodb_file_preextends;		/*!< fsp_n_preextends */
 	ulint innodb_files_open;		/*!< os_file_acct.n_open_files */
 	ulint innodb_files_opened;		/*!< os_file_acct.n_open */
 	ulint innodb_files_closed;		/*!< os_file_acct.n_close */
@@ -809,10 +997,13 @@ struct export_var_struct{
 	ulint innodb_ibuf_merged_pages;		/*!< stat->n_merges */
 	ulint innodb_ibuf_pages;		/*!< ibuf->size */
 	ulint innodb_lock_deadlocks;		/*!< srv_n_lock_deadlock_count */
+	ulint innodb_lock_deadlock_checks;	/*!< srv_n_lock_deadlock_checks */
+	ulint innodb_lock_deadlock_check_time;	/*!< srv_lock_deadlock_check_time
+						in milliseconds */
 	ulint innodb_log_waits;			/*!< srv_log_waits */
 	ulint innodb_log_write_requests;	/*!< srv_log_write_requests */
 	ulint innodb_log_writes;		/*!< srv_log_writes */
-	ib_uint64_t innodb_lsn_current;		/*!< log_sys->lsn */
+	ib_uint64_t innodb_lsn_current;		/*!< log_get_lsn() */
 	ib_uint64_t innodb_lsn_flushed;		/*!< log_sys->flushed_to_disk_lsn */
 	ib_uint64_t innodb_lsn_checkpoint;	/*!< log_sys->last_checkpoint_lsn */
 	ulint innodb_os_log_written;		/*!< srv_os_log_written */
@@ -825,6 +1016,10 @@ struct export_var_struct{
 	ulint innodb_pages_written;		/*!< buf_pool->stat.n_pages_written */
 	ulint innodb_corrupted_page_reads;	/*!< srv_n_corrupted_page_reads */
 	ulint innodb_corrupted_table_opens;	/*!< srv_n_corrupted_table_opens */
+	ulint innodb_dict_cache_hits;		/*!< srv_n_dict_cache_hits */
+	ulint innodb_dict_cache_misses;		/*!< srv_n_dict_cache_misses */
+	ulint innodb_dict_cache_evictions;	/*!< srv_n_dict_cache_evictions */
+	ulint innodb_dict_cache_size;		/*!< dict_sys->size */
 	ulint innodb_row_lock_waits;		/*!< srv_n_lock_wait_count */
 	ulint innodb_row_lock_current_waits;	/*!< srv_n_lock_wait_current_count */
 	ib_int64_t innodb_row_lock_time;	/*!< srv_n_lock_wait_time
@@ -835,6 +1030,7 @@ struct export_var_struct{
 	ulint innodb_row_lock_time_max;		/*!< srv_n_lock_max_wait_time
 						/ 1000 */
 	ulint innodb_rows_read;			/*!< srv_n_rows_read */
+	ulint innodb_rows_prefetch_batches;	/*!< srv_n_rows_prefetch_batches */
 	ulint innodb_rows_inserted;		/*!< srv_n_rows_inserted */
 	ulint innodb_rows_updated;		/*!< srv_n_rows_updated */
 	ulint innodb_rows_deleted;		/*!< srv_n_rows_deleted */
@@ -869,6 +1065,18 @@ struct export_var_struct{
 						/*!< srv_buf_pool_LRU_unzip_search_scanned */
 	ulint innodb_buffer_pool_LRU_get_free_search;
 						/*!< srv_buf_pool_LRU_get_free_search */
+	ulint innodb_page_cleaner_iterations;	/*!< srv_page_cleaner_iterations */
+	ulint innodb_page_cleaner_sleeps;	/*!< srv_page_cleaner_sleeps */
+	ulint innodb_page_cleaner_time;		/*!< srv_page_cleaner_time */
+	ulint innodb_page_cleaner_lru_pages;	/*!< srv_page_cleaner_lru_pages */
+	ulint innodb_page_cleaner_lru_time;	/*!< srv_page_cleaner_lru_time */
+	ulint innodb_page_cleaner_flush_list_pages;
+						/*!< srv_page_cleaner_flush_list_pages */
+	ulint innodb_page_cleaner_flush_list_time;
+						/*!< srv_page_cleaner_flush_list_time */
+	ulint innodb_online_alter_log_rows;	/*!< srv_online_alter_log_rows */
+	ulint innodb_online_alter_log_bytes;	/*!< srv_online_alter_log_bytes */
+	ulint innodb_online_alter_progress;	/*!< srv_online_alter_progress */
 	ulint innodb_btree_page_reorganize;	/*!< btr_n_page_reorganize */
 	ulint innodb_btree_page_split;		/*!< btr_n_page_split */
 	ulint innodb_btree_page_merge;		/*!< btr_n_page_merge */
@@ -878,6 +1086,7 @@ struct export_var_struct{
 	ib_uint64_t innodb_trx_max_id;		/*!< trx_sys->max_trx_id */
 	ib_uint64_t innodb_purge_trx_no;	/*!< purge_sys->purge_trx_no */
 	ib_uint64_t innodb_purge_undo_no;	/*!< purge_sys->purge_undo_no */
+	ib_uint64_t innodb_purge_worker_records;/*!< purge_sys->n_worker_recs */
 	ulint innodb_thread_concurrency_active;	/*!< srv_conc_n_threads */
 	ulint innodb_thread_concurrency_waiting;/*!< srv_conc_n_waiting_threads */
 	ulint innodb_btree_row_searches;        /*!< btr_cur_n_non_sea */
@@ -885,6 +1094,12 @@ struct export_var_struct{
 	ib_int64_t innodb_mysql_master_log_pos;	/*!< Master binlog file position. */
 	char innodb_mysql_master_log_name[TRX_SYS_MYSQL_LOG_NAME_LEN + 1];
 						/*!< Master binlog file name. */
+	char innodb_buffer_pool_dump_status[BUF_DUMP_STATUS_LEN];
+						/*!< Buffer pool dump status */
+	char innodb_buffer_pool_load_status[BUF_DUMP_STATUS_LEN];
+						/*!< Buffer pool load status */
+	char innodb_buffer_pool_resize_status[BUF_RESIZE_STATUS_LEN];
+						/*!< Buffer pool resize status */
 #ifdef UNIV_DEBUG
 	ulint innodb_purge_trx_id_age;		/*!< max_trx_id - purged trx_id */
 	ulint innodb_purge_view_trx_id_age;	/*!< rw_max_trx_id
@@ -908,7 +1123,7 @@ struct srv_sys_struct{
 extern ulint	srv_n_threads_active[];
 #else /* !UNIV_HOTBACKUP */
 # define srv_use_adaptive_hash_indexes		FALSE
-# define srv_use_checksums			TRUE
+# define srv_checksum_algorithm			SRV_CHECKSUM_ALGORITHM_INNODB
 # define srv_use_native_aio			FALSE
 # define srv_force_recovery			0UL
 # define srv_set_io_thread_op_info(t,info)	((void) 0)
@@ -29,6 +29,12 @@ Created 10/10/1995 Heikki Tuuri
 #include "univ.i"
 #include "ut0byte.h"
 
+#ifdef __WIN__
+#define SRV_PATH_SEPARATOR	'\\'
+#else
+#define SRV_PATH_SEPARATOR	'/'
+#endif
+
 /*********************************************************************//**
 Normalizes a directory path for Windows: converts slashes to backslashes. */
 UNIV_INTERN
@@ -71,6 +77,18 @@ srv_add_path_separator_if_needed(
 /*=============================*/
 	char*	str);	/*!< in: null-terminated character string */
 #ifndef UNIV_HOTBACKUP
+/*********************************************************************//**
+Builds the path of an undo tablespace file, or of a file that belongs to
+an undo tablespace, in innodb_undo_directory. */
+UNIV_INTERN
+void
+srv_undo_file_path(
+/*===============*/
+	char*		path,		/*!< out: path of the file */
+	ulint		size,		/*!< in: size of path */
+	ulint		space_id,	/*!< in: undo tablespace id */
+	const char*	suffix);	/*!< in: "" for the tablespace
+					file itself */
 /****************************************************************//**
 Starts Innobase and creates a new database if database files
 are not found and the user wants.
@@ -100,6 +118,9 @@ extern	ibool	srv_have_fullfsync;
 extern	ibool	srv_is_being_started;
 /** TRUE if the server was successfully started */
 extern	ibool	srv_was_started;
+/** Id of the undo tablespace whose truncation was interrupted and is
+completed at the end of the startup, or ULINT_UNDEFINED */
+extern	ulint	srv_undo_space_to_truncate;
 /** TRUE if the server is being started, before rolling back any
 incomplete transactions */
 extern	ibool	srv_startup_is_before_trx_rollback_phase;
@@ -41,6 +41,13 @@ typedef struct sync_array_struct	sync_array_t;
 #define SYNC_ARRAY_MUTEX	2	/*!< protected by mutex_t */
 /* @} */
 
+/** The wait arrays for the implementation of the database's own mutexes
+and read-write locks, sync_array_size of them */
+extern sync_array_t**	sync_wait_array;
+
+/** Number of wait arrays */
+extern ulint		sync_array_size;
+
 /*******************************************************************//**
 Creates a synchronization wait array. It is protected by a mutex
 which is automatically reserved when the functions operating on it
@@ -63,13 +70,13 @@ sync_array_free(
 /*============*/
 	sync_array_t*	arr);	/*!< in, own: sync wait array */
 /******************************************************************//**
-Reserves a wait array cell for waiting for an object.
-The event of the cell is reset to nonsignalled state. */
+Reserves a wait array cell for waiting for an object, in one of the wait
+arrays. The event of the cell is reset to nonsignalled state.
+@return	the wait array of the reserved cell */
 UNIV_INTERN
-void
-sync_array_reserve_cell(
-/*====================*/
-	sync_array_t*	arr,	/*!< in: wait array */
+sync_array_t*
+sync_array_get_and_reserve_cell(
+/*============================*/
 	void*		object, /*!< in: pointer to the object to wait for */
 	ulint		type,	/*!< in: lock request type */
 	const char*	file,	/*!< in: file where requested */
@@ -99,9 +106,8 @@ sync_array_free_cell(
 Note that one of the wait objects was signalled. */
 UNIV_INTERN
 void
-sync_array_object_signalled(
-/*========================*/
-	sync_array_t*	arr);	/*!< in: wait array */
+sync_array_object_signalled(void);
+/*=============================*/
 /**********************************************************************//**
 If the wakeup algorithm does not work perfectly at semaphore relases,
 this function will do the waking (see the comment in mutex_exit). This
@@ -130,13 +136,26 @@ sync_array_validate(
 /*================*/
 	sync_array_t*	arr);	/*!< in: sync wait array */
 /**********************************************************************//**
-Prints info of the wait array. */
+Prints info of the wait arrays. */
+UNIV_INTERN
+void
+sync_array_print(
+/*=============*/
+	FILE*		file);	/*!< in: file where to print */
+/**********************************************************************//**
+Creates the wait arrays, innodb_sync_array_size of them. */
+UNIV_INTERN
+void
+sync_array_init(
+/*============*/
+	ulint	n_threads);	/*!< in: number of threads that may wait
+				at the same time */
+/**********************************************************************//**
+Frees the wait arrays. */
 UNIV_INTERN
 void
-sync_array_print_info(
+sync_array_close(void);
 /*==================*/
-	FILE*		file,	/*!< in: file where to print */
-	sync_array_t*	arr);	/*!< in: wait array */
 
 
 #ifndef UNIV_NONINL
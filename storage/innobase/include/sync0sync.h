@@ -78,6 +78,7 @@ extern mysql_pfs_key_t	buf_pool_zip_mutex_key;
 extern mysql_pfs_key_t	cache_last_read_mutex_key;
 extern mysql_pfs_key_t	dict_foreign_err_mutex_key;
 extern mysql_pfs_key_t	dict_sys_mutex_key;
+extern mysql_pfs_key_t	dict_stats_recalc_pool_mutex_key;
 extern mysql_pfs_key_t	file_format_max_mutex_key;
 extern mysql_pfs_key_t	fil_system_mutex_key;
 extern mysql_pfs_key_t	flush_list_mutex_key;
@@ -85,17 +86,26 @@ extern mysql_pfs_key_t	hash_table_mutex_key;
 extern mysql_pfs_key_t	ibuf_bitmap_mutex_key;
 extern mysql_pfs_key_t	ibuf_mutex_key;
 extern mysql_pfs_key_t	ibuf_pessimistic_insert_mutex_key;
+extern mysql_pfs_key_t	index_online_log_key;
+extern mysql_pfs_key_t	index_zip_pad_mutex_key;
 extern mysql_pfs_key_t	log_sys_mutex_key;
 extern mysql_pfs_key_t	log_flush_order_mutex_key;
+extern mysql_pfs_key_t	log_write_mutex_key;
+extern mysql_pfs_key_t	log_flush_mutex_key;
 extern mysql_pfs_key_t	kernel_mutex_key;
+extern mysql_pfs_key_t	lock_sys_mutex_key;
+extern mysql_pfs_key_t	lock_sys_wait_mutex_key;
 # ifdef UNIV_MEM_DEBUG
 extern mysql_pfs_key_t	mem_hash_mutex_key;
 # endif /* UNIV_MEM_DEBUG */
 extern mysql_pfs_key_t	mem_pool_mutex_key;
 extern mysql_pfs_key_t	mutex_list_mutex_key;
+extern mysql_pfs_key_t	page_cleaner_mutex_key;
+extern mysql_pfs_key_t	page_zip_stat_per_index_mutex_key;
 extern mysql_pfs_key_t	purge_sys_bh_mutex_key;
 extern mysql_pfs_key_t	recv_sys_mutex_key;
 extern mysql_pfs_key_t	rseg_mutex_key;
+extern mysql_pfs_key_t	row_merge_par_mutex_key;
 # ifdef UNIV_SYNC_DEBUG
 extern mysql_pfs_key_t	rw_lock_debug_mutex_key;
 # endif /* UNIV_SYNC_DEBUG */
@@ -110,6 +120,8 @@ extern mysql_pfs_key_t	syn_arr_mutex_key;
 extern mysql_pfs_key_t	sync_thread_mutex_key;
 # endif /* UNIV_SYNC_DEBUG */
 extern mysql_pfs_key_t	trx_doublewrite_mutex_key;
+extern mysql_pfs_key_t	trx_mutex_key;
+extern mysql_pfs_key_t	trx_sys_mutex_key;
 extern mysql_pfs_key_t	trx_undo_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
@@ -441,7 +453,7 @@ except for data dictionary latches. */
 	(!sync_thread_levels_nonempty_gen(TRUE))
 /******************************************************************//**
 Checks if the level array for the current thread is empty,
-except for the btr_search_latch.
+except for the adaptive hash index latches.
 @return	a latch, or NULL if empty except the exceptions specified below */
 UNIV_INTERN
 void*
@@ -449,7 +461,8 @@ sync_thread_levels_nonempty_trx(
 /*============================*/
 	ibool	has_search_latch)
 				/*!< in: TRUE if and only if the thread
-				is supposed to hold btr_search_latch */
+				is supposed to hold an adaptive hash
+				index latch */
 	__attribute__((warn_unused_result));
 
 /******************************************************************//**
@@ -591,10 +604,26 @@ V
 File system pages
 |
 V
-Kernel mutex				If a kernel operation needs a file
-|					page allocation, it must reserve the
-|					fsp x-latch before acquiring the kernel
-|					mutex.
+Lock system wait mutex			Protects the table of threads
+|					suspended in a lock wait.
+V
+Lock system mutex			Protects the lock hash table, the
+|					table lock queues and the lock lists
+|					and lock wait state of transactions.
+V
+Transaction mutex			Protects the query thread and signal
+|					state of a single transaction. Only
+|					one transaction mutex may be held at
+|					a time.
+V
+Transaction system mutex		Protects the transaction lists, the
+|					read views and the rollback segment
+|					array. If it needs a file page
+|					allocation, it must reserve the fsp
+|					x-latch before acquiring the mutex.
+V
+Kernel mutex				Protects the server thread tables
+|					and the task queue.
 V
 Search system mutex
 |
@@ -607,6 +636,10 @@ Log mutex
 Any other latch
 |
 V
+File system latch			Protects the tablespace hash table
+|					and file chains that fil_io() reads
+|					without the file system mutex.
+V
 Memory pool mutex */
 
 /* Latching order levels */
@@ -635,6 +668,8 @@ or row lock! */
 					key checks reserve this in S-mode */
 #define SYNC_DICT		1000
 #define SYNC_DICT_AUTOINC_MUTEX	999
+#define SYNC_DICT_TABLE_HASH	998	/* dict_sys->table_hash_latch */
+#define SYNC_STATS_AUTO_RECALC	997
 #define SYNC_DICT_HEADER	995
 #define SYNC_IBUF_HEADER	914
 #define SYNC_IBUF_PESS_INSERT_MUTEX 912
@@ -649,6 +684,7 @@ or row lock! */
 #define SYNC_RSEG_HEADER_NEW	591
 #define SYNC_RSEG_HEADER	590
 #define SYNC_TRX_UNDO_PAGE	570
+#define SYNC_INDEX_ONLINE_LOG	501	/* index->online_log->mutex */
 #define SYNC_EXTERN_STORAGE	500
 #define	SYNC_FSP		400
 #define	SYNC_FSP_PAGE		395
@@ -663,11 +699,18 @@ or row lock! */
 /*------------------------------------- MySQL query cache mutex */
 /*------------------------------------- MySQL binlog mutex */
 /*-------------------------------*/
-#define	SYNC_KERNEL		300
+#define SYNC_LOCK_WAIT_SYS	301
+#define SYNC_LOCK_SYS		300
 #define SYNC_REC_LOCK		299
 #define	SYNC_TRX_LOCK_HEAP	298
+#define SYNC_TRX		297
+#define SYNC_TRX_SYS		296
+#define	SYNC_KERNEL		295
 #define SYNC_TRX_SYS_HEADER	290
 #define	SYNC_PURGE_QUEUE	200
+#define	SYNC_PAGE_CLEANER	180
+#define SYNC_LOG_WRITE		175	/* log_sys->write_mutex */
+#define SYNC_LOG_FLUSH		172	/* log_sys->flush_mutex */
 #define SYNC_LOG		170
 #define SYNC_LOG_FLUSH_ORDER	147
 #define SYNC_RECV		168
@@ -683,6 +726,7 @@ or row lock! */
 #define	SYNC_BUF_FLUSH_LIST	145	/* Buffer flush list mutex */
 #define SYNC_DOUBLEWRITE	140
 #define	SYNC_ANY_LATCH		135
+#define	SYNC_FIL_SYSTEM_LATCH	134	/* fil_system->latch */
 #define	SYNC_MEM_HASH		131
 #define	SYNC_MEM_POOL		130
 
@@ -747,11 +791,6 @@ struct mutex_struct {
 #endif
 };
 
-/** The global array of wait cells for implementation of the databases own
-mutexes and read-write locks. */
-extern sync_array_t*	sync_primary_wait_array;/* Appears here for
-						debugging purposes only! */
-
 /** Constant determining how long spin wait is continued before suspending
 the thread. A value 600 rounds on a 1995 100 MHz Pentium seems to correspond
 to 20 microseconds. */
@@ -77,6 +77,28 @@ UNIV_INTERN
 void
 trx_purge_sys_close(void);
 /*======================*/
+/********************************************************************//**
+Checks if the truncation of an undo tablespace was interrupted, by
+looking for the log file that is kept while the truncation runs.
+@return	TRUE if the truncation of the tablespace must be completed */
+UNIV_INTERN
+ibool
+trx_purge_undo_trunc_log_exists(
+/*============================*/
+	ulint	space_id);	/*!< in: undo tablespace id */
+/********************************************************************//**
+Truncates an undo tablespace to its initial size and recreates the
+headers of its rollback segments, which must not be used by any
+transaction and must have no history left. A log file is kept while
+the truncation runs, so that it is completed at the next startup if
+the server is killed in between. The rollback segments of the tablespace
+are assigned to new transactions again when it returns TRUE.
+@return	TRUE if the tablespace was truncated */
+UNIV_INTERN
+ibool
+trx_purge_truncate_undo_space(
+/*==========================*/
+	ulint	space_id);	/*!< in: undo tablespace id */
 /************************************************************************
 Adds the update undo log as the first log in the history list. Removes the
 update undo log segment from the rseg slot if it is too big for reuse. */
@@ -88,35 +110,24 @@ trx_purge_add_update_undo_to_history(
 	page_t*	undo_page,	/*!< in: update undo log header page,
 				x-latched */
 	mtr_t*	mtr);		/*!< in: mtr */
-/********************************************************************//**
-Fetches the next undo log record from the history list to purge. It must be
-released with the corresponding release function.
-@return copy of an undo log record or pointer to trx_purge_dummy_rec,
-if the whole undo log can skipped in purge; NULL if none left */
-UNIV_INTERN
-trx_undo_rec_t*
-trx_purge_fetch_next_rec(
-/*=====================*/
-	roll_ptr_t*	roll_ptr,/*!< out: roll pointer to undo record */
-	trx_undo_inf_t** cell,	/*!< out: storage cell for the record in the
-				purge array */
-	mem_heap_t*	heap);	/*!< in: memory heap where copied */
-/*******************************************************************//**
-Releases a reserved purge undo record. */
-UNIV_INTERN
-void
-trx_purge_rec_release(
-/*==================*/
-	trx_undo_inf_t*	cell);	/*!< in: storage cell */
 /*******************************************************************//**
-This function runs a purge batch.
+This function runs a purge batch. The undo log records of the batch are
+fetched by the calling thread, and split by table between the calling
+thread and the purge worker threads, which purge them in parallel.
 @return	number of undo log pages handled in the batch */
 UNIV_INTERN
 ulint
 trx_purge(
 /*======*/
-	ulint	limit);		/*!< in: the maximum number of records to
-				purge in one batch */
+	ulint	limit);		/*!< in: the maximum number of undo log
+				pages to purge in one batch */
+/*******************************************************************//**
+Called by a purge worker thread when it has executed a purge query
+thread of the current batch. */
+UNIV_INTERN
+void
+trx_purge_worker_done(void);
+/*=======================*/
 /******************************************************************//**
 Prints information of the purge system to stderr. */
 UNIV_INTERN
@@ -124,17 +135,43 @@ void
 trx_purge_sys_print(void);
 /*======================*/
 
+/** An undo log record of a purge batch, assigned to a purge query graph */
+struct trx_purge_rec_struct{
+	trx_undo_rec_t*	undo_rec;	/*!< copy of the undo log record, or
+					&trx_purge_dummy_rec */
+	roll_ptr_t	roll_ptr;	/*!< roll pointer to the undo log
+					record */
+};
+
 /** The control structure used in the purge operation */
 struct trx_purge_struct{
 	ulint		state;		/*!< Purge system state */
-	sess_t*		sess;		/*!< System session running the purge
-					query */
+	ulint		n_threads;	/*!< Number of purge query graphs a
+					batch is split across: one for the
+					thread running trx_purge() and one
+					for each purge worker thread */
+	sess_t**	sess;		/*!< System sessions running the purge
+					queries, n_threads of them */
 	trx_t*		trx;		/*!< System transaction running the
-					purge
-					query: this trx is not in the trx list
-					of the trx system and it never ends */
-	que_t*		query;		/*!< The query graph which will do the
-					parallelized purge operation */
+					purge query of the thread calling
+					trx_purge(): this trx is not in the
+					trx list of the trx system and it
+					never ends */
+	que_t**		query;		/*!< The query graphs which do the
+					parallelized purge operation, one per
+					purge thread, each with its own purge
+					transaction; query[0] is run by the
+					thread calling trx_purge() */
+	ulint		n_submitted;	/*!< Number of query graphs handed to
+					the purge worker threads in the
+					current batch; protected by the
+					kernel mutex */
+	ulint		n_completed;	/*!< Number of those graphs that the
+					worker threads have completed;
+					protected by the kernel mutex */
+	os_event_t	event;		/*!< Set when the purge worker threads
+					have completed all the graphs
+					submitted in the current batch */
 	rw_lock_t	latch;		/*!< The latch protecting the purge
 					view.  A purge operation must acquire
 					an x-latch here for the instant at which
@@ -147,6 +184,10 @@ struct trx_purge_struct{
 					pages processed in purge */
 	ulonglong	handle_limit;	/*!< Target of how many pages to get
 					processed in the current purge */
+	ulonglong	n_worker_recs;	/*!< Number of undo log records
+					handled by the purge worker threads;
+					updated by the thread running
+					trx_purge() after a batch */
 	/*------------------------------*/
 	/* The following two fields form the 'purge pointer' which advances
 	during a purge, and which is used in history list truncation */
@@ -178,17 +219,22 @@ struct trx_purge_struct{
 					the next record to purge belongs */
 	ulint		hdr_offset;	/*!< Header byte offset on the page */
 	/*-----------------------------*/
-	trx_undo_arr_t*	arr;		/*!< Array of transaction numbers and
-					undo numbers of the undo records
-					currently under processing in purge */
-	mem_heap_t*	heap;		/*!< Temporary storage used during a
-					purge: can be emptied after purge
-					completes */
+	mem_heap_t*	batch_heap;	/*!< Storage for the undo log records
+					of the current purge batch */
 	/*-----------------------------*/
 	ib_bh_t*	ib_bh;		/*!< Binary min-heap, ordered on
 					rseg_queue_t::trx_no. It is protected
 					by the bh_mutex */
 	mutex_t		bh_mutex;	/*!< Mutex protecting ib_bh */
+	/*-----------------------------*/
+	ulint		undo_trunc_space;/*!< Id of the undo tablespace that
+					is marked for truncation, or
+					ULINT_UNDEFINED; its rollback
+					segments are not assigned to new
+					transactions */
+	ulint		undo_trunc_last;/*!< Id of the undo tablespace that
+					was last marked for truncation,
+					or 0 */
 };
 
 #define TRX_PURGE_ON		1	/* purge operation is running */
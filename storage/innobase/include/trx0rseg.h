@@ -128,8 +128,30 @@ trx_rseg_mem_free(
 Creates a rollback segment. */
 UNIV_INTERN
 trx_rseg_t*
-trx_rseg_create(void);
-/*==================*/
+trx_rseg_create(
+/*============*/
+	ulint	space);		/*!< in: space id of the segment header,
+				TRX_SYS_SPACE or an undo tablespace */
+/*********************************************************************
+Recreates the header of a rollback segment in an undo tablespace that
+has just been truncated, and empties the memory object of the segment. */
+UNIV_INTERN
+void
+trx_rseg_reinit(
+/*============*/
+	trx_rseg_t*	rseg);		/*!< in/out: rollback segment that
+					is not used by any transaction */
+/*********************************************************************
+Reads the ids of the undo tablespaces that hold rollback segments from
+the trx system header.
+@return	number of undo tablespaces */
+UNIV_INTERN
+ulint
+trx_rseg_get_n_undo_tablespaces(
+/*============================*/
+	ulint*	space_ids);	/*!< out: ids of the undo tablespaces,
+				in ascending order; TRX_SYS_N_RSEGS
+				elements */
 
 /* Number of undo log slots in a rollback segment file copy */
 #define TRX_RSEG_N_SLOTS	(UNIV_PAGE_SIZE / 16)
@@ -177,6 +199,12 @@ struct trx_rseg_struct{
 	ibool		last_del_marks;	/*!< TRUE if the last not yet purged log
 					needs purging */
 	/*--------------------------------------------------------*/
+	ibool		skip_allocation;/*!< TRUE if the segment is not
+					assigned to new transactions,
+					because its undo tablespace is
+					being truncated; protected by the
+					trx_sys mutex */
+	/*--------------------------------------------------------*/
 	UT_LIST_NODE_T(trx_rseg_t) rseg_list;
 					/* the list of the rollback segment
 					memory objects */
@@ -80,12 +80,23 @@ extern ibool			trx_sys_multiple_tablespace_format;
 
 /****************************************************************//**
 Creates the doublewrite buffer to a new InnoDB installation. The header of the
-doublewrite buffer is placed on the trx system header page. */
+doublewrite buffer is placed on the trx system header page.
+@return DB_SUCCESS or DB_ERROR */
 UNIV_INTERN
-void
+ulint
 trx_sys_create_doublewrite_buf(void);
 /*================================*/
 /****************************************************************//**
+Opens the doublewrite file (innodb_doublewrite_file), creating it if it
+does not exist, and extends it to hold a slot for each buffer pool
+instance and flush type after its header page. Must be called at a
+database startup before the doublewrite buffer is initialized.
+@return DB_SUCCESS or DB_ERROR */
+UNIV_INTERN
+ulint
+trx_doublewrite_file_create(void);
+/*=============================*/
+/****************************************************************//**
 At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
 upgrading to an InnoDB version which supports multiple tablespaces, then this
@@ -113,6 +124,29 @@ ibool
 trx_doublewrite_page_inside(
 /*========================*/
 	ulint	page_no);	/*!< in: page number */
+#ifndef UNIV_HOTBACKUP
+/****************************************************************//**
+Returns the doublewrite buffer slot that buffers the writes of a flush
+batch of the given type in the given buffer pool instance.
+@return doublewrite slot */
+UNIV_INTERN
+trx_doublewrite_slot_t*
+trx_doublewrite_get_slot(
+/*=====================*/
+	ulint		instance_no,	/*!< in: buffer pool instance */
+	enum buf_flush	flush_type);	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+/****************************************************************//**
+Writes the pages buffered in a doublewrite slot to the part of the
+doublewrite file or of the doublewrite blocks in the system tablespace
+reserved for the slot, and flushes them to disk. The caller must own
+slot->mutex. */
+UNIV_INTERN
+void
+trx_doublewrite_write_slot(
+/*=======================*/
+	trx_doublewrite_slot_t*	slot);	/*!< in: doublewrite slot */
+#endif /* !UNIV_HOTBACKUP */
 /***************************************************************//**
 Checks if a page address is the trx sys header page.
 @return	TRUE if trx sys header page */
@@ -123,8 +157,16 @@ trx_sys_hdr_page(
 	ulint	space,	/*!< in: space */
 	ulint	page_no);/*!< in: page number */
 /*****************************************************************//**
-Creates and initializes the central memory structures for the transaction
-system. This is called when the database is started. */
+Creates the trx_sys memory object and its mutex. This is called when the
+database is started, before the trx system header page or the rollback
+segment slots in it are accessed. */
+UNIV_INTERN
+void
+trx_sys_mem_create(void);
+/*====================*/
+/*****************************************************************//**
+Initializes the central memory structures for the transaction system.
+This is called when the database is started, after trx_sys_mem_create(). */
 UNIV_INTERN
 void
 trx_sys_init_at_db_start(void);
@@ -222,6 +264,14 @@ UNIV_INLINE
 trx_id_t
 trx_sys_get_new_trx_id(void);
 /*========================*/
+/*****************************************************************//**
+Gets the value of trx_sys->max_trx_id. The caller must not own the
+trx_sys mutex.
+@return	the smallest trx id that has not been assigned yet */
+UNIV_INLINE
+trx_id_t
+trx_sys_get_max_trx_id(void);
+/*========================*/
 
 #ifdef UNIV_DEBUG
 /* Flag to control TRX_RSEG_N_SLOTS behavior debugging. */
@@ -257,11 +307,21 @@ trx_get_on_id(
 /*==========*/
 	trx_id_t	trx_id);/*!< in: trx id to search for */
 /****************************************************************//**
-Returns the minumum trx id in trx list. This is the smallest id for which
-the trx can possibly be active. (But, you must look at the trx->conc_state to
-find out if the minimum trx id transaction itself is active, or already
-committed.)
-@return	the minimum trx id, or trx_sys->max_trx_id if the trx list is empty */
+Looks up a trx id in trx_sys->descriptors.
+@return	pointer to the array cell, or NULL if the id is not in the array */
+UNIV_INLINE
+trx_id_t*
+trx_find_descriptor(
+/*================*/
+	const trx_id_t*	descriptors,	/*!< in: sorted array of trx ids */
+	ulint		n_descr,	/*!< in: number of ids in the array */
+	trx_id_t	trx_id);	/*!< in: trx id to search for */
+/****************************************************************//**
+Returns the minumum id of the active read-write transactions. This is the
+smallest id for which the trx can possibly be active and have modified
+records.
+@return	the minimum trx id, or trx_sys->max_trx_id if there are no active
+read-write transactions */
 UNIV_INLINE
 trx_id_t
 trx_list_get_min_trx_id(void);
@@ -455,6 +515,7 @@ UNIV_INTERN
 void
 trx_sys_create_rsegs(
 /*=================*/
+	ulint	n_spaces,	/*!< number of undo tablespaces */
 	ulint	n_rsegs);	/*!< number of rollback segments to create */
 
 /* The automatically created system rollback segment has this id */
@@ -573,6 +634,24 @@ FIL_PAGE_ARCH_LOG_NO_OR_SPACE_NO. */
 
 /** Size of the doublewrite block in pages */
 #define TRX_SYS_DOUBLEWRITE_BLOCK_SIZE	FSP_EXTENT_SIZE
+
+/** Maximum number of slots the two doublewrite blocks in the system
+tablespace are divided into */
+#define TRX_SYS_DOUBLEWRITE_MAX_SLOTS	8
+/* @} */
+
+/** Doublewrite file (innodb_doublewrite_file) */
+/* @{ */
+/** The first page of the doublewrite file is a header page; the slots
+follow it, TRX_DOUBLEWRITE_FILE_SLOT_SIZE pages per slot */
+#define TRX_DOUBLEWRITE_FILE_MAGIC	0	/*!< contains
+						TRX_SYS_DOUBLEWRITE_MAGIC_N */
+#define TRX_DOUBLEWRITE_FILE_PAGE_SIZE	4	/*!< UNIV_PAGE_SIZE */
+#define TRX_DOUBLEWRITE_FILE_N_PAGES	8	/*!< number of pages
+						following the header page */
+
+/** Size of a doublewrite file slot in pages */
+#define TRX_DOUBLEWRITE_FILE_SLOT_SIZE	TRX_SYS_DOUBLEWRITE_BLOCK_SIZE
 /* @} */
 
 /** File format tag */
@@ -594,29 +673,55 @@ identifier is added to this 64-bit constant. */
 /* @} */
 
 #ifndef UNIV_HOTBACKUP
-/** Doublewrite control struct */
-struct trx_doublewrite_struct{
+/** Doublewrite slot: buffers one batch of page writes of the buffer
+pool instances and flush types that map to it. Each slot is written and
+flushed to disk independently of the others. */
+struct trx_doublewrite_slot_struct{
 	mutex_t	mutex;		/*!< mutex protecting the first_free field and
 				write_buf */
-	ulint	block1;		/*!< the page number of the first
-				doublewrite block (64 pages) */
-	ulint	block2;		/*!< page number of the second block */
+	ulint	start;		/*!< position of the first page of the
+				slot in the doublewrite blocks, or in
+				the doublewrite file after its header
+				page */
+	ulint	n_pages;	/*!< size of the slot in pages */
 	ulint	first_free;	/*!< first free position in write_buf measured
 				in units of UNIV_PAGE_SIZE */
 	byte*	write_buf;	/*!< write buffer used in writing to the
 				doublewrite buffer, aligned to an
 				address divisible by UNIV_PAGE_SIZE
 				(which is required by Windows aio) */
-	byte*	write_buf_unaligned;
-				/*!< pointer to write_buf, but unaligned */
 	buf_page_t**
 		buf_block_arr;	/*!< array to store pointers to the buffer
 				blocks which have been cached to write_buf */
 };
 
-/** The transaction system central memory data structure; protected by the
-kernel mutex */
+/** Doublewrite control struct */
+struct trx_doublewrite_struct{
+	ulint	block1;		/*!< the page number of the first
+				doublewrite block (64 pages) */
+	ulint	block2;		/*!< page number of the second block */
+	ibool	use_file;	/*!< TRUE if the slots are in the
+				doublewrite file instead of the
+				doublewrite blocks */
+	os_file_t file;		/*!< the doublewrite file, if use_file */
+	ulint	n_slots;	/*!< number of slots */
+	trx_doublewrite_slot_t*
+		slots;		/*!< array of n_slots slots */
+	byte*	write_buf_unaligned;
+				/*!< memory of the write buffers of
+				the slots, unaligned */
+	buf_page_t**
+		buf_block_arr;	/*!< memory of the buf_block_arr of
+				the slots */
+};
+
+/** The transaction system central memory data structure; protected by
+trx_sys->mutex */
 struct trx_sys_struct{
+	mutex_t		mutex;		/*!< mutex protecting most fields in
+					this structure, except when noted
+					otherwise, and the conc_state of
+					the transactions */
 	trx_id_t	max_trx_id;	/*!< The smallest number not yet
 					assigned as a transaction id or
 					transaction number */
@@ -629,22 +734,61 @@ struct trx_sys_struct{
 					for MySQL */
 	UT_LIST_BASE_NODE_T(trx_rseg_t) rseg_list;
 					/*!< List of rollback segment
-					objects */
+					objects; modified while holding
+					the mutex at startup, before the
+					purge threads and user transactions
+					start, and at shutdown: purge may
+					read it without the mutex */
 	trx_rseg_t*	latest_rseg;	/*!< Latest rollback segment in the
 					round-robin assignment of rollback
 					segments to transactions */
 	trx_rseg_t*	rseg_array[TRX_SYS_N_RSEGS];
 					/*!< Pointer array to rollback
-					segments; NULL if slot not in use */
+					segments; NULL if slot not in use.
+					Like rseg_list, a slot is only set
+					at startup: trx_rseg_get_on_id()
+					reads it without the mutex */
 	ulint		rseg_history_len;/*!< Length of the TRX_RSEG_HISTORY
 					list (update undo logs for committed
-					transactions), protected by
-					rseg->mutex */
+					transactions); modified while
+					holding the mutex */
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
 					/*!< List of read views sorted
 					on trx no, biggest first */
+	trx_id_t*	descriptors;	/*!< Array of trx ids of the active
+					and prepared read-write
+					transactions, sorted in ascending
+					order; read views are copied from
+					this array. Autocommit read-only
+					transactions are not included. */
+	ulint		descr_n_max;	/*!< Number of cells allocated in
+					descriptors */
+	ulint		descr_n_used;	/*!< Number of cells used in
+					descriptors */
+	UT_LIST_BASE_NODE_T(trx_t) trx_serial_list;
+					/*!< List of transactions that have
+					been assigned a serialisation number
+					(trx->no) but have not yet been
+					committed in memory, sorted on
+					trx->no, smallest first */
 };
 
+/** Test if trx_sys->mutex is owned. */
+#define trx_sys_mutex_own() mutex_own(&trx_sys->mutex)
+
+/** Acquire the trx_sys->mutex. */
+#define trx_sys_mutex_enter() do {		\
+	mutex_enter(&trx_sys->mutex);		\
+} while (0)
+
+/** Release the trx_sys->mutex. */
+#define trx_sys_mutex_exit() do {		\
+	mutex_exit(&trx_sys->mutex);		\
+} while (0)
+
+/** Initial number of cells in trx_sys->descriptors */
+#define TRX_DESCR_ARRAY_INITIAL_SIZE	1000
+
 /** When a trx id which is zero modulo this number (which must be a power of
 two) is assigned, the field TRX_SYS_TRX_ID_STORE on the transaction system
 page is updated */
@@ -34,6 +34,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "usr0types.h"
 #include "que0types.h"
 #include "mem0mem.h"
+#include "sync0rw.h"
 #include "read0types.h"
 #include "trx0xa.h"
 #include "ut0vec.h"
@@ -42,10 +43,10 @@ Created 3/26/1996 Heikki Tuuri
 extern sess_t*	trx_dummy_sess;
 
 /** Number of transactions currently allocated for MySQL: protected by
-the kernel mutex */
+the trx_sys mutex */
 extern ulint	trx_n_mysql_transactions;
 /** Number of transactions currently in the XA PREPARED state: protected by
-the kernel mutex */
+the trx_sys mutex */
 extern ulint	trx_n_prepared;
 
 /********************************************************************//**
@@ -174,14 +175,25 @@ trx_start_if_not_started(
 	trx_t*	trx);	/*!< in: transaction */
 /*************************************************************//**
 Starts the transaction if it is not yet started. Assumes we have reserved
-the kernel mutex! */
+the trx_sys mutex! */
 UNIV_INLINE
 void
 trx_start_if_not_started_low(
 /*=========================*/
 	trx_t*	trx);	/*!< in: transaction */
 /****************************************************************//**
-Commits a transaction. */
+Makes a read-only transaction read-write. This is only needed if MySQL
+failed to announce that a statement will lock or modify a table, before
+the transaction was started. The transaction gets a new id, so that the
+read views created while it was read-only cannot see its changes. */
+UNIV_INTERN
+void
+trx_set_rw_mode(
+/*============*/
+	trx_t*	trx);	/*!< in/out: transaction */
+/****************************************************************//**
+Commits a transaction. The caller must own the trx mutex, which is
+released and reacquired. */
 UNIV_INTERN
 void
 trx_commit_off_kernel(
@@ -349,7 +361,7 @@ trx_commit_step(
 
 /**********************************************************************//**
 Prints info about a transaction to the given file. The caller must own the
-kernel mutex. */
+lock mutex. */
 UNIV_INTERN
 void
 trx_print(
@@ -473,6 +485,14 @@ rolling back after a database recovery */
 struct trx_struct{
 	ulint		magic_n;
 
+	mutex_t		mutex;		/*!< mutex protecting the query
+					thread and signal state of the
+					transaction: que_state, graph,
+					n_active_thrs, signals,
+					reply_signals, wait_thrs and the
+					state of the query threads of
+					the transaction */
+
 	/* These fields are not protected by any mutex. */
 	const char*	op_info;	/*!< English text describing the
 					current operation, or an empty
@@ -480,7 +500,8 @@ struct trx_struct{
 	ulint		conc_state;	/*!< state of the trx from the point
 					of view of concurrency control:
 					TRX_ACTIVE, TRX_COMMITTED_IN_MEMORY,
-					... */
+					...; changed only when holding
+					the trx_sys mutex */
 	/*------------------------------*/
 	/* MySQL has a transaction coordinator to coordinate two phase
        	commit between multiple storage engines and the binary log. When
@@ -490,10 +511,6 @@ struct trx_struct{
 				       	transaction has been registered with
 				       	the coordinator using the XA API, and
 				       	is set to 0 after commit or rollback. */
-	unsigned	owns_prepare_mutex:1;/* 1 if owns prepare mutex, if
-					this is set to 1 then registered should
-					also be set to 1. This is used in the
-					XA code */
 	/*------------------------------*/
 	ulint		isolation_level;/* TRX_ISO_REPEATABLE_READ, ... */
 	ulint		check_foreigns;	/* normally TRUE, but if the user
@@ -512,12 +529,11 @@ struct trx_struct{
 					FALSE, one can save CPU time and about
 					150 bytes in the undo log size as then
 					we skip XA steps */
-	ulint		flush_log_later;/* In 2PC, we hold the
-					prepare_commit mutex across
-					both phases. In that case, we
-					defer flush of the logs to disk
-					until after we release the
-					mutex. */
+	ulint		flush_log_later;/* In 2PC, we commit in binlog
+					order. In that case, we defer
+					flush of the logs to disk until
+					after we let the next transaction
+					in binlog order commit. */
 	ulint		must_flush_log_later;/* this flag is set to TRUE in
 					trx_commit_off_kernel() if
 					flush_log_later was TRUE, and there
@@ -526,10 +542,16 @@ struct trx_struct{
 					in trx_commit_complete_for_mysql() */
 	ulint		duplicates;	/*!< TRX_DUP_IGNORE | TRX_DUP_REPLACE */
 	ulint		has_search_latch;
-					/* TRUE if this trx has latched the
-					search system latch in S-mode */
-	ulint		deadlock_mark;	/*!< a mark field used in deadlock
-					checking algorithm.  */
+					/* TRUE if this trx has latched an
+					adaptive hash index latch in S-mode */
+	rw_lock_t*	search_latch;	/*!< the adaptive hash index latch
+					that the trx holds in S-mode if
+					has_search_latch is TRUE */
+	ib_uint64_t	deadlock_mark;	/*!< a mark field used in deadlock
+					checking algorithm: equal to
+					lock_mark_counter if the
+					transaction has been searched in
+					the current deadlock search */
 	trx_dict_op_t	dict_operation;	/**< @see enum trx_dict_op */
 
 	/* Fields protected by the srv_conc_mutex. */
@@ -546,11 +568,23 @@ struct trx_struct{
 					the latch mode trx currently holds
 					on dict_operation_lock */
 
-	/* All the next fields are protected by the kernel mutex, except the
-	undo logs which are protected by undo_mutex */
+	/* The next fields are protected by the trx_sys mutex or, for the
+	query thread and signal state, by the trx mutex, except the undo
+	logs which are protected by undo_mutex */
 	ulint		is_purge;	/*!< 0=user transaction, 1=purge */
 	ulint		is_recovered;	/*!< 0=normal transaction,
 					1=recovered, must be rolled back */
+	ibool		read_only;	/*!< TRUE if the transaction is an
+					autocommit non-locking SELECT: it
+					cannot modify any data, and its id
+					is not stored in
+					trx_sys->descriptors and thus not
+					copied to any read view */
+	ulint		will_lock;	/*!< number of tables of the
+					current statement that will be
+					locked or modified; set by MySQL
+					before the transaction is started
+					and used to decide read_only */
 	ulint		que_state;	/*!< valid when conc_state
 					== TRX_ACTIVE: TRX_QUE_RUNNING,
 					TRX_QUE_LOCK_WAIT, ... */
@@ -622,12 +656,18 @@ struct trx_struct{
 	UT_LIST_NODE_T(trx_t)
 			mysql_trx_list;	/*!< list of transactions created for
 					MySQL */
+	UT_LIST_NODE_T(trx_t)
+			trx_serial_list;/*!< list node in
+					trx_sys->trx_serial_list */
+	ibool		in_trx_serial_list;
+					/*!< TRUE if the transaction is in
+					trx_sys->trx_serial_list */
 	/*------------------------------*/
 	ulint		error_state;	/*!< 0 if no error, otherwise error
 					number; NOTE That ONLY the thread
 					doing the transaction is allowed to
 					set this field: this is NOT protected
-					by the kernel mutex */
+					by the trx mutex */
 	const dict_index_t*error_info;	/*!< if the error number indicates a
 					duplicate key error, a pointer to
 					the problematic index is stored here */
@@ -659,6 +699,7 @@ struct trx_struct{
 					killed, the reply requests in the list
 					must be canceled */
 	/*------------------------------*/
+	/* The lock fields are protected by lock_sys->mutex */
 	lock_t*		wait_lock;	/*!< if trx execution state is
 					TRX_QUE_LOCK_WAIT, this points to
 					the lock request, otherwise this is
@@ -668,7 +709,9 @@ struct trx_struct{
 					for a lock, it sets this to FALSE;
 					if another transaction chooses this
 					transaction as a victim in deadlock
-					resolution, it sets this to TRUE */
+					resolution, it sets this to TRUE;
+					written when holding both the lock
+					mutex and the trx mutex */
 	time_t		wait_started;	/*!< lock wait started at this time */
 	UT_LIST_BASE_NODE_T(que_thr_t)
 			wait_thrs;	/*!< query threads belonging to this
@@ -680,12 +723,14 @@ struct trx_struct{
 	UT_LIST_BASE_NODE_T(lock_t)
 			trx_locks;	/*!< locks reserved by the transaction */
 	/*------------------------------*/
-	mem_heap_t*	global_read_view_heap;
-					/* memory heap for the global read
-					view */
 	read_view_t*	global_read_view;
 					/* consistent read view associated
 					to a transaction or NULL */
+	read_view_t*	prebuilt_view;	/*!< the most recently opened
+					global_read_view, kept after it has
+					been closed so that the next read
+					view of this trx can reuse its
+					memory, or NULL */
 	read_view_t*	read_view;	/*!< consistent read view used in the
 					transaction or NULL, this read view
 					if defined can be normal read view
@@ -748,6 +793,20 @@ struct trx_struct{
 					single operation of a
 					transaction, e.g., a parallel
 					query */
+
+/** Test if trx->mutex is owned. */
+#define trx_mutex_own(t) mutex_own(&(t)->mutex)
+
+/** Acquire the trx->mutex. */
+#define trx_mutex_enter(t) do {			\
+	mutex_enter(&(t)->mutex);		\
+} while (0)
+
+/** Release the trx->mutex. */
+#define trx_mutex_exit(t) do {			\
+	mutex_exit(&(t)->mutex);		\
+} while (0)
+
 /* Transaction concurrency states (trx->conc_state) */
 #define	TRX_NOT_STARTED		0
 #define	TRX_ACTIVE		1
@@ -48,6 +48,8 @@ typedef struct trx_struct	trx_t;
 typedef struct trx_sys_struct	trx_sys_t;
 /** Doublewrite information */
 typedef struct trx_doublewrite_struct	trx_doublewrite_t;
+/** Doublewrite buffer slot */
+typedef struct trx_doublewrite_slot_struct	trx_doublewrite_slot_t;
 /** Signal */
 typedef struct trx_sig_struct	trx_sig_t;
 /** Rollback segment */
@@ -60,6 +62,8 @@ typedef struct trx_undo_arr_struct trx_undo_arr_t;
 typedef struct trx_undo_inf_struct trx_undo_inf_t;
 /** The control structure used in the purge operation */
 typedef struct trx_purge_struct	trx_purge_t;
+/** An undo log record of a purge batch */
+typedef struct trx_purge_rec_struct	trx_purge_rec_t;
 /** Rollback command node in a query graph */
 typedef struct roll_node_struct	roll_node_t;
 /** Commit command node in a query graph */
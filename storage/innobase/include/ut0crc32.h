@@ -0,0 +1,67 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/ut0crc32.h
+CRC32 implementation
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#ifndef ut0crc32_h
+#define ut0crc32_h
+
+#include "univ.i"
+
+/********************************************************************//**
+Initializes the data structures used by ut_crc32(). Does not do any
+allocations, would not hurt if called twice, but would be pointless. */
+UNIV_INTERN
+void
+ut_crc32_init(void);
+/*===============*/
+
+/********************************************************************//**
+Calculates CRC32 (Castagnoli polynomial).
+@param ptr	- data over which to calculate CRC32.
+@param len	- data length in bytes.
+@return CRC32 (CRC-32C, using the GF(2) primitive polynomial 0x11EDC6F41,
+or 0x1EDC6F41 without the high-order bit) */
+typedef ib_uint32_t (*ib_ut_crc32_t)(const byte* ptr, ulint len);
+
+/** Pointer to the CRC32 implementation selected by ut_crc32_init():
+the SSE4.2 crc32 instruction if the CPU supports it, otherwise the
+slicing-by-8 software implementation. */
+extern ib_ut_crc32_t	ut_crc32;
+
+/** TRUE if the CPU supports the SSE4.2 crc32 instruction and ut_crc32
+uses it */
+extern ibool		ut_crc32_sse42_enabled;
+
+/********************************************************************//**
+Calculates CRC32 in software, using the slicing-by-8 algorithm. This is
+the fallback used by ut_crc32 when the CPU has no crc32 instruction.
+@return CRC32 (CRC-32C) */
+UNIV_INTERN
+ib_uint32_t
+ut_crc32_slice8(
+/*============*/
+	const byte*	buf,	/*!< in: data over which to calculate CRC32 */
+	ulint		len);	/*!< in: data length */
+
+#endif /* ut0crc32_h */
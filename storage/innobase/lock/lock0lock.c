@@ -44,14 +44,14 @@ Created 5/7/1996 Heikki Tuuri
 graph of transactions */
 #define LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK 1000000
 
-/* Restricts the recursion depth of the search we will do in the waits-for
+/* Restricts the depth of the search we will do in the waits-for
 graph of transactions */
 #define LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK 200
 
 /* When releasing transaction locks, this specifies how often we release
-the kernel mutex for a moment to give also others access to it */
+the lock mutex for a moment to give also others access to it */
 
-#define LOCK_RELEASE_KERNEL_INTERVAL	1000
+#define LOCK_RELEASE_INTERVAL		1000
 
 /* Safety margin when creating a new record lock: this many extra records
 can be inserted to the page without need to create a lock with a bigger
@@ -367,16 +367,47 @@ lock_rec_validate_page(
 /* The lock system */
 UNIV_INTERN lock_sys_t*	lock_sys	= NULL;
 
+#ifdef UNIV_PFS_MUTEX
+/* Key to register the mutexes of the lock system with
+performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_sys_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	lock_sys_wait_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
 /* We store info on the latest deadlock error to this buffer. InnoDB
 Monitor will then fetch it and print */
 UNIV_INTERN ibool	lock_deadlock_found = FALSE;
 UNIV_INTERN FILE*	lock_latest_err_file;
 
-/* Flags for recursive deadlock search */
+/** Generation of the current deadlock search, see
+trx_struct::deadlock_mark; protected by lock_sys->mutex. The search keeps
+no separate cache of visited edges: the pre-existing per-transaction
+deadlock_mark, formerly a flag that was reset before each search, holds
+the generation in which the waits of the transaction were searched. */
+static ib_uint64_t	lock_mark_counter = 0;
+
+/* Flags for deadlock search */
 #define LOCK_VICTIM_IS_START	1
 #define LOCK_VICTIM_IS_OTHER	2
 #define LOCK_EXCEED_MAX_DEPTH	3
 
+/** A transaction on the path of the deadlock search, see
+lock_deadlock_search() */
+typedef struct lock_deadlock_frame_struct {
+	lock_t*	wait_lock;	/*!< lock that the transaction is waiting
+				for */
+	lock_t*	lock;		/*!< the next lock ahead of wait_lock in
+				its queue to check, or NULL */
+	ulint	heap_no;	/*!< heap number of the record of a record
+				wait_lock, or ULINT_UNDEFINED for a table
+				lock */
+} lock_deadlock_frame_t;
+
+/** The path of the deadlock search from the starting transaction;
+protected by lock_sys->mutex */
+static lock_deadlock_frame_t
+lock_deadlock_stack[LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK + 2];
+
 /********************************************************************//**
 Checks if a lock request results in a deadlock.
 @return TRUE if a deadlock was detected and we chose trx as a victim;
@@ -389,7 +420,7 @@ lock_deadlock_occurs(
 	lock_t*	lock,	/*!< in: lock the transaction is requesting */
 	trx_t*	trx);	/*!< in: transaction */
 /********************************************************************//**
-Looks recursively for a deadlock.
+Looks for a deadlock.
 @return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
 deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
 deadlock was found and we chose some other trx as a victim: we must do
@@ -398,17 +429,13 @@ deadlock!
 LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
 static
 ulint
-lock_deadlock_recursive(
-/*====================*/
-	trx_t*	start,		/*!< in: recursion starting point */
-	trx_t*	trx,		/*!< in: a transaction waiting for a lock */
-	lock_t*	wait_lock,	/*!< in:  lock that is waiting to be granted */
-	ulint*	cost,		/*!< in/out: number of calculation steps thus
+lock_deadlock_search(
+/*=================*/
+	trx_t*	start,		/*!< in: search starting point */
+	lock_t*	wait_lock,	/*!< in: lock that start is waiting for */
+	ulint*	cost);		/*!< in/out: number of calculation steps thus
 				far: if this exceeds LOCK_MAX_N_STEPS_...
 				we return LOCK_EXCEED_MAX_DEPTH */
-	ulint	depth);		/*!< in: recursion depth: if this exceeds
-				LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK, we
-				return LOCK_EXCEED_MAX_DEPTH */
 
 /*********************************************************************//**
 Gets the nth bit of a record lock.
@@ -439,9 +466,6 @@ lock_rec_get_nth_bit(
 
 /*************************************************************************/
 
-#define lock_mutex_enter_kernel()	mutex_enter(&kernel_mutex)
-#define lock_mutex_exit_kernel()	mutex_exit(&kernel_mutex)
-
 /*********************************************************************//**
 Checks that a transaction id is sensible, i.e., not in the future.
 @return	TRUE if ok */
@@ -452,22 +476,19 @@ lock_check_trx_id_sanity(
 	trx_id_t	trx_id,		/*!< in: trx id */
 	const rec_t*	rec,		/*!< in: user record */
 	dict_index_t*	index,		/*!< in: index */
-	const ulint*	offsets,	/*!< in: rec_get_offsets(rec, index) */
-	ibool		has_kernel_mutex)/*!< in: TRUE if the caller owns the
-					kernel mutex */
+	const ulint*	offsets)	/*!< in: rec_get_offsets(rec, index) */
 {
-	ibool	is_ok		= TRUE;
+	ibool		is_ok		= TRUE;
+	trx_id_t	max_trx_id;
 
 	ut_ad(rec_offs_validate(rec, index, offsets));
 
-	if (!has_kernel_mutex) {
-		mutex_enter(&kernel_mutex);
-	}
+	max_trx_id = trx_sys_get_max_trx_id();
 
 	/* A sanity check: the trx_id in rec must be smaller than the global
 	trx id counter */
 
-	if (UNIV_UNLIKELY(trx_id >= trx_sys->max_trx_id)) {
+	if (UNIV_UNLIKELY(trx_id >= max_trx_id)) {
 		ut_print_timestamp(stderr);
 		fputs("  InnoDB: Error: transaction id associated"
 		      " with record\n",
@@ -480,15 +501,11 @@ lock_check_trx_id_sanity(
 			" global trx id counter " TRX_ID_FMT "!\n"
 			"InnoDB: The table is corrupt. You have to do"
 			" dump + drop + reimport.\n",
-			(ullint) trx_id, (ullint) trx_sys->max_trx_id);
+			(ullint) trx_id, (ullint) max_trx_id);
 
 		is_ok = FALSE;
 	}
 
-	if (!has_kernel_mutex) {
-		mutex_exit(&kernel_mutex);
-	}
-
 	return(is_ok);
 }
 
@@ -514,7 +531,7 @@ lock_clust_rec_cons_read_sees(
 
 	/* NOTE that we call this function while holding the search
 	system latch. To obey the latching order we must NOT reserve the
-	kernel mutex here! */
+	lock mutex here! */
 
 	trx_id = row_get_rec_trx_id(rec, index, offsets);
 
@@ -546,7 +563,7 @@ lock_sec_rec_cons_read_sees(
 
 	/* NOTE that we might call this function while holding the search
 	system latch. To obey the latching order we must NOT reserve the
-	kernel mutex here! */
+	lock mutex here! */
 
 	if (recv_recovery_is_on()) {
 
@@ -569,6 +586,11 @@ lock_sys_create(
 {
 	lock_sys = mem_alloc(sizeof(lock_sys_t));
 
+	mutex_create(lock_sys_mutex_key, &lock_sys->mutex, SYNC_LOCK_SYS);
+
+	mutex_create(lock_sys_wait_mutex_key,
+		     &lock_sys->wait_mutex, SYNC_LOCK_WAIT_SYS);
+
 	lock_sys->rec_hash = hash_create(n_cells);
 
 	/* hash_create_mutexes(lock_sys->rec_hash, 2, SYNC_REC_LOCK); */
@@ -590,6 +612,10 @@ lock_sys_close(void)
 	}
 
 	hash_table_free(lock_sys->rec_hash);
+
+	mutex_free(&lock_sys->mutex);
+	mutex_free(&lock_sys->wait_mutex);
+
 	mem_free(lock_sys);
 	lock_sys = NULL;
 }
@@ -726,7 +752,7 @@ lock_is_table_exclusive(
 	ut_ad(table);
 	ut_ad(trx);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	for (lock = UT_LIST_GET_FIRST(table->locks);
 	     lock;
@@ -759,7 +785,7 @@ not_ok:
 	}
 
 func_exit:
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	return(ok);
 }
@@ -1111,7 +1137,7 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
@@ -1160,7 +1186,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = HASH_GET_FIRST(lock_sys->rec_hash,
 			      lock_rec_hash(space, page_no));
@@ -1189,7 +1215,7 @@ lock_rec_expl_exist_on_page(
 {
 	ibool	ret;
 
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
 
 	if (lock_rec_get_first_on_page_addr(space, page_no)) {
 		ret = TRUE;
@@ -1197,7 +1223,7 @@ lock_rec_expl_exist_on_page(
 		ret = FALSE;
 	}
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 
 	return(ret);
 }
@@ -1217,7 +1243,7 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	hash = buf_block_get_lock_hash_val(block);
 
@@ -1246,7 +1272,7 @@ lock_rec_get_next(
 	ulint	heap_no,/*!< in: heap number of the record */
 	lock_t*	lock)	/*!< in: lock */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	do {
 		ut_ad(lock_get_type_low(lock) == LOCK_REC);
@@ -1268,7 +1294,7 @@ lock_rec_get_first(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -1338,7 +1364,7 @@ lock_rec_get_prev(
 	ulint	page_no;
 	lock_t*	found_lock	= NULL;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	space = in_lock->un_member.rec_lock.space;
@@ -1378,7 +1404,7 @@ lock_table_has(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	/* Look for stronger locks the same trx already has on the table */
 
@@ -1425,7 +1451,7 @@ lock_rec_has_expl(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad((precise_mode & LOCK_MODE_MASK) == LOCK_S
 	      || (precise_mode & LOCK_MODE_MASK) == LOCK_X);
 	ut_ad(!(precise_mode & LOCK_INSERT_INTENTION));
@@ -1478,7 +1504,7 @@ lock_rec_other_has_expl_req(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(mode == LOCK_X || mode == LOCK_S);
 	ut_ad(gap == 0 || gap == LOCK_GAP);
 	ut_ad(wait == 0 || wait == LOCK_WAIT);
@@ -1522,7 +1548,7 @@ lock_rec_other_has_conflicting(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = lock_rec_get_first(block, heap_no);
 
@@ -1567,7 +1593,7 @@ lock_rec_find_similar_on_page(
 	lock_t*		lock,		/*!< in: lock_rec_get_first_on_page() */
 	const trx_t*	trx)		/*!< in: transaction */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	while (lock != NULL) {
 		if (lock->trx == trx
@@ -1596,8 +1622,9 @@ lock_sec_rec_some_has_impl_off_kernel(
 	const ulint*	offsets)/*!< in: rec_get_offsets(rec, index) */
 {
 	const page_t*	page = page_align(rec);
+	trx_id_t	min_trx_id;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(!dict_index_is_clust(index));
 	ut_ad(page_rec_is_user_rec(rec));
 	ut_ad(rec_offs_validate(rec, index, offsets));
@@ -1608,7 +1635,11 @@ lock_sec_rec_some_has_impl_off_kernel(
 	max trx id to the log, and therefore during recovery, this value
 	for a page may be incorrect. */
 
-	if (page_get_max_trx_id(page) < trx_list_get_min_trx_id()
+	trx_sys_mutex_enter();
+	min_trx_id = trx_list_get_min_trx_id();
+	trx_sys_mutex_exit();
+
+	if (page_get_max_trx_id(page) < min_trx_id
 	    && !recv_recovery_is_on()) {
 
 		return(NULL);
@@ -1618,7 +1649,7 @@ lock_sec_rec_some_has_impl_off_kernel(
 	implicit x-lock. We have to look in the clustered index. */
 
 	if (!lock_check_trx_id_sanity(page_get_max_trx_id(page),
-				      rec, index, offsets, TRUE)) {
+				      rec, index, offsets)) {
 		buf_page_print(page, 0, 0);
 
 		/* The page is corrupt: try to avoid a crash by returning
@@ -1689,7 +1720,7 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	space = buf_block_get_space(block);
 	page_no	= buf_block_get_page_no(block);
@@ -1734,6 +1765,9 @@ lock_rec_create(
 
 	HASH_INSERT(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), lock);
+
+	index->table->n_rec_locks++;
+
 	if (lock_is_wait_not_by_other(type_mode)) {
 
 		lock_set_lock_and_trx_wait(lock, trx);
@@ -1771,22 +1805,27 @@ lock_rec_enqueue_waiting(
 	que_thr_t*		thr)	/*!< in: query thread */
 {
 	trx_t*	trx;
+	ibool	stopped;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
+
+	trx = thr_get_trx(thr);
 
 	/* Test if there already is some other reason to suspend thread:
 	we do not enqueue a lock request if the query thread should be
 	stopped anyway */
 
-	if (UNIV_UNLIKELY(que_thr_stop(thr))) {
+	trx_mutex_enter(trx);
+	stopped = que_thr_stop(thr);
+	trx_mutex_exit(trx);
+
+	if (UNIV_UNLIKELY(stopped)) {
 
 		ut_error;
 
 		return(DB_QUE_THR_SUSPENDED);
 	}
 
-	trx = thr_get_trx(thr);
-
 	switch (trx_get_dict_operation(trx)) {
 	case TRX_DICT_OP_NONE:
 		break;
@@ -1835,12 +1874,16 @@ lock_rec_enqueue_waiting(
 		return(DB_SUCCESS_LOCKED_REC);
 	}
 
+	trx_mutex_enter(trx);
+
 	trx->que_state = TRX_QUE_LOCK_WAIT;
 	trx->was_chosen_as_deadlock_victim = FALSE;
 	trx->wait_started = time(NULL);
 
 	ut_a(que_thr_stop(thr));
 
+	trx_mutex_exit(trx);
+
 #ifdef UNIV_DEBUG
 	if (lock_print_waits) {
 		fprintf(stderr, "Lock wait for trx " TRX_ID_FMT " in index ",
@@ -1875,7 +1918,7 @@ lock_rec_add_to_queue(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 #ifdef UNIV_DEBUG
 	switch (type_mode & LOCK_MODE_MASK) {
 	case LOCK_X:
@@ -1986,7 +2029,7 @@ lock_rec_lock_fast(
 	lock_t*	lock;
 	trx_t*	trx;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2063,7 +2106,7 @@ lock_rec_lock_slow(
 	trx_t*	trx;
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2148,7 +2191,7 @@ lock_rec_lock(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2189,7 +2232,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint	page_no;
 	ulint	heap_no;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2222,7 +2265,7 @@ lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2269,7 +2312,7 @@ lock_rec_cancel(
 /*============*/
 	lock_t*	lock)	/*!< in: waiting record lock request */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 	ut_ad(!(lock->type_mode & LOCK_CONV_BY_OTHER));
 
@@ -2303,7 +2346,7 @@ lock_rec_dequeue_from_page(
 	lock_t*	lock;
 	trx_t*	trx;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	trx = in_lock->trx;
@@ -2314,6 +2357,9 @@ lock_rec_dequeue_from_page(
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
 
+	ut_ad(in_lock->index->table->n_rec_locks > 0);
+	in_lock->index->table->n_rec_locks--;
+
 	UT_LIST_REMOVE(trx_locks, trx->trx_locks, in_lock);
 
 	/* Check if waiting locks in the queue can now be granted: grant
@@ -2346,7 +2392,7 @@ lock_rec_discard(
 	ulint	page_no;
 	trx_t*	trx;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	trx = in_lock->trx;
@@ -2357,6 +2403,9 @@ lock_rec_discard(
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
 
+	ut_ad(in_lock->index->table->n_rec_locks > 0);
+	in_lock->index->table->n_rec_locks--;
+
 	UT_LIST_REMOVE(trx_locks, trx->trx_locks, in_lock);
 }
 
@@ -2375,7 +2424,7 @@ lock_rec_free_all_from_discard_page(
 	lock_t*	lock;
 	lock_t*	next_lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	space = buf_block_get_space(block);
 	page_no = buf_block_get_page_no(block);
@@ -2409,7 +2458,7 @@ lock_rec_reset_and_release_wait(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = lock_rec_get_first(block, heap_no);
 
@@ -2450,7 +2499,7 @@ lock_rec_inherit_to_gap(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = lock_rec_get_first(block, heap_no);
 
@@ -2495,7 +2544,7 @@ lock_rec_inherit_to_gap_if_gap_lock(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = lock_rec_get_first(block, heap_no);
 
@@ -2534,7 +2583,7 @@ lock_rec_move(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = lock_rec_get_first(donator, donator_heap_no);
 
@@ -2579,12 +2628,12 @@ lock_move_reorganize_page(
 	mem_heap_t*	heap		= NULL;
 	ulint		comp;
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	lock = lock_rec_get_first_on_page(block);
 
 	if (lock == NULL) {
-		lock_mutex_exit_kernel();
+		lock_mutex_exit();
 
 		return;
 	}
@@ -2698,7 +2747,7 @@ lock_move_reorganize_page(
 #endif /* UNIV_DEBUG */
 	}
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	mem_heap_free(heap);
 
@@ -2722,7 +2771,7 @@ lock_move_rec_list_end(
 	lock_t*		lock;
 	const ulint	comp	= page_rec_is_comp(rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Note: when we move locks from record to record, waiting locks
 	and possible granted gap type locks behind them are enqueued in
@@ -2788,7 +2837,7 @@ lock_move_rec_list_end(
 		}
 	}
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 #ifdef UNIV_DEBUG_LOCK_VALIDATE
 	ut_ad(lock_rec_validate_page(block));
@@ -2820,7 +2869,7 @@ lock_move_rec_list_start(
 	ut_ad(block->frame == page_align(rec));
 	ut_ad(new_block->frame == page_align(old_end));
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -2897,7 +2946,7 @@ lock_move_rec_list_start(
 #endif /* UNIV_DEBUG */
 	}
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 #ifdef UNIV_DEBUG_LOCK_VALIDATE
 	ut_ad(lock_rec_validate_page(block));
@@ -2915,7 +2964,7 @@ lock_update_split_right(
 {
 	ulint	heap_no = lock_get_min_heap_no(right_block);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Move the locks on the supremum of the left page to the supremum
 	of the right page */
@@ -2929,7 +2978,7 @@ lock_update_split_right(
 	lock_rec_inherit_to_gap(left_block, right_block,
 				PAGE_HEAP_NO_SUPREMUM, heap_no);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -2948,7 +2997,7 @@ lock_update_merge_right(
 						page which will be
 						discarded */
 {
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Inherit the locks from the supremum of the left page to the
 	original successor of infimum on the right page, to which the left
@@ -2966,7 +3015,7 @@ lock_update_merge_right(
 
 	lock_rec_free_all_from_discard_page(left_block);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -2983,14 +3032,14 @@ lock_update_root_raise(
 	const buf_block_t*	block,	/*!< in: index page to which copied */
 	const buf_block_t*	root)	/*!< in: root page */
 {
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Move the locks on the supremum of the root to the supremum
 	of block */
 
 	lock_rec_move(block, root,
 		      PAGE_HEAP_NO_SUPREMUM, PAGE_HEAP_NO_SUPREMUM);
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3005,7 +3054,7 @@ lock_update_copy_and_discard(
 	const buf_block_t*	block)		/*!< in: index page;
 						NOT the root! */
 {
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Move the locks on the supremum of the old page to the supremum
 	of new_page */
@@ -3014,7 +3063,7 @@ lock_update_copy_and_discard(
 		      PAGE_HEAP_NO_SUPREMUM, PAGE_HEAP_NO_SUPREMUM);
 	lock_rec_free_all_from_discard_page(block);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3028,7 +3077,7 @@ lock_update_split_left(
 {
 	ulint	heap_no = lock_get_min_heap_no(right_block);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Inherit the locks to the supremum of the left page from the
 	successor of the infimum on the right page */
@@ -3036,7 +3085,7 @@ lock_update_split_left(
 	lock_rec_inherit_to_gap(left_block, right_block,
 				PAGE_HEAP_NO_SUPREMUM, heap_no);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3057,7 +3106,7 @@ lock_update_merge_left(
 
 	ut_ad(left_block->frame == page_align(orig_pred));
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	left_next_rec = page_rec_get_next_const(orig_pred);
 
@@ -3085,7 +3134,7 @@ lock_update_merge_left(
 
 	lock_rec_free_all_from_discard_page(right_block);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3106,13 +3155,13 @@ lock_rec_reset_and_inherit_gap_locks(
 	ulint			heap_no)	/*!< in: heap_no of the
 						donating record */
 {
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
 
 	lock_rec_reset_and_release_wait(heir_block, heir_heap_no);
 
 	lock_rec_inherit_to_gap(heir_block, block, heir_heap_no, heap_no);
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3132,12 +3181,12 @@ lock_update_discard(
 	const rec_t*	rec;
 	ulint		heap_no;
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	if (!lock_rec_get_first_on_page(block)) {
 		/* No locks exist on page, nothing to do */
 
-		lock_mutex_exit_kernel();
+		lock_mutex_exit();
 
 		return;
 	}
@@ -3175,7 +3224,7 @@ lock_update_discard(
 
 	lock_rec_free_all_from_discard_page(block);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3205,10 +3254,10 @@ lock_update_insert(
 			page_rec_get_next_low(rec, FALSE));
 	}
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 	lock_rec_inherit_to_gap_if_gap_lock(block,
 					    receiver_heap_no, donator_heap_no);
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3238,7 +3287,7 @@ lock_update_delete(
 								       FALSE));
 	}
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* Let the next record inherit the locks from rec, in gap mode */
 
@@ -3248,7 +3297,7 @@ lock_update_delete(
 
 	lock_rec_reset_and_release_wait(block, heap_no);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -3273,11 +3322,11 @@ lock_rec_store_on_page_infimum(
 
 	ut_ad(block->frame == page_align(rec));
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	lock_rec_move(block, block, PAGE_HEAP_NO_INFIMUM, heap_no);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -3298,11 +3347,11 @@ lock_rec_restore_from_page_infimum(
 {
 	ulint	heap_no = page_rec_get_heap_no(rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	lock_rec_move(block, donator, heap_no, PAGE_HEAP_NO_INFIMUM);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 }
 
 /*=========== DEADLOCK CHECKING ======================================*/
@@ -3393,26 +3442,33 @@ lock_deadlock_occurs(
 	lock_t*	lock,	/*!< in: lock the transaction is requesting */
 	trx_t*	trx)	/*!< in: transaction */
 {
-	trx_t*		mark_trx;
 	ulint		ret;
 	ulint		cost	= 0;
+	ullint		start_us;
 
 	ut_ad(trx);
 	ut_ad(lock);
-	ut_ad(mutex_own(&kernel_mutex));
-retry:
-	/* We check that adding this trx to the waits-for graph
-	does not produce a cycle. First mark all active transactions
-	with 0: */
+	ut_ad(lock_mutex_own());
 
-	mark_trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	if (!srv_deadlock_detect) {
+		/* Deadlocks will be resolved by
+		innodb_lock_wait_timeout */
 
-	while (mark_trx) {
-		mark_trx->deadlock_mark = 0;
-		mark_trx = UT_LIST_GET_NEXT(trx_list, mark_trx);
+		return(FALSE);
 	}
 
-	ret = lock_deadlock_recursive(trx, trx, lock, &cost, 0);
+	srv_n_lock_deadlock_checks++;
+	start_us = ut_time_us(NULL);
+retry:
+	/* We check that adding this trx to the waits-for graph
+	does not produce a cycle. Instead of resetting the marks of
+	all active transactions, which would require the trx_sys
+	mutex, start a new search generation: a transaction is
+	marked as searched if its deadlock_mark equals the counter. */
+
+	lock_mark_counter++;
+
+	ret = lock_deadlock_search(trx, lock, &cost);
 
 	/* Increment counter if a deadlock was detected. */
 	if (ret) {
@@ -3452,230 +3508,299 @@ retry:
 
 	default:
 		/* No deadlock detected*/
+		srv_lock_deadlock_check_time += ut_time_us(NULL) - start_us;
+
 		return(FALSE);
 	}
 
+	srv_lock_deadlock_check_time += ut_time_us(NULL) - start_us;
+
 	lock_deadlock_found = TRUE;
 
 	return(TRUE);
 }
 
 /********************************************************************//**
-Looks recursively for a deadlock.
-@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
-deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
-deadlock was found and we chose some other trx as a victim: we must do
-the search again in this last case because there may be another
-deadlock!
-LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
+Gets the first lock ahead of a waiting lock in its queue that the
+deadlock search must check.
+@return	first lock to check, or NULL */
 static
-ulint
-lock_deadlock_recursive(
-/*====================*/
-	trx_t*	start,		/*!< in: recursion starting point */
-	trx_t*	trx,		/*!< in: a transaction waiting for a lock */
+lock_t*
+lock_deadlock_first(
+/*================*/
 	lock_t*	wait_lock,	/*!< in: lock that is waiting to be granted */
-	ulint*	cost,		/*!< in/out: number of calculation steps thus
-				far: if this exceeds LOCK_MAX_N_STEPS_...
-				we return LOCK_EXCEED_MAX_DEPTH */
-	ulint	depth)		/*!< in: recursion depth: if this exceeds
-				LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK, we
-				return LOCK_EXCEED_MAX_DEPTH */
+	ulint*	heap_no)	/*!< out: heap number of the record of a
+				record lock, or ULINT_UNDEFINED */
 {
-	ulint	ret;
 	lock_t*	lock;
-	trx_t*	lock_trx;
-	ulint	heap_no		= ULINT_UNDEFINED;
 
-	ut_a(trx);
-	ut_a(start);
-	ut_a(wait_lock);
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
-	if (trx->deadlock_mark == 1) {
-		/* We have already exhaustively searched the subtree starting
-		from this trx */
+	if (lock_get_type_low(wait_lock) != LOCK_REC) {
+		*heap_no = ULINT_UNDEFINED;
 
-		return(0);
+		return(UT_LIST_GET_PREV(un_member.tab_lock.locks, wait_lock));
 	}
 
-	*cost = *cost + 1;
+	*heap_no = lock_rec_find_set_bit(wait_lock);
+	ut_a(*heap_no != ULINT_UNDEFINED);
 
-	if (lock_get_type_low(wait_lock) == LOCK_REC) {
-		ulint		space;
-		ulint		page_no;
+	lock = lock_rec_get_first_on_page_addr(
+		wait_lock->un_member.rec_lock.space,
+		wait_lock->un_member.rec_lock.page_no);
 
-		heap_no = lock_rec_find_set_bit(wait_lock);
-		ut_a(heap_no != ULINT_UNDEFINED);
+	/* Position the iterator on the first matching record lock. */
+	while (lock != NULL
+	       && lock != wait_lock
+	       && !lock_rec_get_nth_bit(lock, *heap_no)) {
 
-		space = wait_lock->un_member.rec_lock.space;
-		page_no = wait_lock->un_member.rec_lock.page_no;
+		lock = lock_rec_get_next_on_page(lock);
+	}
 
-		lock = lock_rec_get_first_on_page_addr(space, page_no);
+	if (lock == wait_lock) {
+		lock = NULL;
+	}
 
-		/* Position the iterator on the first matching record lock. */
-		while (lock != NULL
-		       && lock != wait_lock
-		       && !lock_rec_get_nth_bit(lock, heap_no)) {
+	ut_ad(lock == NULL || lock_rec_get_nth_bit(lock, *heap_no));
 
-			lock = lock_rec_get_next_on_page(lock);
-		}
+	return(lock);
+}
 
-		if (lock == wait_lock) {
-			lock = NULL;
-		}
+/********************************************************************//**
+Gets the next lock ahead of a waiting lock in its queue that the
+deadlock search must check.
+@return	next lock to check, or NULL */
+static
+lock_t*
+lock_deadlock_next(
+/*===============*/
+	const lock_deadlock_frame_t*	frame)	/*!< in: the waiting lock and
+						the lock that was checked */
+{
+	lock_t*	lock	= frame->lock;
 
-		ut_ad(lock == NULL || lock_rec_get_nth_bit(lock, heap_no));
+	ut_ad(lock_mutex_own());
+	ut_a(lock != NULL);
 
-	} else {
-		lock = wait_lock;
+	if (frame->heap_no == ULINT_UNDEFINED) {
+
+		return(UT_LIST_GET_PREV(un_member.tab_lock.locks, lock));
 	}
 
-	/* Look at the locks ahead of wait_lock in the lock queue */
+	do {
+		lock = lock_rec_get_next_on_page(lock);
+	} while (lock != NULL
+		 && lock != frame->wait_lock
+		 && !lock_rec_get_nth_bit(lock, frame->heap_no));
 
-	for (;;) {
-		/* Get previous table lock. */
-		if (heap_no == ULINT_UNDEFINED) {
+	if (lock == frame->wait_lock) {
+		lock = NULL;
+	}
 
-			lock = UT_LIST_GET_PREV(
-				un_member.tab_lock.locks, lock);
-		}
+	return(lock);
+}
 
-		if (lock == NULL) {
-			/* We can mark this subtree as searched */
-			trx->deadlock_mark = 1;
+/********************************************************************//**
+Prints a deadlock cycle and chooses the victim.
+@return LOCK_VICTIM_IS_START if we chose 'start' as the victim,
+LOCK_VICTIM_IS_OTHER if we chose the transaction of wait_lock */
+static
+ulint
+lock_deadlock_report(
+/*=================*/
+	trx_t*	start,		/*!< in: search starting point */
+	lock_t*	wait_lock,	/*!< in: lock that is waiting for lock */
+	lock_t*	lock)		/*!< in: lock of start that wait_lock has
+				to wait for */
+{
+	ut_ad(lock_mutex_own());
+	ut_ad(lock->trx == start);
 
-			return(FALSE);
-		}
+	lock_deadlock_start_print();
 
-		if (lock_has_to_wait(wait_lock, lock)) {
+	lock_deadlock_fputs("\n*** (1) TRANSACTION:\n");
 
-			ibool	too_far
-				= depth > LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK
-				|| *cost > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK;
+	lock_deadlock_trx_print(wait_lock->trx, 3000);
 
-			lock_trx = lock->trx;
+	lock_deadlock_fputs(
+		"*** (1) WAITING FOR THIS LOCK"
+		" TO BE GRANTED:\n");
 
-			if (lock_trx == start) {
+	lock_deadlock_lock_print(wait_lock);
 
-				/* We came back to the recursion starting
-				point: a deadlock detected; or we have
-				searched the waits-for graph too long */
+	lock_deadlock_fputs("*** (2) TRANSACTION:\n");
 
-				lock_deadlock_start_print();
+	lock_deadlock_trx_print(lock->trx, 3000);
 
-				lock_deadlock_fputs("\n*** (1) TRANSACTION:\n");
+	lock_deadlock_fputs(
+		"*** (2) HOLDS THE LOCK(S):\n");
 
-				lock_deadlock_trx_print(wait_lock->trx, 3000);
+	lock_deadlock_lock_print(lock);
 
-				lock_deadlock_fputs(
-					"*** (1) WAITING FOR THIS LOCK"
-					" TO BE GRANTED:\n");
+	lock_deadlock_fputs(
+		"*** (2) WAITING FOR THIS LOCK"
+		" TO BE GRANTED:\n");
 
-				lock_deadlock_lock_print(wait_lock);
+	lock_deadlock_lock_print(start->wait_lock);
 
-				lock_deadlock_fputs("*** (2) TRANSACTION:\n");
+#ifdef UNIV_DEBUG
+	if (lock_print_waits) {
+		fputs("Deadlock detected\n",
+		      stderr);
+	}
+#endif /* UNIV_DEBUG */
 
-				lock_deadlock_trx_print(lock->trx, 3000);
+	if (trx_weight_ge(wait_lock->trx, start)) {
+		/* Our search starting point
+		transaction is 'smaller', let us
+		choose 'start' as the victim and roll
+		back it */
 
-				lock_deadlock_fputs(
-					"*** (2) HOLDS THE LOCK(S):\n");
+		return(LOCK_VICTIM_IS_START);
+	}
 
-				lock_deadlock_lock_print(lock);
+	lock_deadlock_found = TRUE;
 
-				lock_deadlock_fputs(
-					"*** (2) WAITING FOR THIS LOCK"
-					" TO BE GRANTED:\n");
+	/* Let us choose the transaction of wait_lock
+	as a victim to try to avoid deadlocking our
+	search starting point transaction */
 
-				lock_deadlock_lock_print(start->wait_lock);
+	lock_deadlock_fputs(
+		"*** WE ROLL BACK TRANSACTION (1)\n");
 
-#ifdef UNIV_DEBUG
-				if (lock_print_waits) {
-					fputs("Deadlock detected\n",
-					      stderr);
-				}
-#endif /* UNIV_DEBUG */
+	trx_mutex_enter(wait_lock->trx);
+	wait_lock->trx->was_chosen_as_deadlock_victim
+		= TRUE;
+	trx_mutex_exit(wait_lock->trx);
 
-				if (trx_weight_ge(wait_lock->trx, start)) {
-					/* Our recursion starting point
-					transaction is 'smaller', let us
-					choose 'start' as the victim and roll
-					back it */
+	lock_cancel_waiting_and_release(wait_lock);
 
-					return(LOCK_VICTIM_IS_START);
-				}
+	/* Since trx and wait_lock are no longer
+	in the waits-for graph, we can return FALSE;
+	note that our selective algorithm can choose
+	several transactions as victims, but still
+	we may end up rolling back also the search
+	starting point transaction! */
 
-				lock_deadlock_found = TRUE;
+	return(LOCK_VICTIM_IS_OTHER);
+}
 
-				/* Let us choose the transaction of wait_lock
-				as a victim to try to avoid deadlocking our
-				recursion starting point transaction */
+/********************************************************************//**
+Looks for a deadlock. This is a depth-first search of the waits-for
+graph, with the path from the starting transaction kept in
+lock_deadlock_stack instead of the call stack. A transaction whose
+waits-for subtree has been searched exhaustively is marked with the
+current lock_mark_counter and is not searched again.
+@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
+deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
+deadlock was found and we chose some other trx as a victim: we must do
+the search again in this last case because there may be another
+deadlock!
+LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
+static
+ulint
+lock_deadlock_search(
+/*=================*/
+	trx_t*	start,		/*!< in: search starting point */
+	lock_t*	wait_lock,	/*!< in: lock that start is waiting for */
+	ulint*	cost)		/*!< in/out: number of calculation steps thus
+				far: if this exceeds LOCK_MAX_N_STEPS_...
+				we return LOCK_EXCEED_MAX_DEPTH */
+{
+	lock_deadlock_frame_t*	frame;
+	ulint			depth	= 0;
 
-				lock_deadlock_fputs(
-					"*** WE ROLL BACK TRANSACTION (1)\n");
+	ut_a(start);
+	ut_a(wait_lock);
+	ut_ad(lock_mutex_own());
+	ut_ad(start->deadlock_mark != lock_mark_counter);
 
-				wait_lock->trx->was_chosen_as_deadlock_victim
-					= TRUE;
+	*cost = *cost + 1;
 
-				lock_cancel_waiting_and_release(wait_lock);
+	frame = &lock_deadlock_stack[0];
+	frame->wait_lock = wait_lock;
+	frame->lock = lock_deadlock_first(wait_lock, &frame->heap_no);
 
-				/* Since trx and wait_lock are no longer
-				in the waits-for graph, we can return FALSE;
-				note that our selective algorithm can choose
-				several transactions as victims, but still
-				we may end up rolling back also the recursion
-				starting point transaction! */
+	/* Look at the locks ahead of wait_lock in the lock queue */
 
-				return(LOCK_VICTIM_IS_OTHER);
-			}
+	for (;;) {
+		lock_t*	lock	= frame->lock;
+		trx_t*	lock_trx;
 
-			if (too_far) {
+		if (lock == NULL) {
+			/* We can mark this subtree as searched */
+			frame->wait_lock->trx->deadlock_mark
+				= lock_mark_counter;
 
-#ifdef UNIV_DEBUG
-				if (lock_print_waits) {
-					fputs("Deadlock search exceeds"
-					      " max steps or depth.\n",
-					      stderr);
-				}
-#endif /* UNIV_DEBUG */
-				/* The information about transaction/lock
-				to be rolled back is available in the top
-				level. Do not print anything here. */
-				return(LOCK_EXCEED_MAX_DEPTH);
+			if (depth == 0) {
+
+				return(0);
 			}
 
-			if (lock_trx->que_state == TRX_QUE_LOCK_WAIT) {
+			/* Continue with the next lock in the queue of
+			the transaction that waits for this one */
 
-				/* Another trx ahead has requested lock	in an
-				incompatible mode, and is itself waiting for
-				a lock */
+			frame = &lock_deadlock_stack[--depth];
+			frame->lock = lock_deadlock_next(frame);
 
-				ret = lock_deadlock_recursive(
-					start, lock_trx,
-					lock_trx->wait_lock, cost, depth + 1);
+			continue;
+		}
 
-				if (ret != 0) {
+		if (!lock_has_to_wait(frame->wait_lock, lock)) {
 
-					return(ret);
-				}
-			}
+			frame->lock = lock_deadlock_next(frame);
+
+			continue;
 		}
-		/* Get the next record lock to check. */
-		if (heap_no != ULINT_UNDEFINED) {
 
-			ut_a(lock != NULL);
+		lock_trx = lock->trx;
 
-			do {
-				lock = lock_rec_get_next_on_page(lock);
-			} while (lock != NULL
-				&& lock != wait_lock
-				&& !lock_rec_get_nth_bit(lock, heap_no));
+		if (lock_trx == start) {
 
-			if (lock == wait_lock) {
-				lock = NULL;
+			/* We came back to the search starting
+			point: a deadlock detected */
+
+			return(lock_deadlock_report(
+				       start, frame->wait_lock, lock));
+		}
+
+		if (depth > LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK
+		    || *cost > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK) {
+
+#ifdef UNIV_DEBUG
+			if (lock_print_waits) {
+				fputs("Deadlock search exceeds"
+				      " max steps or depth.\n",
+				      stderr);
 			}
+#endif /* UNIV_DEBUG */
+			/* The information about transaction/lock
+			to be rolled back is available in the top
+			level. Do not print anything here. */
+			return(LOCK_EXCEED_MAX_DEPTH);
 		}
-	}/* end of the 'for (;;)'-loop */
+
+		if (lock_trx->que_state == TRX_QUE_LOCK_WAIT
+		    && lock_trx->deadlock_mark != lock_mark_counter) {
+
+			/* Another trx ahead has requested lock	in an
+			incompatible mode, and is itself waiting for
+			a lock: search its subtree */
+
+			ut_a(depth + 1 < UT_ARR_SIZE(lock_deadlock_stack));
+
+			*cost = *cost + 1;
+
+			frame = &lock_deadlock_stack[++depth];
+			frame->wait_lock = lock_trx->wait_lock;
+			frame->lock = lock_deadlock_first(
+				frame->wait_lock, &frame->heap_no);
+
+			continue;
+		}
+
+		frame->lock = lock_deadlock_next(frame);
+	}
 }
 
 /*========================= TABLE LOCKS ==============================*/
@@ -3696,7 +3821,7 @@ lock_table_create(
 	lock_t*	lock;
 
 	ut_ad(table && trx);
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(!(type_mode & LOCK_CONV_BY_OTHER));
 
 	if ((type_mode & LOCK_MODE_MASK) == LOCK_AUTO_INC) {
@@ -3744,7 +3869,7 @@ lock_table_pop_autoinc_locks(
 /*=========================*/
 	trx_t*	trx)	/*!< in/out: transaction that owns the AUTOINC locks */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
 
 	/* Skip any gaps, gaps are NULL lock entries in the
@@ -3772,7 +3897,7 @@ lock_table_remove_autoinc_lock(
 	lock_t*	autoinc_lock;
 	lint	i = ib_vector_size(trx->autoinc_locks) - 1;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_mode(lock) == LOCK_AUTO_INC);
 	ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
@@ -3821,7 +3946,7 @@ lock_table_remove_low(
 	trx_t*		trx;
 	dict_table_t*	table;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	trx = lock->trx;
 	table = lock->un_member.tab_lock.table;
@@ -3877,21 +4002,26 @@ lock_table_enqueue_waiting(
 {
 	lock_t*	lock;
 	trx_t*	trx;
+	ibool	stopped;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
+
+	trx = thr_get_trx(thr);
 
 	/* Test if there already is some other reason to suspend thread:
 	we do not enqueue a lock request if the query thread should be
 	stopped anyway */
 
-	if (que_thr_stop(thr)) {
+	trx_mutex_enter(trx);
+	stopped = que_thr_stop(thr);
+	trx_mutex_exit(trx);
+
+	if (stopped) {
 		ut_error;
 
 		return(DB_QUE_THR_SUSPENDED);
 	}
 
-	trx = thr_get_trx(thr);
-
 	switch (trx_get_dict_operation(trx)) {
 	case TRX_DICT_OP_NONE:
 		break;
@@ -3933,12 +4063,16 @@ lock_table_enqueue_waiting(
 		return(DB_SUCCESS);
 	}
 
+	trx_mutex_enter(trx);
+
 	trx->que_state = TRX_QUE_LOCK_WAIT;
 	trx->was_chosen_as_deadlock_victim = FALSE;
 	trx->wait_started = time(NULL);
 
 	ut_a(que_thr_stop(thr));
 
+	trx_mutex_exit(trx);
+
 	return(DB_LOCK_WAIT);
 }
 
@@ -3960,7 +4094,7 @@ lock_table_other_has_incompatible(
 {
 	const lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = UT_LIST_GET_LAST(table->locks);
 
@@ -4007,13 +4141,22 @@ lock_table(
 
 	trx = thr_get_trx(thr);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
+
+	if (UNIV_UNLIKELY(trx->read_only)
+	    && (mode == LOCK_IX || mode == LOCK_X)) {
+
+		/* The transaction is going to modify the table */
+		trx_sys_mutex_enter();
+		trx_set_rw_mode(trx);
+		trx_sys_mutex_exit();
+	}
 
 	/* Look for stronger locks the same trx already has on the table */
 
 	if (lock_table_has(trx, table, mode)) {
 
-		lock_mutex_exit_kernel();
+		lock_mutex_exit();
 
 		return(DB_SUCCESS);
 	}
@@ -4028,7 +4171,7 @@ lock_table(
 
 		err = lock_table_enqueue_waiting(mode | flags, table, thr);
 
-		lock_mutex_exit_kernel();
+		lock_mutex_exit();
 
 		return(err);
 	}
@@ -4037,7 +4180,7 @@ lock_table(
 
 	ut_a(!flags || mode == LOCK_S || mode == LOCK_X);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	return(DB_SUCCESS);
 }
@@ -4054,7 +4197,7 @@ lock_table_has_to_wait_in_queue(
 	const dict_table_t*	table;
 	const lock_t*		lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_wait(wait_lock));
 
 	table = wait_lock->un_member.tab_lock.table;
@@ -4088,7 +4231,7 @@ lock_table_dequeue(
 {
 	lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_a(lock_get_type_low(in_lock) == LOCK_TABLE);
 
 	lock = UT_LIST_GET_NEXT(un_member.tab_lock.locks, in_lock);
@@ -4138,7 +4281,7 @@ lock_rec_unlock(
 
 	heap_no = page_rec_get_heap_no(rec);
 
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
 
 	first_lock = lock_rec_get_first(block, heap_no);
 
@@ -4154,7 +4297,7 @@ lock_rec_unlock(
 		}
 	}
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 	ut_print_timestamp(stderr);
 	fprintf(stderr,
 		"  InnoDB: Error: unlock row could not"
@@ -4176,7 +4319,7 @@ released:
 		}
 	}
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -4191,8 +4334,12 @@ lock_release_off_kernel(
 	dict_table_t*	table;
 	ulint		count;
 	lock_t*		lock;
+	trx_id_t	max_trx_id;
+
+	ut_ad(lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
 
-	ut_ad(mutex_own(&kernel_mutex));
+	max_trx_id = trx_sys_get_max_trx_id();
 
 	lock = UT_LIST_GET_LAST(trx->trx_locks);
 
@@ -4217,20 +4364,19 @@ lock_release_off_kernel(
 
 				table = lock->un_member.tab_lock.table;
 
-				table->query_cache_inv_trx_id
-					= trx_sys->max_trx_id;
+				table->query_cache_inv_trx_id = max_trx_id;
 			}
 
 			lock_table_dequeue(lock);
 		}
 
-		if (count == LOCK_RELEASE_KERNEL_INTERVAL) {
-			/* Release the kernel mutex for a while, so that we
+		if (count == LOCK_RELEASE_INTERVAL) {
+			/* Release the lock mutex for a while, so that we
 			do not monopolize it */
 
-			lock_mutex_exit_kernel();
+			lock_mutex_exit();
 
-			lock_mutex_enter_kernel();
+			lock_mutex_enter();
 
 			count = 0;
 		}
@@ -4252,7 +4398,7 @@ lock_cancel_waiting_and_release(
 /*============================*/
 	lock_t*	lock)	/*!< in: waiting lock request */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(!(lock->type_mode & LOCK_CONV_BY_OTHER));
 
 	if (lock_get_type_low(lock) == LOCK_REC) {
@@ -4301,7 +4447,7 @@ lock_remove_all_on_table_for_trx(
 	lock_t*	lock;
 	lock_t*	prev_lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = UT_LIST_GET_LAST(trx->trx_locks);
 
@@ -4327,6 +4473,27 @@ lock_remove_all_on_table_for_trx(
 	}
 }
 
+/*********************************************************************//**
+Checks if there are any table or record locks on a table.
+@return	TRUE if the table has locks */
+UNIV_INTERN
+ibool
+lock_table_has_locks(
+/*=================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	ibool	has_locks;
+
+	lock_mutex_enter();
+
+	has_locks = UT_LIST_GET_LEN(table->locks) > 0
+		|| table->n_rec_locks > 0;
+
+	lock_mutex_exit();
+
+	return(has_locks);
+}
+
 /*********************************************************************//**
 Removes locks on a table to be dropped or truncated.
 If remove_also_table_sx_locks is TRUE then table-level S and X locks are
@@ -4344,7 +4511,7 @@ lock_remove_all_on_table(
 	lock_t*	lock;
 	lock_t*	prev_lock;
 
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
 
 	lock = UT_LIST_GET_FIRST(table->locks);
 
@@ -4389,7 +4556,7 @@ lock_remove_all_on_table(
 		}
 	}
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 }
 
 /*===================== VALIDATION AND DEBUGGING  ====================*/
@@ -4403,7 +4570,7 @@ lock_table_print(
 	FILE*		file,	/*!< in: file where to print */
 	const lock_t*	lock)	/*!< in: table type lock */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_a(lock_get_type_low(lock) == LOCK_TABLE);
 
 	fputs("TABLE LOCK table ", file);
@@ -4452,7 +4619,7 @@ lock_rec_print(
 	ulint*			offsets		= offsets_;
 	rec_offs_init(offsets_);
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_a(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
@@ -4545,7 +4712,7 @@ lock_get_n_rec_locks(void)
 	ulint	n_locks	= 0;
 	ulint	i;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	for (i = 0; i < hash_get_n_cells(lock_sys->rec_hash); i++) {
 
@@ -4564,22 +4731,22 @@ lock_get_n_rec_locks(void)
 
 /*********************************************************************//**
 Prints info of locks for all transactions.
-@return FALSE if not able to obtain kernel mutex
+@return FALSE if not able to obtain lock mutex
 and exits without printing info */
 UNIV_INTERN
 ibool
 lock_print_info_summary(
 /*====================*/
 	FILE*	file,	/*!< in: file where to print */
-	ibool   nowait)	/*!< in: whether to wait for the kernel mutex */
+	ibool   nowait)	/*!< in: whether to wait for the lock mutex */
 {
-	/* if nowait is FALSE, wait on the kernel mutex,
+	/* if nowait is FALSE, wait on the lock mutex,
 	otherwise return immediately if fail to obtain the
 	mutex. */
 	if (!nowait) {
-		lock_mutex_enter_kernel();
-	} else if (mutex_enter_nowait(&kernel_mutex)) {
-		fputs("FAIL TO OBTAIN KERNEL MUTEX, "
+		lock_mutex_enter();
+	} else if (mutex_enter_nowait(&lock_sys->mutex)) {
+		fputs("FAIL TO OBTAIN LOCK MUTEX, "
 		      "SKIP LOCK INFO PRINTING\n", file);
 		return(FALSE);
 	}
@@ -4597,7 +4764,7 @@ lock_print_info_summary(
 	      "------------\n", file);
 
 	fprintf(file, "Trx id counter " TRX_ID_FMT "\n",
-		(ullint) trx_sys->max_trx_id);
+		(ullint) trx_sys_get_max_trx_id());
 
 	fprintf(file,
 		"Purge done for trx's n:o < " TRX_ID_FMT
@@ -4633,8 +4800,12 @@ lock_print_info_all_transactions(
 	mtr_t	mtr;
 	trx_t*	trx;
 
+	ut_ad(lock_mutex_own());
+
 	fprintf(file, "LIST OF TRANSACTIONS FOR EACH SESSION:\n");
 
+	trx_sys_mutex_enter();
+
 	/* First print info on non-active transactions */
 
 	trx = UT_LIST_GET_FIRST(trx_sys->mysql_trx_list);
@@ -4653,8 +4824,8 @@ loop:
 
 	i = 0;
 
-	/* Since we temporarily release the kernel mutex when
-	reading a database page in below, variable trx may be
+	/* Since we temporarily release the lock mutex and the trx_sys
+	mutex when reading a database page in below, variable trx may be
 	obsolete now and we must loop through the trx list to
 	get probably the same trx, or some other trx. */
 
@@ -4664,7 +4835,8 @@ loop:
 	}
 
 	if (trx == NULL) {
-		lock_mutex_exit_kernel();
+		trx_sys_mutex_exit();
+		lock_mutex_exit();
 
 		ut_ad(lock_validate());
 
@@ -4745,7 +4917,8 @@ loop:
 				goto print_rec;
 			}
 
-			lock_mutex_exit_kernel();
+			trx_sys_mutex_exit();
+			lock_mutex_exit();
 
 			mtr_start(&mtr);
 
@@ -4756,7 +4929,8 @@ loop:
 
 			load_page_first = FALSE;
 
-			lock_mutex_enter_kernel();
+			lock_mutex_enter();
+			trx_sys_mutex_enter();
 
 			goto loop;
 		}
@@ -4799,7 +4973,7 @@ lock_table_queue_validate(
 {
 	const lock_t*	lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	lock = UT_LIST_GET_FIRST(table->locks);
 
@@ -4847,7 +5021,7 @@ lock_rec_queue_validate(
 
 	heap_no = page_rec_get_heap_no(rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	if (!page_rec_is_user_rec(rec)) {
 
@@ -4876,7 +5050,7 @@ lock_rec_queue_validate(
 			lock = lock_rec_get_next(heap_no, lock);
 		}
 
-		lock_mutex_exit_kernel();
+		lock_mutex_exit();
 
 		return(TRUE);
 	}
@@ -4896,7 +5070,7 @@ lock_rec_queue_validate(
 #if 0
 	} else {
 
-		/* The kernel mutex may get released temporarily in the
+		/* The lock mutex may get released temporarily in the
 		next function call: we have to release lock table mutex
 		to obey the latching order */
 
@@ -4970,7 +5144,7 @@ lock_rec_queue_validate(
 		lock = lock_rec_get_next(heap_no, lock);
 	}
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	return(TRUE);
 }
@@ -4994,10 +5168,10 @@ lock_rec_validate_page(
 	ulint*		offsets		= offsets_;
 	rec_offs_init(offsets_);
 
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!lock_mutex_own());
 	ut_ad(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 loop:
 	lock = lock_rec_get_first_on_page_addr(buf_block_get_space(block),
 					       buf_block_get_page_no(block));
@@ -5044,7 +5218,7 @@ loop:
 				"Validating %u %u\n",
 				block->page.space, block->page.offset);
 #endif
-			lock_mutex_exit_kernel();
+			lock_mutex_exit();
 
 			/* If this thread is holding the file space
 			latch (fil_space_t::latch), the following
@@ -5054,7 +5228,7 @@ loop:
 			lock_rec_queue_validate(block, rec, lock->index,
 						offsets);
 
-			lock_mutex_enter_kernel();
+			lock_mutex_enter();
 
 			nth_bit = i + 1;
 
@@ -5068,7 +5242,7 @@ loop:
 	goto loop;
 
 function_exit:
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
@@ -5089,7 +5263,7 @@ lock_rec_validate(
 					(space, page_no) */
 {
 	lock_t*		lock;
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	for (lock = HASH_GET_FIRST(lock_sys->rec_hash, start);
 	     lock != NULL;
@@ -5161,7 +5335,8 @@ lock_validate(void)
 	const trx_t*	trx;
 	ulint		i;
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -5181,6 +5356,8 @@ lock_validate(void)
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
+	trx_sys_mutex_exit();
+
 	/* Iterate over all the record locks and validate the locks. We
 	don't want to hog the lock_sys_t::mutex and the trx_sys_t::mutex.
 	Release both mutexes during the validation check. */
@@ -5194,13 +5371,13 @@ lock_validate(void)
 			ulint	space = lock->un_member.rec_lock.space;
 			ulint	page_no = lock->un_member.rec_lock.page_no;
 
-			lock_mutex_exit_kernel();
+			lock_mutex_exit();
 			lock_rec_block_validate(space, page_no);
-			lock_mutex_enter_kernel();
+			lock_mutex_enter();
 		}
 	}
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	return(TRUE);
 }
@@ -5247,21 +5424,23 @@ lock_rec_insert_check_and_lock(
 	next_rec = page_rec_get_next_const(rec);
 	next_rec_heap_no = page_rec_get_heap_no(next_rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	/* When inserting a record into an index, the table must be at
 	least IX-locked or we must be building an index, in which case
-	the table must be at least S-locked. */
+	the table must be at least S-locked, unless the index is being
+	created online. */
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX)
 	      || (*index->name == TEMP_INDEX_PREFIX
-		  && lock_table_has(trx, index->table, LOCK_S)));
+		  && (lock_table_has(trx, index->table, LOCK_S)
+		      || dict_index_is_online_ddl(index))));
 
 	lock = lock_rec_get_first(block, next_rec_heap_no);
 
 	if (UNIV_LIKELY(lock == NULL)) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit_kernel();
+		lock_mutex_exit();
 
 		if (!dict_index_is_clust(index)) {
 			/* Update the page max trx id field */
@@ -5300,7 +5479,7 @@ lock_rec_insert_check_and_lock(
 		err = DB_SUCCESS;
 	}
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	switch (err) {
 	case DB_SUCCESS_LOCKED_REC:
@@ -5339,7 +5518,7 @@ lock_rec_insert_check_and_lock(
 /*********************************************************************//**
 If a transaction has an implicit x-lock on a record, but no explicit x-lock
 set on the record, sets one for it. NOTE that in the case of a secondary
-index, the kernel mutex may get temporarily released. */
+index, the lock mutex may get temporarily released. */
 static
 void
 lock_rec_convert_impl_to_expl(
@@ -5351,7 +5530,7 @@ lock_rec_convert_impl_to_expl(
 {
 	trx_t*	impl_trx;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_ad(page_rec_is_user_rec(rec));
 	ut_ad(rec_offs_validate(rec, index, offsets));
 	ut_ad(!page_rec_is_comp(rec) == !rec_offs_comp(offsets));
@@ -5429,7 +5608,7 @@ lock_clust_rec_modify_check_and_lock(
 		? rec_get_heap_no_new(rec)
 		: rec_get_heap_no_old(rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
@@ -5441,7 +5620,7 @@ lock_clust_rec_modify_check_and_lock(
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	ut_ad(lock_rec_queue_validate(block, rec, index, offsets));
 
@@ -5490,14 +5669,14 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 #ifdef UNIV_DEBUG
 	{
@@ -5558,6 +5737,7 @@ lock_sec_rec_read_check_and_lock(
 {
 	enum db_err	err;
 	ulint		heap_no;
+	trx_id_t	min_trx_id;
 
 	ut_ad(!dict_index_is_clust(index));
 	ut_ad(block->frame == page_align(rec));
@@ -5572,7 +5752,7 @@ lock_sec_rec_read_check_and_lock(
 
 	heap_no = page_rec_get_heap_no(rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
@@ -5583,7 +5763,11 @@ lock_sec_rec_read_check_and_lock(
 	if the max trx id for the page >= min trx id for the trx list or a
 	database recovery is running. */
 
-	if ((page_get_max_trx_id(block->frame) >= trx_list_get_min_trx_id()
+	trx_sys_mutex_enter();
+	min_trx_id = trx_list_get_min_trx_id();
+	trx_sys_mutex_exit();
+
+	if ((page_get_max_trx_id(block->frame) >= min_trx_id
 	     || recv_recovery_is_on())
 	    && !page_rec_is_supremum(rec)) {
 
@@ -5593,7 +5777,7 @@ lock_sec_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	ut_ad(lock_rec_queue_validate(block, rec, index, offsets));
 
@@ -5648,7 +5832,7 @@ lock_clust_rec_read_check_and_lock(
 
 	heap_no = page_rec_get_heap_no(rec);
 
-	lock_mutex_enter_kernel();
+	lock_mutex_enter();
 
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
@@ -5663,7 +5847,7 @@ lock_clust_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	lock_mutex_exit_kernel();
+	lock_mutex_exit();
 
 	ut_ad(lock_rec_queue_validate(block, rec, index, offsets));
 
@@ -5732,7 +5916,7 @@ lock_release_autoinc_last_lock(
 	ulint		last;
 	lock_t*		lock;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 	ut_a(!ib_vector_is_empty(autoinc_locks));
 
 	/* The lock to be release must be the last lock acquired. */
@@ -5771,7 +5955,7 @@ lock_release_autoinc_locks(
 /*=======================*/
 	trx_t*		trx)		/*!< in/out: transaction */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 
 	ut_a(trx->autoinc_locks != NULL);
 
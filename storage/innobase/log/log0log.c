@@ -44,6 +44,8 @@ Created 12/9/1995 Heikki Tuuri
 #include "log0recv.h"
 #include "fil0fil.h"
 #include "dict0boot.h"
+#include "dict0stats.h"
+#include "fsp0fsp.h"
 #include "srv0srv.h"
 #include "srv0start.h"
 #include "trx0sys.h"
@@ -92,6 +94,8 @@ UNIV_INTERN mysql_pfs_key_t	archive_lock_key;
 #ifdef UNIV_PFS_MUTEX
 UNIV_INTERN mysql_pfs_key_t	log_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	log_flush_order_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	log_write_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	log_flush_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 #ifdef UNIV_DEBUG
@@ -109,6 +113,22 @@ archive */
 UNIV_INTERN byte	log_archive_io;
 #endif /* UNIV_LOG_ARCHIVE */
 
+#if defined HAVE_ATOMIC_BUILTINS && !defined UNIV_HOTBACKUP
+/** log_write_up_to() writes the log without holding log_sys->mutex */
+# define LOG_WRITE_UNLOCKED
+/** Adds to a counter that log_group_write_buf() may update without
+log_sys->mutex */
+# define log_counter_add(counter, n)				\
+	((void) os_atomic_increment_ulint(&(counter), n))
+/** Subtracts from a counter that log_group_write_buf() may update without
+log_sys->mutex */
+# define log_counter_sub(counter, n)				\
+	((void) os_atomic_decrement_ulint(&(counter), n))
+#else /* HAVE_ATOMIC_BUILTINS && !UNIV_HOTBACKUP */
+# define log_counter_add(counter, n)	((void) ((counter) += (n)))
+# define log_counter_sub(counter, n)	((void) ((counter) -= (n)))
+#endif /* HAVE_ATOMIC_BUILTINS && !UNIV_HOTBACKUP */
+
 /* A margin for free space in the log buffer before a log entry is catenated */
 #define LOG_BUF_WRITE_MARGIN	(4 * OS_FILE_LOG_BLOCK_SIZE)
 
@@ -140,10 +160,6 @@ the previous */
 /* This parameter controls asynchronous writing to the archive */
 #define LOG_ARCHIVE_RATIO_ASYNC		16
 
-/* Codes used in unlocking flush latches */
-#define LOG_UNLOCK_NONE_FLUSHED_LOCK	1
-#define LOG_UNLOCK_FLUSH_LOCK		2
-
 /* States of an archiving operation */
 #define	LOG_ARCHIVE_READ	1
 #define	LOG_ARCHIVE_WRITE	2
@@ -191,8 +207,10 @@ log_fsp_current_free_limit_set_and_checkpoint(
 }
 
 /****************************************************************//**
-Returns the oldest modified block lsn in the pool, or log_sys->lsn if none
-exists.
+Returns the oldest modified block lsn in the pool, or log_sys->closed_lsn if
+none exists. The mini-transactions that have not closed their log records
+have not added their pages to the flush lists yet: closed_lsn must be read
+before the flush lists, so that it is not past them.
 @return	LSN of oldest modification */
 static
 ib_uint64_t
@@ -200,203 +218,319 @@ log_buf_pool_get_oldest_modification(void)
 /*======================================*/
 {
 	ib_uint64_t	lsn;
+	ib_uint64_t	closed_lsn;
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
+	log_flush_order_mutex_enter();
+	closed_lsn = log_sys->closed_lsn;
+	log_flush_order_mutex_exit();
+
 	lsn = buf_pool_get_oldest_modification();
 
 	if (!lsn) {
 
-		lsn = log_sys->lsn;
+		lsn = closed_lsn;
 	}
 
 	return(lsn);
 }
 
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release.
-@return	start lsn of the log record */
+Returns the slot of the events in log_sys->close_events,
+log_sys->write_events and log_sys->flush_events that a thread waiting for
+an lsn waits for. The slot is chosen by the log block, so that an advance
+of the log by a few blocks wakes up only the threads waiting in those
+blocks.
+@return	index of the events */
+UNIV_INLINE
+ulint
+log_event_slot(
+/*===========*/
+	ib_uint64_t	lsn)	/*!< in: lsn that is waited for */
+{
+	return((ulint) ((lsn / OS_FILE_LOG_BLOCK_SIZE) % LOG_N_EVENTS));
+}
+
+/************************************************************//**
+Sets the events of the threads that wait for an lsn in the range
+(start_lsn, end_lsn]. */
+static
+void
+log_set_events(
+/*===========*/
+	os_event_t*	events,		/*!< in: log_sys->write_events or
+					log_sys->flush_events */
+	ib_uint64_t	start_lsn,	/*!< in: old value of the lsn */
+	ib_uint64_t	end_lsn)	/*!< in: new value of the lsn */
+{
+	ib_uint64_t	block_no;
+	ulint		i;
+
+	block_no = start_lsn / OS_FILE_LOG_BLOCK_SIZE;
+
+	for (i = 0; i < LOG_N_EVENTS
+	     && block_no <= end_lsn / OS_FILE_LOG_BLOCK_SIZE;
+	     i++, block_no++) {
+
+		os_event_set(events[block_no % LOG_N_EVENTS]);
+	}
+}
+
+/************************************************************//**
+Reserves space in the log buffer for a mini-transaction. This advances
+log_sys->sn without holding any mutex; the log records are then copied to
+the reserved space with log_write_low(), and the space is closed with
+log_wait_for_close() and log_close().
+@return	start lsn of the log records */
 UNIV_INTERN
 ib_uint64_t
 log_reserve_and_open(
 /*=================*/
-	ulint	len)	/*!< in: length of data to be catenated */
+	ulint		len,	/*!< in: length of data to be catenated */
+	ib_uint64_t*	end_lsn)/*!< out: end lsn of the log records */
 {
-	log_t*	log			= log_sys;
-	ulint	len_upper_limit;
+	log_t*		log	= log_sys;
+	ib_uint64_t	sn;
+	ib_uint64_t	start_lsn;
+	ib_uint64_t	limit_lsn;
+	ib_uint64_t	block_lsn;
 #ifdef UNIV_LOG_ARCHIVE
-	ulint	archived_lsn_age;
-	ulint	dummy;
+	ulint		archived_lsn_age;
+	ulint		dummy;
 #endif /* UNIV_LOG_ARCHIVE */
-#ifdef UNIV_DEBUG
-	ulint	count			= 0;
-#endif /* UNIV_DEBUG */
 
+	ut_a(len > 0);
 	ut_a(len < log->buf_size / 2);
-loop:
-	mutex_enter(&(log->mutex));
 	ut_ad(!recv_no_log_write);
 
-	/* Calculate an upper limit for the space the string may take in the
-	log buffer */
+#ifdef UNIV_LOG_ARCHIVE
+	if (log->archiving_state != LOG_ARCH_OFF) {
+loop:
+		mutex_enter(&(log->mutex));
 
-	len_upper_limit = LOG_BUF_WRITE_MARGIN + (5 * len) / 4;
+		archived_lsn_age = log_get_lsn() - log->archived_lsn;
+		if (archived_lsn_age + LOG_BUF_WRITE_MARGIN + (5 * len) / 4
+		    > log->max_archived_lsn_age) {
+			/* Not enough free archived space in log groups: do a
+			synchronous archive write batch: */
 
-	if (log->buf_free + len_upper_limit > log->buf_size) {
+			mutex_exit(&(log->mutex));
 
-		mutex_exit(&(log->mutex));
+			log_archive_do(TRUE, &dummy);
 
-		/* Not enough free space, do a syncronous flush of the log
-		buffer */
+			goto loop;
+		}
 
-		log_buffer_flush_to_disk();
+		mutex_exit(&(log->mutex));
+	}
+#endif /* UNIV_LOG_ARCHIVE */
 
-		srv_log_waits++;
+#ifdef HAVE_ATOMIC_BUILTINS_64
+	sn = os_atomic_increment_uint64(&log->sn, len) - len;
+#else /* HAVE_ATOMIC_BUILTINS_64 */
+	os_fast_mutex_lock(&log->lsn_mutex);
+	sn = log->sn;
+	log->sn += len;
+	os_fast_mutex_unlock(&log->lsn_mutex);
+#endif /* HAVE_ATOMIC_BUILTINS_64 */
 
-		ut_ad(++count < 50);
+	start_lsn = log_translate_sn_to_lsn(sn);
+	*end_lsn = log_translate_sn_to_lsn(sn + len);
 
-		goto loop;
-	}
+	/* The last block that we copy to overwrites in the log buffer the
+	block that is log->buf_size bytes before it: wait until that has
+	been written, and the block where the next write starts is past
+	it. Only the log written before start_lsn is waited for, because
+	len < log->buf_size / 2. */
 
-#ifdef UNIV_LOG_ARCHIVE
-	if (log->archiving_state != LOG_ARCH_OFF) {
+	limit_lsn = ut_uint64_align_down(*end_lsn, OS_FILE_LOG_BLOCK_SIZE)
+		+ OS_FILE_LOG_BLOCK_SIZE;
 
-		archived_lsn_age = log->lsn - log->archived_lsn;
-		if (archived_lsn_age + len_upper_limit
-		    > log->max_archived_lsn_age) {
-			/* Not enough free archived space in log groups: do a
-			synchronous archive write batch: */
+	if (limit_lsn > log_lsn_read(&log->written_to_all_lsn)
+	    + log->buf_size) {
 
-			mutex_exit(&(log->mutex));
+		log_counter_add(srv_log_waits, 1);
 
-			ut_ad(len_upper_limit <= log->max_archived_lsn_age);
+		log_write_up_to(limit_lsn - log->buf_size,
+				LOG_WAIT_ALL_GROUPS, FALSE);
+	}
 
-			log_archive_do(TRUE, &dummy);
+	/* Mark where the first log record group starts in the blocks
+	that we enter: nowhere in the blocks that the records fill, and at
+	end_lsn in the last block, where the records of the next
+	mini-transaction start. */
 
-			ut_ad(++count < 50);
+	for (block_lsn = ut_uint64_align_down(start_lsn, OS_FILE_LOG_BLOCK_SIZE)
+		     + OS_FILE_LOG_BLOCK_SIZE;
+	     block_lsn <= *end_lsn;
+	     block_lsn += OS_FILE_LOG_BLOCK_SIZE) {
 
-			goto loop;
-		}
+		log_block_set_first_rec_group(
+			log->buf + (ulint) (block_lsn % log->buf_size),
+			block_lsn + OS_FILE_LOG_BLOCK_SIZE > *end_lsn
+			? (ulint) (*end_lsn % OS_FILE_LOG_BLOCK_SIZE) : 0);
 	}
-#endif /* UNIV_LOG_ARCHIVE */
 
-#ifdef UNIV_LOG_DEBUG
-	log->old_buf_free = log->buf_free;
-	log->old_lsn = log->lsn;
-#endif
-	return(log->lsn);
+	log_counter_add(srv_log_write_requests, 1);
+
+	return(start_lsn);
 }
 
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Copies log records to space reserved by log_reserve_and_open(). This does
+not need any mutex, because nobody else writes to the reserved space.
+@return	lsn after the copied string */
 UNIV_INTERN
-void
+ib_uint64_t
 log_write_low(
 /*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len)	/*!< in: string length */
+	ib_uint64_t	lsn,		/*!< in: lsn where to copy */
+	const byte*	str,		/*!< in: string */
+	ulint		str_len)	/*!< in: string length */
 {
 	log_t*	log	= log_sys;
 	ulint	len;
-	ulint	data_len;
-	byte*	log_block;
 
-	ut_ad(mutex_own(&(log->mutex)));
-part_loop:
 	ut_ad(!recv_no_log_write);
-	/* Calculate a part length */
 
-	data_len = (log->buf_free % OS_FILE_LOG_BLOCK_SIZE) + str_len;
+	while (str_len > 0) {
+		/* Calculate a part length that fits in the data area of
+		the current block */
 
-	if (data_len <= OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+		len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- (ulint) (lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-		/* The string fits within the current log block */
+		if (len > str_len) {
+			len = str_len;
+		}
 
-		len = str_len;
-	} else {
-		data_len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE;
+		ut_memcpy(log->buf + (ulint) (lsn % log->buf_size), str, len);
 
-		len = OS_FILE_LOG_BLOCK_SIZE
-			- (log->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-			- LOG_BLOCK_TRL_SIZE;
-	}
+		str_len -= len;
+		str += len;
+		lsn += len;
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
+		if (lsn % OS_FILE_LOG_BLOCK_SIZE
+		    == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+			/* This block became full: skip the trailer and the
+			header of the next block */
 
-	str_len -= len;
-	str = str + len;
+			lsn += LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+		}
+	}
 
-	log_block = ut_align_down(log->buf + log->buf_free,
-				  OS_FILE_LOG_BLOCK_SIZE);
-	log_block_set_data_len(log_block, data_len);
+	return(lsn);
+}
 
-	if (data_len == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
-		/* This block became full */
-		log_block_set_data_len(log_block, OS_FILE_LOG_BLOCK_SIZE);
-		log_block_set_checkpoint_no(log_block,
-					    log_sys->next_checkpoint_no);
-		len += LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE;
+/************************************************************//**
+Waits until all log records before start_lsn have been closed. On return
+the caller owns log_sys->log_flush_order_mutex, and must add the pages it
+modified to the flush lists and then call log_close(). */
+UNIV_INTERN
+void
+log_wait_for_close(
+/*===============*/
+	ib_uint64_t	start_lsn)	/*!< in: start lsn of the log records
+					of the caller */
+{
+	log_t*		log	= log_sys;
+	os_event_t	event;
+	ib_int64_t	sig_count;
+	ulint		i;
 
-		log->lsn += len;
+	/* The preceding mini-transactions are usually only copying their
+	log records: spin a while before going to wait. This is a dirty
+	read, it is checked again below. */
 
-		/* Initialize the next block header */
-		log_block_init(log_block + OS_FILE_LOG_BLOCK_SIZE, log->lsn);
-	} else {
-		log->lsn += len;
+	for (i = 0; i < srv_n_spin_wait_rounds
+	     && log->closed_lsn != start_lsn; i++) {
+
+		ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 	}
 
-	log->buf_free += len;
+	event = log->close_events[log_event_slot(start_lsn)];
 
-	ut_ad(log->buf_free <= log->buf_size);
+	log_flush_order_mutex_enter();
 
-	if (str_len > 0) {
-		goto part_loop;
-	}
+	while (log->closed_lsn != start_lsn) {
+
+		ut_ad(log->closed_lsn < start_lsn);
+
+		log_flush_order_mutex_exit();
+
+		sig_count = os_event_reset(event);
 
-	srv_log_write_requests++;
+		log_flush_order_mutex_enter();
+
+		if (log->closed_lsn != start_lsn) {
+
+			log_flush_order_mutex_exit();
+
+			os_event_wait_low(event, sig_count);
+
+			log_flush_order_mutex_enter();
+		}
+	}
 }
 
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Closes the log records that end at end_lsn, which lets the log writer write
+them, and releases log_sys->log_flush_order_mutex. */
 UNIV_INTERN
-ib_uint64_t
-log_close(void)
-/*===========*/
+void
+log_close(
+/*======*/
+	ib_uint64_t	start_lsn,	/*!< in: start lsn of the log records */
+	ib_uint64_t	end_lsn)	/*!< in: end lsn of the log records */
 {
-	byte*		log_block;
-	ulint		first_rec_group;
 	ib_uint64_t	oldest_lsn;
-	ib_uint64_t	lsn;
+	ib_uint64_t	requested_lsn;
 	log_t*		log	= log_sys;
 	ib_uint64_t	checkpoint_age;
+	ibool		check	= FALSE;
 
-	ut_ad(mutex_own(&(log->mutex)));
+	ut_ad(log_flush_order_mutex_own());
+	ut_ad(log->closed_lsn == start_lsn);
 	ut_ad(!recv_no_log_write);
 
-	lsn = log->lsn;
+#ifdef UNIV_LOG_DEBUG
+	log_check_log_recs(start_lsn, end_lsn);
+#endif
 
-	log_block = ut_align_down(log->buf + log->buf_free,
-				  OS_FILE_LOG_BLOCK_SIZE);
-	first_rec_group = log_block_get_first_rec_group(log_block);
+	log->closed_lsn = end_lsn;
 
-	if (first_rec_group == 0) {
-		/* We initialized a new log block which was not written
-		full by the current mtr: the next mtr log record group
-		will start within this block at the offset data_len */
+	requested_lsn = log_lsn_read(&log->write_requested_lsn);
 
-		log_block_set_first_rec_group(
-			log_block, log_block_get_data_len(log_block));
+	log_flush_order_mutex_exit();
+
+	if (end_lsn == start_lsn) {
+
+		return;
 	}
 
-	if (log->buf_free > log->max_buf_free) {
+	os_event_set(log->close_events[log_event_slot(end_lsn)]);
 
-		log->check_flush_or_checkpoint = TRUE;
+	if (requested_lsn > start_lsn && requested_lsn <= end_lsn) {
+		/* A thread waits for the log to be written up to the log
+		records that we closed */
+
+		os_event_set(log->writer_event);
+	}
+
+	if (log->check_flush_or_checkpoint) {
+
+		return;
 	}
 
-	checkpoint_age = lsn - log->last_checkpoint_lsn;
+	if (end_lsn - ut_uint64_align_down(
+		    log_lsn_read(&log->written_to_all_lsn),
+		    OS_FILE_LOG_BLOCK_SIZE) > log->max_buf_free) {
+
+		check = TRUE;
+	}
+
+	checkpoint_age = end_lsn - log->last_checkpoint_lsn;
 
 	if (checkpoint_age >= log->log_group_capacity) {
 		/* TODO: split btr_store_big_rec_extern_fields() into small
@@ -405,6 +539,8 @@ log_close(void)
 		after the latest checkpoint. In principle, we should split all
 		big_rec operations, but other operations are smaller. */
 
+		mutex_enter(&(log->mutex));
+
 		if (!log_has_printed_chkp_warning
 		    || difftime(time(NULL), log_last_warning_time) > 15) {
 
@@ -425,29 +561,30 @@ log_close(void)
 				(ulong) checkpoint_age,
 				(ulong) log->log_group_capacity);
 		}
-	}
-
-	if (checkpoint_age <= log->max_modified_age_async) {
 
-		goto function_exit;
+		mutex_exit(&(log->mutex));
 	}
 
-	oldest_lsn = buf_pool_get_oldest_modification();
+	if (!check && checkpoint_age > log->max_modified_age_async) {
 
-	if (!oldest_lsn
-	    || lsn - oldest_lsn > log->max_modified_age_async
-	    || checkpoint_age > log->max_checkpoint_age_async) {
+		oldest_lsn = buf_pool_get_oldest_modification();
 
-		log->check_flush_or_checkpoint = TRUE;
+		if (!oldest_lsn
+		    || end_lsn - oldest_lsn > log->max_modified_age_async
+		    || checkpoint_age > log->max_checkpoint_age_async) {
+
+			check = TRUE;
+		}
 	}
-function_exit:
 
-#ifdef UNIV_LOG_DEBUG
-	log_check_log_recs(log->buf + log->old_buf_free,
-			   log->buf_free - log->old_buf_free, log->old_lsn);
-#endif
+	if (check) {
+		/* The flag is reset by log_checkpoint_margin() while
+		holding the log mutex */
 
-	return(lsn);
+		mutex_enter(&(log->mutex));
+		log->check_flush_or_checkpoint = TRUE;
+		mutex_exit(&(log->mutex));
+	}
 }
 
 #ifdef UNIV_LOG_ARCHIVE
@@ -462,28 +599,49 @@ log_pad_current_log_block(void)
 	byte		b		= MLOG_DUMMY_RECORD;
 	ulint		pad_length;
 	ulint		i;
+	ib_uint64_t	start_lsn;
+	ib_uint64_t	end_lsn;
 	ib_uint64_t	lsn;
 
-	/* We retrieve lsn only because otherwise gcc crashed on HP-UX */
-	lsn = log_reserve_and_open(OS_FILE_LOG_BLOCK_SIZE);
+	/* Reserve the rest of the current block: the reservation may
+	race with mini-transactions, so retry until it ended a block */
 
-	pad_length = OS_FILE_LOG_BLOCK_SIZE
-		- (log_sys->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-		- LOG_BLOCK_TRL_SIZE;
+	do {
+		lsn = log_get_lsn();
 
-	for (i = 0; i < pad_length; i++) {
-		log_write_low(&b, 1);
-	}
+		pad_length = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- (ulint) (lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-	lsn = log_sys->lsn;
+		start_lsn = log_reserve_and_open(pad_length, &end_lsn);
 
-	log_close();
-	log_release();
+		lsn = start_lsn;
 
-	ut_a(lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
+		for (i = 0; i < pad_length; i++) {
+			lsn = log_write_low(lsn, &b, 1);
+		}
+
+		log_wait_for_close(start_lsn);
+		log_close(start_lsn, end_lsn);
+	} while (end_lsn % OS_FILE_LOG_BLOCK_SIZE != LOG_BLOCK_HDR_SIZE);
 }
 #endif /* UNIV_LOG_ARCHIVE */
 
+#ifdef UNIV_DEBUG
+/******************************************************//**
+Checks if the current thread may access the log group fields that are
+used for writing to the log files: it must own log_sys->mutex, or
+log_sys->write_mutex while writing the log buffer.
+@return	TRUE if the fields may be accessed */
+static
+ibool
+log_write_owned(void)
+/*=================*/
+{
+	return(mutex_own(&(log_sys->mutex))
+	       || mutex_own(&(log_sys->write_mutex)));
+}
+#endif /* UNIV_DEBUG */
+
 /******************************************************//**
 Calculates the data capacity of a log group, when the log file headers are not
 included.
@@ -494,7 +652,7 @@ log_group_get_capacity(
 /*===================*/
 	const log_group_t*	group)	/*!< in: log group */
 {
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_write_owned());
 
 	return((group->file_size - LOG_FILE_HDR_SIZE) * group->n_files);
 }
@@ -511,7 +669,7 @@ log_group_calc_size_offset(
 					log group */
 	const log_group_t*	group)	/*!< in: log group */
 {
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_write_owned());
 
 	return(offset - LOG_FILE_HDR_SIZE * (1 + offset / group->file_size));
 }
@@ -528,7 +686,7 @@ log_group_calc_real_offset(
 					log group */
 	const log_group_t*	group)	/*!< in: log group */
 {
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_write_owned());
 
 	return(offset + LOG_FILE_HDR_SIZE
 	       * (1 + offset / (group->file_size - LOG_FILE_HDR_SIZE)));
@@ -551,7 +709,7 @@ log_group_calc_lsn_offset(
 	ib_int64_t	group_size;
 	ib_int64_t	offset;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_write_owned());
 
 	/* If total log file size is > 2 GB we can easily get overflows
 	with 32-bit integers. Use 64-bit integers instead. */
@@ -766,6 +924,8 @@ void
 log_init(void)
 /*==========*/
 {
+	ulint	i;
+
 	log_sys = mem_alloc(sizeof(log_t));
 
 	mutex_create(log_sys_mutex_key, &log_sys->mutex, SYNC_LOG);
@@ -774,12 +934,17 @@ log_init(void)
 		     &log_sys->log_flush_order_mutex,
 		     SYNC_LOG_FLUSH_ORDER);
 
-	mutex_enter(&(log_sys->mutex));
+	mutex_create(log_write_mutex_key, &log_sys->write_mutex,
+		     SYNC_LOG_WRITE);
 
-	/* Start the lsn from one log block from zero: this way every
-	log record has a start lsn != zero, a fact which we will use */
+	mutex_create(log_flush_mutex_key, &log_sys->flush_mutex,
+		     SYNC_LOG_FLUSH);
+
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	os_fast_mutex_init(&log_sys->lsn_mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
 
-	log_sys->lsn = LOG_START_LSN;
+	mutex_enter(&(log_sys->mutex));
 
 	ut_a(LOG_BUFFER_SIZE >= 16 * OS_FILE_LOG_BLOCK_SIZE);
 	ut_a(LOG_BUFFER_SIZE >= 4 * UNIV_PAGE_SIZE);
@@ -791,6 +956,11 @@ log_init(void)
 
 	memset(log_sys->buf, '\0', LOG_BUFFER_SIZE);
 
+	log_sys->write_buf_ptr = mem_alloc(LOG_BUFFER_SIZE
+					   + OS_FILE_LOG_BLOCK_SIZE);
+	log_sys->write_buf = ut_align(log_sys->write_buf_ptr,
+				      OS_FILE_LOG_BLOCK_SIZE);
+
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
 	log_sys->check_flush_or_checkpoint = TRUE;
@@ -802,30 +972,29 @@ log_init(void)
 	log_sys->last_printout_time = time(NULL);
 	/*----------------------------*/
 
-	log_sys->buf_next_to_write = 0;
-
-	log_sys->write_lsn = 0;
 	log_sys->current_flush_lsn = 0;
 	log_sys->flushed_to_disk_lsn = 0;
 
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
-
 	log_sys->n_pending_writes = 0;
+	log_sys->n_pending_flushes = 0;
 
-	log_sys->no_flush_event = os_event_create(NULL);
-
-	os_event_set(log_sys->no_flush_event);
+	log_sys->writer_active = FALSE;
+	log_sys->flusher_active = FALSE;
 
-	log_sys->one_flushed_event = os_event_create(NULL);
+	log_sys->writer_event = os_event_create(NULL);
+	log_sys->flusher_event = os_event_create(NULL);
 
-	os_event_set(log_sys->one_flushed_event);
+	for (i = 0; i < LOG_N_EVENTS; i++) {
+		log_sys->close_events[i] = os_event_create(NULL);
+		log_sys->write_events[i] = os_event_create(NULL);
+		log_sys->flush_events[i] = os_event_create(NULL);
+	}
 
 	/*----------------------------*/
 	log_sys->adm_checkpoint_interval = ULINT_MAX;
 
 	log_sys->next_checkpoint_no = 0;
-	log_sys->last_checkpoint_lsn = log_sys->lsn;
+	log_sys->last_checkpoint_lsn = LOG_START_LSN;
 	log_sys->n_pending_checkpoint_writes = 0;
 
 	rw_lock_create(checkpoint_lock_key, &log_sys->checkpoint_lock,
@@ -840,7 +1009,7 @@ log_init(void)
 #ifdef UNIV_LOG_ARCHIVE
 	/* Under MySQL, log archiving is always off */
 	log_sys->archiving_state = LOG_ARCH_OFF;
-	log_sys->archived_lsn = log_sys->lsn;
+	log_sys->archived_lsn = LOG_START_LSN;
 	log_sys->next_archived_lsn = 0;
 
 	log_sys->n_pending_archive_ios = 0;
@@ -863,11 +1032,10 @@ log_init(void)
 
 	/*----------------------------*/
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
+	/* Start the lsn from one log block from zero: this way every
+	log record has a start lsn != zero, a fact which we will use */
 
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE;
+	log_buffer_reset(LOG_START_LSN + LOG_BLOCK_HDR_SIZE, NULL);
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -875,14 +1043,61 @@ log_init(void)
 	recv_sys_create();
 	recv_sys_init(buf_pool_get_curr_size());
 
-	recv_sys->parse_start_lsn = log_sys->lsn;
-	recv_sys->scanned_lsn = log_sys->lsn;
+	recv_sys->parse_start_lsn = log_sys->closed_lsn;
+	recv_sys->scanned_lsn = log_sys->closed_lsn;
 	recv_sys->scanned_checkpoint_no = 0;
-	recv_sys->recovered_lsn = log_sys->lsn;
+	recv_sys->recovered_lsn = log_sys->closed_lsn;
 	recv_sys->limit_lsn = IB_ULONGLONG_MAX;
 #endif
 }
 
+/******************************************************//**
+Positions the log buffer at an lsn, when the log system is initialized or
+the log has been recovered or reset. The caller must own log_sys->mutex. */
+UNIV_INTERN
+void
+log_buffer_reset(
+/*=============*/
+	ib_uint64_t	lsn,		/*!< in: new current lsn */
+	const byte*	last_block)	/*!< in: contents of the log block
+					that contains lsn, or NULL to
+					initialize an empty block */
+{
+	log_t*		log	= log_sys;
+	byte*		block;
+	ib_uint64_t	written_lsn	= lsn;
+
+	ut_ad(mutex_own(&(log->mutex)));
+	ut_ad(!log->writer_active);
+
+	block = log->buf + (ulint) (ut_uint64_align_down(
+					    lsn, OS_FILE_LOG_BLOCK_SIZE)
+				    % log->buf_size);
+
+	if (last_block) {
+		ut_memcpy(block, last_block, OS_FILE_LOG_BLOCK_SIZE);
+	} else {
+		ut_ad(lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
+
+		log_block_init(block, lsn);
+		log_block_set_first_rec_group(block, LOG_BLOCK_HDR_SIZE);
+
+		/* The new block is not in the log files yet: let the
+		next write start from its header */
+
+		written_lsn = lsn - LOG_BLOCK_HDR_SIZE;
+	}
+
+	log->sn = log_translate_lsn_to_sn(lsn);
+	log->closed_lsn = lsn;
+
+	log->write_lsn = written_lsn;
+	log->written_to_some_lsn = written_lsn;
+	log->written_to_all_lsn = written_lsn;
+	log->write_requested_lsn = lsn;
+	log->flush_requested_lsn = lsn;
+}
+
 /******************************************************************//**
 Inits a log group to the log system. */
 UNIV_INTERN
@@ -967,114 +1182,6 @@ log_group_init(
 	ut_a(log_calc_max_ages());
 }
 
-/******************************************************************//**
-Does the unlockings needed in flush i/o completion. */
-UNIV_INLINE
-void
-log_flush_do_unlocks(
-/*=================*/
-	ulint	code)	/*!< in: any ORed combination of LOG_UNLOCK_FLUSH_LOCK
-			and LOG_UNLOCK_NONE_FLUSHED_LOCK */
-{
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	/* NOTE that we must own the log mutex when doing the setting of the
-	events: this is because transactions will wait for these events to
-	be set, and at that moment the log flush they were waiting for must
-	have ended. If the log mutex were not reserved here, the i/o-thread
-	calling this function might be preempted for a while, and when it
-	resumed execution, it might be that a new flush had been started, and
-	this function would erroneously signal the NEW flush as completed.
-	Thus, the changes in the state of these events are performed
-	atomically in conjunction with the changes in the state of
-	log_sys->n_pending_writes etc. */
-
-	if (code & LOG_UNLOCK_NONE_FLUSHED_LOCK) {
-		os_event_set(log_sys->one_flushed_event);
-	}
-
-	if (code & LOG_UNLOCK_FLUSH_LOCK) {
-		os_event_set(log_sys->no_flush_event);
-	}
-}
-
-/******************************************************************//**
-Checks if a flush is completed for a log group and does the completion
-routine if yes.
-@return	LOG_UNLOCK_NONE_FLUSHED_LOCK or 0 */
-UNIV_INLINE
-ulint
-log_group_check_flush_completion(
-/*=============================*/
-	log_group_t*	group)	/*!< in: log group */
-{
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	if (!log_sys->one_flushed && group->n_pending_writes == 0) {
-#ifdef UNIV_DEBUG
-		if (log_debug_writes) {
-			fprintf(stderr,
-				"Log flushed first to group %lu\n",
-				(ulong) group->id);
-		}
-#endif /* UNIV_DEBUG */
-		log_sys->written_to_some_lsn = log_sys->write_lsn;
-		log_sys->one_flushed = TRUE;
-
-		return(LOG_UNLOCK_NONE_FLUSHED_LOCK);
-	}
-
-#ifdef UNIV_DEBUG
-	if (log_debug_writes && (group->n_pending_writes == 0)) {
-
-		fprintf(stderr, "Log flushed to group %lu\n",
-			(ulong) group->id);
-	}
-#endif /* UNIV_DEBUG */
-	return(0);
-}
-
-/******************************************************//**
-Checks if a flush is completed and does the completion routine if yes.
-@return	LOG_UNLOCK_FLUSH_LOCK or 0 */
-static
-ulint
-log_sys_check_flush_completion(void)
-/*================================*/
-{
-	ulint	move_start;
-	ulint	move_end;
-
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	if (log_sys->n_pending_writes == 0) {
-
-		log_sys->written_to_all_lsn = log_sys->write_lsn;
-		log_sys->buf_next_to_write = log_sys->write_end_offset;
-
-		if (log_sys->write_end_offset > log_sys->max_buf_free / 2) {
-			/* Move the log buffer content to the start of the
-			buffer */
-
-			move_start = ut_calc_align_down(
-				log_sys->write_end_offset,
-				OS_FILE_LOG_BLOCK_SIZE);
-			move_end = ut_calc_align(log_sys->buf_free,
-						 OS_FILE_LOG_BLOCK_SIZE);
-
-			ut_memmove(log_sys->buf, log_sys->buf + move_start,
-				   move_end - move_start);
-			log_sys->buf_free -= move_start;
-
-			log_sys->buf_next_to_write -= move_start;
-		}
-
-		return(LOG_UNLOCK_FLUSH_LOCK);
-	}
-
-	return(0);
-}
-
 /******************************************************//**
 Completes an i/o to a log file. */
 UNIV_INTERN
@@ -1083,8 +1190,6 @@ log_io_complete(
 /*============*/
 	log_group_t*	group)	/*!< in: log group or a dummy pointer */
 {
-	ulint	unlock;
-
 #ifdef UNIV_LOG_ARCHIVE
 	if ((byte*)group == &log_archive_io) {
 		/* It was an archive write */
@@ -1119,29 +1224,6 @@ log_io_complete(
 
 	ut_error;	/*!< We currently use synchronous writing of the
 			logs and cannot end up here! */
-
-	if (srv_unix_file_flush_method != SRV_UNIX_O_DSYNC
-	    && srv_unix_file_flush_method != SRV_UNIX_NOSYNC
-	    && srv_flush_log_at_trx_commit != 2) {
-
-		fil_flush(group->space_id);
-	}
-
-	mutex_enter(&(log_sys->mutex));
-	ut_ad(!recv_no_log_write);
-
-	ut_a(group->n_pending_writes > 0);
-	ut_a(log_sys->n_pending_writes > 0);
-
-	group->n_pending_writes--;
-	log_sys->n_pending_writes--;
-
-	unlock = log_group_check_flush_completion(group);
-	unlock = unlock | log_sys_check_flush_completion();
-
-	log_flush_do_unlocks(unlock);
-
-	mutex_exit(&(log_sys->mutex));
 }
 
 /******************************************************//**
@@ -1159,7 +1241,7 @@ log_group_file_header_flush(
 	byte*	buf;
 	ulint	dest_offset;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_write_owned());
 	ut_ad(!recv_no_log_write);
 	ut_a(nth_file < group->n_files);
 
@@ -1181,9 +1263,9 @@ log_group_file_header_flush(
 	}
 #endif /* UNIV_DEBUG */
 	if (log_do_write) {
-		log_sys->n_log_ios++;
+		log_counter_add(log_sys->n_log_ios, 1);
 
-		srv_os_log_pending_writes++;
+		log_counter_add(srv_os_log_pending_writes, 1);
 
 		fil_io(OS_FILE_WRITE | OS_FILE_LOG, TRUE, group->space_id, 0,
 		       dest_offset / UNIV_PAGE_SIZE,
@@ -1191,7 +1273,7 @@ log_group_file_header_flush(
 		       OS_FILE_LOG_BLOCK_SIZE,
 		       buf, group);
 
-		srv_os_log_pending_writes--;
+		log_counter_sub(srv_os_log_pending_writes, 1);
 	}
 }
 
@@ -1231,7 +1313,7 @@ log_group_write_buf(
 	ulint	next_offset;
 	ulint	i;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_write_owned());
 	ut_ad(!recv_no_log_write);
 	ut_a(len % OS_FILE_LOG_BLOCK_SIZE == 0);
 	ut_a(((ulint) start_lsn) % OS_FILE_LOG_BLOCK_SIZE == 0);
@@ -1253,84 +1335,299 @@ loop:
 	    && write_header) {
 		/* We start to write a new log file instance in the group */
 
-		log_group_file_header_flush(group,
-					    next_offset / group->file_size,
-					    start_lsn);
-		srv_os_log_written+= OS_FILE_LOG_BLOCK_SIZE;
-		srv_log_writes++;
+		log_group_file_header_flush(group,
+					    next_offset / group->file_size,
+					    start_lsn);
+		log_counter_add(srv_os_log_written, OS_FILE_LOG_BLOCK_SIZE);
+		log_counter_add(srv_log_writes, 1);
+	}
+
+	if ((next_offset % group->file_size) + len > group->file_size) {
+
+		write_len = group->file_size
+			- (next_offset % group->file_size);
+	} else {
+		write_len = len;
+	}
+
+#ifdef UNIV_DEBUG
+	if (log_debug_writes) {
+
+		fprintf(stderr,
+			"Writing log file segment to group %lu"
+			" offset %lu len %lu\n"
+			"start lsn %llu\n"
+			"First block n:o %lu last block n:o %lu\n",
+			(ulong) group->id, (ulong) next_offset,
+			(ulong) write_len,
+			start_lsn,
+			(ulong) log_block_get_hdr_no(buf),
+			(ulong) log_block_get_hdr_no(
+				buf + write_len - OS_FILE_LOG_BLOCK_SIZE));
+		ut_a(log_block_get_hdr_no(buf)
+		     == log_block_convert_lsn_to_no(start_lsn));
+
+		for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
+
+			ut_a(log_block_get_hdr_no(buf) + i
+			     == log_block_get_hdr_no(
+				     buf + i * OS_FILE_LOG_BLOCK_SIZE));
+		}
+	}
+#endif /* UNIV_DEBUG */
+	/* Calculate the checksums for each log block and write them to
+	the trailer fields of the log blocks */
+
+	for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
+		log_block_store_checksum(buf + i * OS_FILE_LOG_BLOCK_SIZE);
+	}
+
+	if (log_do_write) {
+		log_counter_add(log_sys->n_log_ios, 1);
+
+		log_counter_add(srv_os_log_pending_writes, 1);
+
+		fil_io(OS_FILE_WRITE | OS_FILE_LOG, TRUE, group->space_id, 0,
+		       next_offset / UNIV_PAGE_SIZE,
+		       next_offset % UNIV_PAGE_SIZE, write_len, buf, group);
+
+		log_counter_sub(srv_os_log_pending_writes, 1);
+
+		log_counter_add(srv_os_log_written, write_len);
+		log_counter_add(srv_log_writes, 1);
+	}
+
+	if (write_len < len) {
+		start_lsn += write_len;
+		len -= write_len;
+		buf += write_len;
+
+		write_header = TRUE;
+
+		goto loop;
+	}
+}
+
+/******************************************************//**
+Writes the closed part of the log buffer to the log files. The caller must
+own log_sys->write_mutex, which serializes the writes. The log records are
+copied from the log buffer to log_sys->write_buf, where the block headers
+are filled in, so that mini-transactions can keep copying their records
+to the log buffer meanwhile. Without atomic builtins the write keeps
+log_sys->mutex, because the log i/o counters are then only protected by it.
+@return	TRUE if something was written */
+static
+ibool
+log_write_buffer(void)
+/*==================*/
+{
+	log_t*		log	= log_sys;
+	log_group_t*	group;
+	ib_uint64_t	start_lsn;
+	ib_uint64_t	end_lsn;
+	ib_uint64_t	area_start;
+	ulint		len;
+	ulint		offset;
+	ulint		n;
+	ulint		data_len;
+	ulint		checkpoint_no;
+	byte*		block;
+
+	ut_ad(mutex_own(&(log->write_mutex)));
+	ut_ad(!recv_no_log_write);
+
+	log_flush_order_mutex_enter();
+	end_lsn = log->closed_lsn;
+	log_flush_order_mutex_exit();
+
+	start_lsn = log->write_lsn;
+
+	if (end_lsn <= start_lsn) {
+		/* Nothing to write */
+
+		return(FALSE);
+	}
+
+#ifdef UNIV_DEBUG
+	if (log_debug_writes) {
+		fprintf(stderr,
+			"Writing log from %llu up to lsn %llu\n",
+			start_lsn, end_lsn);
+	}
+#endif /* UNIV_DEBUG */
+
+	/* Copy the blocks from the one where the previous write ended to
+	the one that contains end_lsn; log_reserve_and_open() does not let
+	mini-transactions overwrite them in the log buffer before they
+	have been written. */
+
+	area_start = ut_uint64_align_down(start_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	len = (ulint) (ut_uint64_align_down(end_lsn, OS_FILE_LOG_BLOCK_SIZE)
+		       - area_start) + OS_FILE_LOG_BLOCK_SIZE;
+
+	ut_a(len <= log->buf_size);
+
+	offset = (ulint) (area_start % log->buf_size);
+	n = ut_min(len, log->buf_size - offset);
+
+	ut_memcpy(log->write_buf, log->buf + offset, n);
+	ut_memcpy(log->write_buf + n, log->buf, len - n);
+
+	mutex_enter(&(log->mutex));
+
+	checkpoint_no = (ulint) log->next_checkpoint_no;
+
+	log->n_pending_writes++;
+
+	group = UT_LIST_GET_FIRST(log->log_groups);
+	group->n_pending_writes++;	/*!< We assume here that we have only
+					one log group! */
+#ifdef LOG_WRITE_UNLOCKED
+	mutex_exit(&(log->mutex));
+#endif /* LOG_WRITE_UNLOCKED */
+
+	/* The first_rec_group fields were filled in by
+	log_reserve_and_open(); fill in the rest of the block headers. The
+	records after end_lsn in the last block may still be being
+	copied: the block is written as if they were not there. */
+
+	for (n = 0; n < len; n += OS_FILE_LOG_BLOCK_SIZE) {
+		block = log->write_buf + n;
+
+		log_block_set_hdr_no(
+			block, log_block_convert_lsn_to_no(area_start + n));
+		log_block_set_data_len(block, OS_FILE_LOG_BLOCK_SIZE);
+		log_block_set_checkpoint_no(block, checkpoint_no);
+	}
+
+	block = log->write_buf + len - OS_FILE_LOG_BLOCK_SIZE;
+	data_len = (ulint) (end_lsn % OS_FILE_LOG_BLOCK_SIZE);
+
+	log_block_set_data_len(block, data_len);
+	memset(block + data_len, 0, OS_FILE_LOG_BLOCK_SIZE - data_len);
+
+	log_block_set_flush_bit(log->write_buf, TRUE);
+
+	log->write_lsn = end_lsn;
+
+	/* Do the write to the log files */
+
+	for (group = UT_LIST_GET_FIRST(log->log_groups);
+	     group != NULL;
+	     group = UT_LIST_GET_NEXT(log_groups, group)) {
+
+		log_group_write_buf(group, log->write_buf, len, area_start,
+				    (ulint) (start_lsn - area_start));
+	}
+
+#ifdef LOG_WRITE_UNLOCKED
+	mutex_enter(&(log->mutex));
+#endif /* LOG_WRITE_UNLOCKED */
+
+	for (group = UT_LIST_GET_FIRST(log->log_groups);
+	     group != NULL;
+	     group = UT_LIST_GET_NEXT(log_groups, group)) {
+
+		log_group_set_fields(group, end_lsn);
+	}
+
+	group = UT_LIST_GET_FIRST(log->log_groups);
+
+	ut_a(group->n_pending_writes == 1);
+	ut_a(log->n_pending_writes == 1);
+
+	group->n_pending_writes--;
+	log->n_pending_writes--;
+
+	log_lsn_advance(&log->written_to_some_lsn, end_lsn);
+	log_lsn_advance(&log->written_to_all_lsn, end_lsn);
+
+	if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC) {
+		/* O_DSYNC means the OS did not buffer the log file at all:
+		so we have also flushed to disk what we have written */
+
+		log_lsn_advance(&log->flushed_to_disk_lsn, end_lsn);
+	}
+
+	mutex_exit(&(log->mutex));
+
+	log_set_events(log->write_events, start_lsn, end_lsn);
+
+	if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC) {
+
+		log_set_events(log->flush_events, start_lsn, end_lsn);
+
+	} else if (log_lsn_read(&log->flush_requested_lsn)
+		   > log_lsn_read(&log->flushed_to_disk_lsn)
+		   && log->flusher_active) {
+
+		os_event_set(log->flusher_event);
 	}
 
-	if ((next_offset % group->file_size) + len > group->file_size) {
+	return(TRUE);
+}
 
-		write_len = group->file_size
-			- (next_offset % group->file_size);
-	} else {
-		write_len = len;
-	}
+/******************************************************//**
+Flushes the written log to disk. The caller must own log_sys->flush_mutex,
+which serializes the flushes; a write can run meanwhile. */
+static
+void
+log_flush_low(void)
+/*===============*/
+{
+	log_t*		log	= log_sys;
+	log_group_t*	group;
+	ib_uint64_t	start_lsn;
+	ib_uint64_t	flush_lsn;
 
-#ifdef UNIV_DEBUG
-	if (log_debug_writes) {
+	ut_ad(mutex_own(&(log->flush_mutex)));
 
-		fprintf(stderr,
-			"Writing log file segment to group %lu"
-			" offset %lu len %lu\n"
-			"start lsn %llu\n"
-			"First block n:o %lu last block n:o %lu\n",
-			(ulong) group->id, (ulong) next_offset,
-			(ulong) write_len,
-			start_lsn,
-			(ulong) log_block_get_hdr_no(buf),
-			(ulong) log_block_get_hdr_no(
-				buf + write_len - OS_FILE_LOG_BLOCK_SIZE));
-		ut_a(log_block_get_hdr_no(buf)
-		     == log_block_convert_lsn_to_no(start_lsn));
+	mutex_enter(&(log->mutex));
+	ut_ad(!recv_no_log_write);
 
-		for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
+	start_lsn = log->flushed_to_disk_lsn;
+	flush_lsn = log->written_to_all_lsn;
 
-			ut_a(log_block_get_hdr_no(buf) + i
-			     == log_block_get_hdr_no(
-				     buf + i * OS_FILE_LOG_BLOCK_SIZE));
-		}
-	}
-#endif /* UNIV_DEBUG */
-	/* Calculate the checksums for each log block and write them to
-	the trailer fields of the log blocks */
+	if (start_lsn >= flush_lsn) {
 
-	for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
-		log_block_store_checksum(buf + i * OS_FILE_LOG_BLOCK_SIZE);
+		mutex_exit(&(log->mutex));
+
+		return;
 	}
 
-	if (log_do_write) {
-		log_sys->n_log_ios++;
+	ut_a(log->n_pending_flushes == 0);
 
-		srv_os_log_pending_writes++;
+	log->n_pending_flushes++;
+	log->current_flush_lsn = flush_lsn;
 
-		fil_io(OS_FILE_WRITE | OS_FILE_LOG, TRUE, group->space_id, 0,
-		       next_offset / UNIV_PAGE_SIZE,
-		       next_offset % UNIV_PAGE_SIZE, write_len, buf, group);
+	mutex_exit(&(log->mutex));
 
-		srv_os_log_pending_writes--;
+	group = UT_LIST_GET_FIRST(log->log_groups);
 
-		srv_os_log_written+= write_len;
-		srv_log_writes++;
-	}
+	fil_flush(group->space_id);
 
-	if (write_len < len) {
-		start_lsn += write_len;
-		len -= write_len;
-		buf += write_len;
+	mutex_enter(&(log->mutex));
 
-		write_header = TRUE;
+	log->n_pending_flushes--;
 
-		goto loop;
-	}
+	log_lsn_advance(&log->flushed_to_disk_lsn, flush_lsn);
+
+	mutex_exit(&(log->mutex));
+
+	log_set_events(log->flush_events, start_lsn, flush_lsn);
 }
 
 /******************************************************//**
 This function is called, e.g., when a transaction wants to commit. It checks
 that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
+by the transaction. If not, it asks the log writer thread to write it, and
+the log flusher thread to flush it if the log must also be flushed to disk,
+and waits until they have done that up to lsn. The threads that wait are
+woken up by the log block of the lsn that they wait for, in
+log_sys->write_events and log_sys->flush_events, so that the threads
+that commit while a write is running are served by the next write as one
+group. Before the threads have been created and after they have exited,
+the write and the flush are done in the calling thread. */
 UNIV_INTERN
 void
 log_write_up_to(
@@ -1344,15 +1641,11 @@ log_write_up_to(
 				/*!< in: TRUE if we want the written log
 				also to be flushed to disk */
 {
-	log_group_t*	group;
-	ulint		start_offset;
-	ulint		end_offset;
-	ulint		area_start;
-	ulint		area_end;
-#ifdef UNIV_DEBUG
-	ulint		loop_count	= 0;
-#endif /* UNIV_DEBUG */
-	ulint		unlock;
+	log_t*		log	= log_sys;
+	ib_uint64_t*	done_lsn;
+	os_event_t	event;
+	ib_int64_t	sig_count;
+	ib_uint64_t	current_lsn;
 
 	if (recv_no_ibuf_operations) {
 		/* Recovery is running and no operations on the log files are
@@ -1361,236 +1654,239 @@ log_write_up_to(
 		return;
 	}
 
-loop:
-#ifdef UNIV_DEBUG
-	loop_count++;
-
-	ut_ad(loop_count < 5);
-
-# if 0
-	if (loop_count > 2) {
-		fprintf(stderr, "Log loop count %lu\n", loop_count);
-	}
-# endif
-#endif
-
-	mutex_enter(&(log_sys->mutex));
 	ut_ad(!recv_no_log_write);
 
-	if (flush_to_disk
-	    && log_sys->flushed_to_disk_lsn >= lsn) {
-
-		mutex_exit(&(log_sys->mutex));
+	current_lsn = log_get_lsn();
 
-		return;
+	if (lsn > current_lsn) {
+		lsn = current_lsn;
 	}
 
-	if (!flush_to_disk
-	    && (log_sys->written_to_all_lsn >= lsn
-		|| (log_sys->written_to_some_lsn >= lsn
-		    && wait != LOG_WAIT_ALL_GROUPS))) {
-
-		mutex_exit(&(log_sys->mutex));
-
-		return;
+	if (flush_to_disk) {
+		done_lsn = &log->flushed_to_disk_lsn;
+		event = log->flush_events[log_event_slot(lsn)];
+	} else {
+		done_lsn = wait == LOG_WAIT_ONE_GROUP
+			? &log->written_to_some_lsn
+			: &log->written_to_all_lsn;
+		event = log->write_events[log_event_slot(lsn)];
 	}
 
-	if (log_sys->n_pending_writes > 0) {
-		/* A write (+ possibly flush to disk) is running */
+	for (;;) {
+		sig_count = os_event_reset(event);
 
-		if (flush_to_disk
-		    && log_sys->current_flush_lsn >= lsn) {
-			/* The write + flush will write enough: wait for it to
-			complete  */
+		if (log_lsn_read(done_lsn) >= lsn) {
 
-			goto do_waits;
+			return;
 		}
 
-		if (!flush_to_disk
-		    && log_sys->write_lsn >= lsn) {
-			/* The write will write enough: wait for it to
-			complete  */
-
-			goto do_waits;
+		if (flush_to_disk) {
+			log_lsn_advance(&log->flush_requested_lsn, lsn);
 		}
 
-		mutex_exit(&(log_sys->mutex));
-
-		/* Wait for the write to complete and try to start a new
-		write */
-
-		os_event_wait(log_sys->no_flush_event);
-
-		goto loop;
-	}
-
-	if (!flush_to_disk
-	    && log_sys->buf_free == log_sys->buf_next_to_write) {
-		/* Nothing to write and no flush to disk requested */
-
-		mutex_exit(&(log_sys->mutex));
+		if (log_lsn_read(&log->written_to_all_lsn) < lsn) {
 
-		return;
-	}
+			log_lsn_advance(&log->write_requested_lsn, lsn);
 
-#ifdef UNIV_DEBUG
-	if (log_debug_writes) {
-		fprintf(stderr,
-			"Writing log from %llu up to lsn %llu\n",
-			log_sys->written_to_all_lsn,
-			log_sys->lsn);
-	}
-#endif /* UNIV_DEBUG */
-	log_sys->n_pending_writes++;
+			if (log->writer_active) {
+				os_event_set(log->writer_event);
+			} else {
+				mutex_enter(&(log->write_mutex));
+				log_write_buffer();
+				mutex_exit(&(log->write_mutex));
+			}
+		}
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
-	group->n_pending_writes++;	/*!< We assume here that we have only
-					one log group! */
+		/* If the log is written far enough only after we looked,
+		the writer sees our flush request and wakes the flusher */
 
-	os_event_reset(log_sys->no_flush_event);
-	os_event_reset(log_sys->one_flushed_event);
+		if (flush_to_disk
+		    && log_lsn_read(&log->written_to_all_lsn) >= lsn) {
+
+			if (log->flusher_active) {
+				os_event_set(log->flusher_event);
+			} else {
+				mutex_enter(&(log->flush_mutex));
+				log_flush_low();
+				mutex_exit(&(log->flush_mutex));
+			}
+		}
 
-	start_offset = log_sys->buf_next_to_write;
-	end_offset = log_sys->buf_free;
+		if (wait == LOG_NO_WAIT || log_lsn_read(done_lsn) >= lsn) {
 
-	area_start = ut_calc_align_down(start_offset, OS_FILE_LOG_BLOCK_SIZE);
-	area_end = ut_calc_align(end_offset, OS_FILE_LOG_BLOCK_SIZE);
+			return;
+		}
 
-	ut_ad(area_end - area_start > 0);
+		if (log->writer_active
+		    && (!flush_to_disk || log->flusher_active)) {
 
-	log_sys->write_lsn = log_sys->lsn;
+			os_event_wait_low(event, sig_count);
+		} else {
+			/* The mini-transactions before lsn have not been
+			closed yet */
 
-	if (flush_to_disk) {
-		log_sys->current_flush_lsn = log_sys->lsn;
+			os_thread_yield();
+		}
 	}
+}
 
-	log_sys->one_flushed = FALSE;
+/****************************************************************//**
+Does a syncronous flush of the log buffer to disk. */
+UNIV_INTERN
+void
+log_buffer_flush_to_disk(void)
+/*==========================*/
+{
+	log_write_up_to(log_get_lsn(), LOG_WAIT_ALL_GROUPS, TRUE);
+}
 
-	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
-	log_block_set_checkpoint_no(
-		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		log_sys->next_checkpoint_no);
+/****************************************************************//**
+This functions writes the log buffer to the log file and if 'flush'
+is set it forces a flush of the log file as well. This is meant to be
+called from background master thread only as it does not wait for
+the write (+ possible flush) to finish. */
+UNIV_INTERN
+void
+log_buffer_sync_in_background(
+/*==========================*/
+	ibool	flush)	/*!< in: flush the logs to disk */
+{
+	log_write_up_to(log_get_lsn(), LOG_NO_WAIT, flush);
+}
 
-	/* Copy the last, incompletely written, log block a log block length
-	up, so that when the flush operation writes from the log buffer, the
-	segment to write will not be changed by writers to the log */
+/******************************************************************//**
+Log writer thread. Writes the closed part of the log buffer to the log
+files when some thread waits for it in log_write_up_to(), and wakes up
+the waiting threads by the lsn that they wait for.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+log_writer_thread(
+/*==============*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	log_t*		log	= log_sys;
+	ib_int64_t	sig_count;
+	ulint		i;
 
-	ut_memcpy(log_sys->buf + area_end,
-		  log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		  OS_FILE_LOG_BLOCK_SIZE);
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
 
-	log_sys->buf_free += OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->write_end_offset = log_sys->buf_free;
+	my_thread_init();
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	for (;;) {
+		sig_count = os_event_reset(log->writer_event);
 
-	/* Do the write to the log files */
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
 
-	while (group) {
-		log_group_write_buf(
-			group, log_sys->buf + area_start,
-			area_end - area_start,
-			ut_uint64_align_down(log_sys->written_to_all_lsn,
-					     OS_FILE_LOG_BLOCK_SIZE),
-			start_offset - area_start);
+			break;
+		}
 
-		log_group_set_fields(group, log_sys->write_lsn);
+		if (log_lsn_read(&log->write_requested_lsn)
+		    > log_lsn_read(&log->written_to_all_lsn)) {
+			ibool	written;
 
-		group = UT_LIST_GET_NEXT(log_groups, group);
-	}
+			mutex_enter(&(log->write_mutex));
+			written = log_write_buffer();
+			mutex_exit(&(log->write_mutex));
 
-	mutex_exit(&(log_sys->mutex));
+			if (written) {
+				/* More log may have been closed and
+				requested while we were writing */
 
-	if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC) {
-		/* O_DSYNC means the OS did not buffer the log file at all:
-		so we have also flushed to disk what we have written */
+				continue;
+			}
+		}
 
-		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+		os_event_wait_low(log->writer_event, sig_count);
+	}
 
-	} else if (flush_to_disk) {
+	/* The threads that wait for a write now do it themselves: wake up
+	the ones that went to wait for this thread. */
 
-		group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	log->writer_active = FALSE;
 
-		fil_flush(group->space_id);
-		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+	for (i = 0; i < LOG_N_EVENTS; i++) {
+		os_event_set(log->write_events[i]);
+		os_event_set(log->flush_events[i]);
 	}
 
-	mutex_enter(&(log_sys->mutex));
+	my_thread_end();
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
 
-	ut_a(group->n_pending_writes == 1);
-	ut_a(log_sys->n_pending_writes == 1);
+	OS_THREAD_DUMMY_RETURN;
+}
 
-	group->n_pending_writes--;
-	log_sys->n_pending_writes--;
+/******************************************************************//**
+Log flusher thread. Flushes the written log to disk when some thread waits
+for it in log_write_up_to(), and wakes up the waiting threads by the lsn
+that they wait for.
+@return a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+log_flusher_thread(
+/*===============*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	log_t*		log	= log_sys;
+	ib_int64_t	sig_count;
+	ib_uint64_t	flushed_lsn;
+	ulint		i;
 
-	unlock = log_group_check_flush_completion(group);
-	unlock = unlock | log_sys_check_flush_completion();
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
 
-	log_flush_do_unlocks(unlock);
+	my_thread_init();
 
-	mutex_exit(&(log_sys->mutex));
+	for (;;) {
+		sig_count = os_event_reset(log->flusher_event);
 
-	return;
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
 
-do_waits:
-	mutex_exit(&(log_sys->mutex));
+			break;
+		}
 
-	switch (wait) {
-	case LOG_WAIT_ONE_GROUP:
-		os_event_wait(log_sys->one_flushed_event);
-		break;
-	case LOG_WAIT_ALL_GROUPS:
-		os_event_wait(log_sys->no_flush_event);
-		break;
-#ifdef UNIV_DEBUG
-	case LOG_NO_WAIT:
-		break;
-	default:
-		ut_error;
-#endif /* UNIV_DEBUG */
-	}
-}
+		flushed_lsn = log_lsn_read(&log->flushed_to_disk_lsn);
 
-/****************************************************************//**
-Does a syncronous flush of the log buffer to disk. */
-UNIV_INTERN
-void
-log_buffer_flush_to_disk(void)
-/*==========================*/
-{
-	ib_uint64_t	lsn;
+		if (log_lsn_read(&log->flush_requested_lsn) > flushed_lsn
+		    && log_lsn_read(&log->written_to_all_lsn) > flushed_lsn) {
 
-	mutex_enter(&(log_sys->mutex));
+			/* Flush all that has been written, also for the
+			threads that asked for a flush while the previous
+			one was running */
 
-	lsn = log_sys->lsn;
+			mutex_enter(&(log->flush_mutex));
+			log_flush_low();
+			mutex_exit(&(log->flush_mutex));
 
-	mutex_exit(&(log_sys->mutex));
+			continue;
+		}
 
-	log_write_up_to(lsn, LOG_WAIT_ALL_GROUPS, TRUE);
-}
+		os_event_wait_low(log->flusher_event, sig_count);
+	}
 
-/****************************************************************//**
-This functions writes the log buffer to the log file and if 'flush'
-is set it forces a flush of the log file as well. This is meant to be
-called from background master thread only as it does not wait for
-the write (+ possible flush) to finish. */
-UNIV_INTERN
-void
-log_buffer_sync_in_background(
-/*==========================*/
-	ibool	flush)	/*!< in: flush the logs to disk */
-{
-	ib_uint64_t	lsn;
+	log->flusher_active = FALSE;
 
-	mutex_enter(&(log_sys->mutex));
+	for (i = 0; i < LOG_N_EVENTS; i++) {
+		os_event_set(log->flush_events[i]);
+	}
 
-	lsn = log_sys->lsn;
+	my_thread_end();
 
-	mutex_exit(&(log_sys->mutex));
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
 
-	log_write_up_to(lsn, LOG_NO_WAIT, flush);
+	OS_THREAD_DUMMY_RETURN;
 }
 
 /********************************************************************
@@ -1603,23 +1899,14 @@ log_flush_margin(void)
 /*==================*/
 {
 	log_t*		log	= log_sys;
-	ib_uint64_t	lsn	= 0;
-
-	mutex_enter(&(log->mutex));
-
-	if (log->buf_free > log->max_buf_free) {
+	ib_uint64_t	lsn;
 
-		if (log->n_pending_writes > 0) {
-			/* A flush is running: hope that it will provide enough
-			free space */
-		} else {
-			lsn = log->lsn;
-		}
-	}
+	lsn = log_get_lsn();
 
-	mutex_exit(&(log->mutex));
+	if (lsn - ut_uint64_align_down(log_lsn_read(&log->written_to_all_lsn),
+				       OS_FILE_LOG_BLOCK_SIZE)
+	    > log->max_buf_free) {
 
-	if (lsn) {
 		log_write_up_to(lsn, LOG_NO_WAIT, FALSE);
 	}
 }
@@ -1854,7 +2141,7 @@ log_group_checkpoint(
 
 		log_sys->n_pending_checkpoint_writes++;
 
-		log_sys->n_log_ios++;
+		log_counter_add(log_sys->n_log_ios, 1);
 
 		/* We send as the last parameter the group machine address
 		added with 1, as we want to distinguish between a normal log
@@ -1937,7 +2224,7 @@ log_group_read_checkpoint_info(
 {
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
-	log_sys->n_log_ios++;
+	log_counter_add(log_sys->n_log_ios, 1);
 
 	fil_io(OS_FILE_READ | OS_FILE_LOG, TRUE, group->space_id, 0,
 	       field / UNIV_PAGE_SIZE, field % UNIV_PAGE_SIZE,
@@ -2002,7 +2289,7 @@ log_checkpoint(
 
 	/* Because log also contains headers and dummy log records,
 	if the buffer pool contains no dirty buffers, oldest_lsn
-	gets the value log_sys->lsn from the previous function,
+	gets the value log_sys->closed_lsn from the previous function,
 	and we must make sure that the log is flushed up to that
 	lsn. If there are dirty buffers in the buffer pool, then our
 	write-ahead-logging algorithm ensures that the log has been flushed
@@ -2118,7 +2405,7 @@ loop:
 
 	oldest_lsn = log_buf_pool_get_oldest_modification();
 
-	age = log->lsn - oldest_lsn;
+	age = log_get_lsn() - oldest_lsn;
 
 	if (age > log->max_modified_age_sync) {
 
@@ -2134,7 +2421,7 @@ loop:
 		advance = 0;
 	}
 
-	checkpoint_age = log->lsn - log->last_checkpoint_lsn;
+	checkpoint_age = log_get_lsn() - log->last_checkpoint_lsn;
 
 	if (checkpoint_age > log->max_checkpoint_age) {
 		/* A checkpoint is urgent: we do it synchronously */
@@ -2224,7 +2511,7 @@ loop:
 	}
 #endif /* UNIV_LOG_ARCHIVE */
 
-	log_sys->n_log_ios++;
+	log_counter_add(log_sys->n_log_ios, 1);
 
 	fil_io(OS_FILE_READ | OS_FILE_LOG, sync, group->space_id, 0,
 	       source_offset / UNIV_PAGE_SIZE, source_offset % UNIV_PAGE_SIZE,
@@ -2285,7 +2572,7 @@ log_group_archive_file_header_write(
 
 	dest_offset = nth_file * group->file_size;
 
-	log_sys->n_log_ios++;
+	log_counter_add(log_sys->n_log_ios, 1);
 
 	fil_io(OS_FILE_WRITE | OS_FILE_LOG, TRUE, group->archive_space_id,
 	       dest_offset / UNIV_PAGE_SIZE,
@@ -2318,7 +2605,7 @@ log_group_archive_completed_header_write(
 
 	dest_offset = nth_file * group->file_size + LOG_FILE_ARCH_COMPLETED;
 
-	log_sys->n_log_ios++;
+	log_counter_add(log_sys->n_log_ios, 1);
 
 	fil_io(OS_FILE_WRITE | OS_FILE_LOG, TRUE, group->archive_space_id,
 	       dest_offset / UNIV_PAGE_SIZE,
@@ -2445,7 +2732,7 @@ loop:
 
 	log_sys->n_pending_archive_ios++;
 
-	log_sys->n_log_ios++;
+	log_counter_add(log_sys->n_log_ios, 1);
 
 	fil_io(OS_FILE_WRITE | OS_FILE_LOG, FALSE, group->archive_space_id,
 	       next_offset / UNIV_PAGE_SIZE, next_offset % UNIV_PAGE_SIZE,
@@ -2670,10 +2957,10 @@ arch_none:
 
 		*n_bytes = log_sys->archive_buf_size;
 
-		if (limit_lsn >= log_sys->lsn) {
+		if (limit_lsn >= log_get_lsn()) {
 
 			limit_lsn = ut_uint64_align_down(
-				log_sys->lsn, OS_FILE_LOG_BLOCK_SIZE);
+				log_get_lsn(), OS_FILE_LOG_BLOCK_SIZE);
 		}
 	}
 
@@ -2759,7 +3046,7 @@ log_archive_all(void)
 		return;
 	}
 
-	present_lsn = log_sys->lsn;
+	present_lsn = log_get_lsn();
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -2973,7 +3260,7 @@ log_archive_archivelog(void)
 		log_sys->archiving_state = LOG_ARCH_ON;
 
 		log_sys->archived_lsn
-			= ut_uint64_align_down(log_sys->lsn,
+			= ut_uint64_align_down(log_get_lsn(),
 					       OS_FILE_LOG_BLOCK_SIZE);
 		mutex_exit(&(log_sys->mutex));
 
@@ -3007,7 +3294,7 @@ loop:
 		return;
 	}
 
-	age = log->lsn - log->archived_lsn;
+	age = log_get_lsn() - log->archived_lsn;
 
 	if (age > log->max_archived_lsn_age) {
 
@@ -3109,7 +3396,12 @@ loop:
 
 	if (srv_error_monitor_active
 	    || srv_lock_timeout_active
-	    || srv_monitor_active) {
+	    || srv_monitor_active
+	    || srv_buf_dump_thread_active
+	    || srv_buf_resize_thread_active
+	    || srv_page_cleaner_active
+	    || srv_dict_stats_thread_active
+	    || srv_fsp_preextend_thread_active) {
 		const char*	thread_active = NULL;
 
 		/* Print a message every 60 seconds if we are waiting
@@ -3123,6 +3415,16 @@ loop:
 			       thread_active = "srv_lock_timeout thread";
 		       } else if (srv_monitor_active) {
 			       thread_active = "srv_monitor_thread";
+		       } else if (srv_buf_dump_thread_active) {
+			       thread_active = "buf_dump_thread";
+		       } else if (srv_buf_resize_thread_active) {
+			       thread_active = "buf_resize_thread";
+		       } else if (srv_page_cleaner_active) {
+			       thread_active = "page_cleaner_thread";
+		       } else if (srv_dict_stats_thread_active) {
+			       thread_active = "dict_stats_thread";
+		       } else if (srv_fsp_preextend_thread_active) {
+			       thread_active = "fsp_preextend_thread";
 		       }
 		}
 
@@ -3131,6 +3433,20 @@ loop:
 		os_event_set(srv_error_event);
 		os_event_set(srv_monitor_event);
 		os_event_set(srv_timeout_event);
+		os_event_set(srv_buf_dump_event);
+		os_event_set(srv_buf_resize_event);
+
+		if (srv_page_cleaner_active) {
+			os_event_set(buf_flush_event);
+		}
+
+		if (srv_dict_stats_thread_active) {
+			os_event_set(dict_stats_event);
+		}
+
+		if (srv_fsp_preextend_thread_active) {
+			os_event_set(fsp_preextend_event);
+		}
 
 		if (thread_active) {
 			ut_print_timestamp(stderr);
@@ -3142,11 +3458,15 @@ loop:
 		goto loop;
 	}
 
+	mutex_exit(&kernel_mutex);
+
 	/* Check that there are no longer transactions, except for
 	PREPARED ones. We need this wait even for the 'very fast'
 	shutdown, because the InnoDB layer may have committed or
 	prepared transactions and we don't want to lose them. */
 
+	trx_sys_mutex_enter();
+
 	server_busy = trx_n_mysql_transactions > 0
 		|| UT_LIST_GET_LEN(trx_sys->trx_list) > trx_n_prepared;
 
@@ -3154,7 +3474,7 @@ loop:
 		ulint	total_trx = UT_LIST_GET_LEN(trx_sys->trx_list)
 				    + trx_n_mysql_transactions;
 
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		if (srv_print_verbose_log && count > 600) {
 			ut_print_timestamp(stderr);
@@ -3167,7 +3487,7 @@ loop:
 		goto loop;
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	/* Check that the background threads are suspended */
 	active_thd = srv_get_active_thread_type();
@@ -3186,6 +3506,9 @@ loop:
 			case SRV_WORKER:
 				thread_type = "worker threads";
 				break;
+			case SRV_PURGE:
+				thread_type = "purge thread";
+				break;
 			case SRV_MASTER:
 				thread_type = "master thread";
 				break;
@@ -3205,7 +3528,8 @@ loop:
 #ifdef UNIV_LOG_ARCHIVE
 		|| log_sys->n_pending_archive_ios
 #endif /* UNIV_LOG_ARCHIVE */
-		|| log_sys->n_pending_writes;
+		|| log_sys->n_pending_writes
+		|| log_sys->n_pending_flushes;
 	mutex_exit(&log_sys->mutex);
 
 	if (server_busy) {
@@ -3213,9 +3537,11 @@ loop:
 			ut_print_timestamp(stderr);
 			fprintf(stderr,
 				"  InnoDB: Pending checkpoint_writes: %lu\n"
-				"  InnoDB: Pending log flush writes: %lu\n",
+				"  InnoDB: Pending log flush writes: %lu\n"
+				"  InnoDB: Pending log flushes: %lu\n",
 				(ulong) log_sys->n_pending_checkpoint_writes,
-				(ulong) log_sys->n_pending_writes);
+				(ulong) log_sys->n_pending_writes,
+				(ulong) log_sys->n_pending_flushes);
 			count = 0;
 		}
 
@@ -3277,7 +3603,7 @@ loop:
 
 	mutex_enter(&log_sys->mutex);
 
-	lsn = log_sys->lsn;
+	lsn = log_get_lsn();
 
 	if (lsn != log_sys->last_checkpoint_lsn
 #ifdef UNIV_LOG_ARCHIVE
@@ -3341,7 +3667,7 @@ loop:
 	ut_a(srv_get_active_thread_type() == ULINT_UNDEFINED);
 
 	ut_a(buf_all_freed());
-	ut_a(lsn == log_sys->lsn);
+	ut_a(lsn == log_get_lsn());
 
 	if (lsn < srv_start_lsn) {
 		fprintf(stderr,
@@ -3363,53 +3689,75 @@ loop:
 	ut_a(srv_get_active_thread_type() == ULINT_UNDEFINED);
 
 	ut_a(buf_all_freed());
-	ut_a(lsn == log_sys->lsn);
+	ut_a(lsn == log_get_lsn());
 }
 
 #ifdef UNIV_LOG_DEBUG
 /******************************************************//**
 Checks by parsing that the catenated log segment for a single mtr is
-consistent. */
+consistent. The segment is copied out of the log buffer, where it may
+wrap around, and the block headers that log_write_buffer() would fill in
+are filled in the copy. The caller must own
+log_sys->log_flush_order_mutex and close the segment in the lsn order, so
+that recv_sys continues from where the previous segment ended. */
 UNIV_INTERN
 ibool
 log_check_log_recs(
 /*===============*/
-	const byte*	buf,		/*!< in: pointer to the start of
-					the log segment in the
-					log_sys->buf log buffer */
-	ulint		len,		/*!< in: segment length in bytes */
-	ib_uint64_t	buf_start_lsn)	/*!< in: buffer start lsn */
+	ib_uint64_t	start_lsn,	/*!< in: start lsn of the segment */
+	ib_uint64_t	end_lsn)	/*!< in: end lsn of the segment */
 {
+	log_t*		log	= log_sys;
 	ib_uint64_t	contiguous_lsn;
 	ib_uint64_t	scanned_lsn;
-	const byte*	start;
-	const byte*	end;
+	ib_uint64_t	area_start;
+	ulint		len;
+	ulint		offset;
+	ulint		n;
 	byte*		buf1;
 	byte*		scan_buf;
+	byte*		block;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(log_flush_order_mutex_own());
+	ut_ad(log->closed_lsn == start_lsn);
 
-	if (len == 0) {
+	if (end_lsn == start_lsn) {
 
 		return(TRUE);
 	}
 
-	start = ut_align_down(buf, OS_FILE_LOG_BLOCK_SIZE);
-	end = ut_align(buf + len, OS_FILE_LOG_BLOCK_SIZE);
+	area_start = ut_uint64_align_down(start_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	len = (ulint) (ut_uint64_align_down(end_lsn, OS_FILE_LOG_BLOCK_SIZE)
+		       - area_start) + OS_FILE_LOG_BLOCK_SIZE;
 
-	buf1 = mem_alloc((end - start) + OS_FILE_LOG_BLOCK_SIZE);
+	buf1 = mem_alloc(len + OS_FILE_LOG_BLOCK_SIZE);
 	scan_buf = ut_align(buf1, OS_FILE_LOG_BLOCK_SIZE);
 
-	ut_memcpy(scan_buf, start, end - start);
+	offset = (ulint) (area_start % log->buf_size);
+	n = ut_min(len, log->buf_size - offset);
+
+	ut_memcpy(scan_buf, log->buf + offset, n);
+	ut_memcpy(scan_buf + n, log->buf, len - n);
+
+	for (n = 0; n < len; n += OS_FILE_LOG_BLOCK_SIZE) {
+		block = scan_buf + n;
+
+		log_block_set_hdr_no(
+			block, log_block_convert_lsn_to_no(area_start + n));
+		log_block_set_data_len(block, OS_FILE_LOG_BLOCK_SIZE);
+		log_block_set_checkpoint_no(
+			block, (ulint) log->next_checkpoint_no);
+	}
+
+	log_block_set_data_len(scan_buf + len - OS_FILE_LOG_BLOCK_SIZE,
+			       (ulint) (end_lsn % OS_FILE_LOG_BLOCK_SIZE));
 
 	recv_scan_log_recs((buf_pool_get_n_pages()
 			   - (recv_n_pool_free_frames * srv_buf_pool_instances))
-			   * UNIV_PAGE_SIZE, FALSE, scan_buf, end - start,
-			   ut_uint64_align_down(buf_start_lsn,
-						OS_FILE_LOG_BLOCK_SIZE),
+			   * UNIV_PAGE_SIZE, FALSE, scan_buf, len, area_start,
 			   &contiguous_lsn, &scanned_lsn);
 
-	ut_a(scanned_lsn == buf_start_lsn + len);
+	ut_a(scanned_lsn == end_lsn);
 	ut_a(recv_sys->recovered_lsn == scanned_lsn);
 
 	mem_free(buf1);
@@ -3419,7 +3767,8 @@ log_check_log_recs(
 #endif /* UNIV_LOG_DEBUG */
 
 /******************************************************//**
-Peeks the current lsn.
+Peeks the current lsn. This no longer needs the log system mutex, because
+the lsn is reserved with an atomic add.
 @return	TRUE if success, FALSE if could not get the log system mutex */
 UNIV_INTERN
 ibool
@@ -3427,15 +3776,9 @@ log_peek_lsn(
 /*=========*/
 	ib_uint64_t*	lsn)	/*!< out: if returns TRUE, current lsn is here */
 {
-	if (0 == mutex_enter_nowait(&(log_sys->mutex))) {
-		*lsn = log_sys->lsn;
-
-		mutex_exit(&(log_sys->mutex));
+	*lsn = log_get_lsn();
 
-		return(TRUE);
-	}
-
-	return(FALSE);
+	return(TRUE);
 }
 
 /******************************************************//**
@@ -3455,7 +3798,7 @@ log_print(
 		"Log sequence number %llu\n"
 		"Log flushed up to   %llu\n"
 		"Last checkpoint at  %llu\n",
-		log_sys->lsn,
+		log_get_lsn(),
 		log_sys->flushed_to_disk_lsn,
 		log_sys->last_checkpoint_lsn);
 
@@ -3527,6 +3870,7 @@ log_shutdown(void)
 /*==============*/
 {
 	log_group_t*	group;
+	ulint		i;
 
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
@@ -3546,22 +3890,34 @@ log_shutdown(void)
 	log_sys->checkpoint_buf_ptr = NULL;
 	log_sys->checkpoint_buf = NULL;
 
-	os_event_free(log_sys->no_flush_event);
-	os_event_free(log_sys->one_flushed_event);
+	mem_free(log_sys->write_buf_ptr);
+	log_sys->write_buf_ptr = NULL;
+	log_sys->write_buf = NULL;
+
+	os_event_free(log_sys->writer_event);
+	os_event_free(log_sys->flusher_event);
+
+	for (i = 0; i < LOG_N_EVENTS; i++) {
+		os_event_free(log_sys->close_events[i]);
+		os_event_free(log_sys->write_events[i]);
+		os_event_free(log_sys->flush_events[i]);
+	}
 
 	rw_lock_free(&log_sys->checkpoint_lock);
 
 	mutex_free(&log_sys->mutex);
+	mutex_free(&log_sys->write_mutex);
+	mutex_free(&log_sys->flush_mutex);
+
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	os_fast_mutex_free(&log_sys->lsn_mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
 
 #ifdef UNIV_LOG_ARCHIVE
 	rw_lock_free(&log_sys->archive_lock);
 	os_event_create(log_sys->archiving_on);
 #endif /* UNIV_LOG_ARCHIVE */
 
-#ifdef UNIV_LOG_DEBUG
-	recv_sys_debug_free();
-#endif
-
 	recv_sys_close();
 }
 
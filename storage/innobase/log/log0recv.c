@@ -62,7 +62,13 @@ this must be less than UNIV_PAGE_SIZE as it is stored in the buffer pool */
 #define RECV_DATA_BLOCK_SIZE	(MEM_MAX_ALLOC_IN_BUF - sizeof(recv_data_t))
 
 /** Read-ahead area in applying log records to file pages */
-#define RECV_READ_AHEAD_AREA	32
+#define RECV_READ_AHEAD_AREA	64
+
+#ifndef UNIV_HOTBACKUP
+/** Number of threads, including the calling thread, among which
+recv_apply_hashed_log_recs() divides the hash cells in the current batch */
+static ulint	recv_n_apply_threads;
+#endif /* !UNIV_HOTBACKUP */
 
 /** The recovery system */
 UNIV_INTERN recv_sys_t*	recv_sys = NULL;
@@ -824,8 +830,11 @@ recv_read_cp_info_for_backup(
 
 /******************************************************//**
 Checks the 4-byte checksum to the trailer checksum field of a log
-block.  We also accept a log block in the old format before
-InnoDB-3.23.52 where the checksum field contains the log block number.
+block.  Both the CRC32 and the legacy InnoDB checksum are accepted,
+regardless of innodb_checksum_algorithm, so that a log written with
+another setting can still be applied.  We also accept a log block in
+the old format before InnoDB-3.23.52 where the checksum field contains
+the log block number.
 @return TRUE if ok, or if the log block may be in the format of InnoDB
 version predating 3.23.52 */
 static
@@ -837,7 +846,10 @@ log_block_checksum_is_ok_or_old_format(
 #ifdef UNIV_LOG_DEBUG
 	return(TRUE);
 #endif /* UNIV_LOG_DEBUG */
-	if (log_block_calc_checksum(block) == log_block_get_checksum(block)) {
+	if (log_block_calc_checksum_innodb(block)
+	    == log_block_get_checksum(block)
+	    || log_block_calc_checksum_crc32(block)
+	    == log_block_get_checksum(block)) {
 
 		return(TRUE);
 	}
@@ -1729,49 +1741,60 @@ recv_read_in_area(
 }
 
 /*******************************************************************//**
-Empties the hash table of stored log records, applying them to appropriate
-pages. */
-UNIV_INTERN
+Prints the progress of the current apply batch in percents of the hashed
+file addresses that have been processed, if it has changed since the
+last call. The caller must own recv_sys->mutex. */
+static
 void
-recv_apply_hashed_log_recs(
-/*=======================*/
-	ibool	allow_ibuf)	/*!< in: if TRUE, also ibuf operations are
-				allowed during the application; if FALSE,
-				no ibuf operations are allowed, and after
-				the application all file pages are flushed to
-				disk and invalidated in buffer pool: this
-				alternative means that no new log records
-				can be generated during the application;
-				the caller must in this case own the log
-				mutex */
+recv_apply_print_progress(
+/*======================*/
+	ulint*	last_pct)	/*!< in/out: last printed percentage */
 {
-	recv_addr_t* recv_addr;
-	ulint	i;
-	ulint	n_pages;
-	ibool	has_printed	= FALSE;
-	mtr_t	mtr;
-loop:
-	mutex_enter(&(recv_sys->mutex));
+	ulint	pct;
 
-	if (recv_sys->apply_batch_on) {
-
-		mutex_exit(&(recv_sys->mutex));
+	ut_ad(mutex_own(&recv_sys->mutex));
 
-		os_thread_sleep(500000);
+	if (recv_sys->n_batch_addrs == 0) {
 
-		goto loop;
+		return;
 	}
 
-	ut_ad(!allow_ibuf == mutex_own(&log_sys->mutex));
+	pct = ((recv_sys->n_batch_addrs - recv_sys->n_addrs) * 100)
+		/ recv_sys->n_batch_addrs;
 
-	if (!allow_ibuf) {
-		recv_no_ibuf_operations = TRUE;
+	if (pct != *last_pct && pct < 100) {
+		fprintf(stderr, "%lu ", (ulong) pct);
+		*last_pct = pct;
 	}
+}
 
-	recv_sys->apply_log_recs = TRUE;
-	recv_sys->apply_batch_on = TRUE;
+/*******************************************************************//**
+Applies the hashed log records of the pages in the hash cells assigned to
+one apply thread: cell i belongs to thread i % n_threads. Pages that are
+in the buffer pool are recovered directly, the others are read in around
+the page and recovered by the i/o handler threads when the read completes.
+The pages are independent of each other, so the threads do not have to
+coordinate beyond the state field of recv_addr. */
+static
+void
+recv_apply_hashed_log_recs_low(
+/*===========================*/
+	ulint	thread_no,	/*!< in: number of this apply thread */
+	ulint	n_threads,	/*!< in: total number of apply threads */
+	ulint*	last_pct)	/*!< in/out: last printed progress
+				percentage, or NULL if this thread does
+				not print progress */
+{
+	recv_addr_t*	recv_addr;
+	ulint		n_cells;
+	ulint		i;
+	mtr_t		mtr;
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
+	n_cells = hash_get_n_cells(recv_sys->addr_hash);
+
+	mutex_enter(&(recv_sys->mutex));
+
+	for (i = thread_no; i < n_cells; i += n_threads) {
 
 		recv_addr = HASH_GET_FIRST(recv_sys->addr_hash, i);
 
@@ -1781,15 +1804,6 @@ loop:
 			ulint	page_no = recv_addr->page_no;
 
 			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ut_print_timestamp(stderr);
-					fputs("  InnoDB: Starting an"
-					      " apply batch of log records"
-					      " to the database...\n"
-					      "InnoDB: Progress in percents: ",
-					      stderr);
-					has_printed = TRUE;
-				}
 
 				mutex_exit(&(recv_sys->mutex));
 
@@ -1817,26 +1831,132 @@ loop:
 			recv_addr = HASH_GET_NEXT(addr_hash, recv_addr);
 		}
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
-
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
+		if (last_pct) {
+			recv_apply_print_progress(last_pct);
 		}
 	}
 
-	/* Wait until all the pages have been processed */
+	mutex_exit(&(recv_sys->mutex));
+}
+
+/*******************************************************************//**
+A redo log apply worker thread. It is started by
+recv_apply_hashed_log_recs() for the duration of one apply batch.
+@return a dummy parameter */
+static
+os_thread_ret_t
+recv_apply_thread(
+/*==============*/
+	void*	arg)	/*!< in: number of this apply thread */
+{
+	recv_apply_hashed_log_recs_low((ulint) arg, recv_n_apply_threads,
+				       NULL);
+
+	mutex_enter(&(recv_sys->mutex));
+	ut_a(recv_sys->n_apply_threads > 0);
+	recv_sys->n_apply_threads--;
+	mutex_exit(&(recv_sys->mutex));
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
 
-	while (recv_sys->n_addrs != 0) {
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*******************************************************************//**
+Empties the hash table of stored log records, applying them to appropriate
+pages. The hash cells are divided among srv_n_recovery_threads threads,
+the calling thread being one of them. */
+UNIV_INTERN
+void
+recv_apply_hashed_log_recs(
+/*=======================*/
+	ibool	allow_ibuf)	/*!< in: if TRUE, also ibuf operations are
+				allowed during the application; if FALSE,
+				no ibuf operations are allowed, and after
+				the application all file pages are flushed to
+				disk and invalidated in buffer pool: this
+				alternative means that no new log records
+				can be generated during the application;
+				the caller must in this case own the log
+				mutex */
+{
+	ulint	i;
+	ulint	n_pages;
+	ulint	n_threads;
+	ulint	last_pct	= ULINT_UNDEFINED;
+	ibool	has_printed	= FALSE;
+	ullint	start_time;
+loop:
+	mutex_enter(&(recv_sys->mutex));
+
+	if (recv_sys->apply_batch_on) {
 
 		mutex_exit(&(recv_sys->mutex));
 
 		os_thread_sleep(500000);
 
+		goto loop;
+	}
+
+	ut_ad(!allow_ibuf == mutex_own(&log_sys->mutex));
+
+	if (!allow_ibuf) {
+		recv_no_ibuf_operations = TRUE;
+	}
+
+	recv_sys->apply_log_recs = TRUE;
+	recv_sys->apply_batch_on = TRUE;
+	recv_sys->n_batch_addrs = recv_sys->n_addrs;
+
+	n_threads = ut_min(srv_n_recovery_threads,
+			   hash_get_n_cells(recv_sys->addr_hash));
+	ut_a(n_threads >= 1);
+	recv_n_apply_threads = n_threads;
+
+	start_time = ut_time_us(NULL);
+
+	if (recv_sys->n_addrs > 0) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Starting an apply batch of log records"
+			" to %lu pages up to log sequence number %llu"
+			" using %lu threads...\n"
+			"InnoDB: Progress in percents: ",
+			(ulong) recv_sys->n_addrs, recv_sys->recovered_lsn,
+			(ulong) n_threads);
+		has_printed = TRUE;
+	}
+
+	recv_sys->n_apply_threads = n_threads - 1;
+
+	mutex_exit(&(recv_sys->mutex));
+
+	for (i = 1; i < n_threads; i++) {
+		os_thread_create(recv_apply_thread, (void*) i, NULL);
+	}
+
+	recv_apply_hashed_log_recs_low(0, n_threads,
+				       has_printed ? &last_pct : NULL);
+
+	/* Wait until the worker threads have scanned their hash cells and
+	all the pages have been processed */
+
+	mutex_enter(&(recv_sys->mutex));
+
+	while (recv_sys->n_apply_threads != 0 || recv_sys->n_addrs != 0) {
+
+		mutex_exit(&(recv_sys->mutex));
+
+		os_thread_sleep(100000);
+
 		mutex_enter(&(recv_sys->mutex));
+
+		if (has_printed) {
+			recv_apply_print_progress(&last_pct);
+		}
 	}
 
 	if (has_printed) {
@@ -1872,7 +1992,11 @@ loop:
 	recv_sys_empty_hash();
 
 	if (has_printed) {
-		fprintf(stderr, "InnoDB: Apply batch completed\n");
+		fprintf(stderr,
+			"InnoDB: Apply batch completed up to log sequence"
+			" number %llu in %.1f seconds\n",
+			recv_sys->recovered_lsn,
+			(ut_time_us(NULL) - start_time) / 1000000.0);
 	}
 
 	mutex_exit(&(recv_sys->mutex));
@@ -2076,11 +2200,7 @@ recv_parse_log_rec(
 #ifdef UNIV_LOG_LSN_DEBUG
 	if (*type == MLOG_LSN) {
 		ib_uint64_t	lsn = (ib_uint64_t) *space << 32 | *page_no;
-# ifdef UNIV_LOG_DEBUG
-		ut_a(lsn == log_sys->old_lsn);
-# else /* UNIV_LOG_DEBUG */
 		ut_a(lsn == recv_sys->recovered_lsn);
-# endif /* UNIV_LOG_DEBUG */
 	}
 #endif /* UNIV_LOG_LSN_DEBUG */
 
@@ -2236,7 +2356,10 @@ recv_parse_log_recs(
 	byte*		body;
 	ulint		n_recs;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	/* The debug check of log_check_log_recs() is serialized by
+	log_sys->log_flush_order_mutex instead of log_sys->mutex */
+	ut_ad(mutex_own(&(log_sys->mutex))
+	      || (!store_to_hash && log_flush_order_mutex_own()));
 	ut_ad(recv_sys->parse_start_lsn != 0);
 loop:
 	ptr = recv_sys->buf + recv_sys->recovered_offset;
@@ -3212,14 +3335,7 @@ recv_recovery_from_checkpoint_start_func(
 		srv_start_lsn = recv_sys->recovered_lsn;
 	}
 
-	log_sys->lsn = recv_sys->recovered_lsn;
-
-	ut_memcpy(log_sys->buf, recv_sys->last_block, OS_FILE_LOG_BLOCK_SIZE);
-
-	log_sys->buf_free = (ulint) log_sys->lsn % OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->buf_next_to_write = log_sys->buf_free;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_buffer_reset(recv_sys->recovered_lsn, recv_sys->last_block);
 
 	log_sys->last_checkpoint_lsn = checkpoint_lsn;
 
@@ -3362,12 +3478,12 @@ recv_reset_logs(
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
-	log_sys->lsn = ut_uint64_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
+	lsn = ut_uint64_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
 
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
 	while (group) {
-		group->lsn = log_sys->lsn;
+		group->lsn = lsn;
 		group->lsn_offset = LOG_FILE_HDR_SIZE;
 #ifdef UNIV_LOG_ARCHIVE
 		group->archived_file_no = arch_log_no;
@@ -3382,22 +3498,14 @@ recv_reset_logs(
 		group = UT_LIST_GET_NEXT(log_groups, group);
 	}
 
-	log_sys->buf_next_to_write = 0;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
-
 	log_sys->next_checkpoint_no = 0;
 	log_sys->last_checkpoint_lsn = 0;
 
 #ifdef UNIV_LOG_ARCHIVE
-	log_sys->archived_lsn = log_sys->lsn;
+	log_sys->archived_lsn = lsn;
 #endif /* UNIV_LOG_ARCHIVE */
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
+	log_buffer_reset(lsn + LOG_BLOCK_HDR_SIZE, NULL);
 
 	mutex_exit(&(log_sys->mutex));
 
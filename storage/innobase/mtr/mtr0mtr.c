@@ -186,6 +186,7 @@ mtr_log_reserve_and_write(
 	dyn_block_t*	block;
 	ulint		data_size;
 	byte*		first_data;
+	ib_uint64_t	lsn;
 
 	ut_ad(mtr);
 
@@ -200,52 +201,71 @@ mtr_log_reserve_and_write(
 				     | MLOG_SINGLE_REC_FLAG);
 	}
 
-	if (mlog->heap == NULL) {
-		mtr->end_lsn = log_reserve_and_write_fast(
-			first_data, dyn_block_get_used(mlog),
-			&mtr->start_lsn);
-		if (mtr->end_lsn) {
-
-			/* Success. We have the log mutex.
-			Add pages to flush list and exit */
-			goto func_exit;
-		}
-	}
-
-	data_size = dyn_array_get_data_size(mlog);
-
-	/* Open the database log for log_write_low */
-	mtr->start_lsn = log_reserve_and_open(data_size);
-
 	if (mtr->log_mode == MTR_LOG_ALL) {
 
+		data_size = dyn_array_get_data_size(mlog);
+#ifdef UNIV_LOG_LSN_DEBUG
+		data_size += MTR_LSN_REC_LEN;
+#endif /* UNIV_LOG_LSN_DEBUG */
+
+		/* Reserve the space in the log buffer with an atomic add,
+		and copy the log records to it without holding any mutex,
+		concurrently with the other mini-transactions */
+		mtr->start_lsn = log_reserve_and_open(data_size,
+						      &mtr->end_lsn);
+
+		lsn = mtr->start_lsn;
+#ifdef UNIV_LOG_LSN_DEBUG
+		{
+			/* Write the LSN pseudo-record. The lsn is only
+			known after the reservation: write its two parts,
+			as a pseudo space id and page number, in the
+			5-byte form of the compressed format, so that the
+			length of the record does not depend on it. */
+			byte	lsn_rec[MTR_LSN_REC_LEN];
+
+			lsn_rec[0] = MLOG_LSN
+				| (MLOG_SINGLE_REC_FLAG & *first_data);
+			lsn_rec[1] = 0xF0;
+			mach_write_to_4(lsn_rec + 2,
+					(ulint) (mtr->start_lsn >> 32));
+			lsn_rec[6] = 0xF0;
+			mach_write_to_4(lsn_rec + 7,
+					(ulint) (mtr->start_lsn
+						 & 0xFFFFFFFFUL));
+
+			lsn = log_write_low(lsn, lsn_rec, sizeof lsn_rec);
+		}
+#endif /* UNIV_LOG_LSN_DEBUG */
 		block = mlog;
 
 		while (block != NULL) {
-			log_write_low(dyn_block_get_data(block),
-				      dyn_block_get_used(block));
+			lsn = log_write_low(lsn, dyn_block_get_data(block),
+					    dyn_block_get_used(block));
 			block = dyn_array_get_next_block(mlog, block);
 		}
+
+		ut_ad(lsn == mtr->end_lsn);
+
+		/* Wait for the preceding mini-transactions to close, so
+		that the pages are inserted to the flush lists in the lsn
+		order */
+		log_wait_for_close(mtr->start_lsn);
 	} else {
 		ut_ad(mtr->log_mode == MTR_LOG_NONE);
-		/* Do nothing */
-	}
-
-	mtr->end_lsn = log_close();
 
-func_exit:
-	log_flush_order_mutex_enter();
+		/* Nothing is written to the log: the modifications are
+		stamped with the lsn where the closed log ends */
+		log_flush_order_mutex_enter();
 
-	/* It is now safe to release the log mutex because the
-	flush_order mutex will ensure that we are the first one
-	to insert into the flush list. */
-	log_release();
+		mtr->start_lsn = mtr->end_lsn = log_sys->closed_lsn;
+	}
 
 	if (mtr->modifications) {
 		mtr_memo_note_modifications(mtr);
 	}
 
-	log_flush_order_mutex_exit();
+	log_close(mtr->start_lsn, mtr->end_lsn);
 }
 #endif /* !UNIV_HOTBACKUP */
 
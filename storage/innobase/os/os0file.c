@@ -2074,6 +2074,49 @@ error_handling:
 	return(FALSE);
 }
 
+/***********************************************************************//**
+Allocates disk space for a range of a file with posix_fallocate(), without
+writing to it. The allocated range reads as zeros. The file is extended if
+the range ends past its end.
+@return	TRUE if success, FALSE if posix_fallocate() is not available or
+failed; the caller may then write zeros to the range instead */
+UNIV_INTERN
+ibool
+os_file_allocate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file or path as a
+				null-terminated string */
+	os_file_t	file,	/*!< in: handle to a file */
+	ib_int64_t	offset,	/*!< in: start of the range in bytes */
+	ib_int64_t	len)	/*!< in: length of the range in bytes */
+{
+#ifdef HAVE_POSIX_FALLOCATE
+	int	err;
+
+	do {
+		err = posix_fallocate(file, (off_t) offset, (off_t) len);
+	} while (err == EINTR);
+
+	if (err == 0) {
+
+		return(TRUE);
+	}
+
+	/* EINVAL or EOPNOTSUPP means that the file system does not
+	support it; let the caller write the range instead. Report
+	other errors, such as running out of disk space. */
+	if (err != EINVAL && err != EOPNOTSUPP) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Error: posix_fallocate() of %llu bytes"
+			" at offset %llu of file %s failed with error %d\n",
+			(ullint) len, (ullint) offset, name, err);
+	}
+#endif /* HAVE_POSIX_FALLOCATE */
+
+	return(FALSE);
+}
+
 /***********************************************************************//**
 Truncates a file at its current position.
 @return	TRUE if success */
@@ -2091,6 +2134,40 @@ os_file_set_eof(
 #endif /* __WIN__ */
 }
 
+/***********************************************************************//**
+Truncates a file to the given size.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+os_file_truncate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file or path as a
+				null-terminated string */
+	os_file_t	file,	/*!< in: handle to a file */
+	ib_int64_t	size)	/*!< in: new size of the file in bytes */
+{
+#ifdef __WIN__
+	LARGE_INTEGER	length;
+
+	length.QuadPart = size;
+
+	if (SetFilePointerEx(file, length, NULL, FILE_BEGIN)
+	    && SetEndOfFile(file)) {
+
+		return(TRUE);
+	}
+#else /* __WIN__ */
+	if (!ftruncate(file, (off_t) size)) {
+
+		return(TRUE);
+	}
+#endif /* __WIN__ */
+
+	os_file_handle_error_no_exit(name, "truncate");
+
+	return(FALSE);
+}
+
 #ifndef __WIN__
 /***********************************************************************//**
 Wrapper to fsync(2) that retries the call on some errors.
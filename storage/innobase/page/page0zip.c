@@ -36,12 +36,15 @@ Created June 2005 by Marko Makela
 #include "btr0cur.h"
 #include "page0types.h"
 #include "log0recv.h"
+#include "srv0srv.h"
+#include "ut0crc32.h"
 #include "zlib.h"
 #ifndef UNIV_HOTBACKUP
 # include "buf0lru.h"
 # include "btr0sea.h"
 # include "dict0boot.h"
 # include "lock0lock.h"
+# include "hash0hash.h"
 #else /* !UNIV_HOTBACKUP */
 # define lock_move_reorganize_page(block, temp_block)	((void) 0)
 # define buf_LRU_stat_inc_unzip()			((void) 0)
@@ -50,6 +53,209 @@ Created June 2005 by Marko Makela
 #ifndef UNIV_HOTBACKUP
 /** Statistics on compression, indexed by page_zip_des_t::ssize - 1 */
 UNIV_INTERN page_zip_stat_t page_zip_stat[PAGE_ZIP_NUM_SSIZE - 1];
+
+/** Statistics on compression, per index id; protected by
+page_zip_stat_per_index_mutex */
+static hash_table_t*	page_zip_stat_per_index;
+/** Mutex protecting page_zip_stat_per_index */
+static mutex_t		page_zip_stat_per_index_mutex;
+/** Number of hash cells in page_zip_stat_per_index */
+#define PAGE_ZIP_STAT_PER_INDEX_CELLS	1024
+
+# ifdef UNIV_PFS_MUTEX
+/* Key to register page_zip_stat_per_index_mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	page_zip_stat_per_index_mutex_key;
+# endif /* UNIV_PFS_MUTEX */
+#endif /* !UNIV_HOTBACKUP */
+
+/** zlib compression level of compressed pages */
+UNIV_INTERN ulong	page_zip_level = DEFAULT_COMPRESSION_LEVEL;
+
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Creates the per-index compression statistics. */
+UNIV_INTERN
+void
+page_zip_stat_per_index_init(void)
+/*==============================*/
+{
+	ut_ad(page_zip_stat_per_index == NULL);
+
+	page_zip_stat_per_index = hash_create(PAGE_ZIP_STAT_PER_INDEX_CELLS);
+
+	mutex_create(page_zip_stat_per_index_mutex_key,
+		     &page_zip_stat_per_index_mutex, SYNC_ANY_LATCH);
+}
+
+/**********************************************************************//**
+Frees the elements of page_zip_stat_per_index. The caller must hold
+page_zip_stat_per_index_mutex, unless the statistics are being freed
+at shutdown. */
+static
+void
+page_zip_stat_per_index_free_all(void)
+/*==================================*/
+{
+	ulint	i;
+
+	for (i = 0; i < hash_get_n_cells(page_zip_stat_per_index); i++) {
+		page_zip_stat_per_index_t*	s;
+
+		s = HASH_GET_FIRST(page_zip_stat_per_index, i);
+
+		while (s) {
+			page_zip_stat_per_index_t*	next
+				= HASH_GET_NEXT(hash, s);
+
+			ut_free(s);
+			s = next;
+		}
+	}
+
+	hash_table_clear(page_zip_stat_per_index);
+}
+
+/**********************************************************************//**
+Frees the per-index compression statistics. */
+UNIV_INTERN
+void
+page_zip_stat_per_index_close(void)
+/*===============================*/
+{
+	if (page_zip_stat_per_index == NULL) {
+
+		return;
+	}
+
+	page_zip_stat_per_index_free_all();
+	hash_table_free(page_zip_stat_per_index);
+	page_zip_stat_per_index = NULL;
+
+	mutex_free(&page_zip_stat_per_index_mutex);
+}
+
+/**********************************************************************//**
+Discards the per-index compression statistics collected so far. */
+UNIV_INTERN
+void
+page_zip_stat_per_index_reset(void)
+/*===============================*/
+{
+	if (page_zip_stat_per_index == NULL) {
+
+		return;
+	}
+
+	mutex_enter(&page_zip_stat_per_index_mutex);
+	page_zip_stat_per_index_free_all();
+	mutex_exit(&page_zip_stat_per_index_mutex);
+}
+
+/**********************************************************************//**
+Copies the per-index compression statistics, and optionally discards
+them.
+@return	array of statistics allocated from heap, or NULL if empty */
+UNIV_INTERN
+page_zip_stat_per_index_t*
+page_zip_stat_per_index_copy(
+/*=========================*/
+	mem_heap_t*	heap,	/*!< in: memory heap for the copy */
+	ulint*		n,	/*!< out: number of elements in the copy */
+	ibool		reset)	/*!< in: TRUE=discard the statistics */
+{
+	page_zip_stat_per_index_t*	copy;
+	page_zip_stat_per_index_t*	s;
+	ulint				i;
+
+	*n = 0;
+
+	if (page_zip_stat_per_index == NULL) {
+
+		return(NULL);
+	}
+
+	mutex_enter(&page_zip_stat_per_index_mutex);
+
+	for (i = 0; i < hash_get_n_cells(page_zip_stat_per_index); i++) {
+		for (s = HASH_GET_FIRST(page_zip_stat_per_index, i);
+		     s != NULL; s = HASH_GET_NEXT(hash, s)) {
+			(*n)++;
+		}
+	}
+
+	copy = *n ? mem_heap_alloc(heap, *n * sizeof *copy) : NULL;
+	*n = 0;
+
+	for (i = 0; i < hash_get_n_cells(page_zip_stat_per_index); i++) {
+		for (s = HASH_GET_FIRST(page_zip_stat_per_index, i);
+		     s != NULL; s = HASH_GET_NEXT(hash, s)) {
+			copy[(*n)++] = *s;
+		}
+	}
+
+	if (reset) {
+		page_zip_stat_per_index_free_all();
+	}
+
+	mutex_exit(&page_zip_stat_per_index_mutex);
+
+	return(copy);
+}
+
+/**********************************************************************//**
+Adds a compression or decompression to the statistics of an index, if
+innodb_cmp_per_index_enabled is set. */
+static
+void
+page_zip_stat_per_index_add(
+/*========================*/
+	index_id_t	id,	/*!< in: index id */
+	ibool		compress,/*!< in: TRUE=compression,
+				FALSE=decompression */
+	ibool		ok,	/*!< in: TRUE if the compression
+				succeeded */
+	ullint		usec)	/*!< in: duration in microseconds */
+{
+	page_zip_stat_per_index_t*	s;
+	ulint				fold;
+
+	if (!srv_cmp_per_index_enabled
+	    || UNIV_UNLIKELY(page_zip_stat_per_index == NULL)) {
+
+		return;
+	}
+
+	fold = ut_fold_ull(id);
+
+	mutex_enter(&page_zip_stat_per_index_mutex);
+
+	HASH_SEARCH(hash, page_zip_stat_per_index, fold,
+		    page_zip_stat_per_index_t*, s,
+		    ut_ad(s != NULL), s->id == id);
+
+	if (s == NULL) {
+		s = ut_malloc(sizeof *s);
+		memset(s, 0, sizeof *s);
+		s->id = id;
+
+		HASH_INSERT(page_zip_stat_per_index_t, hash,
+			    page_zip_stat_per_index, fold, s);
+	}
+
+	if (compress) {
+		s->stat.compressed++;
+		s->stat.compressed_usec += usec;
+
+		if (ok) {
+			s->stat.compressed_ok++;
+		}
+	} else {
+		s->stat.decompressed++;
+		s->stat.decompressed_usec += usec;
+	}
+
+	mutex_exit(&page_zip_stat_per_index_mutex);
+}
 #endif /* !UNIV_HOTBACKUP */
 
 /* Please refer to ../include/page0zip.ic for a description of the
@@ -1282,7 +1488,7 @@ page_zip_compress(
 	/* Compress the data payload. */
 	page_zip_set_alloc(&c_stream, heap);
 
-	err = deflateInit2(&c_stream, Z_DEFAULT_COMPRESSION,
+	err = deflateInit2(&c_stream, (int) page_zip_level,
 			   Z_DEFLATED, UNIV_PAGE_SIZE_SHIFT,
 			   MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
 	ut_a(err == Z_OK);
@@ -1395,8 +1601,13 @@ err_exit:
 		}
 #endif /* PAGE_ZIP_COMPRESS_DBG */
 #ifndef UNIV_HOTBACKUP
-		page_zip_stat[page_zip->ssize - 1].compressed_usec
-			+= ut_time_us(NULL) - usec;
+		usec = ut_time_us(NULL) - usec;
+		page_zip_stat[page_zip->ssize - 1].compressed_usec += usec;
+		page_zip_stat_per_index_add(index->id, TRUE, FALSE, usec);
+
+		if (page_is_leaf(page)) {
+			dict_index_zip_failure(index);
+		}
 #endif /* !UNIV_HOTBACKUP */
 		return(FALSE);
 	}
@@ -1459,8 +1670,14 @@ err_exit:
 	{
 		page_zip_stat_t*	zip_stat
 			= &page_zip_stat[page_zip->ssize - 1];
+		usec = ut_time_us(NULL) - usec;
 		zip_stat->compressed_ok++;
-		zip_stat->compressed_usec += ut_time_us(NULL) - usec;
+		zip_stat->compressed_usec += usec;
+		page_zip_stat_per_index_add(index->id, TRUE, TRUE, usec);
+	}
+
+	if (page_is_leaf(page)) {
+		dict_index_zip_success(index);
 	}
 #endif /* !UNIV_HOTBACKUP */
 
@@ -3060,8 +3277,11 @@ err_exit:
 	{
 		page_zip_stat_t*	zip_stat
 			= &page_zip_stat[page_zip->ssize - 1];
+		usec = ut_time_us(NULL) - usec;
 		zip_stat->decompressed++;
-		zip_stat->decompressed_usec += ut_time_us(NULL) - usec;
+		zip_stat->decompressed_usec += usec;
+		page_zip_stat_per_index_add(btr_page_get_index_id(page),
+					    FALSE, FALSE, usec);
 	}
 #endif /* !UNIV_HOTBACKUP */
 
@@ -4735,22 +4955,93 @@ UNIV_INTERN
 ulint
 page_zip_calc_checksum(
 /*===================*/
-	const void*	data,	/*!< in: compressed page */
-	ulint		size)	/*!< in: size of compressed page */
+	const void*			data,	/*!< in: compressed page */
+	ulint				size,	/*!< in: size of compressed
+						page */
+	srv_checksum_algorithm_t	algo)	/*!< in: algorithm to use */
 {
+	uLong		adler;
+	ib_uint32_t	crc32;
+
 	/* Exclude FIL_PAGE_SPACE_OR_CHKSUM, FIL_PAGE_LSN,
 	and FIL_PAGE_FILE_FLUSH_LSN from the checksum. */
 
 	const Bytef*	s	= data;
-	uLong		adler;
 
 	ut_ad(size > FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
 
-	adler = adler32(0L, s + FIL_PAGE_OFFSET,
-			FIL_PAGE_LSN - FIL_PAGE_OFFSET);
-	adler = adler32(adler, s + FIL_PAGE_TYPE, 2);
-	adler = adler32(adler, s + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID,
-			size - FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+	switch (algo) {
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_CRC32:
+		crc32 = ut_crc32(s + FIL_PAGE_OFFSET,
+				 FIL_PAGE_LSN - FIL_PAGE_OFFSET)
+			^ ut_crc32(s + FIL_PAGE_TYPE, 2)
+			^ ut_crc32(s + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID,
+				   size - FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+
+		return((ulint) crc32);
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_INNODB:
+		adler = adler32(0L, s + FIL_PAGE_OFFSET,
+				FIL_PAGE_LSN - FIL_PAGE_OFFSET);
+		adler = adler32(adler, s + FIL_PAGE_TYPE, 2);
+		adler = adler32(adler, s + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID,
+				size - FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+
+		return((ulint) adler);
+	case SRV_CHECKSUM_ALGORITHM_NONE:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_NONE:
+		return(BUF_NO_CHECKSUM_MAGIC);
+	/* no default so the compiler will emit a warning if new enum
+	is added and not handled here */
+	}
+
+	ut_error;
+	return(0);
+}
+
+/**********************************************************************//**
+Verify a compressed page's checksum. The strict variants of
+innodb_checksum_algorithm only accept the configured algorithm, the
+others accept a checksum calculated with any algorithm.
+@return	TRUE if the stored checksum is valid */
+UNIV_INTERN
+ibool
+page_zip_verify_checksum(
+/*=====================*/
+	const void*	data,	/*!< in: compressed page */
+	ulint		size)	/*!< in: size of compressed page */
+{
+	ib_uint32_t			stored;
+	srv_checksum_algorithm_t	curr_algo;
+
+	stored = (ib_uint32_t) mach_read_from_4(
+		(const byte*) data + FIL_PAGE_SPACE_OR_CHKSUM);
+
+	curr_algo = (srv_checksum_algorithm_t) srv_checksum_algorithm;
 
-	return((ulint) adler);
+	switch (curr_algo) {
+	case SRV_CHECKSUM_ALGORITHM_NONE:
+		return(TRUE);
+	case SRV_CHECKSUM_ALGORITHM_STRICT_CRC32:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_INNODB:
+	case SRV_CHECKSUM_ALGORITHM_STRICT_NONE:
+		return(stored == page_zip_calc_checksum(data, size,
+							curr_algo));
+	case SRV_CHECKSUM_ALGORITHM_CRC32:
+		return(stored == BUF_NO_CHECKSUM_MAGIC
+		       || stored == page_zip_calc_checksum(
+			       data, size, SRV_CHECKSUM_ALGORITHM_CRC32)
+		       || stored == page_zip_calc_checksum(
+			       data, size, SRV_CHECKSUM_ALGORITHM_INNODB));
+	case SRV_CHECKSUM_ALGORITHM_INNODB:
+		return(stored == BUF_NO_CHECKSUM_MAGIC
+		       || stored == page_zip_calc_checksum(
+			       data, size, SRV_CHECKSUM_ALGORITHM_INNODB)
+		       || stored == page_zip_calc_checksum(
+			       data, size, SRV_CHECKSUM_ALGORITHM_CRC32));
+	}
+
+	ut_error;
+	return(FALSE);
 }
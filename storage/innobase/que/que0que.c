@@ -143,7 +143,7 @@ que_graph_publish(
 	que_t*	graph,	/*!< in: graph */
 	sess_t*	sess)	/*!< in: session */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	UT_LIST_ADD_LAST(graphs, sess->graphs, graph);
 }
@@ -220,6 +220,7 @@ que_thr_create(
 	thr->state = QUE_THR_COMMAND_WAIT;
 
 	thr->is_active = FALSE;
+	thr->slot = NULL;
 
 	thr->run_node = NULL;
 	thr->resource = 0;
@@ -252,8 +253,8 @@ que_thr_end_wait(
 {
 	ibool	was_active;
 
-	ut_ad(mutex_own(&kernel_mutex));
 	ut_ad(thr);
+	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 	ut_ad((thr->state == QUE_THR_LOCK_WAIT)
 	      || (thr->state == QUE_THR_PROCEDURE_WAIT)
 	      || (thr->state == QUE_THR_SIG_REPLY_WAIT));
@@ -292,8 +293,8 @@ que_thr_end_wait_no_next_thr(
 
 	ut_a(thr->state == QUE_THR_LOCK_WAIT);	/* In MySQL this is the
 						only possible state here */
-	ut_ad(mutex_own(&kernel_mutex));
 	ut_ad(thr);
+	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 	ut_ad((thr->state == QUE_THR_LOCK_WAIT)
 	      || (thr->state == QUE_THR_PROCEDURE_WAIT)
 	      || (thr->state == QUE_THR_SIG_REPLY_WAIT));
@@ -431,7 +432,7 @@ que_fork_error_handle(
 {
 	que_thr_t*	thr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 	ut_ad(trx->sess->state == SESS_ERROR);
 	ut_ad(UT_LIST_GET_LEN(trx->reply_signals) == 0);
 	ut_ad(UT_LIST_GET_LEN(trx->wait_thrs) == 0);
@@ -713,6 +714,8 @@ que_thr_node_step(
 	que_thr_t*	thr)	/*!< in: query thread where run_node must
 				be the thread node itself */
 {
+	trx_t*	trx;
+
 	ut_ad(thr->run_node == thr);
 
 	if (thr->prev_node == thr->common.parent) {
@@ -724,11 +727,13 @@ que_thr_node_step(
 		return(thr);
 	}
 
-	mutex_enter(&kernel_mutex);
+	trx = thr_get_trx(thr);
+
+	trx_mutex_enter(trx);
 
 	if (que_thr_peek_stop(thr)) {
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
 
 		return(thr);
 	}
@@ -737,7 +742,7 @@ que_thr_node_step(
 
 	thr->state = QUE_THR_COMPLETED;
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 
 	return(NULL);
 }
@@ -802,7 +807,7 @@ que_thr_dec_refer_count(
 	fork = thr->common.parent;
 	trx = thr_get_trx(thr);
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(trx);
 
 	ut_a(thr->is_active);
 
@@ -831,7 +836,7 @@ que_thr_dec_refer_count(
 				srv_que_task_enqueue_low(thr);
 			}
 
-			mutex_exit(&kernel_mutex);
+			trx_mutex_exit(trx);
 
 			return;
 		}
@@ -847,7 +852,7 @@ que_thr_dec_refer_count(
 
 	if (trx->n_active_thrs > 0) {
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
 
 		return;
 	}
@@ -895,12 +900,12 @@ que_thr_dec_refer_count(
 		trx_end_signal_handling(trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 }
 
 /**********************************************************************//**
 Stops a query thread if graph or trx is in a state requiring it. The
-conditions are tested in the order (1) graph, (2) trx. The kernel mutex has
+conditions are tested in the order (1) graph, (2) trx. The trx mutex has
 to be reserved.
 @return	TRUE if stopped */
 UNIV_INTERN
@@ -913,11 +918,11 @@ que_thr_stop(
 	que_t*	graph;
 	ibool	ret	= TRUE;
 
-	ut_ad(mutex_own(&kernel_mutex));
-
 	graph = thr->graph;
 	trx = graph->trx;
 
+	ut_ad(trx_mutex_own(trx));
+
 	if (graph->state == QUE_FORK_COMMAND_WAIT) {
 		thr->state = QUE_THR_SUSPENDED;
 
@@ -960,7 +965,7 @@ que_thr_stop_for_mysql(
 
 	trx = thr_get_trx(thr);
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(trx);
 
 	if (thr->state == QUE_THR_RUNNING) {
 
@@ -974,7 +979,7 @@ que_thr_stop_for_mysql(
 			already released, or this transaction was chosen
 			as a victim in selective deadlock resolution */
 
-			mutex_exit(&kernel_mutex);
+			trx_mutex_exit(trx);
 
 			return;
 		}
@@ -989,7 +994,7 @@ que_thr_stop_for_mysql(
 
 	trx->n_active_thrs--;
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 }
 
 /**********************************************************************//**
@@ -1287,7 +1292,7 @@ que_run_threads_low(
 
 	ut_ad(thr->state == QUE_THR_RUNNING);
 	ut_a(thr_get_trx(thr)->error_state == DB_SUCCESS);
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!trx_mutex_own(thr_get_trx(thr)));
 
 	loop_count = QUE_MAX_LOOPS_WITHOUT_CHECK;
 loop:
@@ -1341,7 +1346,7 @@ loop:
 	ut_a(thr_get_trx(thr)->error_state == DB_SUCCESS);
 	que_run_threads_low(thr);
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(thr_get_trx(thr));
 
 	switch (thr->state) {
 
@@ -1349,12 +1354,12 @@ loop:
 		/* There probably was a lock wait, but it already ended
 		before we came here: continue running thr */
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(thr_get_trx(thr));
 
 		goto loop;
 
 	case QUE_THR_LOCK_WAIT:
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(thr_get_trx(thr));
 
 		/* The ..._mysql_... function works also for InnoDB's
 		internal threads. Let us wait that the lock wait ends. */
@@ -1381,7 +1386,7 @@ loop:
 		ut_error;
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(thr_get_trx(thr));
 }
 
 /*********************************************************************//**
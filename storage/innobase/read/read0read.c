@@ -138,25 +138,51 @@ TODO: proof this
 */
 
 /*********************************************************************//**
-Creates a read view object.
+Creates a read view object, or reuses a closed one. The trx_ids array of
+a reused view is only reallocated if it is too small.
 @return	own: read view struct */
 UNIV_INLINE
 read_view_t*
 read_view_create_low(
 /*=================*/
 	ulint		n,	/*!< in: number of cells in the trx_ids array */
-	mem_heap_t*	heap)	/*!< in: memory heap from which allocated */
+	read_view_t*	view)	/*!< in: closed read view to reuse, or NULL
+				to allocate a new one */
 {
-	read_view_t*	view;
+	if (view == NULL) {
+		view = ut_malloc(sizeof(read_view_t));
+		view->max_trx_ids = 0;
+		view->trx_ids = NULL;
+	}
 
-	view = mem_heap_alloc(heap, sizeof(read_view_t));
+	if (n > view->max_trx_ids) {
+		/* Leave some room for new transactions, so that the
+		array need not be reallocated every time a view of a
+		busy server is opened. */
+		view->max_trx_ids = ut_max(n, 2 * view->max_trx_ids);
+
+		ut_free(view->trx_ids);
+		view->trx_ids = ut_malloc(
+			view->max_trx_ids * sizeof *view->trx_ids);
+	}
 
 	view->n_trx_ids = n;
-	view->trx_ids = mem_heap_alloc(heap, n * sizeof *view->trx_ids);
 
 	return(view);
 }
 
+/*********************************************************************//**
+Frees the memory of a read view. The view must have been closed. */
+UNIV_INTERN
+void
+read_view_free(
+/*===========*/
+	read_view_t*	view)	/*!< in, own: read view */
+{
+	ut_free(view->trx_ids);
+	ut_free(view);
+}
+
 /*********************************************************************//**
 Makes a copy of the oldest existing read view, with the exception that also
 the creating trx of the oldest view is set as not visible in the 'copied'
@@ -169,8 +195,8 @@ read_view_oldest_copy_or_open_new(
 /*==============================*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
-	mem_heap_t*	heap)		/*!< in: memory heap from which
-					allocated */
+	read_view_t*	view)		/*!< in: closed read view to
+					reuse, or NULL */
 {
 	read_view_t*	old_view;
 	read_view_t*	view_copy;
@@ -179,15 +205,17 @@ read_view_oldest_copy_or_open_new(
 	ulint		n;
 	ulint		i;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	old_view = UT_LIST_GET_LAST(trx_sys->view_list);
 
 	if (old_view == NULL) {
 
-		return(read_view_open_now(cr_trx_id, heap));
+		return(read_view_open_now(cr_trx_id, view));
 	}
 
+	ut_ad(old_view != view);
+
 	n = old_view->n_trx_ids;
 
 	if (old_view->creator_trx_id) {
@@ -196,9 +224,9 @@ read_view_oldest_copy_or_open_new(
 		needs_insert = FALSE;
 	}
 
-	view_copy = read_view_create_low(n, heap);
+	view_copy = read_view_create_low(n, view);
 
-	/* Insert the id of the creator in the right place of the descending
+	/* Insert the id of the creator in the right place of the ascending
 	array of ids, if needs_insert is TRUE: */
 
 	i = 0;
@@ -206,7 +234,7 @@ read_view_oldest_copy_or_open_new(
 		if (needs_insert
 		    && (i >= old_view->n_trx_ids
 			|| old_view->creator_trx_id
-			> read_view_get_nth_trx_id(old_view, i))) {
+			< read_view_get_nth_trx_id(old_view, i))) {
 
 			read_view_set_nth_trx_id(view_copy, i,
 						 old_view->creator_trx_id);
@@ -223,15 +251,17 @@ read_view_oldest_copy_or_open_new(
 	}
 
 	view_copy->creator_trx_id = cr_trx_id;
+	view_copy->type = VIEW_NORMAL;
+	view_copy->undo_no = 0;
 
 	view_copy->low_limit_no = old_view->low_limit_no;
 	view_copy->low_limit_id = old_view->low_limit_id;
 
 
 	if (n > 0) {
-		/* The last active transaction has the smallest id: */
+		/* The first active transaction has the smallest id: */
 		view_copy->up_limit_id = read_view_get_nth_trx_id(
-			view_copy, n - 1);
+			view_copy, 0);
 	} else {
 		view_copy->up_limit_id = old_view->up_limit_id;
 	}
@@ -242,25 +272,33 @@ read_view_oldest_copy_or_open_new(
 }
 
 /*********************************************************************//**
-Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
+Fills a read view with the ids of the active read-write transactions,
+except cr_trx_id, by copying them from trx_sys->descriptors. The view is
+not added to trx_sys->view_list.
 @return	own: read view struct */
-UNIV_INTERN
+static
 read_view_t*
-read_view_open_now(
-/*===============*/
+read_view_open_now_low(
+/*===================*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
-					transaction, or 0 used in purge */
-	mem_heap_t*	heap)		/*!< in: memory heap from which
-					allocated */
+					transaction, or 0 */
+	read_view_t*	view)		/*!< in: closed read view to
+					reuse, or NULL */
 {
-	read_view_t*	view;
+	const trx_id_t*	descr;
+	ulint		n_used;
 	trx_t*		trx;
-	ulint		n;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
+
+	n_used = trx_sys->descr_n_used;
+
+	descr = cr_trx_id == 0
+		? NULL
+		: trx_find_descriptor(trx_sys->descriptors, n_used,
+				      cr_trx_id);
 
-	view = read_view_create_low(UT_LIST_GET_LEN(trx_sys->trx_list), heap);
+	view = read_view_create_low(descr ? n_used - 1 : n_used, view);
 
 	view->creator_trx_id = cr_trx_id;
 	view->type = VIEW_NORMAL;
@@ -271,44 +309,57 @@ read_view_open_now(
 	view->low_limit_no = trx_sys->max_trx_id;
 	view->low_limit_id = view->low_limit_no;
 
-	n = 0;
-	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
-
-	/* No active transaction should be visible, except cr_trx */
-
-	while (trx) {
-		if (trx->id != cr_trx_id
-		    && (trx->conc_state == TRX_ACTIVE
-			|| trx->conc_state == TRX_PREPARED)) {
+	/* No active transaction should be visible, except cr_trx. Both
+	arrays are sorted in ascending order. */
 
-			read_view_set_nth_trx_id(view, n, trx->id);
+	if (descr != NULL) {
+		ulint	n_before = descr - trx_sys->descriptors;
 
-			n++;
+		memcpy(view->trx_ids, trx_sys->descriptors,
+		       n_before * sizeof *view->trx_ids);
+		memcpy(view->trx_ids + n_before, descr + 1,
+		       (n_used - n_before - 1) * sizeof *view->trx_ids);
+	} else if (n_used > 0) {
+		memcpy(view->trx_ids, trx_sys->descriptors,
+		       n_used * sizeof *view->trx_ids);
+	}
 
-			/* NOTE that a transaction whose trx number is <
-			trx_sys->max_trx_id can still be active, if it is
-			in the middle of its commit! Note that when a
-			transaction starts, we initialize trx->no to
-			IB_ULONGLONG_MAX. */
+	/* NOTE that a transaction whose trx number is <
+	trx_sys->max_trx_id can still be active, if it is
+	in the middle of its commit! Such transactions are
+	in trx_sys->trx_serial_list, smallest trx number first. */
 
-			if (view->low_limit_no > trx->no) {
+	trx = UT_LIST_GET_FIRST(trx_sys->trx_serial_list);
 
-				view->low_limit_no = trx->no;
-			}
-		}
+	if (trx != NULL && view->low_limit_no > trx->no) {
 
-		trx = UT_LIST_GET_NEXT(trx_list, trx);
+		view->low_limit_no = trx->no;
 	}
 
-	view->n_trx_ids = n;
-
-	if (n > 0) {
-		/* The last active transaction has the smallest id: */
-		view->up_limit_id = read_view_get_nth_trx_id(view, n - 1);
+	if (view->n_trx_ids > 0) {
+		/* The first active transaction has the smallest id: */
+		view->up_limit_id = read_view_get_nth_trx_id(view, 0);
 	} else {
 		view->up_limit_id = view->low_limit_id;
 	}
 
+	return(view);
+}
+
+/*********************************************************************//**
+Opens a read view where exactly the transactions serialized before this
+point in time are seen in the view.
+@return	own: read view struct */
+UNIV_INTERN
+read_view_t*
+read_view_open_now(
+/*===============*/
+	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
+					transaction, or 0 used in purge */
+	read_view_t*	view)		/*!< in: closed read view to
+					reuse, or NULL */
+{
+	view = read_view_open_now_low(cr_trx_id, view);
 
 	UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
 
@@ -323,14 +374,15 @@ read_view_close(
 /*============*/
 	read_view_t*	view)	/*!< in: read view */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
 }
 
 /*********************************************************************//**
 Closes a consistent read view for MySQL. This function is called at an SQL
-statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED. */
+statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED.
+The view is kept in trx->prebuilt_view for reuse. */
 UNIV_INTERN
 void
 read_view_close_for_mysql(
@@ -338,17 +390,16 @@ read_view_close_for_mysql(
 	trx_t*	trx)	/*!< in: trx which has a read view */
 {
 	ut_a(trx->global_read_view);
+	ut_ad(trx->global_read_view == trx->prebuilt_view);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	read_view_close(trx->global_read_view);
 
-	mem_heap_empty(trx->global_read_view_heap);
-
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -403,8 +454,6 @@ read_cursor_view_create_for_mysql(
 	cursor_view_t*	curview;
 	read_view_t*	view;
 	mem_heap_t*	heap;
-	trx_t*		trx;
-	ulint		n;
 
 	ut_a(cr_trx);
 
@@ -421,62 +470,22 @@ read_cursor_view_create_for_mysql(
 	curview->n_mysql_tables_in_use = cr_trx->n_mysql_tables_in_use;
 	cr_trx->n_mysql_tables_in_use = 0;
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
+
+	/* No active transaction should be visible, not even the
+	creating one */
 
-	curview->read_view = read_view_create_low(
-		UT_LIST_GET_LEN(trx_sys->trx_list), curview->heap);
+	view = read_view_open_now_low(0, NULL);
 
-	view = curview->read_view;
 	view->creator_trx_id = cr_trx->id;
 	view->type = VIEW_HIGH_GRANULARITY;
 	view->undo_no = cr_trx->undo_no;
 
-	/* No future transactions should be visible in the view */
-
-	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
-
-	n = 0;
-	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
-
-	/* No active transaction should be visible */
-
-	while (trx) {
-
-		if (trx->conc_state == TRX_ACTIVE
-		    || trx->conc_state == TRX_PREPARED) {
-
-			read_view_set_nth_trx_id(view, n, trx->id);
-
-			n++;
-
-			/* NOTE that a transaction whose trx number is <
-			trx_sys->max_trx_id can still be active, if it is
-			in the middle of its commit! Note that when a
-			transaction starts, we initialize trx->no to
-			IB_ULONGLONG_MAX. */
-
-			if (view->low_limit_no > trx->no) {
-
-				view->low_limit_no = trx->no;
-			}
-		}
-
-		trx = UT_LIST_GET_NEXT(trx_list, trx);
-	}
-
-	view->n_trx_ids = n;
-
-	if (n > 0) {
-		/* The last active transaction has the smallest id: */
-		view->up_limit_id = read_view_get_nth_trx_id(view, n - 1);
-	} else {
-		view->up_limit_id = view->low_limit_id;
-	}
+	curview->read_view = view;
 
 	UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(curview);
 }
@@ -499,13 +508,14 @@ read_cursor_view_close_for_mysql(
 	belong to this transaction */
 	trx->n_mysql_tables_in_use += curview->n_mysql_tables_in_use;
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	read_view_close(curview->read_view);
 	trx->read_view = trx->global_read_view;
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
+	read_view_free(curview->read_view);
 	mem_heap_free(curview->heap);
 }
 
@@ -522,7 +532,7 @@ read_cursor_set_for_mysql(
 {
 	ut_a(trx);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	if (UNIV_LIKELY(curview != NULL)) {
 		trx->read_view = curview->read_view;
@@ -530,5 +540,5 @@ read_cursor_set_for_mysql(
 		trx->read_view = trx->global_read_view;
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 }
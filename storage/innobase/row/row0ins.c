@@ -42,6 +42,7 @@ Created 4/20/1996 Heikki Tuuri
 #include "row0upd.h"
 #include "row0sel.h"
 #include "row0row.h"
+#include "row0log.h"
 #include "rem0cmp.h"
 #include "lock0lock.h"
 #include "log0log.h"
@@ -2225,7 +2226,8 @@ stored_big_rec:
 Inserts an index entry to index. Tries first optimistic, then pessimistic
 descent down the tree. If the entry matches enough to a delete marked record,
 performs the insert by updating or delete unmarking the delete marked
-record.
+record. If a secondary index is being created online, the insert is
+written to the log of the index instead, unless foreign=FALSE.
 @return	DB_SUCCESS, DB_LOCK_WAIT, DB_DUPLICATE_KEY, or some other error code */
 UNIV_INTERN
 ulint
@@ -2249,6 +2251,14 @@ row_ins_index_entry(
 		}
 	}
 
+	if (foreign && !dict_index_is_clust(index)
+	    && dict_index_is_online_ddl(index)
+	    && row_log_online_op_try(index, entry,
+				     thr_get_trx(thr)->id, ROW_OP_INSERT)) {
+
+		return(DB_SUCCESS);
+	}
+
 	/* Try first optimistic descent to the B-tree */
 
 	err = row_ins_index_entry_low(BTR_MODIFY_LEAF, index, entry,
@@ -2451,6 +2461,13 @@ row_ins(
 
 	if (node->state == INS_NODE_ALLOC_ROW_ID) {
 
+		if (UNIV_UNLIKELY(UT_LIST_GET_LEN(node->entry_list)
+				  != UT_LIST_GET_LEN(node->table->indexes))) {
+			/* An index is being created online. It was
+			added after the entry list was built. */
+			ins_node_create_entry_list(node);
+		}
+
 		row_ins_alloc_row_id_step(node);
 
 		node->index = dict_table_get_first_index(node->table);
@@ -0,0 +1,759 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file row/row0log.c
+Modification log for online index creation
+
+The log of an index consists of blocks of ROW_LOG_BLOCK_SIZE bytes.
+The last block is kept in memory (tail) and the previous ones are
+written to a temporary file, from which they are read back (head) when
+the log is applied. Each block contains a sequence of records:
+
+op		1 byte, enum row_op; 0 marks the end of the block
+trx_id		DATA_TRX_ID_LEN bytes, the transaction that did the operation,
+		or 0 for ROW_OP_PURGE
+extra_size+1	1 or 2 bytes, as in the merge sort files of row0merge.c
+record		the index entry, in the format of rec_convert_dtuple_to_temp()
+
+Created 2013 Twitter, Inc.
+*******************************************************/
+
+#include "row0log.h"
+#include "row0merge.h"
+#include "row0row.h"
+#include "row0upd.h"
+#include "row0ins.h"
+#include "btr0cur.h"
+#include "page0page.h"
+#include "rem0rec.h"
+#include "data0data.h"
+#include "dict0dict.h"
+#include "trx0sys.h"
+#include "trx0trx.h"
+#include "que0que.h"
+#include "pars0pars.h"
+#include "log0log.h"
+#include "os0file.h"
+#include "srv0srv.h"
+#include "sync0sync.h"
+
+/** Size of a block of the modification log, in bytes
+(innodb_sort_buffer_size) */
+#define ROW_LOG_BLOCK_SIZE	srv_sort_buf_size
+
+/** Size of the fixed part of a log record: op, trx_id and the first
+byte of extra_size+1 */
+#define ROW_LOG_HEADER_SIZE	(1 + DATA_TRX_ID_LEN + 1)
+
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t	index_online_log_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** Modification log of a secondary index that is being created online */
+struct row_log_struct {
+	mutex_t		mutex;	/*!< mutex protecting fd, error, total
+				and tail */
+	int		fd;	/*!< file descriptor of the temporary file,
+				or -1 if no block has been written */
+	ulint		error;	/*!< DB_SUCCESS, or the error that
+				occurred while logging; once set, further
+				operations are discarded */
+	ulint		total;	/*!< number of bytes logged */
+	byte*		buf;	/*!< memory for tail.block and head.block */
+	ulint		buf_size;/*!< allocated size of buf */
+	struct {
+		ulint	blocks;	/*!< number of blocks written to fd */
+		ulint	bytes;	/*!< number of bytes used in block */
+		byte*	block;	/*!< the block that is being filled */
+	} tail;			/*!< writer context */
+	struct {
+		ulint	blocks;	/*!< number of blocks applied from fd */
+		byte*	block;	/*!< buffer for reading blocks from fd */
+	} head;			/*!< reader context; only accessed by
+				the thread that creates the index */
+};
+
+/******************************************************//**
+Allocates the modification log of a secondary index that is being
+created online. Modifications to the index will be logged from now on,
+until row_log_apply() or row_log_abort_sec() is called. */
+UNIV_INTERN
+void
+row_log_allocate(
+/*=============*/
+	dict_index_t*	index)	/*!< in/out: index being created */
+{
+	row_log_t*	log;
+
+	ut_ad(!dict_index_is_clust(index));
+	ut_ad(!dict_index_is_unique(index));
+	ut_ad(!index->online_log);
+	ut_ad(*index->name == TEMP_INDEX_PREFIX);
+
+	log = mem_alloc(sizeof *log);
+
+	mutex_create(index_online_log_key, &log->mutex,
+		     SYNC_INDEX_ONLINE_LOG);
+	log->fd = -1;
+	log->error = DB_SUCCESS;
+	log->total = 0;
+	log->buf_size = 2 * ROW_LOG_BLOCK_SIZE;
+	log->buf = os_mem_alloc_large(&log->buf_size, FALSE);
+	log->tail.blocks = 0;
+	log->tail.bytes = 0;
+	log->tail.block = log->buf;
+	log->head.blocks = 0;
+	log->head.block = log->buf + ROW_LOG_BLOCK_SIZE;
+
+	rw_lock_x_lock(dict_index_get_lock(index));
+	index->online_log = log;
+	index->online_status = ONLINE_INDEX_CREATION;
+	rw_lock_x_unlock(dict_index_get_lock(index));
+}
+
+/******************************************************//**
+Frees a modification log. */
+static
+void
+row_log_free_low(
+/*=============*/
+	row_log_t*	log)	/*!< in, own: log */
+{
+	if (log->fd >= 0) {
+		row_merge_file_destroy_low(log->fd);
+	}
+
+	os_atomic_increment_ulint(&srv_online_alter_log_bytes,
+				  0 - log->total);
+
+	mutex_free(&log->mutex);
+	os_mem_free_large(log->buf, log->buf_size);
+	mem_free(log);
+}
+
+/******************************************************//**
+Writes the tail block of a modification log to the temporary file.
+The caller must hold log->mutex.
+@return TRUE on success */
+static
+ibool
+row_log_write_block(
+/*================*/
+	row_log_t*	log)	/*!< in/out: log */
+{
+	ib_uint64_t	ofs;
+
+	ut_ad(mutex_own(&log->mutex));
+	ut_ad(log->tail.bytes < ROW_LOG_BLOCK_SIZE);
+
+	if (log->fd < 0) {
+		log->fd = row_merge_file_create_low();
+
+		if (log->fd < 0) {
+			return(FALSE);
+		}
+	}
+
+	/* Write the end-of-block marker. The space for it was
+	reserved in row_log_online_op(). */
+	log->tail.block[log->tail.bytes] = 0;
+
+	ofs = (ib_uint64_t) log->tail.blocks * ROW_LOG_BLOCK_SIZE;
+
+	if (!os_file_write("(modification log)", OS_FILE_FROM_FD(log->fd),
+			   log->tail.block,
+			   (ulint) (ofs & 0xFFFFFFFF),
+			   (ulint) (ofs >> 32),
+			   ROW_LOG_BLOCK_SIZE)) {
+		return(FALSE);
+	}
+
+	log->tail.blocks++;
+	log->tail.bytes = 0;
+
+	return(TRUE);
+}
+
+/******************************************************//**
+Logs an operation on a secondary index that is being created online.
+The caller must hold index->lock in S or X mode and must have checked
+that dict_index_is_online_ddl() holds. */
+UNIV_INTERN
+void
+row_log_online_op(
+/*==============*/
+	dict_index_t*	index,	/*!< in/out: index */
+	const dtuple_t*	tuple,	/*!< in: index entry */
+	trx_id_t	trx_id,	/*!< in: transaction that modified
+				the index entry */
+	enum row_op	op)	/*!< in: operation */
+{
+	row_log_t*	log;
+	byte*		b;
+	ulint		extra_size;
+	ulint		size;
+	ulint		mrec_size;
+
+	ut_ad(dtuple_validate(tuple));
+	ut_ad(dtuple_get_n_fields(tuple) == dict_index_get_n_fields(index));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(dict_index_get_lock(index), RW_LOCK_SHARED)
+	      || rw_lock_own(dict_index_get_lock(index), RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
+	ut_ad(dict_index_is_online_ddl(index));
+
+	if (index->online_status != ONLINE_INDEX_CREATION) {
+		/* Index creation was aborted. */
+		return;
+	}
+
+	size = rec_get_converted_size_temp(
+		index, tuple->fields, tuple->n_fields, &extra_size);
+
+	mrec_size = ROW_LOG_HEADER_SIZE + (extra_size + 1 >= 0x80) + size;
+
+	/* Secondary index records are much smaller than a block. */
+	ut_ad(mrec_size < ROW_LOG_BLOCK_SIZE);
+
+	log = index->online_log;
+
+	mutex_enter(&log->mutex);
+
+	if (log->error != DB_SUCCESS) {
+		goto func_exit;
+	}
+
+	if (log->total + mrec_size > srv_online_alter_log_max_size) {
+		log->error = DB_ONLINE_LOG_TOO_BIG;
+		goto func_exit;
+	}
+
+	/* Reserve one byte for the end-of-block marker. */
+	if (log->tail.bytes + mrec_size >= ROW_LOG_BLOCK_SIZE
+	    && !row_log_write_block(log)) {
+		log->error = DB_OUT_OF_FILE_SPACE;
+		goto func_exit;
+	}
+
+	b = log->tail.block + log->tail.bytes;
+
+	*b++ = (byte) op;
+	trx_write_trx_id(b, trx_id);
+	b += DATA_TRX_ID_LEN;
+
+	/* Encode extra_size + 1 */
+	if (extra_size + 1 < 0x80) {
+		*b++ = (byte) (extra_size + 1);
+	} else {
+		ut_ad((extra_size + 1) < 0x8000);
+		*b++ = (byte) (0x80 | ((extra_size + 1) >> 8));
+		*b++ = (byte) (extra_size + 1);
+	}
+
+	rec_convert_dtuple_to_temp(b + extra_size, index,
+				   tuple->fields, tuple->n_fields);
+	b += size;
+
+	ut_ad((ulint) (b - log->tail.block) == log->tail.bytes + mrec_size);
+	log->tail.bytes += mrec_size;
+	log->total += mrec_size;
+
+	os_atomic_increment_ulint(&srv_online_alter_log_bytes, mrec_size);
+	os_atomic_increment_ulint(&srv_online_alter_log_rows, 1);
+
+func_exit:
+	mutex_exit(&log->mutex);
+}
+
+/******************************************************//**
+Logs an operation on a secondary index if the index is being created
+online. The caller must not hold index->lock.
+@return TRUE if the index is being created or its creation was aborted,
+and the operation must not be applied to the index tree; FALSE if the
+index is complete */
+UNIV_INTERN
+ibool
+row_log_online_op_try(
+/*==================*/
+	dict_index_t*	index,	/*!< in/out: index */
+	const dtuple_t*	tuple,	/*!< in: index entry */
+	trx_id_t	trx_id,	/*!< in: transaction that modified
+				the index entry */
+	enum row_op	op)	/*!< in: operation */
+{
+	ibool	logged	= FALSE;
+
+	ut_ad(!dict_index_is_clust(index));
+
+	rw_lock_s_lock(dict_index_get_lock(index));
+
+	if (dict_index_is_online_ddl(index)) {
+		row_log_online_op(index, tuple, trx_id, op);
+		logged = TRUE;
+	}
+
+	rw_lock_s_unlock(dict_index_get_lock(index));
+
+	return(logged);
+}
+
+/******************************************************//**
+Applies an operation to a secondary index that is being created online.
+@return DB_SUCCESS, DB_FAIL if the operation must be retried with
+BTR_MODIFY_TREE, or error code */
+static
+ulint
+row_log_apply_op_low(
+/*=================*/
+	dict_index_t*	index,	/*!< in/out: index */
+	que_thr_t*	thr,	/*!< in: query thread */
+	dtuple_t*	entry,	/*!< in: index entry */
+	trx_id_t	trx_id,	/*!< in: transaction that modified
+				the index entry */
+	enum row_op	op,	/*!< in: operation */
+	ulint		mode)	/*!< in: BTR_MODIFY_LEAF or BTR_MODIFY_TREE */
+{
+	btr_cur_t	cursor;
+	mtr_t		mtr;
+	rec_t*		rec;
+	big_rec_t*	big_rec		= NULL;
+	mem_heap_t*	heap		= NULL;
+	ulint		error		= DB_SUCCESS;
+	ibool		exists;
+
+	ut_ad(mode == BTR_MODIFY_LEAF || mode == BTR_MODIFY_TREE);
+
+	mtr_start(&mtr);
+
+	btr_cur_search_to_nth_level(index, 0, entry, PAGE_CUR_LE, mode,
+				    &cursor, 0, __FILE__, __LINE__, &mtr);
+
+	ut_ad(dict_index_get_n_unique(index)
+	      == dtuple_get_n_fields(entry));
+
+	rec = btr_cur_get_rec(&cursor);
+	exists = page_rec_is_user_rec(rec)
+		&& cursor.low_match >= dtuple_get_n_fields(entry);
+
+	/* The page will contain a record that was modified by trx_id.
+	Secondary index pages must know the maximum id, for consistent
+	reads and for checking implicit locks. Splits copy the value
+	to the new pages. Purge is not done by any transaction. */
+	if (op != ROW_OP_PURGE) {
+		page_update_max_trx_id(btr_cur_get_block(&cursor),
+				       btr_cur_get_page_zip(&cursor),
+				       trx_id, &mtr);
+	}
+
+	switch (op) {
+	case ROW_OP_PURGE:
+		if (!exists || !rec_get_deleted_flag(
+			    rec, dict_table_is_comp(index->table))) {
+			/* The record was inserted again. */
+		} else if (mode == BTR_MODIFY_LEAF) {
+			if (!btr_cur_optimistic_delete(&cursor, &mtr)) {
+				error = DB_FAIL;
+			}
+		} else {
+			btr_cur_pessimistic_delete(&error, FALSE, &cursor,
+						   RB_NONE, &mtr);
+		}
+		break;
+	case ROW_OP_DELETE:
+		if (exists && !rec_get_deleted_flag(
+			    rec, dict_table_is_comp(index->table))) {
+			error = btr_cur_del_mark_set_sec_rec(
+				BTR_NO_LOCKING_FLAG, &cursor, TRUE,
+				thr, &mtr);
+		}
+		break;
+	case ROW_OP_INSERT:
+		if (exists) {
+			upd_t*	update;
+
+			if (rec_get_deleted_flag(
+				    rec, dict_table_is_comp(index->table))) {
+				error = btr_cur_del_mark_set_sec_rec(
+					BTR_NO_LOCKING_FLAG, &cursor, FALSE,
+					thr, &mtr);
+				ut_a(error == DB_SUCCESS);
+			}
+
+			/* The fields may differ in case or trailing
+			spaces, while comparing equal. */
+			heap = mem_heap_create(100);
+			update = row_upd_build_sec_rec_difference_binary(
+				index, entry, rec, thr_get_trx(thr), heap);
+
+			if (upd_get_n_fields(update) == 0) {
+				/* The record is up to date. */
+			} else if (mode == BTR_MODIFY_LEAF) {
+				error = btr_cur_optimistic_update(
+					BTR_KEEP_SYS_FLAG
+					| BTR_NO_LOCKING_FLAG,
+					&cursor, update, 0, thr, &mtr);
+				switch (error) {
+				case DB_OVERFLOW:
+				case DB_UNDERFLOW:
+				case DB_ZIP_OVERFLOW:
+					error = DB_FAIL;
+				}
+			} else {
+				error = btr_cur_pessimistic_update(
+					BTR_KEEP_SYS_FLAG
+					| BTR_NO_LOCKING_FLAG,
+					&cursor, &heap, &big_rec,
+					update, 0, thr, &mtr);
+			}
+		} else {
+			error = btr_cur_optimistic_insert(
+				BTR_NO_UNDO_LOG_FLAG | BTR_NO_LOCKING_FLAG,
+				&cursor, entry, &rec, &big_rec,
+				0, thr, &mtr);
+
+			if (error == DB_FAIL && mode == BTR_MODIFY_TREE) {
+				error = btr_cur_pessimistic_insert(
+					BTR_NO_UNDO_LOG_FLAG
+					| BTR_NO_LOCKING_FLAG,
+					&cursor, entry,
+					&rec, &big_rec, 0, thr, &mtr);
+			}
+		}
+
+		/* Secondary index records are never stored
+		externally. */
+		ut_a(!big_rec);
+		break;
+	}
+
+	mtr_commit(&mtr);
+
+	if (heap) {
+		mem_heap_free(heap);
+	}
+
+	return(error);
+}
+
+/******************************************************//**
+Applies the records of a block of the modification log to a secondary
+index that is being created online.
+@return DB_SUCCESS, or error code on failure */
+static
+ulint
+row_log_apply_block(
+/*================*/
+	trx_t*		trx,	/*!< in: transaction creating the index */
+	dict_index_t*	index,	/*!< in/out: index */
+	const byte*	block,	/*!< in: block, ending in a 0 byte */
+	ibool		has_index_lock)
+				/*!< in: TRUE if index->lock is
+				X-latched by the caller */
+{
+	const byte*	b	= block;
+	const byte*	end	= block + ROW_LOG_BLOCK_SIZE;
+	mem_heap_t*	heap;
+	mem_heap_t*	graph_heap;
+	que_thr_t*	thr;
+	ins_node_t*	node;
+	ulint*		offsets;
+	ulint		error	= DB_SUCCESS;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(!has_index_lock
+	      || rw_lock_own(dict_index_get_lock(index), RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
+
+	/* The btr_cur functions want a query thread, for reporting the
+	transaction. Use a dummy graph, as row_merge does. */
+	graph_heap = mem_heap_create(500);
+	node = ins_node_create(INS_DIRECT, index->table, graph_heap);
+	thr = pars_complete_graph_for_exec(node, trx, graph_heap);
+	que_thr_move_to_run_state_for_mysql(thr, trx);
+
+	heap = mem_heap_create(1000);
+
+	{
+		ulint i	= 1 + REC_OFFS_HEADER_SIZE
+			+ dict_index_get_n_fields(index);
+		offsets = mem_heap_alloc(graph_heap, i * sizeof *offsets);
+		offsets[0] = i;
+		offsets[1] = dict_index_get_n_fields(index);
+	}
+
+	while (*b) {
+		enum row_op	op;
+		trx_id_t	trx_id;
+		ulint		extra_size;
+		const rec_t*	mrec;
+		dtuple_t*	entry;
+		ulint		n_ext;
+
+		op = (enum row_op) *b++;
+		trx_id = trx_read_trx_id(b);
+		b += DATA_TRX_ID_LEN;
+
+		extra_size = *b++;
+
+		if (extra_size >= 0x80) {
+			extra_size = (extra_size & 0x7f) << 8;
+			extra_size |= *b++;
+		}
+
+		/* Normalize extra_size. The value 0 would have been the
+		end-of-block marker. */
+		extra_size--;
+
+		mrec = b + extra_size;
+		rec_init_offsets_temp(mrec, index, offsets);
+		b = mrec + rec_offs_data_size(offsets);
+
+		if (UNIV_UNLIKELY(b >= end
+				  || (op != ROW_OP_INSERT
+				      && op != ROW_OP_DELETE
+				      && op != ROW_OP_PURGE))) {
+			error = DB_CORRUPTION;
+			break;
+		}
+
+		entry = row_rec_to_index_entry_low(
+			mrec, index, offsets, &n_ext, heap);
+		ut_ad(!n_ext);
+
+		if (!has_index_lock) {
+			log_free_check();
+		}
+
+		error = row_log_apply_op_low(index, thr, entry, trx_id, op,
+					     has_index_lock
+					     ? BTR_MODIFY_TREE
+					     : BTR_MODIFY_LEAF);
+
+		if (error == DB_FAIL) {
+			error = row_log_apply_op_low(index, thr, entry,
+						     trx_id, op,
+						     BTR_MODIFY_TREE);
+		}
+
+		mem_heap_empty(heap);
+
+		if (error != DB_SUCCESS) {
+			break;
+		}
+	}
+
+	mem_heap_free(heap);
+
+	que_thr_stop_for_mysql_no_error(thr, trx);
+	que_graph_free(thr->graph);
+
+	return(error);
+}
+
+/******************************************************//**
+Reads a block of the modification log from the temporary file.
+@return TRUE on success */
+static
+ibool
+row_log_read_block(
+/*===============*/
+	row_log_t*	log)	/*!< in/out: log */
+{
+	ib_uint64_t	ofs;
+
+	ofs = (ib_uint64_t) log->head.blocks * ROW_LOG_BLOCK_SIZE;
+
+	if (!os_file_read_no_error_handling(OS_FILE_FROM_FD(log->fd),
+					    log->head.block,
+					    (ulint) (ofs & 0xFFFFFFFF),
+					    (ulint) (ofs >> 32),
+					    ROW_LOG_BLOCK_SIZE)) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: failed to read modification log"
+			" block at %llu\n", ofs);
+		return(FALSE);
+	}
+
+#ifdef POSIX_FADV_DONTNEED
+	/* Each block is read exactly once. Free up the file cache. */
+	posix_fadvise(log->fd, ofs, ROW_LOG_BLOCK_SIZE, POSIX_FADV_DONTNEED);
+#endif /* POSIX_FADV_DONTNEED */
+
+	return(TRUE);
+}
+
+/******************************************************//**
+Applies the full blocks of the modification log to a secondary index
+that is being created online, without blocking the concurrent
+modifications that are being logged.
+@return DB_SUCCESS, or error code on failure */
+UNIV_INTERN
+ulint
+row_log_catch_up(
+/*=============*/
+	trx_t*		trx,	/*!< in: transaction creating the index */
+	dict_index_t*	index)	/*!< in/out: index */
+{
+	row_log_t*	log	= index->online_log;
+	ulint		error;
+
+	ut_ad(dict_index_is_online_ddl(index));
+	ut_ad(log);
+
+	trx->op_info = "applying the modification log";
+
+	for (;;) {
+		mutex_enter(&log->mutex);
+		error = log->error;
+
+		if (error != DB_SUCCESS
+		    || log->head.blocks == log->tail.blocks) {
+			mutex_exit(&log->mutex);
+			break;
+		}
+
+		mutex_exit(&log->mutex);
+
+		if (trx_is_interrupted(trx)) {
+			error = DB_INTERRUPTED;
+			break;
+		}
+
+		if (!row_log_read_block(log)) {
+			error = DB_CORRUPTION;
+			break;
+		}
+
+		error = row_log_apply_block(trx, index, log->head.block,
+					    FALSE);
+		if (error != DB_SUCCESS) {
+			break;
+		}
+
+		log->head.blocks++;
+	}
+
+	trx->op_info = "";
+
+	return(error);
+}
+
+/******************************************************//**
+Applies the rest of the modification log to a secondary index that is
+being created online, and makes the index complete. Concurrent
+modifications wait for index->lock meanwhile. On failure, index
+creation is aborted. In either case, the log is freed.
+@return DB_SUCCESS, or error code on failure */
+UNIV_INTERN
+ulint
+row_log_apply(
+/*==========*/
+	trx_t*		trx,	/*!< in: transaction creating the index */
+	dict_index_t*	index)	/*!< in/out: index */
+{
+	row_log_t*	log	= index->online_log;
+	ulint		error;
+
+	/* Apply most of the log without blocking the writers. */
+	error = row_log_catch_up(trx, index);
+
+	rw_lock_x_lock(dict_index_get_lock(index));
+
+	trx->op_info = "applying the modification log";
+
+	while (error == DB_SUCCESS && log->head.blocks < log->tail.blocks) {
+		if (!row_log_read_block(log)) {
+			error = DB_CORRUPTION;
+			break;
+		}
+
+		error = row_log_apply_block(trx, index, log->head.block,
+					    TRUE);
+		log->head.blocks++;
+	}
+
+	if (error == DB_SUCCESS) {
+		error = log->error;
+	}
+
+	if (error == DB_SUCCESS && log->tail.bytes > 0) {
+		/* Nobody can log while we hold index->lock. */
+		log->tail.block[log->tail.bytes] = 0;
+		error = row_log_apply_block(trx, index, log->tail.block,
+					    TRUE);
+	}
+
+	index->online_status = error == DB_SUCCESS
+		? ONLINE_INDEX_COMPLETE
+		: ONLINE_INDEX_ABORTED;
+	index->online_log = NULL;
+
+	rw_lock_x_unlock(dict_index_get_lock(index));
+
+	trx->op_info = "";
+
+	row_log_free_low(log);
+
+	return(error);
+}
+
+/******************************************************//**
+Aborts the creation of a secondary index that is being created online,
+and frees the modification log. Subsequent modifications to the index
+will be discarded, until the index is dropped. */
+UNIV_INTERN
+void
+row_log_abort_sec(
+/*==============*/
+	dict_index_t*	index)	/*!< in/out: index */
+{
+	row_log_t*	log;
+
+	rw_lock_x_lock(dict_index_get_lock(index));
+
+	ut_ad(dict_index_is_online_ddl(index));
+
+	log = index->online_log;
+	index->online_log = NULL;
+	index->online_status = ONLINE_INDEX_ABORTED;
+
+	rw_lock_x_unlock(dict_index_get_lock(index));
+
+	if (log) {
+		row_log_free_low(log);
+	}
+}
+
+/******************************************************//**
+Frees the modification log of an index that is being removed from the
+data dictionary cache. */
+UNIV_INTERN
+void
+row_log_free(
+/*=========*/
+	dict_index_t*	index)	/*!< in/out: index */
+{
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	if (UNIV_LIKELY_NULL(index->online_log)) {
+		row_log_free_low(index->online_log);
+		index->online_log = NULL;
+	}
+}
@@ -24,6 +24,8 @@ Created 12/4/2005 Jan Lindstrom
 Completed by Sunny Bains and Marko Makela
 *******************************************************/
 
+#include "m_string.h" /* for my_sys.h */
+#include "my_sys.h" /* DEBUG_SYNC_C */
 #include "row0merge.h"
 #include "row0ext.h"
 #include "row0row.h"
@@ -56,6 +58,10 @@ Completed by Sunny Bains and Marko Makela
 #include "log0log.h"
 #include "ut0sort.h"
 #include "handler0alter.h"
+#include "row0log.h"
+#include "row0vers.h"
+#include "srv0srv.h"
+#include "os0thread.h"
 
 /* Ignore posix_fadvise() on those platforms where it does not exist */
 #if defined __WIN__
@@ -81,22 +87,22 @@ static ibool	row_merge_print_block_write;
 /* @} */
 #endif /* UNIV_DEBUG */
 
-/** @brief Block size for I/O operations in merge sort.
+/** @brief Block for I/O operations in merge sort.
 
+The size of the block is srv_sort_buf_size (innodb_sort_buffer_size).
 The minimum is UNIV_PAGE_SIZE, or page_get_free_space_of_empty()
 rounded to a power of 2.
 
 When not creating a PRIMARY KEY that contains column prefixes, this
 can be set as small as UNIV_PAGE_SIZE / 2.  See the comment above
-ut_ad(data_size < sizeof(row_merge_block_t)). */
-typedef byte	row_merge_block_t[1048576];
+ut_ad(data_size < srv_sort_buf_size). */
+typedef byte	row_merge_block_t;
 
 /** @brief Secondary buffer for I/O operations of merge records.
 
 This buffer is used for writing or reading a record that spans two
-row_merge_block_t.  Thus, it must be able to hold one merge record,
-whose maximum size is the same as the minimum size of
-row_merge_block_t. */
+blocks.  Thus, it must be able to hold one merge record, whose maximum
+size is the same as the minimum size of a block. */
 typedef byte	mrec_buf_t[UNIV_PAGE_SIZE];
 
 /** @brief Merge record in row_merge_block_t.
@@ -183,7 +189,7 @@ row_merge_buf_create_low(
 	row_merge_buf_t*	buf;
 
 	ut_ad(max_tuples > 0);
-	ut_ad(max_tuples <= sizeof(row_merge_block_t));
+	ut_ad(max_tuples <= srv_sort_buf_size);
 	ut_ad(max_tuples < buf_size);
 
 	buf = mem_heap_zalloc(heap, buf_size);
@@ -211,12 +217,12 @@ row_merge_buf_create(
 	ulint			buf_size;
 	mem_heap_t*		heap;
 
-	max_tuples = sizeof(row_merge_block_t)
+	max_tuples = srv_sort_buf_size
 		/ ut_max(1, dict_index_get_min_size(index));
 
 	buf_size = (sizeof *buf) + (max_tuples - 1) * sizeof *buf->tuples;
 
-	heap = mem_heap_create(buf_size + sizeof(row_merge_block_t));
+	heap = mem_heap_create(buf_size + srv_sort_buf_size);
 
 	buf = row_merge_buf_create_low(heap, index, max_tuples, buf_size);
 
@@ -399,22 +405,22 @@ row_merge_buf_add(
 	}
 #endif /* UNIV_DEBUG */
 
-	/* Add to the total size of the record in row_merge_block_t
+	/* Add to the total size of the record in the block
 	the encoded length of extra_size and the extra bytes (extra_size).
 	See row_merge_buf_write() for the variable-length encoding
 	of extra_size. */
 	data_size += (extra_size + 1) + ((extra_size + 1) >= 0x80);
 
-	/* The following assertion may fail if row_merge_block_t is
-	declared very small and a PRIMARY KEY is being created with
+	/* The following assertion may fail if srv_sort_buf_size is
+	very small and a PRIMARY KEY is being created with
 	many prefix columns.  In that case, the record may exceed the
 	page_zip_rec_needs_ext() limit.  However, no further columns
 	will be moved to external storage until the record is inserted
 	to the clustered index B-tree. */
-	ut_ad(data_size < sizeof(row_merge_block_t));
+	ut_ad(data_size < srv_sort_buf_size);
 
-	/* Reserve one byte for the end marker of row_merge_block_t. */
-	if (buf->total_size + data_size >= sizeof(row_merge_block_t) - 1) {
+	/* Reserve one byte for the end marker of the block. */
+	if (buf->total_size + data_size >= srv_sort_buf_size - 1) {
 		return(FALSE);
 	}
 
@@ -432,16 +438,139 @@ row_merge_buf_add(
 	return(TRUE);
 }
 
+#ifdef UNIV_PFS_MUTEX
+/* Key to register row_merge_par_t::mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	row_merge_par_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** State that is shared by the threads that scan the clustered index
+or merge sort the index entries in parallel. The scan threads read
+disjoint key ranges of the clustered index, and each of them writes
+its sorted buffers as separate blocks to the temporary files. Because
+each block is a run of its own, the blocks of different threads can
+be interleaved in the files. The merge sort threads sort the temporary
+files of different indexes. */
+struct row_merge_par_struct {
+	mutex_t			mutex;	/*!< protects error, error_key_num,
+					next, n_running, the offset of
+					files[] and table->record[0] */
+	os_event_t		event;	/*!< set when n_running drops
+					to 0 */
+	ulint			n_running;/*!< number of threads that
+					have not finished yet */
+	ulint			error;	/*!< DB_SUCCESS, or the first error
+					that any thread encountered */
+	ulint			error_key_num;/*!< position of the index
+					in index[] where the first error
+					occurred */
+	ulint			next;	/*!< position of the next index
+					in index[] to merge sort */
+	ib_uint64_t		n_rows_scanned;/*!< number of clustered
+					index records scanned so far */
+	ib_uint64_t		n_rows_total;/*!< estimated number of rows
+					in the table, for reporting
+					progress */
+	trx_t*			trx;	/*!< transaction */
+	struct TABLE*		table;	/*!< MySQL table object, for
+					reporting erroneous records */
+	const dict_table_t*	old_table;/*!< table where rows are
+					read from */
+	const dict_table_t*	new_table;/*!< table where indexes are
+					created; identical to old_table
+					unless creating a PRIMARY KEY */
+	dict_index_t**		index;	/*!< indexes to be created */
+	merge_file_t*		files;	/*!< temporary files, one for each
+					index */
+	int*			tmpfd;	/*!< temporary files for the merge
+					sort, one for each index */
+	ulint			n_index;/*!< number of indexes to create */
+	ibool			online;	/*!< TRUE if the table can be
+					modified meanwhile, and the rows
+					must be read through trx->read_view */
+	const ulint*		nonnull;/*!< columns changed to NOT NULL,
+					or NULL */
+	ulint			n_nonnull;/*!< number of columns changed
+					to NOT NULL */
+	const dtuple_t**	bounds;	/*!< n_threads + 1 boundaries of
+					the key ranges of the scan threads;
+					NULL stands for the start or the end
+					of the clustered index */
+	row_merge_block_t*	block;	/*!< 3 blocks for each thread */
+};
+
+/** State that is shared by the threads that build indexes */
+typedef struct row_merge_par_struct row_merge_par_t;
+
 /** Structure for reporting duplicate records. */
 struct row_merge_dup_struct {
 	const dict_index_t*	index;		/*!< index being sorted */
-	struct TABLE*		table;		/*!< MySQL table object */
+	row_merge_par_t*	par;		/*!< shared state of the
+						threads that build the
+						indexes */
+	ulint			key_num;	/*!< position of index
+						in par->index[] */
 	ulint			n_dup;		/*!< number of duplicates */
 };
 
 /** Structure for reporting duplicate records. */
 typedef struct row_merge_dup_struct row_merge_dup_t;
 
+/*************************************************************//**
+Records an error in the shared state of the threads that build
+indexes, unless some thread has already encountered an error.
+@return	TRUE if this was the first error */
+static
+ibool
+row_merge_par_set_error(
+/*====================*/
+	row_merge_par_t*	par,	/*!< in/out: shared state */
+	ulint			error,	/*!< in: error code */
+	ulint			key_num)/*!< in: position of the index
+					in par->index[] */
+{
+	ibool	first;
+
+	ut_ad(error != DB_SUCCESS);
+
+	mutex_enter(&par->mutex);
+
+	first = par->error == DB_SUCCESS;
+
+	if (first) {
+		par->error = error;
+		par->error_key_num = key_num;
+	}
+
+	mutex_exit(&par->mutex);
+
+	return(first);
+}
+
+/*************************************************************//**
+Reports a duplicate key in a record. Only the first error of all
+threads is copied to the MySQL record buffer. */
+static
+void
+row_merge_dup_report_rec(
+/*=====================*/
+	row_merge_dup_t*	dup,	/*!< in/out: for reporting duplicates */
+	const rec_t*		rec,	/*!< in: duplicate record */
+	const ulint*		offsets)/*!< in: offsets of rec */
+{
+	row_merge_par_t*	par	= dup->par;
+
+	mutex_enter(&par->mutex);
+
+	if (par->error == DB_SUCCESS) {
+		par->error = DB_DUPLICATE_KEY;
+		par->error_key_num = dup->key_num;
+
+		innobase_rec_to_mysql(par->table, rec, dup->index, offsets);
+	}
+
+	mutex_exit(&par->mutex);
+}
+
 /*************************************************************//**
 Report a duplicate key. */
 static
@@ -480,7 +609,7 @@ row_merge_dup_report(
 	rec = rec_convert_dtuple_to_rec(*buf, index, tuple, n_ext);
 	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED, &heap);
 
-	innobase_rec_to_mysql(dup->table, rec, index, offsets);
+	row_merge_dup_report_rec(dup, rec, offsets);
 
 	mem_heap_free(heap);
 }
@@ -590,7 +719,7 @@ row_merge_buf_write(
 {
 	const dict_index_t*	index	= buf->index;
 	ulint			n_fields= dict_index_get_n_fields(index);
-	byte*			b	= &(*block)[0];
+	byte*			b	= &block[0];
 
 	ulint		i;
 
@@ -612,7 +741,7 @@ row_merge_buf_write(
 			*b++ = (byte) (extra_size + 1);
 		}
 
-		ut_ad(b + size < block[1]);
+		ut_ad(b + size < &block[srv_sort_buf_size]);
 
 		rec_convert_dtuple_to_temp(b + extra_size, index,
 					   entry, n_fields);
@@ -630,13 +759,13 @@ row_merge_buf_write(
 	}
 
 	/* Write an "end-of-chunk" marker. */
-	ut_a(b < block[1]);
-	ut_a(b == block[0] + buf->total_size);
+	ut_a(b < &block[srv_sort_buf_size]);
+	ut_a(b == &block[0] + buf->total_size);
 	*b++ = 0;
 #ifdef UNIV_DEBUG_VALGRIND
 	/* The rest of the block is uninitialized.  Initialize it
 	to avoid bogus warnings. */
-	memset(b, 0xff, block[1] - b);
+	memset(b, 0xff, &block[srv_sort_buf_size] - b);
 #endif /* UNIV_DEBUG_VALGRIND */
 #ifdef UNIV_DEBUG
 	if (row_merge_print_write) {
@@ -712,11 +841,10 @@ row_merge_read(
 /*===========*/
 	int			fd,	/*!< in: file descriptor */
 	ulint			offset,	/*!< in: offset where to read
-					in number of row_merge_block_t
-					elements */
+					in number of blocks */
 	row_merge_block_t*	buf)	/*!< out: data */
 {
-	ib_uint64_t	ofs = ((ib_uint64_t) offset) * sizeof *buf;
+	ib_uint64_t	ofs = ((ib_uint64_t) offset) * srv_sort_buf_size;
 	ibool		success;
 
 	DBUG_EXECUTE_IF("row_merge_read_failure", return(FALSE););
@@ -731,10 +859,10 @@ row_merge_read(
 	success = os_file_read_no_error_handling(OS_FILE_FROM_FD(fd), buf,
 						 (ulint) (ofs & 0xFFFFFFFF),
 						 (ulint) (ofs >> 32),
-						 sizeof *buf);
+						 srv_sort_buf_size);
 #ifdef POSIX_FADV_DONTNEED
 	/* Each block is read exactly once.  Free up the file cache. */
-	posix_fadvise(fd, ofs, sizeof *buf, POSIX_FADV_DONTNEED);
+	posix_fadvise(fd, ofs, srv_sort_buf_size, POSIX_FADV_DONTNEED);
 #endif /* POSIX_FADV_DONTNEED */
 
 	if (UNIV_UNLIKELY(!success)) {
@@ -755,10 +883,10 @@ row_merge_write(
 /*============*/
 	int		fd,	/*!< in: file descriptor */
 	ulint		offset,	/*!< in: offset where to write,
-				in number of row_merge_block_t elements */
+				in number of blocks */
 	const void*	buf)	/*!< in: data */
 {
-	size_t		buf_len = sizeof(row_merge_block_t);
+	size_t		buf_len = srv_sort_buf_size;
 	ib_uint64_t	ofs = buf_len * (ib_uint64_t) offset;
 	ibool		ret;
 
@@ -809,8 +937,8 @@ row_merge_read_rec(
 
 	ut_ad(block);
 	ut_ad(buf);
-	ut_ad(b >= block[0]);
-	ut_ad(b < block[1]);
+	ut_ad(b >= &block[0]);
+	ut_ad(b < &block[srv_sort_buf_size]);
 	ut_ad(index);
 	ut_ad(foffs);
 	ut_ad(mrec);
@@ -837,7 +965,7 @@ row_merge_read_rec(
 	if (extra_size >= 0x80) {
 		/* Read another byte of extra_size. */
 
-		if (UNIV_UNLIKELY(b >= block[1])) {
+		if (UNIV_UNLIKELY(b >= &block[srv_sort_buf_size])) {
 			if (!row_merge_read(fd, ++(*foffs), block)) {
 err_exit:
 				/* Signal I/O error. */
@@ -846,7 +974,7 @@ err_exit:
 			}
 
 			/* Wrap around to the beginning of the buffer. */
-			b = block[0];
+			b = &block[0];
 		}
 
 		extra_size = (extra_size & 0x7f) << 8;
@@ -858,12 +986,12 @@ err_exit:
 
 	/* Read the extra bytes. */
 
-	if (UNIV_UNLIKELY(b + extra_size >= block[1])) {
+	if (UNIV_UNLIKELY(b + extra_size >= &block[srv_sort_buf_size])) {
 		/* The record spans two blocks.  Copy the entire record
 		to the auxiliary buffer and handle this as a special
 		case. */
 
-		avail_size = block[1] - b;
+		avail_size = &block[srv_sort_buf_size] - b;
 
 		memcpy(*buf, b, avail_size);
 
@@ -873,7 +1001,7 @@ err_exit:
 		}
 
 		/* Wrap around to the beginning of the buffer. */
-		b = block[0];
+		b = &block[0];
 
 		/* Copy the record. */
 		memcpy(*buf + avail_size, b, extra_size - avail_size);
@@ -889,7 +1017,7 @@ err_exit:
 		records are much smaller than either buffer, and
 		the record starts near the beginning of each buffer. */
 		ut_a(extra_size + data_size < sizeof *buf);
-		ut_a(b + data_size < block[1]);
+		ut_a(b + data_size < &block[srv_sort_buf_size]);
 
 		/* Copy the data bytes. */
 		memcpy(*buf + extra_size, b, data_size);
@@ -907,7 +1035,7 @@ err_exit:
 
 	b += extra_size + data_size;
 
-	if (UNIV_LIKELY(b < block[1])) {
+	if (UNIV_LIKELY(b < &block[srv_sort_buf_size])) {
 		/* The record fits entirely in the block.
 		This is the normal case. */
 		goto func_exit;
@@ -916,7 +1044,7 @@ err_exit:
 	/* The record spans two blocks.  Copy it to buf. */
 
 	b -= extra_size + data_size;
-	avail_size = block[1] - b;
+	avail_size = &block[srv_sort_buf_size] - b;
 	memcpy(*buf, b, avail_size);
 	*mrec = *buf + extra_size;
 #ifdef UNIV_DEBUG
@@ -934,7 +1062,7 @@ err_exit:
 	}
 
 	/* Wrap around to the beginning of the buffer. */
-	b = block[0];
+	b = &block[0];
 
 	/* Copy the rest of the record. */
 	memcpy(*buf + avail_size, b, extra_size + data_size - avail_size);
@@ -1018,11 +1146,11 @@ row_merge_write_rec(
 
 	ut_ad(block);
 	ut_ad(buf);
-	ut_ad(b >= block[0]);
-	ut_ad(b < block[1]);
+	ut_ad(b >= &block[0]);
+	ut_ad(b < &block[srv_sort_buf_size]);
 	ut_ad(mrec);
 	ut_ad(foffs);
-	ut_ad(mrec < block[0] || mrec > block[1]);
+	ut_ad(mrec < &block[0] || mrec > &block[srv_sort_buf_size]);
 	ut_ad(mrec < buf[0] || mrec > buf[1]);
 
 	/* Normalize extra_size.  Value 0 signals "end of list". */
@@ -1031,10 +1159,10 @@ row_merge_write_rec(
 	size = extra_size + (extra_size >= 0x80)
 		+ rec_offs_data_size(offsets);
 
-	if (UNIV_UNLIKELY(b + size >= block[1])) {
+	if (UNIV_UNLIKELY(b + size >= &block[srv_sort_buf_size])) {
 		/* The record spans two blocks.
 		Copy it to the temporary buffer first. */
-		avail_size = block[1] - b;
+		avail_size = &block[srv_sort_buf_size] - b;
 
 		row_merge_write_rec_low(buf[0],
 					extra_size, size, fd, *foffs,
@@ -1049,10 +1177,10 @@ row_merge_write_rec(
 			return(NULL);
 		}
 
-		UNIV_MEM_INVALID(block[0], sizeof block[0]);
+		UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
 
 		/* Copy the rest. */
-		b = block[0];
+		b = &block[0];
 		memcpy(b, buf[0] + avail_size, size - avail_size);
 		b += size - avail_size;
 	} else {
@@ -1077,8 +1205,8 @@ row_merge_write_eof(
 	ulint*			foffs)	/*!< in/out: file offset */
 {
 	ut_ad(block);
-	ut_ad(b >= block[0]);
-	ut_ad(b < block[1]);
+	ut_ad(b >= &block[0]);
+	ut_ad(b < &block[srv_sort_buf_size]);
 	ut_ad(foffs);
 #ifdef UNIV_DEBUG
 	if (row_merge_print_write) {
@@ -1088,20 +1216,20 @@ row_merge_write_eof(
 #endif /* UNIV_DEBUG */
 
 	*b++ = 0;
-	UNIV_MEM_ASSERT_RW(block[0], b - block[0]);
-	UNIV_MEM_ASSERT_W(block[0], sizeof block[0]);
+	UNIV_MEM_ASSERT_RW(&block[0], b - &block[0]);
+	UNIV_MEM_ASSERT_W(&block[0], srv_sort_buf_size);
 #ifdef UNIV_DEBUG_VALGRIND
 	/* The rest of the block is uninitialized.  Initialize it
 	to avoid bogus warnings. */
-	memset(b, 0xff, block[1] - b);
+	memset(b, 0xff, &block[srv_sort_buf_size] - b);
 #endif /* UNIV_DEBUG_VALGRIND */
 
 	if (!row_merge_write(fd, (*foffs)++, block)) {
 		return(NULL);
 	}
 
-	UNIV_MEM_INVALID(block[0], sizeof block[0]);
-	return(block[0]);
+	UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+	return(&block[0]);
 }
 
 /*************************************************************//**
@@ -1139,27 +1267,191 @@ row_merge_cmp(
 	return(cmp);
 }
 
+/** A thread that builds indexes together with other threads */
+typedef struct row_merge_thread_struct row_merge_thread_t;
+
+/** Work that each of the threads that build indexes does.
+@param par		shared state of the threads
+@param thread_no	number of the thread, 0 for the calling thread */
+typedef void (*row_merge_thread_func_t)(row_merge_par_t* par,
+					ulint thread_no);
+
+/** A thread that builds indexes together with other threads */
+struct row_merge_thread_struct {
+	row_merge_par_t*	par;	/*!< shared state */
+	row_merge_thread_func_t	func;	/*!< work to do */
+	ulint			no;	/*!< number of the thread */
+};
+
+/*********************************************************************//**
+A thread that builds indexes together with the thread that invoked
+row_merge_run_threads().
+@return a dummy parameter */
+static
+os_thread_ret_t
+row_merge_thread(
+/*=============*/
+	void*	arg)	/*!< in: row_merge_thread_t */
+{
+	row_merge_thread_t*	thr	= arg;
+	row_merge_par_t*	par	= thr->par;
+	ibool			last;
+
+	thr->func(par, thr->no);
+
+	mutex_enter(&par->mutex);
+	ut_a(par->n_running > 0);
+	last = !--par->n_running;
+	mutex_exit(&par->mutex);
+
+	if (last) {
+		os_event_set(par->event);
+	}
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Executes func in n_threads threads, the calling thread being one of
+them, and waits for all of them to finish. */
+static
+void
+row_merge_run_threads(
+/*==================*/
+	row_merge_par_t*	par,	/*!< in/out: shared state */
+	ulint			n_threads,/*!< in: number of threads */
+	row_merge_thread_func_t	func)	/*!< in: work to do */
+{
+	row_merge_thread_t*	thrs;
+	ulint			i;
+
+	ut_ad(n_threads > 0);
+
+	thrs = mem_alloc(n_threads * sizeof *thrs);
+
+	os_event_reset(par->event);
+	par->n_running = n_threads - 1;
+
+	for (i = 1; i < n_threads; i++) {
+		thrs[i].par = par;
+		thrs[i].func = func;
+		thrs[i].no = i;
+
+		os_thread_create(row_merge_thread, &thrs[i], NULL);
+	}
+
+	func(par, 0);
+
+	if (n_threads > 1) {
+		os_event_wait(par->event);
+	}
+
+	ut_ad(par->n_running == 0);
+
+	mem_free(thrs);
+}
+
 /********************************************************************//**
-Reads clustered index of the table and create temporary files
-containing the index entries for the indexes to be built.
-@return	DB_SUCCESS or error */
+Divides the clustered index into key ranges of roughly equal size for
+the threads that scan it, at the node pointers on the root page. If
+the root page is a leaf page or has fewer node pointers than there are
+threads, fewer key ranges are returned.
+@return	number of key ranges, between 1 and n_threads */
 static __attribute__((nonnull))
 ulint
-row_merge_read_clustered_index(
-/*===========================*/
-	trx_t*			trx,	/*!< in: transaction */
-	struct TABLE*		table,	/*!< in/out: MySQL table object,
-					for reporting erroneous records */
-	const dict_table_t*	old_table,/*!< in: table where rows are
-					read from */
-	const dict_table_t*	new_table,/*!< in: table where indexes are
-					created; identical to old_table
-					unless creating a PRIMARY KEY */
-	dict_index_t**		index,	/*!< in: indexes to be created */
-	merge_file_t*		files,	/*!< in: temporary files */
-	ulint			n_index,/*!< in: number of indexes to create */
-	row_merge_block_t*	block)	/*!< in/out: file buffer */
+row_merge_split_clustered_index(
+/*============================*/
+	dict_index_t*		clust_index,/*!< in: clustered index */
+	ulint			n_threads,/*!< in: maximum number of
+					key ranges */
+	const dtuple_t**	bounds,	/*!< out: boundaries of the key
+					ranges; bounds[0] and bounds[n]
+					are NULL, and the key range i
+					is [bounds[i], bounds[i + 1]) */
+	mem_heap_t*		heap)	/*!< in/out: memory heap for
+					the boundaries */
+{
+	mtr_t		mtr;
+	buf_block_t*	block;
+	const page_t*	root;
+	ulint		n_recs;
+	ulint		n = 1;
+
+	ut_ad(n_threads > 0);
+	ut_ad(dict_index_is_clust(clust_index));
+
+	bounds[0] = NULL;
+
+	if (n_threads == 1) {
+		goto func_exit;
+	}
+
+	mtr_start(&mtr);
+	mtr_s_lock(dict_index_get_lock(clust_index), &mtr);
+
+	block = btr_block_get(dict_index_get_space(clust_index),
+			      dict_table_zip_size(clust_index->table),
+			      dict_index_get_page(clust_index),
+			      RW_S_LATCH, clust_index, &mtr);
+	root = buf_block_get_frame(block);
+	n_recs = page_get_n_recs(root);
+
+	if (btr_page_get_level(root, &mtr) > 0 && n_recs > 1) {
+		const rec_t*	rec;
+		ulint		i;
+		ulint		n_ranges = ut_min(n_threads, n_recs);
+
+		rec = page_rec_get_next_const(page_get_infimum_rec(root));
+
+		/* The key range n starts at the node pointer number
+		n * n_recs / n_ranges.  The first node pointer is the
+		minimum record, and it always starts the key range 0. */
+
+		for (i = 0; n < n_ranges;
+		     i++, rec = page_rec_get_next_const(rec)) {
+
+			ut_ad(page_rec_is_user_rec(rec));
+
+			if (i == n * n_recs / n_ranges) {
+				bounds[n++] = dict_index_build_data_tuple(
+					clust_index, (rec_t*) rec,
+					dict_index_get_n_unique_in_tree(
+						clust_index),
+					heap);
+			}
+		}
+	}
+
+	mtr_commit(&mtr);
+
+func_exit:
+	bounds[n] = NULL;
+
+	return(n);
+}
+
+/********************************************************************//**
+Reads a key range of the clustered index of the table and writes the
+index entries for the indexes to be built to the temporary files.
+Errors are recorded in par. */
+static __attribute__((nonnull))
+void
+row_merge_read_clustered_index_range(
+/*=================================*/
+	row_merge_par_t*	par,	/*!< in/out: shared state */
+	ulint			thread_no)/*!< in: number of the key range */
 {
+	trx_t*			trx	= par->trx;
+	const dict_table_t*	old_table = par->old_table;
+	const dtuple_t*		start	= par->bounds[thread_no];
+	const dtuple_t*		end	= par->bounds[thread_no + 1];
+	row_merge_block_t*	block	= par->block
+		+ 3 * thread_no * srv_sort_buf_size;
 	dict_index_t*		clust_index;	/* Clustered index */
 	mem_heap_t*		row_heap;	/* Heap memory to create
 						clustered index records */
@@ -1169,24 +1461,16 @@ row_merge_read_clustered_index(
 	mtr_t			mtr;		/* Mini transaction */
 	ulint			err = DB_SUCCESS;/* Return code */
 	ulint			i;
-	ulint			n_nonnull = 0;	/* number of columns
-						changed to NOT NULL */
-	ulint*			nonnull = NULL;	/* NOT NULL columns */
-
-	trx->op_info = "reading clustered index";
-
-	ut_ad(trx);
-	ut_ad(old_table);
-	ut_ad(new_table);
-	ut_ad(index);
-	ut_ad(files);
+	ulint			n_rows_scanned = 0;/* number of records
+						scanned since the progress
+						was last reported */
 
 	/* Create and initialize memory for record buffers */
 
-	merge_buf = mem_alloc(n_index * sizeof *merge_buf);
+	merge_buf = mem_alloc(par->n_index * sizeof *merge_buf);
 
-	for (i = 0; i < n_index; i++) {
-		merge_buf[i] = row_merge_buf_create(index[i]);
+	for (i = 0; i < par->n_index; i++) {
+		merge_buf[i] = row_merge_buf_create(par->index[i]);
 	}
 
 	mtr_start(&mtr);
@@ -1196,40 +1480,15 @@ row_merge_read_clustered_index(
 
 	clust_index = dict_table_get_first_index(old_table);
 
-	btr_pcur_open_at_index_side(
-		TRUE, clust_index, BTR_SEARCH_LEAF, &pcur, TRUE, &mtr);
-
-	if (UNIV_UNLIKELY(old_table != new_table)) {
-		ulint	n_cols = dict_table_get_n_cols(old_table);
-
-		/* A primary key will be created.  Identify the
-		columns that were flagged NOT NULL in the new table,
-		so that we can quickly check that the records in the
-		(old) clustered index do not violate the added NOT
-		NULL constraints. */
-
-		ut_a(n_cols == dict_table_get_n_cols(new_table));
-
-		nonnull = mem_alloc(n_cols * sizeof *nonnull);
-
-		for (i = 0; i < n_cols; i++) {
-			if (dict_table_get_nth_col(old_table, i)->prtype
-			    & DATA_NOT_NULL) {
-
-				continue;
-			}
-
-			if (dict_table_get_nth_col(new_table, i)->prtype
-			    & DATA_NOT_NULL) {
-
-				nonnull[n_nonnull++] = i;
-			}
-		}
-
-		if (!n_nonnull) {
-			mem_free(nonnull);
-			nonnull = NULL;
-		}
+	if (start) {
+		/* Position the cursor on the last record before the
+		key range, so that moving to the next record in the
+		loop below yields the first record of the key range. */
+		btr_pcur_open(clust_index, start, PAGE_CUR_L,
+			      BTR_SEARCH_LEAF, &pcur, &mtr);
+	} else {
+		btr_pcur_open_at_index_side(
+			TRUE, clust_index, BTR_SEARCH_LEAF, &pcur, TRUE, &mtr);
 	}
 
 	row_heap = mem_heap_create(sizeof(mrec_buf_t));
@@ -1254,6 +1513,11 @@ row_merge_read_clustered_index(
 				goto err_exit;
 			}
 
+			if (UNIV_UNLIKELY(par->error != DB_SUCCESS)) {
+				/* Another thread failed. */
+				goto func_exit;
+			}
+
 			/* Store the cursor position on the last user
 			record on the page. */
 			btr_pcur_move_to_prev_on_page(&pcur);
@@ -1266,6 +1530,19 @@ row_merge_read_clustered_index(
 
 			btr_pcur_store_position(&pcur, &mtr);
 			mtr_commit(&mtr);
+
+			mutex_enter(&par->mutex);
+			par->n_rows_scanned += n_rows_scanned;
+
+			if (par->n_rows_total > 0) {
+				srv_online_alter_progress = (ulint) ut_min(
+					99, par->n_rows_scanned * 100
+					/ par->n_rows_total);
+			}
+
+			mutex_exit(&par->mutex);
+			n_rows_scanned = 0;
+
 			mtr_start(&mtr);
 			/* Restore position on the record, or its
 			predecessor if the record was purged
@@ -1281,6 +1558,36 @@ row_merge_read_clustered_index(
 			offsets = rec_get_offsets(rec, clust_index, NULL,
 						  ULINT_UNDEFINED, &row_heap);
 
+			/* The records from the end of the key range
+			onwards are read by the next thread. */
+			has_next = !end
+				|| cmp_dtuple_rec(end, rec, offsets) > 0;
+		}
+
+		if (UNIV_LIKELY(has_next)) {
+			n_rows_scanned++;
+
+			if (par->online && !lock_clust_rec_cons_read_sees(
+				    rec, clust_index, offsets,
+				    trx->read_view)) {
+				rec_t*	old_vers;
+
+				/* The record was modified after the read
+				view was created. The modification has
+				been written to the log of each index. */
+				row_vers_build_for_consistent_read(
+					rec, &mtr, clust_index, &offsets,
+					trx->read_view, &row_heap,
+					row_heap, &old_vers);
+				rec = old_vers;
+
+				if (!rec) {
+					/* Inserted after the read view
+					was created. */
+					continue;
+				}
+			}
+
 			/* Skip delete marked records. */
 			if (rec_get_deleted_flag(
 				    rec, dict_table_is_comp(old_table))) {
@@ -1293,12 +1600,14 @@ row_merge_read_clustered_index(
 
 			row = row_build(ROW_COPY_POINTERS, clust_index,
 					rec, offsets,
-					new_table, &ext, row_heap);
+					par->new_table, &ext, row_heap);
 
-			if (UNIV_LIKELY_NULL(nonnull)) {
-				for (i = 0; i < n_nonnull; i++) {
+			if (UNIV_LIKELY_NULL(par->nonnull)) {
+				for (i = 0; i < par->n_nonnull; i++) {
+					ulint		col_no
+						= par->nonnull[i];
 					dfield_t*	field
-						= &row->fields[nonnull[i]];
+						= &row->fields[col_no];
 					dtype_t*	field_type
 						= dfield_get_type(field);
 
@@ -1319,14 +1628,14 @@ row_merge_read_clustered_index(
 		/* Build all entries for all the indexes to be created
 		in a single scan of the clustered index. */
 
-		for (i = 0; i < n_index; i++) {
+		for (i = 0; i < par->n_index; i++) {
 			row_merge_buf_t*	buf	= merge_buf[i];
-			merge_file_t*		file	= &files[i];
+			merge_file_t*		file	= &par->files[i];
 			const dict_index_t*	index	= buf->index;
+			ulint			offset;
 
 			if (UNIV_LIKELY
 			    (row && row_merge_buf_add(buf, row, ext))) {
-				file->n_rec++;
 				continue;
 			}
 
@@ -1334,38 +1643,54 @@ row_merge_read_clustered_index(
 			to hold at least one record. */
 			ut_ad(buf->n_tuples || !has_next);
 
+			if (!buf->n_tuples) {
+				/* The key range ended with an empty
+				buffer.  Other threads may have written
+				blocks to the file, and if not,
+				row_merge_read_clustered_index() will
+				write an empty one. */
+				continue;
+			}
+
 			/* We have enough data tuples to form a block.
 			Sort them and write to disk. */
 
-			if (buf->n_tuples) {
-				if (dict_index_is_unique(index)) {
-					row_merge_dup_t	dup;
-					dup.index = buf->index;
-					dup.table = table;
-					dup.n_dup = 0;
+			if (dict_index_is_unique(index)) {
+				row_merge_dup_t	dup;
+				dup.index = buf->index;
+				dup.par = par;
+				dup.key_num = i;
+				dup.n_dup = 0;
 
-					row_merge_buf_sort(buf, &dup);
+				row_merge_buf_sort(buf, &dup);
 
-					if (dup.n_dup) {
-						err = DB_DUPLICATE_KEY;
-err_exit:
-						trx->error_key_num = i;
-						goto func_exit;
-					}
-				} else {
-					row_merge_buf_sort(buf, NULL);
+				if (dup.n_dup) {
+					/* The error was recorded by
+					row_merge_dup_report(). */
+					goto func_exit;
 				}
+			} else {
+				row_merge_buf_sort(buf, NULL);
 			}
 
 			row_merge_buf_write(buf, file, block);
 
-			if (!row_merge_write(file->fd, file->offset++,
-					     block)) {
+			/* Each block is a sorted run of its own, so the
+			blocks of different threads can be interleaved
+			in the file. */
+			mutex_enter(&par->mutex);
+			offset = file->offset++;
+			file->n_rec += buf->n_tuples;
+			mutex_exit(&par->mutex);
+
+			if (!row_merge_write(file->fd, offset, block)) {
 				err = DB_OUT_OF_FILE_SPACE;
-				goto err_exit;
+err_exit:
+				row_merge_par_set_error(par, err, i);
+				goto func_exit;
 			}
 
-			UNIV_MEM_INVALID(block[0], sizeof block[0]);
+			UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
 			merge_buf[i] = row_merge_buf_empty(buf);
 
 			if (UNIV_LIKELY(row != NULL)) {
@@ -1379,8 +1704,6 @@ err_exit:
 					room for at least one record. */
 					ut_error;
 				}
-
-				file->n_rec++;
 			}
 		}
 
@@ -1396,19 +1719,130 @@ func_exit:
 	mtr_commit(&mtr);
 	mem_heap_free(row_heap);
 
-	if (UNIV_LIKELY_NULL(nonnull)) {
-		mem_free(nonnull);
-	}
+	mutex_enter(&par->mutex);
+	par->n_rows_scanned += n_rows_scanned;
+	mutex_exit(&par->mutex);
 
-	for (i = 0; i < n_index; i++) {
+	for (i = 0; i < par->n_index; i++) {
 		row_merge_buf_free(merge_buf[i]);
 	}
 
 	mem_free(merge_buf);
+}
+
+/********************************************************************//**
+Reads clustered index of the table and create temporary files
+containing the index entries for the indexes to be built. The
+clustered index is divided into key ranges that are read by
+parallel threads.
+@return	DB_SUCCESS or error */
+static __attribute__((nonnull))
+ulint
+row_merge_read_clustered_index(
+/*===========================*/
+	row_merge_par_t*	par,	/*!< in/out: shared state */
+	ulint			n_threads)/*!< in: maximum number of
+					threads to read with */
+{
+	trx_t*			trx		= par->trx;
+	const dict_table_t*	old_table	= par->old_table;
+	const dict_table_t*	new_table	= par->new_table;
+	mem_heap_t*		heap;
+	const dtuple_t**	bounds;
+	ulint			i;
+	ulint			n_nonnull = 0;	/* number of columns
+						changed to NOT NULL */
+	ulint*			nonnull = NULL;	/* NOT NULL columns */
+
+	trx->op_info = "reading clustered index";
+
+	ut_ad(trx);
+	ut_ad(old_table);
+	ut_ad(new_table);
+	ut_ad(!par->online || old_table == new_table);
+	ut_ad(!par->online || trx->read_view);
+
+	/* The estimate is only used for reporting progress. */
+	par->n_rows_total = old_table->stat_n_rows;
+	par->n_rows_scanned = 0;
+	srv_online_alter_progress = 0;
+
+	if (UNIV_UNLIKELY(old_table != new_table)) {
+		ulint	n_cols = dict_table_get_n_cols(old_table);
+
+		/* A primary key will be created.  Identify the
+		columns that were flagged NOT NULL in the new table,
+		so that we can quickly check that the records in the
+		(old) clustered index do not violate the added NOT
+		NULL constraints. */
+
+		ut_a(n_cols == dict_table_get_n_cols(new_table));
+
+		nonnull = mem_alloc(n_cols * sizeof *nonnull);
+
+		for (i = 0; i < n_cols; i++) {
+			if (dict_table_get_nth_col(old_table, i)->prtype
+			    & DATA_NOT_NULL) {
+
+				continue;
+			}
+
+			if (dict_table_get_nth_col(new_table, i)->prtype
+			    & DATA_NOT_NULL) {
+
+				nonnull[n_nonnull++] = i;
+			}
+		}
+
+		if (!n_nonnull) {
+			mem_free(nonnull);
+			nonnull = NULL;
+		}
+	}
+
+	par->nonnull = nonnull;
+	par->n_nonnull = n_nonnull;
+
+	heap = mem_heap_create(1024);
+	bounds = mem_heap_alloc(heap, (n_threads + 1) * sizeof *bounds);
+
+	n_threads = row_merge_split_clustered_index(
+		dict_table_get_first_index(old_table),
+		n_threads, bounds, heap);
+
+	par->bounds = bounds;
+
+	row_merge_run_threads(par, n_threads,
+			      row_merge_read_clustered_index_range);
+
+	/* The file should always contain at least one byte (the end
+	of file marker).  Write an empty block if no thread wrote
+	a block to the file. */
+
+	for (i = 0; par->error == DB_SUCCESS && i < par->n_index; i++) {
+		merge_file_t*	file	= &par->files[i];
+
+		if (file->offset == 0
+		    && !row_merge_write_eof(par->block, par->block,
+					    file->fd, &file->offset)) {
+			par->error = DB_OUT_OF_FILE_SPACE;
+			par->error_key_num = i;
+		}
+	}
+
+	par->bounds = NULL;
+	mem_heap_free(heap);
+
+	if (UNIV_LIKELY_NULL(nonnull)) {
+		mem_free(nonnull);
+	}
+
+	par->nonnull = NULL;
+	par->n_nonnull = 0;
 
 	trx->op_info = "";
 
-	return(err);
+	return(par->error);
 }
 
 /** Write a record via buffer 2 and read the next record to buffer N.
@@ -1416,13 +1850,15 @@ func_exit:
 @param AT_END	statement to execute at end of input */
 #define ROW_MERGE_WRITE_GET_NEXT(N, AT_END)				\
 	do {								\
-		b2 = row_merge_write_rec(&block[2], &buf[2], b2,	\
+		b2 = row_merge_write_rec(&block[2 * srv_sort_buf_size],	\
+					 &buf[2], b2,			\
 					 of->fd, &of->offset,		\
 					 mrec##N, offsets##N);		\
 		if (UNIV_UNLIKELY(!b2 || ++of->n_rec > file->n_rec)) {	\
 			goto corrupt;					\
 		}							\
-		b##N = row_merge_read_rec(&block[N], &buf[N],		\
+		b##N = row_merge_read_rec(&block[N * srv_sort_buf_size],\
+					  &buf[N],			\
 					  b##N, index,			\
 					  file->fd, foffs##N,		\
 					  &mrec##N, offsets##N);	\
@@ -1450,9 +1886,8 @@ row_merge_blocks(
 	ulint*			foffs1,	/*!< in/out: offset of second
 					source list in the file */
 	merge_file_t*		of,	/*!< in/out: output file */
-	struct TABLE*		table)	/*!< in/out: MySQL table, for
-					reporting erroneous key value
-					if applicable */
+	row_merge_dup_t*	dup)	/*!< in/out: for reporting
+					duplicate key values */
 {
 	mem_heap_t*	heap;	/*!< memory heap for offsets0, offsets1 */
 
@@ -1483,20 +1918,20 @@ row_merge_blocks(
 	file in two halves, which can be merged on the following pass. */
 
 	if (!row_merge_read(file->fd, *foffs0, &block[0])
-	    || !row_merge_read(file->fd, *foffs1, &block[1])) {
+	    || !row_merge_read(file->fd, *foffs1, &block[srv_sort_buf_size])) {
 corrupt:
 		mem_heap_free(heap);
 		return(DB_CORRUPTION);
 	}
 
-	b0 = block[0];
-	b1 = block[1];
-	b2 = block[2];
+	b0 = &block[0];
+	b1 = &block[srv_sort_buf_size];
+	b2 = &block[2 * srv_sort_buf_size];
 
 	b0 = row_merge_read_rec(&block[0], &buf[0], b0, index, file->fd,
 				foffs0, &mrec0, offsets0);
-	b1 = row_merge_read_rec(&block[1], &buf[1], b1, index, file->fd,
-				foffs1, &mrec1, offsets1);
+	b1 = row_merge_read_rec(&block[srv_sort_buf_size], &buf[1], b1,
+				index, file->fd, foffs1, &mrec1, offsets1);
 	if (UNIV_UNLIKELY(!b0 && mrec0)
 	    || UNIV_UNLIKELY(!b1 && mrec1)) {
 
@@ -1511,8 +1946,8 @@ corrupt:
 		case 0:
 			if (UNIV_UNLIKELY
 			    (dict_index_is_unique(index) && !null_eq)) {
-				innobase_rec_to_mysql(table, mrec0,
-						      index, offsets0);
+				row_merge_dup_report_rec(dup, mrec0,
+							 offsets0);
 				mem_heap_free(heap);
 				return(DB_DUPLICATE_KEY);
 			}
@@ -1546,7 +1981,8 @@ done0:
 done1:
 
 	mem_heap_free(heap);
-	b2 = row_merge_write_eof(&block[2], b2, of->fd, &of->offset);
+	b2 = row_merge_write_eof(&block[2 * srv_sort_buf_size], b2,
+				 of->fd, &of->offset);
 	return(b2 ? DB_SUCCESS : DB_CORRUPTION);
 }
 
@@ -1594,8 +2030,8 @@ corrupt:
 		return(FALSE);
 	}
 
-	b0 = block[0];
-	b2 = block[2];
+	b0 = &block[0];
+	b2 = &block[2 * srv_sort_buf_size];
 
 	b0 = row_merge_read_rec(&block[0], &buf[0], b0, index, file->fd,
 				foffs0, &mrec0, offsets0);
@@ -1617,7 +2053,8 @@ done0:
 	(*foffs0)++;
 
 	mem_heap_free(heap);
-	return(row_merge_write_eof(&block[2], b2, of->fd, &of->offset)
+	return(row_merge_write_eof(&block[2 * srv_sort_buf_size], b2,
+				   of->fd, &of->offset)
 	       != NULL);
 }
 
@@ -1634,9 +2071,8 @@ row_merge(
 					index entries */
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
 	int*			tmpfd,	/*!< in/out: temporary file handle */
-	struct TABLE*		table,	/*!< in/out: MySQL table, for
-					reporting erroneous key value
-					if applicable */
+	row_merge_dup_t*	dup,	/*!< in/out: for reporting
+					duplicate key values */
 	ulint*			num_run,/*!< in/out: Number of runs remain
 					to be merged */
 	ulint*			run_offset) /*!< in/out: Array contains the
@@ -1653,7 +2089,7 @@ row_merge(
 				/*!< num of runs generated from this merge */
 
 
-	UNIV_MEM_ASSERT_W(block[0], 3 * sizeof block[0]);
+	UNIV_MEM_ASSERT_W(&block[0], 3 * srv_sort_buf_size);
 
 	ut_ad(ihalf < file->offset);
 
@@ -1685,7 +2121,7 @@ row_merge(
 		run_offset[n_run++] = of.offset;
 
 		error = row_merge_blocks(index, file, block,
-					 &foffs0, &foffs1, &of, table);
+					 &foffs0, &foffs1, &of, dup);
 
 		if (error != DB_SUCCESS) {
 			return(error);
@@ -1747,7 +2183,7 @@ row_merge(
 	*tmpfd = file->fd;
 	*file = of;
 
-	UNIV_MEM_INVALID(block[0], 3 * sizeof block[0]);
+	UNIV_MEM_INVALID(&block[0], 3 * srv_sort_buf_size);
 
 	return(DB_SUCCESS);
 }
@@ -1765,9 +2201,8 @@ row_merge_sort(
 					index entries */
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
 	int*			tmpfd,	/*!< in/out: temporary file handle */
-	struct TABLE*		table)	/*!< in/out: MySQL table, for
-					reporting erroneous key value
-					if applicable */
+	row_merge_dup_t*	dup)	/*!< in/out: for reporting
+					duplicate key values */
 {
 	ulint	half = file->offset / 2;
 	ulint	num_runs;
@@ -1796,7 +2231,7 @@ row_merge_sort(
 	/* Merge the runs until we have one big run */
 	do {
 		error = row_merge(trx, index, file, block, tmpfd,
-				  table, &num_runs, run_offset);
+				  dup, &num_runs, run_offset);
 
 		UNIV_MEM_ASSERT_RW(run_offset, num_runs * sizeof *run_offset);
 
@@ -1810,6 +2245,57 @@ row_merge_sort(
 	return(error);
 }
 
+/*************************************************************//**
+Merge sorts the temporary files of the indexes that no other thread
+has started to sort, until all of them have been sorted or some
+thread has encountered an error. Errors are recorded in par. */
+static __attribute__((nonnull))
+void
+row_merge_sort_indexes(
+/*===================*/
+	row_merge_par_t*	par,	/*!< in/out: shared state */
+	ulint			thread_no)/*!< in: number of the thread */
+{
+	row_merge_block_t*	block	= par->block
+		+ 3 * thread_no * srv_sort_buf_size;
+
+	for (;;) {
+		ulint		i;
+		ulint		error;
+		row_merge_dup_t	dup;
+
+		mutex_enter(&par->mutex);
+
+		i = par->next;
+
+		if (i < par->n_index && par->error == DB_SUCCESS) {
+			par->next++;
+		} else {
+			i = ULINT_UNDEFINED;
+		}
+
+		mutex_exit(&par->mutex);
+
+		if (i == ULINT_UNDEFINED) {
+			break;
+		}
+
+		dup.index = par->index[i];
+		dup.par = par;
+		dup.key_num = i;
+		dup.n_dup = 0;
+
+		error = row_merge_sort(par->trx, par->index[i],
+				       &par->files[i], block,
+				       &par->tmpfd[i], &dup);
+
+		if (error != DB_SUCCESS) {
+			row_merge_par_set_error(par, error, i);
+			break;
+		}
+	}
+}
+
 /*************************************************************//**
 Copy externally stored columns to the data tuple. */
 static
@@ -1904,7 +2390,7 @@ row_merge_insert_index_tuples(
 		offsets[1] = dict_index_get_n_fields(index);
 	}
 
-	b = *block;
+	b = block;
 
 	if (!row_merge_read(fd, foffs, block)) {
 		error = DB_CORRUPTION;
@@ -2231,10 +2717,11 @@ row_merge_drop_temp_indexes(void)
 }
 
 /*********************************************************************//**
-Creates temperary merge files, and if UNIV_PFS_IO defined, register
-the file descriptor with Performance Schema.
+Creates a temporary file for merge sorting or for the modification log
+of online index creation, and if UNIV_PFS_IO is defined, registers the
+file descriptor with Performance Schema.
 @return file descriptor, or -1 on failure */
-UNIV_INLINE
+UNIV_INTERN
 int
 row_merge_file_create_low(void)
 /*===========================*/
@@ -2279,9 +2766,10 @@ row_merge_file_create(
 }
 
 /*********************************************************************//**
-Destroy a merge file. And de-register the file from Performance Schema
-if UNIV_PFS_IO is defined. */
-UNIV_INLINE
+Destroys a temporary file that was created by row_merge_file_create_low(),
+and if UNIV_PFS_IO is defined, de-registers the file from Performance
+Schema. */
+UNIV_INTERN
 void
 row_merge_file_destroy_low(
 /*=======================*/
@@ -2692,6 +3180,8 @@ row_merge_drop_table(
 Build indexes on a table by reading a clustered index,
 creating a temporary file containing index entries, merge sorting
 these index entries and inserting sorted index entries to indexes.
+The clustered index is read and the temporary files are sorted by
+up to innodb_sort_threads threads in parallel.
 @return	DB_SUCCESS or error code */
 UNIV_INTERN
 ulint
@@ -2705,16 +3195,22 @@ row_merge_build_indexes(
 					unless creating a PRIMARY KEY */
 	dict_index_t**	indexes,	/*!< in: indexes to be created */
 	ulint		n_indexes,	/*!< in: size of indexes[] */
-	struct TABLE*	table)		/*!< in/out: MySQL table, for
+	struct TABLE*	table,		/*!< in/out: MySQL table, for
 					reporting erroneous key value
 					if applicable */
+	ibool		online)		/*!< in: TRUE if the indexes are
+					being created online, reading
+					old_table through trx->read_view
+					while it is being modified */
 {
 	merge_file_t*		merge_files;
+	int*			tmpfds;
 	row_merge_block_t*	block;
 	ulint			block_size;
+	row_merge_par_t		par;
+	ulint			n_threads;
 	ulint			i;
 	ulint			error;
-	int			tmpfd = -1;
 
 	ut_ad(trx);
 	ut_ad(old_table);
@@ -2724,11 +3220,18 @@ row_merge_build_indexes(
 
 	trx_start_if_not_started(trx);
 
+	/* innodb_sort_threads may be changed meanwhile. */
+	n_threads = srv_n_sort_threads;
+	ut_ad(n_threads > 0);
+
 	/* Allocate memory for merge file data structure and initialize
 	fields */
 
 	merge_files = mem_alloc(n_indexes * sizeof *merge_files);
-	block_size = 3 * sizeof *block;
+	tmpfds = mem_alloc(n_indexes * sizeof *tmpfds);
+
+	/* Each thread needs 3 blocks for merge sorting. */
+	block_size = 3 * n_threads * srv_sort_buf_size;
 	block = os_mem_alloc_large(&block_size, FALSE);
 
 	/* Initialize all the merge file descriptors, so that we
@@ -2737,6 +3240,27 @@ row_merge_build_indexes(
 
 	for (i = 0; i < n_indexes; i++) {
 		merge_files[i].fd = -1;
+		tmpfds[i] = -1;
+	}
+
+	memset(&par, 0, sizeof par);
+	mutex_create(row_merge_par_mutex_key, &par.mutex, SYNC_ANY_LATCH);
+	par.event = os_event_create(NULL);
+	par.error = DB_SUCCESS;
+	par.trx = trx;
+	par.table = table;
+	par.old_table = old_table;
+	par.new_table = new_table;
+	par.index = indexes;
+	par.files = merge_files;
+	par.tmpfd = tmpfds;
+	par.n_index = n_indexes;
+	par.online = online;
+	par.block = block;
+
+	if (UNIV_UNLIKELY(!block)) {
+		error = DB_OUT_OF_MEMORY;
+		goto func_exit;
 	}
 
 	for (i = 0; i < n_indexes; i++) {
@@ -2746,14 +3270,14 @@ row_merge_build_indexes(
 			error = DB_OUT_OF_MEMORY;
 			goto func_exit;
 		}
-	}
 
-	tmpfd = row_merge_file_create_low();
+		tmpfds[i] = row_merge_file_create_low();
 
-	if (tmpfd < 0)
-	{
-		error = DB_OUT_OF_MEMORY;
-		goto func_exit;
+		if (tmpfds[i] < 0)
+		{
+			error = DB_OUT_OF_MEMORY;
+			goto func_exit;
+		}
 	}
 
 	/* Reset the MySQL row buffer that is used when reporting
@@ -2763,31 +3287,50 @@ row_merge_build_indexes(
 	/* Read clustered index of the table and create files for
 	secondary index entries for merge sort */
 
-	error = row_merge_read_clustered_index(
-		trx, table, old_table, new_table, indexes,
-		merge_files, n_indexes, block);
+	error = row_merge_read_clustered_index(&par, n_threads);
 
 	if (error != DB_SUCCESS) {
-
+		trx->error_key_num = par.error_key_num;
 		goto func_exit;
 	}
 
+	DEBUG_SYNC_C("innodb_add_index_after_scan");
+
 	/* Now we have files containing index entries ready for
-	sorting and inserting. */
+	sorting and inserting.  Sort the files of different indexes
+	in parallel. */
+
+	row_merge_run_threads(&par, ut_min(n_threads, n_indexes),
+			      row_merge_sort_indexes);
+
+	error = par.error;
+
+	if (error != DB_SUCCESS) {
+		trx->error_key_num = par.error_key_num;
+		goto func_exit;
+	}
+
+	/* The index entries are inserted by this thread, because
+	row_merge_insert_index_tuples() executes a query graph
+	of trx. */
 
 	for (i = 0; i < n_indexes; i++) {
-		error = row_merge_sort(trx, indexes[i], &merge_files[i],
-				       block, &tmpfd, table);
-
-		if (error == DB_SUCCESS) {
-			error = row_merge_insert_index_tuples(
-				trx, indexes[i], new_table,
-				dict_table_zip_size(old_table),
-				merge_files[i].fd, block);
-		}
+		error = row_merge_insert_index_tuples(
+			trx, indexes[i], new_table,
+			dict_table_zip_size(old_table),
+			merge_files[i].fd, block);
 
-		/* Close the temporary file to free up space. */
+		/* Close the temporary files to free up space. */
 		row_merge_file_destroy(&merge_files[i]);
+		row_merge_file_destroy_low(tmpfds[i]);
+		tmpfds[i] = -1;
+
+		if (error == DB_SUCCESS && online) {
+			/* Apply the modifications that were made to
+			the table meanwhile, so that less of the log
+			remains for row_log_apply(). */
+			error = row_log_catch_up(trx, indexes[i]);
+		}
 
 		if (error != DB_SUCCESS) {
 			trx->error_key_num = i;
@@ -2795,15 +3338,26 @@ row_merge_build_indexes(
 		}
 	}
 
-func_exit:
-	row_merge_file_destroy_low(tmpfd);
+	srv_online_alter_progress = 100;
 
+func_exit:
 	for (i = 0; i < n_indexes; i++) {
 		row_merge_file_destroy(&merge_files[i]);
+
+		if (tmpfds[i] >= 0) {
+			row_merge_file_destroy_low(tmpfds[i]);
+		}
 	}
 
+	os_event_free(par.event);
+	mutex_free(&par.mutex);
+
+	mem_free(tmpfds);
 	mem_free(merge_files);
-	os_mem_free_large(block, block_size);
+
+	if (block) {
+		os_mem_free_large(block, block_size);
+	}
 
 	return(error);
 }
@@ -40,6 +40,7 @@ Created 9/17/2000 Heikki Tuuri
 #include "dict0dict.h"
 #include "dict0crea.h"
 #include "dict0load.h"
+#include "dict0stats.h"
 #include "dict0boot.h"
 #include "trx0roll.h"
 #include "trx0purge.h"
@@ -758,6 +759,8 @@ row_create_prebuilt(
 
 	prebuilt->autoinc_last_value = 0;
 
+	prebuilt->fetch_cache_limit = MYSQL_FETCH_CACHE_SIZE;
+
 	prebuilt->mysql_row_len = mysql_row_len;
 
 	return(prebuilt);
@@ -822,7 +825,8 @@ row_prebuilt_free(
 		mem_heap_free(prebuilt->old_vers_heap);
 	}
 
-	for (i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
+	for (i = 0; prebuilt->fetch_cache && i < prebuilt->fetch_cache_max;
+	     i++) {
 		if (prebuilt->fetch_cache[i] != NULL) {
 
 			if ((ROW_PREBUILT_FETCH_MAGIC_N != mach_read_from_4(
@@ -843,6 +847,10 @@ row_prebuilt_free(
 		}
 	}
 
+	if (prebuilt->fetch_cache) {
+		mem_free(prebuilt->fetch_cache);
+	}
+
 	dict_table_decrement_handle_count(prebuilt->table, dict_locked);
 
 	mem_heap_free(prebuilt->heap);
@@ -962,6 +970,22 @@ row_update_statistics_if_needed(
 
 	table->stat_modified_counter = counter + 1;
 
+	if (srv_stats_persistent) {
+		/* Have the statistics thread recalculate and store
+		the statistics if 1 / 10 of the table has been
+		modified. */
+
+		if (srv_stats_auto_recalc
+		    && (ib_int64_t) counter > 16 + table->stat_n_rows / 10) {
+
+			table->stat_modified_counter = 0;
+
+			dict_stats_recalc_pool_add(table);
+		}
+
+		return;
+	}
+
 	/* Calculate new statistics if 1 / 16 of table has been modified
 	since the last time a statistics batch was run, or if
 	stat_modified_counter > 2 000 000 000 (to avoid wrap-around).
@@ -987,11 +1011,11 @@ row_unlock_table_autoinc_for_mysql(
 	trx_t*	trx)	/*!< in/out: transaction */
 {
 	if (lock_trx_holds_autoinc_locks(trx)) {
-		mutex_enter(&kernel_mutex);
+		lock_mutex_enter();
 
 		lock_release_autoinc_locks(trx);
 
-		mutex_exit(&kernel_mutex);
+		lock_mutex_exit();
 	}
 }
 
@@ -1020,7 +1044,7 @@ row_lock_table_autoinc_for_mysql(
 
 	/* If we already hold an AUTOINC lock on the table then do nothing.
         Note: We peek at the value of the current owner without acquiring
-	the kernel mutex. **/
+	the lock mutex. **/
 	if (trx == table->autoinc_trx) {
 
 		return(DB_SUCCESS);
@@ -3053,6 +3077,13 @@ next_rec:
 	dict_update_statistics(table, FALSE /* update even if stats are
 					    initialized */);
 
+	if (srv_stats_persistent) {
+		/* We hold the data dictionary latch: leave storing
+		the statistics of the empty table to the statistics
+		thread. */
+		dict_stats_recalc_pool_add(table);
+	}
+
 	trx_commit_for_mysql(trx);
 
 funct_exit:
@@ -3390,6 +3421,10 @@ check_next_foreign:
 			   "END;\n"
 			   , FALSE, trx);
 
+	if (err == DB_SUCCESS) {
+		err = dict_stats_drop_table(name, trx);
+	}
+
 	switch (err) {
 		ibool		is_temp;
 		const char*	name_or_path;
@@ -3415,6 +3450,8 @@ check_next_foreign:
 				& DICT_TF2_TEMPORARY;
 		}
 
+		dict_stats_recalc_pool_del(table);
+
 		dict_table_remove_from_cache(table);
 
 		if (dict_load_table(name, TRUE, DICT_ERR_IGNORE_NONE) != NULL) {
@@ -3954,6 +3991,10 @@ row_rename_table_for_mysql(
 			   "END;\n"
 			   , FALSE, trx);
 
+	if (err == DB_SUCCESS) {
+		err = dict_stats_rename_table(old_name, new_name, trx);
+	}
+
 	if (err != DB_SUCCESS) {
 
 		goto end;
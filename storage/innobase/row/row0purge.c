@@ -42,6 +42,7 @@ Created 3/14/1997 Heikki Tuuri
 #include "row0upd.h"
 #include "row0vers.h"
 #include "row0mysql.h"
+#include "row0log.h"
 #include "log0log.h"
 
 /*************************************************************************
@@ -75,6 +76,9 @@ row_purge_node_create(
 
 	node->heap = mem_heap_create(256);
 
+	node->undo_recs = NULL;
+	node->next_rec = 0;
+
 	return(node);
 }
 
@@ -427,9 +431,31 @@ row_purge_remove_sec_if_poss(
 {
 	ibool	success;
 	ulint	n_tries		= 0;
+	ibool	online;
 
 	/*	fputs("Purge: Removing secondary record\n", stderr); */
 
+	rw_lock_s_lock(dict_index_get_lock(index));
+	online = dict_index_is_online_ddl(index);
+	rw_lock_s_unlock(dict_index_get_lock(index));
+
+	if (online) {
+		/* The index is being created online. Only the thread
+		that creates it may modify the index tree. Log the
+		removal while holding index->lock exclusively, so that
+		a concurrent modification that inserts the entry again
+		will be logged after it. */
+		rw_lock_x_lock(dict_index_get_lock(index));
+
+		if (dict_index_is_online_ddl(index)
+		    && row_purge_poss_sec(node, index, entry)) {
+			row_log_online_op(index, entry, 0, ROW_OP_PURGE);
+		}
+
+		rw_lock_x_unlock(dict_index_get_lock(index));
+		return;
+	}
+
 	if (row_purge_remove_sec_if_poss_leaf(node, index, entry)) {
 
 		return;
@@ -508,6 +534,7 @@ row_purge_upd_exist_or_extern_func(
 	dict_index_t*	index;
 	ibool		is_insert;
 	ulint		rseg_id;
+	trx_rseg_t*	rseg;
 	ulint		page_no;
 	ulint		offset;
 	ulint		i;
@@ -594,10 +621,13 @@ skip_secondaries:
 
 			btr_root_get(index, &mtr);
 
-			/* We assume in purge of externally stored fields
-			that the space id of the undo log record is 0! */
+			/* The undo log record is in the tablespace of its
+			rollback segment, which may be an undo tablespace. */
+
+			rseg = trx_rseg_get_on_id(rseg_id);
 
-			block = buf_page_get(0, 0, page_no, RW_X_LATCH, &mtr);
+			block = buf_page_get(rseg->space, rseg->zip_size,
+					     page_no, RW_X_LATCH, &mtr);
 			buf_block_dbg_add_level(block, SYNC_TRX_UNDO_PAGE);
 
 			data_field = buf_block_get_frame(block)
@@ -728,9 +758,9 @@ err_exit:
 }
 
 /***********************************************************//**
-Fetches an undo log record and does the purge for the recorded operation.
-If none left, or the current purge completed, returns the control to the
-parent node, which is always a query thread node. */
+Takes the next undo log record assigned to the node in the current purge
+batch and does the purge for the recorded operation. If none left, returns
+the control to the parent node, which is always a query thread node. */
 static __attribute__((nonnull))
 void
 row_purge(
@@ -738,15 +768,14 @@ row_purge(
 	purge_node_t*	node,	/*!< in: row purge node */
 	que_thr_t*	thr)	/*!< in: query thread */
 {
-	ibool		updated_extern;
+	ibool			updated_extern;
+	const trx_purge_rec_t*	purge_rec;
 
 	ut_ad(node);
 	ut_ad(thr);
 
-	node->undo_rec = trx_purge_fetch_next_rec(&node->roll_ptr,
-						  &node->reservation,
-						  node->heap);
-	if (!node->undo_rec) {
+	if (node->undo_recs == NULL
+	    || node->next_rec >= ib_vector_size(node->undo_recs)) {
 		/* Purge completed for this query thread */
 
 		thr->run_node = que_node_get_parent(node);
@@ -754,6 +783,11 @@ row_purge(
 		return;
 	}
 
+	purge_rec = ib_vector_get(node->undo_recs, node->next_rec++);
+
+	node->undo_rec = purge_rec->undo_rec;
+	node->roll_ptr = purge_rec->roll_ptr;
+
 	if (node->undo_rec != &trx_purge_dummy_rec
 	    && row_purge_parse_undo_rec(node, &updated_extern, thr)) {
 		node->found_clust = FALSE;
@@ -778,7 +812,6 @@ row_purge(
 	}
 
 	/* Do some cleanup */
-	trx_purge_rec_release(node->reservation);
 	mem_heap_empty(node->heap);
 
 	thr->run_node = node;
@@ -1224,7 +1224,7 @@ row_sel_try_search_shortcut(
 	ut_ad(plan->unique_search);
 	ut_ad(!plan->must_get_clust);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
+	ut_ad(rw_lock_own(btr_search_get_latch(index), RW_LOCK_SHARED));
 #endif /* UNIV_SYNC_DEBUG */
 
 	row_sel_open_pcur(plan, TRUE, mtr);
@@ -1317,6 +1317,7 @@ row_sel(
 	rec_t*		old_vers;
 	rec_t*		clust_rec;
 	ibool		search_latch_locked;
+	rw_lock_t*	search_latch			= NULL;
 	ibool		consistent_read;
 
 	/* The following flag becomes TRUE when we are doing a
@@ -1394,11 +1395,23 @@ table_loop:
 	if (consistent_read && plan->unique_search && !plan->pcur_is_open
 	    && !plan->must_get_clust
 	    && !plan->table->big_rows) {
+		rw_lock_t*	latch = btr_search_get_latch(plan->index);
+
+		if (search_latch_locked && search_latch != latch) {
+			/* The latch of the adaptive hash index partition
+			of the previous table is held: release it */
+
+			rw_lock_s_unlock(search_latch);
+
+			search_latch_locked = FALSE;
+		}
+
 		if (!search_latch_locked) {
-			rw_lock_s_lock(&btr_search_latch);
+			rw_lock_s_lock(latch);
 
+			search_latch = latch;
 			search_latch_locked = TRUE;
-		} else if (rw_lock_get_writer(&btr_search_latch) == RW_LOCK_WAIT_EX) {
+		} else if (rw_lock_get_writer(latch) == RW_LOCK_WAIT_EX) {
 
 			/* There is an x-latch request waiting: release the
 			s-latch for a moment; as an s-latch here is often
@@ -1407,8 +1420,8 @@ table_loop:
 			from acquiring an s-latch for a long time, lowering
 			performance significantly in multiprocessors. */
 
-			rw_lock_s_unlock(&btr_search_latch);
-			rw_lock_s_lock(&btr_search_latch);
+			rw_lock_s_unlock(latch);
+			rw_lock_s_lock(latch);
 		}
 
 		found_flag = row_sel_try_search_shortcut(node, plan, &mtr);
@@ -1431,7 +1444,7 @@ table_loop:
 	}
 
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 
 		search_latch_locked = FALSE;
 	}
@@ -2007,7 +2020,7 @@ lock_wait_or_error:
 
 func_exit:
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 	}
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
@@ -2845,6 +2858,69 @@ row_sel_store_mysql_rec(
 	return(TRUE);
 }
 
+/*********************************************************************//**
+Checks a secondary index record against the index condition that was
+pushed down to prebuilt->idx_cond. The columns of the pushed index that
+the template requests are copied to mysql_rec, so that the condition can
+be evaluated on them before the clustered index record is fetched.
+@return	ICP_NO_MATCH, ICP_MATCH, or ICP_OUT_OF_RANGE */
+static
+ICP_RESULT
+row_search_idx_cond_check(
+/*======================*/
+	byte*			mysql_rec,	/*!< out: record in the MySQL
+						format; only the columns of
+						the pushed index are written */
+	row_prebuilt_t*		prebuilt,	/*!< in: prebuilt struct */
+	const rec_t*		rec,		/*!< in: record in
+						prebuilt->index */
+	const ulint*		offsets)	/*!< in: rec_get_offsets() */
+{
+	ulint	i;
+
+	ut_ad(prebuilt->idx_cond);
+	ut_ad(!dict_index_is_clust(prebuilt->index));
+	ut_ad(rec_offs_validate(rec, prebuilt->index, offsets));
+
+	for (i = 0; i < prebuilt->n_template; i++) {
+		const mysql_row_templ_t*templ = prebuilt->mysql_template + i;
+		const byte*		data;
+		ulint			len;
+
+		if (templ->icp_rec_field_no == ULINT_UNDEFINED) {
+			continue;
+		}
+
+		/* Secondary index records never contain externally
+		stored columns, and columns that are only indexed by a
+		prefix are never evaluated in a pushed index condition. */
+		ut_ad(!rec_offs_nth_extern(offsets, templ->icp_rec_field_no));
+
+		data = rec_get_nth_field(rec, offsets,
+					 templ->icp_rec_field_no, &len);
+
+		if (len != UNIV_SQL_NULL) {
+			row_sel_field_store_in_mysql_format(
+				mysql_rec + templ->mysql_col_offset,
+				templ, data, len);
+
+			if (templ->mysql_null_bit_mask) {
+				mysql_rec[templ->mysql_null_byte_offset]
+					&= ~(byte) templ->mysql_null_bit_mask;
+			}
+		} else {
+			mysql_rec[templ->mysql_null_byte_offset]
+				|= (byte) templ->mysql_null_bit_mask;
+			memcpy(mysql_rec + templ->mysql_col_offset,
+			       (const byte*) prebuilt->default_rec
+			       + templ->mysql_col_offset,
+			       templ->mysql_col_len);
+		}
+	}
+
+	return(innobase_index_cond(prebuilt->idx_cond));
+}
+
 /*********************************************************************//**
 Builds a previous version of a clustered index record for a consistent read
 @return	DB_SUCCESS or error code */
@@ -3255,28 +3331,44 @@ row_sel_push_cache_row_for_mysql(
 	byte*	buf;
 	ulint	i;
 
-	ut_ad(prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE);
 	ut_ad(rec_offs_validate(rec, NULL, offsets));
 	ut_ad(!rec_get_deleted_flag(rec, rec_offs_comp(offsets)));
 	ut_a(!prebuilt->templ_contains_blob);
 
-	if (prebuilt->fetch_cache[0] == NULL) {
-		/* Allocate memory for the fetch cache */
+	if (prebuilt->fetch_cache == NULL) {
+		/* Allocate the array of the fetch cache. Let a batch
+		fill about a page, but at least MYSQL_FETCH_CACHE_SIZE
+		rows. */
 
-		for (i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
+		prebuilt->fetch_cache_max = ut_min(
+			MYSQL_FETCH_CACHE_MAX_SIZE,
+			ut_max(MYSQL_FETCH_CACHE_SIZE,
+			       MYSQL_FETCH_CACHE_MAX_BYTES
+			       / prebuilt->mysql_row_len));
 
-			/* A user has reported memory corruption in these
-			buffers in Linux. Put magic numbers there to help
-			to track a possible bug. */
+		prebuilt->fetch_cache = mem_zalloc(
+			prebuilt->fetch_cache_max * sizeof(byte*));
+	}
 
-			buf = mem_alloc(prebuilt->mysql_row_len + 8);
+	ut_ad(prebuilt->fetch_cache_limit <= prebuilt->fetch_cache_max);
+	ut_ad(prebuilt->n_fetch_cached < prebuilt->fetch_cache_limit);
 
-			prebuilt->fetch_cache[i] = buf + 4;
+	i = prebuilt->n_fetch_cached;
 
-			mach_write_to_4(buf, ROW_PREBUILT_FETCH_MAGIC_N);
-			mach_write_to_4(buf + 4 + prebuilt->mysql_row_len,
-					ROW_PREBUILT_FETCH_MAGIC_N);
-		}
+	if (prebuilt->fetch_cache[i] == NULL) {
+		/* Allocate memory for the row */
+
+		/* A user has reported memory corruption in these
+		buffers in Linux. Put magic numbers there to help
+		to track a possible bug. */
+
+		buf = mem_alloc(prebuilt->mysql_row_len + 8);
+
+		prebuilt->fetch_cache[i] = buf + 4;
+
+		mach_write_to_4(buf, ROW_PREBUILT_FETCH_MAGIC_N);
+		mach_write_to_4(buf + 4 + prebuilt->mysql_row_len,
+				ROW_PREBUILT_FETCH_MAGIC_N);
 	}
 
 	ut_ad(prebuilt->fetch_cache_first == 0);
@@ -3420,6 +3512,9 @@ row_search_for_mysql(
 	/* if the returned record was locked and we did a semi-consistent
 	read (fetch the newest committed version), then this is set to
 	TRUE */
+	ibool		idx_cond_before_lock		= FALSE;
+	/* if a pushed index condition is evaluated before the secondary
+	index record is locked, then this is set to TRUE */
 #ifdef UNIV_SEARCH_DEBUG
 	ulint		cnt				= 0;
 #endif /* UNIV_SEARCH_DEBUG */
@@ -3516,20 +3611,29 @@ row_search_for_mysql(
 	/* PHASE 0: Release a possible s-latch we are holding on the
 	adaptive hash index latch if there is someone waiting behind */
 
-	if (UNIV_UNLIKELY(rw_lock_get_writer(&btr_search_latch) != RW_LOCK_NOT_LOCKED)
-	    && trx->has_search_latch) {
+	if (UNIV_UNLIKELY(trx->has_search_latch)
+	    && rw_lock_get_writer(trx->search_latch) != RW_LOCK_NOT_LOCKED) {
 
 		/* There is an x-latch request on the adaptive hash index:
 		release the s-latch to reduce starvation and wait for
 		BTR_SEA_TIMEOUT rounds before trying to keep it again over
 		calls from MySQL */
 
-		rw_lock_s_unlock(&btr_search_latch);
-		trx->has_search_latch = FALSE;
+		trx_search_latch_release_if_reserved(trx);
 
 		trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 	}
 
+	if (UNIV_UNLIKELY(trx->has_search_latch)
+	    && trx->search_latch != btr_search_get_latch(index)) {
+
+		/* We are holding the latch of the adaptive hash index
+		partition of another index. Release it, so that we never
+		wait for a partition latch while holding another one. */
+
+		trx_search_latch_release_if_reserved(trx);
+	}
+
 	/* Reset the new record lock info if srv_locks_unsafe_for_binlog
 	is set or session is using a READ COMMITED isolation level. Then
 	we are able to remove the record locks set here on an individual
@@ -3545,6 +3649,7 @@ row_search_for_mysql(
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+		prebuilt->fetch_cache_limit = MYSQL_FETCH_CACHE_SIZE;
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -3569,6 +3674,7 @@ row_search_for_mysql(
 			prebuilt->n_rows_fetched = 0;
 			prebuilt->n_fetch_cached = 0;
 			prebuilt->fetch_cache_first = 0;
+			prebuilt->fetch_cache_limit = MYSQL_FETCH_CACHE_SIZE;
 
 		} else if (UNIV_LIKELY(prebuilt->n_fetch_cached > 0)) {
 			row_sel_pop_cached_row_for_mysql(buf, prebuilt);
@@ -3591,6 +3697,12 @@ row_search_for_mysql(
 			goto func_exit;
 		}
 
+		if (prebuilt->fetch_cache_limit > MYSQL_FETCH_CACHE_SIZE) {
+			/* The cache has been emptied after a full batch:
+			restore the cursor to fetch a larger batch. */
+			DEBUG_SYNC_C("row_search_refill_fetch_cache");
+		}
+
 		prebuilt->n_rows_fetched++;
 
 		if (prebuilt->n_rows_fetched > 1000000000) {
@@ -3679,7 +3791,8 @@ row_search_for_mysql(
 
 #ifndef UNIV_SEARCH_DEBUG
 			if (!trx->has_search_latch) {
-				rw_lock_s_lock(&btr_search_latch);
+				trx->search_latch = btr_search_get_latch(index);
+				rw_lock_s_lock(trx->search_latch);
 				trx->has_search_latch = TRUE;
 			}
 #endif
@@ -3741,8 +3854,8 @@ release_search_latch_if_needed:
 
 					trx->search_latch_timeout--;
 
-					rw_lock_s_unlock(&btr_search_latch);
-					trx->has_search_latch = FALSE;
+					trx_search_latch_release_if_reserved(
+						trx);
 				}
 
 				/* NOTE that we do NOT store the cursor
@@ -3764,10 +3877,7 @@ release_search_latch_if_needed:
 	/*-------------------------------------------------------------*/
 	/* PHASE 3: Open or restore index cursor position */
 
-	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
-		trx->has_search_latch = FALSE;
-	}
+	trx_search_latch_release_if_reserved(trx);
 
 	ut_ad(prebuilt->sql_stat_start || trx->conc_state == TRX_ACTIVE);
 	ut_ad(trx->conc_state == TRX_NOT_STARTED
@@ -3788,6 +3898,18 @@ release_search_latch_if_needed:
 		set_also_gap_locks = FALSE;
 	}
 
+	if (prebuilt->idx_cond
+	    && prebuilt->select_lock_type != LOCK_NONE
+	    && (srv_locks_unsafe_for_binlog
+		|| trx->isolation_level <= TRX_ISO_READ_COMMITTED)) {
+		/* Without next-key locking, a record that does not match
+		the WHERE condition would be unlocked right after MySQL
+		has rejected it. We can as well reject it before locking
+		it, if the pushed index condition does not hold. */
+
+		idx_cond_before_lock = TRUE;
+	}
+
 	/* Note that if the search mode was GE or G, then the cursor
 	naturally moves upward (in fetch next) in alphabetical order,
 	otherwise downward */
@@ -4182,6 +4304,19 @@ wrong_offs:
 
 		ulint	lock_type;
 
+		if (idx_cond_before_lock) {
+			switch (row_search_idx_cond_check(buf, prebuilt,
+							  rec, offsets)) {
+			case ICP_NO_MATCH:
+				goto next_rec;
+			case ICP_OUT_OF_RANGE:
+				err = DB_RECORD_NOT_FOUND;
+				goto idx_cond_failed;
+			case ICP_MATCH:
+				break;
+			}
+		}
+
 		if (!set_also_gap_locks
 		    || srv_locks_unsafe_for_binlog
 		    || trx->isolation_level <= TRX_ISO_READ_COMMITTED
@@ -4255,9 +4390,9 @@ no_gap_lock:
 				goto lock_wait_or_error;
 			}
 
-			mutex_enter(&kernel_mutex);
+			lock_mutex_enter();
 			if (trx->was_chosen_as_deadlock_victim) {
-				mutex_exit(&kernel_mutex);
+				lock_mutex_exit();
 				err = DB_DEADLOCK;
 
 				goto lock_wait_or_error;
@@ -4266,7 +4401,7 @@ no_gap_lock:
 				lock_cancel_waiting_and_release(
 					trx->wait_lock);
 			} else {
-				mutex_exit(&kernel_mutex);
+				lock_mutex_exit();
 
 				/* The lock was granted while we were
 				searching for the last committed version.
@@ -4278,7 +4413,7 @@ no_gap_lock:
 				err = DB_SUCCESS;
 				break;
 			}
-			mutex_exit(&kernel_mutex);
+			lock_mutex_exit();
 
 			if (old_vers == NULL) {
 				/* The row was not yet committed */
@@ -4346,7 +4481,28 @@ no_gap_lock:
 
 			if (!lock_sec_rec_cons_read_sees(
 				    rec, trx->read_view)) {
-				goto requires_clust_rec;
+
+				if (!prebuilt->idx_cond) {
+					goto requires_clust_rec;
+				}
+
+				/* Every version of the row that the
+				read view may see has its own entry in
+				this index, with the index columns of
+				that version. Thus we can skip the
+				clustered index lookup if the pushed
+				index condition does not hold. */
+
+				switch (row_search_idx_cond_check(
+						buf, prebuilt, rec, offsets)) {
+				case ICP_NO_MATCH:
+					goto next_rec;
+				case ICP_OUT_OF_RANGE:
+					err = DB_RECORD_NOT_FOUND;
+					goto idx_cond_failed;
+				case ICP_MATCH:
+					goto requires_clust_rec;
+				}
 			}
 		}
 	}
@@ -4393,6 +4549,22 @@ no_gap_lock:
 		goto next_rec;
 	}
 
+	/* Evaluate the pushed index condition on the secondary index
+	record, before fetching the clustered index record. */
+
+	if (prebuilt->idx_cond && !idx_cond_before_lock) {
+		switch (row_search_idx_cond_check(buf, prebuilt,
+						  rec, offsets)) {
+		case ICP_NO_MATCH:
+			goto next_rec;
+		case ICP_OUT_OF_RANGE:
+			err = DB_RECORD_NOT_FOUND;
+			goto idx_cond_failed;
+		case ICP_MATCH:
+			break;
+		}
+	}
+
 	/* Get the clustered index record if needed, if we did not do the
 	search using the clustered index. */
 
@@ -4507,7 +4679,18 @@ requires_clust_rec:
 			level, not here. */
 			ut_a(trx->isolation_level == TRX_ISO_READ_UNCOMMITTED);
 		} else if (prebuilt->n_fetch_cached
-			   == MYSQL_FETCH_CACHE_SIZE) {
+			   == prebuilt->fetch_cache_limit) {
+
+			/* The scan is likely to continue on this cursor.
+			Fetch twice as many rows in the next batch, so that
+			the cursor is restored and the mini-transaction is
+			started and committed less often per row. */
+
+			prebuilt->fetch_cache_limit = ut_min(
+				2 * prebuilt->fetch_cache_limit,
+				prebuilt->fetch_cache_max);
+
+			srv_n_rows_prefetch_batches++;
 
 			goto got_row;
 		}
@@ -4567,6 +4750,9 @@ requires_clust_rec:
 	/* From this point on, 'offsets' are invalid. */
 
 got_row:
+	err = DB_SUCCESS;
+
+idx_cond_failed:
 	/* We have an optimization to save CPU time: if this is a consistent
 	read on a unique condition on the clustered index, then we do not
 	store the pcur position, because any fetch next or prev will anyway
@@ -4583,8 +4769,6 @@ got_row:
 		btr_pcur_store_position(pcur, &mtr);
 	}
 
-	err = DB_SUCCESS;
-
 	goto normal_return;
 
 next_rec:
@@ -4795,7 +4979,9 @@ row_search_check_if_query_cache_permitted(
 		return(FALSE);
 	}
 
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
+
+	trx_sys_mutex_enter();
 
 	/* Start the transaction if it is not started yet */
 
@@ -4818,12 +5004,15 @@ row_search_check_if_query_cache_permitted(
 		    && !trx->read_view) {
 
 			trx->read_view = read_view_open_now(
-				trx->id, trx->global_read_view_heap);
+				trx->id, trx->prebuilt_view);
+			trx->prebuilt_view = trx->read_view;
 			trx->global_read_view = trx->read_view;
 		}
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
+
+	lock_mutex_exit();
 
 	return(ret);
 }
@@ -42,6 +42,7 @@ Created 2/25/1997 Heikki Tuuri
 #include "trx0rec.h"
 #include "row0row.h"
 #include "row0upd.h"
+#include "row0log.h"
 #include "que0que.h"
 #include "ibuf0ibuf.h"
 #include "log0log.h"
@@ -347,6 +348,12 @@ row_undo_ins(
 			only occur during the rollback of incomplete
 			transactions. */
 			ut_a(trx_is_recv(node->trx));
+		} else if (dict_index_is_online_ddl(node->index)
+			   && row_log_online_op_try(node->index, entry,
+						    node->trx->id,
+						    ROW_OP_DELETE)) {
+			/* The index is being created online. The
+			removal was written to the log of the index. */
 		} else {
 			log_free_check();
 			err = row_undo_ins_remove_sec(node->index, entry);
@@ -41,6 +41,7 @@ Created 2/27/1997 Heikki Tuuri
 #include "trx0rec.h"
 #include "row0row.h"
 #include "row0upd.h"
+#include "row0log.h"
 #include "que0que.h"
 #include "log0log.h"
 
@@ -383,6 +384,14 @@ row_undo_mod_del_mark_or_remove_sec(
 {
 	ulint	err;
 
+	if (dict_index_is_online_ddl(index)
+	    && row_log_online_op_try(index, entry, thr_get_trx(thr)->id,
+				     ROW_OP_DELETE)) {
+		/* The index is being created online. The operation
+		was written to the log of the index. */
+		return(DB_SUCCESS);
+	}
+
 	err = row_undo_mod_del_mark_or_remove_sec_low(node, thr, index,
 						      entry, BTR_MODIFY_LEAF);
 	if (err == DB_SUCCESS) {
@@ -421,6 +430,14 @@ row_undo_mod_del_unmark_sec_and_undo_update(
 	trx_t*			trx		= thr_get_trx(thr);
 	enum row_search_result	search_result;
 
+	if (dict_index_is_online_ddl(index)
+	    && row_log_online_op_try(index, entry, trx->id,
+				     ROW_OP_INSERT)) {
+		/* The index is being created online. The operation
+		was written to the log of the index. */
+		return(DB_SUCCESS);
+	}
+
 	/* Ignore indexes that are being created. */
 	if (UNIV_UNLIKELY(*index->name == TEMP_INDEX_PREFIX)) {
 
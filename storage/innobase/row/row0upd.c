@@ -45,6 +45,7 @@ Created 12/27/1996 Heikki Tuuri
 #include "row0ins.h"
 #include "row0sel.h"
 #include "row0row.h"
+#include "row0log.h"
 #include "rem0cmp.h"
 #include "lock0lock.h"
 #include "log0log.h"
@@ -1574,6 +1575,13 @@ row_upd_sec_index_entry(
 	entry = row_build_index_entry(node->row, node->ext, index, heap);
 	ut_a(entry);
 
+	if (dict_index_is_online_ddl(index)
+	    && row_log_online_op_try(index, entry, trx->id, ROW_OP_DELETE)) {
+		/* The index is being created online. The delete-marking
+		of the old entry was written to the log of the index. */
+		goto insert_new;
+	}
+
 	mtr_start(&mtr);
 
 	/* Set the query thread, so that ibuf_insert_low() will be
@@ -1653,6 +1661,7 @@ row_upd_sec_index_entry(
 	btr_pcur_close(&pcur);
 	mtr_commit(&mtr);
 
+insert_new:
 	if (node->is_delete || err != DB_SUCCESS) {
 
 		goto func_exit;
@@ -46,9 +46,49 @@ Created 2/6/1997 Heikki Tuuri
 #include "read0read.h"
 #include "lock0lock.h"
 
+/*****************************************************************//**
+Checks if a transaction is active, acquiring the trx_sys mutex.
+@return	TRUE if active */
+static
+ibool
+row_vers_trx_is_active(
+/*===================*/
+	trx_id_t	trx_id)	/*!< in: trx id of the transaction */
+{
+	ibool	active;
+
+	trx_sys_mutex_enter();
+	active = trx_is_active(trx_id);
+	trx_sys_mutex_exit();
+
+	return(active);
+}
+
+/*****************************************************************//**
+Looks for the trx handle with the given id in trx_list, acquiring the
+trx_sys mutex. The caller must own the lock mutex, so that an active
+transaction cannot commit and be freed before it is used.
+@return	the trx handle or NULL if not found */
+static
+trx_t*
+row_vers_trx_get_on_id(
+/*===================*/
+	trx_id_t	trx_id)	/*!< in: trx id to search for */
+{
+	trx_t*	trx;
+
+	ut_ad(lock_mutex_own());
+
+	trx_sys_mutex_enter();
+	trx = trx_get_on_id(trx_id);
+	trx_sys_mutex_exit();
+
+	return(trx);
+}
+
 /*****************************************************************//**
 Finds out if an active transaction has inserted or modified a secondary
-index record. NOTE: the kernel mutex is temporarily released in this
+index record. NOTE: the lock mutex is temporarily released in this
 function!
 @return NULL if committed, else the active transaction */
 UNIV_INTERN
@@ -77,17 +117,17 @@ row_vers_impl_x_locked_off_kernel(
 	mtr_t		mtr;
 	ulint		comp;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(!rw_lock_own(&(purge_sys->latch), RW_LOCK_SHARED));
 #endif /* UNIV_SYNC_DEBUG */
 
-	mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
 
 	mtr_start(&mtr);
 
 	/* Search for the clustered index record: this is a time-consuming
-	operation: therefore we release the kernel mutex; also, the release
+	operation: therefore we release the lock mutex; also, the release
 	is required by the latching order convention. The latch on the
 	clustered index locks the top of the stack of versions. We also
 	reserve purge_latch to lock the bottom of the version stack. */
@@ -107,7 +147,7 @@ row_vers_impl_x_locked_off_kernel(
 		a rollback we always undo the modifications to secondary index
 		records before the clustered index record. */
 
-		mutex_enter(&kernel_mutex);
+		lock_mutex_enter();
 		mtr_commit(&mtr);
 
 		return(NULL);
@@ -120,17 +160,17 @@ row_vers_impl_x_locked_off_kernel(
 
 	mtr_s_lock(&(purge_sys->latch), &mtr);
 
-	mutex_enter(&kernel_mutex);
+	lock_mutex_enter();
 
 	trx = NULL;
-	if (!trx_is_active(trx_id)) {
+	if (!row_vers_trx_is_active(trx_id)) {
 		/* The transaction that modified or inserted clust_rec is no
 		longer active: no implicit lock on rec */
 		goto exit_func;
 	}
 
 	if (!lock_check_trx_id_sanity(trx_id, clust_rec, clust_index,
-				      clust_offsets, TRUE)) {
+				      clust_offsets)) {
 		/* Corruption noticed: try to avoid a crash by returning */
 		goto exit_func;
 	}
@@ -160,10 +200,10 @@ row_vers_impl_x_locked_off_kernel(
 		row_ext_t*	ext;
 		trx_id_t	prev_trx_id;
 
-		mutex_exit(&kernel_mutex);
+		lock_mutex_exit();
 
 		/* While we retrieve an earlier version of clust_rec, we
-		release the kernel mutex, because it may take time to access
+		release the lock mutex, because it may take time to access
 		the disk. After the release, we have to check if the trx_id
 		transaction is still active. We keep the semaphore in mtr on
 		the clust_rec page, so that no other transaction can update
@@ -180,9 +220,9 @@ row_vers_impl_x_locked_off_kernel(
 		mem_heap_free(heap2); /* free version and clust_offsets */
 
 		if (prev_version == NULL) {
-			mutex_enter(&kernel_mutex);
+			lock_mutex_enter();
 
-			if (!trx_is_active(trx_id)) {
+			if (!row_vers_trx_is_active(trx_id)) {
 				/* Transaction no longer active: no
 				implicit x-lock */
 
@@ -197,7 +237,7 @@ row_vers_impl_x_locked_off_kernel(
 			/* It was a freshly inserted version: there is an
 			implicit x-lock on rec */
 
-			trx = trx_get_on_id(trx_id);
+			trx = row_vers_trx_get_on_id(trx_id);
 
 			break;
 		}
@@ -221,9 +261,9 @@ row_vers_impl_x_locked_off_kernel(
 		prev_version should be NULL. */
 		ut_a(entry);
 
-		mutex_enter(&kernel_mutex);
+		lock_mutex_enter();
 
-		if (!trx_is_active(trx_id)) {
+		if (!row_vers_trx_is_active(trx_id)) {
 			/* Transaction no longer active: no implicit x-lock */
 
 			break;
@@ -247,7 +287,7 @@ row_vers_impl_x_locked_off_kernel(
 			prev_version */
 
 			if (rec_del != vers_del) {
-				trx = trx_get_on_id(trx_id);
+				trx = row_vers_trx_get_on_id(trx_id);
 
 				break;
 			}
@@ -261,7 +301,7 @@ row_vers_impl_x_locked_off_kernel(
 						dtuple_get_n_fields(entry));
 			if (0 != cmp_dtuple_rec(entry, rec, offsets)) {
 
-				trx = trx_get_on_id(trx_id);
+				trx = row_vers_trx_get_on_id(trx_id);
 
 				break;
 			}
@@ -269,7 +309,7 @@ row_vers_impl_x_locked_off_kernel(
 			/* The delete mark should be set in rec for it to be
 			in the state required by prev_version */
 
-			trx = trx_get_on_id(trx_id);
+			trx = row_vers_trx_get_on_id(trx_id);
 
 			break;
 		}
@@ -665,7 +705,7 @@ row_vers_build_for_semi_consistent_read(
 			rec_trx_id = version_trx_id;
 		}
 
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 		version_trx = trx_get_on_id(version_trx_id);
 		if (version_trx
 		    && (version_trx->conc_state == TRX_COMMITTED_IN_MEMORY
@@ -673,7 +713,7 @@ row_vers_build_for_semi_consistent_read(
 
 			version_trx = NULL;
 		}
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		if (!version_trx) {
 
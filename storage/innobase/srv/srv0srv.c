@@ -104,6 +104,11 @@ UNIV_INTERN ulint	srv_dml_needed_delay = 0;
 UNIV_INTERN ibool	srv_lock_timeout_active = FALSE;
 UNIV_INTERN ibool	srv_monitor_active = FALSE;
 UNIV_INTERN ibool	srv_error_monitor_active = FALSE;
+UNIV_INTERN ibool	srv_buf_dump_thread_active = FALSE;
+UNIV_INTERN ibool	srv_buf_resize_thread_active = FALSE;
+UNIV_INTERN ibool	srv_page_cleaner_active = FALSE;
+UNIV_INTERN ibool	srv_dict_stats_thread_active = FALSE;
+UNIV_INTERN ibool	srv_fsp_preextend_thread_active = FALSE;
 
 UNIV_INTERN const char*	srv_main_thread_op_info = "";
 
@@ -171,6 +176,16 @@ UNIV_INTERN ulint	srv_last_file_size_max	= 0;
 /* If the last data file is auto-extended, we add this
 many pages to it at a time */
 UNIV_INTERN ulong	srv_auto_extend_increment = 8;
+/* Percentage of their size by which single-table tablespaces of at
+least 32 extents are extended; if 0, they are extended by FSP_FREE_ADD
+extents */
+UNIV_INTERN ulong	srv_file_extend_percent = 0;
+/* If TRUE, single-table tablespaces that are about to fill up are
+extended in the background by fsp_preextend_thread() */
+UNIV_INTERN my_bool	srv_file_preextend = FALSE;
+/* If TRUE, data files are extended with posix_fallocate() where the
+file system supports it */
+UNIV_INTERN my_bool	srv_use_fallocate = TRUE;
 UNIV_INTERN ulint*	srv_data_file_is_raw_partition = NULL;
 
 /* Minimum percentage of pages in a segment to be used before a new
@@ -236,6 +251,8 @@ UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 UNIV_INTERN my_bool	srv_buf_pool_populate	= FALSE;
 /* requested number of buffer pool instances */
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
+/* size of a buffer pool chunk in bytes */
+UNIV_INTERN ulong	srv_buf_pool_chunk_unit;
 /** whether or not to flush neighbors of a block */
 UNIV_INTERN my_bool	srv_flush_neighbors	= TRUE;
 /* previously requested size */
@@ -296,15 +313,56 @@ that during a time of heavy update/insert activity. */
 
 UNIV_INTERN ulong	srv_max_buf_pool_modified_pct	= 75;
 
-/* the number of purge threads to use from the worker pool (currently 0 or 1).*/
+/* the number of purge threads: 0 means that the master thread does the
+purge, otherwise a purge coordinator thread is started together with
+srv_n_purge_threads - 1 purge worker threads */
 UNIV_INTERN ulong srv_n_purge_threads = 0;
 
+/* the number of threads that apply redo log records to pages during
+crash recovery, including the thread that runs the recovery */
+UNIV_INTERN ulong srv_n_recovery_threads = 4;
+
+/* the number of page cleaner threads: 0 means that the master thread
+flushes the buffer pool, otherwise a page cleaner coordinator thread is
+started together with srv_n_page_cleaners - 1 page cleaner workers */
+UNIV_INTERN ulong srv_n_page_cleaners = 1;
+
+/** Maximum size of the modification log of an index that is being
+created online, in bytes */
+UNIV_INTERN ulong srv_online_alter_log_max_size = 128 * 1024 * 1024;
+
+/** Size of the sort buffers and of the temporary file blocks that are
+used when creating indexes, in bytes */
+UNIV_INTERN ulong srv_sort_buf_size = 1048576;
+
+/** Number of threads that scan the clustered index and merge sort
+the index entries when creating indexes */
+UNIV_INTERN ulong srv_n_sort_threads = 4;
+
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong srv_purge_batch_size = 20;
 
 /* the number of rollback segments to use */
 UNIV_INTERN ulong srv_rollback_segments = TRX_SYS_N_RSEGS;
 
+/** Directory where the undo tablespaces are placed */
+UNIV_INTERN char*	srv_undo_dir = NULL;
+
+/** Number of undo tablespaces to create with a new database */
+UNIV_INTERN ulong	srv_undo_tablespaces = 0;
+
+/** Number of undo tablespaces that were opened at startup; their space
+ids are 1 .. srv_undo_tablespaces_open */
+UNIV_INTERN ulint	srv_undo_tablespaces_open = 0;
+
+/** Whether purge truncates the undo tablespaces that are larger than
+srv_max_undo_log_size */
+UNIV_INTERN my_bool	srv_undo_log_truncate = FALSE;
+
+/** Size of an undo tablespace, in bytes, above which it is truncated */
+UNIV_INTERN unsigned long long	srv_max_undo_log_size
+	= 1024 * 1024 * 1024;
+
 /* variable counts amount of data read in total (in bytes) */
 UNIV_INTERN ulint srv_data_read = 0;
 
@@ -383,6 +441,42 @@ UNIV_INTERN ulint srv_buf_pool_flush_neighbor_pages;
 /** Number of pages scanned as part of LRU batches. */
 UNIV_INTERN ulint srv_buf_pool_flush_LRU_batch_scanned;
 
+/** Number of iterations of the page cleaner coordinator. */
+UNIV_INTERN ulint srv_page_cleaner_iterations;
+
+/** Number of times the page cleaner coordinator slept between
+iterations. */
+UNIV_INTERN ulint srv_page_cleaner_sleeps;
+
+/** Time spent in page cleaner iterations, in milliseconds. */
+UNIV_INTERN ulint srv_page_cleaner_time;
+
+/** Number of pages flushed from the LRU tails by the page cleaner. */
+UNIV_INTERN ulint srv_page_cleaner_lru_pages;
+
+/** Time spent by the page cleaner threads in LRU tail flushes, in
+milliseconds. */
+UNIV_INTERN ulint srv_page_cleaner_lru_time;
+
+/** Number of pages flushed from the flush lists by the page cleaner. */
+UNIV_INTERN ulint srv_page_cleaner_flush_list_pages;
+
+/** Time spent by the page cleaner threads in flush list flushes, in
+milliseconds. */
+UNIV_INTERN ulint srv_page_cleaner_flush_list_time;
+
+/** Number of index entry modifications written to the logs of
+indexes that were being created online. */
+UNIV_INTERN ulint srv_online_alter_log_rows;
+
+/** Current size of the logs of the indexes that are being created
+online, in bytes. */
+UNIV_INTERN ulint srv_online_alter_log_bytes;
+
+/** Percentage of the clustered index that the latest index creation
+has read, or 100 when it has finished building the indexes. */
+UNIV_INTERN ulint srv_online_alter_progress;
+
 /** Number of pages flushed as part of LRU batches. */
 UNIV_INTERN ulint srv_buf_pool_flush_LRU_page_count;
 
@@ -436,6 +530,14 @@ UNIV_INTERN ulint	srv_conc_n_waiting_threads = 0;
 /* print all user-level transactions deadlocks to mysqld stderr */
 UNIV_INTERN my_bool	srv_print_all_deadlocks = FALSE;
 
+/* check for deadlocks when a lock wait begins; if FALSE, deadlocks are
+resolved by innodb_lock_wait_timeout */
+UNIV_INTERN my_bool	srv_deadlock_detect = TRUE;
+
+/* collect compression statistics per index for
+INFORMATION_SCHEMA.INNODB_CMP_PER_INDEX */
+UNIV_INTERN my_bool	srv_cmp_per_index_enabled = FALSE;
+
 typedef struct srv_conc_slot_struct	srv_conc_slot_t;
 struct srv_conc_slot_struct{
 	os_event_t			event;		/*!< event to wait */
@@ -474,8 +576,20 @@ UNIV_INTERN ibool	srv_innodb_status	= FALSE;
 this many index pages */
 UNIV_INTERN unsigned long long	srv_stats_sample_pages = 8;
 
+/* Store the statistics in SYS_TABLE_STATS and SYS_INDEX_STATS, sample
+this many index pages when calculating them, and recalculate them in
+the background when enough of a table has changed */
+UNIV_INTERN my_bool		srv_stats_persistent = FALSE;
+UNIV_INTERN unsigned long long	srv_stats_persistent_sample_pages = 20;
+UNIV_INTERN my_bool		srv_stats_auto_recalc = TRUE;
+
 UNIV_INTERN ibool	srv_use_doublewrite_buf	= TRUE;
-UNIV_INTERN ibool	srv_use_checksums = TRUE;
+/** Doublewrite file, or NULL to keep the doublewrite buffer in the
+system tablespace; set by innodb_doublewrite_file */
+UNIV_INTERN char*	srv_doublewrite_file	= NULL;
+/** the page and log block checksum algorithm, one of
+srv_checksum_algorithm_t; set by innodb_checksum_algorithm */
+UNIV_INTERN ulong	srv_checksum_algorithm = SRV_CHECKSUM_ALGORITHM_INNODB;
 
 UNIV_INTERN ulong	srv_replication_delay		= 0;
 
@@ -484,6 +598,9 @@ UNIV_INTERN ulong	srv_n_spin_wait_rounds	= 30;
 UNIV_INTERN ulong	srv_n_free_tickets_to_enter = 500;
 UNIV_INTERN ulong	srv_thread_sleep_delay = 10000;
 UNIV_INTERN ulong	srv_spin_wait_delay	= 6;
+/** Number of sync wait arrays that threads waiting for a mutex or an
+rw-lock are spread over (innodb_sync_array_size) */
+UNIV_INTERN ulong	srv_sync_array_size	= 1;
 UNIV_INTERN ibool	srv_priority_boost	= TRUE;
 
 #ifdef UNIV_DEBUG
@@ -498,6 +615,9 @@ UNIV_INTERN ulint		srv_n_rows_inserted		= 0;
 UNIV_INTERN ulint		srv_n_rows_updated		= 0;
 UNIV_INTERN ulint		srv_n_rows_deleted		= 0;
 UNIV_INTERN ulint		srv_n_rows_read			= 0;
+/* Number of full batches of rows fetched into the prefetch cache of a
+scan, see row_search_for_mysql() */
+UNIV_INTERN ulint		srv_n_rows_prefetch_batches	= 0;
 
 static ulint	srv_n_rows_inserted_old		= 0;
 static ulint	srv_n_rows_updated_old		= 0;
@@ -509,12 +629,22 @@ UNIV_INTERN ulint		srv_n_lock_wait_current_count	= 0;
 UNIV_INTERN ib_int64_t	srv_n_lock_wait_time		= 0;
 UNIV_INTERN ulint		srv_n_lock_max_wait_time	= 0;
 UNIV_INTERN ulint		srv_n_lock_deadlock_count	= 0;
+UNIV_INTERN ulint		srv_n_lock_deadlock_checks	= 0;
+UNIV_INTERN ullint		srv_lock_deadlock_check_time	= 0;
 
 UNIV_INTERN ulint		srv_truncated_status_writes	= 0;
 
 UNIV_INTERN ulint	srv_n_corrupted_page_reads	= 0;
 UNIV_INTERN ulint	srv_n_corrupted_table_opens	= 0;
 
+/* Size in bytes above which the master thread evicts unused tables from
+the data dictionary cache; 0 if tables are never evicted */
+UNIV_INTERN ulong	srv_dict_size_limit		= 0;
+
+UNIV_INTERN ulint	srv_n_dict_cache_hits		= 0;
+UNIV_INTERN ulint	srv_n_dict_cache_misses		= 0;
+UNIV_INTERN ulint	srv_n_dict_cache_evictions	= 0;
+
 /*
   Set the following to 0 if you want InnoDB to write messages on
   stderr on startup/shutdown
@@ -770,7 +900,8 @@ Unix.*/
 
 /* Thread slot in the thread table */
 struct srv_slot_struct{
-	unsigned	type:1;		/*!< thread type: user, utility etc. */
+	unsigned	type:2;		/*!< thread type: enum
+					srv_thread_type, up to SRV_MASTER */
 	unsigned	in_use:1;	/*!< TRUE if this slot is in use */
 	unsigned	suspended:1;	/*!< TRUE if the thread is waiting
 					for the event of this slot */
@@ -782,7 +913,8 @@ struct srv_slot_struct{
 					used for MySQL threads) */
 };
 
-/* Table for MySQL threads where they will be suspended to wait for locks */
+/* Table for MySQL threads where they will be suspended to wait for locks,
+protected by lock_sys->wait_mutex */
 UNIV_INTERN srv_slot_t*	srv_mysql_table = NULL;
 
 UNIV_INTERN os_event_t	srv_timeout_event;
@@ -791,6 +923,18 @@ UNIV_INTERN os_event_t	srv_monitor_event;
 
 UNIV_INTERN os_event_t	srv_error_event;
 
+UNIV_INTERN os_event_t	srv_buf_dump_event;
+
+UNIV_INTERN os_event_t	srv_buf_resize_event;
+
+/** The buffer pool dump/load file name */
+UNIV_INTERN char*	srv_buf_dump_filename;
+
+/** Boolean config knobs that tell InnoDB to dump the buffer pool at shutdown
+and/or load it during startup. */
+UNIV_INTERN my_bool	srv_buffer_pool_dump_at_shutdown = FALSE;
+UNIV_INTERN my_bool	srv_buffer_pool_load_at_startup = FALSE;
+
 UNIV_INTERN os_event_t	srv_lock_timeout_thread_event;
 
 UNIV_INTERN srv_sys_t*	srv_sys	= NULL;
@@ -798,7 +942,8 @@ UNIV_INTERN srv_sys_t*	srv_sys	= NULL;
 /* padding to prevent other memory update hotspots from residing on
 the same memory cache line */
 UNIV_INTERN byte	srv_pad1[64];
-/* mutex protecting the server, trx structs, query threads, and lock table */
+/* mutex protecting the server thread table and the task queue; the lock
+table, the trx system and the trx structs have mutexes of their own */
 UNIV_INTERN mutex_t*	kernel_mutex_temp;
 /* padding to prevent other memory update hotspots from residing on
 the same memory cache line */
@@ -918,6 +1063,7 @@ srv_thread_type_validate(
 {
 	switch (type) {
 	case SRV_WORKER:
+	case SRV_PURGE:
 	case SRV_MASTER:
 		return(TRUE);
 	}
@@ -1129,6 +1275,10 @@ srv_init(void)
 
 	srv_monitor_event = os_event_create(NULL);
 
+	srv_buf_dump_event = os_event_create(NULL);
+
+	srv_buf_resize_event = os_event_create(NULL);
+
 	srv_lock_timeout_thread_event = os_event_create(NULL);
 
 	for (i = 0; i < SRV_MASTER + 1; i++) {
@@ -1212,6 +1362,10 @@ srv_general_init(void)
 /* Maximum allowable purge history length.  <=0 means 'infinite'. */
 UNIV_INTERN ulong	srv_max_purge_lag		= 0;
 
+/* Maximum DML delay in microseconds caused by srv_max_purge_lag.
+0 means no maximum. */
+UNIV_INTERN ulong	srv_max_purge_lag_delay		= 0;
+
 /*********************************************************************//**
 Puts an OS thread to wait if there are too many concurrent threads
 (>= srv_thread_concurrency) inside InnoDB. The threads wait in a FIFO queue. */
@@ -1588,7 +1742,7 @@ srv_boot(void)
 
 /*********************************************************************//**
 Reserves a slot in the thread table for the current MySQL OS thread.
-NOTE! The kernel mutex has to be reserved by the caller!
+NOTE! The lock wait mutex has to be reserved by the caller!
 @return	reserved slot */
 static
 srv_slot_t*
@@ -1598,7 +1752,7 @@ srv_table_reserve_slot_for_mysql(void)
 	srv_slot_t*	slot;
 	ulint		i;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_wait_mutex_own());
 
 	i = 0;
 	slot = srv_mysql_table + i;
@@ -1674,17 +1828,20 @@ srv_suspend_mysql_thread(
 	ulint		ms;
 	ulong		lock_wait_timeout;
 
-	ut_ad(!mutex_own(&kernel_mutex));
-
 	trx = thr_get_trx(thr);
 
+	ut_ad(!lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
+
 	if (trx->mysql_thd != 0) {
 		DEBUG_SYNC_C("srv_suspend_mysql_thread_enter");
 	}
 
 	os_event_set(srv_lock_timeout_thread_event);
 
-	mutex_enter(&kernel_mutex);
+	lock_wait_mutex_enter();
+
+	trx_mutex_enter(trx);
 
 	trx->error_state = DB_SUCCESS;
 
@@ -1701,7 +1858,9 @@ srv_suspend_mysql_thread(
 			trx->was_chosen_as_deadlock_victim = FALSE;
 		}
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
+
+		lock_wait_mutex_exit();
 
 		return;
 	}
@@ -1714,6 +1873,11 @@ srv_suspend_mysql_thread(
 
 	slot->thr = thr;
 
+	/* srv_release_mysql_thread_if_suspended() finds the slot through
+	the query thread, under the trx mutex */
+
+	thr->slot = slot;
+
 	os_event_reset(event);
 
 	slot->suspend_time = ut_time();
@@ -1732,7 +1896,9 @@ srv_suspend_mysql_thread(
 
 	os_event_set(srv_lock_timeout_thread_event);
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
+
+	lock_wait_mutex_exit();
 
 	had_dict_lock = trx->dict_operation_lock_mode;
 
@@ -1804,10 +1970,14 @@ srv_suspend_mysql_thread(
 		break;
 	}
 
-	mutex_enter(&kernel_mutex);
+	lock_wait_mutex_enter();
+
+	trx_mutex_enter(trx);
 
 	/* Release the slot for others to use */
 
+	thr->slot = NULL;
+
 	slot->in_use = FALSE;
 
 	wait_time = ut_difftime(ut_time(), slot->suspend_time);
@@ -1840,7 +2010,9 @@ srv_suspend_mysql_thread(
 		trx->was_chosen_as_deadlock_victim = FALSE;
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
+
+	lock_wait_mutex_exit();
 
 	/* InnoDB system transactions (such as the purge, and
 	incomplete transactions that are being rolled back after crash
@@ -1870,25 +2042,17 @@ srv_release_mysql_thread_if_suspended(
 	que_thr_t*	thr)	/*!< in: query thread associated with the
 				MySQL OS thread	 */
 {
-	srv_slot_t*	slot;
-	ulint		i;
-
-	ut_ad(mutex_own(&kernel_mutex));
-
-	for (i = 0; i < OS_THREAD_MAX_N; i++) {
+	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 
-		slot = srv_mysql_table + i;
-
-		if (slot->in_use && slot->thr == thr) {
-			/* Found */
+	/* The suspending thread sets thr->slot under the trx mutex,
+	so there is no need to scan the thread table */
 
-			os_event_set(slot->event);
+	if (thr->slot != NULL) {
+		ut_ad(thr->slot->in_use);
+		ut_ad(thr->slot->thr == thr);
 
-			return;
-		}
+		os_event_set(thr->slot->event);
 	}
-
-	/* not found */
 }
 
 /******************************************************************//**
@@ -1928,7 +2092,7 @@ ibool
 srv_printf_innodb_monitor(
 /*======================*/
 	FILE*	file,		/*!< in: output stream */
-	ibool	nowait,		/*!< in: whether to wait for kernel mutex */
+	ibool	nowait,		/*!< in: whether to wait for lock mutex */
 	ulint*	trx_start,	/*!< out: file position of the start of
 				the list of active transactions */
 	ulint*	trx_end)	/*!< out: file position of the end of
@@ -2022,7 +2186,7 @@ srv_printf_innodb_monitor(
 	      "-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	btr_search_print_info(file);
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -2048,6 +2212,10 @@ srv_printf_innodb_monitor(
 		mem_pool_get_reserved(mem_comm_pool));
 	fprintf(file, "Dictionary memory allocated " ULINTPF "\n",
 		dict_sys->size);
+	fprintf(file, "Dictionary cache hits " ULINTPF ", misses " ULINTPF
+		", evictions " ULINTPF "\n",
+		srv_n_dict_cache_hits, srv_n_dict_cache_misses,
+		srv_n_dict_cache_evictions);
 
 	buf_print_io(file);
 
@@ -2212,13 +2380,18 @@ srv_export_innodb_status(void)
 		export_vars.innodb_row_lock_time_avg = 0;
 	}
 	export_vars.innodb_lock_deadlocks = srv_n_lock_deadlock_count;
+	export_vars.innodb_lock_deadlock_checks = srv_n_lock_deadlock_checks;
+	export_vars.innodb_lock_deadlock_check_time
+		= (ulint) (srv_lock_deadlock_check_time / 1000);
 	export_vars.innodb_row_lock_time_max
 		= srv_n_lock_max_wait_time / 1000;
 	export_vars.innodb_rows_read = srv_n_rows_read;
+	export_vars.innodb_rows_prefetch_batches = srv_n_rows_prefetch_batches;
 	export_vars.innodb_rows_inserted = srv_n_rows_inserted;
 	export_vars.innodb_rows_updated = srv_n_rows_updated;
 	export_vars.innodb_rows_deleted = srv_n_rows_deleted;
 	export_vars.innodb_truncated_status_writes = srv_truncated_status_writes;
+	export_vars.innodb_file_preextends = fsp_n_preextends;
 	export_vars.innodb_files_open = os_file_acct.n_open_files;
 	export_vars.innodb_files_opened = os_file_acct.n_open;
 	export_vars.innodb_files_closed = os_file_acct.n_close;
@@ -2228,8 +2401,9 @@ srv_export_innodb_status(void)
 	export_vars.innodb_tablespace_files_open
 		= export_vars.innodb_tablespace_files_opened
 		- export_vars.innodb_tablespace_files_closed;
-	export_vars.innodb_lsn_current = log_sys->lsn;
-	export_vars.innodb_lsn_flushed = log_sys->flushed_to_disk_lsn;
+	export_vars.innodb_lsn_current = log_get_lsn();
+	export_vars.innodb_lsn_flushed = log_lsn_read(
+		&log_sys->flushed_to_disk_lsn);
 	export_vars.innodb_lsn_checkpoint = log_sys->last_checkpoint_lsn;
 
 	export_vars.innodb_buffer_pool_flush_batch_scanned
@@ -2259,15 +2433,39 @@ srv_export_innodb_status(void)
 	export_vars.innodb_buffer_pool_LRU_get_free_search
 		= srv_buf_pool_LRU_get_free_search;
 
+	export_vars.innodb_page_cleaner_iterations
+		= srv_page_cleaner_iterations;
+	export_vars.innodb_page_cleaner_sleeps = srv_page_cleaner_sleeps;
+	export_vars.innodb_page_cleaner_time = srv_page_cleaner_time;
+	export_vars.innodb_page_cleaner_lru_pages = srv_page_cleaner_lru_pages;
+	export_vars.innodb_page_cleaner_lru_time = srv_page_cleaner_lru_time;
+	export_vars.innodb_page_cleaner_flush_list_pages
+		= srv_page_cleaner_flush_list_pages;
+	export_vars.innodb_page_cleaner_flush_list_time
+		= srv_page_cleaner_flush_list_time;
+
+	export_vars.innodb_online_alter_log_rows = srv_online_alter_log_rows;
+	export_vars.innodb_online_alter_log_bytes = srv_online_alter_log_bytes;
+	export_vars.innodb_online_alter_progress = srv_online_alter_progress;
+
 	export_vars.innodb_mysql_master_log_pos
 		= mysql_master_log_pos;
 	memcpy(export_vars.innodb_mysql_master_log_name,
 	       mysql_master_log_name, sizeof(mysql_master_log_name));
 	export_vars.innodb_mysql_master_log_name[TRX_SYS_MYSQL_LOG_NAME_LEN] = 0;
 
+	buf_dump_status_get(export_vars.innodb_buffer_pool_dump_status,
+			    export_vars.innodb_buffer_pool_load_status);
+	buf_resize_status_get(export_vars.innodb_buffer_pool_resize_status);
+
 	export_vars.innodb_corrupted_page_reads = srv_n_corrupted_page_reads;
 	export_vars.innodb_corrupted_table_opens = srv_n_corrupted_table_opens;
 
+	export_vars.innodb_dict_cache_hits = srv_n_dict_cache_hits;
+	export_vars.innodb_dict_cache_misses = srv_n_dict_cache_misses;
+	export_vars.innodb_dict_cache_evictions = srv_n_dict_cache_evictions;
+	export_vars.innodb_dict_cache_size = dict_sys ? dict_sys->size : 0;
+
 	export_vars.innodb_btree_page_reorganize = btr_n_page_reorganize;
 	export_vars.innodb_btree_page_split = btr_n_page_split;
 	export_vars.innodb_btree_page_merge = btr_n_page_merge;
@@ -2277,6 +2475,7 @@ srv_export_innodb_status(void)
 	export_vars.innodb_trx_max_id = trx_sys->max_trx_id;
 	export_vars.innodb_purge_trx_no = purge_sys->purge_trx_no;
 	export_vars.innodb_purge_undo_no = purge_sys->purge_undo_no;
+	export_vars.innodb_purge_worker_records = purge_sys->n_worker_recs;
 
 	export_vars.innodb_ibuf_discarded_delete_marks =
 		ibuf_stat.n_discarded_ops[IBUF_OP_DELETE_MARK];
@@ -2390,7 +2589,7 @@ loop:
 		if (srv_print_innodb_monitor) {
 			/* Reset mutex_skipped counter everytime
 			srv_print_innodb_monitor changes. This is to
-			ensure we will not be blocked by kernel_mutex
+			ensure we will not be blocked by lock_sys->mutex
 			for short duration information printing,
 			such as requested by sync_array_print_long_waits() */
 			if (!last_srv_print_monitor) {
@@ -2532,7 +2731,7 @@ loop:
 
 	srv_lock_timeout_active = TRUE;
 
-	mutex_enter(&kernel_mutex);
+	lock_wait_mutex_enter();
 
 	some_waits = FALSE;
 
@@ -2567,17 +2766,21 @@ loop:
 				possible that the lock has already been
 				granted: in that case do nothing */
 
+				lock_mutex_enter();
+
 				if (trx->wait_lock) {
 					lock_cancel_waiting_and_release(
 						trx->wait_lock);
 				}
+
+				lock_mutex_exit();
 			}
 		}
 	}
 
 	os_event_reset(srv_lock_timeout_thread_event);
 
-	mutex_exit(&kernel_mutex);
+	lock_wait_mutex_exit();
 
 	if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP) {
 		goto exit_func;
@@ -2847,11 +3050,11 @@ srv_wake_purge_thread_if_not_active(void)
 	ut_ad(!mutex_own(&kernel_mutex));
 
 	if (srv_n_purge_threads > 0
-	    && srv_n_threads_active[SRV_WORKER] == 0) {
+	    && srv_n_threads_active[SRV_PURGE] == 0) {
 
 		mutex_enter(&kernel_mutex);
 
-		srv_release_threads(SRV_WORKER, 1);
+		srv_release_threads(SRV_PURGE, 1);
 
 		mutex_exit(&kernel_mutex);
 	}
@@ -2886,7 +3089,27 @@ srv_wake_purge_thread(void)
 
 		mutex_enter(&kernel_mutex);
 
-		srv_release_threads(SRV_WORKER, 1);
+		srv_release_threads(SRV_PURGE, 1);
+
+		mutex_exit(&kernel_mutex);
+	}
+}
+
+/*******************************************************************//**
+Wakes up all suspended purge worker threads, so that they can check
+for shutdown. */
+UNIV_INTERN
+void
+srv_wake_worker_threads(void)
+/*=========================*/
+{
+	ut_ad(!mutex_own(&kernel_mutex));
+
+	if (srv_n_purge_threads > 1) {
+
+		mutex_enter(&kernel_mutex);
+
+		srv_release_threads(SRV_WORKER, srv_n_purge_threads - 1);
 
 		mutex_exit(&kernel_mutex);
 	}
@@ -2940,6 +3163,32 @@ srv_master_do_purge(void)
 	} while (n_pages_purged > 0);
 }
 
+/*********************************************************************//**
+Evicts unused tables from the dictionary cache if it has grown beyond
+innodb_dict_size_limit. */
+static
+void
+srv_master_evict_from_table_cache(
+/*==============================*/
+	ulint	pct_check)	/*!< in: how much of the LRU list of
+				tables to scan, in percent */
+{
+	if (srv_dict_size_limit == 0
+	    || dict_sys->size <= srv_dict_size_limit) {
+		return;
+	}
+
+	srv_main_thread_op_info = "evicting tables from the dictionary cache";
+
+	rw_lock_x_lock(&dict_operation_lock);
+	mutex_enter(&dict_sys->mutex);
+
+	dict_make_room_in_cache(srv_dict_size_limit, pct_check);
+
+	mutex_exit(&dict_sys->mutex);
+	rw_lock_x_unlock(&dict_operation_lock);
+}
+
 /*********************************************************************//**
 The master thread controlling the server.
 @return	a dummy parameter */
@@ -2979,6 +3228,11 @@ srv_master_thread(
 	pfs_register_thread(srv_master_thread_key);
 #endif
 
+	/* The mysys thread context lets DBUG_EXECUTE_IF() fire in the
+	pages that this thread flushes and in the undo tablespace
+	truncation that it runs when there is no purge thread. */
+	my_thread_init();
+
 	srv_main_thread_process_no = os_proc_get_number();
 	srv_main_thread_id = os_thread_pf(os_thread_get_curr_id());
 
@@ -3106,8 +3360,13 @@ loop:
 			srv_sync_log_buffer_in_background();
 		}
 
-		if (UNIV_UNLIKELY(buf_get_modified_ratio_pct()
-				  > srv_max_buf_pool_modified_pct)) {
+		if (srv_n_page_cleaners > 0) {
+
+			/* The page cleaner threads flush the buffer
+			pool */
+
+		} else if (UNIV_UNLIKELY(buf_get_modified_ratio_pct()
+					 > srv_max_buf_pool_modified_pct)) {
 
 			/* Try to keep the number of modified pages in the
 			buffer pool under the limit wished by the user */
@@ -3195,7 +3454,8 @@ loop:
 	if (n_pend_ios < SRV_PEND_IO_THRESHOLD
 	    && (n_ios - n_ios_very_old < SRV_PAST_IO_ACTIVITY)
 	    && flush_lsn_limit
-	    && srv_anticipatory_flushing) {
+	    && srv_anticipatory_flushing
+	    && srv_n_page_cleaners == 0) {
 
 		ulint n_flushed;
 
@@ -3236,7 +3496,11 @@ loop:
 
 	/* Flush a few oldest pages to make a new checkpoint younger */
 
-	if (buf_get_modified_ratio_pct() > 70) {
+	if (srv_n_page_cleaners > 0) {
+
+		/* The page cleaner threads flush the buffer pool */
+
+	} else if (buf_get_modified_ratio_pct() > 70) {
 
 		/* If there are lots of modified pages in the buffer pool
 		(> 70 %), we assume we can afford reserving the disk(s) for
@@ -3257,6 +3521,10 @@ loop:
 		srv_buf_pool_flush_anticipatory_pages += n_pages_flushed;
 	}
 
+	/* Scan a part of the LRU list of tables about once in 10
+	seconds, so that a big cache does not stall the master thread */
+	srv_master_evict_from_table_cache(10);
+
 	srv_main_thread_op_info = "making checkpoint";
 
 	/* Make a new checkpoint about once in 10 seconds */
@@ -3303,6 +3571,11 @@ background_loop:
 		}
 	}
 
+	/* The server is quiet: scan the whole LRU list of tables */
+	if (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		srv_master_evict_from_table_cache(100);
+	}
+
 	if (srv_n_purge_threads == 0) {
 		srv_main_thread_op_info = "master purging";
 
@@ -3465,6 +3738,7 @@ suspend_thread:
 	os_event_wait(slot->event);
 
 	if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+		my_thread_end();
 		os_thread_exit(NULL);
 	}
 
@@ -3488,12 +3762,16 @@ srv_purge_thread(
 	ulint		retries = 0;
 	ulint		n_total_purged = ULINT_UNDEFINED;
 
-	ut_a(srv_n_purge_threads == 1);
+	ut_a(srv_n_purge_threads >= 1);
 
 #ifdef UNIV_PFS_THREAD
 	pfs_register_thread(srv_purge_thread_key);
 #endif /* UNIV_PFS_THREAD */
 
+	/* The mysys thread context lets DBUG_EXECUTE_IF() fire in the
+	undo tablespace truncation that this thread runs. */
+	my_thread_init();
+
 #ifdef UNIV_DEBUG_THREAD_CREATION
 	fprintf(stderr, "InnoDB: Purge thread running, id %lu\n",
 		os_thread_pf(os_thread_get_curr_id()));
@@ -3501,9 +3779,9 @@ srv_purge_thread(
 
 	mutex_enter(&kernel_mutex);
 
-	slot = srv_table_reserve_slot(SRV_WORKER);
+	slot = srv_table_reserve_slot(SRV_PURGE);
 
-	++srv_n_threads_active[SRV_WORKER];
+	++srv_n_threads_active[SRV_PURGE];
 
 	mutex_exit(&kernel_mutex);
 
@@ -3572,6 +3850,93 @@ srv_purge_thread(
 		os_thread_pf(os_thread_get_curr_id()));
 #endif /* UNIV_DEBUG_THREAD_CREATION */
 
+	my_thread_end();
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;	/* Not reached, avoid compiler warning */
+}
+
+/*********************************************************************//**
+Purge worker thread. Executes the purge query threads that the purge
+coordinator enqueues to the server task queue.
+@return	a dummy parameter */
+UNIV_INTERN
+os_thread_ret_t
+srv_worker_thread(
+/*==============*/
+	void*	arg __attribute__((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	srv_slot_t*	slot;
+
+	ut_a(srv_n_purge_threads > 1);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(srv_worker_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: Purge worker thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	mutex_enter(&kernel_mutex);
+
+	slot = srv_table_reserve_slot(SRV_WORKER);
+
+	++srv_n_threads_active[SRV_WORKER];
+
+	while (srv_shutdown_state != SRV_SHUTDOWN_EXIT_THREADS) {
+		que_thr_t*	thr;
+
+		ut_ad(mutex_own(&kernel_mutex));
+
+		thr = UT_LIST_GET_FIRST(srv_sys->tasks);
+
+		if (thr == NULL) {
+			/* The task queue is checked and the thread is
+			suspended under the kernel mutex, so that a task
+			enqueued in between cannot be missed. */
+
+			srv_suspend_thread(slot);
+
+			mutex_exit(&kernel_mutex);
+
+			os_event_wait(slot->event);
+
+			mutex_enter(&kernel_mutex);
+
+			continue;
+		}
+
+		UT_LIST_REMOVE(queue, srv_sys->tasks, thr);
+
+		mutex_exit(&kernel_mutex);
+
+		que_run_threads(thr);
+
+		if (thr->graph->fork_type == QUE_FORK_PURGE) {
+			trx_purge_worker_done();
+		}
+
+		mutex_enter(&kernel_mutex);
+	}
+
+	/* Decrement the active count. */
+	srv_suspend_thread(slot);
+
+	slot->in_use = FALSE;
+
+	mutex_exit(&kernel_mutex);
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: Purge worker thread exiting, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
 	/* We count the number of threads in os_thread_exit(). A created
 	thread should always use that to exit and not use return() to exit. */
 	os_thread_exit(NULL);
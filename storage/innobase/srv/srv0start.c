@@ -44,6 +44,7 @@ Created 2/16/1996 Heikki Tuuri
 #include "data0type.h"
 #include "dict0dict.h"
 #include "buf0buf.h"
+#include "buf0dump.h"
 #include "os0file.h"
 #include "os0thread.h"
 #include "fil0fil.h"
@@ -54,8 +55,11 @@ Created 2/16/1996 Heikki Tuuri
 #include "log0recv.h"
 #include "page0page.h"
 #include "page0cur.h"
+#include "page0zip.h"
 #include "trx0trx.h"
 #include "trx0sys.h"
+#include "trx0rseg.h"
+#include "trx0purge.h"
 #include "btr0btr.h"
 #include "btr0cur.h"
 #include "rem0rec.h"
@@ -79,6 +83,7 @@ Created 2/16/1996 Heikki Tuuri
 # include "btr0sea.h"
 # include "rem0cmp.h"
 # include "dict0crea.h"
+# include "dict0stats.h"
 # include "row0ins.h"
 # include "row0sel.h"
 # include "row0upd.h"
@@ -87,6 +92,7 @@ Created 2/16/1996 Heikki Tuuri
 # include "btr0pcur.h"
 # include "os0sync.h" /* for INNODB_RW_LOCKS_USE_ATOMICS */
 # include "zlib.h" /* for ZLIB_VERSION */
+# include "ut0crc32.h"
 
 /** Log sequence number immediately after startup */
 UNIV_INTERN ib_uint64_t	srv_start_lsn;
@@ -109,6 +115,9 @@ UNIV_INTERN ibool	srv_startup_is_before_trx_rollback_phase = FALSE;
 UNIV_INTERN ibool	srv_is_being_started = FALSE;
 /** TRUE if the server was successfully started */
 UNIV_INTERN ibool	srv_was_started = FALSE;
+/** Id of the undo tablespace whose truncation was interrupted and is
+completed at the end of the startup, or ULINT_UNDEFINED */
+UNIV_INTERN ulint	srv_undo_space_to_truncate = ULINT_UNDEFINED;
 /** TRUE if innobase_start_or_create_for_mysql() has been called */
 static ibool	srv_start_has_been_called = FALSE;
 
@@ -144,6 +153,14 @@ UNIV_INTERN mysql_pfs_key_t	srv_error_monitor_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_monitor_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_master_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_purge_thread_key;
+UNIV_INTERN mysql_pfs_key_t	srv_worker_thread_key;
+UNIV_INTERN mysql_pfs_key_t	buf_dump_thread_key;
+UNIV_INTERN mysql_pfs_key_t	buf_resize_thread_key;
+UNIV_INTERN mysql_pfs_key_t	buf_page_cleaner_coordinator_thread_key;
+UNIV_INTERN mysql_pfs_key_t	buf_page_cleaner_worker_thread_key;
+UNIV_INTERN mysql_pfs_key_t	dict_stats_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_flusher_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
 /*********************************************************************//**
@@ -493,11 +510,6 @@ io_handler_thread(
 }
 #endif /* !UNIV_HOTBACKUP */
 
-#ifdef __WIN__
-#define SRV_PATH_SEPARATOR	'\\'
-#else
-#define SRV_PATH_SEPARATOR	'/'
-#endif
 
 /*********************************************************************//**
 Normalizes a directory path for Windows: converts slashes to backslashes. */
@@ -1007,6 +1019,241 @@ skip_size_check:
 	return(DB_SUCCESS);
 }
 
+/*********************************************************************//**
+Builds the path of an undo tablespace file, or of a file that belongs to
+an undo tablespace, in innodb_undo_directory. */
+UNIV_INTERN
+void
+srv_undo_file_path(
+/*===============*/
+	char*		path,		/*!< out: path of the file */
+	ulint		size,		/*!< in: size of path */
+	ulint		space_id,	/*!< in: undo tablespace id */
+	const char*	suffix)		/*!< in: "" for the tablespace
+					file itself */
+{
+	ulint	dirnamelen = strlen(srv_undo_dir);
+	char	separator[2] = { SRV_PATH_SEPARATOR, 0 };
+
+	/* Add a path separator if needed. */
+	if (!dirnamelen || srv_undo_dir[dirnamelen - 1] == SRV_PATH_SEPARATOR) {
+		separator[0] = 0;
+	}
+
+	ut_snprintf(path, size, "%s%sundo%03lu%s",
+		    srv_undo_dir, separator, (ulong) space_id, suffix);
+}
+
+/*********************************************************************//**
+Creates an undo tablespace file of the initial size.
+@return	DB_SUCCESS or error code */
+static
+ulint
+srv_undo_tablespace_create(
+/*=======================*/
+	const char*	name)	/*!< in: path of the file */
+{
+	os_file_t	file;
+	ibool		ret;
+
+	file = os_file_create(innodb_file_data_key, name, OS_FILE_CREATE,
+			      OS_FILE_NORMAL, OS_DATA_FILE, &ret);
+
+	if (!ret) {
+		fprintf(stderr,
+			"InnoDB: Error in creating undo tablespace %s\n",
+			name);
+
+		return(DB_ERROR);
+	}
+
+	ut_print_timestamp(stderr);
+	fprintf(stderr,
+		"  InnoDB: Setting undo tablespace %s size to %lu MB\n",
+		name, (ulong) (SRV_UNDO_TABLESPACE_SIZE_IN_PAGES
+			       >> (20 - UNIV_PAGE_SIZE_SHIFT)));
+
+	ret = os_file_set_size(
+		name, file,
+		srv_calc_low32(SRV_UNDO_TABLESPACE_SIZE_IN_PAGES),
+		srv_calc_high32(SRV_UNDO_TABLESPACE_SIZE_IN_PAGES));
+
+	os_file_close(file);
+
+	if (!ret) {
+		fprintf(stderr,
+			"InnoDB: Error in creating %s:"
+			" probably out of disk space\n", name);
+
+		return(DB_ERROR);
+	}
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Opens an undo tablespace file and adds it to the tablespace memory cache.
+@return	DB_SUCCESS or error code */
+static
+ulint
+srv_undo_tablespace_open(
+/*=====================*/
+	const char*	name,		/*!< in: path of the file */
+	ulint		space_id)	/*!< in: undo tablespace id */
+{
+	os_file_t	file;
+	ibool		ret;
+	ib_int64_t	size;
+
+	file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, name, OS_FILE_OPEN,
+		OS_FILE_READ_ONLY, &ret);
+
+	if (!ret) {
+		os_file_get_last_error(TRUE);
+
+		fprintf(stderr,
+			"InnoDB: Error: cannot open undo tablespace %s\n",
+			name);
+
+		return(DB_ERROR);
+	}
+
+	size = os_file_get_size_as_iblonglong(file);
+
+	os_file_close(file);
+
+	if (size < 0) {
+		fprintf(stderr,
+			"InnoDB: Error: cannot get the size of"
+			" undo tablespace %s\n", name);
+
+		return(DB_ERROR);
+	}
+
+	/* The undo tablespaces are not in the data dictionary, so
+	fil_load_single_table_tablespaces() does not account for
+	their ids. */
+	fil_set_max_space_id_if_bigger(space_id);
+
+	fil_space_create(name, space_id, 0, FIL_TABLESPACE);
+
+	ut_a(fil_validate());
+
+	fil_node_create(name, (ulint) (size >> UNIV_PAGE_SIZE_SHIFT),
+			space_id, FALSE);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Creates the undo tablespaces of a new database, or opens the undo
+tablespaces that the rollback segments of an existing database are in.
+This must be called before the crash recovery, which may apply redo log
+to them.
+@return	DB_SUCCESS or error code */
+static
+ulint
+srv_undo_tablespaces_init(
+/*======================*/
+	ibool	create_new_db,		/*!< in: TRUE if a new database
+					is being created */
+	ulint	n_conf_tablespaces)	/*!< in: innodb_undo_tablespaces */
+{
+	ulint	i;
+	ulint	err;
+	ulint	n_undo_tablespaces;
+	ulint	undo_tablespace_ids[TRX_SYS_N_RSEGS];
+	char	name[OS_FILE_MAX_PATH];
+
+	srv_normalize_path_for_win(srv_undo_dir);
+
+	if (create_new_db) {
+		n_undo_tablespaces = n_conf_tablespaces;
+
+		for (i = 0; i < n_undo_tablespaces; i++) {
+			undo_tablespace_ids[i] = i + 1;
+
+			srv_undo_file_path(name, sizeof name, i + 1, "");
+
+			err = srv_undo_tablespace_create(name);
+
+			if (err != DB_SUCCESS) {
+
+				return(err);
+			}
+		}
+	} else {
+		/* The undo tablespaces can only be set up when the
+		database is created: the rollback segments are already
+		placed. */
+		n_undo_tablespaces = trx_rseg_get_n_undo_tablespaces(
+			undo_tablespace_ids);
+
+		if (n_undo_tablespaces != n_conf_tablespaces) {
+			ut_print_timestamp(stderr);
+			fprintf(stderr,
+				" InnoDB: Warning: innodb_undo_tablespaces"
+				" is %lu, but the database was created"
+				" with %lu undo tablespaces\n",
+				(ulong) n_conf_tablespaces,
+				(ulong) n_undo_tablespaces);
+		}
+	}
+
+	for (i = 0; i < n_undo_tablespaces; i++) {
+
+		/* The undo tablespaces are numbered from 1 without
+		gaps, see trx_sys_create_rsegs(). */
+		if (undo_tablespace_ids[i] != i + 1) {
+			fprintf(stderr,
+				"InnoDB: Error: undo tablespace %lu"
+				" is missing\n", (ulong) (i + 1));
+
+			return(DB_ERROR);
+		}
+
+		srv_undo_file_path(name, sizeof name, i + 1, "");
+
+		err = srv_undo_tablespace_open(name, i + 1);
+
+		if (err != DB_SUCCESS) {
+
+			return(err);
+		}
+
+		if (!create_new_db && trx_purge_undo_trunc_log_exists(i + 1)) {
+			ut_a(srv_undo_space_to_truncate == ULINT_UNDEFINED);
+
+			ut_print_timestamp(stderr);
+			fprintf(stderr,
+				" InnoDB: The truncation of undo tablespace"
+				" %lu was interrupted, it is completed"
+				" after the recovery\n", (ulong) (i + 1));
+
+			srv_undo_space_to_truncate = i + 1;
+		}
+	}
+
+	srv_undo_tablespaces_open = n_undo_tablespaces;
+
+	if (create_new_db) {
+		mtr_t	mtr;
+
+		for (i = 0; i < n_undo_tablespaces; i++) {
+			mtr_start(&mtr);
+
+			fsp_header_init(i + 1,
+					SRV_UNDO_TABLESPACE_SIZE_IN_PAGES,
+					&mtr);
+
+			mtr_commit(&mtr);
+		}
+	}
+
+	return(DB_SUCCESS);
+}
+
 /********************************************************************
 Starts InnoDB and creates a new database if database files
 are not found and the user wants.
@@ -1152,6 +1399,14 @@ innobase_start_or_create_for_mysql(void)
 	fputs(" InnoDB: and extra copying\n", stderr);
 #endif /* UNIV_ZIP_COPY */
 
+	ut_crc32_init();
+
+	ut_print_timestamp(stderr);
+	fprintf(stderr, " InnoDB: Using %s to compute CRC32 checksums\n",
+		ut_crc32_sse42_enabled
+		? "CPU crc32 instructions"
+		: "software slicing-by-8");
+
 	/* Since InnoDB does not currently clean up all its internal data
 	structures in MySQL Embedded Server Library server_end(), we
 	print an error message if someone tries to start up InnoDB a
@@ -1290,6 +1545,31 @@ innobase_start_or_create_for_mysql(void)
 						computers */
 	}
 
+	/* The buffer pool instances are allocated and resized in
+	chunks of srv_buf_pool_chunk_unit bytes.  Make each instance
+	have at least one chunk, and the pool size a multiple of the
+	chunk size times the number of instances. */
+	if (srv_buf_pool_chunk_unit * srv_buf_pool_instances
+	    > srv_buf_pool_size) {
+		srv_buf_pool_chunk_unit = ut_2pow_round(
+			srv_buf_pool_size / srv_buf_pool_instances,
+			UNIV_PAGE_SIZE);
+	}
+
+	if (srv_buf_pool_size != buf_pool_size_align(srv_buf_pool_size)) {
+		srv_buf_pool_size = buf_pool_size_align(srv_buf_pool_size);
+
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			" InnoDB: Warning: innodb_buffer_pool_size was"
+			" rounded up to %lu bytes, a multiple of"
+			" innodb_buffer_pool_chunk_size %lu times"
+			" innodb_buffer_pool_instances %lu\n",
+			(ulong) srv_buf_pool_size,
+			(ulong) srv_buf_pool_chunk_unit,
+			(ulong) srv_buf_pool_instances);
+	}
+
 	err = srv_boot();
 
 	if (err != DB_SUCCESS) {
@@ -1427,6 +1707,7 @@ innobase_start_or_create_for_mysql(void)
 
 	fsp_init();
 	log_init();
+	page_zip_stat_per_index_init();
 
 	lock_sys_create(srv_lock_table_size);
 
@@ -1640,6 +1921,30 @@ innobase_start_or_create_for_mysql(void)
 		mutex_exit(&(log_sys->mutex));
 	}
 
+	/* The rollback segment slots in the trx system header, which
+	the undo tablespace initialization reads, are protected by the
+	trx_sys mutex. */
+	trx_sys_mem_create();
+
+	err = srv_undo_tablespaces_init(create_new_db, srv_undo_tablespaces);
+
+	if (err != DB_SUCCESS) {
+
+		return((int) err);
+	}
+
+	if (srv_doublewrite_file && srv_use_doublewrite_buf) {
+		/* Open the doublewrite file before a crash recovery
+		reads the pages in it */
+
+		err = trx_doublewrite_file_create();
+
+		if (err != DB_SUCCESS) {
+
+			return((int) err);
+		}
+	}
+
 	trx_sys_file_format_init();
 
 	if (create_new_db) {
@@ -1818,7 +2123,12 @@ innobase_start_or_create_for_mysql(void)
 	if (trx_doublewrite == NULL) {
 		/* Create the doublewrite buffer to a new tablespace */
 
-		trx_sys_create_doublewrite_buf();
+		err = trx_sys_create_doublewrite_buf();
+
+		if (err != DB_SUCCESS) {
+
+			return((int) err);
+		}
 	}
 
 	/* Here the double write buffer has already been created and so
@@ -1834,7 +2144,30 @@ innobase_start_or_create_for_mysql(void)
 	running in single threaded mode essentially. Only the IO threads
 	should be running at this stage. */
 
-	trx_sys_create_rsegs(TRX_SYS_N_RSEGS - 1);
+	trx_sys_create_rsegs(srv_undo_tablespaces_open, TRX_SYS_N_RSEGS - 1);
+
+	if (create_new_db && srv_undo_tablespaces_open > 0) {
+		/* The undo tablespaces are found through the rollback
+		segment slots in the trx system header before the redo
+		log is applied: write the slots to the data file. */
+		log_make_checkpoint_at(IB_ULONGLONG_MAX, TRUE);
+	}
+
+	if (srv_undo_space_to_truncate != ULINT_UNDEFINED) {
+		if (srv_force_recovery < SRV_FORCE_NO_LOG_REDO) {
+			ut_a(trx_purge_truncate_undo_space(
+				     srv_undo_space_to_truncate));
+
+			srv_undo_space_to_truncate = ULINT_UNDEFINED;
+		} else {
+			ut_print_timestamp(stderr);
+			fprintf(stderr,
+				" InnoDB: Undo tablespace %lu is not used"
+				" until its truncation is completed by a"
+				" startup without innodb_force_recovery\n",
+				(ulong) srv_undo_space_to_truncate);
+		}
+	}
 
 	/* Create the thread which watches the timeouts for lock waits */
 	os_thread_create(&srv_lock_timeout_thread, NULL,
@@ -1856,27 +2189,77 @@ innobase_start_or_create_for_mysql(void)
 		return((int)DB_ERROR);
 	}
 
+	err = dict_stats_create_tables();
+
+	if (err != DB_SUCCESS) {
+		return((int)DB_ERROR);
+	}
+
+	/* Create the threads which write and flush the log buffer for
+	the committing transactions. Until now, log_write_up_to() has
+	written and flushed the log in the calling thread. The flags are
+	set here, so that a shutdown cannot miss the threads. */
+	log_sys->writer_active = TRUE;
+	os_thread_create(log_writer_thread, NULL, NULL);
+
+	log_sys->flusher_active = TRUE;
+	os_thread_create(log_flusher_thread, NULL, NULL);
+
+	/* Create the thread which recalculates persistent statistics.
+	The flag is set here rather than in the thread, so that a shutdown
+	cannot miss the thread while it is starting up. */
+	srv_dict_stats_thread_active = TRUE;
+	os_thread_create(dict_stats_thread, NULL, NULL);
+
+	/* Create the thread which extends tablespaces before they
+	fill up */
+	srv_fsp_preextend_thread_active = TRUE;
+	os_thread_create(fsp_preextend_thread, NULL, NULL);
+
 	/* Create the master thread which does purge and other utility
 	operations */
 
 	os_thread_create(&srv_master_thread, NULL, thread_ids
 			 + (1 + SRV_MAX_N_IO_THREADS));
 
-	/* Currently we allow only a single purge thread. */
-	ut_a(srv_n_purge_threads == 0 || srv_n_purge_threads == 1);
+	ut_a(srv_n_purge_threads <= SRV_MAX_N_PURGE_THREADS);
+
+	/* If the user has requested separate purge threads then start
+	the purge coordinator thread and the purge worker threads. */
+	if (srv_n_purge_threads > 0) {
+		ulint	i;
 
-	/* If the user has requested a separate purge thread then
-	start the purge thread. */
-	if (srv_n_purge_threads == 1) {
 		os_thread_create(&srv_purge_thread, NULL, NULL);
+
+		for (i = 1; i < srv_n_purge_threads; i++) {
+			os_thread_create(&srv_worker_thread, NULL, NULL);
+		}
+	}
+
+	ut_a(srv_n_page_cleaners <= SRV_MAX_N_PAGE_CLEANERS);
+
+	/* If the user has requested page cleaner threads then start the
+	page cleaner coordinator thread and the page cleaner workers. */
+	if (srv_n_page_cleaners > 0) {
+		ulint	i;
+
+		buf_flush_page_cleaner_init();
+
+		os_thread_create(buf_flush_page_cleaner_coordinator,
+				 NULL, NULL);
+
+		for (i = 1; i < srv_n_page_cleaners; i++) {
+			os_thread_create(buf_flush_page_cleaner_worker,
+					 NULL, NULL);
+		}
 	}
 
 	/* Wait for the purge and master thread to startup. */
 
 	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
 		if (srv_thread_has_reserved_slot(SRV_MASTER) == ULINT_UNDEFINED
-		    || (srv_n_purge_threads == 1
-			&& srv_thread_has_reserved_slot(SRV_WORKER)
+		    || (srv_n_purge_threads > 0
+			&& srv_thread_has_reserved_slot(SRV_PURGE)
 			== ULINT_UNDEFINED)) {
 
 			ut_print_timestamp(stderr);
@@ -2096,6 +2479,13 @@ innobase_start_or_create_for_mysql(void)
 
 	srv_file_per_table = srv_file_per_table_original_value;
 
+	/* Create the buffer pool dump/load thread */
+	os_thread_create(buf_dump_thread, NULL, NULL);
+
+	/* Create the thread that resizes the buffer pool online */
+	srv_buf_resize_thread_active = TRUE;
+	os_thread_create(buf_resize_thread, NULL, NULL);
+
 	srv_was_started = TRUE;
 
 	return((int) DB_SUCCESS);
@@ -2158,13 +2548,20 @@ innobase_shutdown_for_mysql(void)
 		/* c. We wake the master thread so that it exits */
 		srv_wake_master_thread();
 
-		/* d. We wake the purge thread so that it exits */
+		/* d. We wake the purge threads so that they exit */
 		srv_wake_purge_thread();
 
+		srv_wake_worker_threads();
+
 		/* e. Exit the i/o threads */
 
 		os_aio_wake_all_threads_at_shutdown();
 
+		/* f. We wake the log writer and flusher threads so that
+		they exit */
+		os_event_set(log_sys->writer_event);
+		os_event_set(log_sys->flusher_event);
+
 		os_mutex_enter(os_sync_mutex);
 
 		if (os_thread_count == 0) {
@@ -2219,14 +2616,18 @@ innobase_shutdown_for_mysql(void)
 
 	ibuf_close();
 	log_shutdown();
-	lock_sys_close();
 	trx_sys_file_format_close();
+	/* trx_sys_close() releases the locks of prepared transactions,
+	so it must be called before lock_sys_close(). */
 	trx_sys_close();
+	lock_sys_close();
 
 	mutex_free(&srv_monitor_file_mutex);
 	mutex_free(&srv_dict_tmpfile_mutex);
 	mutex_free(&srv_misc_tmpfile_mutex);
 	dict_close();
+	fsp_close();
+	page_zip_stat_per_index_close();
 	btr_search_sys_free();
 
 	/* 3. Free all InnoDB's own mutexes and the os_fast_mutexes inside
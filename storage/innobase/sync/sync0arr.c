@@ -73,7 +73,13 @@ Instead, now the event that a thread wants to wait on is embedded
 in the wait object (mutex or rw_lock). We still keep the global
 wait array for the sake of diagnostics and also to avoid infinite
 wait The error_monitor thread scans the global wait array to signal
-any waiting threads who have missed the signal. */
+any waiting threads who have missed the signal.
+
+The wait array is divided into innodb_sync_array_size arrays, each
+protected by its own mutex, so that the threads that start or stop
+waiting do not all contend for the mutex of a single array. A thread
+reserves a cell in any of the arrays; the deadlock detection, the
+error_monitor thread and the diagnostics look at all of them. */
 
 /** A cell where an individual thread may wait suspended
 until a resource is released. The suspending is implemented
@@ -133,12 +139,23 @@ struct sync_array_struct {
 					to prevent infinite recursion
 					in implementation, we fall back to
 					an OS mutex. */
-	ulint		sg_count;	/*!< count of how many times an
-					object has been signalled */
 	ulint		res_count;	/*!< count of cell reservations
 					since creation of the array */
 };
 
+/** The wait arrays, sync_array_size of them */
+UNIV_INTERN sync_array_t**	sync_wait_array;
+
+/** Number of wait arrays, set from innodb_sync_array_size */
+UNIV_INTERN ulint		sync_array_size;
+
+/** Count of how many times an object has been signalled */
+static ulint			sync_array_sg_count;
+
+/** Count of wait array selections, for spreading the waiting threads
+over the arrays. Races on it are harmless. */
+static ulint			sync_array_n_get;
+
 #ifdef UNIV_PFS_MUTEX
 /* Key to register the mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	syn_arr_mutex_key;
@@ -153,11 +170,10 @@ static
 ibool
 sync_array_detect_deadlock(
 /*=======================*/
-	sync_array_t*	arr,	/*!< in: wait array; NOTE! the caller must
-				own the mutex to array */
 	sync_cell_t*	start,	/*!< in: cell where recursive search started */
 	sync_cell_t*	cell,	/*!< in: cell to search */
-	ulint		depth);	/*!< in: recursion depth */
+	ulint		depth);	/*!< in: recursion depth; NOTE! the caller
+				must own the mutexes of all wait arrays */
 #endif /* UNIV_SYNC_DEBUG */
 
 /*****************************************************************//**
@@ -218,6 +234,36 @@ sync_array_exit(
 	}
 }
 
+#ifdef UNIV_SYNC_DEBUG
+/******************************************************************//**
+Reserves the mutexes of all wait arrays, in the order of the arrays. */
+static
+void
+sync_array_enter_all(void)
+/*======================*/
+{
+	ulint	i;
+
+	for (i = 0; i < sync_array_size; i++) {
+		sync_array_enter(sync_wait_array[i]);
+	}
+}
+
+/******************************************************************//**
+Releases the mutexes of all wait arrays. */
+static
+void
+sync_array_exit_all(void)
+/*=====================*/
+{
+	ulint	i;
+
+	for (i = 0; i < sync_array_size; i++) {
+		sync_array_exit(sync_wait_array[i]);
+	}
+}
+#endif /* UNIV_SYNC_DEBUG */
+
 /*******************************************************************//**
 Creates a synchronization wait array. It is protected by a mutex
 which is automatically reserved when the functions operating on it
@@ -340,9 +386,10 @@ sync_cell_get_event(
 
 /******************************************************************//**
 Reserves a wait array cell for waiting for an object.
-The event of the cell is reset to nonsignalled state. */
-UNIV_INTERN
-void
+The event of the cell is reset to nonsignalled state.
+@return TRUE if a cell was reserved, FALSE if the array is full */
+static
+ibool
 sync_array_reserve_cell(
 /*====================*/
 	sync_array_t*	arr,	/*!< in: wait array */
@@ -361,6 +408,12 @@ sync_array_reserve_cell(
 
 	sync_array_enter(arr);
 
+	if (arr->n_reserved == arr->n_cells) {
+		sync_array_exit(arr);
+
+		return(FALSE);
+	}
+
 	arr->res_count++;
 
 	/* Reserve a new cell. */
@@ -399,13 +452,51 @@ sync_array_reserve_cell(
 
 			cell->thread = os_thread_get_curr_id();
 
-			return;
+			return(TRUE);
+		}
+	}
+
+	ut_error; /* n_reserved is wrong */
+
+	return(FALSE);
+}
+
+/******************************************************************//**
+Reserves a wait array cell for waiting for an object, in one of the wait
+arrays. The event of the cell is reset to nonsignalled state.
+@return	the wait array of the reserved cell */
+UNIV_INTERN
+sync_array_t*
+sync_array_get_and_reserve_cell(
+/*============================*/
+	void*		object, /*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line,	/*!< in: line where requested */
+	ulint*		index)	/*!< out: index of the reserved cell */
+{
+	ulint	n;
+	ulint	i;
+
+	n = sync_array_n_get++;
+
+	/* The arrays have room for OS_THREAD_MAX_N cells in total, so
+	that one of them must have a free cell */
+
+	for (i = 0; i < sync_array_size; i++) {
+		sync_array_t*	arr;
+
+		arr = sync_wait_array[(n + i) % sync_array_size];
+
+		if (sync_array_reserve_cell(arr, object, type,
+					    file, line, index)) {
+			return(arr);
 		}
 	}
 
 	ut_error; /* No free cell found */
 
-	return;
+	return(NULL);
 }
 
 /******************************************************************//**
@@ -436,7 +527,14 @@ sync_array_wait_event(
 	event = sync_cell_get_event(cell);
 		cell->waiting = TRUE;
 
+	sync_array_exit(arr);
+
 #ifdef UNIV_SYNC_DEBUG
+	/* The threads that this thread may be waiting for can wait in
+	any of the arrays. The arrays are entered in a fixed order, so
+	that concurrent deadlock checks cannot block each other. */
+
+	sync_array_enter_all();
 
 	/* We use simple enter to the mutex below, because if
 	we cannot acquire it at once, mutex_enter would call
@@ -445,15 +543,16 @@ sync_array_wait_event(
 
 	rw_lock_debug_mutex_enter();
 
-	if (TRUE == sync_array_detect_deadlock(arr, cell, cell, 0)) {
+	if (TRUE == sync_array_detect_deadlock(cell, cell, 0)) {
 
 		fputs("########################################\n", stderr);
 		ut_error;
 	}
 
 	rw_lock_debug_mutex_exit();
+
+	sync_array_exit_all();
 #endif
-	sync_array_exit(arr);
 
 	os_event_wait_low(event, cell->signal_count);
 
@@ -550,26 +649,30 @@ sync_array_cell_print(
 
 #ifdef UNIV_SYNC_DEBUG
 /******************************************************************//**
-Looks for a cell with the given thread id.
+Looks for a cell with the given thread id in all wait arrays.
 @return	pointer to cell or NULL if not found */
 static
 sync_cell_t*
 sync_array_find_thread(
 /*===================*/
-	sync_array_t*	arr,	/*!< in: wait array */
 	os_thread_id_t	thread)	/*!< in: thread id */
 {
 	ulint		i;
+	ulint		j;
 	sync_cell_t*	cell;
 
-	for (i = 0; i < arr->n_cells; i++) {
+	for (j = 0; j < sync_array_size; j++) {
+		sync_array_t*	arr = sync_wait_array[j];
 
-		cell = sync_array_get_nth_cell(arr, i);
+		for (i = 0; i < arr->n_cells; i++) {
+
+			cell = sync_array_get_nth_cell(arr, i);
 
-		if (cell->wait_object != NULL
-		    && os_thread_eq(cell->thread, thread)) {
+			if (cell->wait_object != NULL
+			    && os_thread_eq(cell->thread, thread)) {
 
-			return(cell);	/* Found */
+				return(cell);	/* Found */
+			}
 		}
 	}
 
@@ -583,8 +686,6 @@ static
 ibool
 sync_array_deadlock_step(
 /*=====================*/
-	sync_array_t*	arr,	/*!< in: wait array; NOTE! the caller must
-				own the mutex to array */
 	sync_cell_t*	start,	/*!< in: cell where recursive search
 				started */
 	os_thread_id_t	thread,	/*!< in: thread to look at */
@@ -601,7 +702,7 @@ sync_array_deadlock_step(
 		return(FALSE);
 	}
 
-	new = sync_array_find_thread(arr, thread);
+	new = sync_array_find_thread(thread);
 
 	if (UNIV_UNLIKELY(new == start)) {
 		/* Deadlock */
@@ -611,7 +712,7 @@ sync_array_deadlock_step(
 		return(TRUE);
 
 	} else if (new) {
-		return(sync_array_detect_deadlock(arr, start, new, depth + 1));
+		return(sync_array_detect_deadlock(start, new, depth + 1));
 	}
 	return(FALSE);
 }
@@ -624,11 +725,10 @@ static
 ibool
 sync_array_detect_deadlock(
 /*=======================*/
-	sync_array_t*	arr,	/*!< in: wait array; NOTE! the caller must
-				own the mutex to array */
 	sync_cell_t*	start,	/*!< in: cell where recursive search started */
 	sync_cell_t*	cell,	/*!< in: cell to search */
-	ulint		depth)	/*!< in: recursion depth */
+	ulint		depth)	/*!< in: recursion depth; NOTE! the caller
+				must own the mutexes of all wait arrays */
 {
 	mutex_t*	mutex;
 	rw_lock_t*	lock;
@@ -636,7 +736,6 @@ sync_array_detect_deadlock(
 	ibool		ret;
 	rw_lock_debug_t*debug;
 
-	ut_a(arr);
 	ut_a(start);
 	ut_a(cell);
 	ut_ad(cell->wait_object);
@@ -666,7 +765,7 @@ sync_array_detect_deadlock(
 			can occur, as the wait array cannot contain
 			a thread with ID_UNDEFINED value. */
 
-			ret = sync_array_deadlock_step(arr, start, thread, 0,
+			ret = sync_array_deadlock_step(start, thread, 0,
 						       depth);
 			if (ret) {
 				fprintf(stderr,
@@ -705,7 +804,7 @@ sync_array_detect_deadlock(
 				he is blocked by start thread */
 
 				ret = sync_array_deadlock_step(
-					arr, start, thread, debug->pass,
+					start, thread, debug->pass,
 					depth);
 				if (ret) {
 print:
@@ -740,7 +839,7 @@ print:
 				start thread */
 
 				ret = sync_array_deadlock_step(
-					arr, start, thread, debug->pass,
+					start, thread, debug->pass,
 					depth);
 				if (ret) {
 					goto print;
@@ -845,35 +944,29 @@ sync_array_free_cell(
 Increments the signalled count. */
 UNIV_INTERN
 void
-sync_array_object_signalled(
-/*========================*/
-	sync_array_t*	arr)	/*!< in: wait array */
+sync_array_object_signalled(void)
+/*=============================*/
 {
 #ifdef HAVE_ATOMIC_BUILTINS
-	(void) os_atomic_increment_ulint(&arr->sg_count, 1);
+	(void) os_atomic_increment_ulint(&sync_array_sg_count, 1);
 #else
-	sync_array_enter(arr);
+	sync_array_enter(sync_wait_array[0]);
 
-	arr->sg_count++;
+	sync_array_sg_count++;
 
-	sync_array_exit(arr);
+	sync_array_exit(sync_wait_array[0]);
 #endif
 }
 
 /**********************************************************************//**
-If the wakeup algorithm does not work perfectly at semaphore relases,
-this function will do the waking (see the comment in mutex_exit). This
-function should be called about every 1 second in the server.
-
-Note that there's a race condition between this thread and mutex_exit
-changing the lock_word and calling signal_object, so sometimes this finds
-threads to wake up even when nothing has gone wrong. */
-UNIV_INTERN
+Wakes up the threads waiting in a wait array for semaphores that have
+been released. */
+static
 void
-sync_arr_wake_threads_if_sema_free(void)
-/*====================================*/
+sync_array_wake_threads_if_sema_free_low(
+/*=====================================*/
+	sync_array_t*	arr)	/*!< in: wait array */
 {
-	sync_array_t*	arr	= sync_primary_wait_array;
 	sync_cell_t*	cell;
 	ulint		count;
 	ulint		i;
@@ -906,6 +999,27 @@ sync_arr_wake_threads_if_sema_free(void)
 	sync_array_exit(arr);
 }
 
+/**********************************************************************//**
+If the wakeup algorithm does not work perfectly at semaphore relases,
+this function will do the waking (see the comment in mutex_exit). This
+function should be called about every 1 second in the server.
+
+Note that there's a race condition between this thread and mutex_exit
+changing the lock_word and calling signal_object, so sometimes this finds
+threads to wake up even when nothing has gone wrong. */
+UNIV_INTERN
+void
+sync_arr_wake_threads_if_sema_free(void)
+/*====================================*/
+{
+	ulint	i;
+
+	for (i = 0; i < sync_array_size; i++) {
+
+		sync_array_wake_threads_if_sema_free_low(sync_wait_array[i]);
+	}
+}
+
 /**********************************************************************//**
 Prints warnings of long semaphore waits to stderr.
 @return	TRUE if fatal semaphore wait threshold was exceeded */
@@ -921,6 +1035,7 @@ sync_array_print_long_waits(
 	ibool		old_val;
 	ibool		noticed = FALSE;
 	ulint		i;
+	ulint		j;
 	ulint		fatal_timeout = srv_fatal_semaphore_wait_threshold;
 	ulint		n_stalls = 0;
 	ibool		fatal = FALSE;
@@ -943,45 +1058,50 @@ sync_array_print_long_waits(
 # define SYNC_ARRAY_TIMEOUT	240
 #endif
 
-	sync_array_enter(sync_primary_wait_array);
+	for (j = 0; j < sync_array_size; j++) {
+		sync_array_t*	arr = sync_wait_array[j];
 
-	for (i = 0; i < sync_primary_wait_array->n_cells; i++) {
+		sync_array_enter(arr);
 
-		double	diff;
-		void*	wait_object;
+		for (i = 0; i < arr->n_cells; i++) {
 
-		cell = sync_array_get_nth_cell(sync_primary_wait_array, i);
+			double	diff;
+			void*	wait_object;
 
-		wait_object = cell->wait_object;
+			cell = sync_array_get_nth_cell(arr, i);
 
-		if (wait_object == NULL || !cell->waiting) {
+			wait_object = cell->wait_object;
 
-			continue;
-		}
+			if (wait_object == NULL || !cell->waiting) {
 
-		diff = difftime(time(NULL), cell->reservation_time);
+				continue;
+			}
 
-		if (diff > SYNC_ARRAY_TIMEOUT) {
-			fputs("InnoDB: Warning: a long semaphore wait:\n",
-			      stderr);
-			sync_array_cell_print(stderr, cell);
-			noticed = TRUE;
-			n_stalls++;
-		}
+			diff = difftime(time(NULL), cell->reservation_time);
 
-		if (diff > fatal_timeout) {
-			fatal = TRUE;
-		}
+			if (diff > SYNC_ARRAY_TIMEOUT) {
+				fputs("InnoDB: Warning:"
+				      " a long semaphore wait:\n", stderr);
+				sync_array_cell_print(stderr, cell);
+				noticed = TRUE;
+				n_stalls++;
+			}
+
+			if (diff > fatal_timeout) {
+				fatal = TRUE;
+			}
 
-		if (diff > longest_diff) {
-			longest_diff = diff;
-			*sema = wait_object;
-			*waiter = cell->thread;
+			if (diff > longest_diff) {
+				longest_diff = diff;
+				*sema = wait_object;
+				*waiter = cell->thread;
+			}
 		}
+
+		sync_array_exit(arr);
 	}
 
 	*n_tmo = n_stalls;
-	sync_array_exit(sync_primary_wait_array);
 
 	if (noticed) {
 		fprintf(stderr,
@@ -1017,7 +1137,7 @@ sync_array_print_long_waits(
 }
 
 /**********************************************************************//**
-Prints info of the wait array. */
+Prints the waiting threads of a wait array. */
 static
 void
 sync_array_output_info(
@@ -1030,9 +1150,6 @@ sync_array_output_info(
 	ulint		count;
 	ulint		i;
 
-	fprintf(file,
-		"OS WAIT ARRAY INFO: reservation count %ld, signal count %ld\n",
-						(long) arr->res_count, (long) arr->sg_count);
 	i = 0;
 	count = 0;
 
@@ -1050,17 +1167,84 @@ sync_array_output_info(
 }
 
 /**********************************************************************//**
-Prints info of the wait array. */
+Prints info of the wait arrays. */
 UNIV_INTERN
 void
-sync_array_print_info(
+sync_array_print(
+/*=============*/
+	FILE*		file)	/*!< in: file where to print */
+{
+	ulint	res_count	= 0;
+	ulint	i;
+
+	for (i = 0; i < sync_array_size; i++) {
+		res_count += sync_wait_array[i]->res_count;
+	}
+
+	fprintf(file,
+		"OS WAIT ARRAY INFO: reservation count %ld, signal count %ld\n",
+		(long) res_count, (long) sync_array_sg_count);
+
+	for (i = 0; i < sync_array_size; i++) {
+		sync_array_t*	arr = sync_wait_array[i];
+
+		sync_array_enter(arr);
+
+		sync_array_output_info(file, arr);
+
+		sync_array_exit(arr);
+	}
+}
+
+/**********************************************************************//**
+Creates the wait arrays, innodb_sync_array_size of them. */
+UNIV_INTERN
+void
+sync_array_init(
+/*============*/
+	ulint	n_threads)	/*!< in: number of threads that may wait
+				at the same time */
+{
+	ulint	n_cells;
+	ulint	i;
+
+	ut_a(sync_wait_array == NULL);
+	ut_a(srv_sync_array_size > 0);
+	ut_a(n_threads > 0);
+
+	sync_array_size = srv_sync_array_size;
+
+	/* Each thread must find a free cell in one of the arrays */
+
+	n_cells = 1 + (n_threads - 1) / sync_array_size;
+
+	sync_wait_array = ut_malloc(sizeof(*sync_wait_array)
+				    * sync_array_size);
+
+	for (i = 0; i < sync_array_size; i++) {
+
+		/* The arrays are protected by OS mutexes, because
+		they are used in the implementation of the database
+		mutexes */
+
+		sync_wait_array[i] = sync_array_create(
+			n_cells, SYNC_ARRAY_OS_MUTEX);
+	}
+}
+
+/**********************************************************************//**
+Frees the wait arrays. */
+UNIV_INTERN
+void
+sync_array_close(void)
 /*==================*/
-	FILE*		file,	/*!< in: file where to print */
-	sync_array_t*	arr)	/*!< in: wait array */
 {
-	sync_array_enter(arr);
+	ulint	i;
 
-	sync_array_output_info(file, arr);
+	for (i = 0; i < sync_array_size; i++) {
+		sync_array_free(sync_wait_array[i]);
+	}
 
-	sync_array_exit(arr);
+	ut_free(sync_wait_array);
+	sync_wait_array = NULL;
 }
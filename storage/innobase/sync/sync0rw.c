@@ -383,6 +383,7 @@ rw_lock_s_lock_spin(
 {
 	ulint	 index;	/* index of the reserved wait cell */
 	ulint	 i = 0;	/* spin round count */
+	sync_array_t* sync_arr; /* wait array of the reserved wait cell */
 
 	ut_ad(rw_lock_validate(lock));
 
@@ -425,17 +426,15 @@ lock_loop:
 
 		rw_s_spin_round_count += i;
 
-		sync_array_reserve_cell(sync_primary_wait_array,
-					lock, RW_LOCK_SHARED,
-					file_name, line,
-					&index);
+		sync_arr = sync_array_get_and_reserve_cell(
+			lock, RW_LOCK_SHARED, file_name, line, &index);
 
 		/* Set waiters before checking lock_word to ensure wake-up
                 signal is sent. This may lead to some unnecessary signals. */
 		rw_lock_set_waiter_flag(lock);
 
 		if (TRUE == rw_lock_s_lock_low(lock, pass, file_name, line)) {
-			sync_array_free_cell(sync_primary_wait_array, index);
+			sync_array_free_cell(sync_arr, index);
 			return; /* Success */
 		}
 
@@ -453,7 +452,7 @@ lock_loop:
 		lock->count_os_wait++;
 		rw_s_os_wait_count++;
 
-		sync_array_wait_event(sync_primary_wait_array, index);
+		sync_array_wait_event(sync_arr, index);
 
 		i = 0;
 		goto lock_loop;
@@ -497,6 +496,7 @@ rw_lock_x_lock_wait(
 {
 	ulint index;
 	ulint i = 0;
+	sync_array_t* sync_arr;
 
 	ut_ad(lock->lock_word <= 0);
 
@@ -512,11 +512,8 @@ rw_lock_x_lock_wait(
 		/* If there is still a reader, then go to sleep.*/
 		rw_x_spin_round_count += i;
 		i = 0;
-		sync_array_reserve_cell(sync_primary_wait_array,
-					lock,
-					RW_LOCK_WAIT_EX,
-					file_name, line,
-					&index);
+		sync_arr = sync_array_get_and_reserve_cell(
+			lock, RW_LOCK_WAIT_EX, file_name, line, &index);
 		/* Check lock_word to ensure wake-up isn't missed.*/
 		if(lock->lock_word < 0) {
 
@@ -532,8 +529,7 @@ rw_lock_x_lock_wait(
 					       file_name, line);
 #endif
 
-			sync_array_wait_event(sync_primary_wait_array,
-					      index);
+			sync_array_wait_event(sync_arr, index);
 #ifdef UNIV_SYNC_DEBUG
 			rw_lock_remove_debug_info(lock, pass,
 					       RW_LOCK_WAIT_EX);
@@ -541,8 +537,7 @@ rw_lock_x_lock_wait(
                         /* It is possible to wake when lock_word < 0.
                         We must pass the while-loop check to proceed.*/
 		} else {
-			sync_array_free_cell(sync_primary_wait_array,
-					     index);
+			sync_array_free_cell(sync_arr, index);
 		}
 	}
 	rw_x_spin_round_count += i;
@@ -624,6 +619,7 @@ rw_lock_x_lock_func(
 	ulint	index;	/*!< index of the reserved wait cell */
 	ulint	i;	/*!< spin round count */
 	ibool	spinning = FALSE;
+	sync_array_t* sync_arr; /*!< wait array of the reserved wait cell */
 
 	ut_ad(rw_lock_validate(lock));
 #ifdef UNIV_SYNC_DEBUG
@@ -674,18 +670,15 @@ lock_loop:
 			(ulong) lock->cline, (ulong) i);
 	}
 
-	sync_array_reserve_cell(sync_primary_wait_array,
-				lock,
-				RW_LOCK_EX,
-				file_name, line,
-				&index);
+	sync_arr = sync_array_get_and_reserve_cell(
+		lock, RW_LOCK_EX, file_name, line, &index);
 
 	/* Waiters must be set before checking lock_word, to ensure signal
 	is sent. This could lead to a few unnecessary wake-up signals. */
 	rw_lock_set_waiter_flag(lock);
 
 	if (rw_lock_x_lock_low(lock, pass, file_name, line)) {
-		sync_array_free_cell(sync_primary_wait_array, index);
+		sync_array_free_cell(sync_arr, index);
 		return; /* Locking succeeded */
 	}
 
@@ -702,7 +695,7 @@ lock_loop:
 	lock->count_os_wait++;
 	rw_x_os_wait_count++;
 
-	sync_array_wait_event(sync_primary_wait_array, index);
+	sync_array_wait_event(sync_arr, index);
 
 	i = 0;
 	goto lock_loop;
@@ -42,7 +42,11 @@ Created 3/26/1996 Heikki Tuuri
 #include "row0upd.h"
 #include "trx0rec.h"
 #include "srv0srv.h"
+#include "srv0start.h"
 #include "os0thread.h"
+#include "os0file.h"
+#include "buf0lru.h"
+#include "log0log.h"
 
 /** The global data structure coordinating a purge */
 UNIV_INTERN trx_purge_t*	purge_sys = NULL;
@@ -89,133 +93,47 @@ trx_purge_update_undo_must_exist(
 	return(FALSE);
 }
 
-/*=================== PURGE RECORD ARRAY =============================*/
-
-/*******************************************************************//**
-Stores info of an undo log record during a purge.
-@return	pointer to the storage cell */
-static
-trx_undo_inf_t*
-trx_purge_arr_store_info(
-/*=====================*/
-	trx_id_t	trx_no,	/*!< in: transaction number */
-	undo_no_t	undo_no)/*!< in: undo number */
-{
-	trx_undo_inf_t*	cell;
-	trx_undo_arr_t*	arr;
-	ulint		i;
-
-	arr = purge_sys->arr;
-
-	for (i = 0;; i++) {
-		cell = trx_undo_arr_get_nth_info(arr, i);
-
-		if (!(cell->in_use)) {
-			/* Not in use, we may store here */
-			cell->undo_no = undo_no;
-			cell->trx_no = trx_no;
-			cell->in_use = TRUE;
-
-			arr->n_used++;
-
-			return(cell);
-		}
-	}
-}
-
-/*******************************************************************//**
-Removes info of an undo log record during a purge. */
-UNIV_INLINE
-void
-trx_purge_arr_remove_info(
-/*======================*/
-	trx_undo_inf_t*	cell)	/*!< in: pointer to the storage cell */
-{
-	trx_undo_arr_t*	arr;
-
-	arr = purge_sys->arr;
-
-	cell->in_use = FALSE;
-
-	ut_ad(arr->n_used > 0);
-
-	arr->n_used--;
-}
-
-/*******************************************************************//**
-Gets the biggest pair of a trx number and an undo number in a purge array. */
-static
-void
-trx_purge_arr_get_biggest(
-/*======================*/
-	trx_undo_arr_t*	arr,	/*!< in: purge array */
-	trx_id_t*	trx_no,	/*!< out: transaction number: 0
-				if array is empty */
-	undo_no_t*	undo_no)/*!< out: undo number */
-{
-	trx_undo_inf_t*	cell;
-	trx_id_t	pair_trx_no;
-	undo_no_t	pair_undo_no;
-	ulint		i;
-	ulint		n;
-
-	n = arr->n_used;
-	pair_trx_no = 0;
-	pair_undo_no = 0;
-
-	if (n) {
-		for (i = 0;; i++) {
-			cell = trx_undo_arr_get_nth_info(arr, i);
-
-			if (!cell->in_use) {
-				continue;
-			}
-
-			if ((cell->trx_no > pair_trx_no)
-			    || ((cell->trx_no == pair_trx_no)
-				&& cell->undo_no >= pair_undo_no)) {
-
-				pair_trx_no = cell->trx_no;
-				pair_undo_no = cell->undo_no;
-			}
-
-			if (!--n) {
-				break;
-			}
-		}
-	}
-
-	*trx_no = pair_trx_no;
-	*undo_no = pair_undo_no;
-}
-
 /****************************************************************//**
 Builds a purge 'query' graph. The actual purge is performed by executing
 this query graph.
 @return	own: the query graph */
 static
 que_t*
-trx_purge_graph_build(void)
-/*=======================*/
+trx_purge_graph_build(
+/*==================*/
+	trx_t*	trx)	/*!< in: purge transaction running the graph */
 {
 	mem_heap_t*	heap;
 	que_fork_t*	fork;
 	que_thr_t*	thr;
-	/*	que_thr_t*	thr2; */
 
 	heap = mem_heap_create(512);
 	fork = que_fork_create(NULL, NULL, QUE_FORK_PURGE, heap);
-	fork->trx = purge_sys->trx;
+	fork->trx = trx;
 
 	thr = que_thr_create(fork, heap);
 
 	thr->child = row_purge_node_create(thr, heap);
 
-	/*	thr2 = que_thr_create(fork, fork, heap);
+	return(fork);
+}
+
+/****************************************************************//**
+Gets the purge node of the nth purge query graph.
+@return	purge node */
+static
+purge_node_t*
+trx_purge_get_nth_node(
+/*===================*/
+	ulint	n)	/*!< in: graph number, < purge_sys->n_threads */
+{
+	que_thr_t*	thr;
 
-	thr2->child = row_purge_node_create(fork, thr2, heap);	 */
+	ut_ad(n < purge_sys->n_threads);
 
-	return(fork);
+	thr = UT_LIST_GET_FIRST(purge_sys->query[n]->thrs);
+
+	return(thr->child);
 }
 
 /********************************************************************//**
@@ -227,7 +145,9 @@ trx_purge_sys_create(
 /*=================*/
 	ib_bh_t*	ib_bh)	/*!< in, own: UNDO log min binary heap */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ulint	i;
+
+	ut_ad(trx_sys_mutex_own());
 
 	purge_sys = mem_zalloc(sizeof(trx_purge_t));
 
@@ -236,12 +156,16 @@ trx_purge_sys_create(
 	purge_sys->state = TRX_STOP_PURGE;
 
 	purge_sys->n_pages_handled = 0;
+	purge_sys->n_worker_recs = 0;
 
 	purge_sys->purge_trx_no = 0;
 	purge_sys->purge_undo_no = 0;
 	purge_sys->next_stored = FALSE;
 	ut_d(purge_sys->done_trx_no = 0);
 
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+	purge_sys->undo_trunc_last = 0;
+
 	rw_lock_create(trx_purge_latch_key,
 		       &purge_sys->latch, SYNC_PURGE_LATCH);
 
@@ -249,22 +173,38 @@ trx_purge_sys_create(
 		purge_sys_bh_mutex_key, &purge_sys->bh_mutex,
 		SYNC_PURGE_QUEUE);
 
-	purge_sys->heap = mem_heap_create(256);
+	purge_sys->batch_heap = mem_heap_create(4096);
+
+	purge_sys->event = os_event_create(NULL);
 
-	purge_sys->arr = trx_undo_arr_create();
+	/* Every purge thread runs its own query graph, with its own
+	purge transaction. With srv_n_purge_threads == 0 the master
+	thread runs the only graph. */
 
-	purge_sys->sess = sess_open();
+	purge_sys->n_threads = ut_max(srv_n_purge_threads, 1);
 
-	purge_sys->trx = purge_sys->sess->trx;
+	purge_sys->sess = mem_zalloc(
+		purge_sys->n_threads * sizeof(*purge_sys->sess));
+	purge_sys->query = mem_zalloc(
+		purge_sys->n_threads * sizeof(*purge_sys->query));
 
-	purge_sys->trx->is_purge = 1;
+	for (i = 0; i < purge_sys->n_threads; i++) {
+		trx_t*	trx;
 
-	ut_a(trx_start_low(purge_sys->trx, ULINT_UNDEFINED));
+		purge_sys->sess[i] = sess_open();
 
-	purge_sys->query = trx_purge_graph_build();
+		trx = purge_sys->sess[i]->trx;
 
-	purge_sys->view = read_view_oldest_copy_or_open_new(0,
-							    purge_sys->heap);
+		trx->is_purge = 1;
+
+		ut_a(trx_start_low(trx, ULINT_UNDEFINED));
+
+		purge_sys->query[i] = trx_purge_graph_build(trx);
+	}
+
+	purge_sys->trx = purge_sys->sess[0]->trx;
+
+	purge_sys->view = read_view_oldest_copy_or_open_new(0, NULL);
 }
 
 /************************************************************************
@@ -274,32 +214,45 @@ void
 trx_purge_sys_close(void)
 /*======================*/
 {
-	ut_ad(!mutex_own(&kernel_mutex));
+	ulint	i;
+
+	ut_ad(!trx_sys_mutex_own());
 
-	que_graph_free(purge_sys->query);
+	for (i = 0; i < purge_sys->n_threads; i++) {
+		que_graph_free(purge_sys->query[i]);
 
-	ut_a(purge_sys->sess->trx->is_purge);
-	purge_sys->sess->trx->conc_state = TRX_NOT_STARTED;
-	sess_close(purge_sys->sess);
+		ut_a(purge_sys->sess[i]->trx->is_purge);
+		purge_sys->sess[i]->trx->conc_state = TRX_NOT_STARTED;
+		sess_close(purge_sys->sess[i]);
+	}
+
+	mem_free(purge_sys->query);
+	purge_sys->query = NULL;
+
+	mem_free(purge_sys->sess);
 	purge_sys->sess = NULL;
 
+	purge_sys->trx = NULL;
+
 	if (purge_sys->view != NULL) {
-		/* Because acquiring the kernel mutex is a pre-condition
+		/* Because acquiring the trx_sys mutex is a pre-condition
 		of read_view_close(). We don't really need it here. */
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 
 		read_view_close(purge_sys->view);
-		purge_sys->view = NULL;
 
-		mutex_exit(&kernel_mutex);
-	}
+		trx_sys_mutex_exit();
 
-	trx_undo_arr_free(purge_sys->arr);
+		read_view_free(purge_sys->view);
+		purge_sys->view = NULL;
+	}
 
 	rw_lock_free(&purge_sys->latch);
 	mutex_free(&purge_sys->bh_mutex);
 
-	mem_heap_free(purge_sys->heap);
+	os_event_free(purge_sys->event);
+
+	mem_heap_free(purge_sys->batch_heap);
 
 	ib_bh_free(purge_sys->ib_bh);
 
@@ -393,9 +346,9 @@ trx_purge_add_update_undo_to_history(
 		the rseg exists. */
 	}
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 	trx_sys->rseg_history_len++;
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	if (!(trx_sys->rseg_history_len % srv_purge_batch_size)) {
 		/* Inform the purge thread that there is work to do. */
@@ -475,10 +428,10 @@ loop:
 	flst_cut_end(rseg_hdr + TRX_RSEG_HISTORY,
 		     log_hdr + TRX_UNDO_HISTORY_NODE, n_removed_logs, &mtr);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 	ut_ad(trx_sys->rseg_history_len >= n_removed_logs);
 	trx_sys->rseg_history_len -= n_removed_logs;
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	freed = FALSE;
 
@@ -563,10 +516,10 @@ loop:
 						limit_undo_no);
 		}
 
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 		ut_a(trx_sys->rseg_history_len >= n_removed_logs);
 		trx_sys->rseg_history_len -= n_removed_logs;
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		flst_truncate_end(rseg_hdr + TRX_RSEG_HISTORY,
 				  log_hdr + TRX_UNDO_HISTORY_NODE,
@@ -611,9 +564,359 @@ loop:
 	goto loop;
 }
 
+/********************************************************************//**
+Builds the path of the log file that is kept while an undo tablespace
+is being truncated. */
+static
+void
+trx_purge_undo_trunc_log_name(
+/*==========================*/
+	char*	name,		/*!< out: path of the log file */
+	ulint	size,		/*!< in: size of name */
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	srv_undo_file_path(name, size, space_id, "_trunc.log");
+}
+
+/********************************************************************//**
+Checks if the truncation of an undo tablespace was interrupted, by
+looking for the log file that is kept while the truncation runs.
+@return	TRUE if the truncation of the tablespace must be completed */
+UNIV_INTERN
+ibool
+trx_purge_undo_trunc_log_exists(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	ibool		exists;
+	os_file_type_t	type;
+
+	trx_purge_undo_trunc_log_name(name, sizeof name, space_id);
+
+	return(os_file_status(name, &exists, &type) && exists);
+}
+
+/********************************************************************//**
+Creates the log file that is kept while an undo tablespace is being
+truncated. The file is empty: its existence is the log record.
+@return	TRUE on success */
+static
+ibool
+trx_purge_undo_trunc_log_create(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	os_file_t	handle;
+	ibool		success;
+
+	trx_purge_undo_trunc_log_name(name, sizeof name, space_id);
+
+	handle = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, name, OS_FILE_CREATE,
+		OS_FILE_READ_WRITE, &success);
+
+	if (!success) {
+		os_file_get_last_error(TRUE);
+
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			" InnoDB: Error: cannot create %s,"
+			" undo tablespace %lu is not truncated\n",
+			name, (ulong) space_id);
+
+		return(FALSE);
+	}
+
+	success = os_file_flush(handle);
+
+	os_file_close(handle);
+
+	return(success);
+}
+
+/********************************************************************//**
+Sets or clears the flag that keeps the rollback segments of an undo
+tablespace from being assigned to new transactions. */
+static
+void
+trx_purge_mark_undo_space(
+/*======================*/
+	ulint	space_id,	/*!< in: undo tablespace id */
+	ibool	skip)		/*!< in: TRUE to stop assigning the
+				rollback segments of the tablespace */
+{
+	trx_rseg_t*	rseg;
+
+	trx_sys_mutex_enter();
+
+	for (rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
+	     rseg != NULL;
+	     rseg = UT_LIST_GET_NEXT(rseg_list, rseg)) {
+
+		if (rseg->space == space_id) {
+			rseg->skip_allocation = skip;
+		}
+	}
+
+	trx_sys_mutex_exit();
+}
+
+/********************************************************************//**
+Truncates an undo tablespace to its initial size and recreates the
+headers of its rollback segments, which must not be used by any
+transaction and must have no history left. A log file is kept while
+the truncation runs, so that it is completed at the next startup if
+the server is killed in between. The rollback segments of the tablespace
+are assigned to new transactions again when it returns TRUE.
+@return	TRUE if the tablespace was truncated */
+UNIV_INTERN
+ibool
+trx_purge_truncate_undo_space(
+/*==========================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	trx_rseg_t*	rseg;
+	mtr_t		mtr;
+	ulint		old_size;
+	ulint		size;
+	ulint		history_len = 0;
+
+	ut_a(space_id != TRX_SYS_SPACE);
+
+	old_size = fil_space_get_size(space_id);
+
+	/* The purged undo logs that are still in the history lists,
+	such as the last log of a cached undo segment, are discarded
+	with the rollback segment headers. */
+	for (rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
+	     rseg != NULL;
+	     rseg = UT_LIST_GET_NEXT(rseg_list, rseg)) {
+
+		if (rseg->space == space_id) {
+			mtr_start(&mtr);
+
+			history_len += flst_get_len(
+				trx_rsegf_get(rseg->space, rseg->zip_size,
+					      rseg->page_no, &mtr)
+				+ TRX_RSEG_HISTORY, &mtr);
+
+			mtr_commit(&mtr);
+		}
+	}
+
+	/* Write all the changes to the data files first, so that a
+	crash recovery does not apply redo log to the pages that are
+	discarded below. */
+	log_make_checkpoint_at(IB_ULONGLONG_MAX, TRUE);
+
+	if (!trx_purge_undo_trunc_log_exists(space_id)
+	    && !trx_purge_undo_trunc_log_create(space_id)) {
+
+		return(FALSE);
+	}
+
+	/* No page of the tablespace is in use any more, and the
+	checkpoint above wrote out all the modified ones. */
+	buf_LRU_flush_or_remove_pages(space_id, BUF_REMOVE_ALL_NO_WRITE);
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_before_truncate", DBUG_SUICIDE(););
+
+	if (!fil_truncate_tablespace(space_id,
+				     SRV_UNDO_TABLESPACE_SIZE_IN_PAGES)) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			" InnoDB: Warning: cannot shrink undo tablespace"
+			" %lu, it is only emptied\n", (ulong) space_id);
+	}
+
+	size = fil_space_get_size(space_id);
+
+	mtr_start(&mtr);
+
+	fsp_header_init(space_id, size, &mtr);
+
+	mtr_commit(&mtr);
+
+	for (rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
+	     rseg != NULL;
+	     rseg = UT_LIST_GET_NEXT(rseg_list, rseg)) {
+
+		if (rseg->space == space_id) {
+			trx_rseg_reinit(rseg);
+		}
+	}
+
+	trx_sys_mutex_enter();
+	ut_a(trx_sys->rseg_history_len >= history_len);
+	trx_sys->rseg_history_len -= history_len;
+	trx_sys_mutex_exit();
+
+	/* The recreated tablespace must be durable before the log
+	file is removed. */
+	log_make_checkpoint_at(IB_ULONGLONG_MAX, TRUE);
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_before_trunc_log_delete",
+			DBUG_SUICIDE(););
+
+	trx_purge_undo_trunc_log_name(name, sizeof name, space_id);
+
+	os_file_delete_if_exists(name);
+
+	trx_purge_mark_undo_space(space_id, FALSE);
+
+	ut_print_timestamp(stderr);
+	fprintf(stderr,
+		" InnoDB: Truncated undo tablespace %lu"
+		" from %lu to %lu pages\n",
+		(ulong) space_id, (ulong) old_size, (ulong) size);
+
+	return(TRUE);
+}
+
+/********************************************************************//**
+Checks if no transaction uses the rollback segments of an undo tablespace
+any more and purge has processed all their history. The last undo log of
+a rollback segment can stay in the history list after it was purged, if
+its undo segment was cached for reuse.
+@return	TRUE if the tablespace can be truncated */
+static
+ibool
+trx_purge_undo_space_is_free(
+/*=========================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	trx_rseg_t*	rseg;
+	const trx_t*	trx;
+	ibool		is_free = TRUE;
+
+	/* Transactions that were assigned one of the rollback
+	segments before they were marked may still be writing undo
+	logs to them. */
+	trx_sys_mutex_enter();
+
+	for (trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	     trx != NULL && is_free;
+	     trx = UT_LIST_GET_NEXT(trx_list, trx)) {
+
+		if (trx->rseg != NULL && trx->rseg->space == space_id) {
+			is_free = FALSE;
+		}
+	}
+
+	trx_sys_mutex_exit();
+
+	for (rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
+	     rseg != NULL && is_free;
+	     rseg = UT_LIST_GET_NEXT(rseg_list, rseg)) {
+
+		if (rseg->space != space_id) {
+			continue;
+		}
+
+		mutex_enter(&rseg->mutex);
+
+		/* rseg->last_page_no is FIL_NULL once purge has handled
+		every undo log in the history of the rollback segment. */
+		if (UT_LIST_GET_LEN(rseg->update_undo_list) > 0
+		    || UT_LIST_GET_LEN(rseg->insert_undo_list) > 0
+		    || rseg->last_page_no != FIL_NULL) {
+
+			is_free = FALSE;
+		}
+
+		mutex_exit(&rseg->mutex);
+	}
+
+	return(is_free);
+}
+
+/********************************************************************//**
+Looks for an undo tablespace that has grown beyond innodb_max_undo_log_size,
+starting after the one that was truncated last.
+@return	undo tablespace id, or ULINT_UNDEFINED if there is none or undo
+tablespaces are not truncated */
+static
+ulint
+trx_purge_find_undo_space_to_truncate(void)
+/*=======================================*/
+{
+	ulint	i;
+
+	/* Keep at least one undo tablespace available for new
+	transactions. */
+	if (!srv_undo_log_truncate || srv_undo_tablespaces_open < 2) {
+
+		return(ULINT_UNDEFINED);
+	}
+
+	for (i = 0; i < srv_undo_tablespaces_open; i++) {
+		ulint	id;
+
+		id = 1 + (purge_sys->undo_trunc_last + i)
+			% srv_undo_tablespaces_open;
+
+		if ((ib_uint64_t) fil_space_get_size(id)
+		    * UNIV_PAGE_SIZE > srv_max_undo_log_size) {
+
+			return(id);
+		}
+	}
+
+	return(ULINT_UNDEFINED);
+}
+
+/********************************************************************//**
+Truncates an undo tablespace that has grown beyond innodb_max_undo_log_size.
+The tablespace is first marked, so that its rollback segments are not
+assigned to new transactions; it is truncated by a later call, once the
+transactions that use it have completed and purge has removed their
+history. */
+static
+void
+trx_purge_truncate_undo_spaces(void)
+/*================================*/
+{
+	ulint	space_id = purge_sys->undo_trunc_space;
+
+	if (space_id == ULINT_UNDEFINED) {
+
+		space_id = trx_purge_find_undo_space_to_truncate();
+
+		if (space_id == ULINT_UNDEFINED) {
+
+			return;
+		}
+
+		purge_sys->undo_trunc_space = space_id;
+		purge_sys->undo_trunc_last = space_id;
+
+		trx_purge_mark_undo_space(space_id, TRUE);
+
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			" InnoDB: Undo tablespace %lu is marked"
+			" for truncation\n", (ulong) space_id);
+	}
+
+	if (!trx_purge_undo_space_is_free(space_id)) {
+
+		return;
+	}
+
+	if (!trx_purge_truncate_undo_space(space_id)) {
+		trx_purge_mark_undo_space(space_id, FALSE);
+	}
+
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+}
+
 /********************************************************************//**
 Removes unnecessary history data from rollback segments. NOTE that when this
-function is called, the caller must not have any latches on undo log pages! */
+function is called, the caller must not have any latches on undo log pages,
+and all undo log records fetched by the purge must have been processed! */
 static
 void
 trx_purge_truncate_history(void)
@@ -623,14 +926,8 @@ trx_purge_truncate_history(void)
 	trx_id_t	limit_trx_no;
 	undo_no_t	limit_undo_no;
 
-	trx_purge_arr_get_biggest(
-		purge_sys->arr, &limit_trx_no, &limit_undo_no);
-
-	if (limit_trx_no == 0) {
-
-		limit_trx_no = purge_sys->purge_trx_no;
-		limit_undo_no = purge_sys->purge_undo_no;
-	}
+	limit_trx_no = purge_sys->purge_trx_no;
+	limit_undo_no = purge_sys->purge_undo_no;
 
 	/* We play safe and set the truncate limit at most to the purge view
 	low_limit number, though this is not necessary */
@@ -649,25 +946,33 @@ trx_purge_truncate_history(void)
 		trx_purge_truncate_rseg_history(
 			rseg, limit_trx_no, limit_undo_no);
 	}
+
+	if (srv_undo_tablespaces_open > 0) {
+		trx_purge_truncate_undo_spaces();
+	}
 }
 
 /********************************************************************//**
-Does a truncate if the purge array is empty. NOTE that when this function is
-called, the caller must not have any latches on undo log pages! */
+Truncates the history every TRX_SYS_N_RSEGS purge batches, and after every
+batch while an undo tablespace is waiting to be truncated, so that its
+history is removed without delay. This must be called after a batch has
+completed, when no undo log records fetched by the purge are being
+processed. NOTE that when this function is called, the caller must not
+have any latches on undo log pages! */
 UNIV_INLINE
 void
-trx_purge_truncate_if_arr_empty(void)
-/*=================================*/
+trx_purge_truncate(void)
+/*====================*/
 {
 	static ulint	count;
 
-#ifdef UNIV_DEBUG
-	if (purge_sys->arr->n_used == 0) {
-		purge_sys->done_trx_no = purge_sys->purge_trx_no;
-	}
-#endif /* UNIV_DEBUG */
+	ut_d(purge_sys->done_trx_no = purge_sys->purge_trx_no);
 
-	if (!(++count % TRX_SYS_N_RSEGS) && purge_sys->arr->n_used == 0) {
+	if (!(++count % TRX_SYS_N_RSEGS)
+	    || (srv_undo_tablespaces_open > 0
+		&& (purge_sys->undo_trunc_space != ULINT_UNDEFINED
+		    || trx_purge_find_undo_space_to_truncate()
+		    != ULINT_UNDEFINED))) {
 
 		trx_purge_truncate_history();
 	}
@@ -721,7 +1026,7 @@ trx_purge_rseg_get_next_history_log(
 		mutex_exit(&(rseg->mutex));
 		mtr_commit(&mtr);
 
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 
 		/* Add debug code to track history list corruption reported
 		on the MySQL mailing list on Nov 9, 2004. The fut0lst.c
@@ -744,7 +1049,7 @@ trx_purge_rseg_get_next_history_log(
 			ut_ad(0);
 		}
 
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		return;
 	}
@@ -831,10 +1136,6 @@ trx_purge_get_rseg_with_min_trx_id(
 
 	ut_a(purge_sys->rseg->last_page_no != FIL_NULL);
 
-	/* We assume in purge of externally stored fields
-	that space id == 0 */
-	ut_a(purge_sys->rseg->space == 0);
-
 	zip_size = purge_sys->rseg->zip_size;
 
 	ut_a(purge_sys->purge_trx_no <= purge_sys->rseg->last_trx_no);
@@ -873,7 +1174,7 @@ trx_purge_read_undo_rec(
 		mtr_start(&mtr);
 
 		undo_rec = trx_undo_get_first_rec(
-			0 /* System space id */, zip_size,
+			purge_sys->rseg->space, zip_size,
 			purge_sys->hdr_page_no,
 			purge_sys->hdr_offset, RW_S_LATCH, &mtr);
 
@@ -1040,24 +1341,17 @@ trx_purge_get_next_rec(
 }
 
 /********************************************************************//**
-Fetches the next undo log record from the history list to purge. It must be
-released with the corresponding release function.
+Fetches the next undo log record from the history list to purge.
 @return copy of an undo log record or pointer to trx_purge_dummy_rec,
 if the whole undo log can skipped in purge; NULL if none left */
-UNIV_INTERN
+static
 trx_undo_rec_t*
 trx_purge_fetch_next_rec(
 /*=====================*/
 	roll_ptr_t*	roll_ptr,/*!< out: roll pointer to undo record */
-	trx_undo_inf_t** cell,	/*!< out: storage cell for the record in the
-				purge array */
 	mem_heap_t*	heap)	/*!< in: memory heap where copied */
 {
-	trx_undo_rec_t*	undo_rec;
-
-
 	if (purge_sys->state == TRX_STOP_PURGE) {
-		trx_purge_truncate_if_arr_empty();
 
 		return(NULL);
 	} else if (!purge_sys->next_stored) {
@@ -1066,8 +1360,6 @@ trx_purge_fetch_next_rec(
 		if (!purge_sys->next_stored) {
 			purge_sys->state = TRX_STOP_PURGE;
 
-			trx_purge_truncate_if_arr_empty();
-
 			if (srv_print_thread_releases) {
 				fprintf(stderr,
 					"Purge: No logs left in the"
@@ -1083,80 +1375,149 @@ trx_purge_fetch_next_rec(
 
 		purge_sys->state = TRX_STOP_PURGE;
 
-		trx_purge_truncate_if_arr_empty();
-
 		return(NULL);
 	} else if (purge_sys->purge_trx_no >= purge_sys->view->low_limit_no) {
 		purge_sys->state = TRX_STOP_PURGE;
 
-		trx_purge_truncate_if_arr_empty();
-
 		return(NULL);
 	}
 
-	/* fprintf(stderr, "Thread %lu purging trx %llu undo record %llu\n",
-	os_thread_get_curr_id(),
-	(ullint) purge_sys->purge_trx_no,
-	(ullint) purge_sys->purge_undo_no); */
-
-
 	*roll_ptr = trx_undo_build_roll_ptr(
 		FALSE, (purge_sys->rseg)->id, purge_sys->page_no,
 		purge_sys->offset);
 
-	*cell = trx_purge_arr_store_info(
-		purge_sys->purge_trx_no, purge_sys->purge_undo_no);
-
 	ut_ad(purge_sys->purge_trx_no < purge_sys->view->low_limit_no);
 
 	/* The following call will advance the stored values of purge_trx_no
-	and purge_undo_no, therefore we had to store them first */
+	and purge_undo_no */
+
+	return(trx_purge_get_next_rec(heap));
+}
+
+/********************************************************************//**
+Fetches the undo log records of the next purge batch and distributes them
+to the purge query graphs. The records of a table are always assigned to
+the same graph, so that they are purged in the order they were fetched.
+@return	number of undo log records in the batch */
+static
+ulint
+trx_purge_attach_undo_recs(
+/*=======================*/
+	ulint	limit)	/*!< in: the maximum number of undo log pages to
+			handle in the batch */
+{
+	ulint	i;
+	ulint	n_recs = 0;
+
+	purge_sys->state = TRX_PURGE_ON;
+
+	purge_sys->handle_limit = purge_sys->n_pages_handled + limit;
+
+	mem_heap_empty(purge_sys->batch_heap);
+
+	for (i = 0; i < purge_sys->n_threads; i++) {
+		purge_node_t*	node = trx_purge_get_nth_node(i);
+
+		node->undo_recs = ib_vector_create(purge_sys->batch_heap, 64);
+		node->next_rec = 0;
+	}
+
+	for (;;) {
+		trx_purge_rec_t*	purge_rec;
+
+		purge_rec = mem_heap_alloc(
+			purge_sys->batch_heap, sizeof(*purge_rec));
 
-	undo_rec = trx_purge_get_next_rec(heap);
+		purge_rec->undo_rec = trx_purge_fetch_next_rec(
+			&purge_rec->roll_ptr, purge_sys->batch_heap);
 
-	return(undo_rec);
+		if (purge_rec->undo_rec == NULL) {
+			break;
+		}
+
+		i = 0;
+
+		if (purge_rec->undo_rec != &trx_purge_dummy_rec) {
+			ulint		type;
+			ulint		cmpl_info;
+			ibool		updated_extern;
+			undo_no_t	undo_no;
+			table_id_t	table_id;
+
+			trx_undo_rec_get_pars(
+				purge_rec->undo_rec, &type, &cmpl_info,
+				&updated_extern, &undo_no, &table_id);
+
+			i = (ulint) (table_id % purge_sys->n_threads);
+		}
+
+		ib_vector_push(trx_purge_get_nth_node(i)->undo_recs,
+			       purge_rec);
+
+		++n_recs;
+	}
+
+	return(n_recs);
 }
 
 /*******************************************************************//**
-Releases a reserved purge undo record. */
+Called by a purge worker thread when it has executed a purge query
+thread of the current batch. */
 UNIV_INTERN
 void
-trx_purge_rec_release(
-/*==================*/
-	trx_undo_inf_t*	cell)	/*!< in: storage cell */
+trx_purge_worker_done(void)
+/*=======================*/
 {
-	trx_purge_arr_remove_info(cell);
+	mutex_enter(&kernel_mutex);
+
+	++purge_sys->n_completed;
+
+	ut_ad(purge_sys->n_completed <= purge_sys->n_submitted);
+
+	if (purge_sys->n_completed == purge_sys->n_submitted) {
+		os_event_set(purge_sys->event);
+	}
+
+	mutex_exit(&kernel_mutex);
 }
 
 /*******************************************************************//**
-This function runs a purge batch.
-@return	number of undo log pages handled in the batch */
-UNIV_INTERN
-ulint
-trx_purge(
-/*======*/
-	ulint	limit)		/*!< in: the maximum number of records to
-				purge in one batch */
+Waits until the purge worker threads have executed all the purge query
+threads submitted in the current batch. */
+static
+void
+trx_purge_wait_for_workers_to_complete(void)
+/*========================================*/
 {
-	que_thr_t*	thr;
-	ulint		old_pages_handled;
+	mutex_enter(&kernel_mutex);
 
-	ut_a(purge_sys->trx->n_active_thrs == 0);
+	while (purge_sys->n_completed < purge_sys->n_submitted) {
+		ib_int64_t	sig_count;
 
-	rw_lock_x_lock(&purge_sys->latch);
+		sig_count = os_event_reset(purge_sys->event);
 
-	mutex_enter(&kernel_mutex);
+		mutex_exit(&kernel_mutex);
 
-	/* Close and free the old purge view */
+		os_event_wait_low(purge_sys->event, sig_count);
 
-	read_view_close(purge_sys->view);
-	purge_sys->view = NULL;
-	mem_heap_empty(purge_sys->heap);
+		mutex_enter(&kernel_mutex);
+	}
 
-	/* Determine how much data manipulation language (DML) statements
-	need to be delayed in order to reduce the lagging of the purge
-	thread. */
-	srv_dml_needed_delay = 0; /* in microseconds; default: no delay */
+	mutex_exit(&kernel_mutex);
+}
+
+/*******************************************************************//**
+Calculates the delay of data manipulation language (DML) statements
+needed to reduce the lagging of the purge.
+@return	delay in microseconds */
+static
+ulint
+trx_purge_dml_delay(void)
+/*=====================*/
+{
+	ulint	delay = 0; /* in microseconds; default: no delay */
+
+	ut_ad(trx_sys_mutex_own());
 
 	/* If we cannot advance the 'purge view' because of an old
 	'consistent read view', then the DML statements cannot be delayed.
@@ -1167,20 +1528,58 @@ trx_purge(
 			/ srv_max_purge_lag;
 		if (ratio > ULINT_MAX / 10000) {
 			/* Avoid overflow: maximum delay is 4295 seconds */
-			srv_dml_needed_delay = ULINT_MAX;
+			delay = ULINT_MAX;
 		} else if (ratio > 1) {
 			/* If the history list length exceeds the
 			innodb_max_purge_lag, the
 			data manipulation statements are delayed
 			by at least 5000 microseconds. */
-			srv_dml_needed_delay = (ulint) ((ratio - .5) * 10000);
+			delay = (ulint) ((ratio - .5) * 10000);
+		}
+
+		if (srv_max_purge_lag_delay > 0
+		    && delay > srv_max_purge_lag_delay) {
+			delay = srv_max_purge_lag_delay;
 		}
 	}
 
+	return(delay);
+}
+
+/*******************************************************************//**
+This function runs a purge batch. The undo log records of the batch are
+fetched by the calling thread, and split by table between the calling
+thread and the purge worker threads, which purge them in parallel.
+@return	number of undo log pages handled in the batch */
+UNIV_INTERN
+ulint
+trx_purge(
+/*======*/
+	ulint	limit)		/*!< in: the maximum number of undo log
+				pages to purge in one batch */
+{
+	que_thr_t*	thr;
+	que_thr_t*	worker_thrs[SRV_MAX_N_PURGE_THREADS];
+	ulint		n_submitted;
+	ulint		old_pages_handled;
+	ulint		i;
+
+	ut_a(purge_sys->trx->n_active_thrs == 0);
+
+	rw_lock_x_lock(&purge_sys->latch);
+
+	trx_sys_mutex_enter();
+
+	/* Close the old purge view and reuse its memory for the new one */
+
+	read_view_close(purge_sys->view);
+
+	srv_dml_needed_delay = trx_purge_dml_delay();
+
 	purge_sys->view = read_view_oldest_copy_or_open_new(
-		0, purge_sys->heap);
+		0, purge_sys->view);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	rw_lock_x_unlock(&(purge_sys->latch));
 
@@ -1190,21 +1589,60 @@ trx_purge(
 	}
 #endif
 
-	purge_sys->state = TRX_PURGE_ON;
+	old_pages_handled = purge_sys->n_pages_handled;
 
-	purge_sys->handle_limit = purge_sys->n_pages_handled + limit;
+	trx_purge_attach_undo_recs(limit);
 
-	old_pages_handled = purge_sys->n_pages_handled;
+	/* Start the graphs of the purge worker threads that got work in
+	this batch. The query thread state is protected by the mutex of
+	the transaction of each graph. */
 
+	n_submitted = 0;
 
-	mutex_enter(&kernel_mutex);
+	for (i = 1; i < purge_sys->n_threads; i++) {
+		trx_t*	trx;
+
+		if (ib_vector_is_empty(trx_purge_get_nth_node(i)->undo_recs)) {
+			continue;
+		}
+
+		trx = purge_sys->query[i]->trx;
+
+		trx_mutex_enter(trx);
+
+		thr = que_fork_start_command(purge_sys->query[i]);
+
+		trx_mutex_exit(trx);
+
+		ut_ad(thr);
+
+		worker_thrs[n_submitted++] = thr;
+	}
 
-	thr = que_fork_start_command(purge_sys->query);
+	trx_mutex_enter(purge_sys->trx);
+
+	thr = que_fork_start_command(purge_sys->query[0]);
+
+	trx_mutex_exit(purge_sys->trx);
 
 	ut_ad(thr);
 
+	/* The batch counters are protected by the kernel mutex, which
+	trx_purge_worker_done() acquires. The worker graphs are enqueued
+	after releasing it, because srv_que_task_enqueue_low() acquires
+	it too. */
+
+	mutex_enter(&kernel_mutex);
+
+	purge_sys->n_submitted = n_submitted;
+	purge_sys->n_completed = 0;
+
 	mutex_exit(&kernel_mutex);
 
+	for (i = 0; i < n_submitted; i++) {
+		srv_que_task_enqueue_low(worker_thrs[i]);
+	}
+
 	if (srv_print_thread_releases) {
 
 		fputs("Starting purge\n", stderr);
@@ -1212,6 +1650,15 @@ trx_purge(
 
 	que_run_threads(thr);
 
+	trx_purge_wait_for_workers_to_complete();
+
+	for (i = 1; i < purge_sys->n_threads; i++) {
+		purge_sys->n_worker_recs += ib_vector_size(
+			trx_purge_get_nth_node(i)->undo_recs);
+	}
+
+	trx_purge_truncate();
+
 	if (srv_print_thread_releases) {
 
 		fprintf(stderr,
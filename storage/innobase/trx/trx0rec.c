@@ -1227,6 +1227,10 @@ trx_undo_report_row_operation(
 	trx = thr_get_trx(thr);
 	rseg = trx->rseg;
 
+	/* A read-only transaction must have been made read-write by
+	lock_table() before it modifies anything. */
+	ut_ad(!trx->read_only);
+
 	mutex_enter(&(trx->undo_mutex));
 
 	/* If the undo log is not assigned yet, assign one */
@@ -96,18 +96,18 @@ trx_general_rollback_for_mysql(
 	ut_a(thr == que_fork_start_command(que_node_get_parent(thr)));
 	que_run_threads(thr);
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(trx);
 
 	while (trx->que_state != TRX_QUE_RUNNING) {
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
 
 		os_thread_sleep(100000);
 
-		mutex_enter(&kernel_mutex);
+		trx_mutex_enter(trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 
 	mem_heap_free(heap);
 
@@ -436,7 +436,7 @@ trx_rollback_active(
 	thr->child = roll_node;
 	roll_node->common.parent = thr;
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(trx);
 
 	trx->graph = fork;
 
@@ -458,7 +458,7 @@ trx_rollback_active(
 		" rows to undo\n",
 		(ullint) trx->id,
 		(ulong) rows_to_undo, unit);
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 
 	if (trx_get_dict_operation(trx) != TRX_DICT_OP_NONE) {
 		row_mysql_lock_data_dictionary(trx);
@@ -467,11 +467,11 @@ trx_rollback_active(
 
 	que_run_threads(thr);
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(trx);
 
 	while (trx->que_state != TRX_QUE_RUNNING) {
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
 
 		fprintf(stderr,
 			"InnoDB: Waiting for rollback of trx id "
@@ -479,10 +479,10 @@ trx_rollback_active(
 			(ullint) trx->id);
 		os_thread_sleep(100000);
 
-		mutex_enter(&kernel_mutex);
+		trx_mutex_enter(trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 
 	if (trx_get_dict_operation(trx) != TRX_DICT_OP_NONE
 	    && trx->table_id != 0) {
@@ -537,7 +537,7 @@ trx_rollback_or_clean_recovered(
 {
 	trx_t*	trx;
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	if (!UT_LIST_GET_FIRST(trx_sys->trx_list)) {
 		goto leave_function;
@@ -549,10 +549,10 @@ trx_rollback_or_clean_recovered(
 			" of uncommitted transactions\n");
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 loop:
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	for (trx = UT_LIST_GET_FIRST(trx_sys->trx_list); trx;
 	     trx = UT_LIST_GET_NEXT(trx_list, trx)) {
@@ -566,7 +566,7 @@ loop:
 			continue;
 
 		case TRX_COMMITTED_IN_MEMORY:
-			mutex_exit(&kernel_mutex);
+			trx_sys_mutex_exit();
 			fprintf(stderr,
 				"InnoDB: Cleaning up trx with id "
 				TRX_ID_FMT "\n",
@@ -577,7 +577,7 @@ loop:
 		case TRX_ACTIVE:
 			if (all || trx_get_dict_operation(trx)
 			    != TRX_DICT_OP_NONE) {
-				mutex_exit(&kernel_mutex);
+				trx_sys_mutex_exit();
 				trx_rollback_active(trx);
 				goto loop;
 			}
@@ -592,7 +592,7 @@ loop:
 	}
 
 leave_function:
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 }
 
 /*******************************************************************//**
@@ -1074,7 +1074,7 @@ trx_rollback(
 	que_thr_t*	thr;
 	/*	que_thr_t*	thr2; */
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 	ut_ad((trx->undo_no_arr == NULL) || ((trx->undo_no_arr)->n_used == 0));
 
 	/* Initialize the rollback field in the transaction */
@@ -1142,7 +1142,7 @@ trx_roll_graph_build(
 	que_thr_t*	thr;
 	/*	que_thr_t*	thr2; */
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	heap = mem_heap_create(512);
 	fork = que_fork_create(NULL, NULL, QUE_FORK_ROLLBACK, heap);
@@ -1169,7 +1169,7 @@ trx_finish_error_processing(
 	trx_sig_t*	sig;
 	trx_sig_t*	next_sig;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	sig = UT_LIST_GET_FIRST(trx->signals);
 
@@ -1202,7 +1202,7 @@ trx_finish_partial_rollback_off_kernel(
 {
 	trx_sig_t*	sig;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	sig = UT_LIST_GET_FIRST(trx->signals);
 
@@ -1233,7 +1233,7 @@ trx_finish_rollback_off_kernel(
 	trx_sig_t*	sig;
 	trx_sig_t*	next_sig;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	ut_a(trx->undo_no_arr == NULL || trx->undo_no_arr->n_used == 0);
 
@@ -1325,7 +1325,9 @@ trx_rollback_step(
 	}
 
 	if (node->state == ROLL_NODE_SEND) {
-		mutex_enter(&kernel_mutex);
+		trx_t*	trx = thr_get_trx(thr);
+
+		trx_mutex_enter(trx);
 
 		node->state = ROLL_NODE_WAIT;
 
@@ -1339,12 +1341,12 @@ trx_rollback_step(
 
 		/* Send a rollback signal to the transaction */
 
-		trx_sig_send(thr_get_trx(thr), sig_no, TRX_SIG_SELF, thr,
+		trx_sig_send(trx, sig_no, TRX_SIG_SELF, thr,
 			     savept, NULL);
 
 		thr->state = QUE_THR_SIG_REPLY_WAIT;
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
 
 		return(NULL);
 	}
@@ -33,6 +33,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "fut0lst.h"
 #include "srv0srv.h"
 #include "trx0purge.h"
+#include "srv0start.h"
 
 #ifdef UNIV_PFS_MUTEX
 /* Key to register rseg_mutex_key with performance schema */
@@ -40,7 +41,10 @@ UNIV_INTERN mysql_pfs_key_t	rseg_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 /******************************************************************//**
-Looks for a rollback segment, based on the rollback segment id.
+Looks for a rollback segment, based on the rollback segment id. This does
+not need trx_sys->mutex: the slot of a rollback segment that a roll pointer
+refers to was set at startup, before any undo log in it was accessed, and
+it is not reset before shutdown.
 @return	rollback segment */
 UNIV_INTERN
 trx_rseg_t*
@@ -80,8 +84,8 @@ trx_rseg_header_create(
 	ulint		i;
 	buf_block_t*	block;
 
+	ut_ad(trx_sys_mutex_own());
 	ut_ad(mtr);
-	ut_ad(mutex_own(&kernel_mutex));
 	ut_ad(mtr_memo_contains(mtr, fil_space_get_latch(space, NULL),
 				MTR_MEMO_X_LOCK));
 
@@ -129,17 +133,15 @@ trx_rseg_header_create(
 }
 
 /***********************************************************************//**
-Free's an instance of the rollback segment in memory. */
-UNIV_INTERN
+Frees the undo log objects cached for reuse in a rollback segment. */
+static
 void
-trx_rseg_mem_free(
-/*==============*/
-	trx_rseg_t*	rseg)	/* in, own: instance to free */
+trx_rseg_free_cached_undos(
+/*=======================*/
+	trx_rseg_t*	rseg)	/*!< in/out: rollback segment */
 {
 	trx_undo_t*	undo;
 
-	mutex_free(&rseg->mutex);
-
 	/* There can't be any active transactions. */
 	ut_a(UT_LIST_GET_LEN(rseg->update_undo_list) == 0);
 	ut_a(UT_LIST_GET_LEN(rseg->insert_undo_list) == 0);
@@ -165,6 +167,19 @@ trx_rseg_mem_free(
 
 		trx_undo_mem_free(prev_undo);
 	}
+}
+
+/***********************************************************************//**
+Free's an instance of the rollback segment in memory. */
+UNIV_INTERN
+void
+trx_rseg_mem_free(
+/*==============*/
+	trx_rseg_t*	rseg)	/* in, own: instance to free */
+{
+	mutex_free(&rseg->mutex);
+
+	trx_rseg_free_cached_undos(rseg);
 
 	trx_sys_set_nth_rseg(trx_sys, rseg->id, NULL);
 
@@ -198,7 +213,7 @@ trx_rseg_mem_create(
 	trx_ulogf_t*	undo_log_hdr;
 	ulint		sum_of_undo_sizes;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	rseg = mem_zalloc(sizeof(trx_rseg_t));
 
@@ -213,6 +228,19 @@ trx_rseg_mem_create(
 
 	trx_sys_set_nth_rseg(trx_sys, id, rseg);
 
+	if (space == srv_undo_space_to_truncate) {
+		/* The truncation of the undo tablespace was interrupted
+		and the segment header may not be valid. The segment is
+		recreated empty when the truncation is completed at the
+		end of the startup, and it is not used before that. */
+		rseg->max_size = ULINT_MAX;
+		rseg->curr_size = 1;
+		rseg->last_page_no = FIL_NULL;
+		rseg->skip_allocation = TRUE;
+
+		return(rseg);
+	}
+
 	rseg_header = trx_rsegf_get_new(space, zip_size, page_no, mtr);
 
 	rseg->max_size = mtr_read_ulint(rseg_header + TRX_RSEG_MAX_SIZE,
@@ -308,8 +336,10 @@ Creates a rollback segment.
 @return pointer to new rollback segment if create successful */
 UNIV_INTERN
 trx_rseg_t*
-trx_rseg_create(void)
-/*=================*/
+trx_rseg_create(
+/*============*/
+	ulint	space)		/*!< in: space id of the segment header,
+				TRX_SYS_SPACE or an undo tablespace */
 {
 	mtr_t		mtr;
 	ulint		slot_no;
@@ -318,21 +348,20 @@ trx_rseg_create(void)
 	mtr_start(&mtr);
 
 	/* To obey the latching order, acquire the file space
-	x-latch before the kernel mutex. */
-	mtr_x_lock(fil_space_get_latch(TRX_SYS_SPACE, NULL), &mtr);
+	x-latch before the trx_sys mutex. */
+	mtr_x_lock(fil_space_get_latch(space, NULL), &mtr);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	slot_no = trx_sysf_rseg_find_free(&mtr);
 
 	if (slot_no != ULINT_UNDEFINED) {
-		ulint		space;
 		ulint		page_no;
 		ulint		zip_size;
 		trx_sysf_t*	sys_header;
 
 		page_no = trx_rseg_header_create(
-			TRX_SYS_SPACE, 0, ULINT_MAX, slot_no, &mtr);
+			space, 0, ULINT_MAX, slot_no, &mtr);
 
 		ut_a(page_no != FIL_NULL);
 
@@ -349,7 +378,7 @@ trx_rseg_create(void)
 			purge_sys->ib_bh, &mtr);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 	mtr_commit(&mtr);
 
 	return(rseg);
@@ -372,3 +401,108 @@ trx_rseg_list_and_array_init(
 	trx_rseg_create_instance(sys_header, ib_bh, mtr);
 }
 
+
+/*********************************************************************
+Recreates the header of a rollback segment in an undo tablespace that
+has just been truncated, and empties the memory object of the segment. */
+UNIV_INTERN
+void
+trx_rseg_reinit(
+/*============*/
+	trx_rseg_t*	rseg)		/*!< in/out: rollback segment that
+					is not used by any transaction */
+{
+	mtr_t		mtr;
+	ulint		page_no;
+
+	ut_a(rseg->space != TRX_SYS_SPACE);
+
+	mtr_start(&mtr);
+
+	mtr_x_lock(fil_space_get_latch(rseg->space, NULL), &mtr);
+
+	trx_sys_mutex_enter();
+
+	page_no = trx_rseg_header_create(
+		rseg->space, rseg->zip_size, rseg->max_size, rseg->id, &mtr);
+
+	ut_a(page_no != FIL_NULL);
+
+	trx_sys_mutex_exit();
+	mtr_commit(&mtr);
+
+	mutex_enter(&rseg->mutex);
+
+	trx_rseg_free_cached_undos(rseg);
+
+	rseg->page_no = page_no;
+	rseg->curr_size = 1;
+	rseg->last_page_no = FIL_NULL;
+	rseg->last_offset = 0;
+	rseg->last_trx_no = 0;
+	rseg->last_del_marks = FALSE;
+
+	mutex_exit(&rseg->mutex);
+}
+
+/*********************************************************************
+Reads the ids of the undo tablespaces that hold rollback segments from
+the trx system header.
+@return	number of undo tablespaces */
+UNIV_INTERN
+ulint
+trx_rseg_get_n_undo_tablespaces(
+/*============================*/
+	ulint*	space_ids)	/*!< out: ids of the undo tablespaces,
+				in ascending order; TRX_SYS_N_RSEGS
+				elements */
+{
+	ulint		i;
+	mtr_t		mtr;
+	trx_sysf_t*	sys_header;
+	ulint		n_undo_tablespaces = 0;
+
+	mtr_start(&mtr);
+
+	trx_sys_mutex_enter();
+
+	sys_header = trx_sysf_get(&mtr);
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		ulint	page_no;
+		ulint	space;
+		ulint	j;
+
+		page_no = trx_sysf_rseg_get_page_no(sys_header, i, &mtr);
+
+		if (page_no == FIL_NULL) {
+			continue;
+		}
+
+		space = trx_sysf_rseg_get_space(sys_header, i, &mtr);
+
+		if (space == TRX_SYS_SPACE) {
+			continue;
+		}
+
+		/* Keep the ids sorted and without duplicates. */
+		for (j = 0; j < n_undo_tablespaces && space_ids[j] < space;
+		     j++) {
+		}
+
+		if (j < n_undo_tablespaces && space_ids[j] == space) {
+			continue;
+		}
+
+		memmove(space_ids + j + 1, space_ids + j,
+			(n_undo_tablespaces - j) * sizeof *space_ids);
+
+		space_ids[j] = space;
+		n_undo_tablespaces++;
+	}
+
+	trx_sys_mutex_exit();
+	mtr_commit(&mtr);
+
+	return(n_undo_tablespaces);
+}
@@ -67,6 +67,12 @@ UNIV_INTERN ibool	trx_doublewrite_must_reset_space_ids	= FALSE;
 /** Set to TRUE when the doublewrite buffer is being created */
 UNIV_INTERN ibool	trx_doublewrite_buf_is_being_created = FALSE;
 
+/** The doublewrite file, opened by trx_doublewrite_file_create() before
+the doublewrite buffer is initialized */
+static os_file_t	trx_doublewrite_file;
+/** TRUE if trx_doublewrite_file is open */
+static ibool		trx_doublewrite_file_is_open	= FALSE;
+
 /** The following is TRUE when we are using the database in the
 post-4.1 format, i.e., we have successfully upgraded, or have created
 a new database installation */
@@ -132,6 +138,7 @@ static const ulint	FILE_FORMAT_NAME_N
 /* Key to register the mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	trx_doublewrite_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	file_format_max_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	trx_sys_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 #ifndef UNIV_HOTBACKUP
@@ -176,7 +183,109 @@ trx_doublewrite_page_inside(
 }
 
 /****************************************************************//**
-Creates or initialializes the doublewrite buffer at a database start. */
+Opens the doublewrite file (innodb_doublewrite_file), creating it if it
+does not exist, and extends it to hold a slot for each buffer pool
+instance and flush type after its header page. The header page is
+written by trx_doublewrite_init(), after a possible crash recovery has
+read the file. Must be called at a database startup before the
+doublewrite buffer is initialized.
+@return DB_SUCCESS or DB_ERROR */
+UNIV_INTERN
+ulint
+trx_doublewrite_file_create(void)
+/*=============================*/
+{
+	ib_int64_t	size;
+	ibool		success;
+
+	ut_a(srv_doublewrite_file);
+	ut_a(!trx_doublewrite_file_is_open);
+
+	trx_doublewrite_file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, srv_doublewrite_file,
+		OS_FILE_OPEN, OS_FILE_READ_WRITE, &success);
+
+	if (!success) {
+		trx_doublewrite_file = os_file_create_simple_no_error_handling(
+			innodb_file_data_key, srv_doublewrite_file,
+			OS_FILE_CREATE, OS_FILE_READ_WRITE, &success);
+	}
+
+	if (!success) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Error: cannot open or create"
+			" the doublewrite file %s\n",
+			srv_doublewrite_file);
+
+		return(DB_ERROR);
+	}
+
+	size = (ib_int64_t) (1 + 2 * srv_buf_pool_instances
+			     * TRX_DOUBLEWRITE_FILE_SLOT_SIZE)
+		* UNIV_PAGE_SIZE;
+
+	if (os_file_get_size_as_iblonglong(trx_doublewrite_file) < size
+	    && !os_file_set_size(srv_doublewrite_file, trx_doublewrite_file,
+				 (ulint) (size & 0xFFFFFFFFUL),
+				 (ulint) (size >> 32))) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			"  InnoDB: Error: cannot extend"
+			" the doublewrite file %s\n",
+			srv_doublewrite_file);
+
+		os_file_close(trx_doublewrite_file);
+
+		return(DB_ERROR);
+	}
+
+	trx_doublewrite_file_is_open = TRUE;
+
+	return(DB_SUCCESS);
+}
+
+/****************************************************************//**
+Writes the header page of the doublewrite file opened by
+trx_doublewrite_file_create(). */
+static
+void
+trx_doublewrite_file_write_header(
+/*==============================*/
+	ulint	n_pages)	/*!< in: number of pages in the slots */
+{
+	byte*		unaligned_buf;
+	byte*		buf;
+	ibool		success;
+
+	unaligned_buf = ut_malloc(2 * UNIV_PAGE_SIZE);
+	buf = ut_align(unaligned_buf, UNIV_PAGE_SIZE);
+
+	memset(buf, 0, UNIV_PAGE_SIZE);
+	mach_write_to_4(buf + TRX_DOUBLEWRITE_FILE_MAGIC,
+			TRX_SYS_DOUBLEWRITE_MAGIC_N);
+	mach_write_to_4(buf + TRX_DOUBLEWRITE_FILE_PAGE_SIZE, UNIV_PAGE_SIZE);
+	mach_write_to_4(buf + TRX_DOUBLEWRITE_FILE_N_PAGES, n_pages);
+
+	success = os_file_write(srv_doublewrite_file, trx_doublewrite->file,
+				buf, 0, 0, UNIV_PAGE_SIZE);
+	ut_a(success);
+	success = os_file_flush(trx_doublewrite->file);
+	ut_a(success);
+
+	ut_free(unaligned_buf);
+}
+
+/****************************************************************//**
+Creates or initialializes the doublewrite buffer at a database start.
+The buffer is divided into slots, one for each buffer pool instance and
+flush type, so that flush batches of different buffer pool instances
+and flush types can write and flush their pages concurrently. The slots
+are in the doublewrite file if innodb_doublewrite_file is set, else
+they share the two doublewrite blocks of the system tablespace. In the
+latter case the 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE pages are divided as
+evenly as possible: when the number of slots does not divide the number
+of pages, the first slots get one page more than the others. */
 static
 void
 trx_doublewrite_init(
@@ -184,7 +293,12 @@ trx_doublewrite_init(
 	byte*	doublewrite)	/*!< in: pointer to the doublewrite buf
 				header on trx sys page */
 {
-	trx_doublewrite = mem_alloc(sizeof(trx_doublewrite_t));
+	ulint	slot_size;
+	ulint	n_extra;
+	ulint	n_pages;
+	ulint	i;
+
+	trx_doublewrite = mem_zalloc(sizeof(trx_doublewrite_t));
 
 	/* Since we now start to use the doublewrite buffer, no need to call
 	fsync() after every write to a data file */
@@ -192,22 +306,138 @@ trx_doublewrite_init(
 	os_do_not_call_flush_at_each_write = TRUE;
 #endif /* UNIV_DO_FLUSH */
 
-	mutex_create(trx_doublewrite_mutex_key,
-		     &trx_doublewrite->mutex, SYNC_DOUBLEWRITE);
-
-	trx_doublewrite->first_free = 0;
-
 	trx_doublewrite->block1 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK1);
 	trx_doublewrite->block2 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK2);
-	trx_doublewrite->write_buf_unaligned = ut_malloc(
-		(1 + 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) * UNIV_PAGE_SIZE);
 
-	trx_doublewrite->write_buf = ut_align(
-		trx_doublewrite->write_buf_unaligned, UNIV_PAGE_SIZE);
+	if (srv_doublewrite_file && srv_use_doublewrite_buf) {
+		trx_doublewrite->use_file = TRUE;
+		trx_doublewrite->n_slots = 2 * srv_buf_pool_instances;
+		slot_size = TRX_DOUBLEWRITE_FILE_SLOT_SIZE;
+		n_extra = 0;
+		n_pages = trx_doublewrite->n_slots * slot_size;
+
+		/* The file was opened and extended at the startup by
+		trx_doublewrite_file_create() */
+		ut_a(trx_doublewrite_file_is_open);
+		trx_doublewrite->file = trx_doublewrite_file;
+		trx_doublewrite_file_is_open = FALSE;
+
+		trx_doublewrite_file_write_header(n_pages);
+	} else {
+		trx_doublewrite->n_slots = ut_min(
+			2 * srv_buf_pool_instances,
+			TRX_SYS_DOUBLEWRITE_MAX_SLOTS);
+		n_pages = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
+		slot_size = n_pages / trx_doublewrite->n_slots;
+		n_extra = n_pages % trx_doublewrite->n_slots;
+	}
+
+	trx_doublewrite->write_buf_unaligned = ut_malloc(
+		(1 + n_pages) * UNIV_PAGE_SIZE);
 	trx_doublewrite->buf_block_arr = mem_alloc(
-		2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * sizeof(void*));
+		n_pages * sizeof(void*));
+	trx_doublewrite->slots = mem_alloc(
+		trx_doublewrite->n_slots * sizeof(trx_doublewrite_slot_t));
+
+	for (i = 0; i < trx_doublewrite->n_slots; i++) {
+		trx_doublewrite_slot_t*	slot = &trx_doublewrite->slots[i];
+
+		mutex_create(trx_doublewrite_mutex_key,
+			     &slot->mutex, SYNC_DOUBLEWRITE);
+
+		slot->start = i * slot_size + ut_min(i, n_extra);
+		slot->n_pages = slot_size + (i < n_extra);
+		slot->first_free = 0;
+		slot->write_buf = (byte*) ut_align(
+			trx_doublewrite->write_buf_unaligned, UNIV_PAGE_SIZE)
+			+ slot->start * UNIV_PAGE_SIZE;
+		slot->buf_block_arr = trx_doublewrite->buf_block_arr
+			+ slot->start;
+	}
+}
+
+/****************************************************************//**
+Returns the doublewrite buffer slot that buffers the writes of a flush
+batch of the given type in the given buffer pool instance.
+@return doublewrite slot */
+UNIV_INTERN
+trx_doublewrite_slot_t*
+trx_doublewrite_get_slot(
+/*=====================*/
+	ulint		instance_no,	/*!< in: buffer pool instance */
+	enum buf_flush	flush_type)	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+{
+	ulint	i;
+
+	i = 2 * instance_no + (flush_type == BUF_FLUSH_LIST);
+
+	return(&trx_doublewrite->slots[i % trx_doublewrite->n_slots]);
+}
+
+/****************************************************************//**
+Writes the pages buffered in a doublewrite slot to the part of the
+doublewrite file or of the doublewrite blocks in the system tablespace
+reserved for the slot, and flushes them to disk. The caller must own
+slot->mutex. */
+UNIV_INTERN
+void
+trx_doublewrite_write_slot(
+/*=======================*/
+	trx_doublewrite_slot_t*	slot)	/*!< in: doublewrite slot */
+{
+	ulint	i;
+
+	ut_ad(mutex_own(&slot->mutex));
+	ut_ad(slot->first_free <= slot->n_pages);
+
+	if (trx_doublewrite->use_file) {
+		ib_int64_t	offset;
+		ibool		success;
+
+		offset = (ib_int64_t) (1 + slot->start) * UNIV_PAGE_SIZE;
+
+		success = os_file_write(srv_doublewrite_file,
+					trx_doublewrite->file,
+					slot->write_buf,
+					(ulint) (offset & 0xFFFFFFFFUL),
+					(ulint) (offset >> 32),
+					slot->first_free * UNIV_PAGE_SIZE);
+		ut_a(success);
+
+		success = os_file_flush(trx_doublewrite->file);
+		ut_a(success);
+
+		return;
+	}
+
+	/* The slot may span the end of block1 and the start of block2 */
+
+	for (i = 0; i < slot->first_free; ) {
+		ulint	pos	= slot->start + i;
+		ulint	page_no;
+		ulint	n;
+
+		if (pos < TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
+			page_no = trx_doublewrite->block1 + pos;
+			n = ut_min(slot->first_free - i,
+				   TRX_SYS_DOUBLEWRITE_BLOCK_SIZE - pos);
+		} else {
+			page_no = trx_doublewrite->block2
+				+ pos - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
+			n = slot->first_free - i;
+		}
+
+		fil_io(OS_FILE_WRITE, TRUE, TRX_SYS_SPACE, 0, page_no, 0,
+		       n * UNIV_PAGE_SIZE,
+		       (void*) (slot->write_buf + i * UNIV_PAGE_SIZE), NULL);
+
+		i += n;
+	}
+
+	fil_flush(TRX_SYS_SPACE);
 }
 
 /****************************************************************//**
@@ -247,9 +477,10 @@ trx_sys_mark_upgraded_to_multiple_tablespaces(void)
 
 /****************************************************************//**
 Creates the doublewrite buffer to a new InnoDB installation. The header of the
-doublewrite buffer is placed on the trx system header page. */
+doublewrite buffer is placed on the trx system header page.
+@return DB_SUCCESS or DB_ERROR */
 UNIV_INTERN
-void
+ulint
 trx_sys_create_doublewrite_buf(void)
 /*================================*/
 {
@@ -266,7 +497,7 @@ trx_sys_create_doublewrite_buf(void)
 	if (trx_doublewrite) {
 		/* Already inited */
 
-		return;
+		return(DB_SUCCESS);
 	}
 
 start_again:
@@ -300,10 +531,12 @@ start_again:
 			fprintf(stderr,
 				"InnoDB: Cannot create doublewrite buffer:"
 				" you must\n"
-				"InnoDB: increase your buffer pool size.\n"
-				"InnoDB: Cannot continue operation.\n");
+				"InnoDB: increase your buffer pool size.\n");
 
-			exit(1);
+			mtr_commit(&mtr);
+			trx_doublewrite_buf_is_being_created = FALSE;
+
+			return(DB_ERROR);
 		}
 
 		block2 = fseg_create(TRX_SYS_SPACE, TRX_SYS_PAGE_NO,
@@ -319,13 +552,13 @@ start_again:
 			fprintf(stderr,
 				"InnoDB: Cannot create doublewrite buffer:"
 				" you must\n"
-				"InnoDB: increase your tablespace size.\n"
-				"InnoDB: Cannot continue operation.\n");
+				"InnoDB: increase your tablespace size.\n");
 
-			/* We exit without committing the mtr to prevent
-			its modifications to the database getting to disk */
+			/* We return without committing the mtr to prevent
+			its modifications to the database getting to disk.
+			The startup fails and the server exits. */
 
-			exit(1);
+			return(DB_ERROR);
 		}
 
 		fseg_header = buf_block_get_frame(block)
@@ -341,11 +574,11 @@ start_again:
 					"InnoDB: Cannot create doublewrite"
 					" buffer: you must\n"
 					"InnoDB: increase your"
-					" tablespace size.\n"
-					"InnoDB: Cannot continue operation.\n"
-					);
+					" tablespace size.\n");
 
-				exit(1);
+				/* As above, the mtr is not committed */
+
+				return(DB_ERROR);
 			}
 
 			/* We read the allocated pages to the buffer pool;
@@ -409,6 +642,110 @@ start_again:
 
 		goto start_again;
 	}
+
+	return(DB_SUCCESS);
+}
+
+/****************************************************************//**
+Opens the doublewrite file for reading the pages written before the
+shutdown or crash, and checks its header page.
+@return number of pages after the header page, or 0 if the file does
+not exist or is not a valid doublewrite file */
+static
+ulint
+trx_doublewrite_file_open_for_recovery(
+/*===================================*/
+	os_file_t*	file)	/*!< out: the doublewrite file, open
+				if the return value is not 0 */
+{
+	byte*	unaligned_buf;
+	byte*	buf;
+	ibool	success;
+	ulint	magic;
+	ulint	n_pages	= 0;
+
+	*file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, srv_doublewrite_file,
+		OS_FILE_OPEN, OS_FILE_READ_ONLY, &success);
+
+	if (!success) {
+		return(0);
+	}
+
+	unaligned_buf = ut_malloc(2 * UNIV_PAGE_SIZE);
+	buf = ut_align(unaligned_buf, UNIV_PAGE_SIZE);
+
+	if (!os_file_read(*file, buf, 0, 0, UNIV_PAGE_SIZE)) {
+		memset(buf, 0, UNIV_PAGE_SIZE);
+	}
+
+	magic = mach_read_from_4(buf + TRX_DOUBLEWRITE_FILE_MAGIC);
+
+	if (magic == TRX_SYS_DOUBLEWRITE_MAGIC_N
+	    && mach_read_from_4(buf + TRX_DOUBLEWRITE_FILE_PAGE_SIZE)
+	    == UNIV_PAGE_SIZE) {
+
+		n_pages = mach_read_from_4(buf + TRX_DOUBLEWRITE_FILE_N_PAGES);
+	} else if (magic != 0) {
+		/* A zero-filled header page is a file that was just
+		created by trx_doublewrite_file_create() */
+		fprintf(stderr,
+			"InnoDB: Warning: %s is not a valid"
+			" doublewrite file; ignoring its contents\n",
+			srv_doublewrite_file);
+	}
+
+	ut_free(unaligned_buf);
+
+	if (n_pages == 0) {
+		os_file_close(*file);
+	}
+
+	return(n_pages);
+}
+
+/****************************************************************//**
+Finds the newest copy of a page among the pages read from the
+doublewrite buffer. The slots of the doublewrite buffer are written
+independently of each other, so that a slot may still hold an older
+copy of a page whose latest copy is in another slot.
+@return the copy with the highest FIL_PAGE_LSN that is not corrupted,
+or NULL if there is none */
+static
+byte*
+trx_doublewrite_find_page(
+/*======================*/
+	byte*	buf,		/*!< in: pages read from the
+				doublewrite buffer */
+	ulint	n_pages,	/*!< in: number of pages in buf */
+	ulint	space_id,	/*!< in: space id */
+	ulint	page_no,	/*!< in: page number */
+	ulint	zip_size)	/*!< in: compressed page size, or 0 */
+{
+	byte*	found	= NULL;
+	ulint	i;
+
+	for (i = 0; i < n_pages; i++) {
+		byte*	page = buf + i * UNIV_PAGE_SIZE;
+
+		if (mach_read_from_4(page + FIL_PAGE_OFFSET) != page_no
+		    || mach_read_from_4(page
+					+ FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID)
+		    != space_id
+		    || buf_page_is_corrupted(page, zip_size)) {
+
+			continue;
+		}
+
+		if (found == NULL
+		    || mach_read_from_8(page + FIL_PAGE_LSN)
+		    > mach_read_from_8(found + FIL_PAGE_LSN)) {
+
+			found = page;
+		}
+	}
+
+	return(found);
 }
 
 /****************************************************************//**
@@ -417,24 +754,30 @@ we already have a doublewrite buffer created in the data files. If we are
 upgrading to an InnoDB version which supports multiple tablespaces, then this
 function performs the necessary update operations. If we are in a crash
 recovery, this function uses a possible doublewrite buffer to restore
-half-written pages in the data files. */
+half-written pages in the data files. Both the doublewrite blocks in the
+system tablespace and the doublewrite file, if one is configured, are
+searched for the pages. */
 UNIV_INTERN
 void
 trx_sys_doublewrite_init_or_restore_pages(
 /*======================================*/
 	ibool	restore_corrupt_pages)	/*!< in: TRUE=restore pages */
 {
-	byte*	buf;
-	byte*	read_buf;
-	byte*	unaligned_read_buf;
-	ulint	block1;
-	ulint	block2;
-	ulint	source_page_no;
-	byte*	page;
-	byte*	doublewrite;
-	ulint	space_id;
-	ulint	page_no;
-	ulint	i;
+	byte*		buf;
+	byte*		unaligned_buf	= NULL;
+	byte*		read_buf;
+	byte*		unaligned_read_buf;
+	ulint		block1;
+	ulint		block2;
+	ulint		source_page_no;
+	byte*		page;
+	byte*		doublewrite;
+	ulint		space_id;
+	ulint		page_no;
+	ulint		n_pages;
+	ulint		n_file_pages	= 0;
+	os_file_t	file;
+	ulint		i;
 
 	/* We do the file i/o past the buffer pool */
 
@@ -449,19 +792,29 @@ trx_sys_doublewrite_init_or_restore_pages(
 	doublewrite = read_buf + TRX_SYS_DOUBLEWRITE;
 
 	if (mach_read_from_4(doublewrite + TRX_SYS_DOUBLEWRITE_MAGIC)
-	    == TRX_SYS_DOUBLEWRITE_MAGIC_N) {
-		/* The doublewrite buffer has been created */
+	    != TRX_SYS_DOUBLEWRITE_MAGIC_N) {
 
-		trx_doublewrite_init(doublewrite);
+		goto leave_func;
+	}
 
-		block1 = trx_doublewrite->block1;
-		block2 = trx_doublewrite->block2;
+	/* The doublewrite buffer has been created. Look for the
+	doublewrite file before trx_doublewrite_init() rewrites its
+	header page. */
 
-		buf = trx_doublewrite->write_buf;
-	} else {
-		goto leave_func;
+	if (srv_doublewrite_file) {
+		n_file_pages = trx_doublewrite_file_open_for_recovery(&file);
 	}
 
+	trx_doublewrite_init(doublewrite);
+
+	block1 = trx_doublewrite->block1;
+	block2 = trx_doublewrite->block2;
+
+	n_pages = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE + n_file_pages;
+
+	unaligned_buf = ut_malloc((1 + n_pages) * UNIV_PAGE_SIZE);
+	buf = ut_align(unaligned_buf, UNIV_PAGE_SIZE);
+
 	if (mach_read_from_4(doublewrite + TRX_SYS_DOUBLEWRITE_SPACE_ID_STORED)
 	    != TRX_SYS_DOUBLEWRITE_SPACE_ID_STORED_N) {
 
@@ -489,16 +842,47 @@ trx_sys_doublewrite_init_or_restore_pages(
 	       TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE,
 	       buf + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE,
 	       NULL);
+
+	/* Read the pages from the doublewrite file, one file slot
+	at a time */
+
+	for (i = 0; i < n_file_pages; i += TRX_DOUBLEWRITE_FILE_SLOT_SIZE) {
+		ib_int64_t	offset;
+		ulint		n;
+
+		offset = (ib_int64_t) (1 + i) * UNIV_PAGE_SIZE;
+		n = ut_min(n_file_pages - i, TRX_DOUBLEWRITE_FILE_SLOT_SIZE);
+
+		if (!os_file_read(file,
+				  buf + (2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE
+					 + i) * UNIV_PAGE_SIZE,
+				  (ulint) (offset & 0xFFFFFFFFUL),
+				  (ulint) (offset >> 32),
+				  n * UNIV_PAGE_SIZE)) {
+			fprintf(stderr,
+				"InnoDB: Warning: cannot read"
+				" the doublewrite file %s\n",
+				srv_doublewrite_file);
+			n_pages = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE + i;
+			break;
+		}
+	}
+
+	if (n_file_pages) {
+		os_file_close(file);
+	}
+
 	/* Check if any of these pages is half-written in data files, in the
 	intended position */
 
 	page = buf;
 
-	for (i = 0; i < TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * 2; i++) {
+	for (i = 0; i < n_pages; i++) {
 
 		page_no = mach_read_from_4(page + FIL_PAGE_OFFSET);
 
-		if (trx_doublewrite_must_reset_space_ids) {
+		if (trx_doublewrite_must_reset_space_ids
+		    && i < 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
 
 			space_id = 0;
 			mach_write_to_4(page
@@ -542,18 +926,13 @@ trx_sys_doublewrite_init_or_restore_pages(
 				(ulong) space_id, (ulong) page_no, (ulong) i);
 
 		} else if (space_id == TRX_SYS_SPACE
-			   && ((page_no >= block1
-				&& page_no
-				< block1 + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
-			       || (page_no >= block2
-				   && page_no
-				   < (block2
-				      + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)))) {
+			   && trx_doublewrite_page_inside(page_no)) {
 
 			/* It is an unwritten doublewrite buffer page:
 			do nothing */
 		} else {
 			ulint	zip_size = fil_space_get_zip_size(space_id);
+			byte*	copy;
 
 			/* Read in the actual page from the file */
 			fil_io(OS_FILE_READ, TRUE, space_id, zip_size,
@@ -575,7 +954,11 @@ trx_sys_doublewrite_init_or_restore_pages(
 					" the doublewrite buffer.\n",
 					(ulong) space_id, (ulong) page_no);
 
-				if (buf_page_is_corrupted(page, zip_size)) {
+				copy = trx_doublewrite_find_page(
+					buf, n_pages, space_id, page_no,
+					zip_size);
+
+				if (copy == NULL) {
 					fprintf(stderr,
 						"InnoDB: Dump of the page:\n");
 					buf_page_print(
@@ -604,14 +987,14 @@ trx_sys_doublewrite_init_or_restore_pages(
 					ut_error;
 				}
 
-				/* Write the good page from the
-				doublewrite buffer to the intended
-				position */
+				/* Write the newest good copy of the page
+				from the doublewrite buffer to the
+				intended position */
 
 				fil_io(OS_FILE_WRITE, TRUE, space_id,
 				       zip_size, page_no, 0,
 				       zip_size ? zip_size : UNIV_PAGE_SIZE,
-				       page, NULL);
+				       copy, NULL);
 				fprintf(stderr,
 					"InnoDB: Recovered the page from"
 					" the doublewrite buffer.\n");
@@ -624,11 +1007,16 @@ trx_sys_doublewrite_init_or_restore_pages(
 	fil_flush_file_spaces(FIL_TABLESPACE);
 
 leave_func:
+	if (unaligned_buf) {
+		ut_free(unaligned_buf);
+	}
+
 	ut_free(unaligned_read_buf);
 }
 
 /****************************************************************//**
-Checks that trx is in the trx list.
+Checks that trx is in the trx list. The caller must not own the trx_sys
+mutex.
 @return	TRUE if is in */
 UNIV_INTERN
 ibool
@@ -638,21 +1026,18 @@ trx_in_trx_list(
 {
 	trx_t*	trx;
 
-	ut_ad(mutex_own(&(kernel_mutex)));
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
-	while (trx != NULL) {
-
-		if (trx == in_trx) {
-
-			return(TRUE);
-		}
+	while (trx != NULL && trx != in_trx) {
 
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
-	return(FALSE);
+	trx_sys_mutex_exit();
+
+	return(trx != NULL);
 }
 
 /*****************************************************************//**
@@ -665,7 +1050,7 @@ trx_sys_flush_max_trx_id(void)
 	trx_sysf_t*	sys_header;
 	mtr_t		mtr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	mtr_start(&mtr);
 
@@ -896,7 +1281,7 @@ trx_sysf_rseg_find_free(
 	ulint		page_no;
 	ulint		i;
 
-	ut_ad(mutex_own(&(kernel_mutex)));
+	ut_ad(trx_sys_mutex_own());
 
 	sys_header = trx_sysf_get(mtr);
 
@@ -915,7 +1300,7 @@ trx_sysf_rseg_find_free(
 
 /*****************************************************************//**
 Creates the file page for the transaction system. This function is called only
-at the database creation, before trx_sys_init. */
+at the database creation, before trx_sys_init_at_db_start(). */
 static
 void
 trx_sysf_create(
@@ -932,12 +1317,15 @@ trx_sysf_create(
 
 	ut_ad(mtr);
 
-	/* Note that below we first reserve the file space x-latch, and
-	then enter the kernel: we must do it in this order to conform
+	/* Note that below we first reserve the file space x-latch: we
+	must do it before latching the trx system header to conform
 	to the latching order rules. */
 
 	mtr_x_lock(fil_space_get_latch(TRX_SYS_SPACE, NULL), mtr);
-	mutex_enter(&kernel_mutex);
+
+	/* The rollback segment slots are protected by the trx_sys
+	mutex, which must be acquired before the trx system header. */
+	trx_sys_mutex_enter();
 
 	/* Create the trx sys file block in a new allocated file segment */
 	block = fseg_create(TRX_SYS_SPACE, 0, TRX_SYS + TRX_SYS_FSEG_HEADER,
@@ -986,7 +1374,7 @@ trx_sysf_create(
 	ut_a(slot_no == TRX_SYS_SYSTEM_RSEG_ID);
 	ut_a(page_no == FSP_FIRST_RSEG_PAGE_NO);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 }
 
 /*****************************************************************//**
@@ -1015,8 +1403,24 @@ trx_rseg_compare_last_trx_no(
 }
 
 /*****************************************************************//**
-Creates and initializes the central memory structures for the transaction
-system. This is called when the database is started. */
+Creates the trx_sys memory object and its mutex. This is called when the
+database is started, before the trx system header page or the rollback
+segment slots in it are accessed. */
+UNIV_INTERN
+void
+trx_sys_mem_create(void)
+/*====================*/
+{
+	ut_ad(trx_sys == NULL);
+
+	trx_sys = mem_zalloc(sizeof(*trx_sys));
+
+	mutex_create(trx_sys_mutex_key, &trx_sys->mutex, SYNC_TRX_SYS);
+}
+
+/*****************************************************************//**
+Initializes the central memory structures for the transaction system.
+This is called when the database is started, after trx_sys_mem_create(). */
 UNIV_INTERN
 void
 trx_sys_init_at_db_start(void)
@@ -1031,9 +1435,7 @@ trx_sys_init_at_db_start(void)
 
 	mtr_start(&mtr);
 
-	ut_ad(trx_sys == NULL);
-
-	mutex_enter(&kernel_mutex);
+	ut_ad(trx_sys != NULL);
 
 	/* We create the min binary heap here and pass ownership to
 	purge when we init the purge sub-system. Purge is responsible
@@ -1043,7 +1445,7 @@ trx_sys_init_at_db_start(void)
 		trx_rseg_compare_last_trx_no,
 		sizeof(rseg_queue_t), TRX_SYS_N_RSEGS);
 
-	trx_sys = mem_zalloc(sizeof(*trx_sys));
+	trx_sys_mutex_enter();
 
 	sys_header = trx_sysf_get(&mtr);
 
@@ -1064,6 +1466,13 @@ trx_sys_init_at_db_start(void)
 				     TRX_SYS_TRX_ID_WRITE_MARGIN);
 
 	UT_LIST_INIT(trx_sys->mysql_trx_list);
+	UT_LIST_INIT(trx_sys->trx_serial_list);
+
+	trx_sys->descr_n_max = TRX_DESCR_ARRAY_INITIAL_SIZE;
+	trx_sys->descr_n_used = 0;
+	trx_sys->descriptors = ut_malloc(
+		TRX_DESCR_ARRAY_INITIAL_SIZE * sizeof(trx_id_t));
+
 	trx_dummy_sess = sess_open();
 	trx_lists_init_at_db_start();
 
@@ -1104,7 +1513,7 @@ trx_sys_init_at_db_start(void)
 	/* Transfer ownership to purge. */
 	trx_purge_sys_create(ib_bh);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	mtr_commit(&mtr);
 }
@@ -1392,6 +1801,7 @@ UNIV_INTERN
 void
 trx_sys_create_rsegs(
 /*=================*/
+	ulint	n_spaces,	/*!< number of undo tablespaces */
 	ulint	n_rsegs)	/*!< number of rollback segments to create */
 {
 	ulint	new_rsegs = 0;
@@ -1403,8 +1813,14 @@ trx_sys_create_rsegs(
 		ulint	i;
 
 		for (i = 0;  i < n_rsegs; ++i) {
+			ulint	space;
+
+			/* Spread the new rollback segments over the
+			undo tablespaces, which are numbered from 1. */
+			space = n_spaces > 0
+				? 1 + (i % n_spaces) : TRX_SYS_SPACE;
 
-			if (trx_rseg_create() != NULL) {
+			if (trx_rseg_create(space) != NULL) {
 				++new_rsegs;
 			} else {
 				break;
@@ -1664,6 +2080,7 @@ trx_sys_close(void)
 	trx_t*		trx;
 	trx_rseg_t*	rseg;
 	read_view_t*	view;
+	ulint		i;
 
 	ut_ad(trx_sys != NULL);
 	ut_ad(srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS);
@@ -1684,7 +2101,15 @@ trx_sys_close(void)
 
 	trx_purge_sys_close();
 
-	mutex_enter(&kernel_mutex);
+	/* Only prepared transactions may be left in the system. Free them.
+	trx_free_prepared() acquires the lock and trx_sys mutexes itself. */
+	ut_a(UT_LIST_GET_LEN(trx_sys->trx_list) == trx_n_prepared);
+
+	while ((trx = UT_LIST_GET_FIRST(trx_sys->trx_list)) != NULL) {
+		trx_free_prepared(trx);
+	}
+
+	trx_sys_mutex_enter();
 
 	/* Free the double write data structures. */
 	ut_a(trx_doublewrite != NULL);
@@ -1694,17 +2119,19 @@ trx_sys_close(void)
 	mem_free(trx_doublewrite->buf_block_arr);
 	trx_doublewrite->buf_block_arr = NULL;
 
-	mutex_free(&trx_doublewrite->mutex);
-	mem_free(trx_doublewrite);
-	trx_doublewrite = NULL;
+	for (i = 0; i < trx_doublewrite->n_slots; i++) {
+		mutex_free(&trx_doublewrite->slots[i].mutex);
+	}
 
-	/* Only prepared transactions may be left in the system. Free them. */
-	ut_a(UT_LIST_GET_LEN(trx_sys->trx_list) == trx_n_prepared);
+	mem_free(trx_doublewrite->slots);
 
-	while ((trx = UT_LIST_GET_FIRST(trx_sys->trx_list)) != NULL) {
-		trx_free_prepared(trx);
+	if (trx_doublewrite->use_file) {
+		os_file_close(trx_doublewrite->file);
 	}
 
+	mem_free(trx_doublewrite);
+	trx_doublewrite = NULL;
+
 	/* There can't be any active transactions. */
 	rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
 
@@ -1724,8 +2151,8 @@ trx_sys_close(void)
 
 		view = UT_LIST_GET_NEXT(view_list, prev_view);
 
-		/* Views are allocated from the trx_sys->global_read_view_heap.
-		So, we simply remove the element here. */
+		/* Views are owned by the transactions and by purge, which
+		free them. So, we simply remove the element here. */
 		UT_LIST_REMOVE(view_list, trx_sys->view_list, prev_view);
 	}
 
@@ -1733,10 +2160,16 @@ trx_sys_close(void)
 	ut_a(UT_LIST_GET_LEN(trx_sys->rseg_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->view_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->mysql_trx_list) == 0);
+	ut_a(UT_LIST_GET_LEN(trx_sys->trx_serial_list) == 0);
+
+	ut_free(trx_sys->descriptors);
+
+	trx_sys_mutex_exit();
+
+	mutex_free(&trx_sys->mutex);
 
 	mem_free(trx_sys);
 
 	trx_sys = NULL;
-	mutex_exit(&kernel_mutex);
 }
 #endif /* !UNIV_HOTBACKUP */
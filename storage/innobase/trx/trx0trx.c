@@ -48,15 +48,17 @@ Created 3/26/1996 Heikki Tuuri
 UNIV_INTERN sess_t*		trx_dummy_sess = NULL;
 
 /** Number of transactions currently allocated for MySQL: protected by
-the kernel mutex */
+the trx_sys mutex */
 UNIV_INTERN ulint	trx_n_mysql_transactions = 0;
 /** Number of transactions currently in the XA PREPARED state: protected by
-the kernel mutex */
+the trx_sys mutex */
 UNIV_INTERN ulint	trx_n_prepared = 0;
 
 #ifdef UNIV_PFS_MUTEX
 /* Key to register the mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	trx_undo_mutex_key;
+/* Key to register the trx mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	trx_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 /*************************************************************//**
@@ -96,21 +98,25 @@ trx_create(
 {
 	trx_t*	trx;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 	ut_ad(sess);
 
 	trx = mem_alloc(sizeof(trx_t));
 
 	trx->magic_n = TRX_MAGIC_N;
 
+	mutex_create(trx_mutex_key, &trx->mutex, SYNC_TRX);
+
 	trx->op_info = "";
 
 	trx->is_purge = 0;
 	trx->is_recovered = 0;
+	trx->read_only = FALSE;
+	trx->will_lock = 0;
+	trx->in_trx_serial_list = FALSE;
 	trx->conc_state = TRX_NOT_STARTED;
 
 	trx->is_registered = 0;
-	trx->owns_prepare_mutex = 0;
 
 	trx->start_time = ut_time();
 
@@ -178,13 +184,14 @@ trx_create(
 
 	trx->dict_operation_lock_mode = 0;
 	trx->has_search_latch = FALSE;
+	trx->search_latch = NULL;
 	trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 
 	trx->declared_to_be_inside_innodb = FALSE;
 	trx->n_tickets_to_enter_innodb = 0;
 
-	trx->global_read_view_heap = mem_heap_create(256);
 	trx->global_read_view = NULL;
+	trx->prebuilt_view = NULL;
 	trx->read_view = NULL;
 
 	/* Set X/Open XA transaction identification to NULL */
@@ -210,7 +217,7 @@ trx_allocate_for_mysql(void)
 {
 	trx_t*	trx;
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx = trx_create(trx_dummy_sess);
 
@@ -218,7 +225,7 @@ trx_allocate_for_mysql(void)
 
 	UT_LIST_ADD_FIRST(mysql_trx_list, trx_sys->mysql_trx_list, trx);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(trx);
 }
@@ -233,11 +240,11 @@ trx_allocate_for_background(void)
 {
 	trx_t*	trx;
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx = trx_create(trx_dummy_sess);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(trx);
 }
@@ -251,9 +258,10 @@ trx_search_latch_release_if_reserved(
 	trx_t*	   trx) /*!< in: transaction */
 {
 	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 
 		trx->has_search_latch = FALSE;
+		trx->search_latch = NULL;
 	}
 }
 
@@ -265,7 +273,7 @@ trx_free(
 /*=====*/
 	trx_t*	trx)	/*!< in, own: trx object */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	if (trx->declared_to_be_inside_innodb) {
 		ut_print_timestamp(stderr);
@@ -328,8 +336,8 @@ trx_free(
 
 	ut_a(UT_LIST_GET_LEN(trx->trx_locks) == 0);
 
-	if (trx->global_read_view_heap) {
-		mem_heap_free(trx->global_read_view_heap);
+	if (trx->prebuilt_view != NULL) {
+		read_view_free(trx->prebuilt_view);
 	}
 
 	trx->global_read_view = NULL;
@@ -340,6 +348,8 @@ trx_free(
 	/* We allocated a dedicated heap for the vector. */
 	ib_vector_free(trx->autoinc_locks);
 
+	mutex_free(&trx->mutex);
+
 	mem_free(trx);
 }
 
@@ -351,7 +361,8 @@ trx_free_prepared(
 /*==============*/
 	trx_t*	trx)	/*!< in, own: trx object */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(!lock_mutex_own());
+	ut_ad(!trx_sys_mutex_own());
 	ut_a(trx->conc_state == TRX_PREPARED);
 	ut_a(trx->magic_n == TRX_MAGIC_N);
 
@@ -361,8 +372,12 @@ trx_free_prepared(
 	the shutdown stage and because a transaction cannot become
 	PREPARED while holding locks, it is safe to release the locks
 	held by PREPARED transactions here at shutdown.*/
+	lock_mutex_enter();
+
 	lock_release_off_kernel(trx);
 
+	lock_mutex_exit();
+
 	trx_undo_free_prepared(trx);
 
 	mutex_free(&trx->undo_mutex);
@@ -385,15 +400,21 @@ trx_free_prepared(
 		mem_heap_free(trx->lock_heap);
 	}
 
-	if (trx->global_read_view_heap) {
-		mem_heap_free(trx->global_read_view_heap);
+	if (trx->prebuilt_view != NULL) {
+		read_view_free(trx->prebuilt_view);
 	}
 
 	ut_a(ib_vector_is_empty(trx->autoinc_locks));
 	ib_vector_free(trx->autoinc_locks);
 
+	trx_sys_mutex_enter();
+
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
 
+	trx_sys_mutex_exit();
+
+	mutex_free(&trx->mutex);
+
 	mem_free(trx);
 }
 
@@ -405,7 +426,7 @@ trx_free_for_mysql(
 /*===============*/
 	trx_t*	trx)	/*!< in, own: trx object */
 {
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	UT_LIST_REMOVE(mysql_trx_list, trx_sys->mysql_trx_list, trx);
 
@@ -415,7 +436,7 @@ trx_free_for_mysql(
 
 	trx_n_mysql_transactions--;
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 }
 
 /********************************************************************//**
@@ -426,11 +447,79 @@ trx_free_for_background(
 /*====================*/
 	trx_t*	trx)	/*!< in, own: trx object */
 {
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx_free(trx);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
+}
+
+/****************************************************************//**
+Inserts the id of a read-write transaction in trx_sys->descriptors,
+which is kept sorted in ascending order. Transaction ids are assigned in
+ascending order, so the new id is normally appended at the end. */
+static
+void
+trx_reserve_descriptor(
+/*===================*/
+	const trx_t*	trx)	/*!< in: transaction */
+{
+	ulint		n_used;
+	trx_id_t*	descr;
+
+	ut_ad(trx_sys_mutex_own());
+	ut_ad(!trx->read_only);
+	ut_ad(!trx_find_descriptor(trx_sys->descriptors,
+				   trx_sys->descr_n_used, trx->id));
+
+	n_used = trx_sys->descr_n_used;
+
+	if (UNIV_UNLIKELY(n_used == trx_sys->descr_n_max)) {
+
+		trx_sys->descr_n_max *= 2;
+
+		trx_sys->descriptors = ut_realloc(
+			trx_sys->descriptors,
+			trx_sys->descr_n_max * sizeof(trx_id_t));
+	}
+
+	descr = trx_sys->descriptors + n_used;
+
+	/* Find the position to insert at, searching from the end */
+
+	while (descr > trx_sys->descriptors && descr[-1] > trx->id) {
+		descr--;
+	}
+
+	memmove(descr + 1, descr,
+		(trx_sys->descriptors + n_used - descr) * sizeof(trx_id_t));
+
+	*descr = trx->id;
+
+	trx_sys->descr_n_used++;
+}
+
+/****************************************************************//**
+Removes the id of a read-write transaction from trx_sys->descriptors. */
+static
+void
+trx_release_descriptor(
+/*===================*/
+	const trx_t*	trx)	/*!< in: transaction */
+{
+	trx_id_t*	descr;
+
+	ut_ad(trx_sys_mutex_own());
+
+	descr = trx_find_descriptor(trx_sys->descriptors,
+				    trx_sys->descr_n_used, trx->id);
+	ut_a(descr != NULL);
+
+	trx_sys->descr_n_used--;
+
+	memmove(descr, descr + 1,
+		(trx_sys->descriptors + trx_sys->descr_n_used - descr)
+		* sizeof(trx_id_t));
 }
 
 /****************************************************************//**
@@ -446,7 +535,7 @@ trx_list_insert_ordered(
 {
 	trx_t*	trx2;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	trx2 = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -488,7 +577,7 @@ trx_lists_init_at_db_start(void)
 	trx_undo_t*	undo;
 	trx_t*		trx;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 	UT_LIST_INIT(trx_sys->trx_list);
 
 	/* Look from the rollback segments if there exist undo logs for
@@ -658,10 +747,27 @@ trx_lists_init_at_db_start(void)
 
 		rseg = UT_LIST_GET_NEXT(rseg_list, rseg);
 	}
+
+	/* Store the ids of the recovered active and prepared transactions
+	in trx_sys->descriptors. The trx list is sorted on trx id, biggest
+	first. */
+
+	for (trx = UT_LIST_GET_LAST(trx_sys->trx_list);
+	     trx != NULL;
+	     trx = UT_LIST_GET_PREV(trx_list, trx)) {
+
+		if (trx->conc_state == TRX_ACTIVE
+		    || trx->conc_state == TRX_PREPARED) {
+
+			trx_reserve_descriptor(trx);
+		}
+	}
 }
 
 /******************************************************************//**
 Assigns a rollback segment to a transaction in a round-robin fashion.
+When there are undo tablespaces, the rollback segment in the system
+tablespace is only used if all the others are being truncated.
 @return	assigned rollback segment instance */
 UNIV_INLINE
 trx_rseg_t*
@@ -670,15 +776,30 @@ trx_assign_rseg(
 	ulint	max_undo_logs)	/*!< in: maximum number of UNDO logs to use */
 {
 	trx_rseg_t*	rseg = trx_sys->latest_rseg;
+	ulint		i;
+
+	ut_ad(trx_sys_mutex_own());
 
-	ut_ad(mutex_own(&kernel_mutex));
+	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
 
-	rseg = UT_LIST_GET_NEXT(rseg_list, rseg);
+		rseg = UT_LIST_GET_NEXT(rseg_list, rseg);
+
+		if (rseg == NULL || rseg->id == max_undo_logs - 1) {
+			rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
+		}
 
-	if (rseg == NULL || rseg->id == max_undo_logs - 1) {
-		rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
+		if (!rseg->skip_allocation
+		    && (rseg->space != TRX_SYS_SPACE
+			|| srv_undo_tablespaces_open == 0)) {
+
+			trx_sys->latest_rseg = rseg;
+
+			return(rseg);
+		}
 	}
 
+	rseg = trx_sys_get_nth_rseg(trx_sys, TRX_SYS_SYSTEM_RSEG_ID);
+
 	trx_sys->latest_rseg = rseg;
 
 	return(rseg);
@@ -698,7 +819,7 @@ trx_start_low(
 {
 	trx_rseg_t*	rseg;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 	ut_ad(trx->rseg == NULL);
 
 	if (trx->is_purge) {
@@ -724,6 +845,18 @@ trx_start_low(
 
 	trx->rseg = rseg;
 
+	/* An autocommit SELECT that does not lock any table cannot
+	modify anything: it is enough to give it an id, other read views
+	need not know about it. */
+
+	trx->read_only = trx->mysql_thd != NULL
+		&& trx->will_lock == 0
+		&& thd_trx_is_read_only(trx->mysql_thd);
+
+	if (!trx->read_only) {
+		trx_reserve_descriptor(trx);
+	}
+
 	trx->conc_state = TRX_ACTIVE;
 	trx->start_time = time(NULL);
 
@@ -732,6 +865,34 @@ trx_start_low(
 	return(TRUE);
 }
 
+/****************************************************************//**
+Makes a read-only transaction read-write. This is only needed if MySQL
+failed to announce that a statement will lock or modify a table, before
+the transaction was started. The transaction gets a new id, so that the
+read views created while it was read-only cannot see its changes. */
+UNIV_INTERN
+void
+trx_set_rw_mode(
+/*============*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+	ut_ad(trx_sys_mutex_own());
+	ut_ad(trx->read_only);
+	ut_ad(trx->conc_state == TRX_ACTIVE);
+	ut_ad(trx->insert_undo == NULL && trx->update_undo == NULL);
+
+	trx->id = trx_sys_get_new_trx_id();
+	trx->read_only = FALSE;
+
+	trx_reserve_descriptor(trx);
+
+	/* The transaction must see its own changes in its read view */
+
+	if (trx->global_read_view != NULL) {
+		trx->global_read_view->creator_trx_id = trx->id;
+	}
+}
+
 /****************************************************************//**
 Starts a new transaction.
 @return	TRUE */
@@ -754,11 +915,11 @@ trx_start(
 	generated by the same transaction, doesn't. */
 	trx->support_xa = thd_supports_xa(trx->mysql_thd);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	ret = trx_start_low(trx, rseg_id);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(ret);
 }
@@ -777,10 +938,17 @@ trx_serialisation_number_get(
 
 	ut_ad(mutex_own(&rseg->mutex));
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx->no = trx_sys_get_new_trx_id();
 
+	/* The numbers are assigned in ascending order under the
+	trx_sys mutex, so the list stays sorted on trx->no. */
+
+	ut_ad(!trx->in_trx_serial_list);
+	UT_LIST_ADD_LAST(trx_serial_list, trx_sys->trx_serial_list, trx);
+	trx->in_trx_serial_list = TRUE;
+
 	/* If the rollack segment is not empty then the
 	new trx_t::no can't be less than any trx_t::no
 	already in the rollback segment. User threads only
@@ -795,19 +963,19 @@ trx_serialisation_number_get(
 
 		mutex_enter(&purge_sys->bh_mutex);
 
-		/* This is to reduce the pressure on the kernel mutex,
+		/* This is to reduce the pressure on the trx_sys mutex,
 		though in reality it should make very little (read no)
 		difference because this code path is only taken when the
 		rbs is empty. */
 
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		ptr = ib_bh_push(purge_sys->ib_bh, &rseg_queue);
 		ut_a(ptr);
 
 		mutex_exit(&purge_sys->bh_mutex);
 	} else {
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 	}
 }
 
@@ -824,7 +992,7 @@ trx_write_serialisation_history(
 	mtr_t		mtr;
 	trx_rseg_t*	rseg;
 
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!trx_sys_mutex_own());
 
 	rseg = trx->rseg;
 
@@ -907,8 +1075,8 @@ trx_write_serialisation_history(
 	transactions with an update undo log, do not necessarily come
 	in exactly the same order as commit lsn's, if the transactions
 	have different rollback segments. To get exactly the same
-	order we should hold the kernel mutex up to this point,
-	adding to the contention of the kernel mutex. However, if
+	order we should hold the trx_sys mutex up to this point,
+	adding to the contention of the trx_sys mutex. However, if
 	a transaction T2 is able to see modifications made by
 	a transaction T1, T2 will always get a bigger transaction
 	number and a bigger commit lsn than T1. */
@@ -930,25 +1098,31 @@ trx_commit_off_kernel(
 {
 	ib_uint64_t	lsn;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	trx->must_flush_log_later = FALSE;
 
+	/* The lock mutex must be acquired before the trx mutex. Only
+	the thread committing the transaction changes its state, so
+	it is safe to release the trx mutex here. */
+
+	trx_mutex_exit(trx);
+
 	/* If the transaction made any updates then we need to write the
 	UNDO logs for the updates to the assigned rollback segment. */
 
 	if (trx->insert_undo != NULL || trx->update_undo != NULL) {
-		mutex_exit(&kernel_mutex);
 
 		lsn = trx_write_serialisation_history(trx);
-
-		mutex_enter(&kernel_mutex);
 	} else {
 		lsn = 0;
 	}
 
 	ut_ad(trx->conc_state == TRX_ACTIVE || trx->conc_state == TRX_PREPARED);
-	ut_ad(mutex_own(&kernel_mutex));
+
+	lock_mutex_enter();
+
+	trx_sys_mutex_enter();
 
 	if (UNIV_UNLIKELY(trx->conc_state == TRX_PREPARED)) {
 		ut_a(trx_n_prepared > 0);
@@ -973,7 +1147,16 @@ trx_commit_off_kernel(
 	trx->conc_state = TRX_COMMITTED_IN_MEMORY;
 	/*--------------------------------------*/
 
-	/* If we release kernel_mutex below and we are still doing
+	if (!trx->read_only) {
+		trx_release_descriptor(trx);
+	}
+
+	if (trx->in_trx_serial_list) {
+		UT_LIST_REMOVE(trx_serial_list, trx_sys->trx_serial_list, trx);
+		trx->in_trx_serial_list = FALSE;
+	}
+
+	/* If we release the trx_sys mutex below and we are still doing
 	recovery i.e.: back ground rollback thread is still active
 	then there is a chance that the rollback thread may see
 	this trx as COMMITTED_IN_MEMORY and goes adhead to clean it
@@ -987,19 +1170,20 @@ trx_commit_off_kernel(
 
 	trx->is_recovered = FALSE;
 
-	lock_release_off_kernel(trx);
-
 	if (trx->global_read_view) {
 		read_view_close(trx->global_read_view);
-		mem_heap_empty(trx->global_read_view_heap);
 		trx->global_read_view = NULL;
 	}
 
 	trx->read_view = NULL;
 
-	if (lsn) {
+	trx_sys_mutex_exit();
+
+	lock_release_off_kernel(trx);
 
-		mutex_exit(&kernel_mutex);
+	lock_mutex_exit();
+
+	if (lsn) {
 
 		if (trx->insert_undo != NULL) {
 
@@ -1026,13 +1210,13 @@ trx_commit_off_kernel(
 		there are > 2 users in the database. Then at least 2 users can
 		gather behind one doing the physical log write to disk.
 
-		If we are calling trx_commit() under prepare_commit_mutex, we
+		If we are calling trx_commit() in binlog commit order, we
 		will delay possible log write and flush to a separate function
 		trx_commit_complete_for_mysql(), which is only called when the
-		thread has released the mutex. This is to make the
-		group commit algorithm to work. Otherwise, the prepare_commit
-		mutex would serialize all commits and prevent a group of
-		transactions from gathering. */
+		thread has let the next transaction commit. This is to make
+		the group commit algorithm to work. Otherwise, the binlog
+		commit order would serialize all commits and prevent a group
+		of transactions from gathering. */
 
 		if (trx->flush_log_later) {
 			/* Do nothing yet */
@@ -1063,14 +1247,16 @@ trx_commit_off_kernel(
 		trx->commit_lsn = lsn;
 
 		/*-------------------------------------*/
-
-		mutex_enter(&kernel_mutex);
 	}
 
 	/* Free all savepoints */
 	trx_roll_free_all_savepoints(trx);
 
+	trx_sys_mutex_enter();
+
 	trx->conc_state = TRX_NOT_STARTED;
+	trx->read_only = FALSE;
+	trx->will_lock = 0;
 	trx->rseg = NULL;
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
@@ -1080,6 +1266,10 @@ trx_commit_off_kernel(
 
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
 
+	trx_sys_mutex_exit();
+
+	trx_mutex_enter(trx);
+
 	trx->error_state = DB_SUCCESS;
 }
 
@@ -1098,12 +1288,16 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
+	trx_sys_mutex_enter();
+
 	trx->conc_state = TRX_NOT_STARTED;
 	trx->rseg = NULL;
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
+
+	trx_sys_mutex_exit();
 }
 
 /********************************************************************//**
@@ -1123,21 +1317,22 @@ trx_assign_read_view(
 		return(trx->read_view);
 	}
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	if (!trx->read_view) {
 		trx->read_view = read_view_open_now(
-			trx->id, trx->global_read_view_heap);
+			trx->id, trx->prebuilt_view);
+		trx->prebuilt_view = trx->read_view;
 		trx->global_read_view = trx->read_view;
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(trx->read_view);
 }
 
 /****************************************************************//**
-Commits a transaction. NOTE that the kernel mutex is temporarily released. */
+Commits a transaction. NOTE that the trx mutex is temporarily released. */
 static
 void
 trx_handle_commit_sig_off_kernel(
@@ -1152,7 +1347,7 @@ trx_handle_commit_sig_off_kernel(
 	trx_sig_t*	sig;
 	trx_sig_t*	next_sig;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	trx->que_state = TRX_QUE_COMMITTING;
 
@@ -1192,7 +1387,11 @@ trx_end_lock_wait(
 {
 	que_thr_t*	thr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
+
+	trx_mutex_enter(trx);
+
 	ut_ad(trx->que_state == TRX_QUE_LOCK_WAIT);
 
 	thr = UT_LIST_GET_FIRST(trx->wait_thrs);
@@ -1206,6 +1405,8 @@ trx_end_lock_wait(
 	}
 
 	trx->que_state = TRX_QUE_RUNNING;
+
+	trx_mutex_exit(trx);
 }
 
 /***********************************************************//**
@@ -1219,7 +1420,7 @@ trx_lock_wait_to_suspended(
 {
 	que_thr_t*	thr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 	ut_ad(trx->que_state == TRX_QUE_LOCK_WAIT);
 
 	thr = UT_LIST_GET_FIRST(trx->wait_thrs);
@@ -1247,7 +1448,7 @@ trx_sig_reply_wait_to_suspended(
 	trx_sig_t*	sig;
 	que_thr_t*	thr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	sig = UT_LIST_GET_FIRST(trx->reply_signals);
 
@@ -1280,7 +1481,7 @@ trx_sig_is_compatible(
 {
 	trx_sig_t*	sig;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	if (UT_LIST_GET_LEN(trx->signals) == 0) {
 
@@ -1366,7 +1567,7 @@ trx_sig_send(
 	trx_t*		receiver_trx;
 
 	ut_ad(trx);
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	if (!trx_sig_is_compatible(trx, type, sender)) {
 		/* The signal is not compatible with the other signals in
@@ -1435,7 +1636,7 @@ trx_end_signal_handling(
 /*====================*/
 	trx_t*	trx)	/*!< in: trx */
 {
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 	ut_ad(trx->handling_signals == TRUE);
 
 	trx->handling_signals = FALSE;
@@ -1469,7 +1670,7 @@ loop:
 	we can process immediately */
 
 	ut_ad(trx);
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	if (trx->handling_signals && (UT_LIST_GET_LEN(trx->signals) == 0)) {
 
@@ -1480,7 +1681,11 @@ loop:
 
 	if (trx->conc_state == TRX_NOT_STARTED) {
 
+		trx_sys_mutex_enter();
+
 		trx_start_low(trx, ULINT_UNDEFINED);
+
+		trx_sys_mutex_exit();
 	}
 
 	/* If the trx is in a lock wait state, moves the waiting query threads
@@ -1570,13 +1775,14 @@ trx_sig_reply(
 	trx_t*	receiver_trx;
 
 	ut_ad(sig);
-	ut_ad(mutex_own(&kernel_mutex));
 
 	if (sig->receiver != NULL) {
 		ut_ad((sig->receiver)->state == QUE_THR_SIG_REPLY_WAIT);
 
 		receiver_trx = thr_get_trx(sig->receiver);
 
+		ut_ad(trx_mutex_own(receiver_trx));
+
 		UT_LIST_REMOVE(reply_signals, receiver_trx->reply_signals,
 			       sig);
 		ut_ad(receiver_trx->sess->state != SESS_ERROR);
@@ -1598,7 +1804,7 @@ trx_sig_remove(
 	trx_sig_t*	sig)	/*!< in, own: signal */
 {
 	ut_ad(trx && sig);
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_mutex_own(trx));
 
 	ut_ad(sig->receiver == NULL);
 
@@ -1649,7 +1855,9 @@ trx_commit_step(
 	}
 
 	if (node->state == COMMIT_NODE_SEND) {
-		mutex_enter(&kernel_mutex);
+		trx_t*	trx = thr_get_trx(thr);
+
+		trx_mutex_enter(trx);
 
 		node->state = COMMIT_NODE_WAIT;
 
@@ -1659,10 +1867,10 @@ trx_commit_step(
 
 		/* Send the commit signal to the transaction */
 
-		trx_sig_send(thr_get_trx(thr), TRX_SIG_COMMIT, TRX_SIG_SELF,
+		trx_sig_send(trx, TRX_SIG_COMMIT, TRX_SIG_SELF,
 			     thr, NULL, &next_thr);
 
-		mutex_exit(&kernel_mutex);
+		trx_mutex_exit(trx);
 
 		return(next_thr);
 	}
@@ -1695,11 +1903,11 @@ trx_commit_for_mysql(
 
 	trx->op_info = "committing";
 
-	mutex_enter(&kernel_mutex);
+	trx_mutex_enter(trx);
 
 	trx_commit_off_kernel(trx);
 
-	mutex_exit(&kernel_mutex);
+	trx_mutex_exit(trx);
 
 	trx->op_info = "";
 
@@ -1772,7 +1980,7 @@ trx_mark_sql_stat_end(
 
 /**********************************************************************//**
 Prints info about a transaction to the given file. The caller must own the
-kernel mutex. */
+lock mutex. */
 UNIV_INTERN
 void
 trx_print(
@@ -1933,13 +2141,13 @@ trx_prepare_off_kernel(
 	ib_uint64_t	lsn		= 0;
 	mtr_t		mtr;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	rseg = trx->rseg;
 
 	if (trx->insert_undo != NULL || trx->update_undo != NULL) {
 
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		mtr_start(&mtr);
 
@@ -1974,10 +2182,10 @@ trx_prepare_off_kernel(
 		/*--------------*/
 		lsn = mtr.end_lsn;
 
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 	}
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	/*--------------------------------------*/
 	trx->conc_state = TRX_PREPARED;
@@ -2002,7 +2210,7 @@ trx_prepare_off_kernel(
 		TODO: find out if MySQL holds some mutex when calling this.
 		That would spoil our group prepare algorithm. */
 
-		mutex_exit(&kernel_mutex);
+		trx_sys_mutex_exit();
 
 		if (srv_flush_log_at_trx_commit == 0) {
 			/* Do nothing */
@@ -2027,7 +2235,7 @@ trx_prepare_off_kernel(
 			ut_error;
 		}
 
-		mutex_enter(&kernel_mutex);
+		trx_sys_mutex_enter();
 	}
 }
 
@@ -2050,11 +2258,11 @@ trx_prepare_for_mysql(
 
 	trx_start_if_not_started(trx);
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx_prepare_off_kernel(trx);
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	trx->op_info = "";
 
@@ -2081,7 +2289,7 @@ trx_recover_for_mysql(
 	/* We should set those transactions which are in the prepared state
 	to the xid_list */
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -2118,7 +2326,7 @@ trx_recover_for_mysql(
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	if (count > 0){
 		ut_print_timestamp(stderr);
@@ -2148,7 +2356,7 @@ trx_get_trx_by_xid(
 		return(NULL);
 	}
 
-	mutex_enter(&kernel_mutex);
+	trx_sys_mutex_enter();
 
 	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
@@ -2175,7 +2383,7 @@ trx_get_trx_by_xid(
 		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
-	mutex_exit(&kernel_mutex);
+	trx_sys_mutex_exit();
 
 	return(trx);
 }
@@ -897,7 +897,7 @@ trx_undo_add_page(
 	ulint		n_reserved;
 
 	ut_ad(mutex_own(&(trx->undo_mutex)));
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!trx_sys_mutex_own());
 	ut_ad(mutex_own(&(trx->rseg->mutex)));
 
 	rseg = trx->rseg;
@@ -975,7 +975,7 @@ trx_undo_free_page(
 	ulint		zip_size;
 
 	ut_a(hdr_page_no != page_no);
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!trx_sys_mutex_own());
 	ut_ad(mutex_own(&(rseg->mutex)));
 
 	zip_size = rseg->zip_size;
@@ -1224,7 +1224,7 @@ trx_undo_seg_free(
 
 		mtr_start(&mtr);
 
-		ut_ad(!mutex_own(&kernel_mutex));
+		ut_ad(!trx_sys_mutex_own());
 
 		mutex_enter(&(rseg->mutex));
 
@@ -1759,7 +1759,7 @@ trx_undo_assign_undo(
 
 	mtr_start(&mtr);
 
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!trx_sys_mutex_own());
 
 	mutex_enter(&(rseg->mutex));
 
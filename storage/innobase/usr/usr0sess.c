@@ -30,6 +30,7 @@ Created 6/25/1996 Heikki Tuuri
 #endif
 
 #include "trx0trx.h"
+#include "trx0sys.h"
 
 /*********************************************************************//**
 Opens a session.
@@ -41,7 +42,7 @@ sess_open(void)
 {
 	sess_t*	sess;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx_sys_mutex_own());
 
 	sess = mem_alloc(sizeof(sess_t));
 
@@ -62,7 +63,7 @@ sess_close(
 /*=======*/
 	sess_t*	sess)	/*!< in, own: session object */
 {
-	ut_ad(!mutex_own(&kernel_mutex));
+	ut_ad(!trx_sys_mutex_own());
 
 	ut_a(UT_LIST_GET_LEN(sess->graphs) == 0);
 
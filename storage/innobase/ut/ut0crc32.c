@@ -0,0 +1,283 @@
+/*****************************************************************************
+
+Copyright (c) 2013, Twitter, Inc.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+*****************************************************************************/
+
+/***************************************************************//**
+@file ut/ut0crc32.c
+CRC32 implementation
+
+Two implementations of CRC-32C (Castagnoli) are provided: one using the
+crc32 instruction of SSE4.2 capable x86-64 CPUs, and a table-driven
+slicing-by-8 software fallback, which processes 8 bytes per iteration
+using 8 lookup tables of 256 entries each. The implementation is chosen
+at runtime by ut_crc32_init(). Both produce identical results.
+
+Created 2013 Twitter, Inc.
+********************************************************************/
+
+#include <string.h>
+
+#include "ut0crc32.h"
+
+/** The reversed CRC-32C (Castagnoli) polynomial */
+#define UT_CRC32_POLY		0x82F63B78UL
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/** The CPU may support the SSE4.2 crc32 instruction */
+# define UT_CRC32_SSE42
+#endif /* __GNUC__ && __x86_64__ */
+
+/** Pointer to the CRC32 implementation selected by ut_crc32_init() */
+UNIV_INTERN ib_ut_crc32_t	ut_crc32;
+
+/** TRUE if the CPU supports the SSE4.2 crc32 instruction and ut_crc32
+uses it */
+UNIV_INTERN ibool		ut_crc32_sse42_enabled = FALSE;
+
+/** Lookup tables of the slicing-by-8 algorithm */
+static ib_uint32_t	ut_crc32_slice8_table[8][256];
+
+/** Flag that tells whether the slicing-by-8 tables have been initialized */
+static ibool		ut_crc32_slice8_table_initialized = FALSE;
+
+#ifdef UT_CRC32_SSE42
+/********************************************************************//**
+Checks whether the CPU supports the SSE4.2 crc32 instruction.
+@return TRUE if supported */
+static
+ibool
+ut_crc32_sse42_supported(void)
+/*==========================*/
+{
+	ib_uint32_t	features_ecx;
+	ib_uint32_t	eax;
+	ib_uint32_t	max_level;
+
+	asm("cpuid" : "=a" (max_level) : "a" (0) : "ebx", "ecx", "edx");
+
+	if (max_level < 1) {
+		return(FALSE);
+	}
+
+	asm("cpuid" : "=a" (eax), "=c" (features_ecx) : "a" (1)
+	    : "ebx", "edx");
+
+	/* Bit 20 of ECX is set if SSE4.2 is supported. */
+	return((features_ecx >> 20) & 1);
+}
+
+/********************************************************************//**
+Updates a CRC32 checksum with one byte using the crc32 instruction.
+@return updated CRC32 */
+UNIV_INLINE
+ib_uint32_t
+ut_crc32_sse42_byte(
+/*================*/
+	ib_uint32_t	crc,	/*!< in: CRC32 so far */
+	byte		data)	/*!< in: data byte */
+{
+	asm("crc32b %1, %0" : "+r" (crc) : "rm" (data));
+
+	return(crc);
+}
+
+/********************************************************************//**
+Updates a CRC32 checksum with eight bytes using the crc32 instruction.
+@return updated CRC32 */
+UNIV_INLINE
+ib_uint64_t
+ut_crc32_sse42_64(
+/*==============*/
+	ib_uint64_t	crc,	/*!< in: CRC32 so far */
+	const byte*	data)	/*!< in: eight data bytes */
+{
+	ib_uint64_t	data_int;
+
+	/* The compiler turns this into a single unaligned load. */
+	memcpy(&data_int, data, sizeof data_int);
+
+	asm("crc32q %1, %0" : "+r" (crc) : "rm" (data_int));
+
+	return(crc);
+}
+
+/********************************************************************//**
+Calculates CRC32 using the SSE4.2 crc32 instruction.
+@return CRC32 (CRC-32C) */
+static
+ib_uint32_t
+ut_crc32_sse42(
+/*===========*/
+	const byte*	buf,	/*!< in: data over which to calculate CRC32 */
+	ulint		len)	/*!< in: data length */
+{
+	ib_uint32_t	crc = 0xFFFFFFFFUL;
+	ib_uint64_t	crc64;
+
+	/* Process unaligned leading bytes one at a time. */
+	while (len > 0 && ((ulint) buf & 7) != 0) {
+		crc = ut_crc32_sse42_byte(crc, *buf++);
+		len--;
+	}
+
+	crc64 = crc;
+
+	/* The main loop, unrolled to process 64 bytes per iteration. */
+	while (len >= 64) {
+		crc64 = ut_crc32_sse42_64(crc64, buf);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 8);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 16);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 24);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 32);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 40);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 48);
+		crc64 = ut_crc32_sse42_64(crc64, buf + 56);
+		buf += 64;
+		len -= 64;
+	}
+
+	while (len >= 8) {
+		crc64 = ut_crc32_sse42_64(crc64, buf);
+		buf += 8;
+		len -= 8;
+	}
+
+	crc = (ib_uint32_t) crc64;
+
+	while (len > 0) {
+		crc = ut_crc32_sse42_byte(crc, *buf++);
+		len--;
+	}
+
+	return(~crc);
+}
+#endif /* UT_CRC32_SSE42 */
+
+/********************************************************************//**
+Initializes the lookup tables of the slicing-by-8 algorithm. */
+static
+void
+ut_crc32_slice8_table_init(void)
+/*============================*/
+{
+	ulint		n;
+	ulint		k;
+	ib_uint32_t	c;
+
+	for (n = 0; n < 256; n++) {
+		c = (ib_uint32_t) n;
+		for (k = 0; k < 8; k++) {
+			c = (c & 1) ? (UT_CRC32_POLY ^ (c >> 1)) : (c >> 1);
+		}
+		ut_crc32_slice8_table[0][n] = c;
+	}
+
+	for (n = 0; n < 256; n++) {
+		c = ut_crc32_slice8_table[0][n];
+		for (k = 1; k < 8; k++) {
+			c = ut_crc32_slice8_table[0][c & 0xFF] ^ (c >> 8);
+			ut_crc32_slice8_table[k][n] = c;
+		}
+	}
+
+	ut_crc32_slice8_table_initialized = TRUE;
+}
+
+/********************************************************************//**
+Reads four bytes in little-endian order.
+@return the 32-bit value */
+UNIV_INLINE
+ib_uint32_t
+ut_crc32_read_le32(
+/*===============*/
+	const byte*	b)	/*!< in: four bytes */
+{
+	return((ib_uint32_t) b[0]
+	       | ((ib_uint32_t) b[1] << 8)
+	       | ((ib_uint32_t) b[2] << 16)
+	       | ((ib_uint32_t) b[3] << 24));
+}
+
+/********************************************************************//**
+Calculates CRC32 in software, using the slicing-by-8 algorithm. This is
+the fallback used by ut_crc32 when the CPU has no crc32 instruction.
+@return CRC32 (CRC-32C) */
+UNIV_INTERN
+ib_uint32_t
+ut_crc32_slice8(
+/*============*/
+	const byte*	buf,	/*!< in: data over which to calculate CRC32 */
+	ulint		len)	/*!< in: data length */
+{
+	ib_uint32_t	(*t)[256] = ut_crc32_slice8_table;
+	ib_uint32_t	crc = 0xFFFFFFFFUL;
+
+	while (len > 0 && ((ulint) buf & 7) != 0) {
+		crc = t[0][(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+		len--;
+	}
+
+	while (len >= 8) {
+		ib_uint32_t	lo = crc ^ ut_crc32_read_le32(buf);
+		ib_uint32_t	hi = ut_crc32_read_le32(buf + 4);
+
+		crc = t[7][lo & 0xFF]
+			^ t[6][(lo >> 8) & 0xFF]
+			^ t[5][(lo >> 16) & 0xFF]
+			^ t[4][lo >> 24]
+			^ t[3][hi & 0xFF]
+			^ t[2][(hi >> 8) & 0xFF]
+			^ t[1][(hi >> 16) & 0xFF]
+			^ t[0][hi >> 24];
+
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len > 0) {
+		crc = t[0][(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+		len--;
+	}
+
+	return(~crc);
+}
+
+/********************************************************************//**
+Initializes the data structures used by ut_crc32(). Does not do any
+allocations, would not hurt if called twice, but would be pointless. */
+UNIV_INTERN
+void
+ut_crc32_init(void)
+/*===============*/
+{
+	/* The software tables are always built, ut_crc32_slice8() is
+	also used directly for verification. */
+	if (!ut_crc32_slice8_table_initialized) {
+		ut_crc32_slice8_table_init();
+	}
+
+#ifdef UT_CRC32_SSE42
+	ut_crc32_sse42_enabled = ut_crc32_sse42_supported();
+
+	if (ut_crc32_sse42_enabled) {
+		ut_crc32 = ut_crc32_sse42;
+		return;
+	}
+#endif /* UT_CRC32_SSE42 */
+
+	ut_crc32 = ut_crc32_slice8;
+}
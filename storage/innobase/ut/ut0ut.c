@@ -736,6 +736,8 @@ ut_get_strerr(
 		return("Table is being used in foreign key check");
 	case DB_IDENTIFIER_TOO_LONG:
 		return("Identifier name is too long");
+	case DB_ONLINE_LOG_TOO_BIG:
+		return("Log size exceeded during online index creation");
 	/* do not add default: in order to produce a warning if new code
 	is added to the enum but not added here */
 	}
@@ -0,0 +1,207 @@
+/* Copyright (c) 2013, Twitter, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Contended InnoDB mutex handoff (sync/sync0sync.c) with different
+  numbers of sync wait arrays (sync/sync0arr.c, innodb_sync_array_size).
+
+  A number of threads increment a counter protected by a single mutex,
+  and sleep while holding it. The spin rounds are kept short, so the
+  other threads stop spinning and wait on the mutex event with a cell
+  reserved in one of the wait arrays. The counter must be exact, the
+  threads must have waited in the arrays, and the arrays must be
+  consistent afterwards. The holder sleeps, so the handoff rates are
+  dominated by the sleep time; they are only printed as diagnostics.
+*/
+
+#include "univ.i"
+#include "os0sync.h"
+#include "os0thread.h"
+#include "sync0sync.h"
+#include "sync0arr.h"
+#include "srv0srv.h"
+#include "ut0mem.h"
+#include "mem0mem.h"
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <my_pthread.h>
+#include <tap.h>
+
+#define N_THREADS		16
+#define N_ROUNDS		500
+
+/* Time to hold the mutex, in microseconds */
+#define HOLD_TIME		20
+
+/* The parts of the rest of InnoDB that the sync, os and ut sources
+refer to. */
+ulint		srv_max_n_threads		= N_THREADS + 16;
+ulong		srv_n_spin_wait_rounds		= 30;
+ulong		srv_spin_wait_delay		= 6;
+ulong		srv_sync_array_size		= 1;
+my_bool		srv_use_sys_malloc		= TRUE;
+ibool		srv_print_innodb_monitor	= FALSE;
+ulint		srv_fatal_semaphore_wait_threshold = 600;
+os_event_t	srv_lock_timeout_thread_event	= NULL;
+ulint		os_file_n_pending_preads	= 0;
+ulint		os_file_n_pending_pwrites	= 0;
+
+const char*
+innobase_basename(const char* path_name)
+{
+  const char*	name= strrchr(path_name, '/');
+
+  return(name ? name + 1 : path_name);
+}
+
+char*
+innobase_convert_name(char* buf, ulint buflen, const char* id, ulint idlen,
+                      void* thd __attribute__((unused)),
+                      ibool table_id __attribute__((unused)))
+{
+  ulint	len= ut_min(buflen, idlen);
+
+  memcpy(buf, id, len);
+  return(buf + len);
+}
+
+/* Memory heaps are not used by the code under test. */
+mem_block_t*
+mem_heap_create_block(mem_heap_t* heap __attribute__((unused)),
+                      ulint n __attribute__((unused)),
+                      ulint type __attribute__((unused)),
+                      const char* file_name __attribute__((unused)),
+                      ulint line __attribute__((unused)))
+{
+  ut_error;
+  return(NULL);
+}
+
+mem_block_t*
+mem_heap_add_block(mem_heap_t* heap __attribute__((unused)),
+                   ulint n __attribute__((unused)))
+{
+  ut_error;
+  return(NULL);
+}
+
+static mutex_t	bench_mutex;
+static ulint	bench_counter;
+
+static void*
+bench_thread(void* arg __attribute__((unused)))
+{
+  ulint	i;
+
+  for (i= 0; i < N_ROUNDS; i++)
+  {
+    mutex_enter(&bench_mutex);
+    bench_counter++;
+    os_thread_sleep(HOLD_TIME);
+    mutex_exit(&bench_mutex);
+  }
+
+  return(NULL);
+}
+
+/* Returns the number of cells reserved in all the wait arrays. */
+static ulong
+bench_reservations(void)
+{
+  FILE*	file= tmpfile();
+  ulong	res_count= 0;
+
+  if (file == NULL)
+    return(0);
+
+  sync_array_print(file);
+  rewind(file);
+  if (fscanf(file, "OS WAIT ARRAY INFO: reservation count %lu",
+             &res_count) != 1)
+    res_count= 0;
+  fclose(file);
+
+  return(res_count);
+}
+
+static void
+bench(ulint n_arrays)
+{
+  pthread_t	threads[N_THREADS];
+  ulonglong	start;
+  ulonglong	elapsed;
+  ulong		res_count;
+  ulint		i;
+
+  srv_sync_array_size= n_arrays;
+  sync_init();
+
+  mutex_create(PFS_NOT_INSTRUMENTED, &bench_mutex, SYNC_NO_ORDER_CHECK);
+  bench_counter= 0;
+
+  start= my_getsystime();
+
+  for (i= 0; i < N_THREADS; i++)
+    pthread_create(&threads[i], NULL, bench_thread, NULL);
+
+  for (i= 0; i < N_THREADS; i++)
+    pthread_join(threads[i], NULL);
+
+  /* my_getsystime() is in units of 100 nanoseconds. */
+  elapsed= my_getsystime() - start;
+  if (elapsed == 0)
+    elapsed= 1;
+
+  /* sync_array_validate() crashes on an inconsistent array. */
+  for (i= 0; i < sync_array_size; i++)
+    sync_array_validate(sync_wait_array[i]);
+
+  ok(bench_counter == N_THREADS * N_ROUNDS,
+     "%lu wait arrays: counter is exact", (ulong) n_arrays);
+
+  res_count= bench_reservations();
+  ok(res_count > 0,
+     "%lu wait arrays: threads waited in the arrays", (ulong) n_arrays);
+
+  diag("%2lu wait arrays, %d threads: %8.0f handoffs/s, %lu waits",
+       (ulong) n_arrays, N_THREADS,
+       (double) N_THREADS * N_ROUNDS / (elapsed / 1e7), res_count);
+
+  mutex_free(&bench_mutex);
+  sync_close();
+}
+
+int main(int argc __attribute__((unused)), char **argv)
+{
+  MY_INIT(argv[0]);
+
+  plan(6);
+
+  ut_mem_init();
+  os_sync_init();
+
+  /* Spin only briefly, so that the waits go through the wait arrays. */
+  srv_n_spin_wait_rounds= 1;
+
+  bench(1);
+  bench(4);
+  bench(N_THREADS);
+
+  os_sync_free();
+
+  my_end(0);
+  return exit_status();
+}
@@ -0,0 +1,159 @@
+/* Copyright (c) 2013, Twitter, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Tests the CRC32 implementations of InnoDB (ut/ut0crc32.c) and reports
+  the page checksum throughput of the innodb_checksum_algorithm values.
+
+  The hardware and software implementations must agree on every input,
+  regardless of length and alignment. The throughput figures are only
+  printed as diagnostics and are not checked.
+*/
+
+#include "univ.i"
+#include "ut0crc32.h"
+#include "ut0rnd.h"
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <tap.h>
+
+/* Page layout, see fil0fil.h and buf_calc_page_new_checksum(). */
+#define PAGE_SIZE		16384
+#define PAGE_OFFSET		4
+#define PAGE_FILE_FLUSH_LSN	26
+#define PAGE_DATA		38
+#define PAGE_END_LSN_OLD_CHKSUM	8
+
+#define BENCH_ITERATIONS	20000
+
+static byte	buf[PAGE_SIZE + 16];
+
+/** Legacy InnoDB page checksum, as in buf_calc_page_new_checksum(). */
+static ulint
+calc_page_innodb(const byte* page)
+{
+  return(ut_fold_binary(page + PAGE_OFFSET,
+                        PAGE_FILE_FLUSH_LSN - PAGE_OFFSET)
+         + ut_fold_binary(page + PAGE_DATA,
+                          PAGE_SIZE - PAGE_DATA - PAGE_END_LSN_OLD_CHKSUM));
+}
+
+/** CRC32 page checksum, as in buf_calc_page_crc32(). */
+static ulint
+calc_page_crc32(const byte* page)
+{
+  return(ut_crc32(page + PAGE_OFFSET, PAGE_FILE_FLUSH_LSN - PAGE_OFFSET)
+         ^ ut_crc32(page + PAGE_DATA,
+                    PAGE_SIZE - PAGE_DATA - PAGE_END_LSN_OLD_CHKSUM));
+}
+
+/** CRC32 page checksum, always using the software implementation. */
+static ulint
+calc_page_crc32_slice8(const byte* page)
+{
+  return(ut_crc32_slice8(page + PAGE_OFFSET,
+                         PAGE_FILE_FLUSH_LSN - PAGE_OFFSET)
+         ^ ut_crc32_slice8(page + PAGE_DATA,
+                           PAGE_SIZE - PAGE_DATA - PAGE_END_LSN_OLD_CHKSUM));
+}
+
+static void
+test_known_values()
+{
+  static const byte	check[] = "123456789";
+  static const byte	zeros[32];
+
+  ok(ut_crc32(check, 9) == 0xE3069283UL, "ut_crc32 check value");
+  ok(ut_crc32_slice8(check, 9) == 0xE3069283UL,
+     "ut_crc32_slice8 check value");
+  ok(ut_crc32(zeros, 32) == 0x8A9136AAUL, "ut_crc32 of 32 zero bytes");
+  ok(ut_crc32(check, 0) == 0, "ut_crc32 of empty input");
+}
+
+static void
+test_implementations_agree()
+{
+  ulint	i;
+  ulint	align;
+  ulint	len;
+  ibool	all_ok= TRUE;
+  ulint	rnd= 1;
+
+  for (i= 0; i < sizeof(buf); i++)
+  {
+    rnd= rnd * 1103515245 + 12345;
+    buf[i]= (byte) (rnd >> 16);
+  }
+
+  for (align= 0; align < 8; align++)
+    for (len= 0; len <= 200; len++)
+      if (ut_crc32(buf + align, len) != ut_crc32_slice8(buf + align, len))
+        all_ok= FALSE;
+
+  ok(all_ok, "ut_crc32 and ut_crc32_slice8 agree on short inputs");
+
+  ok(ut_crc32(buf + 3, PAGE_SIZE) == ut_crc32_slice8(buf + 3, PAGE_SIZE),
+     "ut_crc32 and ut_crc32_slice8 agree on an unaligned page");
+}
+
+static void
+bench(const char* name, ulint (*calc)(const byte*))
+{
+  ulonglong	start;
+  ulonglong	elapsed;
+  ulint		sum= 0;
+  ulint		i;
+
+  start= my_getsystime();
+
+  for (i= 0; i < BENCH_ITERATIONS; i++)
+  {
+    /* Change the page, so that the calls cannot be optimized away. */
+    buf[PAGE_DATA]= (byte) i;
+    sum+= calc(buf);
+  }
+
+  /* my_getsystime() is in units of 100 nanoseconds. */
+  elapsed= my_getsystime() - start;
+  if (elapsed == 0)
+    elapsed= 1;
+
+  diag("%-24s %8.1f MB/s  %6.2f us/page  (sum %lu)", name,
+       (double) BENCH_ITERATIONS * PAGE_SIZE / (elapsed / 10.0),
+       elapsed / 10.0 / BENCH_ITERATIONS, (ulong) sum);
+}
+
+int main(int argc __attribute__((unused)), char **argv)
+{
+  MY_INIT(argv[0]);
+
+  plan(6);
+
+  ut_crc32_init();
+
+  diag("CRC32 implementation: %s",
+       ut_crc32_sse42_enabled ? "SSE4.2 crc32 instruction" : "slicing-by-8");
+
+  test_known_values();
+  test_implementations_agree();
+
+  bench("innodb", calc_page_innodb);
+  bench("crc32", calc_page_crc32);
+  bench("crc32 (slicing-by-8)", calc_page_crc32_slice8);
+
+  my_end(0);
+  return exit_status();
+}